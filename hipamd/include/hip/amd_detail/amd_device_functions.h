@@ -810,6 +810,76 @@ int __syncthreads_or(int predicate)
   return __ockl_wgred_or_i32(!!predicate);
 }
 
+// Asynchronous global to LDS copies. Every lane copies size bytes from its source, the LDS
+// destination is uniform for the wave and the lane i writes at lds + i * size, as the
+// global_load_lds instructions do. The copies bypass the VGPRs on gfx940 and later CDNA targets,
+// the other targets copy synchronously with the same layout. The copies count as vector memory
+// loads of the wave, __hip_memcpy_async_wait() waits for them and a __syncthreads() after the
+// wait makes the data visible to the other waves of the workgroup.
+#if (defined(__gfx940__) || defined(__gfx941__) || defined(__gfx942__) || defined(__gfx950__))
+#define __HIP_ASYNC_LDS_COPY 1
+#else
+#define __HIP_ASYNC_LDS_COPY 0
+#endif
+
+template <unsigned int size>
+__device__
+inline
+static void __hip_memcpy_async_lds(void* lds, const void* src)
+{
+#if defined(__gfx950__)
+  static_assert(size == 1 || size == 2 || size == 4 || size == 12 || size == 16,
+                "The copy size must be 1, 2, 4, 12 or 16 bytes");
+#else
+  static_assert(size == 1 || size == 2 || size == 4, "The copy size must be 1, 2 or 4 bytes");
+#endif
+#if __HIP_ASYNC_LDS_COPY
+  __builtin_amdgcn_global_load_lds((__attribute__((address_space(1))) void*)src,
+                                   (__attribute__((address_space(3))) void*)lds, size, 0, 0);
+#else
+  __builtin_memcpy(static_cast<char*>(lds) + __lane_id() * size, src, size);
+#endif
+}
+
+// Waits until at most pending vector memory loads of the wave, including the asynchronous
+// copies, are in flight
+template <unsigned int pending = 0>
+__device__
+inline
+static void __hip_memcpy_async_wait()
+{
+#if __HIP_ASYNC_LDS_COPY
+  static_assert(pending < 64, "The vector memory counter holds up to 63 loads");
+  // s_waitcnt vmcnt(pending) of gfx9, the export and LDS counters don't wait
+  __builtin_amdgcn_s_waitcnt((pending & 0xf) | ((pending >> 4) << 14) | (0x7 << 4) | (0xf << 8));
+#endif
+}
+
+// A multistage pipeline of the asynchronous copies for the tiled kernels. Every stage issues
+// copies_per_stage copies per lane, then the kernel waits for the oldest stage and computes on it
+// while the later stages are in flight:
+//
+//   __hip_lds_pipeline<2, 4> pipe;
+//   load_tile(0);
+//   for (int k = 0; k < tiles; ++k) {
+//     if (k + 1 < tiles) { load_tile(k + 1); pipe.wait_prior(); } else { pipe.wait_all(); }
+//     __syncthreads();
+//     compute_tile(k);
+//     __syncthreads();
+//   }
+template <unsigned int stages, unsigned int copies_per_stage = 1>
+struct __hip_lds_pipeline {
+  static_assert(stages > 0, "The pipeline needs a stage");
+
+  // Waits for the oldest stage in flight, the stages - 1 newer stages keep loading
+  __device__ void wait_prior() const {
+    __hip_memcpy_async_wait<(stages - 1) * copies_per_stage>();
+  }
+
+  // Waits for all stages
+  __device__ void wait_all() const { __hip_memcpy_async_wait<0>(); }
+};
+
 // hip.amdgcn.bc - device routine
 /*
   HW_ID Register bit structure for RDNA2 & RDNA3
@@ -301,6 +301,15 @@ double atomicAdd_system(double* address, double val) {
   return __hip_atomic_fetch_add(address, val, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_SYSTEM);
 }
 
+// Atomic add with the memory order and the scope, e.g. atomicAdd<__ATOMIC_RELEASE>(p, v) or
+// atomicAdd<__ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_WORKGROUP>(p, v)
+template <int order, int scope = __HIP_MEMORY_SCOPE_AGENT, typename T>
+__device__
+inline
+T atomicAdd(T* address, T val) {
+  return __hip_atomic_fetch_add(address, val, order, scope);
+}
+
 __device__
 inline
 int atomicSub(int* address, int val) {
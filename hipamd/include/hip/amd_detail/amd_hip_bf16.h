@@ -1861,5 +1861,55 @@ __BF16_DEVICE_STATIC__ __hip_bfloat162 unsafeAtomicAdd(__hip_bfloat162* address,
   return old_val.h2r;
 #endif
 }
+
+// CAS loop of the packed add in the given scope, the two halves add atomically
+template <int scope>
+__BF16_DEVICE_STATIC__ __hip_bfloat162 __hip_atomic_add_bfloat162(__hip_bfloat162* address,
+                                                                  __hip_bfloat162 value) {
+  static_assert(sizeof(unsigned int) == sizeof(__hip_bfloat162_raw));
+  union u_hold {
+    __hip_bfloat162_raw h2r;
+    unsigned int u32;
+  };
+  u_hold old_val, new_val;
+  old_val.u32 = __hip_atomic_load((unsigned int*)address, __ATOMIC_RELAXED, scope);
+  do {
+    new_val.h2r = __hadd2(old_val.h2r, value);
+  } while (!__hip_atomic_compare_exchange_strong((unsigned int*)address, &old_val.u32, new_val.u32,
+                                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED, scope));
+  return old_val.h2r;
+}
+
+/**
+ * \ingroup HIP_INTRINSIC_BFLOAT162_MATH
+ * \brief Atomic add bfloat162, returns the old value. With -munsafe-fp-atomics it lowers to the
+ * hardware packed add, which isn't safe on the fine grained memory
+ */
+__BF16_DEVICE_STATIC__ __hip_bfloat162 atomicAdd(__hip_bfloat162* address,
+                                                 __hip_bfloat162 value) {
+#if defined(__AMDGCN_UNSAFE_FP_ATOMICS__)
+  return unsafeAtomicAdd(address, value);
+#else
+  return __hip_atomic_add_bfloat162<__HIP_MEMORY_SCOPE_AGENT>(address, value);
+#endif
+}
+
+/**
+ * \ingroup HIP_INTRINSIC_BFLOAT162_MATH
+ * \brief Atomic add bfloat162 at the system scope
+ */
+__BF16_DEVICE_STATIC__ __hip_bfloat162 atomicAdd_system(__hip_bfloat162* address,
+                                                        __hip_bfloat162 value) {
+  return __hip_atomic_add_bfloat162<__HIP_MEMORY_SCOPE_SYSTEM>(address, value);
+}
+
+/**
+ * \ingroup HIP_INTRINSIC_BFLOAT162_MATH
+ * \brief Atomic add bfloat162 at the workgroup scope
+ */
+__BF16_DEVICE_STATIC__ __hip_bfloat162 atomicAdd_block(__hip_bfloat162* address,
+                                                       __hip_bfloat162 value) {
+  return __hip_atomic_add_bfloat162<__HIP_MEMORY_SCOPE_WORKGROUP>(address, value);
+}
 #endif  // defined(__clang__) && defined(__HIP__)
 #endif
@@ -928,6 +928,53 @@ __CG_QUALIFIER__ coalesced_group binary_partition(const thread_block_tile<size,
   }
 }
 #endif // HIP_DISABLE_WARP_SYNC_BUILTINS
+
+/** \brief Operators for the tile reductions and scans
+ */
+template <class T> struct plus {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return a + b; }
+};
+template <class T> struct less {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return (b < a) ? b : a; }
+};
+template <class T> struct greater {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return (a < b) ? b : a; }
+};
+template <class T> struct bit_and {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return a & b; }
+};
+template <class T> struct bit_or {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return a | b; }
+};
+template <class T> struct bit_xor {
+  __CG_QUALIFIER__ T operator()(T a, T b) const { return a ^ b; }
+};
+
+/** \brief Reduces the values of the tile, every rank returns the result
+ *
+ *  \details The operator must be commutative and associative and T a 32-bit type. The tile
+ *            must be fully active.
+ */
+template <unsigned int size, class ParentCGTy, class T, class Op>
+__CG_QUALIFIER__ T reduce(const thread_block_tile<size, ParentCGTy>& tile, T value, Op op) {
+  return __hip_wave_reduce<size>(value, op);
+}
+
+/** \brief Inclusive scan over the ranks of the tile
+ */
+template <unsigned int size, class ParentCGTy, class T, class Op>
+__CG_QUALIFIER__ T inclusive_scan(const thread_block_tile<size, ParentCGTy>& tile, T value,
+                                  Op op) {
+  return __hip_wave_inclusive_scan<size>(value, op);
+}
+
+/** \brief Exclusive scan over the ranks of the tile, the rank 0 returns a value initialized T
+ */
+template <unsigned int size, class ParentCGTy, class T, class Op>
+__CG_QUALIFIER__ T exclusive_scan(const thread_block_tile<size, ParentCGTy>& tile, T value,
+                                  Op op) {
+  return __hip_wave_exclusive_scan<size>(value, op, T{});
+}
 }  // namespace cooperative_groups
 
 #endif  // __cplusplus
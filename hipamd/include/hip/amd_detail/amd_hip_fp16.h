@@ -1537,6 +1537,43 @@ THE SOFTWARE.
                 return old_val.h2r;
             #endif
             }
+
+            // CAS loop of the packed add in the given scope, the two halves add atomically
+            template <int scope>
+            inline __device__ __half2 __hip_atomic_add_half2(__half2* address, __half2 value) {
+                static_assert(sizeof(__half2_raw) == sizeof(unsigned int));
+                union u_hold {
+                    __half2_raw h2r;
+                    unsigned int u32;
+                };
+                u_hold old_val, new_val;
+                old_val.u32 = __hip_atomic_load((unsigned int*)address, __ATOMIC_RELAXED, scope);
+                do {
+                    new_val.h2r = __hadd2(old_val.h2r, value);
+                } while (!__hip_atomic_compare_exchange_strong(
+                    (unsigned int*)address, &old_val.u32, new_val.u32, __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED, scope));
+                return old_val.h2r;
+            }
+
+            // Packed atomic add, returns the old value. With -munsafe-fp-atomics it lowers to
+            // the hardware packed add, which isn't safe on the fine grained memory. The compiler
+            // emits the no return encoding when the result is unused
+            inline __device__ __half2 atomicAdd(__half2* address, __half2 value) {
+            #if defined(__AMDGCN_UNSAFE_FP_ATOMICS__)
+                return unsafeAtomicAdd(address, value);
+            #else
+                return __hip_atomic_add_half2<__HIP_MEMORY_SCOPE_AGENT>(address, value);
+            #endif
+            }
+
+            inline __device__ __half2 atomicAdd_system(__half2* address, __half2 value) {
+                return __hip_atomic_add_half2<__HIP_MEMORY_SCOPE_SYSTEM>(address, value);
+            }
+
+            inline __device__ __half2 atomicAdd_block(__half2* address, __half2 value) {
+                return __hip_atomic_add_half2<__HIP_MEMORY_SCOPE_WORKGROUP>(address, value);
+            }
             #endif // defined(__clang__) && defined(__HIP__)
 
             // Math functions
@@ -30,8 +30,8 @@
 #ifndef _HIP_INCLUDE_HIP_AMD_DETAIL_HIP_FP8_H_
 #define _HIP_INCLUDE_HIP_AMD_DETAIL_HIP_FP8_H_
 
-#if (defined(__gfx940__) || defined(__gfx941__) || defined(__gfx942__) || defined(__gfx1200__) ||  \
-     defined(__gfx1201__)) &&                                                                      \
+#if (defined(__gfx940__) || defined(__gfx941__) || defined(__gfx942__) || defined(__gfx950__) ||   \
+     defined(__gfx1200__) || defined(__gfx1201__)) &&                                              \
     __HIP_DEVICE_COMPILE__
 #define HIP_FP8_CVT_FAST_PATH 1
 #else
@@ -41,7 +41,8 @@
 #if (defined(__gfx940__) || defined(__gfx941__) || defined(__gfx942__)) && __HIP_DEVICE_COMPILE__
 #define HIP_FP8_TYPE_OCP 0
 #define HIP_FP8_TYPE_FNUZ 1
-#elif (defined(__gfx1200__) || defined(__gfx1201__)) && __HIP_DEVICE_COMPILE__
+#elif (defined(__gfx950__) || defined(__gfx1200__) || defined(__gfx1201__)) &&                      \
+    __HIP_DEVICE_COMPILE__
 #define HIP_FP8_TYPE_OCP 1
 #define HIP_FP8_TYPE_FNUZ 0
 #else
@@ -548,48 +549,84 @@ static __device__ __hip_fp8_storage_t cast_to_f8_from_f32(float v, bool saturate
   return i8data;
 }
 
-static __device__ __hip_fp8x2_storage_t
-cast_to_f8x2_from_f32x2(float2 v, bool saturate, __hip_fp8_interpretation_t interpret) {
+// Clamps the value to the fp8 range, NAN/INF are propagated without clipping
+static __device__ float saturate_f32_to_f8(float v, __hip_fp8_interpretation_t interpret) {
   union {
-    static_assert(sizeof(float2) == sizeof(unsigned int[2]), "size mismatch");
-    static_assert(sizeof(float2) == sizeof(unsigned short[4]), "size mismatch");
-    float2 fval;
-    unsigned int i32val[2];
-    unsigned short i16val[4];
-  } f2val;
-
-  f2val.fval = v;
+    float fval;
+    unsigned int i32val;
+  } val;
+  val.fval = v;
+  if ((val.i32val & 0x7F800000) == 0x7F800000) {
+    return v;
+  }
+  const float fmax = (interpret == __HIP_E4M3_FNUZ) ? 240.0f
+      : (interpret == __HIP_E4M3)                   ? 448.0f
+                                                    : 57344.0f;
+  return __builtin_amdgcn_fmed3f(v, fmax, -fmax);
+}
 
-  if (saturate) {  /// propagate NAN/INF, no clipping
-    if (interpret == __HIP_E4M3_FNUZ) {
-      if ((f2val.i32val[0] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.x = __builtin_amdgcn_fmed3f(f2val.fval.x, 240.0, -240.0);
-      }
-      if ((f2val.i32val[1] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.y = __builtin_amdgcn_fmed3f(f2val.fval.x, 240.0, -240.0);
-      }
-    } else if (interpret == __HIP_E4M3) {
-      if ((f2val.i32val[0] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.x = __builtin_amdgcn_fmed3f(f2val.fval.x, 448.0, -448.0);
-      }
-      if ((f2val.i32val[1] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.y = __builtin_amdgcn_fmed3f(f2val.fval.x, 448.0, -448.0);
-      }
-    } else {
-      if ((f2val.i32val[0] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.x = __builtin_amdgcn_fmed3f(f2val.fval.x, 57344.0, -57344.0);
-      }
-      if ((f2val.i32val[1] & 0x7F800000) != 0x7F800000) {
-        f2val.fval.y = __builtin_amdgcn_fmed3f(f2val.fval.x, 57344.0, -57344.0);
-      }
-    }
+static __device__ __hip_fp8x2_storage_t
+cast_to_f8x2_from_f32x2(float2 v, bool saturate, __hip_fp8_interpretation_t interpret) {
+  if (saturate) {
+    v.x = saturate_f32_to_f8(v.x, interpret);
+    v.y = saturate_f32_to_f8(v.y, interpret);
   }
 
-  f2val.i32val[0] = (interpret == __HIP_E4M3_FNUZ) || (interpret == __HIP_E4M3)
+  unsigned int ival = (interpret == __HIP_E4M3_FNUZ) || (interpret == __HIP_E4M3)
       ? __builtin_amdgcn_cvt_pk_fp8_f32(v.x, v.y, 0, false)
       : __builtin_amdgcn_cvt_pk_bf8_f32(v.x, v.y, 0, false);
 
-  return static_cast<__hip_fp8x2_storage_t>(f2val.i16val[0]);
+  return static_cast<__hip_fp8x2_storage_t>(ival);
+}
+
+// Converts four values with two packed conversions, x lands in the lowest byte
+static __device__ __hip_fp8x4_storage_t
+cast_to_f8x4_from_f32x4(float4 v, bool saturate, __hip_fp8_interpretation_t interpret) {
+  if (saturate) {
+    v.x = saturate_f32_to_f8(v.x, interpret);
+    v.y = saturate_f32_to_f8(v.y, interpret);
+    v.z = saturate_f32_to_f8(v.z, interpret);
+    v.w = saturate_f32_to_f8(v.w, interpret);
+  }
+
+  unsigned int ival;
+  if ((interpret == __HIP_E4M3_FNUZ) || (interpret == __HIP_E4M3)) {
+    ival = __builtin_amdgcn_cvt_pk_fp8_f32(v.x, v.y, 0, false);
+    ival = __builtin_amdgcn_cvt_pk_fp8_f32(v.z, v.w, ival, true);  // true -> WORD1
+  } else {
+    ival = __builtin_amdgcn_cvt_pk_bf8_f32(v.x, v.y, 0, false);
+    ival = __builtin_amdgcn_cvt_pk_bf8_f32(v.z, v.w, ival, true);
+  }
+  return static_cast<__hip_fp8x4_storage_t>(ival);
+}
+
+// Stochastic rounding of four values, the random bits of each value are rotated from rng
+static __device__ __hip_fp8x4_storage_t
+cast_to_f8x4_from_f32x4_sr(float4 v, unsigned int rng, bool saturate,
+                           __hip_fp8_interpretation_t interpret) {
+  if (saturate) {
+    v.x = saturate_f32_to_f8(v.x, interpret);
+    v.y = saturate_f32_to_f8(v.y, interpret);
+    v.z = saturate_f32_to_f8(v.z, interpret);
+    v.w = saturate_f32_to_f8(v.w, interpret);
+  }
+
+  const unsigned int rng1 = (rng >> 8) | (rng << 24);
+  const unsigned int rng2 = (rng >> 16) | (rng << 16);
+  const unsigned int rng3 = (rng >> 24) | (rng << 8);
+  unsigned int ival;
+  if ((interpret == __HIP_E4M3_FNUZ) || (interpret == __HIP_E4M3)) {
+    ival = __builtin_amdgcn_cvt_sr_fp8_f32(v.x, rng, 0, 0);
+    ival = __builtin_amdgcn_cvt_sr_fp8_f32(v.y, rng1, ival, 1);
+    ival = __builtin_amdgcn_cvt_sr_fp8_f32(v.z, rng2, ival, 2);
+    ival = __builtin_amdgcn_cvt_sr_fp8_f32(v.w, rng3, ival, 3);
+  } else {
+    ival = __builtin_amdgcn_cvt_sr_bf8_f32(v.x, rng, 0, 0);
+    ival = __builtin_amdgcn_cvt_sr_bf8_f32(v.y, rng1, ival, 1);
+    ival = __builtin_amdgcn_cvt_sr_bf8_f32(v.z, rng2, ival, 2);
+    ival = __builtin_amdgcn_cvt_sr_bf8_f32(v.w, rng3, ival, 3);
+  }
+  return static_cast<__hip_fp8x4_storage_t>(ival);
 }
 
 static __device__ float cast_to_f32_from_f8(__hip_fp8_storage_t v,
@@ -619,6 +656,16 @@ static __device__ float2 cast_to_f32x2_from_f8x2(__hip_fp8x2_storage_t v,
       : __builtin_amdgcn_cvt_pk_f32_bf8(val.i32val, false);
   return float2{f2[0], f2[1]};
 }
+
+static __device__ float4 cast_to_f32x4_from_f8x4(__hip_fp8x4_storage_t v,
+                                                 __hip_fp8_interpretation_t interpret) {
+  const bool fp8 = (interpret == __HIP_E4M3_FNUZ) || (interpret == __HIP_E4M3);
+  auto low = fp8 ? __builtin_amdgcn_cvt_pk_f32_fp8(v, false)
+                 : __builtin_amdgcn_cvt_pk_f32_bf8(v, false);
+  auto high = fp8 ? __builtin_amdgcn_cvt_pk_f32_fp8(v, true)  // true -> WORD1
+                  : __builtin_amdgcn_cvt_pk_f32_bf8(v, true);
+  return float4(low[0], low[1], high[0], high[1]);
+}
 #endif  // HIP_FP8_CVT_FAST_PATH
 
 /* For fp8 fnuz types, finite and NaN values are supported. Zero is unsigned.
@@ -703,6 +750,112 @@ __FP8_HOST_STATIC__ __hip_fp8x2_storage_t __hip_cvt_float2_to_fp8x2(
 #endif  // HIP_FP8_CVT_FAST_PATH
 }
 
+/**
+ * \brief convert float4 to @p __hip_fp8x4_storage_t, x is stored in the lowest byte
+ *
+ * \param f4 float4 number
+ * \param sat saturation of fp8
+ * \param interp interpretation of fp8
+ * \return __hip_fp8x4_storage_t
+ */
+#if HIP_FP8_CVT_FAST_PATH
+__FP8_HOST_DEVICE_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4(
+    const float4 f4, const __hip_saturation_t sat, const __hip_fp8_interpretation_t interp) {
+  internal::__is_interpret_supported(interp);
+  return internal::cast_to_f8x4_from_f32x4(f4, sat == __HIP_SATFINITE, interp);
+#else
+#if HIP_FP8_TYPE_OCP && HIP_FP8_TYPE_FNUZ
+__FP8_HOST_DEVICE_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4(
+    const float4 f4, const __hip_saturation_t sat, const __hip_fp8_interpretation_t interp) {
+#else
+__FP8_HOST_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4(
+    const float4 f4, const __hip_saturation_t sat, const __hip_fp8_interpretation_t interp) {
+#endif
+  return static_cast<__hip_fp8x4_storage_t>(
+      static_cast<unsigned int>(__hip_cvt_float2_to_fp8x2(float2(f4.z, f4.w), sat, interp))
+          << 16 |
+      static_cast<unsigned int>(__hip_cvt_float2_to_fp8x2(float2(f4.x, f4.y), sat, interp)));
+#endif  // HIP_FP8_CVT_FAST_PATH
+}
+
+/**
+ * \brief convert float4 to @p __hip_fp8x4_storage_t with stochastic rounding
+ *
+ * The random bits of x are @p rng, the bits of y, z and w are @p rng rotated right by 8, 16
+ * and 24 bits, hence a single random number per thread rounds all four values.
+ *
+ * \param f4 float4 number
+ * \param rng random bits for the rounding
+ * \param sat saturation of fp8
+ * \param interp interpretation of fp8
+ * \return __hip_fp8x4_storage_t
+ */
+#if HIP_FP8_CVT_FAST_PATH
+__FP8_HOST_DEVICE_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4_sr(
+    const float4 f4, const unsigned int rng, const __hip_saturation_t sat,
+    const __hip_fp8_interpretation_t interp) {
+  internal::__is_interpret_supported(interp);
+  return internal::cast_to_f8x4_from_f32x4_sr(f4, rng, sat == __HIP_SATFINITE, interp);
+#else
+#if HIP_FP8_TYPE_OCP && HIP_FP8_TYPE_FNUZ
+__FP8_HOST_DEVICE_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4_sr(
+    const float4 f4, const unsigned int rng, const __hip_saturation_t sat,
+    const __hip_fp8_interpretation_t interp) {
+#else
+__FP8_HOST_STATIC__ __hip_fp8x4_storage_t __hip_cvt_float4_to_fp8x4_sr(
+    const float4 f4, const unsigned int rng, const __hip_saturation_t sat,
+    const __hip_fp8_interpretation_t interp) {
+#endif
+  const bool fnuz = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E5M2_FNUZ);
+  const int we = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E4M3) ? 4 : 5;
+  const int wm = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E4M3) ? 3 : 2;
+  const bool clip = (sat == __HIP_SATFINITE);
+  const float f[4] = {f4.x, f4.y, f4.z, f4.w};
+  unsigned int ival = 0;
+  for (int i = 0; i < 4; ++i) {
+    const unsigned int r = (i == 0) ? rng : ((rng >> (8 * i)) | (rng << (32 - 8 * i)));
+    const __hip_fp8_storage_t v = fnuz
+        ? internal::cast_to_f8<float, true>(f[i], wm, we, clip, true, r)
+        : internal::cast_to_f8<float, false>(f[i], wm, we, clip, true, r);
+    ival |= static_cast<unsigned int>(static_cast<unsigned char>(v)) << (8 * i);
+  }
+  return static_cast<__hip_fp8x4_storage_t>(ival);
+#endif  // HIP_FP8_CVT_FAST_PATH
+}
+
+/**
+ * \brief convert @p __hip_fp8x4_storage_t to float4, the lowest byte is x
+ *
+ * \param x __hip_fp8x4_storage_t val
+ * \param interp interpretation of fp8
+ * \return float4
+ */
+#if HIP_FP8_CVT_FAST_PATH
+__FP8_HOST_DEVICE_STATIC__ float4 __hip_cvt_fp8x4_to_float4(
+    const __hip_fp8x4_storage_t x, const __hip_fp8_interpretation_t interp) {
+  internal::__is_interpret_supported(interp);
+  return internal::cast_to_f32x4_from_f8x4(x, interp);
+#else
+#if HIP_FP8_TYPE_OCP && HIP_FP8_TYPE_FNUZ
+__FP8_HOST_DEVICE_STATIC__ float4 __hip_cvt_fp8x4_to_float4(
+    const __hip_fp8x4_storage_t x, const __hip_fp8_interpretation_t interp) {
+#else
+__FP8_HOST_STATIC__ float4 __hip_cvt_fp8x4_to_float4(
+    const __hip_fp8x4_storage_t x, const __hip_fp8_interpretation_t interp) {
+#endif
+  const bool fnuz = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E5M2_FNUZ);
+  const int we = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E4M3) ? 4 : 5;
+  const int wm = (interp == __HIP_E4M3_FNUZ) || (interp == __HIP_E4M3) ? 3 : 2;
+  float f[4];
+  for (int i = 0; i < 4; ++i) {
+    const __hip_fp8_storage_t v = static_cast<__hip_fp8_storage_t>(x >> (8 * i));
+    f[i] = fnuz ? internal::cast_from_f8<float, true>(v, wm, we)
+                : internal::cast_from_f8<float, false>(v, wm, we);
+  }
+  return float4(f[0], f[1], f[2], f[3]);
+#endif  // HIP_FP8_CVT_FAST_PATH
+}
+
 /**
  * \brief convert double to @p __hip_fp8_storage_t
  *
@@ -1391,19 +1544,7 @@ struct __hip_fp8x4_e4m3_fnuz {
 #else
   __FP8_HOST__ __hip_fp8x4_e4m3_fnuz(const float4 val)
 #endif
-      : __x{reinterpret_cast<__hip_fp8x4_storage_t>(
-            static_cast<unsigned int>(reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.x, __default_saturation, __default_interpret)) |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.y, __default_saturation, __default_interpret))
-                                          << 8 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.z, __default_saturation, __default_interpret))
-                                          << 16 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.w, __default_saturation, __default_interpret))
-                                          << 24))} {
-  }
+      : __x{__hip_cvt_float4_to_fp8x4(val, __default_saturation, __default_interpret)} {}
 
   /*! create fp8x4 e4m3 type from two __hip_bfloat162 */
 #if HIP_FP8_TYPE_FNUZ
@@ -1446,23 +1587,7 @@ struct __hip_fp8x4_e4m3_fnuz {
 #else
   __FP8_HOST__ operator float4() const {
 #endif
-    auto x = __x;                                                // bypass const
-    auto fp8x2_low = *reinterpret_cast<__hip_fp8x2_storage_t*>(&x);  // Little E
-    auto fp8x2_high = *(reinterpret_cast<__hip_fp8x2_storage_t*>(&x) + 1);
-#if HIP_FP8_CVT_FAST_PATH
-    float2 high = internal::cast_to_f32x2_from_f8x2(fp8x2_high, __default_interpret);
-    float2 low = internal::cast_to_f32x2_from_f8x2(fp8x2_low, __default_interpret);
-#else
-    float2 high = float2(internal::cast_from_f8<float, true>(
-                             static_cast<__hip_fp8_storage_t>((fp8x2_high << 8) >> 8), __wm, __we),
-                         internal::cast_from_f8<float, true>(
-                             static_cast<__hip_fp8_storage_t>(fp8x2_high >> 8), __wm, __we));
-    float2 low = float2(internal::cast_from_f8<float, true>(
-                            static_cast<__hip_fp8_storage_t>((fp8x2_low << 8) >> 8), __wm, __we),
-                        internal::cast_from_f8<float, true>(
-                            static_cast<__hip_fp8_storage_t>(fp8x2_low >> 8), __wm, __we));
-#endif
-    return float4(low.x, low.y, high.x, high.y);
+    return __hip_cvt_fp8x4_to_float4(__x, __default_interpret);
   }
 };
 
@@ -1949,19 +2074,7 @@ struct __hip_fp8x4_e5m2_fnuz {
 #else
   __FP8_HOST__ __hip_fp8x4_e5m2_fnuz(const float4 val)
 #endif
-      : __x(reinterpret_cast<__hip_fp8x4_storage_t>(
-            static_cast<unsigned int>(reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.x, __default_saturation, __default_interpret)) |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.y, __default_saturation, __default_interpret))
-                                          << 8 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.z, __default_saturation, __default_interpret))
-                                          << 16 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.w, __default_saturation, __default_interpret))
-                                          << 24))) {
-  }
+      : __x{__hip_cvt_float4_to_fp8x4(val, __default_saturation, __default_interpret)} {}
 
   /*! create fp8x4 e5m2 type from two __hip_bfloat162 */
 #if HIP_FP8_TYPE_FNUZ
@@ -2004,23 +2117,7 @@ struct __hip_fp8x4_e5m2_fnuz {
 #else
   __FP8_HOST__ operator float4() const {
 #endif
-    auto x = __x;                                                // bypass const
-    auto fp8x2_low = *reinterpret_cast<__hip_fp8x2_storage_t*>(&x);  // Little E
-    auto fp8x2_high = *(reinterpret_cast<__hip_fp8x2_storage_t*>(&x) + 1);
-#if HIP_FP8_CVT_FAST_PATH
-    float2 high = internal::cast_to_f32x2_from_f8x2(fp8x2_high, __default_interpret);
-    float2 low = internal::cast_to_f32x2_from_f8x2(fp8x2_low, __default_interpret);
-#else
-    float2 high = float2(internal::cast_from_f8<float, true>(
-                             static_cast<__hip_fp8_storage_t>((fp8x2_high << 8) >> 8), __wm, __we),
-                         internal::cast_from_f8<float, true>(
-                             static_cast<__hip_fp8_storage_t>(fp8x2_high >> 8), __wm, __we));
-    float2 low = float2(internal::cast_from_f8<float, true>(
-                            static_cast<__hip_fp8_storage_t>((fp8x2_low << 8) >> 8), __wm, __we),
-                        internal::cast_from_f8<float, true>(
-                            static_cast<__hip_fp8_storage_t>(fp8x2_low >> 8), __wm, __we));
-#endif
-    return float4(low.x, low.y, high.x, high.y);
+    return __hip_cvt_fp8x4_to_float4(__x, __default_interpret);
   }
 };
 
@@ -2509,19 +2606,7 @@ struct __hip_fp8x4_e4m3 {
 #else
   __FP8_HOST__ __hip_fp8x4_e4m3(const float4 val)
 #endif
-      : __x{reinterpret_cast<__hip_fp8x4_storage_t>(
-            static_cast<unsigned int>(reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.x, __default_saturation, __default_interpret)) |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.y, __default_saturation, __default_interpret))
-                                          << 8 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.z, __default_saturation, __default_interpret))
-                                          << 16 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.w, __default_saturation, __default_interpret))
-                                          << 24))} {
-  }
+      : __x{__hip_cvt_float4_to_fp8x4(val, __default_saturation, __default_interpret)} {}
 
   /*! create fp8x4 e4m3 type from two __hip_bfloat162 */
 #if HIP_FP8_TYPE_OCP
@@ -2564,23 +2649,7 @@ struct __hip_fp8x4_e4m3 {
 #else
   __FP8_HOST__ operator float4() const {
 #endif
-    auto x = __x;                                                // bypass const
-    auto fp8x2_low = *reinterpret_cast<__hip_fp8x2_storage_t*>(&x);  // Little E
-    auto fp8x2_high = *(reinterpret_cast<__hip_fp8x2_storage_t*>(&x) + 1);
-#if HIP_FP8_CVT_FAST_PATH
-    float2 high = internal::cast_to_f32x2_from_f8x2(fp8x2_high, __default_interpret);
-    float2 low = internal::cast_to_f32x2_from_f8x2(fp8x2_low, __default_interpret);
-#else
-    float2 high = float2(internal::cast_from_f8<float, false>(
-                             static_cast<__hip_fp8_storage_t>((fp8x2_high << 8) >> 8), __wm, __we),
-                         internal::cast_from_f8<float, false>(
-                             static_cast<__hip_fp8_storage_t>(fp8x2_high >> 8), __wm, __we));
-    float2 low = float2(internal::cast_from_f8<float, false>(
-                            static_cast<__hip_fp8_storage_t>((fp8x2_low << 8) >> 8), __wm, __we),
-                        internal::cast_from_f8<float, false>(
-                            static_cast<__hip_fp8_storage_t>(fp8x2_low >> 8), __wm, __we));
-#endif
-    return float4(low.x, low.y, high.x, high.y);
+    return __hip_cvt_fp8x4_to_float4(__x, __default_interpret);
   }
 };
 
@@ -3072,19 +3141,7 @@ struct __hip_fp8x4_e5m2 {
 #else
   __FP8_HOST__ __hip_fp8x4_e5m2(const float4 val)
 #endif
-      : __x(reinterpret_cast<__hip_fp8x4_storage_t>(
-            static_cast<unsigned int>(reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.x, __default_saturation, __default_interpret)) |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.y, __default_saturation, __default_interpret))
-                                          << 8 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.z, __default_saturation, __default_interpret))
-                                          << 16 |
-                                      reinterpret_cast<unsigned char>(__hip_cvt_float_to_fp8(
-                                          val.w, __default_saturation, __default_interpret))
-                                          << 24))) {
-  }
+      : __x{__hip_cvt_float4_to_fp8x4(val, __default_saturation, __default_interpret)} {}
 
   /*! create fp8x4 e5m2 type from two __hip_bfloat162 */
 #if HIP_FP8_TYPE_OCP
@@ -3127,27 +3184,7 @@ struct __hip_fp8x4_e5m2 {
 #else
   __FP8_HOST__ operator float4() const {
 #endif
-    auto x = __x;                                                // bypass const
-    auto fp8x2_low = *reinterpret_cast<__hip_fp8x2_storage_t*>(&x);  // Little E
-    auto fp8x2_high = *(reinterpret_cast<__hip_fp8x2_storage_t*>(&x) + 1);
-#if HIP_FP8_CVT_FAST_PATH
-    float2 high = internal::cast_to_f32x2_from_f8x2(fp8x2_high, __default_interpret);
-    float2 low = internal::cast_to_f32x2_from_f8x2(fp8x2_low, __default_interpret);
-#else
-    float2 high = float2(
-        internal::cast_from_f8<float, false>(
-            static_cast<__hip_fp8_storage_t>((fp8x2_high << 8) >> 8), __wm, __we,
-            __default_saturation == __HIP_SATFINITE),
-        internal::cast_from_f8<float, false>(static_cast<__hip_fp8_storage_t>(fp8x2_high >> 8),
-                                             __wm, __we, __default_saturation == __HIP_SATFINITE));
-    float2 low = float2(
-        internal::cast_from_f8<float, false>(
-            static_cast<__hip_fp8_storage_t>((fp8x2_low << 8) >> 8), __wm, __we,
-            __default_saturation == __HIP_SATFINITE),
-        internal::cast_from_f8<float, false>(static_cast<__hip_fp8_storage_t>(fp8x2_low >> 8), __wm,
-                                             __we, __default_saturation == __HIP_SATFINITE));
-#endif
-    return float4(low.x, low.y, high.x, high.y);
+    return __hip_cvt_fp8x4_to_float4(__x, __default_interpret);
   }
 };
 #endif // ENABLE_OCP_HIPRTC
@@ -451,7 +451,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename U,
             typename std::enable_if<
                 std::is_convertible<U, T>::value>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         explicit
         constexpr
         HIP_vector_type(U x_) noexcept
@@ -461,7 +461,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename... Us,
             typename std::enable_if<
                 (rank > 1) && sizeof...(Us) == rank>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         constexpr
         HIP_vector_type(Us... xs) noexcept
             : HIP_vector_base<T, rank>{static_cast<T>(xs)...}
@@ -475,18 +475,19 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         __HOST_DEVICE__
         ~HIP_vector_type() = default;
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator=(const HIP_vector_type&) = default;
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator=(HIP_vector_type&&) = default;
 
-        // Operators
-        __HOST_DEVICE__
+        // Operators. They are forced inline, so the native vector operations and the wide
+        // loads and stores of data survive -O0 and the nested template instantiations
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator++() noexcept
         {
             return *this += HIP_vector_type{1};
         }
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type operator++(int) noexcept
         {
             auto tmp(*this);
@@ -494,12 +495,12 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             return tmp;
         }
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator--() noexcept
         {
             return *this -= HIP_vector_type{1};
         }
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type operator--(int) noexcept
         {
             auto tmp(*this);
@@ -507,7 +508,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             return tmp;
         }
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator+=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -521,13 +522,13 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename U,
             typename std::enable_if<
                 std::is_convertible<U, T>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator+=(U x) noexcept
         {
             return *this += HIP_vector_type{x};
         }
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator-=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -541,13 +542,13 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename U,
             typename std::enable_if<
                 std::is_convertible<U, T>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator-=(U x) noexcept
         {
             return *this -= HIP_vector_type{x};
         }
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator*=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -558,7 +559,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             return *this;
         }
 
-        friend __HOST_DEVICE__ inline constexpr HIP_vector_type operator*(
+        friend __forceinline__ __HOST_DEVICE__ constexpr HIP_vector_type operator*(
         HIP_vector_type x, const HIP_vector_type& y) noexcept
         {
           return HIP_vector_type{ x } *= y;
@@ -568,19 +569,19 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename U,
             typename std::enable_if<
                 std::is_convertible<U, T>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator*=(U x) noexcept
         {
             return *this *= HIP_vector_type{x};
         }
 
-        friend __HOST_DEVICE__ inline constexpr HIP_vector_type operator/(
+        friend __forceinline__ __HOST_DEVICE__ constexpr HIP_vector_type operator/(
         HIP_vector_type x, const HIP_vector_type& y) noexcept
         {
           return HIP_vector_type{ x } /= y;
         }
 
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator/=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -594,7 +595,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
             typename U,
             typename std::enable_if<
                 std::is_convertible<U, T>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator/=(U x) noexcept
         {
             return *this /= HIP_vector_type{x};
@@ -603,7 +604,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_signed<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type operator-() const noexcept
         {
             auto tmp(*this);
@@ -618,7 +619,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type operator~() const noexcept
         {
             HIP_vector_type r{*this};
@@ -633,7 +634,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator%=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -647,7 +648,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator^=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -661,7 +662,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator|=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -675,7 +676,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator&=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -689,7 +690,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator>>=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -703,7 +704,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         template<
             typename U = T,
             typename std::enable_if<std::is_integral<U>{}>::type* = nullptr>
-        __HOST_DEVICE__
+        __forceinline__ __HOST_DEVICE__
         HIP_vector_type& operator<<=(const HIP_vector_type& x) noexcept
         {
 #if __HIP_USE_NATIVE_VECTOR__
@@ -716,8 +717,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     };
 
     template<typename T, unsigned int n>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator+(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -725,8 +725,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} += y;
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator+(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -734,8 +733,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} += HIP_vector_type<T, n>{y};
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator+(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -744,8 +742,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename T, unsigned int n>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator-(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -753,8 +750,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} -= y;
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator-(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -762,8 +758,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} -= HIP_vector_type<T, n>{y};
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator-(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -772,8 +767,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator*(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -781,8 +775,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} *= HIP_vector_type<T, n>{y};
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator*(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -791,8 +784,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator/(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -800,8 +792,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return HIP_vector_type<T, n>{x} /= HIP_vector_type<T, n>{y};
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator/(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -810,8 +801,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename V>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool _hip_compare(const V& x, const V& y, int n) noexcept
     {
@@ -820,8 +810,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename T, unsigned int n>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator==(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -829,16 +818,14 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return _hip_compare(x.data, y.data, n - 1);
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator==(const HIP_vector_type<T, n>& x, U y) noexcept
     {
         return x == HIP_vector_type<T, n>{y};
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator==(U x, const HIP_vector_type<T, n>& y) noexcept
     {
@@ -846,8 +833,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
     }
 
     template<typename T, unsigned int n>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator!=(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -855,16 +841,14 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         return !(x == y);
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator!=(const HIP_vector_type<T, n>& x, U y) noexcept
     {
         return !(x == y);
     }
     template<typename T, unsigned int n, typename U>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     bool operator!=(U x, const HIP_vector_type<T, n>& y) noexcept
     {
@@ -875,8 +859,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator%(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -888,8 +871,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator%(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -901,8 +883,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator%(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -914,8 +895,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator^(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -927,8 +907,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator^(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -940,8 +919,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator^(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -953,8 +931,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator|(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -966,8 +943,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator|(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -979,8 +955,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator|(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -992,8 +967,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator&(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -1005,8 +979,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator&(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -1018,8 +991,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator&(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -1031,8 +1003,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator>>(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -1044,8 +1015,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator>>(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -1057,8 +1027,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator>>(
         U x, const HIP_vector_type<T, n>& y) noexcept
@@ -1070,8 +1039,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename T,
         unsigned int n,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator<<(
         const HIP_vector_type<T, n>& x, const HIP_vector_type<T, n>& y) noexcept
@@ -1083,8 +1051,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         unsigned int n,
         typename U,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator<<(
         const HIP_vector_type<T, n>& x, U y) noexcept
@@ -1097,8 +1064,7 @@ template <typename __T> struct is_scalar : public integral_constant<bool, __is_s
         typename U,
         typename std::enable_if<std::is_arithmetic<U>::value>::type,
         typename std::enable_if<std::is_integral<T>{}>* = nullptr>
-    __HOST_DEVICE__
-    inline
+    __forceinline__ __HOST_DEVICE__
     constexpr
     HIP_vector_type<T, n> operator<<(
         U x, const HIP_vector_type<T, n>& y) noexcept
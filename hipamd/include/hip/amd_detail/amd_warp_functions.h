@@ -543,4 +543,132 @@ unsigned long long __shfl_xor(MAYBE_UNDEF unsigned long long var, int lane_mask,
     return tmp1;
 }
 
+// Wave-wide reduction and scan. The operator is a functor with T operator()(T, T) const, the
+// reductions require a commutative and associative operator, the scans an associative one. T
+// must be a 32-bit type, e.g. int, float or __half2. All lanes of the wave must be active.
+// Width reduces and scans independent groups of Width consecutive lanes, as the tiles do.
+// The lanes exchange the values with DPP inside the rows of 16 lanes, then with permlanex16
+// or readlane between the rows.
+
+template <typename T>
+__device__ static inline int __hip_wave_as_int(T v) {
+    static_assert(sizeof(T) == sizeof(int), "Only 32-bit types are supported");
+    int i; __builtin_memcpy(&i, &v, sizeof(i));
+    return i;
+}
+
+template <typename T>
+__device__ static inline T __hip_wave_from_int(int i) {
+    T v; __builtin_memcpy(&v, &i, sizeof(v));
+    return v;
+}
+
+template <int dpp_ctrl, typename T>
+__device__ static inline T __hip_wave_dpp(T v) {
+    return __hip_wave_from_int<T>(__hip_move_dpp_N<dpp_ctrl, 0xf, 0xf, false>(
+        __hip_wave_as_int(v)));
+}
+
+template <typename T>
+__device__ static inline T __hip_wave_readlane(T v, int lane) {
+    return __hip_wave_from_int<T>(__builtin_amdgcn_readlane(__hip_wave_as_int(v), lane));
+}
+
+// Returns the value of the lane 16 lanes apart, i.e. of the other row in the 32 lanes
+template <typename T>
+__device__ static inline T __hip_wave_swap_rows(T v) {
+#if (defined(__GFX10__) || defined(__GFX11__) || defined(__GFX12__))
+    return __hip_wave_from_int<T>(__builtin_amdgcn_permlanex16(
+        __hip_wave_as_int(v), __hip_wave_as_int(v), 0x76543210, 0xfedcba98, false, false));
+#else
+    return __hip_wave_from_int<T>(__builtin_amdgcn_ds_swizzle(__hip_wave_as_int(v), 0x401f));
+#endif
+}
+
+// Returns the value of the lane delta lanes below, the lanes under delta keep their value
+template <typename T>
+__device__ static inline T __hip_wave_shift_up(T v, unsigned int delta) {
+    const unsigned int lane = __lane_id();
+    const int src = (lane >= delta) ? (lane - delta) : lane;
+    return __hip_wave_from_int<T>(__builtin_amdgcn_ds_bpermute(src << 2, __hip_wave_as_int(v)));
+}
+
+template <unsigned int Width = warpSize, typename T, typename Op>
+__device__ inline T __hip_wave_reduce(T v, Op op) {
+    static_assert((Width != 0) && ((Width & (Width - 1)) == 0) && (Width <= warpSize),
+                  "Width must be a power of 2 up to the wavefront size");
+    if (Width > 1) v = op(v, __hip_wave_dpp<0xb1>(v));   // quad_perm:[1,0,3,2]
+    if (Width > 2) v = op(v, __hip_wave_dpp<0x4e>(v));   // quad_perm:[2,3,0,1]
+    if (Width > 4) v = op(v, __hip_wave_dpp<0x141>(v));  // row_half_mirror
+    if (Width > 8) v = op(v, __hip_wave_dpp<0x140>(v));  // row_mirror
+    if (Width == warpSize && Width > 16) {
+        // The row results are uniform, combine them in the scalar unit
+        T r = __hip_wave_readlane(v, 0);
+        for (int row = 16; row < warpSize; row += 16) {
+            r = op(r, __hip_wave_readlane(v, row));
+        }
+        return r;
+    }
+    if (Width > 16) v = op(v, __hip_wave_swap_rows(v));
+    return v;
+}
+
+template <unsigned int Width = warpSize, typename T, typename Op>
+__device__ inline T __hip_wave_inclusive_scan(T v, Op op) {
+    static_assert((Width != 0) && ((Width & (Width - 1)) == 0) && (Width <= warpSize),
+                  "Width must be a power of 2 up to the wavefront size");
+    const unsigned int rank = __lane_id() & (Width - 1);
+    // Kogge-Stone inside the rows, row_shr:n
+    T t;
+    if (Width > 1) { t = __hip_wave_dpp<0x111>(v); v = (rank >= 1) ? op(t, v) : v; }
+    if (Width > 2) { t = __hip_wave_dpp<0x112>(v); v = (rank >= 2) ? op(t, v) : v; }
+    if (Width > 4) { t = __hip_wave_dpp<0x114>(v); v = (rank >= 4) ? op(t, v) : v; }
+    if (Width > 8) { t = __hip_wave_dpp<0x118>(v); v = (rank >= 8) ? op(t, v) : v; }
+    if (Width > 16) {
+        // Carry the last lane of each row into the next row of the same group, in the row order
+        const unsigned int row = __lane_id() / 16;
+        for (unsigned int r = 1; r < warpSize / 16; ++r) {
+            if ((r % (Width / 16)) != 0) {
+                t = __hip_wave_readlane(v, 16 * r - 1);
+                v = (row == r) ? op(t, v) : v;
+            }
+        }
+    }
+    return v;
+}
+
+template <unsigned int Width = warpSize, typename T, typename Op>
+__device__ inline T __hip_wave_exclusive_scan(T v, Op op, T identity) {
+    v = __hip_wave_inclusive_scan<Width>(v, op);
+    T t = __hip_wave_shift_up(v, 1);
+    return ((__lane_id() & (Width - 1)) == 0) ? identity : t;
+}
+
+// Reduces the segments of the wave, a segment starts at each lane with head set and at lane 0.
+// Every lane returns the reduction of its segment
+template <typename T, typename Op>
+__device__ inline T __hip_wave_segmented_reduce(T v, Op op, bool head) {
+    const unsigned int lane = __lane_id();
+    const unsigned long long heads = __ballot(head) | 1ull;
+    const unsigned long long below = (2ull << lane) - 1;
+    const unsigned int first = 63 - __builtin_clzll(heads & below);
+    const unsigned long long above = heads & ~below;
+    const unsigned int last = (above != 0) ? (__builtin_ctzll(above) - 1) : (warpSize - 1);
+    // Segmented scan inside the rows, the first lane of the segment or the row stops it
+    const unsigned int rank = lane - ((first > (lane & ~15u)) ? first : (lane & ~15u));
+    T t;
+    t = __hip_wave_dpp<0x111>(v); v = (rank >= 1) ? op(t, v) : v;
+    t = __hip_wave_dpp<0x112>(v); v = (rank >= 2) ? op(t, v) : v;
+    t = __hip_wave_dpp<0x114>(v); v = (rank >= 4) ? op(t, v) : v;
+    t = __hip_wave_dpp<0x118>(v); v = (rank >= 8) ? op(t, v) : v;
+    // Carry the segments, which continue from the previous row
+    for (unsigned int r = 1; r < warpSize / 16; ++r) {
+        t = __hip_wave_readlane(v, 16 * r - 1);
+        v = ((lane / 16 == r) && (first < 16 * r)) ? op(t, v) : v;
+    }
+    // The last lane of the segment holds the total
+    return __hip_wave_from_int<T>(
+        __builtin_amdgcn_ds_bpermute(static_cast<int>(last << 2), __hip_wave_as_int(v)));
+}
+
 #endif
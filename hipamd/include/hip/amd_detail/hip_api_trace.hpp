@@ -61,7 +61,7 @@
 // - Reset any of the *_STEP_VERSION defines to zero if the corresponding *_MAJOR_VERSION increases
 #define HIP_API_TABLE_STEP_VERSION 0
 #define HIP_COMPILER_API_TABLE_STEP_VERSION 0
-#define HIP_RUNTIME_API_TABLE_STEP_VERSION 6
+#define HIP_RUNTIME_API_TABLE_STEP_VERSION 20
 
 // HIP API interface
 typedef hipError_t (*t___hipPopCallConfiguration)(dim3* gridDim, dim3* blockDim, size_t* sharedMem,
@@ -1004,6 +1004,53 @@ typedef hipError_t (*t_hipExtHostAlloc)(void **ptr, size_t size,
 typedef hipError_t (*t_hipDeviceGetTexture1DLinearMaxWidth)(size_t *maxWidthInElements,
                                                             const hipChannelFormatDesc *fmtDesc,
                                                             int device);
+
+typedef hipError_t (*t_hipExtStreamGetLaunchLatency)(hipStream_t stream, unsigned int interval,
+                                                     uint64_t* bins, unsigned int numBins);
+
+typedef hipError_t (*t_hipExtMemcpyPeerBroadcastAsync)(void* const* dsts, const int* dstDevices,
+                                                       unsigned int numDsts, const void* src,
+                                                       int srcDevice, size_t sizeBytes,
+                                                       hipStream_t stream);
+
+typedef hipError_t (*t_hipExtMemMapBatch)(void* ptr, const hipMemGenericAllocationHandle_t* handles,
+                                          const size_t* sizes, unsigned int count,
+                                          const hipMemAccessDesc* desc, size_t descCount);
+
+typedef hipError_t (*t_hipExtMemMapAsync)(void* ptr, size_t size, size_t offset,
+                                          hipMemGenericAllocationHandle_t handle,
+                                          unsigned long long flags, hipStream_t stream);
+
+typedef hipError_t (*t_hipExtMemUnmapAsync)(void* ptr, size_t size, hipStream_t stream);
+
+typedef hipError_t (*t_hipExtDevicesSynchronize)(const int* devices, unsigned int numDevices);
+
+typedef hipError_t (*t_hipExtMemPrefetchBatchAsync)(const void* const* dev_ptrs,
+                                                    const size_t* counts, size_t numRanges,
+                                                    int device, hipStream_t stream);
+
+typedef hipError_t (*t_hipExtMemPrintAllocReport)(hipMemPool_t mem_pool);
+
+typedef hipError_t (*t_hipExtStreamSetCUMask)(hipStream_t stream, uint32_t cuMaskSize,
+                                              const uint32_t* cuMask);
+typedef hipError_t (*t_hipExtStreamsPartitionCUs)(const hipStream_t* streams,
+                                                  const float* weights, uint32_t numStreams);
+
+typedef hipError_t (*t_hipExtCreateTextureObjects)(hipTextureObject_t* pTexObjects,
+                                                   const hipResourceDesc* pResDescs,
+                                                   const hipTextureDesc* pTexDescs,
+                                                   const hipResourceViewDesc* pResViewDescs,
+                                                   unsigned int numObjects);
+typedef hipError_t (*t_hipExtMemcpyBatchAsync)(void* const* dsts, const void* const* srcs,
+                                               const size_t* sizes, size_t count,
+                                               hipStream_t stream);
+typedef hipError_t (*t_hipExtMemsetPatternAsync)(void* dst, const void* pattern,
+                                                 size_t patternSize, size_t count,
+                                                 hipStream_t stream);
+typedef hipError_t (*t_hipExtHostRegisterAsync)(void* hostPtr, size_t sizeBytes, unsigned int flags,
+                                                hipStream_t stream);
+typedef hipError_t (*t_hipExtExternalMemoryPin)(hipExternalMemory_t extMem);
+typedef hipError_t (*t_hipExtExternalMemoryUnpin)(hipExternalMemory_t extMem);
 // HIP Compiler dispatch table
 struct HipCompilerDispatchTable {
   // HIP_COMPILER_API_TABLE_STEP_VERSION == 0
@@ -1519,8 +1566,52 @@ struct HipDispatchTable {
   // HIP_RUNTIME_API_TABLE_STEP_VERSION == 6
   t_hipDeviceGetTexture1DLinearMaxWidth hipDeviceGetTexture1DLinearMaxWidth_fn;
 
-  // DO NOT EDIT ABOVE!
   // HIP_RUNTIME_API_TABLE_STEP_VERSION == 7
+  t_hipExtStreamGetLaunchLatency hipExtStreamGetLaunchLatency_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 8
+  t_hipExtMemcpyPeerBroadcastAsync hipExtMemcpyPeerBroadcastAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 9
+  t_hipExtMemMapBatch hipExtMemMapBatch_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 10
+  t_hipExtMemMapAsync hipExtMemMapAsync_fn;
+  t_hipExtMemUnmapAsync hipExtMemUnmapAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 11
+  t_hipExtDevicesSynchronize hipExtDevicesSynchronize_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 12
+  t_hipExtMemPrefetchBatchAsync hipExtMemPrefetchBatchAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 13
+  t_hipExtMemPrintAllocReport hipExtMemPrintAllocReport_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 14
+  t_hipExtStreamSetCUMask hipExtStreamSetCUMask_fn;
+  t_hipExtStreamsPartitionCUs hipExtStreamsPartitionCUs_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 15
+  t_hipExtCreateTextureObjects hipExtCreateTextureObjects_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 16
+  t_hipExtMemcpyBatchAsync hipExtMemcpyBatchAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 17
+  t_hipExtMemsetPatternAsync hipExtMemsetPatternAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 18
+  t_hipExtHostRegisterAsync hipExtHostRegisterAsync_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 19
+  t_hipExtExternalMemoryPin hipExtExternalMemoryPin_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 20
+  t_hipExtExternalMemoryUnpin hipExtExternalMemoryUnpin_fn;
+
+  // DO NOT EDIT ABOVE!
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 21
 
   // ******************************************************************************************* //
   //
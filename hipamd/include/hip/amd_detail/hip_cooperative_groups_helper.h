@@ -184,7 +184,80 @@ __CG_STATIC_QUALIFIER__ uint32_t thread_rank() {
 
 __CG_STATIC_QUALIFIER__ bool is_valid() { return static_cast<bool>(__ockl_grid_is_valid()); }
 
-__CG_STATIC_QUALIFIER__ void sync() { __ockl_grid_sync(); }
+#if defined(HIP_GRID_SYNC_HIERARCHICAL)
+// The single grid part of the runtime sync info, which the hidden multigrid sync argument of the
+// code object v5 points to
+struct grid_sync_info {
+  void* mgs;
+  uint32_t grid_id;
+  uint32_t num_grids;
+  uint64_t prev_sum;
+  uint64_t all_sum;
+  uint32_t w0;
+  uint32_t w1;
+  uint32_t num_wg;
+  uint32_t* grid_sync;  // Zeroed counters, the barrier leaves them zeroed
+};
+
+// The workgroups arrive on one of the group counters, the last arrival of each group arrives on
+// the global counter and the last global arrival bumps the generation, which the workgroups
+// poll. The groups follow the round robin dispatch of the workgroups between the XCDs, hence
+// the arrivals of an XCD share a counter and no cache line sees all workgroups.
+constexpr uint32_t kGridSyncLine = 32;    // 128 bytes in the counters
+constexpr uint32_t kGridSyncGroups = 8;
+constexpr uint32_t kGridSyncGeneration = 0;
+constexpr uint32_t kGridSyncGlobal = kGridSyncLine;
+constexpr uint32_t kGridSyncGroup = 2 * kGridSyncLine;
+constexpr uint32_t kGridSyncArgOffset = 96;  // hidden_multigrid_sync_arg
+
+__CG_STATIC_QUALIFIER__ void hierarchical_sync(uint32_t* counters, uint32_t num_wg) {
+  __syncthreads();
+  if ((threadIdx.x | threadIdx.y | threadIdx.z) == 0) {
+    const uint32_t wg = static_cast<uint32_t>((blockIdx.z * gridDim.y * gridDim.x) +
+                                              (blockIdx.y * gridDim.x) + blockIdx.x);
+    const uint32_t groups = (num_wg < kGridSyncGroups) ? num_wg : kGridSyncGroups;
+    const uint32_t group = wg % groups;
+    const uint32_t group_wgs = num_wg / groups + ((group < (num_wg % groups)) ? 1 : 0);
+    uint32_t* generation = counters + kGridSyncGeneration;
+    uint32_t* group_count = counters + kGridSyncGroup + group * kGridSyncLine;
+
+    const uint32_t gen =
+        __hip_atomic_load(generation, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT);
+    __builtin_amdgcn_fence(__ATOMIC_RELEASE, "agent");
+    if (__hip_atomic_fetch_add(group_count, 1u, __ATOMIC_ACQ_REL, __HIP_MEMORY_SCOPE_AGENT) ==
+        group_wgs - 1) {
+      // The group can't arrive again before the generation changes, reset it for the next sync
+      __hip_atomic_store(group_count, 0u, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT);
+      uint32_t* global_count = counters + kGridSyncGlobal;
+      if (__hip_atomic_fetch_add(global_count, 1u, __ATOMIC_ACQ_REL, __HIP_MEMORY_SCOPE_AGENT) ==
+          groups - 1) {
+        __hip_atomic_store(global_count, 0u, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT);
+        __hip_atomic_fetch_add(generation, 1u, __ATOMIC_RELEASE, __HIP_MEMORY_SCOPE_AGENT);
+      }
+    }
+    while (__hip_atomic_load(generation, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT) == gen) {
+      __builtin_amdgcn_s_sleep(1);
+    }
+    __builtin_amdgcn_fence(__ATOMIC_ACQUIRE, "agent");
+  }
+  __syncthreads();
+}
+#endif // HIP_GRID_SYNC_HIERARCHICAL
+
+// Define HIP_GRID_SYNC_HIERARCHICAL to use the hierarchical barrier over the counters from the
+// runtime, it falls back to the device library barrier on the runtimes without the counters
+__CG_STATIC_QUALIFIER__ void sync() {
+#if defined(HIP_GRID_SYNC_HIERARCHICAL)
+  const char* implicitarg = (const char*)__builtin_amdgcn_implicitarg_ptr();
+  const grid_sync_info* info =
+      *reinterpret_cast<const grid_sync_info* const*>(implicitarg + kGridSyncArgOffset);
+  if ((info != nullptr) && (info->grid_sync != nullptr)) {
+    hierarchical_sync(info->grid_sync, info->num_wg);
+    return;
+  }
+#endif // HIP_GRID_SYNC_HIERARCHICAL
+  __ockl_grid_sync();
+}
 
 }  // namespace grid
 
@@ -95,6 +95,155 @@ __device__ inline static double __ldg(const double* ptr) { return ptr[0]; }
 
 __device__ inline static double2 __ldg(const double2* ptr) { return ptr[0]; }
 
+
+// Cache policy loads and stores. The compiler maps the policy to the cache bits of the target:
+// the streaming forms are non-temporal (slc on gfx9 to gfx11, nt on gfx94x), the global forms
+// skip the per CU cache and keep the line in L2 (glc on gfx9, sc1 on gfx94x, glc dlc on gfx10+)
+// and the system forms skip L2 too, for the data shared with the host or the peers.
+// The types must be trivially copyable. The types of 8 and 16 bytes keep a single wide access in
+// the streaming forms, such as float4, int4 or a struct of eight __half.
+enum __hip_cache_policy {
+  __hip_cache_streaming = 0,  // Once touched data, doesn't pollute the caches
+  __hip_cache_global,         // Cached in L2 only
+  __hip_cache_system          // Not cached, coherent with the host
+};
+
+template <__hip_cache_policy policy, typename W>
+__device__ inline static W __hip_load_word(const W* ptr) {
+  if constexpr (policy == __hip_cache_streaming) {
+    return __builtin_nontemporal_load(ptr);
+  } else if constexpr (policy == __hip_cache_global) {
+    return __hip_atomic_load(ptr, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT);
+  } else {
+    return __hip_atomic_load(ptr, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_SYSTEM);
+  }
+}
+
+template <__hip_cache_policy policy, typename W>
+__device__ inline static void __hip_store_word(W* ptr, W value) {
+  if constexpr (policy == __hip_cache_streaming) {
+    __builtin_nontemporal_store(value, ptr);
+  } else if constexpr (policy == __hip_cache_global) {
+    __hip_atomic_store(ptr, value, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_AGENT);
+  } else {
+    __hip_atomic_store(ptr, value, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_SYSTEM);
+  }
+}
+
+template <__hip_cache_policy policy, typename T>
+__device__ inline static T __hip_load_cache_policy(const T* ptr) {
+  static_assert(__is_trivially_copyable(T), "The type must be trivially copyable");
+  static_assert(sizeof(T) <= 2 || sizeof(T) % 4 == 0, "The type size must be 1, 2 or 4N bytes");
+  T value;
+  if constexpr (sizeof(T) == 1) {
+    unsigned char w = __hip_load_word<policy>(reinterpret_cast<const unsigned char*>(ptr));
+    __builtin_memcpy(&value, &w, sizeof(T));
+  } else if constexpr (sizeof(T) == 2) {
+    unsigned short w = __hip_load_word<policy>(reinterpret_cast<const unsigned short*>(ptr));
+    __builtin_memcpy(&value, &w, sizeof(T));
+  } else if constexpr (sizeof(T) % 8 == 0) {
+    // The atomic forms split the access into 8 byte words, the streaming forms keep it wide
+    typedef unsigned long long __hip_word_vec __attribute__((ext_vector_type(2)));
+    if constexpr (policy == __hip_cache_streaming && sizeof(T) % 16 == 0) {
+      const __hip_word_vec* src = reinterpret_cast<const __hip_word_vec*>(ptr);
+      __hip_word_vec* dst = reinterpret_cast<__hip_word_vec*>(&value);
+      for (unsigned int i = 0; i < sizeof(T) / 16; ++i) {
+        dst[i] = __hip_load_word<policy>(src + i);
+      }
+    } else {
+      const unsigned long long* src = reinterpret_cast<const unsigned long long*>(ptr);
+      unsigned long long* dst = reinterpret_cast<unsigned long long*>(&value);
+      for (unsigned int i = 0; i < sizeof(T) / 8; ++i) {
+        dst[i] = __hip_load_word<policy>(src + i);
+      }
+    }
+  } else {
+    const unsigned int* src = reinterpret_cast<const unsigned int*>(ptr);
+    unsigned int* dst = reinterpret_cast<unsigned int*>(&value);
+    for (unsigned int i = 0; i < sizeof(T) / 4; ++i) {
+      dst[i] = __hip_load_word<policy>(src + i);
+    }
+  }
+  return value;
+}
+
+template <__hip_cache_policy policy, typename T>
+__device__ inline static void __hip_store_cache_policy(T* ptr, const T& value) {
+  static_assert(__is_trivially_copyable(T), "The type must be trivially copyable");
+  static_assert(sizeof(T) <= 2 || sizeof(T) % 4 == 0, "The type size must be 1, 2 or 4N bytes");
+  if constexpr (sizeof(T) == 1) {
+    unsigned char w;
+    __builtin_memcpy(&w, &value, sizeof(T));
+    __hip_store_word<policy>(reinterpret_cast<unsigned char*>(ptr), w);
+  } else if constexpr (sizeof(T) == 2) {
+    unsigned short w;
+    __builtin_memcpy(&w, &value, sizeof(T));
+    __hip_store_word<policy>(reinterpret_cast<unsigned short*>(ptr), w);
+  } else if constexpr (sizeof(T) % 8 == 0) {
+    typedef unsigned long long __hip_word_vec __attribute__((ext_vector_type(2)));
+    if constexpr (policy == __hip_cache_streaming && sizeof(T) % 16 == 0) {
+      const __hip_word_vec* src = reinterpret_cast<const __hip_word_vec*>(&value);
+      __hip_word_vec* dst = reinterpret_cast<__hip_word_vec*>(ptr);
+      for (unsigned int i = 0; i < sizeof(T) / 16; ++i) {
+        __hip_store_word<policy>(dst + i, src[i]);
+      }
+    } else {
+      const unsigned long long* src = reinterpret_cast<const unsigned long long*>(&value);
+      unsigned long long* dst = reinterpret_cast<unsigned long long*>(ptr);
+      for (unsigned int i = 0; i < sizeof(T) / 8; ++i) {
+        __hip_store_word<policy>(dst + i, src[i]);
+      }
+    }
+  } else {
+    const unsigned int* src = reinterpret_cast<const unsigned int*>(&value);
+    unsigned int* dst = reinterpret_cast<unsigned int*>(ptr);
+    for (unsigned int i = 0; i < sizeof(T) / 4; ++i) {
+      __hip_store_word<policy>(dst + i, src[i]);
+    }
+  }
+}
+
+// Loads cached at all levels, as __ldg
+template <typename T> __device__ inline static T __ldca(const T* ptr) { return ptr[0]; }
+
+// Loads cached in L2 only
+template <typename T> __device__ inline static T __ldcg(const T* ptr) {
+  return __hip_load_cache_policy<__hip_cache_global>(ptr);
+}
+
+// Streaming loads of once touched data
+template <typename T> __device__ inline static T __ldcs(const T* ptr) {
+  return __hip_load_cache_policy<__hip_cache_streaming>(ptr);
+}
+
+// Loads of the last use of the data
+template <typename T> __device__ inline static T __ldlu(const T* ptr) {
+  return __hip_load_cache_policy<__hip_cache_streaming>(ptr);
+}
+
+// Loads fetching again on every access, coherent with the host writes
+template <typename T> __device__ inline static T __ldcv(const T* ptr) {
+  return __hip_load_cache_policy<__hip_cache_system>(ptr);
+}
+
+// Write back stores, cached at all levels
+template <typename T> __device__ inline static void __stwb(T* ptr, T value) { ptr[0] = value; }
+
+// Stores cached in L2 only
+template <typename T> __device__ inline static void __stcg(T* ptr, T value) {
+  __hip_store_cache_policy<__hip_cache_global>(ptr, value);
+}
+
+// Streaming stores of the data, which isn't read again soon
+template <typename T> __device__ inline static void __stcs(T* ptr, T value) {
+  __hip_store_cache_policy<__hip_cache_streaming>(ptr, value);
+}
+
+// Write through stores, visible to the host
+template <typename T> __device__ inline static void __stwt(T* ptr, T value) {
+  __hip_store_cache_policy<__hip_cache_system>(ptr, value);
+}
+
 #endif  // __HIP_CLANG_ONLY__
 
 #endif  // HIP_LDG_H
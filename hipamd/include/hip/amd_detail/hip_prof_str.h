@@ -438,6 +438,22 @@ enum hip_api_id_t {
   HIP_API_ID_hipDestroyTextureObject = HIP_API_ID_NONE,
   HIP_API_ID_hipDeviceGetCount = HIP_API_ID_NONE,
   HIP_API_ID_hipDeviceGetTexture1DLinearMaxWidth = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtStreamGetLaunchLatency = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemcpyPeerBroadcastAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemMapBatch = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemMapAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemUnmapAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtDevicesSynchronize = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemPrefetchBatchAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemPrintAllocReport = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtStreamSetCUMask = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtStreamsPartitionCUs = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtCreateTextureObjects = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemcpyBatchAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemsetPatternAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtHostRegisterAsync = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtExternalMemoryPin = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtExternalMemoryUnpin = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureAlignmentOffset = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceDesc = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceViewDesc = HIP_API_ID_NONE,
@@ -6045,6 +6061,38 @@ typedef struct hip_api_data_s {
 #define INIT_hipDeviceGetCount_CB_ARGS_DATA(cb_data) {};
 // hipDeviceGetTexture1DLinearMaxWidth()
 #define INIT_hipDeviceGetTexture1DLinearMaxWidth_CB_ARGS_DATA(cb_data) {};
+// hipExtStreamGetLaunchLatency()
+#define INIT_hipExtStreamGetLaunchLatency_CB_ARGS_DATA(cb_data) {};
+// hipExtMemcpyPeerBroadcastAsync()
+#define INIT_hipExtMemcpyPeerBroadcastAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtMemMapBatch()
+#define INIT_hipExtMemMapBatch_CB_ARGS_DATA(cb_data) {};
+// hipExtMemMapAsync()
+#define INIT_hipExtMemMapAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtMemUnmapAsync()
+#define INIT_hipExtMemUnmapAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtDevicesSynchronize()
+#define INIT_hipExtDevicesSynchronize_CB_ARGS_DATA(cb_data) {};
+// hipExtMemPrefetchBatchAsync()
+#define INIT_hipExtMemPrefetchBatchAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtMemPrintAllocReport()
+#define INIT_hipExtMemPrintAllocReport_CB_ARGS_DATA(cb_data) {};
+// hipExtStreamSetCUMask()
+#define INIT_hipExtStreamSetCUMask_CB_ARGS_DATA(cb_data) {};
+// hipExtStreamsPartitionCUs()
+#define INIT_hipExtStreamsPartitionCUs_CB_ARGS_DATA(cb_data) {};
+// hipExtCreateTextureObjects()
+#define INIT_hipExtCreateTextureObjects_CB_ARGS_DATA(cb_data) {};
+// hipExtMemcpyBatchAsync()
+#define INIT_hipExtMemcpyBatchAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtMemsetPatternAsync()
+#define INIT_hipExtMemsetPatternAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtHostRegisterAsync()
+#define INIT_hipExtHostRegisterAsync_CB_ARGS_DATA(cb_data) {};
+// hipExtExternalMemoryPin()
+#define INIT_hipExtExternalMemoryPin_CB_ARGS_DATA(cb_data) {};
+// hipExtExternalMemoryUnpin()
+#define INIT_hipExtExternalMemoryUnpin_CB_ARGS_DATA(cb_data) {};
 // hipGetTextureAlignmentOffset()
 #define INIT_hipGetTextureAlignmentOffset_CB_ARGS_DATA(cb_data) {};
 // hipGetTextureObjectResourceDesc()
@@ -475,4 +475,69 @@ static __device__ __hip_img_chk__ void texCubemapLayeredGrad(T *ptr, hipTextureO
     *ptr = texCubemapLayeredGrad<T>(textureObject, x, y, z, layer, dPdx, dPdy);
 }
 
+
+// Texture object views with the fetched type fixed at compile time. A view reads the descriptor
+// addresses once, so the loops over a texture reuse the image and sampler descriptors, which the
+// compiler keeps in scalar registers, and every access emits the image instruction directly.
+//
+//   __hip_texture_view<float4> tex(textureObject);
+//   for (int k = 0; k < n; ++k) acc += tex.sample2D(x + k, y);
+template <
+    typename T,
+    typename std::enable_if<__hip_is_tex_surf_channel_type<T>::value>::type* = nullptr>
+struct __hip_texture_view {
+    unsigned int ADDRESS_SPACE_CONSTANT* i;
+    unsigned int ADDRESS_SPACE_CONSTANT* s;
+
+    __device__ __hip_img_chk__ explicit __hip_texture_view(hipTextureObject_t textureObject)
+        : i((unsigned int ADDRESS_SPACE_CONSTANT*)textureObject),
+          s(i + HIP_SAMPLER_OBJECT_OFFSET_DWORD) {}
+
+    __device__ __hip_img_chk__ T fetch1D(int x) const {
+        return __hipMapFrom<T>(__ockl_image_load_1Db(i, x));
+    }
+    __device__ __hip_img_chk__ T sample1D(float x) const {
+        return __hipMapFrom<T>(__ockl_image_sample_1D(i, s, x));
+    }
+    __device__ __hip_img_chk__ T sample2D(float x, float y) const {
+        return __hipMapFrom<T>(__ockl_image_sample_2D(i, s, float2(x, y).data));
+    }
+    __device__ __hip_img_chk__ T sample3D(float x, float y, float z) const {
+        return __hipMapFrom<T>(__ockl_image_sample_3D(i, s, float4(x, y, z, 0.0f).data));
+    }
+    __device__ __hip_img_chk__ T sample2DLod(float x, float y, float level) const {
+        return __hipMapFrom<T>(__ockl_image_sample_lod_2D(i, s, float2(x, y).data, level));
+    }
+    __device__ __hip_img_chk__ T sample3DLod(float x, float y, float z, float level) const {
+        return __hipMapFrom<T>(
+            __ockl_image_sample_lod_3D(i, s, float4(x, y, z, 0.0f).data, level));
+    }
+};
+
+// View of a linear 1D texture read in the element type, T must match the element format of
+// the resource. The linear textures are buffer images, their descriptor is a buffer resource
+// with the base address in dword0 and dword1[15:0] and the element count in dword2, hence the
+// fetch is a plain global load instead of a formatted buffer load. The reads past the end
+// return zero, as the image fetch does.
+template <
+    typename T,
+    typename std::enable_if<__hip_is_tex_surf_channel_type<T>::value>::type* = nullptr>
+struct __hip_linear_texture_view {
+    const T* base;
+    unsigned int count;
+
+    __device__ explicit __hip_linear_texture_view(hipTextureObject_t textureObject) {
+        const unsigned int ADDRESS_SPACE_CONSTANT* i =
+            (const unsigned int ADDRESS_SPACE_CONSTANT*)textureObject;
+        base = reinterpret_cast<const T*>(
+            static_cast<unsigned long long>(i[0]) |
+            (static_cast<unsigned long long>(i[1] & 0xffff) << 32));
+        count = i[2];
+    }
+
+    __device__ T fetch(int x) const {
+        return (static_cast<unsigned int>(x) < count) ? base[x] : T{};
+    }
+};
+
 #endif
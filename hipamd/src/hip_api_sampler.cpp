@@ -0,0 +1,217 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hip_api_sampler.hpp"
+#include "hip_launch_stats.hpp"
+#include "hip/amd_detail/hip_prof_str.h"
+#include "platform/runtime.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace hip {
+
+bool ApiSampler::enabled_ = false;
+uint32_t ApiSampler::rate_ = 0;
+uint64_t ApiSampler::threshold_ = 0;
+
+namespace {
+constexpr size_t kBufferRecords = 4096;
+
+/// Recorded API call
+struct Record {
+  uint64_t start_;           //!< Start timestamp in ticks
+  uint64_t end_;             //!< End timestamp in ticks
+  uint64_t correlation_id_;  //!< Correlation ID of the call
+  uint32_t api_id_;          //!< HIP API ID
+  uint32_t flags_;           //!< ApiSampler record flags
+};
+
+/// Per API statistics of the recorded calls
+struct ApiStats {
+  uint64_t sampled_ = 0;     //!< The number of the randomly sampled calls
+  uint64_t sum_ = 0;         //!< Total time of the sampled calls in ns
+  uint64_t slow_ = 0;        //!< The number of the calls above the threshold
+  uint64_t max_ = 0;         //!< The worst recorded time in ns
+  uint64_t max_id_ = 0;      //!< Correlation ID of the worst call
+};
+
+/// Buffer of the recorded calls of a single thread
+struct ThreadBuffer {
+  std::mutex lock_;              //!< Serializes the owner with the teardown flush
+  std::vector<Record> records_;  //!< Recorded calls, not yet flushed
+};
+
+std::mutex samplerLock;                     //!< Protects the statistics and the buffer list
+std::vector<ThreadBuffer*> threadBuffers;   //!< Buffers of all live threads
+ApiStats apiStats[HIP_API_ID_LAST + 1];     //!< Statistics per API ID
+FILE* recordFile = nullptr;                 //!< Output of the raw records, if requested
+double ticksPerNs = 1.0;                    //!< Timestamp conversion factor
+std::atomic<uint64_t> nextCorrelationId{1}; //!< Correlation IDs without an attached tool
+
+// ================================================================================================
+void FlushRecords(std::vector<Record>& records) {
+  std::lock_guard<std::mutex> lock(samplerLock);
+  for (const auto& record : records) {
+    uint64_t ns = static_cast<uint64_t>((record.end_ - record.start_) / ticksPerNs);
+    ApiStats& stats = apiStats[record.api_id_];
+    if (record.flags_ & ApiSampler::kSampled) {
+      stats.sampled_++;
+      stats.sum_ += ns;
+    }
+    if (record.flags_ & ApiSampler::kSlow) {
+      stats.slow_++;
+    }
+    if (ns > stats.max_) {
+      stats.max_ = ns;
+      stats.max_id_ = record.correlation_id_;
+    }
+    if (recordFile != nullptr) {
+      fprintf(recordFile, "%s,%lu,%lu,%lu,%u\n", hip_api_name(record.api_id_),
+              record.correlation_id_, static_cast<uint64_t>(record.start_ / ticksPerNs), ns,
+              record.flags_);
+    }
+  }
+  records.clear();
+}
+
+/// Registers the buffer of the current thread and flushes it at the thread exit
+struct ThreadBufferHolder {
+  ThreadBuffer* buffer_ = nullptr;
+
+  ThreadBuffer* get() {
+    if (buffer_ == nullptr) {
+      buffer_ = new ThreadBuffer();
+      buffer_->records_.reserve(kBufferRecords);
+      std::lock_guard<std::mutex> lock(samplerLock);
+      threadBuffers.push_back(buffer_);
+    }
+    return buffer_;
+  }
+
+  ~ThreadBufferHolder() {
+    if (buffer_ != nullptr) {
+      {
+        std::lock_guard<std::mutex> lock(buffer_->lock_);
+        FlushRecords(buffer_->records_);
+      }
+      std::lock_guard<std::mutex> lock(samplerLock);
+      threadBuffers.erase(std::find(threadBuffers.begin(), threadBuffers.end(), buffer_));
+      delete buffer_;
+    }
+  }
+};
+
+thread_local ThreadBufferHolder threadBuffer;
+thread_local uint64_t randomState = 0;
+}  // namespace
+
+// ================================================================================================
+void ApiSampler::Init() {
+  if ((HIP_API_SAMPLE_RATE == 0) && (HIP_API_SAMPLE_THRESHOLD == 0)) {
+    return;
+  }
+  ticksPerNs = LaunchStats::TicksPerNs();
+  rate_ = HIP_API_SAMPLE_RATE;
+  threshold_ = static_cast<uint64_t>(HIP_API_SAMPLE_THRESHOLD * 1000 * ticksPerNs);
+  if (HIP_API_SAMPLE_FILE[0] != '\0') {
+    recordFile = fopen(HIP_API_SAMPLE_FILE, "w");
+    if (recordFile == nullptr) {
+      LogPrintfError("Unable to open the API sample file %s", HIP_API_SAMPLE_FILE);
+    } else {
+      fprintf(recordFile, "api,correlation_id,start_ns,duration_ns,flags\n");
+    }
+  }
+  // The runtime teardown flushes the buffers and prints the summary
+  amd::RuntimeTearDown::RegisterObject(new ApiSampler());
+  enabled_ = true;
+}
+
+// ================================================================================================
+uint64_t ApiSampler::NextRandom() {
+  uint64_t x = randomState;
+  if (x == 0) {
+    x = reinterpret_cast<uint64_t>(&randomState) ^ amd::activity_prof::LaunchTimestamp();
+    x |= 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  randomState = x;
+  return x;
+}
+
+// ================================================================================================
+void ApiSampler::End(uint32_t api_id, uint64_t start, bool sampled) {
+  uint64_t end = amd::activity_prof::LaunchTimestamp();
+  bool slow = (threshold_ != 0) && ((end - start) >= threshold_);
+  if (!sampled && !slow) {
+    return;
+  }
+  uint64_t correlation_id = amd::activity_prof::correlation_id;
+  if (correlation_id == 0) {
+    correlation_id = nextCorrelationId.fetch_add(1, std::memory_order_relaxed);
+  }
+  ThreadBuffer* buffer = threadBuffer.get();
+  std::lock_guard<std::mutex> lock(buffer->lock_);
+  buffer->records_.push_back({start, end, correlation_id, api_id,
+                              (sampled ? kSampled : 0) | (slow ? kSlow : 0)});
+  if (buffer->records_.size() >= kBufferRecords) {
+    FlushRecords(buffer->records_);
+  }
+}
+
+// ================================================================================================
+bool ApiSampler::terminate() {
+  std::vector<ThreadBuffer*> buffers;
+  {
+    std::lock_guard<std::mutex> lock(samplerLock);
+    buffers = threadBuffers;
+  }
+  for (auto buffer : buffers) {
+    std::lock_guard<std::mutex> lock(buffer->lock_);
+    FlushRecords(buffer->records_);
+  }
+
+  std::lock_guard<std::mutex> lock(samplerLock);
+  for (uint32_t id = HIP_API_ID_FIRST; id <= HIP_API_ID_LAST; ++id) {
+    const ApiStats& stats = apiStats[id];
+    if ((stats.sampled_ == 0) && (stats.slow_ == 0)) {
+      continue;
+    }
+    // The random samples give the unbiased estimation of the call count and the total time
+    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "API sample %-32s: samples %lu, est. calls %lu, "
+            "avg %lu ns, est. total %lu us, slow calls %lu, max %lu ns (correlation id %lu)",
+            hip_api_name(id), stats.sampled_, stats.sampled_ * rate_,
+            (stats.sampled_ != 0) ? stats.sum_ / stats.sampled_ : 0,
+            (stats.sum_ * rate_) / 1000, stats.slow_, stats.max_, stats.max_id_);
+  }
+  if (recordFile != nullptr) {
+    fclose(recordFile);
+    recordFile = nullptr;
+  }
+  return false;
+}
+
+}  // namespace hip
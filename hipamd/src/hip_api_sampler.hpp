@@ -0,0 +1,72 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+#include "platform/activity.hpp"
+
+#include <cstdint>
+
+namespace hip {
+
+/// Sampling API tracer. It records a random 1-in-HIP_API_SAMPLE_RATE subset of the API calls and
+/// all calls slower than HIP_API_SAMPLE_THRESHOLD microseconds into per-thread buffers.
+/// The summary with the estimated per API times is printed at the runtime teardown
+class ApiSampler : public amd::ReferenceCountedObject {
+ public:
+  /// Record flags
+  enum : uint32_t {
+    kSampled = 0x1,  //!< The call was randomly sampled
+    kSlow = 0x2      //!< The call was slower than the threshold
+  };
+
+  /// Creates the sampler, if the sampling is enabled
+  static void Init();
+
+  /// Returns true if the sampling is enabled
+  static bool IsEnabled() { return enabled_; }
+
+  /// Starts the call, returns the start timestamp if the call must be timed, 0 otherwise
+  static uint64_t Begin(bool* sampled) {
+    *sampled = (rate_ != 0) && ((NextRandom() % rate_) == 0);
+    return (*sampled || (threshold_ != 0)) ? amd::activity_prof::LaunchTimestamp() : 0;
+  }
+
+  /// Finishes the timed call
+  static void End(uint32_t api_id, uint64_t start, bool sampled);
+
+ protected:
+  /// Flushes all buffers and prints the summary. The sampler isn't destroyed, since
+  /// the exiting threads may still flush their buffers
+  bool terminate() override;
+
+ private:
+  ApiSampler() {}
+
+  /// Per-thread xorshift generator, random sampling avoids the aliasing with periodic calls
+  static uint64_t NextRandom();
+
+  static bool enabled_;        //!< The sampling is enabled
+  static uint32_t rate_;       //!< Sampling rate, 0 if only the slow calls are recorded
+  static uint64_t threshold_;  //!< Slow call threshold in timestamp ticks, 0 if disabled
+};
+
+}  // namespace hip
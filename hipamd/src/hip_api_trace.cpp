@@ -165,6 +165,38 @@ hipError_t hipExtMallocWithFlags(void** ptr, size_t sizeBytes, unsigned int flag
 hipError_t hipExtStreamCreateWithCUMask(hipStream_t* stream, uint32_t cuMaskSize,
                                         const uint32_t* cuMask);
 hipError_t hipExtStreamGetCUMask(hipStream_t stream, uint32_t cuMaskSize, uint32_t* cuMask);
+hipError_t hipExtStreamGetLaunchLatency(hipStream_t stream, unsigned int interval,
+                                        uint64_t* bins, unsigned int numBins);
+hipError_t hipExtMemcpyPeerBroadcastAsync(void* const* dsts, const int* dstDevices,
+                                          unsigned int numDsts, const void* src, int srcDevice,
+                                          size_t sizeBytes, hipStream_t stream);
+hipError_t hipExtMemMapBatch(void* ptr, const hipMemGenericAllocationHandle_t* handles,
+                             const size_t* sizes, unsigned int count,
+                             const hipMemAccessDesc* desc, size_t descCount);
+hipError_t hipExtMemMapAsync(void* ptr, size_t size, size_t offset,
+                             hipMemGenericAllocationHandle_t handle, unsigned long long flags,
+                             hipStream_t stream);
+hipError_t hipExtMemUnmapAsync(void* ptr, size_t size, hipStream_t stream);
+hipError_t hipExtDevicesSynchronize(const int* devices, unsigned int numDevices);
+hipError_t hipExtMemPrefetchBatchAsync(const void* const* dev_ptrs, const size_t* counts,
+                                       size_t numRanges, int device, hipStream_t stream);
+hipError_t hipExtMemPrintAllocReport(hipMemPool_t mem_pool);
+hipError_t hipExtStreamSetCUMask(hipStream_t stream, uint32_t cuMaskSize, const uint32_t* cuMask);
+hipError_t hipExtCreateTextureObjects(hipTextureObject_t* pTexObjects,
+                                      const hipResourceDesc* pResDescs,
+                                      const hipTextureDesc* pTexDescs,
+                                      const hipResourceViewDesc* pResViewDescs,
+                                      unsigned int numObjects);
+hipError_t hipExtMemcpyBatchAsync(void* const* dsts, const void* const* srcs,
+                                  const size_t* sizes, size_t count, hipStream_t stream);
+hipError_t hipExtMemsetPatternAsync(void* dst, const void* pattern, size_t patternSize,
+                                    size_t count, hipStream_t stream);
+hipError_t hipExtHostRegisterAsync(void* hostPtr, size_t sizeBytes, unsigned int flags,
+                                   hipStream_t stream);
+hipError_t hipExtExternalMemoryPin(hipExternalMemory_t extMem);
+hipError_t hipExtExternalMemoryUnpin(hipExternalMemory_t extMem);
+hipError_t hipExtStreamsPartitionCUs(const hipStream_t* streams, const float* weights,
+                                     uint32_t numStreams);
 hipError_t hipExternalMemoryGetMappedBuffer(void** devPtr, hipExternalMemory_t extMem,
                                             const hipExternalMemoryBufferDesc* bufferDesc);
 hipError_t hipFree(void* ptr);
@@ -1032,6 +1064,22 @@ void UpdateDispatchTable(HipDispatchTable* ptrDispatchTable) {
   ptrDispatchTable->hipHostGetFlags_fn = hip::hipHostGetFlags;
   ptrDispatchTable->hipHostMalloc_fn = hip::hipHostMalloc;
   ptrDispatchTable->hipExtHostAlloc_fn = hip::hipExtHostAlloc;
+  ptrDispatchTable->hipExtStreamGetLaunchLatency_fn = hip::hipExtStreamGetLaunchLatency;
+  ptrDispatchTable->hipExtMemcpyPeerBroadcastAsync_fn = hip::hipExtMemcpyPeerBroadcastAsync;
+  ptrDispatchTable->hipExtMemMapBatch_fn = hip::hipExtMemMapBatch;
+  ptrDispatchTable->hipExtMemMapAsync_fn = hip::hipExtMemMapAsync;
+  ptrDispatchTable->hipExtMemUnmapAsync_fn = hip::hipExtMemUnmapAsync;
+  ptrDispatchTable->hipExtDevicesSynchronize_fn = hip::hipExtDevicesSynchronize;
+  ptrDispatchTable->hipExtMemPrefetchBatchAsync_fn = hip::hipExtMemPrefetchBatchAsync;
+  ptrDispatchTable->hipExtMemPrintAllocReport_fn = hip::hipExtMemPrintAllocReport;
+  ptrDispatchTable->hipExtStreamSetCUMask_fn = hip::hipExtStreamSetCUMask;
+  ptrDispatchTable->hipExtStreamsPartitionCUs_fn = hip::hipExtStreamsPartitionCUs;
+  ptrDispatchTable->hipExtCreateTextureObjects_fn = hip::hipExtCreateTextureObjects;
+  ptrDispatchTable->hipExtMemcpyBatchAsync_fn = hip::hipExtMemcpyBatchAsync;
+  ptrDispatchTable->hipExtMemsetPatternAsync_fn = hip::hipExtMemsetPatternAsync;
+  ptrDispatchTable->hipExtHostRegisterAsync_fn = hip::hipExtHostRegisterAsync;
+  ptrDispatchTable->hipExtExternalMemoryPin_fn = hip::hipExtExternalMemoryPin;
+  ptrDispatchTable->hipExtExternalMemoryUnpin_fn = hip::hipExtExternalMemoryUnpin;
   ptrDispatchTable->hipHostRegister_fn = hip::hipHostRegister;
   ptrDispatchTable->hipHostUnregister_fn = hip::hipHostUnregister;
   ptrDispatchTable->hipImportExternalMemory_fn = hip::hipImportExternalMemory;
@@ -1887,6 +1935,36 @@ HIP_ENFORCE_ABI(HipDispatchTable, hipDrvGraphMemcpyNodeSetParams_fn, 460)
 HIP_ENFORCE_ABI(HipDispatchTable, hipExtHostAlloc_fn, 461)
 // HIP_RUNTIME_API_TABLE_STEP_VERSION == 6
 HIP_ENFORCE_ABI(HipDispatchTable, hipDeviceGetTexture1DLinearMaxWidth_fn, 462)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 7
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtStreamGetLaunchLatency_fn, 463)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 8
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemcpyPeerBroadcastAsync_fn, 464)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 9
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemMapBatch_fn, 465)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 10
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemMapAsync_fn, 466)
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemUnmapAsync_fn, 467)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 11
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtDevicesSynchronize_fn, 468)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 12
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemPrefetchBatchAsync_fn, 469)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 13
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemPrintAllocReport_fn, 470)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 14
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtStreamSetCUMask_fn, 471)
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtStreamsPartitionCUs_fn, 472)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 15
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtCreateTextureObjects_fn, 473)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 16
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemcpyBatchAsync_fn, 474)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 17
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemsetPatternAsync_fn, 475)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 18
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtHostRegisterAsync_fn, 476)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 19
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtExternalMemoryPin_fn, 477)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 20
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtExternalMemoryUnpin_fn, 478)
 
 // if HIP_ENFORCE_ABI entries are added for each new function pointer in the table, the number below
 // will be +1 of the number in the last HIP_ENFORCE_ABI line. E.g.:
@@ -1894,9 +1972,9 @@ HIP_ENFORCE_ABI(HipDispatchTable, hipDeviceGetTexture1DLinearMaxWidth_fn, 462)
 //  HIP_ENFORCE_ABI(<table>, <functor>, 8)
 //
 //  HIP_ENFORCE_ABI_VERSIONING(<table>, 9) <- 8 + 1 = 9
-HIP_ENFORCE_ABI_VERSIONING(HipDispatchTable, 463)
+HIP_ENFORCE_ABI_VERSIONING(HipDispatchTable, 479)
 
-static_assert(HIP_RUNTIME_API_TABLE_MAJOR_VERSION == 0 && HIP_RUNTIME_API_TABLE_STEP_VERSION == 6,
+static_assert(HIP_RUNTIME_API_TABLE_MAJOR_VERSION == 0 && HIP_RUNTIME_API_TABLE_STEP_VERSION == 20,
               "If you get this error, add new HIP_ENFORCE_ABI(...) code for the new function "
               "pointers and then update this check so it is true");
 #endif
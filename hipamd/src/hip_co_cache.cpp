@@ -0,0 +1,202 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hip_co_cache.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include "top.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+namespace hip {
+namespace fs = std::filesystem;
+
+namespace {
+// Compressed clang offload bundle header, the hash covers the uncompressed bundle
+struct CompressedBundleHeader {
+  char magic_[4];  // "CCOB"
+  uint16_t version_;
+  uint16_t method_;
+  uint32_t total_size_;
+  uint32_t uncompressed_size_;
+  uint64_t hash_;
+};
+constexpr char kCompressedMagic[] = "CCOB";
+
+// Cache entry header. The size keeps the code object 16 bytes aligned after the header,
+// as the code objects allocated by the unbundler
+struct EntryHeader {
+  uint32_t magic_;    // kEntryMagic
+  uint32_t version_;  // kEntryVersion
+  uint64_t size_;     // Size of the code object after the header
+};
+static_assert(sizeof(EntryHeader) % 16 == 0, "Code object must stay 16 bytes aligned");
+constexpr uint32_t kEntryMagic = 0x4f435348;  // "HSCO"
+constexpr uint32_t kEntryVersion = 1;
+constexpr const char* kEntryExtension = ".hipco";
+
+// The ISA name contains ':' for the target features, which isn't valid for all file systems
+std::string FileKey(const std::string& prefix, const std::string& isa) {
+  std::string key = prefix + isa;
+  for (auto& c : key) {
+    if (c == ':') {
+      c = '_';
+    }
+  }
+  return key;
+}
+}  // namespace
+
+// ================================================================================================
+SharedCodeCache* SharedCodeCache::get() {
+  static SharedCodeCache* cache = nullptr;
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    std::string path = HIP_SHARED_CO_CACHE_PATH;
+    if (path.empty()) {
+      return;
+    }
+    std::error_code ec;
+    fs::create_directories(path, ec);
+    if (!fs::is_directory(path, ec)) {
+      LogPrintfError("Shared code object cache: unable to use the directory %s", path.c_str());
+      return;
+    }
+    cache = new SharedCodeCache(path);
+  });
+  return cache;
+}
+
+// ================================================================================================
+std::string SharedCodeCache::Key(const void* fatbin, const std::string& isa) {
+  // Only the compressed bundles carry a hash of the contents. The uncompressed bundles are
+  // sliced in place without a copy, so caching them saves nothing.
+  const auto header = reinterpret_cast<const CompressedBundleHeader*>(fatbin);
+  if (memcmp(header->magic_, kCompressedMagic, sizeof(header->magic_)) != 0 ||
+      header->version_ < 2) {
+    return std::string();
+  }
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%016llx-%08x-%08x-%u-", static_cast<unsigned long long>(
+           header->hash_), header->total_size_, header->uncompressed_size_, header->method_);
+  return FileKey(buffer, isa);
+}
+
+// ================================================================================================
+std::string SharedCodeCache::SpecializedKey(const void* code, size_t size,
+                                            const std::string& isa) {
+  // FNV-1a of the generic code object, the specialization runs once per code object and ISA
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(code);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "spec-%016llx-%zx-", static_cast<unsigned long long>(hash),
+           size);
+  return FileKey(buffer, isa);
+}
+
+// ================================================================================================
+std::string SharedCodeCache::FileName(const std::string& key) const {
+  return (fs::path(path_) / (key + kEntryExtension)).string();
+}
+
+// ================================================================================================
+bool SharedCodeCache::Map(const std::string& key, const void** code, size_t* size) {
+  std::string file_name = FileName(key);
+  amd::Os::FileDesc fdesc = amd::Os::FDescInit();
+  size_t file_size = 0;
+  if (!amd::Os::GetFileHandle(file_name.c_str(), &fdesc, &file_size)) {
+    LogPrintfInfo("Shared code object cache miss: %s", key.c_str());
+    return false;
+  }
+  const void* image = nullptr;
+  bool mapped = (file_size > sizeof(EntryHeader)) &&
+                amd::Os::MemoryMapFileDesc(fdesc, file_size, 0, &image);
+  // The mapping stays valid after the file is closed
+  amd::Os::CloseFileHandle(fdesc);
+  if (!mapped) {
+    LogPrintfInfo("Shared code object cache: unable to map %s", file_name.c_str());
+    return false;
+  }
+
+  const auto header = reinterpret_cast<const EntryHeader*>(image);
+  if ((header->magic_ != kEntryMagic) || (header->version_ != kEntryVersion) ||
+      (header->size_ != file_size - sizeof(EntryHeader))) {
+    LogPrintfInfo("Shared code object cache miss: %s is invalid", file_name.c_str());
+    amd::Os::MemoryUnmapFile(image, file_size);
+    return false;
+  }
+  *code = reinterpret_cast<const char*>(image) + sizeof(EntryHeader);
+  *size = header->size_;
+  LogPrintfInfo("Shared code object cache hit: %s, %zu bytes", key.c_str(), *size);
+  return true;
+}
+
+// ================================================================================================
+void SharedCodeCache::Store(const std::string& key, const void* code, size_t size) {
+  static std::atomic<uint32_t> counter{0};
+  std::string file_name = FileName(key);
+  // The temporary name is unique across the threads and the processes
+  std::string tmp_name = file_name + "." + std::to_string(amd::Os::getProcessId()) + "." +
+                         std::to_string(counter++) + ".tmp";
+  {
+    std::ofstream file(tmp_name, std::ios_base::out | std::ios_base::binary |
+                       std::ios_base::trunc);
+    EntryHeader header = {kEntryMagic, kEntryVersion, size};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(code), size);
+    file.close();
+    if (!file.good()) {
+      LogPrintfInfo("Shared code object cache: unable to write %s", tmp_name.c_str());
+      std::error_code ec;
+      fs::remove(tmp_name, ec);
+      return;
+    }
+  }
+
+  // Another process may store the same entry meanwhile, the rename replaces it atomically
+  std::error_code ec;
+  fs::rename(tmp_name, file_name, ec);
+  if (ec) {
+    LogPrintfInfo("Shared code object cache: unable to store %s", file_name.c_str());
+    fs::remove(tmp_name, ec);
+    return;
+  }
+  LogPrintfInfo("Shared code object cache store: %s, %zu bytes", key.c_str(), size);
+}
+
+// ================================================================================================
+void SharedCodeCache::Unmap(const void* code, size_t size) {
+  const void* image = reinterpret_cast<const char*>(code) - sizeof(EntryHeader);
+  if (!amd::Os::MemoryUnmapFile(image, size + sizeof(EntryHeader))) {
+    LogPrintfError("Shared code object cache: unable to unmap %p", image);
+  }
+}
+
+}  // namespace hip
@@ -0,0 +1,65 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hip {
+
+/// Node-local cache of the unbundled and decompressed code objects, shared between the
+/// processes. An entry is a file keyed by the fat binary hash and the device ISA. The readers
+/// map the entries read-only, so all processes on the node share the same page cache copy.
+/// The writers create a temporary file and rename it, so the readers never see partial data.
+class SharedCodeCache {
+ public:
+  /// Returns the cache, nullptr if the cache is disabled
+  static SharedCodeCache* get();
+
+  /// Returns the cache key of the fat binary for the ISA, an empty key if the bundle can't be
+  /// identified without hashing the contents
+  static std::string Key(const void* fatbin, const std::string& isa);
+
+  /// Returns the cache key of the code object, specialized for the ISA from a generic target
+  /// code object
+  static std::string SpecializedKey(const void* code, size_t size, const std::string& isa);
+
+  /// Maps the cached code object. On a hit returns true, the code object pointer and size,
+  /// the mapping must be released with Unmap()
+  bool Map(const std::string& key, const void** code, size_t* size);
+
+  /// Stores the code object into the cache
+  void Store(const std::string& key, const void* code, size_t size);
+
+  /// Releases the mapping of a code object returned by Map()
+  static void Unmap(const void* code, size_t size);
+
+ private:
+  explicit SharedCodeCache(const std::string& path) : path_(path) {}
+
+  /// Returns the full file name for the key
+  std::string FileName(const std::string& key) const;
+
+  std::string path_;  //!< Cache directory
+};
+
+}  // namespace hip
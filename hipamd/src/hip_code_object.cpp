@@ -22,6 +22,7 @@ THE SOFTWARE.
 #include "hip_code_object.hpp"
 #include "amd_hsa_elf.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 #include <hip/driver_types.h>
@@ -29,6 +30,8 @@ THE SOFTWARE.
 #include "hip/hip_runtime.h"
 #include "hip_internal.hpp"
 #include "platform/program.hpp"
+#include "platform/runtime.hpp"
+#include "thread/threadpool.hpp"
 #include <elf/elf.hpp>
 #include "comgrctx.hpp"
 namespace hip {
@@ -124,6 +127,111 @@ bool CodeObject::containGenericTarget(const void *data) {
   return false;
 }
 
+bool CodeObject::getEmbeddedBitcode(const void* image, size_t size, const char** bitcode,
+                                    size_t* bitcode_size) {
+  constexpr char kBitcodeSection[] = ".llvmbc";
+  const char* base = reinterpret_cast<const char*>(image);
+  const Elf64_Ehdr* ehdr = reinterpret_cast<const Elf64_Ehdr*>(image);
+  if ((size < sizeof(Elf64_Ehdr)) || !amd::Elf::isElfMagic(base) ||
+      (ehdr->e_ident[EI_CLASS] != ELFCLASS64) || (ehdr->e_shentsize != sizeof(Elf64_Shdr)) ||
+      (ehdr->e_shoff > size) ||
+      ((size - ehdr->e_shoff) / sizeof(Elf64_Shdr) < ehdr->e_shnum) ||
+      (ehdr->e_shstrndx >= ehdr->e_shnum)) {
+    return false;
+  }
+  const Elf64_Shdr* shdrs = reinterpret_cast<const Elf64_Shdr*>(base + ehdr->e_shoff);
+  const Elf64_Shdr& strtab = shdrs[ehdr->e_shstrndx];
+  if ((strtab.sh_offset > size) || (strtab.sh_size > size - strtab.sh_offset)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < ehdr->e_shnum; ++i) {
+    const Elf64_Shdr& shdr = shdrs[i];
+    if ((shdr.sh_name >= strtab.sh_size) ||
+        (strtab.sh_size - shdr.sh_name < sizeof(kBitcodeSection)) ||
+        (memcmp(base + strtab.sh_offset + shdr.sh_name, kBitcodeSection,
+                sizeof(kBitcodeSection)) != 0)) {
+      continue;
+    }
+    if ((shdr.sh_type == SHT_NOBITS) || (shdr.sh_size == 0) || (shdr.sh_offset > size) ||
+        (shdr.sh_size > size - shdr.sh_offset)) {
+      return false;
+    }
+    *bitcode = base + shdr.sh_offset;
+    *bitcode_size = shdr.sh_size;
+    return true;
+  }
+  return false;
+}
+
+bool CodeObject::compileBitcodeForIsa(const char* bitcode, size_t size, const std::string& isa,
+                                      std::vector<char>* code_object) {
+  amd_comgr_data_t data_bc{0};
+  amd_comgr_data_t data_exe{0};
+  amd_comgr_data_set_t set_bc{0};
+  amd_comgr_data_set_t set_reloc{0};
+  amd_comgr_data_set_t set_exe{0};
+  amd_comgr_action_info_t action{0};
+  const char* options[] = {"-O3"};
+  bool result = false;
+
+  do {
+    if ((amd::Comgr::create_data(AMD_COMGR_DATA_KIND_BC, &data_bc) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::set_data(data_bc, size, bitcode) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::set_data_name(data_bc, "generic.bc") != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::create_data_set(&set_bc) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::data_set_add(set_bc, data_bc) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::create_data_set(&set_reloc) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::create_data_set(&set_exe) != AMD_COMGR_STATUS_SUCCESS)) {
+      LogPrintfError("Unable to set up the bitcode compilation for %s", isa.c_str());
+      break;
+    }
+    if ((amd::Comgr::create_action_info(&action) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::action_info_set_isa_name(action, isa.c_str()) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::action_info_set_option_list(action, options, 1) !=
+         AMD_COMGR_STATUS_SUCCESS)) {
+      LogPrintfError("Unable to create the bitcode compilation action for %s", isa.c_str());
+      break;
+    }
+    amd_comgr_status_t status = amd::Comgr::do_action(AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE,
+                                                      action, set_bc, set_reloc);
+    if (status == AMD_COMGR_STATUS_SUCCESS) {
+      status = amd::Comgr::do_action(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, action,
+                                     set_reloc, set_exe);
+    }
+    if (status != AMD_COMGR_STATUS_SUCCESS) {
+      LogPrintfError("Bitcode compilation for %s failed with status 0x%xh", isa.c_str(), status);
+      break;
+    }
+    size_t exe_size = 0;
+    if ((amd::Comgr::action_data_get_data(set_exe, AMD_COMGR_DATA_KIND_EXECUTABLE, 0,
+                                          &data_exe) != AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::get_data(data_exe, &exe_size, nullptr) != AMD_COMGR_STATUS_SUCCESS) ||
+        (exe_size == 0)) {
+      LogPrintfError("Bitcode compilation for %s returned no code object", isa.c_str());
+      break;
+    }
+    code_object->resize(exe_size);
+    result = (amd::Comgr::get_data(data_exe, &exe_size, code_object->data()) ==
+              AMD_COMGR_STATUS_SUCCESS);
+  } while (0);
+
+  if (data_exe.handle != 0) {
+    amd::Comgr::release_data(data_exe);
+  }
+  if (action.handle != 0) {
+    amd::Comgr::destroy_action_info(action);
+  }
+  for (auto set : {set_exe, set_reloc, set_bc}) {
+    if (set.handle != 0) {
+      amd::Comgr::destroy_data_set(set);
+    }
+  }
+  if (data_bc.handle != 0) {
+    amd::Comgr::release_data(data_bc);
+  }
+  return result;
+}
+
 uint64_t CodeObject::ElfSize(const void* emi) { return amd::Elf::getElfSize(emi); }
 
 static bool getProcName(uint32_t EFlags, std::string& proc_name, bool& xnackSupported,
@@ -849,6 +957,24 @@ hipError_t CodeObject::extractCodeObjectFromFatBinaryUsingComgr(
       break;
     }
 
+    // The unbundled entries own their data. Release comgr's copy of the input bundle before the
+    // entries are copied out, so at most one bundle sized buffer is alive in the host memory.
+    comgrStatus = amd::Comgr::destroy_data_set(dataSetBundled);
+    dataSetBundled.handle = 0;
+    if (comgrStatus != AMD_COMGR_STATUS_SUCCESS) {
+      LogPrintfError("amd::Comgr::destroy_data_set(dataSetBundled) failed with status 0x%xh",
+                     comgrStatus);
+      hipStatus = hipErrorInvalidValue;
+      break;
+    }
+    comgrStatus = amd::Comgr::release_data(dataCodeObj);
+    dataCodeObj.handle = 0;
+    if (comgrStatus != AMD_COMGR_STATUS_SUCCESS) {
+      LogPrintfError("amd::Comgr::release_data(dataCodeObj) failed with status 0x%xh", comgrStatus);
+      hipStatus = hipErrorInvalidValue;
+      break;
+    }
+
     // Check CodeObject count
     size_t count = 0;
     comgrStatus =
@@ -1141,7 +1267,22 @@ bool DynCO::isValidDynFunc(const void* hfunc) {
                      [&](auto& it) { return it.second->isValidDynFunc(hfunc); });
 }
 
-hipError_t DynCO::initDynManagedVars(const std::string& managedVar) {
+hipError_t VarInitBatch::submit(hip::Stream& stream) {
+  if (dsts_.empty()) {
+    return hipSuccess;
+  }
+  hipError_t status = ihipMemcpyBatchAsync(dsts_.data(), srcs_.data(), sizes_.data(),
+                                           dsts_.size(), reinterpret_cast<hipStream_t>(&stream));
+  // The sources may go away after the load, wait for the queued part even on a failure
+  stream.finish();
+  dsts_.clear();
+  srcs_.clear();
+  sizes_.clear();
+  pointers_.clear();
+  return status;
+}
+
+hipError_t DynCO::initDynManagedVars(const std::string& managedVar, VarInitBatch& batch) {
   amd::ScopedLock lock(dclock_);
   DeviceVar* dvar;
   void* pointer = nullptr;
@@ -1162,19 +1303,7 @@ hipError_t DynCO::initDynManagedVars(const std::string& managedVar) {
   it->second->setManagedVarInfo(pointer, dvar->size());
 
   // copy initial value to the managed variable to the managed memory allocated
-  hip::Stream* stream = hip::getNullStream();
-  if (stream != nullptr) {
-    status = ihipMemcpy(pointer, reinterpret_cast<address>(dvar->device_ptr()), dvar->size(),
-                        hipMemcpyDeviceToDevice, *stream);
-    if (status != hipSuccess) {
-      ClPrint(amd::LOG_ERROR, amd::LOG_API, "Status %d, failed to copy device ptr:%s", status,
-              managedVar.c_str());
-      return status;
-    }
-  } else {
-    ClPrint(amd::LOG_ERROR, amd::LOG_API, "Host Queue is NULL");
-    return hipErrorInvalidResourceHandle;
-  }
+  batch.add(pointer, dvar->device_ptr(), dvar->size());
 
   // Get deivce ptr to initialize with managed memory pointer
   status = getDeviceVar(&dvar, managedVar);
@@ -1184,13 +1313,7 @@ hipError_t DynCO::initDynManagedVars(const std::string& managedVar) {
     return status;
   }
   // copy managed memory pointer to the managed device variable
-  status = ihipMemcpy(reinterpret_cast<address>(dvar->device_ptr()), &pointer, dvar->size(),
-                      hipMemcpyHostToDevice, *stream);
-  if (status != hipSuccess) {
-    ClPrint(amd::LOG_ERROR, amd::LOG_API, "Status %d, failed to copy device ptr:%s", status,
-            managedVar.c_str());
-    return status;
-  }
+  batch.addPointer(dvar->device_ptr(), pointer, dvar->size());
   return status;
 }
 
@@ -1213,13 +1336,30 @@ hipError_t DynCO::populateDynGlobalVars() {
         std::make_pair(elem, new Var(elem, Var::DeviceVarKind::DVK_Variable, 0, 0, 0, nullptr)));
   }
 
+  // The initial copies of all managed variables go out together with one wait
+  VarInitBatch batch;
   for (auto& elem : var_names) {
     if (elem.find(managedVarExt) != std::string::npos) {
       std::string managedVar = elem;
       managedVar.erase(managedVar.length() - managedVarExt.length(), managedVarExt.length());
-      err = initDynManagedVars(managedVar);
+      err = initDynManagedVars(managedVar, batch);
+      if (err != hipSuccess) {
+        break;
+      }
     }
   }
+
+  hip::Stream* stream = hip::getNullStream();
+  if (stream == nullptr) {
+    ClPrint(amd::LOG_ERROR, amd::LOG_API, "Host Queue is NULL");
+    return hipErrorInvalidResourceHandle;
+  }
+  hipError_t status = batch.submit(*stream);
+  if (status != hipSuccess) {
+    ClPrint(amd::LOG_ERROR, amd::LOG_API, "Status %d, failed to copy the managed variables",
+            status);
+    return status;
+  }
   return err;
 }
 
@@ -1247,7 +1387,7 @@ hipError_t DynCO::populateDynGlobalFuncs() {
 StatCO::StatCO() {}
 
 StatCO::~StatCO() {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
 
   for (auto& elem : functions_) {
     delete elem.second;
@@ -1258,24 +1398,65 @@ StatCO::~StatCO() {
     delete elem.second;
   }
   vars_.clear();
+  varGeneration_++;
 }
 
 hipError_t StatCO::digestFatBinary(const void* data, FatBinaryInfo*& programs) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
 
   if (programs != nullptr) {
     return hipSuccess;
   }
 
   // Create a new fat binary object and extract the fat binary for all devices.
+  // In the lazy mode the extraction is done per device on the first BuildProgram().
   programs = new FatBinaryInfo(nullptr, data);
+  if (HIP_LAZY_FATBIN_EXTRACT) {
+    programs->DeferExtraction();
+    return hipSuccess;
+  }
   IHIP_RETURN_ONFAIL(programs->ExtractFatBinary(g_devices));
 
   return hipSuccess;
 }
 
+void StatCO::digestFatBinaries(uint32_t num_threads) {
+  amd::ScopedExclusiveLock lock(sclock_);
+
+  std::vector<std::pair<const void*, FatBinaryInfo**>> modules;
+  modules.reserve(modules_.size());
+  for (auto& it : modules_) {
+    if (it.second == nullptr) {
+      modules.push_back(std::make_pair(it.first, &it.second));
+    }
+  }
+  if (modules.empty()) {
+    return;
+  }
+
+  // Each worker takes a whole fat binary, since the extraction of one fat binary updates the
+  // shared file and image state. The workers don't take sclock_, it's held by this thread.
+  uint64_t start = amd::Os::timeNanos();
+  amd::ThreadPool& pool = amd::ThreadPool::shared();
+  pool.parallelFor(modules.size(), [&modules](size_t i) {
+    FatBinaryInfo* programs = new FatBinaryInfo(nullptr, modules[i].first);
+    *modules[i].second = programs;
+    hipError_t err = programs->ExtractFatBinary(g_devices);
+    for (size_t dev = 0; (err == hipSuccess) && (dev < g_devices.size()); ++dev) {
+      err = programs->BuildProgram(dev);
+    }
+    if (err != hipSuccess) {
+      HIP_ERROR_PRINT(err, "continue parsing remaining modules");
+    }
+  }, num_threads);
+  num_threads = std::min({num_threads, pool.size() + 1, static_cast<uint32_t>(modules.size())});
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Built %zu fat binaries on %u threads in %.3f ms",
+          modules.size(), num_threads, (amd::Os::timeNanos() - start) / 1e6);
+}
+
 FatBinaryInfo** StatCO::addFatBinary(const void* data, bool initialized, bool& success) {
-  amd::ScopedLock lock(sclock_);
+  amd::StartupProfile::Scope scope(amd::StartupProfile::FatBinaryRegistration);
+  amd::ScopedExclusiveLock lock(sclock_);
 
   if (initialized == false) {
     success = true;
@@ -1288,8 +1469,9 @@ FatBinaryInfo** StatCO::addFatBinary(const void* data, bool initialized, bool& s
 }
 
 hipError_t StatCO::removeFatBinary(FatBinaryInfo** module) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
 
+  varGeneration_++;
   auto vit = vars_.begin();
   while (vit != vars_.end()) {
     if (vit->second->moduleInfo() == module) {
@@ -1346,7 +1528,7 @@ hipError_t StatCO::removeFatBinary(FatBinaryInfo** module) {
 }
 
 hipError_t StatCO::registerStatFunction(const void* hostFunction, Function* func) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
 
   if (functions_.find(hostFunction) != functions_.end()) {
     DevLogPrintfError("hostFunctionPtr: 0x%x already exists", hostFunction);
@@ -1359,7 +1541,7 @@ hipError_t StatCO::registerStatFunction(const void* hostFunction, Function* func
 }
 
 const char* StatCO::getStatFuncName(const void* hostFunction) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedSharedLock lock(sclock_);
 
   const auto it = functions_.find(hostFunction);
   if (it == functions_.end()) {
@@ -1369,7 +1551,18 @@ const char* StatCO::getStatFuncName(const void* hostFunction) {
 }
 
 hipError_t StatCO::getStatFunc(hipFunction_t* hfunc, const void* hostFunction, int deviceId) {
-  amd::ScopedLock lock(sclock_);
+  {
+    amd::ScopedSharedLock lock(sclock_);
+    const auto it = functions_.find(hostFunction);
+    if (it == functions_.end()) {
+      return hipErrorInvalidSymbol;
+    }
+    if (it->second->findStatFunc(hfunc, deviceId)) {
+      return hipSuccess;
+    }
+  }
+  // The first lookup on the device builds the program
+  amd::ScopedExclusiveLock lock(sclock_);
 
   const auto it = functions_.find(hostFunction);
   if (it == functions_.end()) {
@@ -1381,7 +1574,17 @@ hipError_t StatCO::getStatFunc(hipFunction_t* hfunc, const void* hostFunction, i
 
 hipError_t StatCO::getStatFuncAttr(hipFuncAttributes* func_attr, const void* hostFunction,
                                    int deviceId) {
-  amd::ScopedLock lock(sclock_);
+  {
+    amd::ScopedSharedLock lock(sclock_);
+    const auto it = functions_.find(hostFunction);
+    if (it == functions_.end()) {
+      return hipErrorInvalidSymbol;
+    }
+    if (it->second->findStatFuncAttr(func_attr, deviceId)) {
+      return hipSuccess;
+    }
+  }
+  amd::ScopedExclusiveLock lock(sclock_);
 
   const auto it = functions_.find(hostFunction);
   if (it == functions_.end()) {
@@ -1392,7 +1595,7 @@ hipError_t StatCO::getStatFuncAttr(hipFuncAttributes* func_attr, const void* hos
 }
 
 hipError_t StatCO::registerStatGlobalVar(const void* hostVar, Var* var) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
 
   auto var_it = vars_.find(hostVar);
   if ((var_it != vars_.end()) && (var_it->second->getName() != var->getName())) {
@@ -1403,9 +1606,43 @@ hipError_t StatCO::registerStatGlobalVar(const void* hostVar, Var* var) {
   return hipSuccess;
 }
 
+namespace {
+// Resolved symbol of a device, cached per thread for the repeated symbol copies
+struct SymbolCacheEntry {
+  const void* hostVar_;
+  int deviceId_;
+  uint64_t generation_;   // StatCO::varGeneration_ at the resolution
+  hipDeviceptr_t devPtr_;
+  size_t size_;
+};
+
+// Open addressing table with the linear probing over a short window
+constexpr uint32_t kSymbolCacheSize = 64;
+constexpr uint32_t kSymbolCacheProbes = 4;
+thread_local SymbolCacheEntry symbolCache[kSymbolCacheSize] = {};
+
+inline uint32_t SymbolCacheSlot(const void* hostVar, int deviceId) {
+  uint64_t hash = (reinterpret_cast<uint64_t>(hostVar) >> 4) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<uint32_t>((hash >> 58) + deviceId) % kSymbolCacheSize;
+}
+}  // namespace
+
 hipError_t StatCO::getStatGlobalVar(const void* hostVar, int deviceId, hipDeviceptr_t* dev_ptr,
                                     size_t* size_ptr) {
-  amd::ScopedLock lock(sclock_);
+  // The generation is read before the lookup, so a removal in between invalidates the new entry
+  const uint64_t generation = varGeneration_.load(std::memory_order_acquire);
+  const uint32_t slot = SymbolCacheSlot(hostVar, deviceId);
+  for (uint32_t i = 0; i < kSymbolCacheProbes; ++i) {
+    const SymbolCacheEntry& entry = symbolCache[(slot + i) % kSymbolCacheSize];
+    if (entry.hostVar_ == hostVar && entry.deviceId_ == deviceId &&
+        entry.generation_ == generation) {
+      *dev_ptr = entry.devPtr_;
+      *size_ptr = entry.size_;
+      return hipSuccess;
+    }
+  }
+
+  amd::ScopedExclusiveLock lock(sclock_);
 
   const auto it = vars_.find(hostVar);
   if (it == vars_.end()) {
@@ -1417,6 +1654,17 @@ hipError_t StatCO::getStatGlobalVar(const void* hostVar, int deviceId, hipDevice
 
   *dev_ptr = dvar->device_ptr();
   *size_ptr = dvar->size();
+
+  // Take an empty or a stale slot in the window, otherwise replace the home slot
+  SymbolCacheEntry* victim = &symbolCache[slot];
+  for (uint32_t i = 0; i < kSymbolCacheProbes; ++i) {
+    SymbolCacheEntry& entry = symbolCache[(slot + i) % kSymbolCacheSize];
+    if (entry.hostVar_ == nullptr || entry.generation_ != generation) {
+      victim = &entry;
+      break;
+    }
+  }
+  *victim = {hostVar, deviceId, generation, *dev_ptr, *size_ptr};
   return hipSuccess;
 }
 
@@ -1426,22 +1674,25 @@ hipError_t StatCO::registerStatManagedVar(Var* var) {
 }
 
 hipError_t StatCO::initStatManagedVarDevicePtr(int deviceId) {
-  amd::ScopedLock lock(sclock_);
+  amd::ScopedExclusiveLock lock(sclock_);
   hipError_t err = hipSuccess;
   if (managedVarsDevicePtrInitalized_.find(deviceId) == managedVarsDevicePtrInitalized_.end() ||
       !managedVarsDevicePtrInitalized_[deviceId]) {
+    hip::Stream* stream = g_devices.at(deviceId)->NullStream();
+    if (stream == nullptr) {
+      ClPrint(amd::LOG_ERROR, amd::LOG_API, "Host Queue is NULL");
+      return hipErrorInvalidResourceHandle;
+    }
+    // The pointer writes of all managed variables go out together with one wait
+    VarInitBatch batch;
     for (auto var : managedVars_) {
       DeviceVar* dvar = nullptr;
       IHIP_RETURN_ONFAIL(var->getStatDeviceVar(&dvar, deviceId));
-
-      hip::Stream* stream = g_devices.at(deviceId)->NullStream();
-      if (stream != nullptr) {
-        err = ihipMemcpy(reinterpret_cast<address>(dvar->device_ptr()), var->getManagedVarPtr(),
-                         dvar->size(), hipMemcpyHostToDevice, *stream);
-      } else {
-        ClPrint(amd::LOG_ERROR, amd::LOG_API, "Host Queue is NULL");
-        return hipErrorInvalidResourceHandle;
-      }
+      batch.add(dvar->device_ptr(), var->getManagedVarPtr(), dvar->size());
+    }
+    err = batch.submit(*stream);
+    if (err != hipSuccess) {
+      return err;
     }
     managedVarsDevicePtrInitalized_[deviceId] = true;
   }
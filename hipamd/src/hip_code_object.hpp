@@ -25,19 +25,48 @@ THE SOFTWARE.
 
 #include "hip_global.hpp"
 
+#include <atomic>
 #include <cstring>
+#include <deque>
 #include <unordered_map>
+#include <vector>
 
 #include "hip/hip_runtime.h"
 #include "hip/hip_runtime_api.h"
 #include "hip_internal.hpp"
 #include "device/device.hpp"
 #include "platform/program.hpp"
+#include "thread/rwmonitor.hpp"
 
 namespace hip {
 //Forward Declaration for friend usage
 class PlatformState;
 
+// The initial device writes of the global variables of a code object. The writes are queued
+// together and the code object load waits once, instead of a synchronous copy per variable.
+class VarInitBatch {
+ public:
+  // Adds a write, the source must stay valid until submit()
+  void add(void* dst, const void* src, size_t size) {
+    dsts_.push_back(dst);
+    srcs_.push_back(src);
+    sizes_.push_back(size);
+  }
+  // Adds a write of the pointer value, the batch holds the value
+  void addPointer(void* dst, void* value, size_t size) {
+    pointers_.push_back(value);
+    add(dst, &pointers_.back(), size);
+  }
+  // Queues the writes on the stream and waits for them
+  hipError_t submit(hip::Stream& stream);
+
+ private:
+  std::vector<void*> dsts_;
+  std::vector<const void*> srcs_;
+  std::vector<size_t> sizes_;
+  std::deque<void*> pointers_;  // The stable storage of the pointer values
+};
+
 //Code Object base class
 class CodeObject {
  public:
@@ -71,6 +100,15 @@ class CodeObject {
 
   static bool containGenericTarget(const void *data);
 
+  // Returns the bitcode, which the compiler embedded into the code object (.llvmbc section),
+  // false if the code object has none
+  static bool getEmbeddedBitcode(const void* image, size_t size, const char** bitcode,
+                                 size_t* bitcode_size);
+
+  // Compiles the bitcode into a code object for the ISA
+  static bool compileBitcodeForIsa(const char* bitcode, size_t size, const std::string& isa,
+                                   std::vector<char>* code_object);
+
   // Return size of fat bin
   static size_t getFatbinSize(const void* data, const bool isCompressed = false);
 
@@ -154,13 +192,17 @@ private:
   //Populate Global Vars/Funcs from an code object(@ module_load)
   hipError_t populateDynGlobalFuncs();
   hipError_t populateDynGlobalVars();
-  hipError_t initDynManagedVars(const std::string& managedVar);
+  hipError_t initDynManagedVars(const std::string& managedVar, VarInitBatch& batch);
 };
 
 //Static Code Object
 class StatCO: public CodeObject {
-  // Guards Static Code object
-  amd::Monitor sclock_{true};
+  // Guards Static Code object. The kernel launches look up the functions concurrently, hence
+  // the built functions are found under the shared side and the builds take the exclusive side
+  amd::RwMonitor sclock_;
+  // Changes whenever a resolved variable may go away, so the cached lookups of the threads
+  // in getStatGlobalVar() see the stale entries
+  std::atomic<uint64_t> varGeneration_{1};
 public:
   StatCO();
   virtual ~StatCO();
@@ -169,6 +211,8 @@ public:
   FatBinaryInfo** addFatBinary(const void* data, bool initialized, bool& success);
   hipError_t removeFatBinary(FatBinaryInfo** module);
   hipError_t digestFatBinary(const void* data, FatBinaryInfo*& programs);
+  //Digests all registered fat binaries and builds their programs for all devices in parallel
+  void digestFatBinaries(uint32_t num_threads);
 
   //Register vars/funcs given to use from __hipRegister[Var/Func/ManagedVar]
   hipError_t registerStatFunction(const void* hostFunction, Function* func);
@@ -78,6 +78,7 @@ void init(bool* status) {
   amd::RuntimeTearDown::RegisterObject(hContext);
 
   PlatformState::instance().init();
+  ApiSampler::Init();
   *status = true;
   return;
 }
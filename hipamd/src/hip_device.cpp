@@ -76,6 +76,11 @@ bool Device::Create() {
 
   // Current is default pool after device creation
   current_mem_pool_ = default_mem_pool_;
+
+  if (HIP_MEM_POOL_RECLAIM_RATE != 0) {
+    reclaimer_ = new MemoryReclaimer(this);
+    reclaimer_->Start();
+  }
   return true;
 }
 
@@ -116,6 +121,12 @@ bool Device::FreeMemory(amd::Memory* memory, Stream* stream, Event* event) {
 
 // ================================================================================================
 void Device::ReleaseFreedMemory() {
+  if (reclaimer_ != nullptr) {
+    // Move the release off the sync point
+    reclaimer_->Notify();
+    return;
+  }
+  ReclaimDeferredFrees(false);
   amd::ScopedLock lock(lock_);
   // Search for memory in the entire list of pools
   for (auto it : mem_pools_) {
@@ -123,6 +134,208 @@ void Device::ReleaseFreedMemory() {
   }
 }
 
+// ================================================================================================
+size_t Device::ReclaimFreedMemory(size_t max_bytes) {
+  amd::ScopedLock lock(lock_);
+  size_t released = 0;
+  for (auto it : mem_pools_) {
+    if (released >= max_bytes) {
+      break;
+    }
+    released += it->ReleaseFreedMemory(max_bytes - released);
+  }
+  return released;
+}
+
+// ================================================================================================
+void Device::PrintPoolReport() {
+  amd::ScopedLock lock(lock_);
+  for (auto it : mem_pools_) {
+    it->PrintReport();
+  }
+}
+
+// ================================================================================================
+bool Device::IsPoolMemory(amd::Memory* memory) {
+  if (memory->getUserData().phys_mem_obj != nullptr) {
+    memory = memory->getUserData().phys_mem_obj;
+  }
+  amd::ScopedLock lock(lock_);
+  for (auto it : mem_pools_) {
+    if (it->IsBusyMemory(memory)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ================================================================================================
+void Device::DeferFree(amd::Memory* memory) {
+  // Tag the memory with the last commands of all streams, since any of them may use it
+  DeferredFree deferred = {memory, {}};
+  std::vector<hip::Stream*> streams;
+  CollectStreams(streams, false);
+  for (auto it : streams) {
+    if (amd::Command* command = it->getLastQueuedCommand(true)) {
+      if (command->status() == CL_COMPLETE) {
+        command->release();
+      } else {
+        deferred.commands_.push_back(command);
+      }
+    }
+    it->release();
+  }
+
+  // The deferred free holds a reference to keep the memory alive, but the address becomes
+  // invalid for the app right away
+  memory->retain();
+  amd::SvmBuffer::free(memory->getContext(), memory->getSvmPtr());
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Deferred free: %p, size %zu, %zu commands",
+          memory->getSvmPtr(), memory->getSize(), deferred.commands_.size());
+
+  size_t num_frees = 0;
+  {
+    amd::ScopedLock lock(deferred_free_lock_);
+    deferred_frees_.push_back(std::move(deferred));
+    num_frees = deferred_frees_.size();
+  }
+  // Return the passed frees to ROCr in batches, if the background reclaimer doesn't run
+  constexpr size_t kDeferredFreeBatch = 16;
+  if ((reclaimer_ == nullptr) && (num_frees >= kDeferredFreeBatch)) {
+    ReclaimDeferredFrees(false);
+  }
+}
+
+// ================================================================================================
+size_t Device::ReclaimDeferredFrees(bool wait) {
+  std::list<DeferredFree> passed;
+  {
+    amd::ScopedLock lock(deferred_free_lock_);
+    if (wait) {
+      passed.swap(deferred_frees_);
+    } else {
+      for (auto it = deferred_frees_.begin(); it != deferred_frees_.end();) {
+        bool ready = true;
+        for (auto command : it->commands_) {
+          if ((command->status() != CL_COMPLETE) &&
+              !devices()[0]->IsHwEventReady(command->event())) {
+            ready = false;
+            break;
+          }
+        }
+        auto current = it++;
+        if (ready) {
+          passed.splice(passed.end(), deferred_frees_, current);
+        }
+      }
+    }
+  }
+
+  // The GPU waits and the release happen outside of the lock, so hipFree never stalls on them
+  size_t released = 0;
+  for (auto& it : passed) {
+    for (auto command : it.commands_) {
+      if (wait) {
+        command->awaitCompletion();
+      }
+      command->release();
+    }
+    released += it.memory_->getSize();
+    it.memory_->release();
+  }
+  if (released != 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Reclaimed %zu deferred frees, %zu bytes",
+            passed.size(), released);
+  }
+  return released;
+}
+
+// ================================================================================================
+void* Device::AcquireBounceBuffer(size_t size) {
+  auto idle = [this](const BounceBuffer& buffer) {
+    return !buffer.busy_ && ((buffer.command_ == nullptr) ||
+                             (buffer.command_->status() == CL_COMPLETE) ||
+                             devices()[0]->IsHwEventReady(buffer.command_->event()));
+  };
+  amd::ScopedLock lock(bounce_lock_);
+  // Take the smallest idle buffer, which fits the copy
+  BounceBuffer* best = nullptr;
+  for (auto& it : bounce_buffers_) {
+    if ((it.size_ >= size) && ((best == nullptr) || (it.size_ < best->size_)) && idle(it)) {
+      best = &it;
+    }
+  }
+  if (best != nullptr) {
+    if (best->command_ != nullptr) {
+      best->command_->release();
+      best->command_ = nullptr;
+    }
+    best->busy_ = true;
+    return best->ptr_;
+  }
+
+  // Replace the idle buffers, which are too small, if the pool can't grow
+  const size_t limit = static_cast<size_t>(HIP_ASYNC_STAGING_POOL_SIZE) * Mi;
+  const size_t alloc_size = amd::alignUp(size, 2 * Mi);
+  for (auto it = bounce_buffers_.begin();
+       (bounce_size_ + alloc_size > limit) && (it != bounce_buffers_.end());) {
+    if (idle(*it)) {
+      if (it->command_ != nullptr) {
+        it->command_->release();
+      }
+      amd::SvmBuffer::free(*hip::host_context, it->ptr_);
+      bounce_size_ -= it->size_;
+      it = bounce_buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (bounce_size_ + alloc_size > limit) {
+    return nullptr;
+  }
+  void* ptr = amd::SvmBuffer::malloc(*hip::host_context, CL_MEM_SVM_FINE_GRAIN_BUFFER,
+                                     alloc_size, devices()[0]->info().memBaseAddrAlign_,
+                                     context_->svmDevices()[0]);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  bounce_buffers_.push_back({ptr, alloc_size, nullptr, true});
+  bounce_size_ += alloc_size;
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Bounce buffer: %p, size %zu, pool size %zu", ptr,
+          alloc_size, bounce_size_);
+  return ptr;
+}
+
+// ================================================================================================
+void Device::ReleaseBounceBuffer(void* ptr, amd::Command* command) {
+  amd::ScopedLock lock(bounce_lock_);
+  for (auto& it : bounce_buffers_) {
+    if (it.ptr_ == ptr) {
+      if (command != nullptr) {
+        command->retain();
+      }
+      it.command_ = command;
+      it.busy_ = false;
+      return;
+    }
+  }
+  ShouldNotReachHere();
+}
+
+// ================================================================================================
+void Device::FreeBounceBuffers() {
+  amd::ScopedLock lock(bounce_lock_);
+  for (auto& it : bounce_buffers_) {
+    if (it.command_ != nullptr) {
+      it.command_->awaitCompletion();
+      it.command_->release();
+    }
+    amd::SvmBuffer::free(*hip::host_context, it.ptr_);
+  }
+  bounce_buffers_.clear();
+  bounce_size_ = 0;
+}
+
 // ================================================================================================
 void Device::RemoveStreamFromPools(Stream* stream) {
   amd::ScopedLock lock(lock_);
@@ -154,6 +367,9 @@ void Device::Reset() {
     mem_pools_.clear();
   }
   flags_ = hipDeviceScheduleSpin;
+  // The deferred frees and the bounce buffers hold the commands of the streams
+  ReclaimDeferredFrees(true);
+  FreeBounceBuffers();
   destroyAllStreams();
   amd::MemObjMap::Purge(devices()[0]);
   Create();
@@ -163,9 +379,17 @@ void Device::Reset() {
 void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stream) {
   amd::Command::EventWaitList eventWaitList(0);
   bool submitMarker = 0;
-
-  auto waitForStream = [&submitMarker,
-                         &eventWaitList](hip::Stream* stream) {
+  // The streams and their epochs, covered by the wait
+  std::vector<std::pair<std::atomic<uint64_t>*, uint64_t>> waitedEpochs;
+
+  auto waitForStream = [&submitMarker, &eventWaitList,
+                         &waitedEpochs](hip::Stream* stream, std::atomic<uint64_t>* waited) {
+    // The epoch is read before the command, so a newer command only repeats the wait next time
+    uint64_t epoch = stream->enqueueEpoch();
+    if ((waited != nullptr) && (epoch == waited->load(std::memory_order_acquire))) {
+      // Nothing was enqueued since the last wait on this stream
+      return;
+    }
     if (amd::Command *command = stream->getLastQueuedCommand(true)) {
       amd::Event &event = command->event();
       // Check HW status of the ROCcrl event.
@@ -183,13 +407,24 @@ void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stre
         command->release();
       }
     }
+    if (waited != nullptr) {
+      waitedEpochs.push_back({waited, epoch});
+    }
   };
 
+  // The epochs track the waits of the null stream only
+  const bool null_wait = (blocking_stream == null_stream_);
+  uint64_t blocking_epoch = 0;
   if (wait_null_stream) {
     if (null_stream_) {
-      waitForStream(null_stream_);
+      waitForStream(null_stream_, &blocking_stream->WaitedNullEpoch());
     }
   } else {
+    blocking_epoch = blocking_epoch_.load(std::memory_order_acquire);
+    if (null_wait && (blocking_epoch == waited_blocking_epoch_.load(std::memory_order_acquire))) {
+      // No blocking stream enqueued anything since the last wait of the null stream
+      return;
+    }
     auto activeQueues = blocking_stream->device().getActiveQueues();
     for (const auto& command : activeQueues) {
       hip::Stream* active_stream = static_cast<hip::Stream*>(command);
@@ -198,7 +433,7 @@ void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stre
         // and it's not the current stream
         (active_stream != blocking_stream)) {
         // Get the last valid command
-        waitForStream(active_stream);
+        waitForStream(active_stream, null_wait ? &active_stream->WaitedEpoch() : nullptr);
       }
     }
   }
@@ -212,6 +447,15 @@ void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stre
     }
   }
 
+  // Publish the epochs only after the marker was enqueued, so a concurrent wait can't skip the
+  // streams before the marker is in the queue
+  for (const auto& it : waitedEpochs) {
+    it.first->store(it.second, std::memory_order_release);
+  }
+  if (null_wait && !wait_null_stream) {
+    waited_blocking_epoch_.store(blocking_epoch, std::memory_order_release);
+  }
+
   // Release all active commands. It's safe after the marker was enqueued
   for (const auto& it : eventWaitList) {
     it->release();
@@ -222,26 +466,73 @@ void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stre
 void Device::AddStream(Stream* stream) {
   std::unique_lock lock(streamSetLock);
   streamSet.insert(stream);
+  StreamRegistry::Get().Add(stream);
 }
 
 // ================================================================================================
 void Device::RemoveStream(Stream* stream){
   std::unique_lock lock(streamSetLock);
+  StreamRegistry::Get().Remove(stream);
   streamSet.erase(stream);
 }
 
 // ================================================================================================
-bool Device::StreamExists(Stream* stream){
-  std::shared_lock lock(streamSetLock);
-  if (streamSet.find(stream) != streamSet.end()) {
-    return true;
+bool Device::RecycleStream(Stream* stream) {
+  if (!stream->GetCUMask().empty()) {
+    // The queues with custom CU masks aren't shared, hence they return to ROCr
+    return false;
   }
-  return false;
+  {
+    amd::ScopedLock lock(lock_);
+    if (idle_streams_.size() >= HIP_STREAM_POOL_SIZE) {
+      return false;
+    }
+    // The handle becomes invalid, as after a regular destroy. The submitted work still runs to
+    // completion and the next owner's work is ordered after it
+    RemoveStream(stream);
+    stream->ResetForReuse();
+    idle_streams_.push_back(stream);
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Stream %p returned to the stream pool", stream);
+  return true;
+}
+
+// ================================================================================================
+Stream* Device::TakeIdleStream(Stream::Priority priority, unsigned int flags) {
+  Stream* stream = nullptr;
+  {
+    amd::ScopedLock lock(lock_);
+    // The oldest streams go first, since their work most likely finished
+    auto it = std::find_if(idle_streams_.begin(), idle_streams_.end(), [&](Stream* idle) {
+      return (idle->GetPriority() == priority) && (idle->Flags() == flags);
+    });
+    if (it == idle_streams_.end()) {
+      return nullptr;
+    }
+    stream = *it;
+    idle_streams_.erase(it);
+  }
+  AddStream(stream);
+  ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Stream %p taken from the stream pool", stream);
+  return stream;
+}
+
+// ================================================================================================
+bool Device::StreamExists(Stream* stream){
+  // The registry confirms the handle is live, before the stream can be accessed
+  return StreamRegistry::Get().Exists(stream) && (stream->GetDevice() == this);
 }
 
 // ================================================================================================
 void Device::destroyAllStreams() {
   std::vector<Stream*> toBeDeleted;
+  {
+    // The pooled graph streams are destroyed with all other streams
+    amd::ScopedLock lock(lock_);
+    graph_streams_.clear();
+    next_graph_stream_ = 0;
+    toBeDeleted.swap(idle_streams_);
+  }
   {
     std::shared_lock lock(streamSetLock);
     for (auto& it : streamSet) {
@@ -257,10 +548,46 @@ void Device::destroyAllStreams() {
 }
 
 // ================================================================================================
-void Device::SyncAllStreams(bool cpu_wait, bool wait_blocking_streams_only) {
-  // Make a local copy to avoid stalls for GPU finish with multiple threads
-  std::vector<hip::Stream*> streams;
-  streams.reserve(streamSet.size());
+bool Device::LeaseGraphStreams(uint32_t num_streams, std::vector<Stream*>& streams) {
+  amd::ScopedLock lock(lock_);
+  // The pool has a stream per HW queue, unless a graph requires more streams for the launch.
+  // The launches of different graphs rotate over the pool to spread the work across the queues
+  const size_t pool_size = std::max<size_t>(GPU_MAX_HW_QUEUES, num_streams);
+  while (graph_streams_.size() < pool_size) {
+    auto stream = new Stream(this, Stream::Priority::Normal, hipStreamNonBlocking);
+    if (stream == nullptr || !stream->Create()) {
+      if (stream != nullptr) {
+        Stream::Destroy(stream);
+      }
+      ClPrint(amd::LOG_ERROR, amd::LOG_CODE, "[hipGraph] Failed to create parallel stream!");
+      return false;
+    }
+    graph_streams_.push_back(stream);
+  }
+  streams.resize(num_streams);
+  for (uint32_t i = 0; i < num_streams; ++i) {
+    streams[i] = graph_streams_[(next_graph_stream_ + i) % graph_streams_.size()];
+  }
+  if (GPU_HW_QUEUE_LOAD_BALANCE && (num_streams < graph_streams_.size())) {
+    // Lease the streams on the least loaded HW queues, the rotation breaks the ties
+    std::vector<std::pair<uint64_t, Stream*>> candidates(graph_streams_.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      Stream* stream = graph_streams_[(next_graph_stream_ + i) % graph_streams_.size()];
+      candidates[i] = {stream->vdev()->hwQueueLoad(), stream};
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (uint32_t i = 0; i < num_streams; ++i) {
+      streams[i] = candidates[i].second;
+    }
+  }
+  next_graph_stream_ = (next_graph_stream_ + num_streams) % graph_streams_.size();
+  return true;
+}
+
+// ================================================================================================
+void Device::CollectStreams(std::vector<hip::Stream*>& streams, bool wait_blocking_streams_only) {
+  streams.reserve(streams.size() + streamSet.size());
   {
     std::shared_lock lock(streamSetLock);
     if (wait_blocking_streams_only) {
@@ -283,14 +610,56 @@ void Device::SyncAllStreams(bool cpu_wait, bool wait_blocking_streams_only) {
       }
     }
   }
+}
+
+// ================================================================================================
+void Device::FinishStreams(std::vector<hip::Stream*>& streams, bool cpu_wait) {
+  // Wait for the last commands of all streams with one multi-wait, instead of a blocking wait
+  // per stream. The finish below then only retires the completed commands
+  if (streams.size() > 1) {
+    std::vector<amd::Event*> events;
+    events.reserve(streams.size());
+    for (auto it : streams) {
+      if (amd::Command* command = it->getLastQueuedCommand(true)) {
+        events.push_back(&command->event());
+      }
+    }
+    if (events.size() > 1) {
+      streams[0]->device().WaitHwEvents(events);
+    }
+    for (auto it : events) {
+      it->release();
+    }
+  }
   for (auto it : streams) {
     it->finish(cpu_wait);
     it->release();
   }
+}
+
+// ================================================================================================
+void Device::SyncAllStreams(bool cpu_wait, bool wait_blocking_streams_only) {
+  // Make a local copy to avoid stalls for GPU finish with multiple threads
+  std::vector<hip::Stream*> streams;
+  CollectStreams(streams, wait_blocking_streams_only);
+  FinishStreams(streams, cpu_wait);
   // Release freed memory for all memory pools on the device
   ReleaseFreedMemory();
 }
 
+// ================================================================================================
+void Device::SyncDevices(const std::vector<Device*>& devices, bool cpu_wait) {
+  // The streams of all devices share one multi-wait
+  std::vector<hip::Stream*> streams;
+  for (auto device : devices) {
+    device->CollectStreams(streams, false);
+  }
+  FinishStreams(streams, cpu_wait);
+  for (auto device : devices) {
+    device->ReleaseFreedMemory();
+  }
+}
+
 // ================================================================================================
 bool Device::StreamCaptureBlocking() {
   std::shared_lock lock(streamSetLock);
@@ -315,6 +684,11 @@ bool Device::existsActiveStreamForDevice() {
 
 // ================================================================================================
 Device::~Device() {
+  // Stop the background release before the pools are destroyed
+  delete reclaimer_;
+  ReclaimDeferredFrees(true);
+  FreeBounceBuffers();
+
   if (default_mem_pool_ != nullptr) {
     default_mem_pool_->release();
   }
@@ -323,12 +697,25 @@ Device::~Device() {
     graph_mem_pool_->release();
   }
 
+  for (auto stream : graph_streams_) {
+    hip::Stream::Destroy(stream);
+  }
+  for (auto stream : idle_streams_) {
+    hip::Stream::Destroy(stream);
+  }
+
   if (null_stream_ != nullptr) {
     hip::Stream::Destroy(null_stream_);
   }
 }
 
 void ihipDestroyDevice() {
+  if (HIP_ALLOC_REPORT) {
+    for (auto deviceHandle : g_devices) {
+      deviceHandle->PrintPoolReport();
+    }
+    amd::AllocTrace::Report();
+  }
   for (auto deviceHandle : g_devices) {
     delete deviceHandle;
   }
@@ -645,6 +645,33 @@ hipError_t hipDeviceSynchronize() {
   HIP_RETURN(hipSuccess);
 }
 
+hipError_t hipExtDevicesSynchronize(const int* devices, unsigned int numDevices) {
+  HIP_INIT_API(hipExtDevicesSynchronize, devices, numDevices);
+  CHECK_SUPPORTED_DURING_CAPTURE();
+
+  if (devices == nullptr && numDevices != 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  // No device list synchronizes all devices
+  std::vector<hip::Device*> sync_devices;
+  if (numDevices == 0) {
+    sync_devices = g_devices;
+  } else {
+    for (unsigned int i = 0; i < numDevices; ++i) {
+      if (devices[i] < 0 || static_cast<size_t>(devices[i]) >= g_devices.size()) {
+        HIP_RETURN(hipErrorInvalidDevice);
+      }
+      if (std::find(sync_devices.begin(), sync_devices.end(), g_devices[devices[i]]) ==
+          sync_devices.end()) {
+        sync_devices.push_back(g_devices[devices[i]]);
+      }
+    }
+  }
+  constexpr bool kDoWaitForCpu = false;
+  hip::Device::SyncDevices(sync_devices, kDoWaitForCpu);
+  HIP_RETURN(hipSuccess);
+}
+
 int ihipGetDevice() {
   hip::Device* device = hip::getCurrentDevice();
   if (device == nullptr) {
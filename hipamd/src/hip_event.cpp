@@ -32,36 +32,35 @@ static amd::Monitor eventSetLock{};
 static std::unordered_set<hipEvent_t> eventSet;
 
 bool Event::ready() {
-  if (event_->status() != CL_COMPLETE) {
-    event_->notifyCmdQueue();
+  // The status is set by the batch completion, hence the signal is read only before it
+  if (event_->status() == CL_COMPLETE) {
+    return true;
   }
+  event_->notifyCmdQueue();
   // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
-  bool ready = CheckHwEvent();
-  if (!ready) {
-    ready = (event_->status() == CL_COMPLETE);
-  }
-  return ready;
+  return CheckHwEvent() || (event_->status() == CL_COMPLETE);
 }
 
 bool EventDD::ready() {
-  // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
-  bool ready = CheckHwEvent();
-  // FIXME: Remove status check entirely
-  if (!ready) {
-    ready = (event_->status() == CL_COMPLETE);
+  // The markers with a batch are completed by the signal handler of ROCr, which waits for all
+  // the completion signals of the process at once, so the signal isn't read after that
+  if (event_->status() == CL_COMPLETE) {
+    return true;
   }
-  return ready;
+  // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
+  return CheckHwEvent() || (event_->status() == CL_COMPLETE);
 }
 
 hipError_t Event::query() {
   amd::ScopedLock lock(lock_);
 
   // If event is not recorded, event_ is null, hence return hipSuccess
-  if (event_ == nullptr) {
+  if (event_ == nullptr || completed_) {
     return hipSuccess;
   }
 
-  return ready() ? hipSuccess : hipErrorNotReady;
+  completed_ = ready();
+  return completed_ ? hipSuccess : hipErrorNotReady;
 }
 
 // ================================================================================================
@@ -123,7 +122,10 @@ hipError_t Event::elapsedTime(Event& eStop, float& ms) {
     return hipErrorNotReady;
   }
 
-  if (event_ == eStop.event_) {
+  if ((event_ == eStop.event_) && (reused_ || eStop.reused_)) {
+    // Both events were recorded on the same command without any work in between
+    ms = 0.f;
+  } else if (event_ == eStop.event_) {
     // Events are the same, which indicates the stream is empty and likely
     // eventRecord is called on another stream. For such cases insert and measure a
     // marker.
@@ -203,6 +205,11 @@ hipError_t Event::streamWait(hipStream_t stream, uint flags) {
   if (!event_->notifyCmdQueue()) {
     return hipErrorLaunchOutOfResources;
   }
+  if (AMD_DIRECT_DISPATCH && HIP_COALESCE_STREAM_WAITS) {
+    // The consecutive waits on the stream become a single marker before the next command
+    hip_stream->addPendingWait(*event_);
+    return hipSuccess;
+  }
   amd::Command* command;
   hipError_t status = streamWaitCommand(command, hip_stream);
   if (status != hipSuccess) {
@@ -216,18 +223,22 @@ hipError_t Event::streamWait(hipStream_t stream, uint flags) {
   return hipSuccess;
 }
 
+// ================================================================================================
+int32_t Event::releaseScope(uint32_t ext_flags) const {
+  int32_t releaseFlags = ((ext_flags == 0) ? flags_ : ext_flags) &
+                          (hipEventReleaseToDevice | hipEventReleaseToSystem |
+                           hipEventDisableSystemFence);
+  if (releaseFlags & hipEventDisableSystemFence) {
+    return amd::Device::kCacheStateIgnore;
+  }
+  return amd::Device::kCacheStateInvalid;
+}
+
 // ================================================================================================
 hipError_t Event::recordCommand(amd::Command*& command, amd::HostQueue* stream,
                                 uint32_t ext_flags, bool batch_flush) {
   if (command == nullptr) {
-    int32_t releaseFlags = ((ext_flags == 0) ? flags_ : ext_flags) &
-                            (hipEventReleaseToDevice | hipEventReleaseToSystem |
-                             hipEventDisableSystemFence);
-    if (releaseFlags & hipEventDisableSystemFence) {
-      releaseFlags = amd::Device::kCacheStateIgnore;
-    } else {
-      releaseFlags = amd::Device::kCacheStateInvalid;
-    }
+    int32_t releaseFlags = releaseScope(ext_flags);
     // Always submit a EventMarker.
     command = new hip::EventMarker(*stream, !kMarkerDisableFlush, true, releaseFlags, batch_flush);
   }
@@ -243,6 +254,8 @@ hipError_t Event::enqueueRecordCommand(hipStream_t stream, amd::Command* command
   }
   event_ = &command->event();
   unrecorded_ = !record;
+  reused_ = false;
+  completed_ = false;
 
   return hipSuccess;
 }
@@ -253,6 +266,10 @@ hipError_t Event::addMarker(hipStream_t stream, amd::Command* command,
   hip::Stream* hip_stream = hip::getStream(stream);
   // Keep the lock always at the beginning of this to avoid a race. SWDEV-277847
   amd::ScopedLock lock(lock_);
+  if ((command == nullptr) && record && HIP_EVENT_RECORD_REUSE &&
+      attachToLastCommand(hip_stream)) {
+    return hipSuccess;
+  }
   hipError_t status = recordCommand(command, hip_stream, 0, batch_flush);
   if (status != hipSuccess) {
     return hipSuccess;
@@ -261,6 +278,37 @@ hipError_t Event::addMarker(hipStream_t stream, amd::Command* command,
   return status;
 }
 
+// ================================================================================================
+bool EventDD::attachToLastCommand(hip::Stream* stream) {
+  amd::Command* last = stream->getLastQueuedCommand(true);
+  if (last == nullptr) {
+    return false;
+  }
+  // The command must have the completion signal with the timestamps, so the queries and
+  // the timing work as for a marker. Its release must cover the scope of the event release
+  int32_t scope = releaseScope(0);
+  int32_t last_scope = last->getEventScope();
+  bool scope_ok = (scope == amd::Device::kCacheStateIgnore) ||
+                  (last_scope == amd::Device::kCacheStateSystem) ||
+                  ((last->type() == CL_COMMAND_MARKER) &&
+                   (last_scope != amd::Device::kCacheStateIgnore));
+  if ((last->HwEvent() == nullptr) || !last->profilingInfo().marker_ts_ || !scope_ok) {
+    last->release();
+    return false;
+  }
+  ClPrint(amd::LOG_DEBUG, amd::LOG_CMD, "Event %p reuses command %p on stream %p", this, last,
+          stream);
+  if (event_ != nullptr) {
+    event_->release();
+  }
+  // The reference from getLastQueuedCommand() is kept by the event
+  event_ = &last->event();
+  unrecorded_ = false;
+  reused_ = true;
+  completed_ = false;
+  return true;
+}
+
 // ================================================================================================
 bool isValid(hipEvent_t event) {
   // NULL event is always valid
@@ -67,6 +67,10 @@ class LaunchHostFuncCallback : public StreamCallback {
 
 void CL_CALLBACK ihipStreamCallback(cl_event event, cl_int command_exec_status, void* user_data);
 
+//! Runs the callback on the host after the queued work of the stream, the later work of the
+//! stream waits for the callback
+hipError_t ihipEnqueueStreamCallback(hip::Stream* stream, StreamCallback* cbo);
+
 
 #define IPC_SIGNALS_PER_EVENT 32
 typedef struct ihipIpcEventShmem_s {
@@ -105,7 +109,8 @@ class Event {
   constexpr static bool kBatchFlush = true;  //!< Flushes CPU command batch in direct dispatch mode
 
   Event(uint32_t flags) : flags_(flags), lock_(true) /* hipEvent_t lock*/,
-                              event_(nullptr), unrecorded_(false), stream_(nullptr) {
+                              event_(nullptr), unrecorded_(false), reused_(false),
+                              completed_(false), stream_(nullptr) {
     // No need to init event_ here as addMarker does that
     device_id_ = hip::getCurrentDevice()->deviceId();  // Created in current device ctx
   }
@@ -130,6 +135,8 @@ class Event {
   virtual hipError_t enqueueRecordCommand(hipStream_t stream, amd::Command* command, bool record);
   hipError_t addMarker(hipStream_t stream, amd::Command* command,
                        bool record, bool batch_flush = true);
+  /// Records the event on the last command of the stream, if it already has a HW signal
+  virtual bool attachToLastCommand(hip::Stream* stream) { return false; }
 
   void BindCommand(amd::Command& command, bool record) {
     amd::ScopedLock lock(lock_);
@@ -138,6 +145,8 @@ class Event {
     }
     event_ = &command.event();
     unrecorded_ = !record;
+    reused_ = false;
+    completed_ = false;
     command.retain();
   }
 
@@ -167,6 +176,9 @@ class Event {
   virtual int64_t time(bool getStartTs) const;
 
  protected:
+  /// Returns the cache scope of the event release
+  int32_t releaseScope(uint32_t ext_flags) const;
+
   amd::Monitor lock_;
   hip::Stream* stream_;
   amd::Event* event_;
@@ -175,6 +187,11 @@ class Event {
   //! hip*ModuleLaunchKernel API which takes start and stop events so no
   //! hipEventRecord is called. Cleanup needed once those APIs are deprecated.
   bool unrecorded_;
+  //! The event shares the command of a previous record on the same stream, hence nothing
+  //! executed in between
+  bool reused_;
+  //! The recorded command was found complete, the later queries don't look at the signal
+  bool completed_;
 };
 
 class EventDD : public Event {
@@ -182,6 +199,7 @@ class EventDD : public Event {
   EventDD(unsigned int flags) : Event(flags) {}
   virtual ~EventDD() {}
 
+  virtual bool attachToLastCommand(hip::Stream* stream);
   virtual bool awaitEventCompletion();
   virtual bool ready();
   virtual int64_t time(bool getStartTs) const;
@@ -21,6 +21,8 @@
 #include <hip/hip_runtime.h>
 
 #include "hip_event.hpp"
+
+#include <limits>
 #if !defined(_MSC_VER)
 #include <unistd.h>
 #else
@@ -128,6 +130,15 @@ hipError_t IPCEvent::streamWait(hipStream_t stream, uint flags) {
 
   amd::ScopedLock lock(lock_);
   if(query() != hipSuccess) {
+    if (!GPU_STREAMOPS_CP_WAIT) {
+      // The queue waits on the signal slot, which the producer device clears on the record
+      // completion, so neither the calling thread nor a host callback is involved
+      int offset = ipc_evt_.ipc_shmem_->read_index % IPC_SIGNALS_PER_EVENT;
+      return ihipStreamOperation(stream, ROCCLR_COMMAND_STREAM_WAIT_VALUE,
+                                 &(ipc_evt_.ipc_shmem_->signal[offset]), 0,
+                                 std::numeric_limits<uint32_t>::max(), hipStreamWaitValueEq,
+                                 sizeof(uint32_t));
+    }
     amd::Command* command;
     hipError_t status = streamWaitCommand(command, hip_stream);
     if (status != hipSuccess) {
@@ -22,10 +22,14 @@ THE SOFTWARE.
 
 #include "hip_fatbin.hpp"
 
+#include <set>
 #include <unordered_map>
 #include "hip_code_object.hpp"
+#include "hip_co_cache.hpp"
 #include "hip_platform.hpp"
 #include "comgrctx.hpp"
+#include "platform/runtime.hpp"
+#include "thread/threadpool.hpp"
 
 namespace hip {
 
@@ -62,6 +66,16 @@ FatBinaryInfo::~FatBinaryInfo() {
       delete fbd;
     }
   }
+  for (const auto& image : generic_images_) {
+    if (image.second == 0 && image.first != image_) {
+      toDelete.insert(image.first);
+    }
+  }
+  // The code objects from the shared cache are mapped, not allocated
+  for (const auto& image : shared_images_) {
+    toDelete.erase(image.first);
+    SharedCodeCache::Unmap(image.first, image.second);
+  }
   for (auto itemData : toDelete) {
     LogPrintfInfo("~FatBinaryInfo(%p) will delete binary_image_ %p", this, itemData);
     delete[] reinterpret_cast<const char*>(itemData);
@@ -450,14 +464,77 @@ hipError_t FatBinaryInfo::AddDevProgram(const int device_id) {
   return hipSuccess;
 }
 
+// ================================================================================================
+void FatBinaryInfo::SpecializeGenericTarget(const int device_id) {
+  FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[device_id];
+  SharedCodeCache* cache = SharedCodeCache::get();
+  if ((cache == nullptr) || fbd_info->add_dev_prog_ ||
+      (fbd_info->binary_size_ < sizeof(Elf64_Ehdr)) ||
+      !CodeObject::isGenericTarget(fbd_info->binary_image_)) {
+    return;
+  }
+  const std::string isa = g_devices[device_id]->devices()[0]->isa().isaName();
+  const std::string key = SharedCodeCache::SpecializedKey(fbd_info->binary_image_,
+                                                          fbd_info->binary_size_, isa);
+  const void* code = nullptr;
+  size_t size = 0;
+  if (cache->Map(key, &code, &size)) {
+    LogPrintfInfo("Loading the code object specialized for %s instead of the generic one",
+                  isa.c_str());
+    generic_images_.push_back(std::make_pair(fbd_info->binary_image_, fbd_info->binary_offset_));
+    shared_images_.push_back(std::make_pair(code, size));
+    fbd_info->binary_image_ = code;
+    fbd_info->binary_size_ = size;
+    fbd_info->binary_offset_ = 0;
+    return;
+  }
+
+  const char* bitcode = nullptr;
+  size_t bitcode_size = 0;
+  if (!CodeObject::getEmbeddedBitcode(fbd_info->binary_image_, fbd_info->binary_size_, &bitcode,
+                                      &bitcode_size)) {
+    LogPrintfInfo("Generic code object for %s has no embedded bitcode to specialize",
+                  isa.c_str());
+    return;
+  }
+  // Each code object is specialized once per process, the later loads map the result
+  static std::mutex scheduled_lock;
+  static std::set<std::string> scheduled;
+  {
+    std::lock_guard<std::mutex> lock(scheduled_lock);
+    if (!scheduled.insert(key).second) {
+      return;
+    }
+  }
+  // The task keeps a copy of the bitcode, since the module may be unloaded meanwhile
+  auto input = std::make_shared<std::vector<char>>(bitcode, bitcode + bitcode_size);
+  LogPrintfInfo("Specializing the generic code object for %s in the background", isa.c_str());
+  amd::ThreadPool::shared().enqueue([cache, key, isa, input]() {
+    std::vector<char> code_object;
+    if (CodeObject::compileBitcodeForIsa(input->data(), input->size(), isa, &code_object)) {
+      cache->Store(key, code_object.data(), code_object.size());
+    }
+  });
+}
+
 hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
 
   // Device Id Check and Add DeviceProgram if not added so far
   DeviceIdCheck(device_id);
+  if (!extract_pending_.empty() && extract_pending_[device_id]) {
+    // Extract the code object of this device only. The flag is cleared before the extraction,
+    // hence a failed lookup isn't repeated and the device reports an invalid kernel file later.
+    extract_pending_[device_id] = false;
+    IHIP_RETURN_ONFAIL(ExtractFatBinary({g_devices[device_id]}));
+  }
+  if (HIP_SPECIALIZE_GENERIC_TARGETS && (fatbin_dev_info_[device_id] != nullptr)) {
+    SpecializeGenericTarget(device_id);
+  }
   IHIP_RETURN_ONFAIL(AddDevProgram(device_id));
 
   // If Program was already built skip this step and return success
   FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[device_id];
+  amd::StartupProfile::Scope scope(amd::StartupProfile::BuildProgram, !fbd_info->prog_built_);
   if (fbd_info->prog_built_ == false) {
     if(CL_SUCCESS != fbd_info->program_->build(g_devices[device_id]->devices(),
                                                nullptr, nullptr, nullptr,
@@ -475,11 +552,36 @@ hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
 
 // ================================================================================================
 hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const void *data,
-    const std::vector<hip::Device*>& devices) {
+    const std::vector<hip::Device*>& all_devices) {
   hipError_t hip_status = hipSuccess;
   // At this line, image should be a valid ptr.
   guarantee(data != nullptr, "Image cannot be nullptr");
 
+  // Map the code objects, already unbundled by another process, from the shared cache and
+  // unbundle only the remaining devices
+  SharedCodeCache* cache = SharedCodeCache::get();
+  std::vector<hip::Device*> devices;
+  std::vector<std::string> cache_keys;
+  for (auto device : all_devices) {
+    std::string key;
+    if (cache != nullptr) {
+      key = SharedCodeCache::Key(data, device->devices()[0]->isa().isaName());
+      const void* code = nullptr;
+      size_t size = 0;
+      if (!key.empty() && cache->Map(key, &code, &size)) {
+        shared_images_.push_back(std::make_pair(code, size));
+        fatbin_dev_info_[device->deviceId()] = new FatBinaryDeviceInfo(code, size, 0);
+        fatbin_dev_info_[device->deviceId()]->program_ = new amd::Program(*device->asContext());
+        continue;
+      }
+    }
+    devices.push_back(device);
+    cache_keys.push_back(key);
+  }
+  if (devices.empty()) {
+    return hipSuccess;
+  }
+
   do {
     std::vector<std::pair<const void*, size_t>> code_objs;
     // Copy device names
@@ -492,6 +594,7 @@ hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const void *data,
     hip_status = CodeObject::extractCodeObjectFromFatBinaryUsingComgr(data, 0,
       device_names, code_objs);
     if (hip_status == hipErrorNoBinaryForGpu || hip_status == hipSuccess) {
+      std::set<std::string> stored_keys;
       for (size_t dev_idx = 0; dev_idx < devices.size(); ++dev_idx) {
         if (code_objs[dev_idx].first) {
           fatbin_dev_info_[devices[dev_idx]->deviceId()] =
@@ -502,6 +605,11 @@ hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const void *data,
           if (fatbin_dev_info_[devices[dev_idx]->deviceId()]->program_ == NULL) {
             break;
           }
+          // The devices with the same ISA share one code object
+          if (!cache_keys[dev_idx].empty() && stored_keys.insert(cache_keys[dev_idx]).second) {
+            cache->Store(cache_keys[dev_idx], code_objs[dev_idx].first,
+                         code_objs[dev_idx].second);
+          }
         } else {
           // This is the case of hipErrorNoBinaryForGpu which will finally fail app on device
           // without code object
@@ -83,6 +83,10 @@ public:
   hipError_t ExtractFatBinaryUsingCOMGR(const void* data,
                                               const std::vector<hip::Device*>& devices);
   hipError_t ExtractFatBinary(const std::vector<hip::Device*>& devices);
+
+  // Postpones the extraction for all devices until BuildProgram() of the device, so only the
+  // code objects of the devices in use are looked up in the bundle and loaded.
+  void DeferExtraction() { extract_pending_.assign(fatbin_dev_info_.size(), true); }
   hipError_t AddDevProgram(const int device_id);
   hipError_t BuildProgram(const int device_id);
 
@@ -110,6 +114,10 @@ public:
   }
 
 private:
+  // Replaces the generic target code object of the device with the code object, specialized
+  // for the device ISA from the shared cache, or compiles the specialization in the background
+  void SpecializeGenericTarget(const int device_id);
+
   std::string fname_;        //!< File name
   amd::Os::FileDesc fdesc_;  //!< File descriptor
   size_t fsize_;             //!< Total file size
@@ -125,6 +133,15 @@ private:
   // Per Device Info, like corresponding binary ptr, size.
   std::vector<FatBinaryDeviceInfo*> fatbin_dev_info_;
 
+  // Code objects mapped from the shared cache
+  std::vector<std::pair<const void*, size_t>> shared_images_;
+
+  // Generic target code objects, replaced by the specialized ones, and their offsets
+  std::vector<std::pair<const void*, size_t>> generic_images_;
+
+  // Devices, which code objects weren't extracted yet
+  std::vector<bool> extract_pending_;
+
   std::shared_ptr<UniqueFD> ufd_; //!< Unique file descriptor
 };
 
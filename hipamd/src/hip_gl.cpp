@@ -629,6 +629,15 @@ hipError_t hipGraphicsGLRegisterBuffer(hipGraphicsResource** resource, GLuint bu
   HIP_RETURN(hipSuccess);
 }
 
+// Waits for the GL fence of hipGraphicsMapResources on the stream callback thread
+static void ihipWaitGLFence(void* userData) {
+  amd::ClGlEvent* fence = reinterpret_cast<amd::ClGlEvent*>(userData);
+  if (!fence->awaitCompletion()) {
+    LogError("GL fence wait failed in the map of the graphics resources");
+  }
+  fence->release();
+}
+
 hipError_t hipGraphicsMapResources(int count, hipGraphicsResource_t* resources,
                                    hipStream_t stream) {
   HIP_INIT_API(hipGraphicsMapResources, count, resources, stream);
@@ -636,12 +645,6 @@ hipError_t hipGraphicsMapResources(int count, hipGraphicsResource_t* resources,
   if (!amdContext || !amdContext->glenv()) {
     HIP_RETURN(hipErrorUnknown);
   }
-  clearGLErrors(*amdContext);
-  amdContext->glenv()->glFinish_();
-  if (checkForGLError(*amdContext) != GL_NO_ERROR) {
-    HIP_RETURN(hipErrorUnknown);
-  }
-
   hip::Stream* hip_stream = hip::getStream(stream);
   if (nullptr == hip_stream) {
     HIP_RETURN(hipErrorUnknown);
@@ -658,6 +661,38 @@ hipError_t hipGraphicsMapResources(int count, hipGraphicsResource_t* resources,
     HIP_RETURN(err);
   }
 
+  // The pending GL work must finish before the stream accesses the resources. A GL fence keeps
+  // the stream order without a drain of the GL pipeline: the callback thread waits for it and
+  // the stream waits for the callback, so the application thread doesn't block
+  amd::GLFunctions* glenv = amdContext->glenv();
+  clearGLErrors(*amdContext);
+  amd::ClGlEvent* fence = nullptr;
+  if (AMD_OCL_GL_FENCE_SYNC) {
+    GLsync sync = glenv->glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (sync != nullptr) {
+      fence = new amd::ClGlEvent(*amdContext, true);
+      fence->data().emplace_back(sync);
+      glenv->glFlush_();
+    }
+  }
+  if (fence == nullptr) {
+    glenv->glFinish_();
+  }
+  if (checkForGLError(*amdContext) != GL_NO_ERROR) {
+    if (fence != nullptr) {
+      glenv->glDeleteSync_(reinterpret_cast<GLsync>(fence->data().back()));
+      fence->release();
+    }
+    HIP_RETURN(hipErrorUnknown);
+  }
+  if (fence != nullptr) {
+    err = hipLaunchHostFunc_common(stream, ihipWaitGLFence, fence);
+    if (err != hipSuccess) {
+      fence->awaitCompletion();
+      fence->release();
+    }
+  }
+
   amd::Command::EventWaitList nullWaitList;
 
   //! Now create command and enqueue
@@ -109,7 +109,7 @@ DeviceVar::~DeviceVar() {
 }
 
 //Device Functions
-DeviceFunc::DeviceFunc(std::string name, hipModule_t hmod) : dflock_("function lock"),
+DeviceFunc::DeviceFunc(std::string name, hipModule_t hmod) : dflock_("function lock", true),
                        name_(name), kernel_(nullptr) {
   amd::Program* program = as_amd(reinterpret_cast<cl_program>(hmod));
 
@@ -186,7 +186,27 @@ hipError_t Function::getStatFuncAttr(hipFuncAttributes* func_attr, int deviceId)
   if (dFunc_[deviceId] == nullptr) {
     dFunc_[deviceId] = new DeviceFunc(name_, hmod);
   }
+  fillStatFuncAttr(func_attr, deviceId);
+  return hipSuccess;
+}
+
+bool Function::findStatFunc(hipFunction_t* hfunc, int deviceId) const {
+  if (dFunc_.size() != g_devices.size() || dFunc_[deviceId] == nullptr) {
+    return false;
+  }
+  *hfunc = dFunc_[deviceId]->asHipFunction();
+  return true;
+}
 
+bool Function::findStatFuncAttr(hipFuncAttributes* func_attr, int deviceId) const {
+  if (dFunc_.size() != g_devices.size() || dFunc_[deviceId] == nullptr) {
+    return false;
+  }
+  fillStatFuncAttr(func_attr, deviceId);
+  return true;
+}
+
+void Function::fillStatFuncAttr(hipFuncAttributes* func_attr, int deviceId) const {
   const std::vector<amd::Device*>& devices = amd::Device::getDevices(CL_DEVICE_TYPE_GPU, false);
 
   amd::Kernel* kernel = dFunc_[deviceId]->kernel();
@@ -205,7 +225,6 @@ hipError_t Function::getStatFuncAttr(hipFuncAttributes* func_attr, int deviceId)
   func_attr->numRegs = static_cast<int>(wginfo->usedVGPRs_);
   func_attr->preferredShmemCarveout = 0;
   func_attr->ptxVersion = binaryVersion;
-  return hipSuccess;
 }
 
 //Abstract Vars
@@ -88,11 +88,16 @@ public:
   //Return Device Func & attr . Generate/build if not already done so.
   hipError_t getStatFunc(hipFunction_t *hfunc, int deviceId);
   hipError_t getStatFuncAttr(hipFuncAttributes* func_attr, int deviceId);
+  //Return Device Func & attr only if already generated, the lookup doesn't modify the function
+  bool findStatFunc(hipFunction_t* hfunc, int deviceId) const;
+  bool findStatFuncAttr(hipFuncAttributes* func_attr, int deviceId) const;
   void resize_dFunc(size_t size) { dFunc_.resize(size); }
   FatBinaryInfo** moduleInfo() { return modules_; }
   const std::string& name() const { return name_; }
 
 private:
+  void fillStatFuncAttr(hipFuncAttributes* func_attr, int deviceId) const;
+
   std::vector<DeviceFunc*> dFunc_;  //DeviceFuncObj per Device
   std::string name_;                //name of the func(not unique identifier)
   FatBinaryInfo** modules_;      // static module where it is referenced
@@ -31,6 +31,8 @@ namespace hip {
 std::vector<hip::Stream*> g_captureStreams;
 // StreamCaptureGlobalList lock
 amd::Monitor g_captureStreamsLock{};
+// StreamCaptureGlobalList changes, invalidates the capture state cached in TLS
+std::atomic<uint64_t> g_captureStreamsGeneration{0};
 // StreamCaptureset lock
 amd::Monitor g_streamSetLock{};
 std::unordered_set<hip::Stream*> g_allCapturingStreams;
@@ -55,16 +57,22 @@ inline hipError_t ihipGraphAddNode(hip::GraphNode* graphNode, hip::Graph* graph,
                                    hip::GraphNode* const* pDependencies, size_t numDependencies,
                                    bool capture = true) {
   graph->AddNode(graphNode);
+  // The stream capture passes a few dependencies, hence a lookup in the processed ones is
+  // cheaper than a set of the dependencies
+  constexpr size_t kMaxLinearDepSearch = 16;
   std::unordered_set<hip::GraphNode*> DuplicateDep;
   for (size_t i = 0; i < numDependencies; i++) {
     if ((!hip::GraphNode::isNodeValid(pDependencies[i])) ||
         (graph != pDependencies[i]->GetParentGraph())) {
       return hipErrorInvalidValue;
     }
-    if (DuplicateDep.find(pDependencies[i]) != DuplicateDep.end()) {
+    if (numDependencies <= kMaxLinearDepSearch) {
+      if (std::find(pDependencies, pDependencies + i, pDependencies[i]) != pDependencies + i) {
+        return hipErrorInvalidValue;
+      }
+    } else if (!DuplicateDep.insert(pDependencies[i]).second) {
       return hipErrorInvalidValue;
     }
-    DuplicateDep.insert(pDependencies[i]);
     pDependencies[i]->AddEdgeDep(graphNode);
   }
   if (capture == false) {
@@ -992,6 +1000,7 @@ hipError_t hipStreamBeginCapture_common(hipStream_t stream, hipStreamCaptureMode
   if (mode == hipStreamCaptureModeGlobal) {
     amd::ScopedLock lock(g_captureStreamsLock);
     g_captureStreams.push_back(s);
+    g_captureStreamsGeneration++;
   }
   {
     amd::ScopedLock lock(g_streamSetLock);
@@ -1073,6 +1082,7 @@ hipError_t hipStreamEndCapture_common(hipStream_t stream, hip::Graph** pGraph) {
   if (s->GetCaptureMode() == hipStreamCaptureModeGlobal) {
     amd::ScopedLock lock(g_captureStreamsLock);
     g_captureStreams.erase(std::find(g_captureStreams.begin(), g_captureStreams.end(), s));
+    g_captureStreamsGeneration++;
   }
   {
     amd::ScopedLock lock(g_streamSetLock);
@@ -1381,10 +1391,9 @@ hipError_t ihipGraphInstantiate(hip::GraphExec** pGraphExec, hip::Graph* graph,
     return hipErrorInvalidValue;
   }
   std::vector<hip::GraphNode*> graphNodes;
-  if (false == clonedGraph->TopologicalOrder(graphNodes)) {
+  if (false == graph->OrderAndSchedule(clonedGraph, graphNodes)) {
     return hipErrorInvalidValue;
   }
-  clonedGraph->ScheduleNodes();
   *pGraphExec = new hip::GraphExec(graphNodes, clonedGraph, clonedNodes, flags);
   if (*pGraphExec != nullptr) {
     graph->SetGraphInstantiated(true);
@@ -1482,6 +1491,8 @@ hipError_t hipGraphExecDestroy(hipGraphExec_t pGraphExec) {
     HIP_RETURN(hipErrorInvalidValue);
   }
   hip::GraphExec* ge = reinterpret_cast<hip::GraphExec*>(pGraphExec);
+  // The launches in flight keep the graph alive, until the GPU is done with them
+  ge->ReleaseLaunches();
   ge->release();
   HIP_RETURN(hipSuccess);
 }
@@ -1490,7 +1501,16 @@ hipError_t ihipGraphLaunch(hip::GraphExec* graphExec, hipStream_t stream) {
   if (!hip::isValid(stream)) {
     return hipErrorContextIsDestroyed;
   }
-  return graphExec->Run(stream);
+  GraphLaunchStats* stats = graphExec->GetLaunchStats();
+  if (stats == nullptr) {
+    return graphExec->Run(stream);
+  }
+  // Host time of the launch, from the entry into the runtime until all packets are published
+  uint64_t start = amd::Os::timeNanos();
+  hipError_t status = graphExec->Run(stream);
+  stats->Record(graphExec->GetLaunchPath(hip::getStream(stream)), amd::Os::timeNanos() - start,
+                amd::activity_prof::correlation_id);
+  return status;
 }
 
 hipError_t hipGraphLaunch_common(hip::GraphExec* graphExec, hipStream_t stream) {
@@ -32,7 +32,8 @@ hipError_t ihipMemcpy_validate(void* dst, const void* src, size_t sizeBytes, hip
 hipError_t ihipMemcpyCommand(amd::Command*& command, void* dst, const void* src, size_t sizeBytes,
                              hipMemcpyKind kind, hip::Stream& stream, bool isAsync = false);
 
-void ihipHtoHMemcpy(void* dst, const void* src, size_t sizeBytes, hip::Stream& stream);
+hipError_t ihipHtoHMemcpy(void* dst, const void* src, size_t sizeBytes, hip::Stream& stream,
+                          bool isHostAsync = false);
 
 bool IsHtoHMemcpy(void* dst, const void* src);
 
@@ -54,7 +55,7 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
                                    void** kernelParams, void** extra, hipEvent_t startEvent,
                                    hipEvent_t stopEvent, uint32_t flags, uint32_t params,
                                    uint32_t gridId, uint32_t numGrids, uint64_t prevGridSum,
-                                   uint64_t allGridSum, uint32_t firstDevice);
+                                   uint64_t allGridSum, uint32_t firstDevice, bool directArgs);
 
 hipError_t ihipMemcpy3DCommand(amd::Command*& command, const hipMemcpy3DParms* p,
                                hip::Stream* stream);
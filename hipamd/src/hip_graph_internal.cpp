@@ -19,6 +19,7 @@
  THE SOFTWARE. */
 
 #include "hip_graph_internal.hpp"
+#include <limits>
 #include <queue>
 
 #define CASE_STRING(X, C)                                                                          \
@@ -63,6 +64,8 @@ amd::Monitor Graph::graphSetLock_{};
 std::unordered_set<GraphExec*> GraphExec::graphExecSet_;
 // Guards global exec graph set
 amd::Monitor GraphExec::graphExecSetLock_{};
+amd::Monitor GraphKernelNode::node_pool_lock_{};
+std::vector<void*>* GraphKernelNode::node_pool_ = new std::vector<void*>();
 std::unordered_set<UserObject*> UserObject::ObjectSet_;
 // Guards global user object
 amd::Monitor UserObject::UserObjectLock_{};
@@ -116,7 +119,14 @@ bool Graph::isGraphValid(Graph* pGraph) {
   return true;
 }
 
+void GraphNode::StructureChanged() {
+  if (parentGraph_ != nullptr) {
+    parentGraph_->StructureChanged();
+  }
+}
+
 void Graph::AddNode(const Node& node) {
+  StructureChanged();
   vertices_.emplace_back(node);
   ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Add %s(%p)",
           GetGraphNodeTypeString(node->GetType()), node);
@@ -124,6 +134,7 @@ void Graph::AddNode(const Node& node) {
 }
 
 void Graph::RemoveNode(const Node& node) {
+  StructureChanged();
   vertices_.erase(std::remove(vertices_.begin(), vertices_.end(), node), vertices_.end());
   delete node;
 }
@@ -186,15 +197,7 @@ void Graph::ScheduleOneNode(Node node, int stream_id) {
         dep->signal_is_required_ |= true;
       }
     }
-    // Process child graph separately, since, there is no connection
-    if (node->GetType() == hipGraphNodeTypeGraph) {
-      auto child = reinterpret_cast<hip::ChildGraphNode*>(node)->childGraph_;
-      child->ScheduleNodes();
-      max_streams_ = std::max(max_streams_, child->max_streams_);
-      if (child->max_streams_ == 1) {
-        reinterpret_cast<hip::ChildGraphNode*>(node)->TopologicalOrder();
-      }
-    }
+    ScheduleChildGraph(node);
     for (auto edge: node->GetEdges()) {
       ScheduleOneNode(edge, stream_id);
       // 1. Each extra edge will get a new stream from the pool
@@ -204,6 +207,102 @@ void Graph::ScheduleOneNode(Node node, int stream_id) {
   }
 }
 
+// ================================================================================================
+void Graph::ScheduleChildGraph(Node node) {
+  // Process child graph separately, since, there is no connection
+  if (node->GetType() == hipGraphNodeTypeGraph) {
+    auto child = reinterpret_cast<hip::ChildGraphNode*>(node)->childGraph_;
+    child->ScheduleNodes();
+    max_streams_ = std::max(max_streams_, child->max_streams_);
+    if (child->max_streams_ == 1) {
+      reinterpret_cast<hip::ChildGraphNode*>(node)->TopologicalOrder();
+    }
+  }
+}
+
+// ================================================================================================
+void Graph::ListScheduleNodes() {
+  // Estimated cost of a cross-stream wait in the workload units
+  constexpr uint64_t kWaitCost = 16;
+  const uint32_t num_streams = std::max(DEBUG_HIP_FORCE_GRAPH_QUEUES, 1U);
+
+  std::vector<Node> order;
+  TopologicalOrder(order);
+
+  // Find the critical path length from every node to the graph exit
+  std::unordered_map<Node, uint64_t> path;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    uint64_t max_edge = 0;
+    for (auto edge : (*it)->GetEdges()) {
+      max_edge = std::max(max_edge, path[edge]);
+    }
+    path[*it] = (*it)->GetWorkload() + max_edge;
+  }
+
+  // Ready nodes are processed in the order of the longest remaining path
+  auto compare = [&path](Node a, Node b) {
+    return (path[a] != path[b]) ? (path[a] < path[b]) : (a->GetID() > b->GetID());
+  };
+  std::priority_queue<Node, std::vector<Node>, decltype(compare)> ready(compare);
+  std::unordered_map<Node, size_t> in_degree;
+  for (auto node : vertices_) {
+    in_degree[node] = node->GetInDegree();
+    if (node->GetInDegree() == 0) {
+      ready.push(node);
+    }
+  }
+
+  std::unordered_map<Node, uint64_t> finish;
+  std::vector<uint64_t> available(num_streams, 0);
+  while (!ready.empty()) {
+    Node node = ready.top();
+    ready.pop();
+
+    uint64_t ready_time = 0;
+    for (auto dep : node->GetDependencies()) {
+      ready_time = std::max(ready_time, finish[dep]);
+    }
+    // Pick the stream with the earliest start. A dependency on the same stream is satisfied
+    // by the in-order execution, the others require a wait
+    int stream_id = 0;
+    uint64_t best_start = std::numeric_limits<uint64_t>::max();
+    for (uint32_t i = 0; i < num_streams; ++i) {
+      uint64_t start = std::max(ready_time, available[i]);
+      for (auto dep : node->GetDependencies()) {
+        if (dep->stream_id_ != static_cast<int>(i)) {
+          start += kWaitCost;
+        }
+      }
+      if (start < best_start) {
+        best_start = start;
+        stream_id = i;
+      }
+    }
+
+    node->stream_id_ = stream_id;
+    finish[node] = best_start + node->GetWorkload();
+    available[stream_id] = finish[node];
+    max_streams_ = std::max(max_streams_, (stream_id + 1));
+    for (auto dep : node->GetDependencies()) {
+      if (dep->stream_id_ != node->stream_id_) {
+        dep->signal_is_required_ |= true;
+      }
+    }
+    // Fill in only the first root in the sequence
+    if ((node->GetDependencies().size() == 0) && (stream_id != 0) &&
+        (roots_[stream_id] == nullptr)) {
+      roots_[stream_id] = node;
+    }
+    ScheduleChildGraph(node);
+
+    for (auto edge : node->GetEdges()) {
+      if (--in_degree[edge] == 0) {
+        ready.push(edge);
+      }
+    }
+  }
+}
+
 // ================================================================================================
 void Graph::ScheduleNodes() {
   for (auto node : vertices_) {
@@ -212,6 +311,10 @@ void Graph::ScheduleNodes() {
   }
   memset(&roots_[0], 0, sizeof(Node) * roots_.size());
   max_streams_ = 0;
+  if (DEBUG_HIP_GRAPH_LIST_SCHEDULE) {
+    ListScheduleNodes();
+    return;
+  }
   // Start processing all nodes in the graph to find async executions.
   int stream_id = 0;
   for (auto node : vertices_) {
@@ -259,8 +362,79 @@ bool Graph::TopologicalOrder(std::vector<Node>& TopoOrder) {
   return false;
 }
 
+// ================================================================================================
+bool Graph::OrderAndSchedule(Graph* clonedGraph, std::vector<Node>& topoOrder) {
+  const std::vector<Node>& nodes = clonedGraph->vertices_;
+  // The list scheduling depends on the node workloads, which can change without the structure
+  const bool use_cache = !DEBUG_HIP_GRAPH_LIST_SCHEDULE;
+  if (use_cache && (scheduleCache_ != nullptr) && (scheduleCache_->version_ == structureVersion_) &&
+      (scheduleCache_->stream_ids_.size() == nodes.size())) {
+    topoOrder.reserve(nodes.size());
+    for (auto index : scheduleCache_->order_) {
+      topoOrder.push_back(nodes[index]);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      nodes[i]->stream_id_ = scheduleCache_->stream_ids_[i];
+      nodes[i]->signal_is_required_ = scheduleCache_->signals_[i];
+    }
+    for (size_t i = 0; i < clonedGraph->roots_.size(); ++i) {
+      int32_t index = scheduleCache_->roots_[i];
+      clonedGraph->roots_[i] = (index < 0) ? nullptr : nodes[index];
+    }
+    clonedGraph->max_streams_ = scheduleCache_->max_streams_;
+    // The structure of the child graphs isn't tracked, hence they are always scheduled
+    for (auto node : nodes) {
+      clonedGraph->ScheduleChildGraph(node);
+    }
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Reused the schedule of %zu nodes",
+            nodes.size());
+    return true;
+  }
+
+  if (!clonedGraph->TopologicalOrder(topoOrder)) {
+    return false;
+  }
+  clonedGraph->ScheduleNodes();
+  if (!use_cache) {
+    return true;
+  }
+
+  // The cloned vertices keep the order of the original vertices
+  std::unordered_map<Node, uint32_t> indices;
+  indices.reserve(nodes.size());
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    indices[nodes[i]] = i;
+  }
+  if (scheduleCache_ == nullptr) {
+    scheduleCache_.reset(new ScheduleCache());
+  }
+  ScheduleCache& cache = *scheduleCache_;
+  cache.version_ = structureVersion_;
+  cache.order_.clear();
+  cache.order_.reserve(topoOrder.size());
+  for (auto node : topoOrder) {
+    cache.order_.push_back(indices[node]);
+  }
+  cache.stream_ids_.resize(nodes.size());
+  cache.signals_.resize(nodes.size());
+  cache.max_streams_ = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    cache.stream_ids_[i] = nodes[i]->stream_id_;
+    cache.signals_[i] = nodes[i]->signal_is_required_;
+    cache.max_streams_ = std::max(cache.max_streams_, nodes[i]->stream_id_ + 1);
+  }
+  cache.roots_.resize(clonedGraph->roots_.size());
+  for (size_t i = 0; i < clonedGraph->roots_.size(); ++i) {
+    Node root = clonedGraph->roots_[i];
+    cache.roots_[i] = (root == nullptr) ? -1 : static_cast<int32_t>(indices[root]);
+  }
+  return true;
+}
+
 Graph* Graph::clone(std::unordered_map<Node, Node>& clonedNodes) const {
   Graph* newGraph = new Graph(device_, this);
+  clonedNodes.reserve(vertices_.size());
+  newGraph->vertices_.reserve(vertices_.size());
   for (auto entry : vertices_) {
     GraphNode* node = entry->clone();
     node->SetParentGraph(newGraph);
@@ -313,42 +487,80 @@ bool GraphExec::isGraphExecValid(GraphExec* pGraphExec) {
   return true;
 }
 
-hipError_t GraphExec::CreateStreams(uint32_t num_streams) {
-  parallel_streams_.reserve(num_streams);
-  for (uint32_t i = 0; i < num_streams; ++i) {
-    auto stream = new hip::Stream(hip::getCurrentDevice(),
-                                  hip::Stream::Priority::Normal, hipStreamNonBlocking);
-    if (stream == nullptr || !stream->Create()) {
-      if (stream != nullptr) {
-        hip::Stream::Destroy(stream);
-      }
-      ClPrint(amd::LOG_ERROR, amd::LOG_CODE, "[hipGraph] Failed to create parallel stream!");
-      return hipErrorOutOfMemory;
-    }
-    parallel_streams_.push_back(stream);
-  }
-  // Don't wait for other streams to finish.
-  // Capture stream is to capture AQL packet.
-  capture_stream_ = hip::getNullStream(false);
-  return hipSuccess;
-}
-
 // ================================================================================================
 hipError_t GraphExec::Init() {
   hipError_t status = hipSuccess;
-  // create extra stream to avoid queue collision with the default execution stream
-  status = CreateStreams(clonedGraph_->max_streams_);
-  if (status != hipSuccess) {
-    return status;
-  }
+  // Don't wait for other streams to finish.
+  // Capture stream is to capture AQL packet.
+  capture_stream_ = hip::getNullStream(false);
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     // For graph nodes capture AQL packets to dispatch them directly during graph launch.
     status = CaptureAQLPackets();
   }
   instantiateDeviceId_ = hip::getCurrentDevice()->deviceId();
+  if (HIP_LAUNCH_LATENCY) {
+    launchStats_.reset(new GraphLaunchStats());
+  }
+  if (HIP_MEM_POOL_USE_VM && HIP_GRAPH_MEM_PLAN) {
+    PlanGraphMemory();
+  }
   return status;
 }
 
+// ================================================================================================
+void GraphExec::PlanGraphMemory() {
+  // Only the allocations, freed inside the graph, return to the pool on every launch
+  std::unordered_set<void*> freed;
+  for (auto node : topoOrder_) {
+    if (node->GetType() == hipGraphNodeTypeMemFree) {
+      void* dptr = nullptr;
+      reinterpret_cast<GraphMemFreeNode*>(node)->GetParams(&dptr);
+      freed.insert(dptr);
+    }
+  }
+  if (freed.empty()) {
+    return;
+  }
+
+  // Walk the liveness of the allocations over the topological order. The allocations with
+  // disjoint lifetimes reuse the same physical memory from the pool, hence the launch needs
+  // only the peak of the live bytes
+  const size_t granularity =
+      g_devices[instantiateDeviceId_]->devices()[0]->info().virtualMemAllocGranularity_;
+  std::unordered_map<void*, size_t> live;
+  size_t live_size = 0;
+  size_t peak_size = 0;
+  size_t total_size = 0;
+  for (auto node : topoOrder_) {
+    if (node->GetType() == hipGraphNodeTypeMemAlloc) {
+      hipMemAllocNodeParams params;
+      reinterpret_cast<GraphMemAllocNode*>(node)->GetParams(&params);
+      if (freed.find(params.dptr) != freed.end()) {
+        size_t size = amd::alignUp(params.bytesize, granularity);
+        live[params.dptr] = size;
+        live_size += size;
+        total_size += size;
+        peak_size = std::max(peak_size, live_size);
+      }
+    } else if (node->GetType() == hipGraphNodeTypeMemFree) {
+      void* dptr = nullptr;
+      reinterpret_cast<GraphMemFreeNode*>(node)->GetParams(&dptr);
+      if (auto it = live.find(dptr); it != live.end()) {
+        live_size -= it->second;
+        live.erase(it);
+      }
+    }
+  }
+
+  // Hold the working set in the graph pool, so the replays don't return the memory to the OS
+  // on the synchronization points and then allocate it again
+  memPlanSize_ = peak_size;
+  clonedGraph_->mem_pool_->AddHoldSize(static_cast<int64_t>(memPlanSize_));
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL,
+          "Graph exec %p memory plan: peak %zu bytes, total %zu bytes", this, peak_size,
+          total_size);
+}
+
 //! Chunk size to add to kern arg pool
 constexpr uint32_t kKernArgChunkSize = 128 * Ki;
 // ================================================================================================
@@ -370,7 +582,8 @@ void GetKernelArgSizeForGraph(std::vector<hip::Node>& topoOrder,
 
 // ================================================================================================
 hipError_t AllocKernelArgForGraphNode(std::vector<hip::Node>& topoOrder,
-                                      hip::Stream* capture_stream, hip::GraphExec* graphExec) {
+                                      hip::Stream* capture_stream, hip::GraphExec* graphExec,
+                                      bool captureChildGraphs = true) {
   hipError_t status = hipSuccess;
   for (auto& node : topoOrder) {
     if (node->GetType() == hipGraphNodeTypeKernel) {
@@ -383,7 +596,7 @@ hipError_t AllocKernelArgForGraphNode(std::vector<hip::Node>& topoOrder,
     }
     if (node->GraphCaptureEnabled()) {
       node->CaptureAndFormPacket(capture_stream, graphExec->GetKernelArgManager());
-    } else if (node->GetType() == hipGraphNodeTypeGraph) {
+    } else if (captureChildGraphs && node->GetType() == hipGraphNodeTypeGraph) {
       auto childNode = reinterpret_cast<hip::ChildGraphNode*>(node);
       if (childNode->childGraph_->max_streams_ == 1) {
         childNode->SetGraphCaptureStatus(true);
@@ -402,7 +615,7 @@ hipError_t AllocKernelArgForGraphNode(std::vector<hip::Node>& topoOrder,
 // ================================================================================================
 hipError_t GraphExec::CaptureAQLPackets() {
   hipError_t status = hipSuccess;
-  if (clonedGraph_->max_streams_ == 1) {
+  if (clonedGraph_->max_streams_ == 1 || HIP_GRAPH_MULTI_STREAM_CAPTURE) {
     size_t kernArgSizeForGraph = 0;
     GetKernelArgSizeForGraph(topoOrder_, kernArgSizeForGraph);
     auto device = g_devices[ihipGetDevice()]->devices()[0];
@@ -412,21 +625,136 @@ hipError_t GraphExec::CaptureAQLPackets() {
       return hipErrorMemoryAllocation;
     }
 
-    status = AllocKernelArgForGraphNode(topoOrder_, capture_stream_, this);
+    // The child graphs of a multi-stream graph run through the command path, since the child
+    // nodes don't track the completion on their own streams
+    status = AllocKernelArgForGraphNode(topoOrder_, capture_stream_, this,
+                                        clonedGraph_->max_streams_ == 1);
     if (status != hipSuccess) {
       return status;
     }
+    // The fusion relies on the in-order execution of all nodes on a single stream
+    if (HIP_GRAPH_FUSE_MEMSET && clonedGraph_->max_streams_ == 1) {
+      status = FuseMemsetNodes();
+      if (status != hipSuccess) {
+        return status;
+      }
+    }
     kernArgManager_->ReadBackOrFlush();
   }
   return status;
 }
 
+// ================================================================================================
+static bool CanFuseMemset(hip::GraphNode* prev, hip::GraphNode* next) {
+  if (prev->GetType() != hipGraphNodeTypeMemset || next->GetType() != hipGraphNodeTypeMemset ||
+      !prev->GraphCaptureEnabled() || !next->GraphCaptureEnabled()) {
+    return false;
+  }
+  auto prevMemset = reinterpret_cast<hip::GraphMemsetNode*>(prev);
+  auto nextMemset = reinterpret_cast<hip::GraphMemsetNode*>(next);
+  if (!prevMemset->IsLinear() || !nextMemset->IsLinear()) {
+    return false;
+  }
+  hipMemsetParams prevParams, nextParams;
+  prevMemset->GetParams(&prevParams);
+  nextMemset->GetParams(&nextParams);
+  if (prevParams.value != nextParams.value ||
+      prevParams.elementSize != nextParams.elementSize ||
+      reinterpret_cast<address>(prevParams.dst) + prevParams.width * prevParams.elementSize !=
+      reinterpret_cast<address>(nextParams.dst)) {
+    return false;
+  }
+  // The fused fill must stay within a single allocation
+  size_t offset = 0;
+  amd::Memory* prevMem = getMemoryObject(prevParams.dst, offset);
+  return (prevMem != nullptr) && (prevMem == getMemoryObject(nextParams.dst, offset));
+}
+
+// ================================================================================================
+hipError_t GraphExec::FuseMemsetNodes() {
+  // Nodes run back to back in the topological order on a single stream, hence the adjacent
+  // fills of a contiguous range can be replaced with one fill, regardless of the dependencies
+  for (size_t first = 0; first < topoOrder_.size();) {
+    size_t last = first;
+    size_t sizeBytes = 0;
+    while (last + 1 < topoOrder_.size() && CanFuseMemset(topoOrder_[last], topoOrder_[last + 1])) {
+      hipMemsetParams params;
+      reinterpret_cast<hip::GraphMemsetNode*>(topoOrder_[last])->GetParams(&params);
+      sizeBytes += params.width * params.elementSize;
+      ++last;
+    }
+    if (last != first) {
+      hipMemsetParams params;
+      reinterpret_cast<hip::GraphMemsetNode*>(topoOrder_[last])->GetParams(&params);
+      sizeBytes += params.width * params.elementSize;
+
+      MemsetFusion& fusion = memsetFusions_[first];
+      fusion.count_ = last - first + 1;
+      hipError_t status =
+          reinterpret_cast<hip::GraphMemsetNode*>(topoOrder_[first])->CaptureLinearFill(
+              capture_stream_, kernArgManager_, sizeBytes, fusion.packets_, fusion.kernelName_);
+      if (status != hipSuccess) {
+        return status;
+      }
+      ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Fused %zu memset nodes, %zu bytes",
+              fusion.count_, sizeBytes);
+    }
+    first = last + 1;
+  }
+  return hipSuccess;
+}
+
+// ================================================================================================
+void GraphExec::ReleaseMemsetFusion(hip::GraphNode* node) {
+  for (auto it = memsetFusions_.begin(); it != memsetFusions_.end(); ++it) {
+    auto first = topoOrder_.begin() + it->first;
+    if (std::find(first, first + it->second.count_, node) != first + it->second.count_) {
+      for (auto packet : it->second.packets_) {
+        delete[] packet;
+      }
+      memsetFusions_.erase(it);
+      return;
+    }
+  }
+}
+
+// ================================================================================================
+const GraphExec::MemsetFusion* GraphExec::GetMemsetFusion(const std::vector<Node>& topoOrder,
+                                                          size_t index) const {
+  if (&topoOrder != &topoOrder_) {
+    return nullptr;
+  }
+  auto it = memsetFusions_.find(index);
+  if (it == memsetFusions_.end()) {
+    return nullptr;
+  }
+  // A disabled node keeps its range untouched, hence the fused fill can't be used
+  for (size_t i = index; i < index + it->second.count_; ++i) {
+    if (!topoOrder_[i]->GetEnabled()) {
+      return nullptr;
+    }
+  }
+  return &it->second;
+}
+
 // ================================================================================================
 hipError_t GraphExec::UpdateAQLPacket(hip::GraphNode* node) {
   hipError_t status = hipSuccess;
+  // The kernel args can be overwritten in place, only if no launch can read them anymore
+  bool inPlace = false;
   if (clonedGraph_->max_streams_ == 1) {
-    node->CaptureAndFormPacket(capture_stream_, kernArgManager_);
+    // The updated node falls back to its own packets
+    ReleaseMemsetFusion(node);
+    inPlace = !LaunchesInFlight();
+    node->CaptureAndFormPacket(capture_stream_, kernArgManager_, inPlace);
+  } else if (HIP_GRAPH_MULTI_STREAM_CAPTURE && node->GetParentGraph() == clonedGraph_) {
+    // Only the top level nodes of a multi-stream graph are captured
+    inPlace = !LaunchesInFlight();
+    node->CaptureAndFormPacket(capture_stream_, kernArgManager_, inPlace);
+  } else {
+    return hipSuccess;
   }
+  kernArgManager_->ReadBackOrFlush();
   return hipSuccess;
 }
 
@@ -437,6 +765,53 @@ void GraphExec::DecrementRefCount(cl_event event, cl_int command_exec_status, vo
   graphExec->release();
 }
 
+// ================================================================================================
+//! The limit of the launches in flight, before the oldest launch is waited for
+constexpr size_t kMaxPendingLaunches = 256;
+
+void GraphExec::ReclaimLaunches() {
+  // Bound the pending list, if the application never synchronizes
+  if (pendingLaunches_.size() >= kMaxPendingLaunches) {
+    pendingLaunches_.front()->awaitCompletion();
+  }
+  // The launches complete in order on a stream, but the graph can be launched on many streams
+  auto it = std::remove_if(pendingLaunches_.begin(), pendingLaunches_.end(),
+                           [this](amd::Command* command) {
+    if (command->status() != CL_COMPLETE) {
+      return false;
+    }
+    command->release();
+    // The caller holds a reference, hence the graph can't be destroyed here
+    release();
+    return true;
+  });
+  pendingLaunches_.erase(it, pendingLaunches_.end());
+}
+
+// ================================================================================================
+bool GraphExec::LaunchesInFlight() {
+  amd::ScopedLock lock(launchLock_);
+  ReclaimLaunches();
+  return !pendingLaunches_.empty();
+}
+
+// ================================================================================================
+void GraphExec::ReleaseLaunches() {
+  std::vector<amd::Command*> launches;
+  {
+    amd::ScopedLock lock(launchLock_);
+    launches.swap(pendingLaunches_);
+  }
+  for (auto command : launches) {
+    // The callback runs immediately, if the launch is already done
+    if (!command->event().setCallback(CL_COMPLETE, GraphExec::DecrementRefCount, this)) {
+      command->awaitCompletion();
+      release();
+    }
+    command->release();
+  }
+}
+
 // ================================================================================================
 
 hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::Stream* hip_stream,
@@ -448,20 +823,43 @@ hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::St
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     accumulate = new amd::AccumulateCommand(*hip_stream, {}, nullptr);
   }
+  // The captured packets of consecutive nodes are dispatched as one batch
+  std::vector<uint8_t*> packets;
+  std::vector<const std::string*> kernelNames;
+  auto dispatchBatch = [&]() {
+    if (!packets.empty()) {
+      hip_stream->vdev()->dispatchAqlPackets(packets, kernelNames, accumulate);
+      packets.clear();
+      kernelNames.clear();
+    }
+  };
   for (int i = 0; i < topoOrder.size(); i++) {
     if (topoOrder[i]->GraphCaptureEnabled()) {
+      auto fusion = (graphExec != nullptr) ? graphExec->GetMemsetFusion(topoOrder, i) : nullptr;
+      if (fusion != nullptr) {
+        for (auto& packet : fusion->packets_) {
+          packets.push_back(packet);
+          kernelNames.push_back(&fusion->kernelName_);
+        }
+        i += fusion->count_ - 1;
+        continue;
+      }
       if (topoOrder[i]->GetEnabled()) {
         std::vector<uint8_t*>& gpuPackets = topoOrder[i]->GetAqlPackets();
         for (auto& packet : gpuPackets) {
-          hip_stream->vdev()->dispatchAqlPacket(packet, topoOrder[i]->GetKernelName(), accumulate);
+          packets.push_back(packet);
+          kernelNames.push_back(&topoOrder[i]->GetKernelName());
         }
       }
     } else {
+      // The commands path must observe all previously captured packets in the queue
+      dispatchBatch();
       topoOrder[i]->SetStream(hip_stream, graphExec);
       status = topoOrder[i]->CreateCommand(topoOrder[i]->GetQueue());
       topoOrder[i]->EnqueueCommands(hip_stream);
     }
   }
+  dispatchBatch();
 
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     accumulate->enqueue();
@@ -480,12 +878,17 @@ void Graph::UpdateStreams(hip::Stream* launch_stream,
   streams_[0] = launch_stream;
   // Assign the streams in the array of all streams
   // Avoid stream that has collision with launch stream
-  for (uint32_t i = 1, j = 0; i < streams_.size(); j++) {
-    assert(j != parallel_streams.size());
+  uint32_t i = 1;
+  for (uint32_t j = 0; (i < streams_.size()) && (j < parallel_streams.size()); j++) {
     if (launch_stream->getQueueID() != parallel_streams[j]->getQueueID()) {
       streams_[i++] = parallel_streams[j];
     }
   }
+  // The pooled streams can share the HW queue with the launch stream, hence reuse the streams
+  // in order, if there are not enough streams without the collision
+  for (uint32_t j = 0; i < streams_.size(); j++) {
+    streams_[i++] = parallel_streams[j];
+  }
 }
 
 
@@ -533,6 +936,26 @@ bool Graph::RunOneNode(Node node, bool wait) {
       if (!reinterpret_cast<hip::ChildGraphNode*>(node)->graphCaptureStatus_) {
         child->RunNodes(node->stream_id_, &streams_, &waitList);
       }
+    } else if (packetReplay_ && node->GraphCaptureEnabled()) {
+      node->SetStream(streams_);
+      hip::Stream* stream = node->GetQueue();
+      // The waits for the other streams go ahead of the packets as a barrier on the node's stream
+      if (wait && !waitList.empty()) {
+        auto marker = new amd::Marker(*stream, kMarkerDisableFlush, waitList);
+        marker->enqueue();
+        marker->release();
+      }
+      // Accumulate command tracks the dispatched packets and serves as the node's command
+      // for the waits of the dependent nodes
+      auto accumulate = new amd::AccumulateCommand(*stream, {}, nullptr);
+      if (node->GetEnabled()) {
+        const std::vector<uint8_t*>& packets = node->GetAqlPackets();
+        std::vector<const std::string*> kernelNames(packets.size(), &node->GetKernelName());
+        stream->vdev()->dispatchAqlPackets(packets, kernelNames, accumulate);
+      }
+      accumulate->enqueue();
+      // The reference is released with the other node commands after the graph execution
+      node->commands_.assign(1, accumulate);
     } else {
       // Assing a stream to the current node
       node->SetStream(streams_);
@@ -560,8 +983,9 @@ bool Graph::RunOneNode(Node node, bool wait) {
     uint32_t i = 0;
     // Execute the nodes in the edges list
     for (auto edge: node->GetEdges()) {
-      // Don't wait in the nodes, executed on the same streams and if it has just one dependency
-      bool wait = ((i < DEBUG_HIP_FORCE_GRAPH_QUEUES) ||
+      // Don't wait in the nodes, executed on the same streams and if it has just one dependency.
+      // The list scheduling doesn't follow the edges order, hence it always checks the waits
+      bool wait = (DEBUG_HIP_GRAPH_LIST_SCHEDULE || (i < DEBUG_HIP_FORCE_GRAPH_QUEUES) ||
                    (edge->GetDependencies().size() > 1)) ? true : false;
       // Execute the edge node
       if (!RunOneNode(edge, wait)) {
@@ -682,17 +1106,20 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
     repeatLaunch_ = true;
   }
 
-  if (clonedGraph_->max_streams_ == 1 && instantiateDeviceId_ == launch_stream->DeviceId()) {
-    if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
-      // If the graph has kernels that does device side allocation,  during packet capture, heap is
-      // allocated because heap pointer has to be added to the AQL packet, and initialized during
-      // graph launch.
-      static bool initialized = false;
-      if (!initialized && HasHiddenHeap()) {
-        launch_stream->vdev()->HiddenHeapInit();
-        initialized = true;
-      }
+  const bool packetReplay = DEBUG_CLR_GRAPH_PACKET_CAPTURE &&
+      (clonedGraph_->max_streams_ == 1 || HIP_GRAPH_MULTI_STREAM_CAPTURE) &&
+      (instantiateDeviceId_ == launch_stream->DeviceId());
+  if (packetReplay) {
+    // If the graph has kernels that does device side allocation,  during packet capture, heap is
+    // allocated because heap pointer has to be added to the AQL packet, and initialized during
+    // graph launch.
+    static bool initialized = false;
+    if (!initialized && HasHiddenHeap()) {
+      launch_stream->vdev()->HiddenHeapInit();
+      initialized = true;
     }
+  }
+  if (clonedGraph_->max_streams_ == 1 && instantiateDeviceId_ == launch_stream->DeviceId()) {
     status = EnqueueGraphWithSingleList(topoOrder_, launch_stream, this);
   } else if (clonedGraph_->max_streams_ == 1 && instantiateDeviceId_ != launch_stream->DeviceId()) {
     for (int i = 0; i < topoOrder_.size(); i++) {
@@ -701,35 +1128,38 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
       topoOrder_[i]->EnqueueCommands(launch_stream);
     }
   } else {
+    // Lease the parallel streams, including an extra stream to avoid queue collision with
+    // the launch stream
+    if (!launch_stream->GetDevice()->LeaseGraphStreams(clonedGraph_->max_streams_,
+                                                       parallel_streams_)) {
+      return hipErrorOutOfMemory;
+    }
     // Update streams for the graph execution
     clonedGraph_->UpdateStreams(launch_stream, parallel_streams_);
+    // The captured nodes dispatch their packets directly on the assigned streams
+    clonedGraph_->packetReplay_ = packetReplay;
     // Execute all nodes in the graph
     if (!clonedGraph_->RunNodes()) {
       LogError("Failed to launch nodes!");
       return hipErrorOutOfMemory;
     }
   }
-  this->retain();
-  amd::Command* CallbackCommand = new amd::Marker(*launch_stream, kMarkerDisableFlush, {});
-  // we may not need to flush any caches.
-  CallbackCommand->setEventScope(amd::Device::kCacheStateIgnore);
-  amd::Event& event = CallbackCommand->event();
-  if (!event.setCallback(CL_COMPLETE, GraphExec::DecrementRefCount, this)) {
-    return hipErrorInvalidHandle;
-  }
-  CallbackCommand->enqueue();
-  // Add the new barrier to stall the stream, until the callback is done
-  amd::Command::EventWaitList eventWaitList;
-  eventWaitList.push_back(CallbackCommand);
-  amd::Command* block_command = new amd::Marker(*launch_stream, kMarkerDisableFlush, eventWaitList);
+  // The completion marker keeps the graph resources alive, until the GPU is done with the launch.
+  // The completed launches are reclaimed at the next launch, hence back to back launches don't
+  // wait for a host callback
+  amd::Command* completion = new amd::Marker(*launch_stream, kMarkerDisableFlush, {});
+  if (completion == nullptr) {
+    return hipErrorOutOfMemory;
+  }
   // we may not need to flush any caches.
-  block_command->setEventScope(amd::Device::kCacheStateIgnore);
-  if (block_command == nullptr) {
-    return hipErrorInvalidValue;
+  completion->setEventScope(amd::Device::kCacheStateIgnore);
+  completion->enqueue();
+  this->retain();
+  {
+    amd::ScopedLock lock(launchLock_);
+    ReclaimLaunches();
+    pendingLaunches_.push_back(completion);
   }
-  block_command->enqueue();
-  block_command->release();
-  CallbackCommand->release();
   ResetQueueIndex();
   return status;
 }
@@ -759,6 +1189,31 @@ bool GraphKernelArgManager::AllocGraphKernargPool(size_t pool_size) {
 }
 
 address GraphKernelArgManager::AllocKernArg(size_t size, size_t alignment) {
+  if (node_slots_ == nullptr) {
+    return AllocFromPool(size, alignment);
+  }
+  if (reuse_slots_ && slot_index_ < node_slots_->size()) {
+    KernArgSlot& slot = (*node_slots_)[slot_index_];
+    if (size <= slot.size_ && amd::isMultipleOf(slot.addr_, alignment)) {
+      slot_index_++;
+      dirty_end_ = std::max(dirty_end_, slot.addr_ + size);
+      return slot.addr_;
+    }
+  }
+  address result = AllocFromPool(size, alignment);
+  if (result != nullptr) {
+    if (slot_index_ < node_slots_->size()) {
+      (*node_slots_)[slot_index_] = {result, size};
+    } else {
+      node_slots_->push_back({result, size});
+    }
+    slot_index_++;
+  }
+  return result;
+}
+
+// ================================================================================================
+address GraphKernelArgManager::AllocFromPool(size_t size, size_t alignment) {
   assert(alignment != 0);
   address result = nullptr;
   result = amd::alignUp(
@@ -774,7 +1229,7 @@ address GraphKernelArgManager::AllocKernArg(size_t size, size_t alignment) {
       return nullptr;
     } else {
       // Allocte kernel arg memory from new chunck
-      return AllocKernArg(size, alignment);
+      return AllocFromPool(size, alignment);
     }
   }
   return result;
@@ -789,14 +1244,20 @@ void GraphKernelArgManager::ReadBackOrFlush() {
       auto kSentinel = *reinterpret_cast<volatile int*>(device_->info().hdpMemFlushCntl);
     } else if (kernArgImpl == KernelArgImpl::DeviceKernelArgsReadback &&
                kernarg_graph_.back().kernarg_pool_addr_ != 0) {
-      address dev_ptr =
-          kernarg_graph_.back().kernarg_pool_addr_ + kernarg_graph_.back().kernarg_pool_size_;
-      auto kSentinel = *reinterpret_cast<volatile unsigned char*>(dev_ptr - 1);
-      _mm_sfence();
-      *(dev_ptr - 1) = kSentinel;
-      _mm_mfence();
-      kSentinel = *reinterpret_cast<volatile unsigned char*>(dev_ptr - 1);
+      auto readBack = [](address dev_ptr) {
+        auto kSentinel = *reinterpret_cast<volatile unsigned char*>(dev_ptr - 1);
+        _mm_sfence();
+        *(dev_ptr - 1) = kSentinel;
+        _mm_mfence();
+        kSentinel = *reinterpret_cast<volatile unsigned char*>(dev_ptr - 1);
+      };
+      readBack(kernarg_graph_.back().kernarg_pool_addr_ + kernarg_graph_.back().kernarg_pool_size_);
+      // The slots, overwritten in place, can belong to an older pool
+      if (dirty_end_ != nullptr) {
+        readBack(dirty_end_);
+      }
     }
   }
+  dirty_end_ = nullptr;
 }
 }  // namespace hip
@@ -20,6 +20,7 @@
 
 #pragma once
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <stack>
 #include <iostream>
@@ -46,6 +47,8 @@ struct GraphNode;
 struct GraphExec;
 struct UserObject;
 typedef GraphNode* Node;
+//! The number of bytes a blit workgroup transfers, used for the graph scheduling estimates
+constexpr size_t kWorkloadBytes = 64 * Ki;
 hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::Stream* hip_stream,
                                       hip::GraphExec* graphExec = nullptr);
 struct UserObject : public amd::ReferenceCountedObject {
@@ -172,7 +175,30 @@ class GraphKernelArgManager : public amd::ReferenceCountedObject, public amd::Gr
   // Do HDP flush/When HDP flush register is invalid fallback to Readback
   void ReadBackOrFlush();
 
+  // Kernel arg slot, allocated for a captured node
+  struct KernArgSlot {
+    address addr_;  //! Address of the slot in the pool
+    size_t size_;   //! Size of the slot
+  };
+
+  // Starts the capture of a node. The allocations are recorded in the node slots. If reuse is
+  // set, the recorded slots are overwritten in order, when they fit the new allocations.
+  void BeginNodeCapture(std::vector<KernArgSlot>* slots, bool reuse) {
+    node_slots_ = slots;
+    reuse_slots_ = reuse;
+    slot_index_ = 0;
+  }
+
+  // Finishes the capture of a node and drops the unused slots
+  void EndNodeCapture() {
+    node_slots_->resize(slot_index_);
+    node_slots_ = nullptr;
+  }
+
  private:
+  // Allocates kernel args from the pool, grows the pool if it's full
+  address AllocFromPool(size_t size, size_t alignment);
+
   struct KernelArgPoolGraph {
     KernelArgPoolGraph(address base_addr, size_t size)
         : kernarg_pool_addr_(base_addr), kernarg_pool_size_(size), kernarg_pool_offset_(0) {}
@@ -183,6 +209,10 @@ class GraphKernelArgManager : public amd::ReferenceCountedObject, public amd::Gr
   bool device_kernarg_pool_ = false;  //! Indicate if kernel pool in device mem
   amd::Device* device_ = nullptr;     //! Device from where kernel arguments are allocated
   std::vector<KernelArgPoolGraph> kernarg_graph_;  //! Vector of allocated kernarg pool
+  std::vector<KernArgSlot>* node_slots_ = nullptr;  //! Slots of the node under capture
+  bool reuse_slots_ = false;       //! Overwrite the recorded slots of the node
+  size_t slot_index_ = 0;          //! The next slot of the node under capture
+  address dirty_end_ = nullptr;    //! End of the last slot, overwritten in place
   using KernelArgImpl = device::Settings::KernelArgImpl;
 };
 
@@ -214,6 +244,8 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   size_t alignedKernArgSize_ = 256;       //!< Aligned size required for kernel args
   size_t kernargSegmentByteSize_ = 512;   //!< Kernel arg segment byte size
   size_t kernargSegmentAlignment_ = 256;  //!< Kernel arg segment alignment
+  //!< Kernel arg slots of the captured packets, reused on the parameter updates
+  std::vector<GraphKernelArgManager::KernArgSlot> kernArgSlots_;
 
  public:
   GraphNode(hipGraphNodeType type, std::string style = "", std::string shape = "",
@@ -271,9 +303,15 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   size_t GetKerArgSize() const { return alignedKernArgSize_; }
   size_t GetKernargSegmentByteSize() const { return kernargSegmentByteSize_; }
   size_t GetKernargSegmentAlignment() const { return kernargSegmentAlignment_; }
-  void CaptureAndFormPacket(hip::Stream* capture_stream, GraphKernelArgManager* kernArgMgr) {
+  //! Captures the node packets. The update reuses the node kernel args in place, if they fit
+  void CaptureAndFormPacket(hip::Stream* capture_stream, GraphKernelArgManager* kernArgMgr,
+                            bool update = false) {
     hipError_t status = CreateCommand(capture_stream);
+    for (auto packet : gpuPackets_) {
+      delete[] packet;
+    }
     gpuPackets_.clear();
+    kernArgMgr->BeginNodeCapture(&kernArgSlots_, update);
     for (auto& command : commands_) {
       command->setPktCapturingState(true, &gpuPackets_, kernArgMgr, &capturedKernelName_);
       // Enqueue command to capture GPU Packet. The packet is not submitted to the device.
@@ -281,6 +319,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
       command->submit(*(command->queue())->vdev());
       command->release();
     }
+    kernArgMgr->EndNodeCapture();
     // Commands are captured and released. Clear them from the object.
     commands_.clear();
   }
@@ -310,6 +349,8 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   virtual std::vector<amd::Command*>& GetCommands() { return commands_; }
   /// Returns graph node type
   hipGraphNodeType GetType() const { return type_; }
+  /// Returns the estimated amount of work in the node, used for the graph scheduling
+  virtual uint64_t GetWorkload() const { return 1; }
   /// Clone graph node
   virtual GraphNode* clone() const = 0;
   /// Returns graph node indegree
@@ -322,30 +363,37 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   void SetOutDegree(size_t outDegree) { outDegree_ = outDegree; }
   /// Returns graph node dependencies
   const std::vector<Node>& GetDependencies() const { return dependencies_; }
+  /// Invalidates the cached schedule of the parent graph on a change of the edges
+  void StructureChanged();
   /// Update graph node dependecies
   void SetDependencies(std::vector<Node>& dependencies) {
     for (auto entry : dependencies) {
       dependencies_.push_back(entry);
     }
+    StructureChanged();
   }
   /// Add graph node dependency
   void AddDependency(const Node& node) {
     dependencies_.push_back(node);
     inDegree_++;
+    StructureChanged();
   }
   /// Remove graph node dependency
   void RemoveDependency(const Node& node) {
     dependencies_.erase(std::remove(dependencies_.begin(), dependencies_.end(), node),
                         dependencies_.end());
     inDegree_--;
+    StructureChanged();
   }
   void RemoveEdge(const Node& childNode) {
     edges_.erase(std::remove(edges_.begin(), edges_.end(), childNode), edges_.end());
     outDegree_--;
+    StructureChanged();
   }
   void AddEdge(const Node& childNode) {
     edges_.push_back(childNode);
     outDegree_++;
+    StructureChanged();
   }
   /// Add edge, update parent node outdegree, child node indegree and dependency
   void AddEdgeDep(const Node& childNode) {
@@ -363,6 +411,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     }
     edges_.erase(it, edges_.end());
     outDegree_--;
+    StructureChanged();
     childNode->RemoveDependency(this);
     return true;
   }
@@ -373,6 +422,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     for (auto entry : edges) {
       edges_.push_back(entry);
     }
+    StructureChanged();
   }
   /// Get topological sort of the nodes embedded as part of the graphnode(e.g. ChildGraph)
   virtual bool TopologicalOrder(std::vector<Node>& TopoOrder) { return true; }
@@ -487,11 +537,24 @@ struct Graph {
   std::vector<Node> wait_order_;
   std::vector<hip::Stream*> streams_; //!< The list of streams, used in the execution
   int32_t current_id_ = 0;    //!< The current node ID in the graph execution sequence
+  bool packetReplay_ = false; //!< Captured nodes dispatch the AQL packets in the execution
   hip::Device* device_;       //!< HIP device object
   hip::MemoryPool* mem_pool_; //!< Memory pool, associated with this graph
   std::unordered_set<GraphNode*> capturedNodes_;
   bool graphInstantiated_;
   std::unordered_set<void*> memAllocNodePtrs_;
+  uint64_t structureVersion_ = 0; //!< Incremented on every change of the nodes or the edges
+
+  //! Topological order and streams schedule of the last instantiation
+  struct ScheduleCache {
+    uint64_t version_;                //!< Structure version of the cached schedule
+    std::vector<uint32_t> order_;     //!< Topological order as the vertex indices
+    std::vector<int32_t> stream_ids_; //!< Stream ID of every vertex
+    std::vector<bool> signals_;       //!< Signal requirement of every vertex
+    std::vector<int32_t> roots_;      //!< Vertex index of every root, -1 for an empty slot
+    int max_streams_;                 //!< Maximum number of streams, used by the vertices
+  };
+  std::unique_ptr<ScheduleCache> scheduleCache_;
  public:
   Graph(hip::Device* device, const Graph* original = nullptr)
       : pOriginalGraph_(original)
@@ -616,6 +679,14 @@ struct Graph {
   //! Schedules all nodes in the graph into different streams
   void ScheduleNodes();
 
+  //! Schedules the nodes with the list scheduling in the critical path order.
+  //! Every node goes to the stream with the earliest estimated start, including the cost of
+  //! the cross-stream waits for its dependencies
+  void ListScheduleNodes();
+
+  //! Schedules the child graph of the node
+  void ScheduleChildGraph(Node node);
+
   //! Update streams for the graph execution
   void UpdateStreams(
     hip::Stream* launch_stream, //!< Launch stream from the application
@@ -637,6 +708,16 @@ struct Graph {
 
   bool TopologicalOrder(std::vector<Node>& TopoOrder);
 
+  //! Invalidates the cached schedule
+  void StructureChanged() { structureVersion_++; }
+
+  //! Orders and schedules the clone of this graph. The order and the schedule of the previous
+  //! instantiation are reused, if the graph structure didn't change
+  bool OrderAndSchedule(
+    Graph* clonedGraph,         //!< The clone of this graph for the instantiation
+    std::vector<Node>& topoOrder  //!< Topological order of the cloned nodes
+  );
+
   Graph* clone(std::unordered_map<Node, Node>& clonedNodes) const;
   Graph* clone() const;
   void GenerateDOT(std::ostream& fout, hipGraphDebugDotFlags flag) {
@@ -741,6 +822,32 @@ struct GraphExec : public amd::ReferenceCountedObject {
   int instantiateDeviceId_ = -1;
   bool hasHiddenHeap_ = false;  //!< Hidden heap indicator for Kernel node
   bool repeatLaunch_ = false;
+  size_t memPlanSize_ = 0;  //!< Planned peak of the graph allocations, held in the graph pool
+  std::unique_ptr<GraphLaunchStats> launchStats_;  //!< Launch time, if HIP_LAUNCH_LATENCY is set
+
+ public:
+  //! Adjacent memset nodes, which fill one contiguous range and run as a single fill
+  struct MemsetFusion {
+    size_t count_;                   //!< The number of fused nodes
+    std::vector<uint8_t*> packets_;  //!< GPU packets of the fused fill
+    std::string kernelName_;         //!< Blit kernel name of the fused fill
+  };
+
+ private:
+  //! Memset fusions, indexed by the position of the first fused node in topoOrder_
+  std::map<size_t, MemsetFusion> memsetFusions_;
+
+  //! Fuses adjacent memset nodes of the topological order into single fills
+  hipError_t FuseMemsetNodes();
+  //! Releases the fusion, which contains the node
+  void ReleaseMemsetFusion(hip::GraphNode* node);
+
+  amd::Monitor launchLock_;                     //!< Guards the pending launches
+  std::vector<amd::Command*> pendingLaunches_;  //!< Completion markers of the unreclaimed launches
+  //! Releases the references of the completed launches
+  void ReclaimLaunches();
+  //! Returns true if the GPU may still use the graph resources of a previous launch
+  bool LaunchesInFlight();
 
  public:
   GraphExec(std::vector<Node>& topoOrder, struct Graph*& clonedGraph,
@@ -757,14 +864,21 @@ struct GraphExec : public amd::ReferenceCountedObject {
   }
 
   ~GraphExec() {
-    for (auto stream : parallel_streams_) {
-      if (stream != nullptr) {
-        stream->finish();
-        hip::Stream::Destroy(stream);
-      }
-    }
+    // The parallel streams belong to the device pool. The last launch is done at this point,
+    // since every launch holds a reference
     amd::ScopedLock lock(graphExecSetLock_);
     graphExecSet_.erase(this);
+    for (auto& fusion : memsetFusions_) {
+      for (auto packet : fusion.second.packets_) {
+        delete[] packet;
+      }
+    }
+    if ((launchStats_ != nullptr) && (HIP_LAUNCH_LATENCY & 0x2)) {
+      launchStats_->Print(this, topoOrder_.size());
+    }
+    if (memPlanSize_ != 0) {
+      clonedGraph_->mem_pool_->AddHoldSize(-static_cast<int64_t>(memPlanSize_));
+    }
     delete clonedGraph_;
     if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
       kernArgManager_->release();
@@ -800,11 +914,24 @@ struct GraphExec : public amd::ReferenceCountedObject {
   void ResetQueueIndex() { currentQueueIndex_ = 0; }
   uint64_t GetFlags() const { return flags_; }
   hipError_t Init();
-  hipError_t CreateStreams(uint32_t num_streams);
+  //! Returns the path of the launch on the provided stream
+  GraphLaunchStats::Path GetLaunchPath(hip::Stream* stream) const {
+    if (clonedGraph_->max_streams_ != 1) {
+      return GraphLaunchStats::kMultiStream;
+    }
+    return (instantiateDeviceId_ == stream->DeviceId()) ? GraphLaunchStats::kSingleList :
+                                                          GraphLaunchStats::kCommands;
+  }
+  //! Returns the launch time histograms or nullptr if the collection is disabled
+  GraphLaunchStats* GetLaunchStats() const { return launchStats_.get(); }
+  //! Plans the peak memory of the alloc/free nodes and holds it in the graph pool
+  void PlanGraphMemory();
   hipError_t Run(hipStream_t stream);
   // Capture GPU Packets from graph commands
   hipError_t CaptureAQLPackets();
   hipError_t UpdateAQLPacket(hip::GraphNode* node);
+  //! Returns the memset fusion, which starts at the node position, if all fused nodes are enabled
+  const MemsetFusion* GetMemsetFusion(const std::vector<Node>& topoOrder, size_t index) const;
   // Kenrel arg manger is for the entire graph.
   // Child graph also shares the same kernel arg manager object. some apps have 100's of
   // child graph nodes and each child graph has only one node.
@@ -815,6 +942,8 @@ struct GraphExec : public amd::ReferenceCountedObject {
     return kernArgManager_;
   }
   static void DecrementRefCount(cl_event event, cl_int command_exec_status, void* user_data);
+  //! Hands the references of the pending launches over to the completion callbacks
+  void ReleaseLaunches();
 };
 
 struct ChildGraphNode : public GraphNode {
@@ -905,6 +1034,15 @@ struct ChildGraphNode : public GraphNode {
 };
 
 class GraphKernelNode : public GraphNode {
+  //! Alignment of the copied kernel parameter values
+  static constexpr size_t kParamAlignment = alignof(std::max_align_t);
+  //! The limit of the released nodes, kept for the reuse
+  static constexpr size_t kMaxPooledNodes = 16 * Ki;
+  static amd::Monitor node_pool_lock_;   //!< Guards the pool of the released nodes
+  //!< Memory of the released nodes. It's never destroyed, since the graphs can be released
+  //!< after the static objects on the application exit
+  static std::vector<void*>* node_pool_;
+
   hipKernelNodeParams kernelParams_;   //!< Kernel node parameters
   unsigned int numParams_;             //!< No. of kernel params as part of signature
   hipKernelNodeAttrValue kernelAttr_;  //!< Kernel node attributes
@@ -1054,18 +1192,24 @@ class GraphKernelNode : public GraphNode {
 
     // Allocate/assign memory if params are passed part of 'kernelParams'
     if (pNodeParams->kernelParams != nullptr) {
-      kernelParams_.kernelParams = (void**)malloc(numParams_ * sizeof(void*));
+      // A single block holds the array of the parameter pointers, followed by the values
+      size_t size = numParams_ * sizeof(void*);
+      for (uint32_t i = 0; i < numParams_; ++i) {
+        size = amd::alignUp(size, kParamAlignment) + signature.at(i).size_;
+      }
+      kernelParams_.kernelParams = (void**)malloc(std::max(size, sizeof(void*)));
       if (kernelParams_.kernelParams == nullptr) {
         return hipErrorOutOfMemory;
       }
 
+      address values = reinterpret_cast<address>(kernelParams_.kernelParams);
+      size_t offset = numParams_ * sizeof(void*);
       for (uint32_t i = 0; i < numParams_; ++i) {
         const amd::KernelParameterDescriptor& desc = signature.at(i);
-        kernelParams_.kernelParams[i] = malloc(desc.size_);
-        if (kernelParams_.kernelParams[i] == nullptr) {
-          return hipErrorOutOfMemory;
-        }
+        offset = amd::alignUp(offset, kParamAlignment);
+        kernelParams_.kernelParams[i] = values + offset;
         ::memcpy(kernelParams_.kernelParams[i], (pNodeParams->kernelParams[i]), desc.size_);
+        offset += desc.size_;
       }
       for (uint32_t i = signature.numParameters(); i < signature.numParametersAll(); ++i) {
         if (signature.at(i).info_.oclObject_ == amd::KernelParameterDescriptor::HiddenHeap) {
@@ -1122,15 +1266,34 @@ class GraphKernelNode : public GraphNode {
 
   ~GraphKernelNode() { freeParams(); }
 
+  //! Kernel nodes reuse the memory of the released nodes, since every stream capture of
+  //! a training step creates and destroys thousands of them
+  void* operator new(size_t size) {
+    if (size == sizeof(GraphKernelNode)) {
+      amd::ScopedLock lock(node_pool_lock_);
+      if (!node_pool_->empty()) {
+        void* ptr = node_pool_->back();
+        node_pool_->pop_back();
+        return ptr;
+      }
+    }
+    return ::operator new(size);
+  }
+  void operator delete(void* ptr, size_t size) {
+    if (size == sizeof(GraphKernelNode)) {
+      amd::ScopedLock lock(node_pool_lock_);
+      if (node_pool_->size() < kMaxPooledNodes) {
+        node_pool_->push_back(ptr);
+        return;
+      }
+    }
+    ::operator delete(ptr);
+  }
+
   void freeParams() {
-    // Deallocate memory allocated for kernargs passed via 'kernelParams'
+    // Deallocate memory allocated for kernargs passed via 'kernelParams'. The values share
+    // the allocation with the array of pointers
     if (kernelParams_.kernelParams != nullptr) {
-      for (size_t i = 0; i < numParams_; ++i) {
-        if (kernelParams_.kernelParams[i] != nullptr) {
-          free(kernelParams_.kernelParams[i]);
-        }
-        kernelParams_.kernelParams[i] = nullptr;
-      }
       free(kernelParams_.kernelParams);
       kernelParams_.kernelParams = nullptr;
     }
@@ -1164,6 +1327,12 @@ class GraphKernelNode : public GraphNode {
     return new GraphKernelNode(static_cast<GraphKernelNode const&>(*this));
   }
 
+  /// The number of workgroups in the launch
+  uint64_t GetWorkload() const override {
+    return static_cast<uint64_t>(kernelParams_.gridDim.x) * kernelParams_.gridDim.y *
+           kernelParams_.gridDim.z;
+  }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     int devID = hip::getDeviceID(stream->context());
     hipFunction_t func = getFunc(kernelParams_, devID);
@@ -1200,7 +1369,7 @@ class GraphKernelNode : public GraphNode {
         kernelParams_.gridDim.z * kernelParams_.blockDim.z, kernelParams_.blockDim.x,
         kernelParams_.blockDim.y, kernelParams_.blockDim.z, kernelParams_.sharedMemBytes, stream,
         kernelParams_.kernelParams, kernelParams_.extra, kernelEvents_.startEvent_,
-        kernelEvents_.stopEvent_, flags, coopKernel_, 0, 0, 0, 0, 0);
+        kernelEvents_.stopEvent_, flags, coopKernel_, 0, 0, 0, 0, 0, false);
     if (signal_is_required_) {
       // Optimize the barriers by adding a signal into the dispatch packet directly
       command->SetProfiling();
@@ -1538,6 +1707,9 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
     return new GraphMemcpyNode1D(static_cast<GraphMemcpyNode1D const&>(*this));
   }
 
+  /// Copy size in the blit workgroup units
+  uint64_t GetWorkload() const override { return 1 + count_ / kWorkloadBytes; }
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     if ((kind_ == hipMemcpyHostToHost || kind_ == hipMemcpyDefault) && IsHtoHMemcpy(dst_, src_)) {
       return hipSuccess;
@@ -1940,6 +2112,12 @@ class GraphMemsetNode : public GraphNode {
     return new GraphMemsetNode(static_cast<GraphMemsetNode const&>(*this));
   }
 
+  /// Fill size in the blit workgroup units
+  uint64_t GetWorkload() const override {
+    return 1 + memsetParams_.width * memsetParams_.height * depth_ * memsetParams_.elementSize /
+               kWorkloadBytes;
+  }
+
   virtual std::string GetLabel(hipGraphDebugDotFlags flag) override {
     std::string label;
     if (flag == hipGraphDebugDotFlagsMemsetNodeParams || flag == hipGraphDebugDotFlagsVerbose) {
@@ -1997,6 +2175,27 @@ class GraphMemsetNode : public GraphNode {
     std::memcpy(params, &memsetParams_, sizeof(hipMemsetParams));
   }
 
+  /// Returns true if the node fills a linear range
+  bool IsLinear() const { return memsetParams_.height == 1 && depth_ == 1; }
+
+  /// Captures GPU packets of a linear fill, which starts at the node destination and may cover
+  /// the ranges of the following nodes
+  hipError_t CaptureLinearFill(hip::Stream* capture_stream, GraphKernelArgManager* kernArgMgr,
+                               size_t sizeBytes, std::vector<uint8_t*>& packets,
+                               std::string& kernelName) {
+    std::vector<amd::Command*> commands;
+    hipError_t status = ihipMemsetCommand(commands, memsetParams_.dst, memsetParams_.value,
+                                          memsetParams_.elementSize, sizeBytes, capture_stream);
+    for (auto& command : commands) {
+      if (status == hipSuccess) {
+        command->setPktCapturingState(true, &packets, kernArgMgr, &kernelName);
+        command->submit(*(command->queue())->vdev());
+      }
+      command->release();
+    }
+    return status;
+  }
+
   void GetParams(HIP_MEMSET_NODE_PARAMS* params) {
     params->dst = memsetParams_.dst;
     params->elementSize = memsetParams_.elementSize;
@@ -2651,21 +2850,25 @@ class hipGraphExternalSemSignalNode : public GraphNode {
     if (status != hipSuccess) {
       return status;
     }
+    // All semaphores of the node go into one command
     unsigned int numExtSems = externalSemaphorNodeParam_.numExtSems;
-    commands_.reserve(numExtSems);
+    amd::ExternalSemaphoreCmd::SemaphoreList semaphores;
+    semaphores.reserve(numExtSems);
     for (unsigned int i = 0; i < numExtSems; i++) {
-      if (externalSemaphorNodeParam_.extSemArray[i] != nullptr) {
-        amd::ExternalSemaphoreCmd* command = new amd::ExternalSemaphoreCmd(*stream,
-                                      externalSemaphorNodeParam_.extSemArray[i],
-                                      externalSemaphorNodeParam_.paramsArray[i].params.fence.value,
-                                      amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE);
-        if (command == nullptr) {
-          return hipErrorOutOfMemory;
-        }
-        commands_.emplace_back(command);
-      } else {
+      if (externalSemaphorNodeParam_.extSemArray[i] == nullptr) {
         return hipErrorInvalidValue;
       }
+      semaphores.push_back({externalSemaphorNodeParam_.extSemArray[i],
+                            externalSemaphorNodeParam_.paramsArray[i].params.fence.value});
+    }
+    if (!semaphores.empty()) {
+      amd::ExternalSemaphoreCmd* command = new amd::ExternalSemaphoreCmd(*stream,
+                                    std::move(semaphores),
+                                    amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE);
+      if (command == nullptr) {
+        return hipErrorOutOfMemory;
+      }
+      commands_.emplace_back(command);
     }
     return hipSuccess;
   }
@@ -2707,21 +2910,25 @@ class hipGraphExternalSemWaitNode : public GraphNode {
       return status;
 
     }
+    // All semaphores of the node go into one command
     unsigned int numExtSems = externalSemaphorNodeParam_.numExtSems;
-    commands_.reserve(numExtSems);
+    amd::ExternalSemaphoreCmd::SemaphoreList semaphores;
+    semaphores.reserve(numExtSems);
     for (unsigned int i = 0; i < numExtSems; i++) {
-      if (externalSemaphorNodeParam_.extSemArray[i] != nullptr) {
-        amd::ExternalSemaphoreCmd* command = new amd::ExternalSemaphoreCmd(*stream,
-                                    externalSemaphorNodeParam_.extSemArray[i],
-                                    externalSemaphorNodeParam_.paramsArray[i].params.fence.value,
-                                    amd::ExternalSemaphoreCmd::COMMAND_WAIT_EXTSEMAPHORE);
-        if (command == nullptr) {
-          return hipErrorOutOfMemory;
-        }
-        commands_.emplace_back(command);
-      } else {
+      if (externalSemaphorNodeParam_.extSemArray[i] == nullptr) {
         return hipErrorInvalidValue;
       }
+      semaphores.push_back({externalSemaphorNodeParam_.extSemArray[i],
+                            externalSemaphorNodeParam_.paramsArray[i].params.fence.value});
+    }
+    if (!semaphores.empty()) {
+      amd::ExternalSemaphoreCmd* command = new amd::ExternalSemaphoreCmd(*stream,
+                                    std::move(semaphores),
+                                    amd::ExternalSemaphoreCmd::COMMAND_WAIT_EXTSEMAPHORE);
+      if (command == nullptr) {
+        return hipErrorOutOfMemory;
+      }
+      commands_.emplace_back(command);
     }
     return hipSuccess;
   }
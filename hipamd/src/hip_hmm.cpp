@@ -25,6 +25,9 @@
 #include "platform/command.hpp"
 #include "platform/memory.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 namespace hip {
 
 // Forward declaraiton of a function
@@ -74,35 +77,38 @@ hipError_t hipMallocManaged(void** dev_ptr, size_t size, unsigned int flags) {
 }
 
 // ================================================================================================
-hipError_t hipMemPrefetchAsync(const void* dev_ptr, size_t count, int device,
-                               hipStream_t stream) {
-  HIP_INIT_API(hipMemPrefetchAsync, dev_ptr, count, device, stream);
-
-  if ((dev_ptr == nullptr) || (count == 0)) {
-    HIP_RETURN(hipErrorInvalidValue);
+static hipError_t ihipMemPrefetchAsync(const amd::SvmPrefetchAsyncCommand::RangeList& ranges,
+                                       int device, hipStream_t stream) {
+  for (const auto& range : ranges) {
+    if ((range.first == nullptr) || (range.second == 0)) {
+      return hipErrorInvalidValue;
+    }
   }
 
   if (!hip::isValid(stream)) {
-    HIP_RETURN(hipErrorContextIsDestroyed);
+    return hipErrorContextIsDestroyed;
   }
 
-  size_t offset = 0;
-  amd::Memory* memObj = getMemoryObject(dev_ptr, offset);
-
-  if ((memObj != nullptr) && (count  > (memObj->getSize() - offset))) {
-    HIP_RETURN(hipErrorInvalidValue);
+  bool unknown_memory = false;
+  for (const auto& range : ranges) {
+    size_t offset = 0;
+    amd::Memory* memObj = getMemoryObject(range.first, offset);
+    if ((memObj != nullptr) && (range.second > (memObj->getSize() - offset))) {
+      return hipErrorInvalidValue;
+    }
+    unknown_memory |= (memObj == nullptr);
   }
   if (device != hipCpuDeviceId && (static_cast<size_t>(device) >= g_devices.size())) {
-    HIP_RETURN(hipErrorInvalidDevice);
+    return hipErrorInvalidDevice;
   }
 
   hip::Stream* hip_stream = nullptr;
   amd::Device* dev = nullptr;
   bool cpu_access = false;
 
-  if ((memObj == nullptr) && (device != hipCpuDeviceId) &&
+  if (unknown_memory && (device != hipCpuDeviceId) &&
       (!g_devices[device]->devices()[0]->info().hmmCpuMemoryAccessible_)) {
-    HIP_RETURN(hipErrorNotSupported);
+    return hipErrorNotSupported;
   }
 
   // Pick the specified stream or Null one from the provided device
@@ -117,12 +123,14 @@ hipError_t hipMemPrefetchAsync(const void* dev_ptr, size_t count, int device,
   }
 
   if (hip_stream == nullptr) {
-    HIP_RETURN(hipErrorInvalidValue);
+    return hipErrorInvalidValue;
   }
 
   amd::Command::EventWaitList waitList;
-  amd::SvmPrefetchAsyncCommand* command =
-      new amd::SvmPrefetchAsyncCommand(*hip_stream, waitList, dev_ptr, count, dev, cpu_access);
+  amd::SvmPrefetchAsyncCommand* command = (ranges.size() == 1)
+      ? new amd::SvmPrefetchAsyncCommand(*hip_stream, waitList, ranges[0].first,
+                                         ranges[0].second, dev, cpu_access)
+      : new amd::SvmPrefetchAsyncCommand(*hip_stream, waitList, ranges, dev, cpu_access);
   if (command == nullptr) {
     return hipErrorOutOfMemory;
   }
@@ -130,7 +138,33 @@ hipError_t hipMemPrefetchAsync(const void* dev_ptr, size_t count, int device,
   command->enqueue();
   command->release();
 
-  HIP_RETURN(hipSuccess);
+  return hipSuccess;
+}
+
+// ================================================================================================
+hipError_t hipMemPrefetchAsync(const void* dev_ptr, size_t count, int device,
+                               hipStream_t stream) {
+  HIP_INIT_API(hipMemPrefetchAsync, dev_ptr, count, device, stream);
+
+  HIP_RETURN(ihipMemPrefetchAsync({{dev_ptr, count}}, device, stream));
+}
+
+// ================================================================================================
+hipError_t hipExtMemPrefetchBatchAsync(const void* const* dev_ptrs, const size_t* counts,
+                                       size_t numRanges, int device, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemPrefetchBatchAsync, dev_ptrs, counts, numRanges, device, stream);
+
+  if ((dev_ptrs == nullptr) || (counts == nullptr) || (numRanges == 0)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  amd::SvmPrefetchAsyncCommand::RangeList ranges;
+  ranges.reserve(numRanges);
+  for (size_t i = 0; i < numRanges; ++i) {
+    ranges.push_back({dev_ptrs[i], counts[i]});
+  }
+  // The command merges the adjacent and the overlapping ranges into single prefetch ops
+  HIP_RETURN(ihipMemPrefetchAsync(ranges, device, stream));
 }
 
 // ================================================================================================
@@ -163,6 +197,9 @@ hipError_t hipMemAdvise(const void* dev_ptr, size_t count, hipMemoryAdvise advic
   if (!dev->SetSvmAttributes(dev_ptr, count, static_cast<amd::MemoryAdvice>(advice), use_cpu)) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (HIP_HMM_AUTO_POLICY && (memObj != nullptr)) {
+    hip::ManagedPolicy::Advised(memObj);
+  }
 
   HIP_RETURN(hipSuccess);
 }
@@ -304,8 +341,150 @@ hipError_t ihipMallocManaged(void** ptr, size_t size, unsigned int align) {
   }
   //saves the current device id so that it can be accessed later
   memObj->getUserData().deviceId = hip::getCurrentDevice()->deviceId();
+  if (HIP_HMM_AUTO_POLICY) {
+    ManagedPolicy::AddRange(memObj);
+  }
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kAlloc, amd::AllocTrace::kManaged, *ptr, size);
+  }
 
   ClPrint(amd::LOG_INFO, amd::LOG_API, "ihipMallocManaged ptr=0x%zx", *ptr);
   return hipSuccess;
 }
+
+// ================================================================================================
+namespace {
+//! Access statistics of a managed allocation
+struct ManagedRange {
+  uint32_t launches_ = 0;           //!< Launches in the current window
+  std::vector<uint32_t> accesses_;  //!< Launches in the current window per device
+  int location_ = amd::InvalidDeviceId;  //!< Preferred location, set by the policy
+  bool shared_ = false;             //!< The accessed-by mappings were set by the policy
+  bool advised_ = false;            //!< The application placed the range, the policy is off
+};
+
+amd::Monitor managedLock("Managed policy lock", true);
+std::unordered_map<amd::Memory*, ManagedRange> managedRanges;
+}  // namespace
+
+// ================================================================================================
+void ManagedPolicy::AddRange(amd::Memory* memory) {
+  amd::ScopedLock lock(managedLock);
+  managedRanges[memory].accesses_.resize(g_devices.size(), 0);
+}
+
+// ================================================================================================
+void ManagedPolicy::RemoveRange(amd::Memory* memory) {
+  amd::ScopedLock lock(managedLock);
+  managedRanges.erase(memory);
+}
+
+// ================================================================================================
+void ManagedPolicy::Advised(amd::Memory* memory) {
+  amd::ScopedLock lock(managedLock);
+  auto it = managedRanges.find(memory);
+  if (it != managedRanges.end()) {
+    it->second.advised_ = true;
+  }
+}
+
+// ================================================================================================
+void ManagedPolicy::RecordLaunch(const amd::NDRangeKernelCommand& command, hip::Stream* stream) {
+  const amd::Kernel& kernel = command.kernel();
+  uint32_t num_memories = kernel.signature().numMemories();
+  if (num_memories == 0) {
+    return;
+  }
+  amd::Memory* const* memories = reinterpret_cast<amd::Memory* const*>(
+      command.parameters() + kernel.parameters().memoryObjOffset());
+  const int device = stream->DeviceId();
+  const uint32_t window = std::max(HIP_HMM_POLICY_WINDOW, 1u);
+
+  // Ranges, which the policy moves to the launch device before the kernel
+  amd::SvmPrefetchAsyncCommand::RangeList prefetches;
+  {
+    amd::ScopedLock lock(managedLock);
+    if (managedRanges.empty()) {
+      return;
+    }
+    for (uint32_t i = 0; i < num_memories; ++i) {
+      amd::Memory* memory = memories[i];
+      if (memory == nullptr) {
+        continue;
+      }
+      auto it = managedRanges.find(memory);
+      if ((it == managedRanges.end()) || it->second.advised_) {
+        continue;
+      }
+      ManagedRange& range = it->second;
+      ++range.accesses_[device];
+      if (++range.launches_ < window) {
+        continue;
+      }
+
+      const void* ptr = memory->getSvmPtr();
+      size_t size = memory->getSize();
+      amd::Device* dev = g_devices[device]->devices()[0];
+      if (!dev->info().hmmSupported_) {
+        range.advised_ = true;
+        continue;
+      }
+      // Leave the range alone, if the preferred location in HMM differs from the policy choice
+      int preferred = amd::InvalidDeviceId;
+      void* data = &preferred;
+      size_t data_size = sizeof(preferred);
+      int attribute = amd::MemRangeAttribute::PreferredLocation;
+      if (!dev->GetSvmAttributes(&data, &data_size, &attribute, 1, ptr, size) ||
+          (preferred != range.location_)) {
+        range.advised_ = true;
+        continue;
+      }
+
+      uint32_t num_devices = 0;
+      for (auto accesses : range.accesses_) {
+        num_devices += (accesses != 0) ? 1 : 0;
+      }
+      if ((num_devices == 1) && (range.location_ != device)) {
+        // One device uses the range, hence migrate it there once and keep it there
+        if (dev->SetSvmAttributes(ptr, size, amd::MemoryAdvice::SetPreferredLocation)) {
+          range.location_ = device;
+          prefetches.push_back({ptr, size});
+          ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Managed policy: %p preferred on device %d",
+                  ptr, device);
+        }
+      } else if ((num_devices > 1) && !range.shared_) {
+        // Several devices share the range, hence map it to all of them instead of the
+        // migrations back and forth on every fault
+        if (range.location_ != amd::InvalidDeviceId) {
+          g_devices[range.location_]->devices()[0]->SetSvmAttributes(
+              ptr, size, amd::MemoryAdvice::UnsetPreferredLocation);
+          range.location_ = amd::InvalidDeviceId;
+        }
+        for (size_t j = 0; j < range.accesses_.size(); ++j) {
+          if (range.accesses_[j] != 0) {
+            g_devices[j]->devices()[0]->SetSvmAttributes(
+                ptr, size, amd::MemoryAdvice::SetAccessedBy);
+          }
+        }
+        range.shared_ = true;
+        ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Managed policy: %p shared by %u devices",
+                ptr, num_devices);
+      }
+      // Start a new window
+      range.launches_ = 0;
+      std::fill(range.accesses_.begin(), range.accesses_.end(), 0);
+    }
+  }
+
+  if (!prefetches.empty()) {
+    // The migration is ordered before the kernel on the same stream
+    amd::Command::EventWaitList waitList;
+    amd::SvmPrefetchAsyncCommand* prefetch = new amd::SvmPrefetchAsyncCommand(
+        *stream, waitList, prefetches, g_devices[device]->devices()[0], false);
+    if (prefetch != nullptr) {
+      prefetch->enqueue();
+      prefetch->release();
+    }
+  }
+}
 } //namespace hip
@@ -27,10 +27,12 @@
 #include "utils/debug.hpp"
 #include "hip_formatting.hpp"
 #include "hip_graph_capture.hpp"
+#include "hip_launch_stats.hpp"
 
 #include <unordered_set>
 #include <thread>
 #include <stack>
+#include <memory>
 #include <mutex>
 #include <iterator>
 #ifdef _WIN32
@@ -51,6 +53,11 @@
 /*! IHIP IPC MEMORY Structure */
 #define IHIP_IPC_MEM_HANDLE_SIZE   32
 #define IHIP_IPC_MEM_RESERVED_SIZE LP64_SWITCH(20,12)
+
+/*! hipHostMalloc flag, backs the allocation with huge pages if the system provides them */
+#ifndef hipExtHostAllocHugePages
+#define hipExtHostAllocHugePages 0x08000000
+#endif
 namespace hip{
   extern std::once_flag g_ihipInitialized;
 }
@@ -143,24 +150,30 @@ const char* ihipGetErrorName(hipError_t hip_error);
   ClPrint(amd::LOG_INFO, amd::LOG_API, "%s: Returned %s : %s",                     \
           __func__, hip::ihipGetErrorName(err), ToString( __VA_ARGS__ ).c_str());
 
+// The first API call on a thread creates the runtime thread object, initializes the runtime and
+// selects the device. The later calls check only the TLS flag, the logging and the tracing work
+// stays behind their own enable checks
 #define HIP_INIT_API_INTERNAL(noReturn, cid, ...)                                                  \
-  amd::Thread* thread = amd::Thread::current();                                                    \
-  if (!VDI_CHECK_THREAD(thread)) {                                                                 \
-    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS,                                                        \
-            "An internal error has occurred."                                                      \
-            " This may be due to insufficient memory.");                                           \
-    if (!noReturn) {                                                                               \
-      return hipErrorOutOfMemory;                                                                  \
+  if (!hip::tls.api_ready_) {                                                                      \
+    amd::Thread* thread = amd::Thread::current();                                                  \
+    if (!VDI_CHECK_THREAD(thread)) {                                                               \
+      ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS,                                                      \
+              "An internal error has occurred."                                                    \
+              " This may be due to insufficient memory.");                                         \
+      if (!noReturn) {                                                                             \
+        return hipErrorOutOfMemory;                                                                \
+      }                                                                                            \
     }                                                                                              \
+    HIP_INIT(noReturn)                                                                             \
+    hip::tls.api_ready_ = (hip::tls.device_ != nullptr);                                           \
   }                                                                                                \
-  HIP_INIT(noReturn)                                                                               \
   HIP_API_PRINT(__VA_ARGS__)                                                                       \
   HIP_CB_SPAWNER_OBJECT(cid);
 
 // This macro should be called at the beginning of every HIP API.
 #define HIP_INIT_API(cid, ...)                                                                     \
   HIP_INIT_API_INTERNAL(0, cid, __VA_ARGS__)                                                       \
-  if (hip::g_devices.size() == 0) {                                                                \
+  if (!hip::tls.api_ready_ && hip::g_devices.size() == 0) {                                        \
     HIP_RETURN(hipErrorNoDevice);                                                                  \
   }
 
@@ -168,32 +181,38 @@ const char* ihipGetErrorName(hipError_t hip_error);
   HIP_INIT_API_INTERNAL(1, cid, __VA_ARGS__)
 
 #define HIP_RETURN_DURATION(ret, ...)                                                              \
-  hip::tls.last_command_error_ = ret;                                                              \
-  if (DEBUG_HIP_7_PREVIEW & amd::CHANGE_HIP_GET_LAST_ERROR) {                                      \
-    if (hip::tls.last_command_error_ != hipSuccess &&                                              \
-           hip::tls.last_command_error_ != hipErrorNotReady) {                                     \
-      hip::tls.last_error_ = hip::tls.last_command_error_;                                         \
+  {                                                                                                \
+    hip::TlsAggregator& ret_tls = hip::tls;                                                        \
+    ret_tls.last_command_error_ = ret;                                                             \
+    if (DEBUG_HIP_7_PREVIEW & amd::CHANGE_HIP_GET_LAST_ERROR) {                                    \
+      if (ret_tls.last_command_error_ != hipSuccess &&                                             \
+          ret_tls.last_command_error_ != hipErrorNotReady) {                                       \
+        ret_tls.last_error_ = ret_tls.last_command_error_;                                         \
+      }                                                                                            \
+    } else {                                                                                       \
+      ret_tls.last_error_ = ret_tls.last_command_error_;                                           \
     }                                                                                              \
-  } else {                                                                                         \
-    hip::tls.last_error_ = hip::tls.last_command_error_;                                           \
-  }                                                                                                \
-  HIPPrintDuration(amd::LOG_INFO, amd::LOG_API, &startTimeUs, "%s: Returned %s : %s", __func__,    \
-                   hip::ihipGetErrorName(hip::tls.last_command_error_),                            \
-                   ToString(__VA_ARGS__).c_str());                                                 \
-  return hip::tls.last_command_error_;
+    HIPPrintDuration(amd::LOG_INFO, amd::LOG_API, &startTimeUs, "%s: Returned %s : %s",            \
+                     __func__, hip::ihipGetErrorName(ret_tls.last_command_error_),                 \
+                     ToString(__VA_ARGS__).c_str());                                               \
+    return ret_tls.last_command_error_;                                                            \
+  }
 
 #define HIP_RETURN(ret, ...)                                                                       \
-  hip::tls.last_command_error_ = ret;                                                              \
-  if (DEBUG_HIP_7_PREVIEW & amd::CHANGE_HIP_GET_LAST_ERROR) {                                      \
-    if (hip::tls.last_command_error_ != hipSuccess &&                                              \
-           hip::tls.last_command_error_ != hipErrorNotReady) {                                     \
-      hip::tls.last_error_ = hip::tls.last_command_error_;                                         \
+  {                                                                                                \
+    hip::TlsAggregator& ret_tls = hip::tls;                                                        \
+    ret_tls.last_command_error_ = ret;                                                             \
+    if (DEBUG_HIP_7_PREVIEW & amd::CHANGE_HIP_GET_LAST_ERROR) {                                    \
+      if (ret_tls.last_command_error_ != hipSuccess &&                                             \
+          ret_tls.last_command_error_ != hipErrorNotReady) {                                       \
+        ret_tls.last_error_ = ret_tls.last_command_error_;                                         \
+      }                                                                                            \
+    } else {                                                                                       \
+      ret_tls.last_error_ = ret_tls.last_command_error_;                                           \
     }                                                                                              \
-  } else {                                                                                         \
-    hip::tls.last_error_ = hip::tls.last_command_error_;                                           \
-  }                                                                                                \
-  HIP_ERROR_PRINT(hip::tls.last_command_error_, __VA_ARGS__)                                       \
-  return hip::tls.last_command_error_;
+    HIP_ERROR_PRINT(ret_tls.last_command_error_, __VA_ARGS__)                                      \
+    return ret_tls.last_command_error_;                                                            \
+  }
 
 #define HIP_RETURN_ONFAIL(func)          \
   do {                                   \
@@ -230,7 +249,8 @@ const char* ihipGetErrorName(hipError_t hip_error);
       }                                                                                            \
       HIP_RETURN(hipErrorStreamCaptureUnsupported);                                                \
     }                                                                                              \
-    if (g_captureStreams.size() != 0) {                                                            \
+    if (hip::Stream::GlobalCaptureOngoing()) {                                                     \
+      amd::ScopedLock lock(g_captureStreamsLock);                                                  \
       for (auto stream : g_captureStreams) {                                                       \
         stream->SetCaptureStatus(hipStreamCaptureStatusInvalidated);                               \
       }                                                                                            \
@@ -304,6 +324,7 @@ public:
 
   class Device;
   class MemoryPool;
+  class MemoryReclaimer;
   class Event;
   class Stream : public amd::HostQueue {
   public:
@@ -315,7 +336,7 @@ public:
     Priority priority_;
     unsigned int flags_;
     bool null_;
-    const std::vector<uint32_t> cuMask_;
+    std::vector<uint32_t> cuMask_;
 
     /// Stream capture related parameters
 
@@ -339,6 +360,12 @@ public:
     /// Capture events
     std::unordered_set<hipEvent_t> captureEvents_;
     unsigned long long captureID_;
+    /// Launch latency histograms, allocated if HIP_LAUNCH_LATENCY is set
+    std::unique_ptr<LaunchStats> launchStats_;
+    /// Epoch of this stream, the null stream waited for the last time
+    std::atomic<uint64_t> waitedEpoch_{0};
+    /// Epoch of the null stream, this stream waited for the last time
+    std::atomic<uint64_t> waitedNullEpoch_{0};
 
     static inline CommandQueue::Priority convertToQueuePriority(Priority p) {
       return p == Priority::High ? amd::CommandQueue::Priority::High : p == Priority::Low ?
@@ -367,7 +394,20 @@ public:
     /// Returns the priority for the current stream
     Priority GetPriority() const { return priority_; }
     /// Returns the CU mask for the current stream
-    const std::vector<uint32_t> GetCUMask() const { return cuMask_; }
+    const std::vector<uint32_t> GetCUMask() const {
+      amd::ScopedLock lock(lock_);
+      return cuMask_;
+    }
+    /// Waits for the submitted work and moves the stream to a HW queue with the new CU mask
+    hipError_t SetCUMask(const std::vector<uint32_t>& cuMask);
+    /// Clears the capture state of a destroyed stream before it returns to the stream pool
+    void ResetForReuse();
+    /// Returns the launch latency histograms or nullptr if the collection is disabled
+    LaunchStats* GetLaunchStats() const { return launchStats_.get(); }
+    /// Epoch of this stream, the null stream waited for the last time
+    std::atomic<uint64_t>& WaitedEpoch() { return waitedEpoch_; }
+    /// Epoch of the null stream, this stream waited for the last time
+    std::atomic<uint64_t>& WaitedNullEpoch() { return waitedNullEpoch_; }
 
     /// Check whether any blocking stream running
     static bool StreamCaptureBlocking();
@@ -379,6 +419,9 @@ public:
     /// Check Stream Capture status to make sure it is done
     static bool StreamCaptureOngoing(hipStream_t hStream);
 
+    /// Check whether any stream captures in global mode, the result is cached per thread
+    static bool GlobalCaptureOngoing();
+
     /// Returns capture status of the current stream
     hipStreamCaptureStatus GetCaptureStatus() const { return captureStatus_; }
     /// Returns capture mode of the current stream
@@ -483,6 +526,50 @@ public:
       ~Stream() {};
   };
 
+  /// Lock-free lookup of the live stream handles for the API validation. The writers serialize
+  /// on a lock, the readers only load the slots of an open addressing table. A replaced table is
+  /// kept alive until the exit, since a reader may still probe it
+  class StreamRegistry {
+   public:
+    static StreamRegistry& Get();
+
+    void Add(const Stream* stream);
+    void Remove(const Stream* stream);
+    bool Exists(const Stream* stream) const;
+
+   private:
+    StreamRegistry();
+
+    static constexpr uintptr_t kEmpty = 0;      //!< The slot was never used
+    static constexpr uintptr_t kTombstone = 1;  //!< The slot had a removed stream
+    static constexpr size_t kMinSlots = 256;    //!< The initial table size
+    static constexpr size_t kInvalidSlot = ~static_cast<size_t>(0);  //!< No slot index
+
+    struct Table {
+      explicit Table(size_t size) : mask_(size - 1), slots_(new std::atomic<uintptr_t>[size]) {
+        for (size_t i = 0; i < size; ++i) {
+          slots_[i].store(kEmpty, std::memory_order_relaxed);
+        }
+      }
+      size_t mask_;                                   //!< The table size minus one
+      std::unique_ptr<std::atomic<uintptr_t>[]> slots_;  //!< Stream pointers or markers
+    };
+
+    static size_t Hash(uintptr_t key) {
+      uint64_t hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+      return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    /// Moves the live streams into a new table of the specified size
+    void Rehash(size_t size);
+
+    std::atomic<Table*> table_;                   //!< The current table
+    std::vector<std::unique_ptr<Table>> tables_;  //!< All tables, including the replaced ones
+    size_t live_ = 0;                             //!< The number of live streams
+    size_t used_ = 0;                             //!< The number of live and removed slots
+    amd::Monitor lock_{true};                     //!< Serializes the writers
+  };
+
   /// HIP Device class
   class Device : public amd::ReferenceCountedObject {
     // Device lock
@@ -511,6 +598,35 @@ public:
     MemoryPool* graph_mem_pool_;    //!< Memory pool, associated with graphs for this device
 
     std::set<MemoryPool*> mem_pools_;
+    MemoryReclaimer* reclaimer_;    //!< Background release of the freed pool memory
+
+    /// Memory of a deferred hipFree and the last commands of the device streams at the free
+    struct DeferredFree {
+      amd::Memory* memory_;
+      std::vector<amd::Command*> commands_;
+    };
+    std::list<DeferredFree> deferred_frees_;  //!< Deferred frees in the order of hipFree
+    amd::Monitor deferred_free_lock_{true};   //!< Guards the deferred frees
+
+    /// Pinned bounce buffer of the async H2D copies from pageable memory
+    struct BounceBuffer {
+      void* ptr_;
+      size_t size_;
+      amd::Command* command_;  //!< The last copy from the buffer or nullptr
+      bool busy_;              //!< A copy from the buffer is in the setup
+    };
+    std::vector<BounceBuffer> bounce_buffers_;  //!< Grows up to HIP_ASYNC_STAGING_POOL_SIZE
+    size_t bounce_size_ = 0;                    //!< The size of all bounce buffers
+    amd::Monitor bounce_lock_{true};            //!< Guards the bounce buffers
+
+    std::vector<Stream*> idle_streams_;   //!< Destroyed streams, kept for hipStreamCreate
+    std::vector<Stream*> graph_streams_;  //!< Streams, shared by the multi-stream graph launches
+    size_t next_graph_stream_ = 0;        //!< The first stream of the next lease
+
+    /// Advanced with every enqueue on the blocking streams, so the null stream skips the walk of
+    /// the active streams, if nothing was enqueued since the last wait
+    std::atomic<uint64_t> blocking_epoch_{0};
+    std::atomic<uint64_t> waited_blocking_epoch_{0};  //!< The epoch of the last null stream wait
 
   public:
     Device(amd::Context* ctx, int devId): context_(ctx),
@@ -519,7 +635,8 @@ public:
         isActive_(false),
         default_mem_pool_(nullptr),
         current_mem_pool_(nullptr),
-        graph_mem_pool_(nullptr)
+        graph_mem_pool_(nullptr),
+        reclaimer_(nullptr)
         { assert(ctx != nullptr); }
     ~Device();
 
@@ -596,6 +713,39 @@ public:
     /// Release freed memory from all pools on the current device
     void ReleaseFreedMemory();
 
+    /// Release up to max_bytes of freed memory from all pools. Returns the released size
+    size_t ReclaimFreedMemory(size_t max_bytes);
+
+    /// Returns true if the memory belongs to a memory pool on the device
+    bool IsPoolMemory(amd::Memory* memory);
+
+    /// Prints the usage and fragmentation report of all pools on the device
+    void PrintPoolReport();
+
+    /// Keeps the destroyed stream in the stream pool. Returns false, if the stream can't be kept
+    bool RecycleStream(Stream* stream);
+
+    /// Returns a stream from the stream pool with the same priority and flags or nullptr
+    Stream* TakeIdleStream(Stream::Priority priority, unsigned int flags);
+
+    /// Frees the memory without a device sync. The memory returns to ROCr, when the GPU passes
+    /// the last commands of the device streams at the time of the free
+    void DeferFree(amd::Memory* memory);
+
+    /// Returns the memory of the deferred frees, which the GPU passed, to ROCr. If wait is true,
+    /// then waits for all deferred frees. Returns the released size
+    size_t ReclaimDeferredFrees(bool wait);
+
+    /// Returns a pinned buffer of at least size bytes for an async copy from pageable memory or
+    /// nullptr, if the pool is at its limit. The buffer stays busy until ReleaseBounceBuffer
+    void* AcquireBounceBuffer(size_t size);
+
+    /// Returns the bounce buffer into the pool, a new copy reuses it after the command passes
+    void ReleaseBounceBuffer(void* ptr, amd::Command* command);
+
+    /// Waits for the last copies and frees all bounce buffers
+    void FreeBounceBuffers();
+
     /// Removes a destroyed stream from the safe list of memory pools
     void RemoveStreamFromPools(Stream* stream);
 
@@ -604,6 +754,11 @@ public:
 
     /// Returns true if memory pool is valid on this device
     bool IsMemoryPoolValid(MemoryPool* pool);
+
+    /// Leases num_streams streams from the graph streams pool for a graph launch. The streams
+    /// stay in the pool and may be shared with the concurrent launches of other graphs
+    bool LeaseGraphStreams(uint32_t num_streams, std::vector<Stream*>& streams);
+
     void AddStream(Stream* stream);
 
     void RemoveStream(Stream* stream);
@@ -614,12 +769,42 @@ public:
 
     void SyncAllStreams( bool cpu_wait = true, bool wait_blocking_streams_only = false);
 
+    /// Synchronizes all streams of the devices with one host wait
+    static void SyncDevices(const std::vector<Device*>& devices, bool cpu_wait);
+
+    /// Appends the retained streams of the device, the null stream goes after the blocking streams
+    void CollectStreams(std::vector<hip::Stream*>& streams, bool wait_blocking_streams_only);
+
+    /// Waits for the last commands of the streams together, then finishes and releases the streams
+    static void FinishStreams(std::vector<hip::Stream*>& streams, bool cpu_wait);
+
     bool StreamCaptureBlocking();
 
     bool existsActiveStreamForDevice();
   /// Wait all active streams on the blocking queue. The method enqueues a wait command and
   /// doesn't stall the current thread
     void WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stream = false);
+
+    /// Returns the epoch, advanced by the enqueues on all blocking streams of the device
+    std::atomic<uint64_t>* BlockingEpoch() { return &blocking_epoch_; }
+  };
+
+  /// Automatic placement of the managed memory, driven by the kernel launches accessing it.
+  /// A range used by one device gets the preferred location and a prefetch to that device,
+  /// a range shared by several devices gets the accessed-by mappings instead of the migrations
+  class ManagedPolicy {
+  public:
+    /// Starts the tracking of a managed allocation
+    static void AddRange(amd::Memory* memory);
+
+    /// Stops the tracking of a managed allocation
+    static void RemoveRange(amd::Memory* memory);
+
+    /// Excludes the allocation from the policy, the application placed it explicitly
+    static void Advised(amd::Memory* memory);
+
+    /// Accounts the managed allocations in the kernel arguments of the launch on the stream
+    static void RecordLaunch(const amd::NDRangeKernelCommand& command, hip::Stream* stream);
   };
 
   /// Thread Local Storage Variables Aggregator Class
@@ -632,11 +817,19 @@ public:
     hipStreamCaptureMode stream_capture_mode_;
     std::stack<ihipExec_t> exec_stack_;
     stream_per_thread stream_per_thread_obj_;
+    bool api_ready_;  //!< The thread object, the runtime and the device are ready for the APIs
+    //! g_captureStreamsGeneration of global_capture_, the thread takes the list lock only after
+    //! a global mode capture begins or ends
+    uint64_t capture_generation_;
+    bool global_capture_;  //!< g_captureStreams isn't empty
 
     TlsAggregator(): device_(nullptr),
       last_error_(hipSuccess),
       last_command_error_(hipSuccess),
-      stream_capture_mode_(hipStreamCaptureModeGlobal) {
+      stream_capture_mode_(hipStreamCaptureModeGlobal),
+      api_ready_(false),
+      capture_generation_(~0ull),
+      global_capture_(false) {
     }
     ~TlsAggregator() {
     }
@@ -678,11 +871,23 @@ public:
   extern hipError_t ihipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags);
   extern amd::Memory* getMemoryObject(const void* ptr, size_t& offset, size_t size = 0);
   extern amd::Memory* getMemoryObjectWithOffset(const void* ptr, const size_t size = 0);
+
+  /// The memory object lookup of a memcpy or memset pointer. One API call classifies every
+  /// pointer once and the validation, the command creation and the sync decision reuse it
+  struct PtrInfo {
+    amd::Memory* memory_ = nullptr;           //!< nullptr for the pageable host memory
+    size_t offset_ = 0;                       //!< The offset of the pointer in memory_
+    hipMemoryType type_ = hipMemoryTypeHost;  //!< The pinned host memory is host type too
+
+    PtrInfo() = default;
+    explicit PtrInfo(const void* ptr);
+  };
   extern void getStreamPerThread(hipStream_t& stream);
   extern hipStream_t getPerThreadDefaultStream();
   extern hipError_t ihipUnbindTexture(textureReference* texRef);
   extern hipError_t ihipHostRegister(void* hostPtr, size_t sizeBytes, unsigned int flags);
   extern hipError_t ihipHostUnregister(void* hostPtr);
+  extern hipError_t hipLaunchHostFunc_common(hipStream_t stream, hipHostFn_t fn, void* userData);
   extern hipError_t ihipGetDeviceProperties(hipDeviceProp_t* props, hipDevice_t device);
 
   extern hipError_t ihipDeviceGet(hipDevice_t* device, int deviceId);
@@ -691,6 +896,9 @@ public:
                                         size_t sizeBytes);
   hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKind kind,
                         hip::Stream& stream, bool isHostAsync = false, bool isGPUAsync = true);
+  // Queues the copies with one command per kind of copy, the sources must stay valid until sync
+  hipError_t ihipMemcpyBatchAsync(void* const* dsts, const void* const* srcs,
+                                  const size_t* sizes, size_t count, hipStream_t stream);
   constexpr bool kOptionChangeable = true;
   constexpr bool kNewDevProg = false;
 
@@ -698,6 +906,7 @@ public:
 
   extern std::vector<hip::Stream*> g_captureStreams;
   extern amd::Monitor g_captureStreamsLock;
+  extern std::atomic<uint64_t> g_captureStreamsGeneration;
   extern amd::Monitor g_streamSetLock;
   extern std::unordered_set<hip::Stream*> g_allCapturingStreams;
 } // namespace hip
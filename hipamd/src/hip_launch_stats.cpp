@@ -0,0 +1,153 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hip_launch_stats.hpp"
+
+#include <mutex>
+#include <string>
+
+namespace hip {
+
+static const char* IntervalName[LaunchStats::kNumIntervals] = {
+    "validate", "create", "queue", "dispatch", "total"};
+
+static const char* GraphPathName[GraphLaunchStats::kNumPaths] = {
+    "single", "commands", "streams"};
+
+// ================================================================================================
+double LaunchStats::TicksPerNs() {
+  static double ticks_per_ns = 1.0;
+#if defined(__x86_64__) || defined(_M_X64)
+  static std::once_flag calibrated;
+  std::call_once(calibrated, []() {
+    // Calibrate TSC against the OS clock, it's done once with the enabled collection only
+    uint64_t ns_start = amd::Os::timeNanos();
+    uint64_t tsc_start = amd::activity_prof::LaunchTimestamp();
+    amd::Os::sleep(10);
+    uint64_t ns = amd::Os::timeNanos() - ns_start;
+    uint64_t tsc = amd::activity_prof::LaunchTimestamp() - tsc_start;
+    if (ns != 0 && tsc != 0) {
+      ticks_per_ns = static_cast<double>(tsc) / ns;
+    }
+  });
+#endif
+  return ticks_per_ns;
+}
+
+// ================================================================================================
+void LatencyHistogram::Add(uint64_t ns, uint64_t correlation_id) {
+  uint32_t bin = 0;
+  while ((bin < kNumBins - 1) && ((ns >> (bin + 1)) != 0)) {
+    ++bin;
+  }
+  bins_[bin].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (ns > max) {
+    if (max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+      // The ID can be a bit off under a race, but it only points to the trace to look at
+      max_id_.store(correlation_id, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+// ================================================================================================
+void LatencyHistogram::AppendBins(std::string& str) const {
+  for (uint32_t b = 0; b < kNumBins; ++b) {
+    uint64_t value = bins_[b].load(std::memory_order_relaxed);
+    if (value != 0) {
+      str += " [" + std::to_string(1ull << b) + "ns]:" + std::to_string(value);
+    }
+  }
+}
+
+// ================================================================================================
+void LaunchStats::Record(const amd::activity_prof::LaunchTrace& trace, uint64_t correlation_id) {
+  const double ticks_per_ns = TicksPerNs();
+  const uint64_t* stamp = trace.stamp_;
+  // The first stage with a valid timestamp is the start point of the next interval
+  uint32_t start = amd::activity_prof::LAUNCH_STAGE_API_ENTRY;
+  if (stamp[start] == 0) {
+    return;
+  }
+  uint32_t last = start;
+  for (uint32_t stage = start + 1; stage < amd::activity_prof::LAUNCH_STAGE_NUMBER; ++stage) {
+    // Skip the stages, which didn't happen in this thread. Their time goes into the next interval
+    if (stamp[stage] < stamp[last]) {
+      continue;
+    }
+    intervals_[stage - 1].Add(static_cast<uint64_t>((stamp[stage] - stamp[last]) / ticks_per_ns),
+                              correlation_id);
+    last = stage;
+  }
+  intervals_[kNumIntervals - 1].Add(
+      static_cast<uint64_t>((stamp[last] - stamp[start]) / ticks_per_ns), correlation_id);
+}
+
+// ================================================================================================
+void LaunchStats::Histogram(uint32_t interval, uint64_t* bins, uint32_t numBins) const {
+  for (uint32_t i = 0; i < numBins; ++i) {
+    bins[i] = (i < kNumBins) ? intervals_[interval].bins_[i].load(std::memory_order_relaxed) : 0;
+  }
+}
+
+// ================================================================================================
+void LaunchStats::Print(const void* stream) const {
+  if (intervals_[kNumIntervals - 1].count_ == 0) {
+    return;
+  }
+  for (uint32_t i = 0; i < kNumIntervals; ++i) {
+    const LatencyHistogram& it = intervals_[i];
+    uint64_t count = it.count_.load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    std::string bins;
+    it.AppendBins(bins);
+    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "Stream %p launch latency %-8s: count %lu, "
+            "avg %lu ns, max %lu ns (correlation id %lu),%s", stream, IntervalName[i], count,
+            it.sum_.load(std::memory_order_relaxed) / count,
+            it.max_.load(std::memory_order_relaxed),
+            it.max_id_.load(std::memory_order_relaxed), bins.c_str());
+  }
+}
+
+// ================================================================================================
+void GraphLaunchStats::Print(const void* graph_exec, size_t num_nodes) const {
+  for (uint32_t i = 0; i < kNumPaths; ++i) {
+    const LatencyHistogram& it = paths_[i];
+    uint64_t count = it.count_.load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    uint64_t avg = it.sum_.load(std::memory_order_relaxed) / count;
+    std::string bins;
+    it.AppendBins(bins);
+    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "Graph exec %p launch time %-8s: nodes %zu, "
+            "count %lu, avg %lu ns (%lu ns per node), max %lu ns (correlation id %lu),%s",
+            graph_exec, GraphPathName[i], num_nodes, count, avg,
+            (num_nodes != 0) ? avg / num_nodes : 0, it.max_.load(std::memory_order_relaxed),
+            it.max_id_.load(std::memory_order_relaxed), bins.c_str());
+  }
+}
+
+}  // namespace hip
@@ -0,0 +1,98 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "platform/activity.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace hip {
+
+/// Lock-free log2 latency histogram. Bin N counts the samples in [2^N, 2^(N+1)) nanoseconds
+struct LatencyHistogram {
+  static constexpr uint32_t kNumBins = 32;
+
+  /// Adds a sample with the correlation ID of the launch
+  void Add(uint64_t ns, uint64_t correlation_id);
+
+  /// Appends the non-empty bins as the text into the string
+  void AppendBins(std::string& str) const;
+
+  std::atomic<uint64_t> bins_[kNumBins] = {};  //!< Launch counts per latency bin
+  std::atomic<uint64_t> count_{0};             //!< Total number of the samples
+  std::atomic<uint64_t> sum_{0};               //!< Total latency in nanoseconds
+  std::atomic<uint64_t> max_{0};               //!< The worst latency in nanoseconds
+  std::atomic<uint64_t> max_id_{0};            //!< Correlation ID of the worst launch
+};
+
+/// Lock-free launch latency histograms of a stream. Each interval covers the time between
+/// two consecutive launch stages, the last interval covers the whole launch.
+/// Bin N counts the launches with the latency in [2^N, 2^(N+1)) nanoseconds
+class LaunchStats {
+ public:
+  static constexpr uint32_t kNumIntervals = amd::activity_prof::LAUNCH_STAGE_NUMBER;
+  static constexpr uint32_t kNumBins = LatencyHistogram::kNumBins;
+
+  LaunchStats() = default;
+
+  /// Records the launch stages of the current thread
+  void Record(const amd::activity_prof::LaunchTrace& trace, uint64_t correlation_id);
+
+  /// Copies up to numBins bins of the interval histogram
+  void Histogram(uint32_t interval, uint64_t* bins, uint32_t numBins) const;
+
+  /// Prints all histograms with the slowest launch correlation IDs
+  void Print(const void* stream) const;
+
+  /// Converts the launch timestamps into nanoseconds
+  static double TicksPerNs();
+
+ private:
+  LatencyHistogram intervals_[kNumIntervals];
+};
+
+/// Host time histograms of the graph launches, separated by the execution path of the graph
+class GraphLaunchStats {
+ public:
+  enum Path : uint32_t {
+    kSingleList = 0,  //!< Single stream graph, launched on the instantiation device
+    kCommands,        //!< Single stream graph, launched on another device with the commands
+    kMultiStream,     //!< Graph with parallel branches, launched on the leased streams
+    kNumPaths
+  };
+
+  GraphLaunchStats() = default;
+
+  /// Records the host time of a single launch
+  void Record(Path path, uint64_t ns, uint64_t correlation_id) {
+    paths_[path].Add(ns, correlation_id);
+  }
+
+  /// Prints all histograms of the executable graph with the number of the nodes
+  void Print(const void* graph_exec, size_t num_nodes) const;
+
+ private:
+  LatencyHistogram paths_[kNumPaths];
+};
+
+}  // namespace hip
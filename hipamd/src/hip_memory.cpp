@@ -19,19 +19,64 @@
  THE SOFTWARE. */
 
 #include <hip/hip_runtime.h>
+#include <unordered_map>
 #include "hip_internal.hpp"
 #include "hip_platform.hpp"
 #include "hip_conversions.hpp"
+#include "hip_event.hpp"
 #include "platform/context.hpp"
 #include "platform/command.hpp"
 #include "platform/memory.hpp"
 #include "platform/external_memory.hpp"
+#include "platform/trace_events.hpp"
+#include "thread/threadpool.hpp"
+
+#if defined(ATI_ARCH_X86)
+#include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 namespace hip {
 
 // Guards global hipArray set
 amd::Monitor hipArraySetLock{};
 std::unordered_set<hipArray*> hipArraySet;
 
+// Cache of the opened IPC memory handles. Repeated opens of the same handle on the same device
+// reuse the imported memory, and only the last close detaches it
+struct IpcOpenEntry {
+  void* dev_ptr_;       //!< Device pointer of the imported memory
+  uint32_t open_count_; //!< Number of the opens, which weren't closed yet
+};
+static amd::Monitor ipcOpenLock{};
+static std::unordered_map<std::string, IpcOpenEntry> ipcOpenCache;
+static std::unordered_map<void*, std::string> ipcOpenKeys;
+
+// Registered host ranges. A registration inside a registered range shares its pin instead of a
+// new lock, and the range keeps its MemObjMap entry until its own and all nested registrations
+// are gone
+struct HostRegion {
+  uint32_t nested_ = 0;  //!< Number of the registrations inside the range
+  bool own_ = true;      //!< The registration of the range itself is active
+};
+static amd::Monitor hostRegisterLock{};
+static std::unordered_map<amd::Memory*, HostRegion> hostRegions;
+static std::unordered_map<const void*, amd::Memory*> hostNestedRegs;
+
+// Imported external memory, keyed by the identity of the underlying buffer. Repeated imports of
+// the same buffer share the mapping, and a pinned buffer stays mapped after the last destroy
+struct ExtMemEntry {
+  amd::ExternalBuffer* buffer_;  //!< The imported buffer
+  uint32_t import_count_;        //!< Number of the imports, which weren't destroyed yet
+  uint32_t pin_count_;           //!< Number of the pins, each holds a reference on the buffer
+};
+static amd::Monitor extMemLock{};
+static std::unordered_map<std::string, ExtMemEntry> extMemCache;
+static std::unordered_map<amd::Memory*, std::string> extMemKeys;
+
 // ================================================================================================
 amd::Memory* getMemoryObject(const void* ptr, size_t& offset, size_t size) {
   auto memObj = amd::MemObjMap::FindMemObj(ptr, &offset);
@@ -53,6 +98,14 @@ hipMemoryType getMemoryType(const amd::Memory* memory) {
       : hipMemoryTypeDevice;
 }
 
+// ================================================================================================
+PtrInfo::PtrInfo(const void* ptr) {
+  if (ptr != nullptr) {
+    memory_ = getMemoryObject(ptr, offset_);
+    type_ = getMemoryType(memory_);
+  }
+}
+
 // ================================================================================================
 amd::Memory* getMemoryObjectWithOffset(const void* ptr, const size_t size) {
   size_t offset = 0;
@@ -76,6 +129,15 @@ amd::Memory* getMemoryObjectWithOffset(const void* ptr, const size_t size) {
   return memObj;
 }
 
+// ================================================================================================
+//! Returns the trace kind of the allocation with the SVM flags
+static amd::AllocTrace::Kind AllocTraceKind(cl_mem_flags flags) {
+  if ((flags & CL_MEM_SVM_FINE_GRAIN_BUFFER) == 0) {
+    return amd::AllocTrace::kDevice;
+  }
+  return (flags & CL_MEM_ALLOC_HOST_PTR) ? amd::AllocTrace::kManaged : amd::AllocTrace::kHost;
+}
+
 // ================================================================================================
 hipError_t ihipFree(void *ptr) {
   if (ptr == nullptr) {
@@ -85,8 +147,24 @@ hipError_t ihipFree(void *ptr) {
   size_t offset = 0;
   amd::Memory* memory_object = getMemoryObject(ptr, offset);
   if (memory_object != nullptr) {
+    if (HIP_HMM_AUTO_POLICY) {
+      hip::ManagedPolicy::RemoveRange(memory_object);
+    }
     // Wait on the device, associated with the current memory object during allocation
     auto device_id = memory_object->getUserData().deviceId;
+    if (amd::AllocTrace::Enabled() && !memory_object->isInterop() &&
+        !memory_object->ipcShared() && !g_devices[device_id]->IsPoolMemory(memory_object)) {
+      // The pool frees are recorded by the pool
+      amd::AllocTrace::Record(amd::AllocTrace::kFree,
+                              AllocTraceKind(memory_object->getMemFlags()), ptr,
+                              memory_object->getSize());
+    }
+    if (HIP_DEFERRED_FREE && !memory_object->isInterop() && !memory_object->ipcShared() &&
+        !g_devices[device_id]->IsPoolMemory(memory_object)) {
+      // Skip the device sync, the memory returns to ROCr after the GPU is done with it
+      g_devices[device_id]->DeferFree(memory_object);
+      return hipSuccess;
+    }
     g_devices[device_id]->SyncAllStreams();
 
     // Find out if memory belongs to any memory pool
@@ -104,6 +182,38 @@ hipError_t ihipFree(void *ptr) {
   return hipErrorInvalidValue;
 }
 
+// ================================================================================================
+// Builds the cache key of the external memory. The key is empty if the handle has no stable
+// identity, and then the memory isn't shared
+static std::string ihipExternalMemoryKey(const hipExternalMemoryHandleDesc* memHandleDesc,
+                                         const amd::Context& amdContext) {
+  std::string key;
+#ifdef _WIN32
+  // Only the KMT handles are global names of the resource, NT handles differ per duplicate
+  if ((memHandleDesc->type != hipExternalMemoryHandleTypeOpaqueWin32Kmt) &&
+      (memHandleDesc->type != hipExternalMemoryHandleTypeD3D11ResourceKmt)) {
+    return key;
+  }
+  uint64_t id = reinterpret_cast<uint64_t>(memHandleDesc->handle.win32.handle);
+  key.append(reinterpret_cast<const char*>(&id), sizeof(id));
+#else
+  // All the file descriptors of a dma-buf share the same inode
+  struct stat st;
+  if (fstat(memHandleDesc->handle.fd, &st) != 0) {
+    return key;
+  }
+  uint64_t dev = st.st_dev;
+  uint64_t ino = st.st_ino;
+  key.append(reinterpret_cast<const char*>(&dev), sizeof(dev));
+  key.append(reinterpret_cast<const char*>(&ino), sizeof(ino));
+#endif
+  const amd::Context* context = &amdContext;
+  key.append(reinterpret_cast<const char*>(&memHandleDesc->type), sizeof(memHandleDesc->type));
+  key.append(reinterpret_cast<const char*>(&memHandleDesc->size), sizeof(memHandleDesc->size));
+  key.append(reinterpret_cast<const char*>(&context), sizeof(context));
+  return key;
+}
+
 // ================================================================================================
 hipError_t hipImportExternalMemory(
     hipExternalMemory_t* extMem_out,
@@ -121,6 +231,19 @@ hipError_t hipImportExternalMemory(
   }
 
   amd::Context& amdContext = *hip::getCurrentDevice()->asContext();
+  std::string key = ihipExternalMemoryKey(memHandleDesc, amdContext);
+
+  amd::ScopedLock lock(extMemLock);
+  if (!key.empty()) {
+    auto it = extMemCache.find(key);
+    if (it != extMemCache.end()) {
+      it->second.import_count_++;
+      it->second.buffer_->retain();
+      *extMem_out = it->second.buffer_;
+      HIP_RETURN(hipSuccess);
+    }
+  }
+
 #ifdef _WIN32
   auto ext_buffer = new (amdContext) amd::ExternalBuffer(amdContext, memHandleDesc->size,
       memHandleDesc->handle.win32.handle,
@@ -140,6 +263,10 @@ hipError_t hipImportExternalMemory(
     ext_buffer->release();
     HIP_RETURN(hipErrorOutOfMemory);
   }
+  if (!key.empty()) {
+    extMemCache[key] = {ext_buffer, 1, 0};
+    extMemKeys[ext_buffer] = key;
+  }
   *extMem_out = ext_buffer;
 
   HIP_RETURN(hipSuccess);
@@ -174,7 +301,69 @@ hipError_t hipDestroyExternalMemory(hipExternalMemory_t extMem) {
   if (extMem == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  reinterpret_cast<amd::ExternalBuffer*>(extMem)->release();
+  auto buf = reinterpret_cast<amd::ExternalBuffer*>(extMem);
+  {
+    // The last import, which isn't pinned, removes the buffer from the cache, so a later import
+    // of the same handle maps it again
+    amd::ScopedLock lock(extMemLock);
+    auto key = extMemKeys.find(buf);
+    if (key != extMemKeys.end()) {
+      auto it = extMemCache.find(key->second);
+      if ((--it->second.import_count_ == 0) && (it->second.pin_count_ == 0)) {
+        extMemCache.erase(it);
+        extMemKeys.erase(key);
+      }
+    }
+  }
+  buf->release();
+
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+hipError_t hipExtExternalMemoryPin(hipExternalMemory_t extMem) {
+  HIP_INIT_API(hipExtExternalMemoryPin, extMem);
+
+  if (extMem == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  auto buf = reinterpret_cast<amd::ExternalBuffer*>(extMem);
+  amd::ScopedLock lock(extMemLock);
+  auto key = extMemKeys.find(buf);
+  if (key == extMemKeys.end()) {
+    // The handle has no stable identity, so a later import couldn't find the mapping
+    HIP_RETURN(hipErrorNotSupported);
+  }
+  extMemCache[key->second].pin_count_++;
+  buf->retain();
+
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+hipError_t hipExtExternalMemoryUnpin(hipExternalMemory_t extMem) {
+  HIP_INIT_API(hipExtExternalMemoryUnpin, extMem);
+
+  if (extMem == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  auto buf = reinterpret_cast<amd::ExternalBuffer*>(extMem);
+  {
+    amd::ScopedLock lock(extMemLock);
+    auto key = extMemKeys.find(buf);
+    if (key == extMemKeys.end()) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    auto it = extMemCache.find(key->second);
+    if (it->second.pin_count_ == 0) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    if ((--it->second.pin_count_ == 0) && (it->second.import_count_ == 0)) {
+      extMemCache.erase(it);
+      extMemKeys.erase(key);
+    }
+  }
+  buf->release();
 
   HIP_RETURN(hipSuccess);
 }
@@ -228,24 +417,30 @@ hipError_t hipSignalExternalSemaphoresAsync(
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  // All semaphores of the call go into one command, validate them first
+  amd::ExternalSemaphoreCmd::SemaphoreList semaphores;
+  semaphores.reserve(numExtSems);
   for (unsigned int i = 0; i < numExtSems; i++) {
-    if (extSemArray[i] != nullptr) {
-     if (paramsArray[i].flags != 0) {
-       // flags should be 0 for any type other than hipExternalSemaphoreHandleTypeNvSciSync.
-       // But hipExternalSemaphoreHandleTypeNvSciSync is not supported on AMD device.
-       HIP_RETURN(hipErrorInvalidValue);
-      }
-      amd::ExternalSemaphoreCmd* command =
-          new amd::ExternalSemaphoreCmd(*hip_stream, extSemArray[i], paramsArray[i].params.fence.value,
-                                        amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE);
-      if (command == nullptr) {
-        return hipErrorOutOfMemory;
-      }
-      command->enqueue();
-      command->release();
-    } else {
+    if (extSemArray[i] == nullptr) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    if (paramsArray[i].flags != 0) {
+      // flags should be 0 for any type other than hipExternalSemaphoreHandleTypeNvSciSync.
+      // But hipExternalSemaphoreHandleTypeNvSciSync is not supported on AMD device.
       HIP_RETURN(hipErrorInvalidValue);
     }
+    semaphores.push_back({extSemArray[i], paramsArray[i].params.fence.value});
+  }
+
+  if (!semaphores.empty()) {
+    amd::ExternalSemaphoreCmd* command =
+        new amd::ExternalSemaphoreCmd(*hip_stream, std::move(semaphores),
+                                      amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE);
+    if (command == nullptr) {
+      HIP_RETURN(hipErrorOutOfMemory);
+    }
+    command->enqueue();
+    command->release();
   }
 
   HIP_RETURN(hipSuccess);
@@ -268,25 +463,32 @@ hipError_t hipWaitExternalSemaphoresAsync(const hipExternalSemaphore_t* extSemAr
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  // All semaphores of the call go into one command, validate them first
+  amd::ExternalSemaphoreCmd::SemaphoreList semaphores;
+  semaphores.reserve(numExtSems);
   for (unsigned int i = 0; i < numExtSems; i++) {
-    if (extSemArray[i] != nullptr) {
-      if (paramsArray[i].flags != 0) {
-        // flags should be 0 for any type other than hipExternalSemaphoreHandleTypeNvSciSync.
-        // But hipExternalSemaphoreHandleTypeNvSciSync is not supported on AMD device.
-        HIP_RETURN(hipErrorInvalidValue);
-      }
-      amd::ExternalSemaphoreCmd* command =
-          new amd::ExternalSemaphoreCmd(*hip_stream, extSemArray[i], paramsArray[i].params.fence.value,
-                                        amd::ExternalSemaphoreCmd::COMMAND_WAIT_EXTSEMAPHORE);
-      if (command == nullptr) {
-        return hipErrorOutOfMemory;
-      }
-      command->enqueue();
-      command->release();
-    } else {
+    if (extSemArray[i] == nullptr) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    if (paramsArray[i].flags != 0) {
+      // flags should be 0 for any type other than hipExternalSemaphoreHandleTypeNvSciSync.
+      // But hipExternalSemaphoreHandleTypeNvSciSync is not supported on AMD device.
       HIP_RETURN(hipErrorInvalidValue);
     }
+    semaphores.push_back({extSemArray[i], paramsArray[i].params.fence.value});
   }
+
+  if (!semaphores.empty()) {
+    amd::ExternalSemaphoreCmd* command =
+        new amd::ExternalSemaphoreCmd(*hip_stream, std::move(semaphores),
+                                      amd::ExternalSemaphoreCmd::COMMAND_WAIT_EXTSEMAPHORE);
+    if (command == nullptr) {
+      HIP_RETURN(hipErrorOutOfMemory);
+    }
+    command->enqueue();
+    command->release();
+  }
+
   HIP_RETURN(hipSuccess);
 }
 
@@ -335,6 +537,13 @@ hipError_t ihipMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
   *ptr = amd::SvmBuffer::malloc(*amdContext, flags, sizeBytes, dev_info.memBaseAddrAlign_,
               useHostDevice ? curDevContext->svmDevices()[0] : nullptr);
 
+  if ((*ptr == nullptr) && HIP_DEFERRED_FREE &&
+      (hip::getCurrentDevice()->ReclaimDeferredFrees(true) != 0)) {
+    // Retry with the memory of the deferred frees
+    *ptr = amd::SvmBuffer::malloc(*amdContext, flags, sizeBytes, dev_info.memBaseAddrAlign_,
+                useHostDevice ? curDevContext->svmDevices()[0] : nullptr);
+  }
+
   if (*ptr == nullptr) {
     if (!useHostDevice) {
       size_t free = 0, total =0;
@@ -351,6 +560,9 @@ hipError_t ihipMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
   amd::Memory* memObj = getMemoryObject(*ptr, offset);
   //saves the current device id so that it can be accessed later
   memObj->getUserData().deviceId = hip::getCurrentDevice()->deviceId();
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kAlloc, AllocTraceKind(flags), *ptr, sizeBytes);
+  }
   return hipSuccess;
 }
 
@@ -392,6 +604,10 @@ hipError_t ihipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
     ihipFlags &= ~CL_MEM_SVM_ATOMICS;
   }
 
+  if (flags & hipExtHostAllocHugePages) {
+    ihipFlags |= ROCCLR_MEM_HUGE_PAGES;
+  }
+
   hipError_t status = ihipMalloc(ptr, sizeBytes, ihipFlags);
 
   if ((status == hipSuccess) && ((*ptr) != nullptr)) {
@@ -405,12 +621,9 @@ hipError_t ihipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
 }
 
 // ================================================================================================
-bool IsHtoHMemcpyValid(void* dst, const void* src, hipMemcpyKind kind) {
-  size_t sOffset = 0;
-  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
-  size_t dOffset = 0;
-  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
-  if (src && dst && srcMemory == nullptr && dstMemory == nullptr) {
+static bool IsHtoHMemcpyValid(const PtrInfo& dstInfo, const PtrInfo& srcInfo, void* dst,
+                              const void* src, hipMemcpyKind kind) {
+  if (src && dst && srcInfo.memory_ == nullptr && dstInfo.memory_ == nullptr) {
     if (!g_devices[0]->devices()[0]->info().hmmCpuMemoryAccessible_ &&
          kind != hipMemcpyHostToHost && kind != hipMemcpyDefault) {
       return false;
@@ -420,7 +633,8 @@ bool IsHtoHMemcpyValid(void* dst, const void* src, hipMemcpyKind kind) {
 }
 
 // ================================================================================================
-hipError_t ihipMemcpy_validate(void* dst, const void* src, size_t sizeBytes,
+static hipError_t ihipMemcpy_validate(const PtrInfo& dstInfo, const PtrInfo& srcInfo,
+                                      void* dst, const void* src, size_t sizeBytes,
                                       hipMemcpyKind kind) {
   if (dst == nullptr || src == nullptr) {
     return hipErrorInvalidValue;
@@ -428,10 +642,10 @@ hipError_t ihipMemcpy_validate(void* dst, const void* src, size_t sizeBytes,
   if (static_cast<uint32_t>(kind) > hipMemcpyDefault && kind != hipMemcpyDeviceToDeviceNoCU) {
     return hipErrorInvalidMemcpyDirection;
   }
-  size_t sOffset = 0;
-  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
-  size_t dOffset = 0;
-  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
+  const size_t sOffset = srcInfo.offset_;
+  amd::Memory* srcMemory = srcInfo.memory_;
+  const size_t dOffset = dstInfo.offset_;
+  amd::Memory* dstMemory = dstInfo.memory_;
 
   if (srcMemory != nullptr) {
     // Validate Mem Access in case of VMM Memory
@@ -470,17 +684,26 @@ hipError_t ihipMemcpy_validate(void* dst, const void* src, size_t sizeBytes,
   }
 
   //If src and dst ptr are null then kind must be either h2h or def.
-  if (!IsHtoHMemcpyValid(dst, src, kind)) {
+  if (!IsHtoHMemcpyValid(dstInfo, srcInfo, dst, src, kind)) {
     return hipErrorInvalidValue;
   }
   return hipSuccess;
 }
 
-hip::MemcpyType ihipGetMemcpyType(const void* src, void* dst, hipMemcpyKind kind) {
-  size_t sOffset = 0;
-  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
-  size_t dOffset = 0;
-  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
+// ================================================================================================
+hipError_t ihipMemcpy_validate(void* dst, const void* src, size_t sizeBytes,
+                                      hipMemcpyKind kind) {
+  if (dst == nullptr || src == nullptr) {
+    return hipErrorInvalidValue;
+  }
+  return ihipMemcpy_validate(PtrInfo(dst), PtrInfo(src), dst, src, sizeBytes, kind);
+}
+
+// ================================================================================================
+static hip::MemcpyType ihipGetMemcpyType(const PtrInfo& srcInfo, const PtrInfo& dstInfo,
+                                         hipMemcpyKind kind) {
+  amd::Memory* srcMemory = srcInfo.memory_;
+  amd::Memory* dstMemory = dstInfo.memory_;
   hip::MemcpyType type;
   if(srcMemory == nullptr && dstMemory == nullptr) {
     type = hipHostToHost;
@@ -506,16 +729,23 @@ hip::MemcpyType ihipGetMemcpyType(const void* src, void* dst, hipMemcpyKind kind
 }
 
 // ================================================================================================
-hipError_t ihipMemcpyCommand(amd::Command*& command, void* dst, const void* src, size_t sizeBytes,
-                             hipMemcpyKind kind, hip::Stream& stream, bool isAsync) {
+hip::MemcpyType ihipGetMemcpyType(const void* src, void* dst, hipMemcpyKind kind) {
+  return ihipGetMemcpyType(PtrInfo(src), PtrInfo(dst), kind);
+}
+
+// ================================================================================================
+static hipError_t ihipMemcpyCommand(amd::Command*& command, const PtrInfo& dstInfo,
+                                    const PtrInfo& srcInfo, void* dst, const void* src,
+                                    size_t sizeBytes, hipMemcpyKind kind, hip::Stream& stream,
+                                    bool isAsync) {
   amd::Command::EventWaitList waitList;
-  size_t sOffset = 0;
-  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
-  size_t dOffset = 0;
-  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
+  const size_t sOffset = srcInfo.offset_;
+  amd::Memory* srcMemory = srcInfo.memory_;
+  const size_t dOffset = dstInfo.offset_;
+  amd::Memory* dstMemory = dstInfo.memory_;
   amd::Device* queueDevice = &stream.device();
   amd::CopyMetadata copyMetadata(isAsync, amd::CopyMetadata::CopyEnginePreference::NONE);
-  hip::MemcpyType type = ihipGetMemcpyType(src, dst, kind);
+  hip::MemcpyType type = ihipGetMemcpyType(srcInfo, dstInfo, kind);
   hip::Stream* pStream = &stream;
   switch (type) {
     case hipWriteBuffer:
@@ -599,6 +829,13 @@ hipError_t ihipMemcpyCommand(amd::Command*& command, void* dst, const void* src,
   return hipSuccess;
 }
 
+// ================================================================================================
+hipError_t ihipMemcpyCommand(amd::Command*& command, void* dst, const void* src, size_t sizeBytes,
+                             hipMemcpyKind kind, hip::Stream& stream, bool isAsync) {
+  return ihipMemcpyCommand(command, PtrInfo(dst), PtrInfo(src), dst, src, sizeBytes, kind, stream,
+                           isAsync);
+}
+
 bool IsHtoHMemcpy(void* dst, const void* src) {
   size_t sOffset = 0;
   amd::Memory* srcMemory = getMemoryObject(src, sOffset);
@@ -611,9 +848,101 @@ bool IsHtoHMemcpy(void* dst, const void* src) {
 }
 
 // ================================================================================================
-void ihipHtoHMemcpy(void* dst, const void* src, size_t sizeBytes, hip::Stream& stream) {
+//! Copies with the streaming stores, so a large copy doesn't evict the caches of the app
+static void ihipStreamingMemcpy(void* dst, const void* src, size_t size) {
+#if defined(ATI_ARCH_X86)
+  char* d = reinterpret_cast<char*>(dst);
+  const char* s = reinterpret_cast<const char*>(src);
+  // The streaming stores need the aligned destination
+  const size_t head =
+      std::min(size, (sizeof(__m128i) - (reinterpret_cast<uintptr_t>(d) % sizeof(__m128i))) %
+                         sizeof(__m128i));
+  memcpy(d, s, head);
+  d += head;
+  s += head;
+  size -= head;
+  for (; size >= sizeof(__m128i); size -= sizeof(__m128i)) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+    d += sizeof(__m128i);
+    s += sizeof(__m128i);
+  }
+  memcpy(d, s, size);
+  _mm_sfence();
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+// ================================================================================================
+//! Copies the host memory on the calling thread, the large copies run in parallel chunks with
+//! the streaming stores
+static void ihipHostCopy(void* dst, const void* src, size_t sizeBytes) {
+  // A few threads saturate the host memory bandwidth
+  constexpr size_t kChunkSize = 4 * Mi;
+  constexpr uint32_t kCopyThreads = 8;
+  if (sizeBytes <= kChunkSize) {
+    memcpy(dst, src, sizeBytes);
+    return;
+  }
+  const size_t chunks = amd::alignUp(sizeBytes, kChunkSize) / kChunkSize;
+  amd::ThreadPool::shared().parallelFor(chunks, [=](size_t i) {
+    const size_t offset = i * kChunkSize;
+    ihipStreamingMemcpy(reinterpret_cast<char*>(dst) + offset,
+                        reinterpret_cast<const char*>(src) + offset,
+                        std::min(kChunkSize, sizeBytes - offset));
+  }, kCopyThreads);
+}
+
+//! The stream ordered host to host copy of the async memcpy
+class HostCopyCallback : public StreamCallback {
+  void* dst_;
+  const void* src_;
+  size_t size_;
+ public:
+  HostCopyCallback(void* dst, const void* src, size_t size)
+      : StreamCallback(nullptr), dst_(dst), src_(src), size_(size) {}
+
+  void CL_CALLBACK callback() {
+    amd::TraceEvents::Scope trace(amd::TraceEvents::Copy, "HostCopy");
+    ihipHostCopy(dst_, src_, size_);
+  }
+};
+
+// ================================================================================================
+hipError_t ihipHtoHMemcpy(void* dst, const void* src, size_t sizeBytes, hip::Stream& stream,
+                          bool isHostAsync) {
+  if (isHostAsync) {
+    // The callback thread copies after the queued work of the stream
+    return ihipEnqueueStreamCallback(&stream, new HostCopyCallback(dst, src, sizeBytes));
+  }
   stream.finish();
-  memcpy(dst, src, sizeBytes);
+  ihipHostCopy(dst, src, sizeBytes);
+  return hipSuccess;
+}
+
+// ================================================================================================
+//! Copies the pageable source into a pinned bounce buffer in parallel chunks, so the GPU copy
+//! runs from the snapshot. Returns nullptr if the bounce pool is at its limit
+static void* ihipSnapshotHostSource(const void* src, size_t sizeBytes, hip::Device* device) {
+  void* bounce = device->AcquireBounceBuffer(sizeBytes);
+  if (bounce == nullptr) {
+    return nullptr;
+  }
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Copy, "BounceSnapshot");
+  ihipHostCopy(bounce, src, sizeBytes);
+  return bounce;
+}
+
+// ================================================================================================
+// The small H2D copies from pageable memory carry the data with the command, which skips the
+// staging copy and lets the source be reused right after the enqueue
+static bool ihipUseInlineWrite(const PtrInfo& dstInfo, size_t sizeBytes, hip::Stream& stream) {
+  return (sizeBytes <= HIP_INLINE_WRITE_SIZE) &&
+         (sizeBytes <= amd::WriteMemoryInlineCommand::MaxPayloadSize) &&
+         (dstInfo.memory_ != nullptr) && (dstInfo.type_ == hipMemoryTypeDevice) &&
+         (dstInfo.memory_->GetDeviceById() == &stream.device()) &&
+         !dstInfo.memory_->getUserData().sync_mem_ops_;
 }
 
 // ================================================================================================
@@ -624,31 +953,56 @@ hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKin
     // Skip if nothing needs writing.
     return hipSuccess;
   }
-  status = ihipMemcpy_validate(dst, src, sizeBytes, kind);
+  // The validation, the command and the sync decision share one lookup of each pointer
+  const PtrInfo srcInfo(src);
+  const PtrInfo dstInfo(dst);
+  status = ihipMemcpy_validate(dstInfo, srcInfo, dst, src, sizeBytes, kind);
   if (status != hipSuccess) {
     return status;
   }
   if (src == dst && kind == hipMemcpyDefault) {
     return hipSuccess;
   }
-  size_t sOffset = 0;
-  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
-  size_t dOffset = 0;
-  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
+  amd::Memory* srcMemory = srcInfo.memory_;
+  amd::Memory* dstMemory = dstInfo.memory_;
 
-  hipMemoryType srcMemoryType = getMemoryType(srcMemory);
-  hipMemoryType dstMemoryType = getMemoryType(dstMemory);
+  hipMemoryType srcMemoryType = srcInfo.type_;
+  hipMemoryType dstMemoryType = dstInfo.type_;
 
-  if (srcMemory == nullptr && dstMemory == nullptr) {
-    ihipHtoHMemcpy(dst, src, sizeBytes, stream);
+  if ((srcMemory == nullptr) && isGPUAsync && ihipUseInlineWrite(dstInfo, sizeBytes, stream)) {
+    amd::Command::EventWaitList waitList;
+    amd::WriteMemoryInlineCommand* command = new amd::WriteMemoryInlineCommand(stream, waitList);
+    if (command == nullptr) {
+      return hipErrorOutOfMemory;
+    }
+    command->addWrite(*dstMemory, dstInfo.offset_, src, sizeBytes);
+    command->enqueue();
+    // The small staged H2D copies return without the wait under the direct dispatch only
+    if (!isHostAsync && !AMD_DIRECT_DISPATCH) {
+      command->awaitCompletion();
+    }
+    command->release();
     return hipSuccess;
+  }
+
+  void* bounce = nullptr;
+  if (srcMemory == nullptr && dstMemory == nullptr) {
+    return ihipHtoHMemcpy(dst, src, sizeBytes, stream, isHostAsync);
   } else if (((srcMemory == nullptr) && (dstMemory != nullptr)) ||
              ((srcMemory != nullptr) && (dstMemory == nullptr))) {
-    // Don't wait for unpinned H2D copy if staging is used for copy. If dstMemory is not null, it
-    // can still be a pinned host memory, hence the check on dst memory type.
+    // The staging path waits for the GPU on the large copies, hence the app thread copies the
+    // pageable source into a pinned snapshot and the GPU copy runs from it in the stream order
+    if (isHostAsync && (srcMemory == nullptr) && (dstMemoryType == hipMemoryTypeDevice) &&
+        (sizeBytes > stream.device().settings().stagedXferSize_) &&
+        (HIP_ASYNC_STAGING_POOL_SIZE != 0)) {
+      bounce = ihipSnapshotHostSource(src, sizeBytes, stream.GetDevice());
+    }
+    // Don't wait for unpinned H2D copy if staging or a bounce buffer is used for copy. If
+    // dstMemory is not null, it can still be a pinned host memory, hence the check on dst type.
     isHostAsync &=
         ((srcMemory == nullptr) && (dstMemory != nullptr && dstMemoryType == hipMemoryTypeDevice) &&
-         AMD_DIRECT_DISPATCH && (sizeBytes <= stream.device().settings().stagedXferSize_))
+         AMD_DIRECT_DISPATCH && (sizeBytes <= stream.device().settings().stagedXferSize_)) ||
+        (bounce != nullptr)
         ? true
         : false;
   } else if (srcMemory->GetDeviceById() == dstMemory->GetDeviceById()) {
@@ -664,11 +1018,21 @@ hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKin
   }
 
   amd::Command* command = nullptr;
-  status = ihipMemcpyCommand(command, dst, src, sizeBytes, kind, stream, isHostAsync);
+  status = (bounce != nullptr)
+      ? ihipMemcpyCommand(command, dstInfo, PtrInfo(bounce), dst, bounce, sizeBytes, kind, stream,
+                          isHostAsync)
+      : ihipMemcpyCommand(command, dstInfo, srcInfo, dst, src, sizeBytes, kind, stream,
+                          isHostAsync);
   if (status != hipSuccess) {
+    if (bounce != nullptr) {
+      stream.GetDevice()->ReleaseBounceBuffer(bounce, nullptr);
+    }
     return status;
   }
   command->enqueue();
+  if (bounce != nullptr) {
+    stream.GetDevice()->ReleaseBounceBuffer(bounce, command);
+  }
   if (!isHostAsync) {
     command->queue()->finish();
   } else if (!isGPUAsync) {
@@ -1319,40 +1683,67 @@ hipError_t hipHostGetFlags(unsigned int* flagsPtr, void* hostPtr) {
   HIP_RETURN(hipSuccess);
 }
 
-hipError_t ihipHostRegister(void* hostPtr, size_t sizeBytes, unsigned int flags) {
+// ================================================================================================
+static hipError_t ihipHostRegisterOnDevice(void* hostPtr, size_t sizeBytes, unsigned int flags,
+                                           int deviceId) {
   if (hostPtr == nullptr || sizeBytes == 0 || flags > 15) {
     return hipErrorInvalidValue;
-  } else {
-    amd::Memory* mem = new (*hip::host_context) amd::Buffer(*hip::host_context,
-                            CL_MEM_USE_HOST_PTR | CL_MEM_SVM_ATOMICS, sizeBytes);
-
-    constexpr bool sysMemAlloc = false;
-    constexpr bool skipAlloc = false;
-    constexpr bool forceAlloc = true;
-    if (!mem->create(hostPtr, sysMemAlloc, skipAlloc, forceAlloc)) {
-      mem->release();
-      LogPrintfError("Cannot create memory for size: %u with flags: %d", sizeBytes, flags);
-      return hipErrorInvalidValue;
-    }
-
-    amd::MemObjMap::AddMemObj(hostPtr, mem);
-    for (const auto& device : g_devices) {
-      // Since the amd::Memory object is shared between all devices
-      // it's fine to have multiple addresses mapped to it
-      const device::Memory* devMem = mem->getDeviceMemory(*device->devices()[0]);
-      void* vAddr = reinterpret_cast<void*>(devMem->virtualAddress());
-      if ((hostPtr != vAddr) && (amd::MemObjMap::FindMemObj(vAddr) == nullptr)) {
-        amd::MemObjMap::AddMemObj(vAddr, mem);
+  }
+  amd::ScopedLock lock(hostRegisterLock);
+  size_t offset = 0;
+  amd::Memory* region = amd::MemObjMap::FindMemObj(hostPtr, &offset);
+  auto it = (region != nullptr) ? hostRegions.find(region) : hostRegions.end();
+  if ((it != hostRegions.end()) && ((offset + sizeBytes) <= region->getSize())) {
+    // The range is pinned already, hence the registration only takes a reference on it
+    if (offset == 0) {
+      if (it->second.own_) {
+        return hipErrorHostMemoryAlreadyRegistered;
       }
+      it->second.own_ = true;
+    } else if (!hostNestedRegs.insert({hostPtr, region}).second) {
+      return hipErrorHostMemoryAlreadyRegistered;
+    } else {
+      it->second.nested_++;
     }
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Host register %p inside the registered range %p",
+            hostPtr, region->getHostMem());
+    return hipSuccess;
+  }
+
+  amd::Memory* mem = new (*hip::host_context) amd::Buffer(*hip::host_context,
+                          CL_MEM_USE_HOST_PTR | CL_MEM_SVM_ATOMICS, sizeBytes);
 
-    if (mem != nullptr) {
-      mem->getUserData().deviceId = hip::getCurrentDevice()->deviceId();
-      // Save the HIP memory flags so that they can be accessed later
-      mem->getUserData().flags = flags;
+  constexpr bool sysMemAlloc = false;
+  constexpr bool skipAlloc = false;
+  constexpr bool forceAlloc = true;
+  if (!mem->create(hostPtr, sysMemAlloc, skipAlloc, forceAlloc)) {
+    mem->release();
+    LogPrintfError("Cannot create memory for size: %u with flags: %d", sizeBytes, flags);
+    return hipErrorInvalidValue;
+  }
+
+  amd::MemObjMap::AddMemObj(hostPtr, mem);
+  for (const auto& device : g_devices) {
+    // Since the amd::Memory object is shared between all devices
+    // it's fine to have multiple addresses mapped to it
+    const device::Memory* devMem = mem->getDeviceMemory(*device->devices()[0]);
+    void* vAddr = reinterpret_cast<void*>(devMem->virtualAddress());
+    if ((hostPtr != vAddr) && (amd::MemObjMap::FindMemObj(vAddr) == nullptr)) {
+      amd::MemObjMap::AddMemObj(vAddr, mem);
     }
-    return hipSuccess;
   }
+
+  mem->getUserData().deviceId = deviceId;
+  // Save the HIP memory flags so that they can be accessed later
+  mem->getUserData().flags = flags;
+  hostRegions[mem] = HostRegion();
+  return hipSuccess;
+}
+
+// ================================================================================================
+hipError_t ihipHostRegister(void* hostPtr, size_t sizeBytes, unsigned int flags) {
+  return ihipHostRegisterOnDevice(hostPtr, sizeBytes, flags,
+                                  hip::getCurrentDevice()->deviceId());
 }
 
 hipError_t hipHostRegister(void* hostPtr, size_t sizeBytes, unsigned int flags) {
@@ -1361,23 +1752,103 @@ hipError_t hipHostRegister(void* hostPtr, size_t sizeBytes, unsigned int flags)
   HIP_RETURN(ihipHostRegister(hostPtr, sizeBytes,flags));
 }
 
+// ================================================================================================
+// The registration of hipExtHostRegisterAsync, which runs on the stream callback thread
+struct HostRegisterArgs {
+  void* hostPtr_;
+  size_t sizeBytes_;
+  unsigned int flags_;
+  int deviceId_;  //!< The current device of the caller
+};
+
+static void ihipHostRegisterCallback(void* userData) {
+  HostRegisterArgs* args = reinterpret_cast<HostRegisterArgs*>(userData);
+  hipError_t status = ihipHostRegisterOnDevice(args->hostPtr_, args->sizeBytes_, args->flags_,
+                                               args->deviceId_);
+  if (status != hipSuccess) {
+    // The range stays pageable, so the later copies from it still work over the staging path
+    LogPrintfError("Async host register of %p, size: %zu failed with the error: %d",
+                   args->hostPtr_, args->sizeBytes_, status);
+  }
+  delete args;
+}
+
+// ================================================================================================
+hipError_t hipExtHostRegisterAsync(void* hostPtr, size_t sizeBytes, unsigned int flags,
+                                   hipStream_t stream) {
+  HIP_INIT_API(hipExtHostRegisterAsync, hostPtr, sizeBytes, flags, stream);
+  if (hostPtr == nullptr || sizeBytes == 0 || flags > 15) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  hip::getStreamPerThread(stream);
+  // A graph node would register the range again on every launch
+  if (stream != nullptr && stream != hipStreamLegacy &&
+      reinterpret_cast<hip::Stream*>(stream)->GetCaptureStatus() !=
+          hipStreamCaptureStatusNone) {
+    HIP_RETURN(hipErrorStreamCaptureUnsupported);
+  }
+  if (!hip::isValid(stream)) {
+    HIP_RETURN(hipErrorContextIsDestroyed);
+  }
+  HostRegisterArgs* args =
+      new HostRegisterArgs{hostPtr, sizeBytes, flags, hip::getCurrentDevice()->deviceId()};
+  hipError_t status = hipLaunchHostFunc_common(stream, ihipHostRegisterCallback, args);
+  if (status != hipSuccess) {
+    delete args;
+  }
+  HIP_RETURN(status);
+}
+
+// ================================================================================================
 hipError_t ihipHostUnregister(void* hostPtr) {
   if (hostPtr == nullptr) {
     return hipErrorInvalidValue;
   }
   size_t offset = 0;
-  amd::Memory* mem = getMemoryObject(hostPtr, offset);
+  amd::Memory* mem = nullptr;
+  // The map key of a registered range is its start, the other memory keeps the legacy key
+  void* basePtr = hostPtr;
+  {
+    amd::ScopedLock lock(hostRegisterLock);
+    auto nested = hostNestedRegs.find(hostPtr);
+    if (nested != hostNestedRegs.end()) {
+      mem = nested->second;
+      hostNestedRegs.erase(nested);
+      HostRegion& region = hostRegions[mem];
+      if ((--region.nested_ != 0) || region.own_) {
+        return hipSuccess;
+      }
+    } else {
+      mem = getMemoryObject(hostPtr, offset);
+      auto it = (mem != nullptr) ? hostRegions.find(mem) : hostRegions.end();
+      if (it != hostRegions.end()) {
+        if (!it->second.own_) {
+          LogPrintfError("Cannot unregister host_ptr: 0x%x", hostPtr);
+          return hipErrorHostMemoryNotRegistered;
+        }
+        // The nested registrations keep the pin of the range
+        it->second.own_ = false;
+        if (it->second.nested_ != 0) {
+          return hipSuccess;
+        }
+      }
+    }
+    if ((mem != nullptr) && (hostRegions.erase(mem) != 0)) {
+      basePtr = mem->getHostMem();
+    }
+  }
 
   if (mem != nullptr) {
-    // Wait on the device, associated with the current memory object during allocation
+    // Wait on the device, associated with the current memory object during allocation. The wait
+    // runs without the registration lock, since the streams may run a pending async registration
     g_devices[mem->getUserData().deviceId]->SyncAllStreams();
 
-    amd::MemObjMap::RemoveMemObj(hostPtr);
+    amd::MemObjMap::RemoveMemObj(basePtr);
     for (const auto& device: g_devices) {
       const device::Memory* devMem = mem->getDeviceMemory(*device->devices()[0]);
       if (devMem != nullptr) {
         void* vAddr = reinterpret_cast<void*>(devMem->virtualAddress());
-        if ((vAddr != hostPtr) && amd::MemObjMap::FindMemObj(vAddr)) {
+        if ((vAddr != basePtr) && amd::MemObjMap::FindMemObj(vAddr)) {
           amd::MemObjMap::RemoveMemObj(vAddr);
         }
       }
@@ -1446,6 +1917,44 @@ inline hipError_t ihipMemcpySymbol_validate(const void* symbol, size_t sizeBytes
   return hipSuccess;
 }
 
+// ================================================================================================
+// The small constant updates of the symbols write the value with one stream write packet, which
+// skips the staging copy. Returns false if the copy has to take the memcpy path
+static bool ihipMemcpyToSymbolInline(hipDeviceptr_t device_ptr, const void* src,
+                                     size_t sizeBytes, hipMemcpyKind kind, hip::Stream& stream,
+                                     bool isAsync, hipError_t& status) {
+  if ((kind != hipMemcpyHostToDevice) || (src == nullptr) ||
+      ((sizeBytes != sizeof(uint32_t)) && (sizeBytes != sizeof(uint64_t))) ||
+      !amd::isMultipleOf(device_ptr, sizeBytes) || (getMemoryObject(src) != nullptr)) {
+    return false;
+  }
+  size_t offset = 0;
+  amd::Memory* memory = getMemoryObject(device_ptr, offset);
+  if ((memory == nullptr) || (memory->GetDeviceById() != &stream.device())) {
+    return false;
+  }
+  // The value is taken now, so the pageable source can be reused right after the call
+  uint64_t value = 0;
+  memcpy(&value, src, sizeBytes);
+
+  amd::Command::EventWaitList waitList;
+  amd::StreamOperationCommand* command =
+      new amd::StreamOperationCommand(stream, ROCCLR_COMMAND_STREAM_WRITE_VALUE, waitList,
+                                      *memory->asBuffer(), value, 0, 0, offset, sizeBytes);
+  if (command == nullptr) {
+    status = hipErrorOutOfMemory;
+    return true;
+  }
+  command->enqueue();
+  // The small staged H2D copies return without the wait under the direct dispatch only
+  if (!isAsync && !AMD_DIRECT_DISPATCH) {
+    command->awaitCompletion();
+  }
+  command->release();
+  status = hipSuccess;
+  return true;
+}
+
 hipError_t hipMemcpyToSymbol_common(const void* symbol, const void* src, size_t sizeBytes,
                              size_t offset, hipMemcpyKind kind, hipStream_t stream=nullptr) {
   CHECK_STREAM_CAPTURING();
@@ -1463,6 +1972,13 @@ hipError_t hipMemcpyToSymbol_common(const void* symbol, const void* src, size_t
     return status;
   }
 
+  hip::Stream* hip_stream = (stream != nullptr && stream != hipStreamLegacy)
+      ? hip::getStream(stream) : hip::getNullStream();
+  if ((hip_stream != nullptr) &&
+      ihipMemcpyToSymbolInline(device_ptr, src, sizeBytes, kind, *hip_stream, false, status)) {
+    return status;
+  }
+
   /* Copy memory from source to destination address */
   return hipMemcpy_common(device_ptr, src, sizeBytes, kind, stream);
 }
@@ -1531,6 +2047,12 @@ hipError_t hipMemcpyToSymbolAsync_common(const void* symbol, const void* src, si
     return status;
   }
 
+  hip::Stream* hip_stream = hip::getStream(stream);
+  if ((hip_stream != nullptr) && hip::isValid(stream) &&
+      ihipMemcpyToSymbolInline(device_ptr, src, sizeBytes, kind, *hip_stream, true, status)) {
+    return status;
+  }
+
   return hipMemcpyAsync_common(device_ptr, src, sizeBytes, kind, stream);
 }
 
@@ -1623,6 +2145,121 @@ hipError_t hipMemcpyAsync(void* dst, const void* src, size_t sizeBytes,
   HIP_RETURN_DURATION(hipMemcpyAsync_common(dst, src, sizeBytes, kind, stream));
 }
 
+// ================================================================================================
+hipError_t ihipMemcpyBatchAsync(void* const* dsts, const void* const* srcs,
+                                const size_t* sizes, size_t count, hipStream_t stream) {
+  if ((count != 0) && ((dsts == nullptr) || (srcs == nullptr) || (sizes == nullptr))) {
+    return hipErrorInvalidValue;
+  }
+  hip::getStreamPerThread(stream);
+  if (stream != nullptr && stream != hipStreamLegacy &&
+      reinterpret_cast<hip::Stream*>(stream)->GetCaptureStatus() !=
+          hipStreamCaptureStatusNone) {
+    // The graph has no batch node, hence every copy is captured as a memcpy node
+    for (size_t i = 0; i < count; ++i) {
+      hipError_t status = hipMemcpyAsync_common(dsts[i], srcs[i], sizes[i], hipMemcpyDefault,
+                                                stream);
+      if (status != hipSuccess) {
+        return status;
+      }
+    }
+    return hipSuccess;
+  }
+  if (!hip::isValid(stream)) {
+    return hipErrorContextIsDestroyed;
+  }
+  hip::Stream* hip_stream = hip::getStream(stream);
+  if (hip_stream == nullptr) {
+    return hipErrorInvalidValue;
+  }
+
+  // Validate the whole batch first, so an invalid entry doesn't leave a part of it queued
+  std::vector<std::pair<PtrInfo, PtrInfo>> infos;
+  infos.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    infos.emplace_back(PtrInfo(dsts[i]), PtrInfo(srcs[i]));
+    if (sizes[i] == 0) {
+      continue;
+    }
+    hipError_t status = ihipMemcpy_validate(infos[i].first, infos[i].second, dsts[i], srcs[i],
+                                            sizes[i], hipMemcpyDefault);
+    if (status != hipSuccess) {
+      return status;
+    }
+  }
+
+  // The device copies on the stream device share one command. The other copies need staging,
+  // P2P or a host wait and take the regular path in the batch order
+  amd::Device* queueDevice = &hip_stream->device();
+  amd::CopyMemoryBatchCommand::CopyList copies;
+  amd::Command::EventWaitList waitList;
+  // The small copies from pageable memory go with the inline writes, a command per full payload
+  amd::WriteMemoryInlineCommand* writes = nullptr;
+  std::vector<size_t> others;
+  for (size_t i = 0; i < count; ++i) {
+    const PtrInfo& dstInfo = infos[i].first;
+    const PtrInfo& srcInfo = infos[i].second;
+    if ((sizes[i] == 0) || (dsts[i] == srcs[i])) {
+      continue;
+    }
+    if ((ihipGetMemcpyType(srcInfo, dstInfo, hipMemcpyDefault) == hipCopyBuffer) &&
+        (srcInfo.memory_->GetDeviceById() == queueDevice) &&
+        (dstInfo.memory_->GetDeviceById() == queueDevice) &&
+        !srcInfo.memory_->getUserData().sync_mem_ops_ &&
+        !dstInfo.memory_->getUserData().sync_mem_ops_) {
+      copies.push_back({srcInfo.memory_, dstInfo.memory_, srcInfo.offset_, dstInfo.offset_,
+                        sizes[i]});
+    } else if ((srcInfo.memory_ == nullptr) &&
+               ihipUseInlineWrite(dstInfo, sizes[i], *hip_stream)) {
+      if ((writes != nullptr) &&
+          !writes->addWrite(*dstInfo.memory_, dstInfo.offset_, srcs[i], sizes[i])) {
+        writes->enqueue();
+        writes->release();
+        writes = nullptr;
+      }
+      if (writes == nullptr) {
+        writes = new amd::WriteMemoryInlineCommand(*hip_stream, waitList);
+        if (writes == nullptr) {
+          return hipErrorOutOfMemory;
+        }
+        writes->addWrite(*dstInfo.memory_, dstInfo.offset_, srcs[i], sizes[i]);
+      }
+    } else {
+      others.push_back(i);
+    }
+  }
+
+  if (writes != nullptr) {
+    writes->enqueue();
+    writes->release();
+  }
+  if (!copies.empty()) {
+    amd::CopyMetadata copyMetadata(true, amd::CopyMetadata::CopyEnginePreference::NONE);
+    amd::Command* command =
+        new amd::CopyMemoryBatchCommand(*hip_stream, waitList, copies, copyMetadata);
+    if (command == nullptr) {
+      return hipErrorOutOfMemory;
+    }
+    command->enqueue();
+    command->release();
+  }
+  for (auto i : others) {
+    hipError_t status = ihipMemcpy(dsts[i], srcs[i], sizes[i], hipMemcpyDefault, *hip_stream,
+                                   true);
+    if (status != hipSuccess) {
+      return status;
+    }
+  }
+  return hipSuccess;
+}
+
+// ================================================================================================
+hipError_t hipExtMemcpyBatchAsync(void* const* dsts, const void* const* srcs,
+                                  const size_t* sizes, size_t count, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemcpyBatchAsync, dsts, srcs, sizes, count, stream);
+  HIP_RETURN_DURATION(ihipMemcpyBatchAsync(dsts, srcs, sizes, count, stream));
+}
+
 hipError_t hipMemcpyAsync_spt(void* dst, const void* src, size_t sizeBytes,
                           hipMemcpyKind kind, hipStream_t stream) {
   HIP_INIT_API(hipMemcpyAsync, dst, src, sizeBytes, kind, stream);
@@ -2451,12 +3088,10 @@ void ihipCopyMemParamSet(const HIP_MEMCPY3D* pCopy, hipMemoryType& srcMemType,
   dstMemType = dstMemoryType;
 }
 
-hipError_t ihipGetMemcpyParam3DCommand(amd::Command*& command, const HIP_MEMCPY3D* pCopy,
-                                       hip::Stream* stream) {
-  hipMemoryType srcMemoryType;
-  hipMemoryType dstMemoryType;
-  ihipCopyMemParamSet(pCopy, srcMemoryType, dstMemoryType);
-
+//! Creates the command of the copy, which ihipCopyMemParamSet already classified
+static hipError_t ihipGetMemcpyParam3DCommand(amd::Command*& command, const HIP_MEMCPY3D* pCopy,
+                                              hip::Stream* stream, hipMemoryType srcMemoryType,
+                                              hipMemoryType dstMemoryType) {
   amd::Coord3D srcOrigin = {pCopy->srcXInBytes, pCopy->srcY, pCopy->srcZ};
   amd::Coord3D dstOrigin = {pCopy->dstXInBytes, pCopy->dstY, pCopy->dstZ};
   amd::Coord3D copyRegion = {pCopy->WidthInBytes, pCopy->Height, pCopy->Depth};
@@ -2507,6 +3142,15 @@ hipError_t ihipGetMemcpyParam3DCommand(amd::Command*& command, const HIP_MEMCPY3
   return hipSuccess;
 }
 
+// ================================================================================================
+hipError_t ihipGetMemcpyParam3DCommand(amd::Command*& command, const HIP_MEMCPY3D* pCopy,
+                                       hip::Stream* stream) {
+  hipMemoryType srcMemoryType;
+  hipMemoryType dstMemoryType;
+  ihipCopyMemParamSet(pCopy, srcMemoryType, dstMemoryType);
+  return ihipGetMemcpyParam3DCommand(command, pCopy, stream, srcMemoryType, dstMemoryType);
+}
+
 inline hipError_t ihipMemcpyCmdEnqueue(amd::Command* command, bool isAsync = false) {
   hipError_t status = hipSuccess;
   if (command == nullptr) {
@@ -2553,7 +3197,9 @@ hipError_t ihipMemcpyParam3D(const HIP_MEMCPY3D* pCopy, hipStream_t stream, bool
     if (hip_stream == nullptr) {
       return hipErrorInvalidValue;
     }
-    status = ihipGetMemcpyParam3DCommand(command, pCopy, hip_stream);
+    // The copy is classified above, the command skips the pointer lookups
+    status = ihipGetMemcpyParam3DCommand(command, pCopy, hip_stream, srcMemoryType,
+                                         dstMemoryType);
     if (status != hipSuccess) return status;
 
     // Transfers from device memory to pageable host memory and transfers from any
@@ -3006,16 +3652,17 @@ hipError_t ihipMemcpy3D_validate(const hipMemcpy3DParms* p) {
     return hipErrorInvalidValue;
   }
 
+  // get memory obj of the PitchPtr
+  const PtrInfo srcInfo(p->srcPtr.ptr);
+  const PtrInfo dstInfo(p->dstPtr.ptr);
   if (p->dstArray == nullptr && p->srcArray == nullptr) {
     if ((p->extent.width + p->dstPos.x > p->dstPtr.pitch) ||
         (p->extent.width + p->srcPos.x > p->srcPtr.pitch)) {
       return hipErrorInvalidValue;
     }
     auto totalExtentBytes = p->extent.width * p->extent.height * p->extent.depth;
-    // get memory obj of the PitchPtr
-    size_t offset = 0;
-    amd::Memory* srcPtrMemObj = getMemoryObject(p->srcPtr.ptr, offset);
-    amd::Memory* dstPtrMemObj = getMemoryObject(p->dstPtr.ptr, offset);
+    amd::Memory* srcPtrMemObj = srcInfo.memory_;
+    amd::Memory* dstPtrMemObj = dstInfo.memory_;
 
     if (dstPtrMemObj != nullptr && (p->dstPtr.xsize != 0 && p->dstPtr.ysize != 0)) {
       // Use the memoryObj to get 3d data
@@ -3055,7 +3702,7 @@ hipError_t ihipMemcpy3D_validate(const hipMemcpy3DParms* p) {
     return hipErrorInvalidMemcpyDirection;
   }
   //If src and dst ptr are null then kind must be either h2h or def.
-  if (!IsHtoHMemcpyValid(p->dstPtr.ptr, p->srcPtr.ptr, p->kind)) {
+  if (!IsHtoHMemcpyValid(dstInfo, srcInfo, p->dstPtr.ptr, p->srcPtr.ptr, p->kind)) {
     return hipErrorInvalidValue;
   }
   return hipSuccess;
@@ -3247,9 +3894,9 @@ hipError_t hipDrvMemcpy3DAsync(const HIP_MEMCPY3D* pCopy, hipStream_t stream) {
   HIP_RETURN_DURATION(ihipMemcpyParam3D(pCopy, stream, true));
 }
 
-hipError_t packFillMemoryCommand(amd::Command*& command, amd::Memory* memory, size_t offset,
-                                 int64_t value, size_t valueSize, size_t sizeBytes,
-                                 hip::Stream* stream) {
+static hipError_t packFillMemoryCommand(amd::Command*& command, amd::Memory* memory,
+                                        size_t offset, const void* pattern, size_t patternSize,
+                                        size_t sizeBytes, hip::Stream* stream) {
   if ((memory == nullptr) || (stream == nullptr)) {
     return hipErrorInvalidValue;
   }
@@ -3261,7 +3908,7 @@ hipError_t packFillMemoryCommand(amd::Command*& command, amd::Memory* memory, si
   amd::Coord3D surface(sizeBytes, sizeBytes, 1);
   amd::FillMemoryCommand* fillMemCommand =
       new amd::FillMemoryCommand(*stream, CL_COMMAND_FILL_BUFFER, waitList, *memory->asBuffer(),
-                                 &value, valueSize, fillOffset, fillSize, surface);
+                                 pattern, patternSize, fillOffset, fillSize, surface);
   if (fillMemCommand == nullptr) {
     return hipErrorOutOfMemory;
   }
@@ -3274,8 +3921,14 @@ hipError_t packFillMemoryCommand(amd::Command*& command, amd::Memory* memory, si
   return hipSuccess;
 }
 
-hipError_t ihipMemset_validate(void* dst, int64_t value, size_t valueSize,
-                                      size_t sizeBytes) {
+// ================================================================================================
+hipError_t packFillMemoryCommand(amd::Command*& command, amd::Memory* memory, size_t offset,
+                                 int64_t value, size_t valueSize, size_t sizeBytes,
+                                 hip::Stream* stream) {
+  return packFillMemoryCommand(command, memory, offset, &value, valueSize, sizeBytes, stream);
+}
+
+static hipError_t ihipMemset_validate(const PtrInfo& dstInfo, void* dst, size_t sizeBytes) {
   if (sizeBytes == 0) {
     // Skip if nothing needs filling.
     return hipSuccess;
@@ -3285,8 +3938,8 @@ hipError_t ihipMemset_validate(void* dst, int64_t value, size_t valueSize,
     return hipErrorInvalidValue;
   }
 
-  size_t offset = 0;
-  amd::Memory* memory = getMemoryObject(dst, offset);
+  const size_t offset = dstInfo.offset_;
+  amd::Memory* memory = dstInfo.memory_;
   if (memory == nullptr) {
     // dst ptr is host ptr hence error
     return hipErrorInvalidValue;
@@ -3309,6 +3962,15 @@ hipError_t ihipMemset_validate(void* dst, int64_t value, size_t valueSize,
   return hipSuccess;
 }
 
+// ================================================================================================
+hipError_t ihipMemset_validate(void* dst, int64_t value, size_t valueSize,
+                                      size_t sizeBytes) {
+  if ((sizeBytes == 0) || (dst == nullptr)) {
+    return (sizeBytes == 0) ? hipSuccess : hipErrorInvalidValue;
+  }
+  return ihipMemset_validate(PtrInfo(dst), dst, sizeBytes);
+}
+
 hipError_t ihipGraphMemsetParams_validate(const hipMemsetParams* pNodeParams) {
   if (pNodeParams == nullptr) {
     return hipErrorInvalidValue;
@@ -3342,23 +4004,23 @@ hipError_t ihipGraphMemsetParams_validate(const hipMemsetParams* pNodeParams) {
   return hipSuccess;
 }
 
-hipError_t ihipMemsetCommand(std::vector<amd::Command*>& commands, void* dst, int64_t value,
-                             size_t valueSize, size_t sizeBytes, hip::Stream* stream) {
-  hipError_t hip_error = hipSuccess;
-  auto aligned_dst = amd::alignUp(reinterpret_cast<address>(dst), sizeof(uint64_t));
-  size_t offset = 0;
-  amd::Memory* memory = getMemoryObject(dst, offset);
-  size_t n_head_bytes = 0;
-  size_t n_tail_bytes = 0;
+static hipError_t ihipMemsetCommand(std::vector<amd::Command*>& commands,
+                                    const PtrInfo& dstInfo, int64_t value, size_t valueSize,
+                                    size_t sizeBytes, hip::Stream* stream) {
   amd::Command* command;
-
-  hip_error = packFillMemoryCommand(command, memory, offset, value, valueSize, sizeBytes,
-                                    stream);
+  hipError_t hip_error = packFillMemoryCommand(command, dstInfo.memory_, dstInfo.offset_, value,
+                                               valueSize, sizeBytes, stream);
   commands.push_back(command);
 
   return hip_error;
 }
 
+// ================================================================================================
+hipError_t ihipMemsetCommand(std::vector<amd::Command*>& commands, void* dst, int64_t value,
+                             size_t valueSize, size_t sizeBytes, hip::Stream* stream) {
+  return ihipMemsetCommand(commands, PtrInfo(dst), value, valueSize, sizeBytes, stream);
+}
+
 hipError_t ihipMemset(void* dst, int64_t value, size_t valueSize, size_t sizeBytes,
                       hipStream_t stream, bool isAsync = false) {
   hipError_t hip_error = hipSuccess;
@@ -3368,8 +4030,10 @@ hipError_t ihipMemset(void* dst, int64_t value, size_t valueSize, size_t sizeByt
       break;
     }
 
+    // The validation, the sync decision and the command share one lookup of the pointer
+    const PtrInfo dstInfo(dst);
     // In case of validation failure stop processing. Returns hip_error.
-    hip_error = ihipMemset_validate(dst, value, valueSize, sizeBytes);
+    hip_error = ihipMemset_validate(dstInfo, dst, sizeBytes);
     if (hip_error != hipSuccess) {
       break;
     }
@@ -3377,8 +4041,8 @@ hipError_t ihipMemset(void* dst, int64_t value, size_t valueSize, size_t sizeByt
     // spec says hipMemset will be asynchronous when destination memory is device memory
     // and pointer is non-offseted
     if (isAsync == false) {
-      size_t offset = 0;
-      amd::Memory* memObj = getMemoryObject(dst, offset);
+      const size_t offset = dstInfo.offset_;
+      amd::Memory* memObj = dstInfo.memory_;
       auto flags = memObj->getMemFlags();
       if ((memObj->getUserData().sync_mem_ops_)
            || (offset == 0 && !(flags & (CL_MEM_SVM_FINE_GRAIN_BUFFER
@@ -3389,7 +4053,7 @@ hipError_t ihipMemset(void* dst, int64_t value, size_t valueSize, size_t sizeByt
     std::vector<amd::Command*> commands;
     hip::Stream* hip_stream = hip::getStream(stream);
     if (hip_stream == nullptr) { return hipErrorOutOfMemory; }
-    hip_error = ihipMemsetCommand(commands, dst, value, valueSize, sizeBytes, hip_stream);
+    hip_error = ihipMemsetCommand(commands, dstInfo, value, valueSize, sizeBytes, hip_stream);
     if (hip_error != hipSuccess) {
       break;
     }
@@ -3485,6 +4149,61 @@ hipError_t hipMemsetD32Async(hipDeviceptr_t dst, int value, size_t count,
   HIP_RETURN(ihipMemset(dst, value, valueSize, sizeBytes, stream, true));
 }
 
+// ================================================================================================
+static hipError_t ihipMemsetPattern(void* dst, const void* pattern, size_t patternSize,
+                                    size_t count, hipStream_t stream) {
+  if ((pattern == nullptr) || (patternSize == 0) || !amd::isPowerOfTwo(patternSize) ||
+      (patternSize > 2 * sizeof(uint64_t)) ||
+      (count > (std::numeric_limits<size_t>::max() / patternSize))) {
+    return hipErrorInvalidValue;
+  }
+  const size_t sizeBytes = count * patternSize;
+  hip::getStreamPerThread(stream);
+  if (patternSize <= sizeof(int32_t)) {
+    int32_t iValue = 0;
+    memcpy(&iValue, pattern, patternSize);
+    size_t valueSize = patternSize;
+    STREAM_CAPTURE(hipMemsetAsync, stream, dst, iValue, valueSize, sizeBytes);
+  } else if (stream != nullptr && stream != hipStreamLegacy &&
+             reinterpret_cast<hip::Stream*>(stream)->GetCaptureStatus() !=
+                 hipStreamCaptureStatusNone) {
+    // The graph memset nodes keep the values of 4 bytes at most
+    return hipErrorStreamCaptureUnsupported;
+  }
+  if (sizeBytes == 0) {
+    return hipSuccess;
+  }
+
+  const PtrInfo dstInfo(dst);
+  hipError_t status = ihipMemset_validate(dstInfo, dst, sizeBytes);
+  if (status != hipSuccess) {
+    return status;
+  }
+  if (!hip::isValid(stream)) {
+    return hipErrorContextIsDestroyed;
+  }
+  hip::Stream* hip_stream = hip::getStream(stream);
+  if (hip_stream == nullptr) {
+    return hipErrorInvalidValue;
+  }
+  amd::Command* command = nullptr;
+  status = packFillMemoryCommand(command, dstInfo.memory_, dstInfo.offset_, pattern, patternSize,
+                                 sizeBytes, hip_stream);
+  if (status != hipSuccess) {
+    return status;
+  }
+  command->enqueue();
+  command->release();
+  return hipSuccess;
+}
+
+// ================================================================================================
+hipError_t hipExtMemsetPatternAsync(void* dst, const void* pattern, size_t patternSize,
+                                    size_t count, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemsetPatternAsync, dst, pattern, patternSize, count, stream);
+  HIP_RETURN(ihipMemsetPattern(dst, pattern, patternSize, count, stream));
+}
+
 hipError_t ihipMemset3D_validate(hipPitchedPtr pitchedDevPtr, int value, hipExtent extent,
                                         size_t sizeBytes) {
   size_t offset = 0;
@@ -3505,13 +4224,15 @@ hipError_t ihipMemset3D_validate(hipPitchedPtr pitchedDevPtr, int value, hipExte
   return hipSuccess;
 }
 
-hipError_t ihipMemset3DCommand(std::vector<amd::Command*> &commands, hipPitchedPtr pitchedDevPtr,
-                               int value, hipExtent extent, hip::Stream* stream, size_t elementSize = 1) {
-  size_t offset = 0;
+static hipError_t ihipMemset3DCommand(std::vector<amd::Command*>& commands,
+                                      const PtrInfo& dstInfo, hipPitchedPtr pitchedDevPtr,
+                                      int value, hipExtent extent, hip::Stream* stream,
+                                      size_t elementSize) {
+  const size_t offset = dstInfo.offset_;
   auto sizeBytes = extent.width * extent.height * extent.depth;
-  amd::Memory* memory = getMemoryObject(pitchedDevPtr.ptr, offset);
+  amd::Memory* memory = dstInfo.memory_;
   if (pitchedDevPtr.pitch == extent.width) {
-    return ihipMemsetCommand(commands, pitchedDevPtr.ptr, value, elementSize,
+    return ihipMemsetCommand(commands, dstInfo, value, elementSize,
                                   static_cast<size_t>(sizeBytes), stream);
   }
   // Workaround for cases when pitch > row until fill kernel will be updated to support pitch.
@@ -3534,6 +4255,13 @@ hipError_t ihipMemset3DCommand(std::vector<amd::Command*> &commands, hipPitchedP
   return hipSuccess;
 }
 
+// ================================================================================================
+hipError_t ihipMemset3DCommand(std::vector<amd::Command*> &commands, hipPitchedPtr pitchedDevPtr,
+                               int value, hipExtent extent, hip::Stream* stream, size_t elementSize = 1) {
+  return ihipMemset3DCommand(commands, PtrInfo(pitchedDevPtr.ptr), pitchedDevPtr, value, extent,
+                             stream, elementSize);
+}
+
 
 hipError_t ihipMemset3D(hipPitchedPtr pitchedDevPtr, int value, hipExtent extent,
                         hipStream_t stream, bool isAsync = false) {
@@ -3550,9 +4278,11 @@ hipError_t ihipMemset3D(hipPitchedPtr pitchedDevPtr, int value, hipExtent extent
   // This is required to comply with the spec
   // spec says hipMemset will be asynchronous when destination memory is device memory
   // and pointer is non-offseted
+  // The sync decision and the command share one lookup of the pointer
+  const PtrInfo dstInfo(pitchedDevPtr.ptr);
   if (isAsync == false) {
-    size_t offset = 0;
-    amd::Memory* memObj = getMemoryObject(pitchedDevPtr.ptr, offset);
+    const size_t offset = dstInfo.offset_;
+    amd::Memory* memObj = dstInfo.memory_;
     auto flags = memObj->getMemFlags();
     if (offset == 0 &&
       !(flags & (CL_MEM_USE_HOST_PTR | CL_MEM_SVM_ATOMICS | CL_MEM_SVM_FINE_GRAIN_BUFFER))) {
@@ -3561,7 +4291,7 @@ hipError_t ihipMemset3D(hipPitchedPtr pitchedDevPtr, int value, hipExtent extent
   }
   hip::Stream* hip_stream = hip::getStream(stream);
   std::vector<amd::Command*> commands;
-  status = ihipMemset3DCommand(commands, pitchedDevPtr, value, extent, hip_stream);
+  status = ihipMemset3DCommand(commands, dstInfo, pitchedDevPtr, value, extent, hip_stream, 1);
   if (status != hipSuccess) {
     return status;
   }
@@ -3709,6 +4439,21 @@ hipError_t hipIpcOpenMemHandle(void** dev_ptr, hipIpcMemHandle_t handle, unsigne
     HIP_RETURN(hipErrorInvalidContext);
   }
 
+  // The key is the handle bytes with the offset and the size on the current device
+  int device_id = hip::getCurrentDevice()->deviceId();
+  std::string key(ihandle->ipc_handle, sizeof(ihandle->ipc_handle));
+  key.append(reinterpret_cast<const char*>(&ihandle->psize), sizeof(ihandle->psize));
+  key.append(reinterpret_cast<const char*>(&ihandle->poffset), sizeof(ihandle->poffset));
+  key.append(reinterpret_cast<const char*>(&device_id), sizeof(device_id));
+
+  amd::ScopedLock lock(ipcOpenLock);
+  auto it = ipcOpenCache.find(key);
+  if (it != ipcOpenCache.end()) {
+    it->second.open_count_++;
+    *dev_ptr = it->second.dev_ptr_;
+    HIP_RETURN(hipSuccess);
+  }
+
   if(!device->IpcAttach(&(ihandle->ipc_handle), ihandle->psize,
                         ihandle->poffset, flags, dev_ptr)) {
     LogPrintfError("Cannot attach ipc_handle: with ipc_size: %u"
@@ -3717,7 +4462,18 @@ hipError_t hipIpcOpenMemHandle(void** dev_ptr, hipIpcMemHandle_t handle, unsigne
   }
 
   amd_mem_obj = getMemoryObject(*dev_ptr, offset);
-  amd_mem_obj->getUserData().deviceId = hip::getCurrentDevice()->deviceId();
+  amd_mem_obj->getUserData().deviceId = device_id;
+
+  // Different handles can refer to the same memory, in which case IpcAttach retained the
+  // existing memory object. The entry of the pointer counts the open instead
+  auto ptr_key = ipcOpenKeys.find(*dev_ptr);
+  if (ptr_key != ipcOpenKeys.end()) {
+    ipcOpenCache[ptr_key->second].open_count_++;
+    amd_mem_obj->release();
+  } else {
+    ipcOpenCache[key] = {*dev_ptr, 1};
+    ipcOpenKeys[*dev_ptr] = key;
+  }
 
   HIP_RETURN(hipSuccess);
 }
@@ -3728,12 +4484,27 @@ hipError_t hipIpcCloseMemHandle(void* dev_ptr) {
   amd::Device* device = nullptr;
   amd::Memory* amd_mem_obj = nullptr;
 
-  hip::getNullStream()->finish();
-
   if (dev_ptr == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  // The memory stays attached until the last close, so the earlier closes don't have to wait
+  // for the device
+  {
+    amd::ScopedLock lock(ipcOpenLock);
+    auto key = ipcOpenKeys.find(dev_ptr);
+    if (key != ipcOpenKeys.end()) {
+      auto it = ipcOpenCache.find(key->second);
+      if (--it->second.open_count_ > 0) {
+        HIP_RETURN(hipSuccess);
+      }
+      ipcOpenCache.erase(it);
+      ipcOpenKeys.erase(key);
+    }
+  }
+
+  hip::getNullStream()->finish();
+
   amd_mem_obj = amd::MemObjMap::FindMemObj(dev_ptr);
   if (amd_mem_obj != nullptr) {
     auto device_id = amd_mem_obj->getUserData().deviceId;
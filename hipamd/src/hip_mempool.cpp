@@ -500,4 +500,19 @@ hipError_t hipMemPoolImportPointer(
   mpool->retain();
   HIP_RETURN(hipSuccess);
 }
+
+// ================================================================================================
+hipError_t hipExtMemPrintAllocReport(hipMemPool_t mem_pool) {
+  HIP_INIT_API(hipExtMemPrintAllocReport, mem_pool);
+  if (mem_pool != nullptr) {
+    reinterpret_cast<hip::MemoryPool*>(mem_pool)->PrintReport();
+    HIP_RETURN(hipSuccess);
+  }
+  // Report all pools and the allocation trace
+  for (auto device : g_devices) {
+    device->PrintPoolReport();
+  }
+  amd::AllocTrace::Report();
+  HIP_RETURN(hipSuccess);
+}
 }  // namespace hip
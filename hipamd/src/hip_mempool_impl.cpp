@@ -21,13 +21,117 @@
 #include "hip_mempool_impl.hpp"
 #include "hip_vm.hpp"
 #include "platform/command.hpp"
+#include "platform/trace_events.hpp"
 
 namespace hip {
 
+// ================================================================================================
+size_t SlabAllocator::SizeClass(size_t size) {
+  if (size <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+  // Four classes per power of two keep the internal fragmentation under 25%
+  size_t step = std::max(amd::nextPowerOfTwo(size) >> 3, kMinBlockSize);
+  return amd::alignUp(size, step);
+}
+
+// ================================================================================================
+amd::Memory* SlabAllocator::Allocate(size_t size_class) {
+  if (current_ == nullptr) {
+    return nullptr;
+  }
+  auto& slab = slabs_[current_];
+  if ((slab.offset_ + size_class) > slab_size_) {
+    return nullptr;
+  }
+  amd::Memory* block = new (current_->getContext())
+      amd::Buffer(*current_, current_->getMemFlags(), slab.offset_, size_class);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  if (!block->create(nullptr)) {
+    block->release();
+    return nullptr;
+  }
+  slab.offset_ += size_class;
+  slab.blocks_++;
+  idle_size_ -= size_class;
+
+  block->getUserData().deviceId = device_->deviceId();
+  amd::MemObjMap::AddMemObj(block->getSvmPtr(), block);
+  return block;
+}
+
+// ================================================================================================
+//! Updates P2P access to the memory object from the device
+static void SetPeerAccess(amd::Memory* memory, hip::Device* device, bool enable) {
+  auto peer_device = device->asContext()->devices()[0];
+  device::Memory* mem = memory->getDeviceMemory(*peer_device);
+  if (mem != nullptr) {
+    if (!mem->getAllowedPeerAccess() && enable) {
+      // Enable p2p access for the specified device
+      peer_device->allowPeerAccess(mem);
+      mem->setAllowedPeerAccess(true);
+    } else if (mem->getAllowedPeerAccess() && !enable) {
+      mem->setAllowedPeerAccess(false);
+    }
+  } else {
+    LogError("Couldn't find device memory for P2P access");
+  }
+}
+
+// ================================================================================================
+void SlabAllocator::SetAccess(hip::Device* device, bool enable) {
+  for (const auto& it : slabs_) {
+    SetPeerAccess(it.first, device, enable);
+  }
+}
+
+// ================================================================================================
+void SlabAllocator::AddSlab(amd::Memory* slab) {
+  // The carved blocks are tracked in MemObjMap instead of the slab
+  amd::MemObjMap::RemoveMemObj(slab->getSvmPtr());
+  slabs_[slab] = {0, 0};
+  idle_size_ += slab_size_;
+  current_ = slab;
+}
+
+// ================================================================================================
+bool SlabAllocator::IsBlock(amd::Memory* memory) const {
+  return (memory->parent() != nullptr) && (slabs_.find(memory->parent()) != slabs_.end());
+}
+
+// ================================================================================================
+void SlabAllocator::Free(amd::Memory* block) {
+  amd::Memory* slab = block->parent();
+  if (amd::MemObjMap::FindMemObj(block->getSvmPtr()) == block) {
+    amd::MemObjMap::RemoveMemObj(block->getSvmPtr());
+  }
+  // The block holds a reference on the slab, thus the slab is still alive after release
+  block->release();
+
+  auto it = slabs_.find(slab);
+  if (--it->second.blocks_ == 0) {
+    idle_size_ -= slab_size_ - it->second.offset_;
+    if (current_ == slab) {
+      current_ = nullptr;
+    }
+    slabs_.erase(it);
+    // Restore the slab in MemObjMap, so SVM free could find and destroy it
+    void* slab_ptr = slab->getSvmPtr();
+    amd::MemObjMap::AddMemObj(slab_ptr, slab);
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool FreeSlab: %p, %p", slab_ptr, slab);
+    amd::SvmBuffer::free(slab->getContext(), slab_ptr);
+  }
+}
+
 // ================================================================================================
 void Heap::AddMemory(amd::Memory* memory, Stream* stream) {
   auto mem_size = memory->getSize();
   allocations_.insert({{mem_size, memory}, {stream}});
+  if (stream != nullptr) {
+    safe_streams_[stream].insert({mem_size, memory});
+  }
   total_size_ += mem_size;
   max_total_size_ = std::max(max_total_size_, total_size_);
 }
@@ -36,14 +140,38 @@ void Heap::AddMemory(amd::Memory* memory, Stream* stream) {
 void Heap::AddMemory(amd::Memory* memory, const MemoryTimestamp& ts) {
   auto mem_size = memory->getSize();
   allocations_.insert({{mem_size, memory}, ts});
+  AddSafeStreams({mem_size, memory}, ts);
   total_size_ += mem_size;
   max_total_size_ = std::max(max_total_size_, total_size_);
 }
 
+// ================================================================================================
+amd::Memory* Heap::TakeMemory(SortedMap::iterator it, MemoryTimestamp* ts) {
+  amd::Memory* memory = it->first.second;
+  total_size_ -= memory->getSize();
+  // Preserve event, since the logic could skip GPU wait on reuse
+  ts->event_ = it->second.event_;
+  RemoveSafeStreams(it->first, it->second);
+  // Remove found allocation from the map
+  allocations_.erase(it);
+  return memory;
+}
+
 // ================================================================================================
 amd::Memory* Heap::FindMemory(size_t size, Stream* stream, bool opportunistic,
     void* dptr, MemoryTimestamp* ts) {
   amd::Memory* memory = nullptr;
+  if ((stream != nullptr) && (dptr == nullptr)) {
+    // The allocations, safe for the stream, don't require any HIP event checks,
+    // thus try the closest size on the same stream first
+    if (auto list = safe_streams_.find(stream); list != safe_streams_.end()) {
+      auto candidate = list->second.lower_bound({size, nullptr});
+      // Accept the same 12.5% on the size threshold as the opportunistic search below
+      if ((candidate != list->second.end()) && (candidate->first <= (size / 8.0) * 9)) {
+        return TakeMemory(allocations_.find(*candidate), ts);
+      }
+    }
+  }
   auto start = allocations_.lower_bound({size, nullptr});
   for (auto it = start; it != allocations_.end();) {
     bool check_address = (dptr == nullptr);
@@ -60,12 +188,7 @@ amd::Memory* Heap::FindMemory(size_t size, Stream* stream, bool opportunistic,
     }
     // Check if size can match and it's safe to use this resource.
     if (check_address && (it->second.IsSafeFind(stream, opp_mode))) {
-      memory = it->first.second;
-      total_size_ -= memory->getSize();
-      // Preserve event, since the logic could skip GPU wait on reuse
-      ts->event_ = it->second.event_;
-      // Remove found allocation from the map
-      it = allocations_.erase(it);
+      memory = TakeMemory(it, ts);
       break;
     } else {
       ++it;
@@ -85,6 +208,7 @@ bool Heap::RemoveMemory(amd::Memory* memory, MemoryTimestamp* ts) {
       it->second.SetEvent(nullptr);
     }
     total_size_ -= mem_size;
+    RemoveSafeStreams(it->first, it->second);
     allocations_.erase(it);
     return true;
   }
@@ -94,6 +218,15 @@ bool Heap::RemoveMemory(amd::Memory* memory, MemoryTimestamp* ts) {
 // ================================================================================================
 Heap::SortedMap::iterator Heap::EraseAllocaton(Heap::SortedMap::iterator& it) {
   auto memory = it->first.second;
+  RemoveSafeStreams(it->first, it->second);
+  if ((slabs_ != nullptr) && slabs_->IsBlock(memory)) {
+    total_size_ -= it->first.first;
+    it->second.SetEvent(nullptr);
+    auto next = allocations_.erase(it);
+    // Carved blocks go back to the slab allocator instead of ROCr
+    slabs_->Free(memory);
+    return next;
+  }
   const device::Memory* dev_mem = memory->getDeviceMemory(*device_->devices()[0]);
   void* dev_mem_vaddr = reinterpret_cast<void*>(dev_mem->virtualAddress());
   total_size_ -= it->first.first;
@@ -131,43 +264,47 @@ bool Heap::ReleaseAllMemory(size_t min_bytes_to_hold, bool safe_release) {
 
 // ================================================================================================
 bool Heap::ReleaseAllMemory() {
+  ReleaseOverThreshold(std::numeric_limits<size_t>::max());
+  return true;
+}
+
+// ================================================================================================
+size_t Heap::ReleaseOverThreshold(size_t max_bytes) {
+  size_t released = 0;
+  // The graph working sets stay in the heap, so the graph replays skip the physical allocations
+  const uint64_t min_size = std::max(release_threshold_, hold_size_);
   for (auto it = allocations_.begin(); it != allocations_.end();) {
     // Make sure the heap holds the minimum number of bytes
-    if (total_size_ <= release_threshold_) {
-      return true;
+    if ((total_size_ <= min_size) || (released >= max_bytes)) {
+      break;
     }
     if (it->second.IsSafeRelease()) {
+      released += it->first.first;
       it = EraseAllocaton(it);
     } else {
       ++it;
     }
   }
-  return true;
+  return released;
 }
 
 // ================================================================================================
 void Heap::RemoveStream(Stream* stream) {
-  for (auto it : allocations_) {
+  for (auto& it : allocations_) {
     it.second.safe_streams_.erase(stream);
   }
+  safe_streams_.erase(stream);
 }
 
 // ================================================================================================
 void Heap::SetAccess(hip::Device* device, bool enable) {
   for (const auto& it : allocations_) {
-    auto peer_device = device->asContext()->devices()[0];
-    device::Memory* mem = it.first.second->getDeviceMemory(*peer_device);
-    if (mem != nullptr) {
-      if (!mem->getAllowedPeerAccess() && enable) {
-        // Enable p2p access for the specified device
-        peer_device->allowPeerAccess(mem);
-        mem->setAllowedPeerAccess(true);
-      } else if (mem->getAllowedPeerAccess() && !enable) {
-        mem->setAllowedPeerAccess(false);
-      }
-    } else {
-      LogError("Couldn't find device memory for P2P access");
+    amd::Memory* memory = it.first.second;
+    if ((slabs_ != nullptr) && slabs_->IsBlock(memory)) {
+      // P2P access is controlled on the whole slab by the slab allocator
+      continue;
     }
+    SetPeerAccess(memory, device, enable);
   }
 }
 
@@ -177,7 +314,18 @@ void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
 
   void* dev_ptr = nullptr;
   MemoryTimestamp ts;
+  bool sub_alloc = state_.sub_alloc_ && (dptr == nullptr) && slabs_.IsSuballocation(size);
+  if (sub_alloc) {
+    // Round the size up, so the freed blocks of the same class are reused without any slack
+    size = SlabAllocator::SizeClass(size);
+  }
   amd::Memory* memory = free_heap_.FindMemory(size, stream, Opportunistic(), dptr, &ts);
+  if ((memory == nullptr) && sub_alloc) {
+    memory = slabs_.Allocate(size);
+    if (memory == nullptr) {
+      memory = AllocateSlabBlock(size);
+    }
+  }
   if (memory == nullptr) {
     if (Properties().maxSize != 0 && (max_total_size_ + size) > Properties().maxSize) {
       return nullptr;
@@ -187,9 +335,20 @@ void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
     if (dev_info.maxMemAllocSize_ < size) {
       return nullptr;
     }
-    cl_svm_mem_flags flags = (state_.interprocess_) ? ROCCLR_MEM_INTERPROCESS : 0;
+    cl_svm_mem_flags flags = ROCCLR_MEM_POOL_MEMORY;
+    flags |= (state_.interprocess_) ? ROCCLR_MEM_INTERPROCESS : 0;
     flags |= (state_.phys_mem_) ? ROCCLR_MEM_PHYMEM : 0;
     dev_ptr = amd::SvmBuffer::malloc(*context, flags, size, dev_info.memBaseAddrAlign_, nullptr);
+    if (HIP_MEM_POOL_COMPACT) {
+      // Release the retired free pieces first, then wait for the rest of them
+      for (bool wait : {false, true}) {
+        if ((dev_ptr != nullptr) || !Compact(size, wait)) {
+          break;
+        }
+        dev_ptr = amd::SvmBuffer::malloc(*context, flags, size, dev_info.memBaseAddrAlign_,
+                                         nullptr);
+      }
+    }
     if (dev_ptr == nullptr) {
       size_t free = 0, total =0;
       hipError_t err = hipMemGetInfo(&free, &total);
@@ -206,14 +365,7 @@ void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
     memory->getUserData().deviceId = device_->deviceId();
 
     // Update access for the new allocation from other devices
-    for (const auto& it : access_map_) {
-      auto vdi_device = it.first->asContext()->devices()[0];
-      device::Memory* mem = memory->getDeviceMemory(*vdi_device);
-      if ((mem != nullptr) && (it.second != hipMemAccessFlagsProtNone)) {
-        vdi_device->allowPeerAccess(mem);
-        mem->setAllowedPeerAccess(true);
-      }
-    }
+    UpdatePeerAccess(memory);
   } else {
     dev_ptr = memory->getSvmPtr();
     if (!amd::MemObjMap::FindMemObj(dev_ptr))
@@ -223,16 +375,79 @@ void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
   ts.AddSafeStream(stream);
   busy_heap_.AddMemory(memory, ts);
 
-  max_total_size_ = std::max(max_total_size_, busy_heap_.GetTotalSize() +
-                                                  free_heap_.GetTotalSize());
+  max_total_size_ = std::max(max_total_size_, ReservedSize());
   // Increment the reference counter on the pool
   retain();
 
   ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool AllocMem: %p, %p", memory->getSvmPtr(), memory);
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kAlloc, amd::AllocTrace::kPool, dev_ptr,
+                            memory->getSize(), this, stream);
+  }
 
   return dev_ptr;
 }
 
+// ================================================================================================
+amd::Memory* MemoryPool::AllocateSlabBlock(size_t size_class) {
+  if (Properties().maxSize != 0 &&
+      (max_total_size_ + slabs_.SlabSize()) > Properties().maxSize) {
+    return nullptr;
+  }
+  amd::Context* context = device_->asContext();
+  const auto& dev_info = context->devices()[0]->info();
+  void* slab_ptr = amd::SvmBuffer::malloc(*context, ROCCLR_MEM_POOL_MEMORY, slabs_.SlabSize(),
+                                          dev_info.memBaseAddrAlign_, nullptr);
+  if (slab_ptr == nullptr) {
+    // Fall back to a dedicated allocation
+    return nullptr;
+  }
+  size_t offset = 0;
+  amd::Memory* slab = getMemoryObject(slab_ptr, offset);
+  slab->getUserData().deviceId = device_->deviceId();
+  UpdatePeerAccess(slab);
+  slabs_.AddSlab(slab);
+
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool AllocSlab: %p, %p", slab_ptr, slab);
+  return slabs_.Allocate(size_class);
+}
+
+// ================================================================================================
+bool MemoryPool::Compact(size_t size, bool wait) {
+  uint64_t free_size = free_heap_.GetTotalSize();
+  if (free_size == 0) {
+    return false;
+  }
+  // The free heap holds only unmapped physical memory or allocations without the users, hence
+  // nothing has to be copied. The graph working sets are released too, since the allocation
+  // fails otherwise
+  constexpr size_t kBytesToHold = 0;
+  free_heap_.ReleaseAllMemory(kBytesToHold, wait);
+  uint64_t released = free_size - free_heap_.GetTotalSize();
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool compact for %zu bytes: released %llu of %llu",
+          size, static_cast<unsigned long long>(released),
+          static_cast<unsigned long long>(free_size));
+  return released != 0;
+}
+
+// ================================================================================================
+void MemoryPool::UpdatePeerAccess(amd::Memory* memory) {
+  if (peer_devices_.empty()) {
+    return;
+  }
+  // Map the new allocation to all peers with one update, instead of an update per peer
+  auto pool_device = device_->asContext()->devices()[0];
+  if (!pool_device->allowPeersAccess(memory->getDeviceMemory(*pool_device), peer_devices_)) {
+    return;
+  }
+  for (auto peer_device : peer_devices_) {
+    device::Memory* mem = memory->getDeviceMemory(*peer_device);
+    if (mem != nullptr) {
+      mem->setAllowedPeerAccess(true);
+    }
+  }
+}
+
 // ================================================================================================
 bool MemoryPool::FreeMemory(amd::Memory* memory, Stream* stream, Event* event) {
   {
@@ -265,6 +480,10 @@ bool MemoryPool::FreeMemory(amd::Memory* memory, Stream* stream, Event* event) {
       return false;
     }
     ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool FreeMem: %p, %p", memory->getSvmPtr(), memory);
+    if (amd::AllocTrace::Enabled()) {
+      amd::AllocTrace::Record(amd::AllocTrace::kFree, amd::AllocTrace::kPool,
+                              memory->getSvmPtr(), memory->getSize(), this, stream);
+    }
 
     if (memory->getUserData().vaddr_mem_obj != nullptr) {
       auto va_mem = memory->getUserData().vaddr_mem_obj;
@@ -318,10 +537,10 @@ void MemoryPool::ReleaseAllMemory() {
 }
 
 // ================================================================================================
-void MemoryPool::ReleaseFreedMemory() {
+size_t MemoryPool::ReleaseFreedMemory(size_t max_bytes) {
   amd::ScopedLock lock(lock_pool_ops_);
 
-  free_heap_.ReleaseAllMemory();
+  return free_heap_.ReleaseOverThreshold(max_bytes);
 }
 
 // ================================================================================================
@@ -329,10 +548,13 @@ void MemoryPool::RemoveStream(Stream* stream) {
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.RemoveStream(stream);
+  // Busy allocations carry the safe streams into the free heap on release
+  busy_heap_.RemoveStream(stream);
 }
 
 // ================================================================================================
 void MemoryPool::TrimTo(size_t min_bytes_to_hold) {
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Memory, "MemoryPool::TrimTo");
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.ReleaseAllMemory(min_bytes_to_hold);
@@ -411,7 +633,7 @@ hipError_t MemoryPool::GetAttribute(hipMemPoolAttr attr, void* value) {
       break;
     case hipMemPoolAttrReservedMemCurrent:
       // All allocate memory by the pool in OS
-      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() + free_heap_.GetTotalSize();
+      *reinterpret_cast<uint64_t*>(value) = ReservedSize();
       break;
     case hipMemPoolAttrReservedMemHigh:
       // High watermark of all allocated memory in OS, since the last reset
@@ -431,6 +653,24 @@ hipError_t MemoryPool::GetAttribute(hipMemPoolAttr attr, void* value) {
   return hipSuccess;
 }
 
+// ================================================================================================
+void MemoryPool::PrintReport() {
+  amd::ScopedLock lock(lock_pool_ops_);
+
+  uint64_t free_size = free_heap_.GetTotalSize();
+  size_t largest_free = free_heap_.LargestSize();
+  // The share of the free memory, which a single allocation of the largest free piece can't reuse
+  double fragmentation = (free_size != 0) ?
+      (1.0 - static_cast<double>(largest_free) / static_cast<double>(free_size)) : 0.0;
+  ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "Pool %p on device %d: reserved %lu (peak %lu), "
+          "busy %lu in %zu allocations (peak %lu), free %lu in %zu allocations, largest free "
+          "%zu, fragmentation %.1f%%, idle slabs %zu, release threshold %lu", this,
+          device_->deviceId(), ReservedSize(), max_total_size_, busy_heap_.GetTotalSize(),
+          busy_heap_.NumAllocations(), busy_heap_.GetMaxTotalSize(), free_size,
+          free_heap_.NumAllocations(), largest_free, fragmentation * 100.0, slabs_.IdleSize(),
+          free_heap_.GetReleaseThreshold());
+}
+
 // ================================================================================================
 void MemoryPool::SetAccess(hip::Device* device, hipMemAccessFlags flags) {
   amd::ScopedLock lock(lock_pool_ops_);
@@ -455,9 +695,19 @@ void MemoryPool::SetAccess(hip::Device* device, hipMemAccessFlags flags) {
     if ((flags == hipMemAccessFlagsProtRead) || (flags == hipMemAccessFlagsProtReadWrite)) {
       enable_access = true;
     }
-    // Update device access on the both pools
+    // Update device access on the both pools and all slabs at once
     busy_heap_.SetAccess(device, enable_access);
     free_heap_.SetAccess(device, enable_access);
+    slabs_.SetAccess(device, enable_access);
+
+    // Cache the peer list, so the new allocations are mapped with a single update
+    auto peer_device = device->asContext()->devices()[0];
+    auto it = std::find(peer_devices_.begin(), peer_devices_.end(), peer_device);
+    if (enable_access && (it == peer_devices_.end())) {
+      peer_devices_.push_back(peer_device);
+    } else if (!enable_access && (it != peer_devices_.end())) {
+      peer_devices_.erase(it);
+    }
   }
 }
 
@@ -526,4 +776,60 @@ bool MemoryPool::Import(amd::Os::FileDesc handle) {
   }
   return result;
 }
+// ================================================================================================
+void MemoryReclaimer::Start() {
+  thread_ = std::thread(&MemoryReclaimer::Run, this);
+}
+
+// ================================================================================================
+void MemoryReclaimer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    exit_ = true;
+    cv_.notify_one();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+// ================================================================================================
+void MemoryReclaimer::Run() {
+  // The runtime objects expect an attached host thread
+  amd::Thread* thread = amd::Thread::current();
+  if (!VDI_CHECK_THREAD(thread)) {
+    LogError("Couldn't attach the memory reclaimer thread");
+    return;
+  }
+  uint64_t last = amd::Os::timeNanos();
+  std::unique_lock<std::mutex> lock(lock_);
+  while (!exit_) {
+    // Wake up on a sync point, otherwise poll the pools for retired HIP events
+    cv_.wait_for(lock, std::chrono::milliseconds(kPeriodMs), [this] { return pending_ || exit_; });
+    if (exit_) {
+      break;
+    }
+    pending_ = false;
+    lock.unlock();
+    // The deferred frees aren't pool memory, hence they don't count against the rate
+    device_->ReclaimDeferredFrees(false);
+    lock.lock();
+    uint64_t now = amd::Os::timeNanos();
+    // Accumulate the budget, but don't allow bursts over a second worth of the rate
+    budget_ = std::min(budget_ + rate_ * (now - last) / 1e9, rate_);
+    last = now;
+    if (budget_ < 1.0) {
+      continue;
+    }
+    lock.unlock();
+    // HIP events are only queried, so the pool locks are never held on a GPU wait
+    size_t released = device_->ReclaimFreedMemory(static_cast<size_t>(budget_));
+    lock.lock();
+    budget_ = std::max(budget_ - static_cast<double>(released), 0.0);
+    if (released != 0) {
+      ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Pool reclaimed %zu bytes", released);
+    }
+  }
+}
+
 }
@@ -23,6 +23,10 @@
 #include <hip/hip_runtime.h>
 #include "hip_event.hpp"
 #include "hip_internal.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -97,12 +101,73 @@ struct MemoryTimestamp {
   hip::Event*   event_ = nullptr;   //!< Last known HIP event, associated with the memory object
 };
 
+/// Carves small pool allocations out of larger slabs, so the steady state reuse of odd sizes
+/// doesn't reach ROCr. The carved blocks are views of a slab and go through the regular busy and
+/// free heaps, hence stream ordered reuse is still tracked per block.
+class SlabAllocator : public amd::EmbeddedObject {
+public:
+  static constexpr size_t kMinBlockSize = 512;  //!< The smallest size class
+
+  SlabAllocator(hip::Device* device):
+    slab_size_(static_cast<size_t>(HIP_MEM_POOL_SLAB_SIZE) * Ki), idle_size_(0),
+    current_(nullptr), device_(device) {}
+  ~SlabAllocator() {}
+
+  /// Returns true if the allocation size can be served from a slab
+  bool IsSuballocation(size_t size) const {
+    return (slab_size_ != 0) && (size <= (slab_size_ >> 3));
+  }
+
+  /// Rounds the size up to its size class
+  static size_t SizeClass(size_t size);
+
+  /// Carves a block of the size class from the current slab
+  amd::Memory* Allocate(size_t size_class);
+
+  /// Adds a new slab for carving. The slab object must be removed from MemObjMap
+  void AddSlab(amd::Memory* slab);
+
+  /// Returns true if the memory object is a block, carved from a slab
+  bool IsBlock(amd::Memory* memory) const;
+
+  /// Destroys the carved block and frees the slab, if it doesn't have any blocks left
+  void Free(amd::Memory* block);
+
+  /// Updates P2P access to all slabs. The carved blocks inherit the access of their slab
+  void SetAccess(hip::Device* device, bool enable);
+
+  /// Returns the size of a single slab
+  size_t SlabSize() const { return slab_size_; }
+
+  /// Returns the size of the reserved memory in slabs, which wasn't carved yet
+  size_t IdleSize() const { return idle_size_; }
+
+private:
+  SlabAllocator() = delete;
+  SlabAllocator(const SlabAllocator&) = delete;
+  SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+  struct Slab {
+    size_t offset_;   //!< Offset of the first not carved byte
+    size_t blocks_;   //!< The number of alive blocks, carved from the slab
+  };
+
+  std::unordered_map<amd::Memory*, Slab> slabs_;  //!< All slabs, reserved by the allocator
+  size_t slab_size_;        //!< The size of a single slab
+  size_t idle_size_;        //!< The size of not carved memory in all slabs
+  amd::Memory* current_;    //!< The slab for carving of new blocks
+  hip::Device*  device_;    //!< Hip device the slabs will reside
+};
+
 class Heap : public amd::EmbeddedObject {
 public:
-  typedef std::map<std::pair<size_t, amd::Memory*>, MemoryTimestamp> SortedMap;
+  typedef std::pair<size_t, amd::Memory*> SortedKey;
+  typedef std::map<SortedKey, MemoryTimestamp> SortedMap;
+  typedef std::unordered_map<Stream*, std::set<SortedKey>> StreamMap;
 
-  Heap(hip::Device* device):
-    total_size_(0), max_total_size_(0), release_threshold_(0), device_(device) {}
+  Heap(hip::Device* device, SlabAllocator* slabs = nullptr):
+    total_size_(0), max_total_size_(0), release_threshold_(0), hold_size_(0), slabs_(slabs),
+    device_(device) {}
   ~Heap() {}
 
   /// Adds allocation into the heap on a specific stream
@@ -124,6 +189,9 @@ public:
   /// Releases all memory, safe to the provided stream, until the threshold value is met
   bool ReleaseAllMemory();
 
+  /// Releases up to max_bytes of safe memory over the threshold. Returns the released size
+  size_t ReleaseOverThreshold(size_t max_bytes);
+
   /// Remove the provided stream from the safe list
   void RemoveStream(Stream* stream);
 
@@ -133,12 +201,23 @@ public:
   /// Heap doesn't have any allocations
   bool IsEmpty() const { return (allocations_.size() == 0) ? true : false; }
 
+  /// Returns the number of the allocations in the heap
+  size_t NumAllocations() const { return allocations_.size(); }
+
+  /// Returns the size of the largest allocation in the heap
+  size_t LargestSize() const {
+    return allocations_.empty() ? 0 : allocations_.rbegin()->first.first;
+  }
+
   /// Set the memory release threshold
   void SetReleaseThreshold(uint64_t value) { release_threshold_ = value; }
 
   /// Set the memory release threshold
   uint64_t GetReleaseThreshold() const { return release_threshold_; }
 
+  /// Adjusts the size, held for the planned graph working sets, by the provided delta
+  void AddHoldSize(int64_t delta) { hold_size_ += delta; }
+
   /// Get the size of all allocations in the heap
   uint64_t GetTotalSize() const { return total_size_; }
 
@@ -153,8 +232,13 @@ public:
 
   /// Add a safe stream for  quick looks-ups in all allocations
   void AddSafeStream(Stream* event_stream, Stream* wait_stream) {
+    Stream* safe_stream = (wait_stream != nullptr) ? wait_stream : event_stream;
     for (auto& it : allocations_) {
+      auto num_streams = it.second.safe_streams_.size();
       it.second.AddSafeStream(event_stream, wait_stream);
+      if (it.second.safe_streams_.size() != num_streams) {
+        safe_streams_[safe_stream].insert(it.first);
+      }
     }
   }
 
@@ -169,10 +253,32 @@ private:
   Heap(const Heap&) = delete;
   Heap& operator=(const Heap&) = delete;
 
+  /// Adds the allocation into the lists of all safe streams
+  void AddSafeStreams(const SortedKey& key, const MemoryTimestamp& ts) {
+    for (auto stream : ts.safe_streams_) {
+      safe_streams_[stream].insert(key);
+    }
+  }
+
+  /// Removes the allocation from the lists of all safe streams
+  void RemoveSafeStreams(const SortedKey& key, const MemoryTimestamp& ts) {
+    for (auto stream : ts.safe_streams_) {
+      if (auto it = safe_streams_.find(stream); it != safe_streams_.end()) {
+        it->second.erase(key);
+      }
+    }
+  }
+
+  /// Removes the found allocation from the heap and returns the memory object for reuse
+  amd::Memory* TakeMemory(SortedMap::iterator it, MemoryTimestamp* ts);
+
   SortedMap allocations_;       //!< Map of allocations on a specific stream
+  StreamMap safe_streams_;      //!< Allocations, sorted by size, for each safe stream
   uint64_t total_size_;         //!< Size of all allocations in the heap
   uint64_t max_total_size_;     //!< Maximum heap allocation size
   uint64_t release_threshold_;  //!< Threshold size in bytes for memory release from heap, default 0
+  uint64_t hold_size_;          //!< Size in bytes, held for the instantiated graph working sets
+  SlabAllocator* slabs_;        //!< Slab allocator for the carved blocks
 
   hip::Device*  device_;    //!< Hip device the allocations will reside
 };
@@ -197,9 +303,10 @@ class MemoryPool : public amd::ReferenceCountedObject {
   };
 
   MemoryPool(hip::Device* device, const hipMemPoolProps* props = nullptr, bool phys_mem = false)
-      : busy_heap_(device),
-        free_heap_(device),
-        lock_pool_ops_(true), /* Pool operations */
+      : slabs_(device),
+        busy_heap_(device, &slabs_),
+        free_heap_(device, &slabs_),
+        lock_pool_ops_("Memory pool lock", true),
         device_(device),
         shared_(nullptr),
         max_total_size_(0) {
@@ -220,6 +327,8 @@ class MemoryPool : public amd::ReferenceCountedObject {
                      .reserved = {}};
     }
     state_.interprocess_ = properties_.handleTypes != hipMemHandleTypeNone;
+    // IPC and graph pools work with the whole allocations only
+    state_.sub_alloc_ = !state_.interprocess_ && !phys_mem;
   }
 
   virtual ~MemoryPool() {
@@ -246,7 +355,7 @@ class MemoryPool : public amd::ReferenceCountedObject {
 
   /// Releases all allocations from free_heap_. It can be called on Stream or Device synchronization
   /// @note The caller must make sure it's safe to release memory
-  void ReleaseFreedMemory();
+  size_t ReleaseFreedMemory(size_t max_bytes = std::numeric_limits<size_t>::max());
 
   /// Removes a stream from tracking
   void RemoveStream(hip::Stream* stream);
@@ -288,6 +397,9 @@ class MemoryPool : public amd::ReferenceCountedObject {
   /// Frees all busy memory
   void FreeAllMemory(hip::Stream* stream = nullptr);
 
+  /// Prints the usage, the peaks and the fragmentation of the free memory in the pool
+  void PrintReport();
+
   /// Exports memory pool into an OS specific handle
   amd::Os::FileDesc Export();
 
@@ -304,11 +416,34 @@ class MemoryPool : public amd::ReferenceCountedObject {
   bool GraphInUse() const { return (state_.graph_in_use_) ? true : false; }
   void SetGraphInUse() { state_.graph_in_use_ = true; }
 
+  /// Holds the planned working set of a graph in the free heap across the launches
+  void AddHoldSize(int64_t delta) {
+    amd::ScopedLock lock(lock_pool_ops_);
+    free_heap_.AddHoldSize(delta);
+  }
+
  private:
   MemoryPool() = delete;
   MemoryPool(const MemoryPool&) = delete;
   MemoryPool& operator=(const MemoryPool&) = delete;
 
+  /// Reserves a new slab and carves a block of the size class from it
+  amd::Memory* AllocateSlabBlock(size_t size_class);
+
+  /// Allows access to the new allocation from the devices in the access map
+  void UpdatePeerAccess(amd::Memory* memory);
+
+  /// Returns the freed allocations, which no live pointer references, to the device, so a failed
+  /// allocation can retry with the scattered free pieces joined into one block by ROCr. Returns
+  /// true if any memory was released
+  bool Compact(size_t size, bool wait);
+
+  /// Returns the size of all memory, reserved by the pool
+  uint64_t ReservedSize() const {
+    return busy_heap_.GetTotalSize() + free_heap_.GetTotalSize() + slabs_.IdleSize();
+  }
+
+  SlabAllocator slabs_;   //!< Sub-allocator of small allocations
   Heap busy_heap_;    //!< Heap of busy allocations
   Heap free_heap_;    //!< Heap of freed allocations
   union {
@@ -320,6 +455,7 @@ class MemoryPool : public amd::ReferenceCountedObject {
       uint32_t interprocess_ : 1;   //!< Memory pool can be used in interprocess communications
       uint32_t graph_in_use_ : 1;   //!< Memory pool was used in a graph execution
       uint32_t phys_mem_ : 1;       //!< Mempool is used for graphs and will have physical allocations
+      uint32_t sub_alloc_ : 1;      //!< Small allocations are carved from slabs
     };
     uint32_t value_;
   } state_;
@@ -327,10 +463,52 @@ class MemoryPool : public amd::ReferenceCountedObject {
   hipMemPoolProps properties_;  //!< Properties of the memory pool
   amd::Monitor lock_pool_ops_;  //!< Access to the pool must be lock protected
   std::map<hip::Device*, hipMemAccessFlags> access_map_;  //!< Map of access to the pool from devices
+  std::vector<amd::Device*> peer_devices_;  //!< Devices with the enabled access to the pool
   hip::Device*  device_;    //!< Hip device the heap will reside
   SharedMemPool* shared_;   //!< Pointer to shared memory for IPC
   uint64_t max_total_size_; //!< Max of total reserved memory in the pool since last reset
 };
 
+/// Releases the freed memory of all pools on the device in the background,
+/// so the sync points don't have to return memory to ROCr
+class MemoryReclaimer {
+ public:
+  static constexpr uint32_t kPeriodMs = 10;   //!< Release period without notifications
+
+  MemoryReclaimer(hip::Device* device)
+      : rate_(static_cast<double>(HIP_MEM_POOL_RECLAIM_RATE) * Mi), budget_(0),
+        pending_(false), exit_(false), device_(device) {}
+  ~MemoryReclaimer() { Stop(); }
+
+  /// Starts the background thread
+  void Start();
+
+  /// Stops and joins the background thread
+  void Stop();
+
+  /// Requests a release pass, usually from a sync point
+  void Notify() {
+    std::lock_guard<std::mutex> lock(lock_);
+    pending_ = true;
+    cv_.notify_one();
+  }
+
+ private:
+  MemoryReclaimer() = delete;
+  MemoryReclaimer(const MemoryReclaimer&) = delete;
+  MemoryReclaimer& operator=(const MemoryReclaimer&) = delete;
+
+  /// The thread entry point
+  void Run();
+
+  double rate_;                 //!< Rate limit in bytes per second
+  double budget_;               //!< Bytes, which can be released without exceeding the rate
+  bool pending_;                //!< A release pass was requested
+  bool exit_;                   //!< The thread must exit
+  std::mutex lock_;             //!< Protects the reclaimer state
+  std::condition_variable cv_;  //!< Wakes up the thread
+  std::thread thread_;          //!< The background thread
+  hip::Device* device_;         //!< Hip device the pools belong to
+};
 
 } // Mamespace hip
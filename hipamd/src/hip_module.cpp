@@ -20,10 +20,12 @@
 
 #include <hip/hip_runtime.h>
 #include <elf/elf.hpp>
+#include <atomic>
 #include <fstream>
 
 #include "hip_internal.hpp"
 #include "platform/program.hpp"
+#include "platform/runtime.hpp"
 #include "hip_event.hpp"
 #include "hip_platform.hpp"
 
@@ -341,7 +343,8 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
                                    hipEvent_t startEvent = nullptr, hipEvent_t stopEvent = nullptr,
                                    uint32_t flags = 0, uint32_t params = 0, uint32_t gridId = 0,
                                    uint32_t numGrids = 0, uint64_t prevGridSum = 0,
-                                   uint64_t allGridSum = 0, uint32_t firstDevice = 0) {
+                                   uint64_t allGridSum = 0, uint32_t firstDevice = 0,
+                                   bool directArgs = false) {
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(f);
   amd::Kernel* kernel = function->kernel();
 
@@ -380,7 +383,7 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
   }
 
   if (DEBUG_HIP_KERNARG_COPY_OPT) {
-    if (CL_SUCCESS != kernelCommand->AllocCaptureSetValidate(kernelParams, kernargs)) {
+    if (CL_SUCCESS != kernelCommand->AllocCaptureSetValidate(kernelParams, kernargs, directArgs)) {
       kernelCommand->release();
       return hipErrorOutOfMemory;
     }
@@ -399,7 +402,7 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
     }
 
     // Capture the kernel arguments
-    if (CL_SUCCESS != kernelCommand->captureAndValidate()) {
+    if (CL_SUCCESS != kernelCommand->captureAndValidate(directArgs)) {
       kernelCommand->release();
       return hipErrorOutOfMemory;
     }
@@ -410,14 +413,13 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
   return hipSuccess;
 }
 
-hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
-                                  uint32_t globalWorkSizeY, uint32_t globalWorkSizeZ,
-                                  uint32_t blockDimX, uint32_t blockDimY, uint32_t blockDimZ,
-                                  uint32_t sharedMemBytes, hipStream_t hStream, void** kernelParams,
-                                  void** extra, hipEvent_t startEvent, hipEvent_t stopEvent,
-                                  uint32_t flags = 0, uint32_t params = 0, uint32_t gridId = 0,
-                                  uint32_t numGrids = 0, uint64_t prevGridSum = 0,
-                                  uint64_t allGridSum = 0, uint32_t firstDevice = 0) {
+// Validates the launch and creates the kernel command without the submission
+static hipError_t ihipModuleLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
+    uint32_t globalWorkSizeX, uint32_t globalWorkSizeY, uint32_t globalWorkSizeZ,
+    uint32_t blockDimX, uint32_t blockDimY, uint32_t blockDimZ, uint32_t sharedMemBytes,
+    hipStream_t hStream, void** kernelParams, void** extra, hipEvent_t startEvent,
+    hipEvent_t stopEvent, uint32_t flags, uint32_t params, uint32_t gridId, uint32_t numGrids,
+    uint64_t prevGridSum, uint64_t allGridSum, uint32_t firstDevice) {
   int deviceId = hip::Stream::DeviceId(hStream);
   HIP_RETURN_ONFAIL(PlatformState::instance().initStatManagedVarDevicePtr(deviceId));
 
@@ -435,6 +437,7 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
   if (status != hipSuccess) {
     return status;
   }
+  amd::activity_prof::LaunchStamp(amd::activity_prof::LAUNCH_STAGE_VALIDATED);
   // Make sure the app doesn't launch a workgroup bigger than the global size
   if (globalWorkSizeX < blockDimX) blockDimX = globalWorkSizeX;
   if (globalWorkSizeY < blockDimY) blockDimY = globalWorkSizeY;
@@ -449,15 +452,37 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
       return hipErrorInvalidValue;
     }
   }
-  amd::Command* command = nullptr;
   hip::Stream* hip_stream = hip::getStream(hStream);
-  status = ihipLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ,
-                                   blockDimX, blockDimY, blockDimZ, sharedMemBytes, hip_stream,
-                                   kernelParams, extra, startEvent, stopEvent, flags, params,
-                                   gridId, numGrids, prevGridSum, allGridSum, firstDevice);
+  return ihipLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ,
+                                 blockDimX, blockDimY, blockDimZ, sharedMemBytes, hip_stream,
+                                 kernelParams, extra, startEvent, stopEvent, flags, params,
+                                 gridId, numGrids, prevGridSum, allGridSum, firstDevice, true);
+}
+
+hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
+                                  uint32_t globalWorkSizeY, uint32_t globalWorkSizeZ,
+                                  uint32_t blockDimX, uint32_t blockDimY, uint32_t blockDimZ,
+                                  uint32_t sharedMemBytes, hipStream_t hStream, void** kernelParams,
+                                  void** extra, hipEvent_t startEvent, hipEvent_t stopEvent,
+                                  uint32_t flags = 0, uint32_t params = 0, uint32_t gridId = 0,
+                                  uint32_t numGrids = 0, uint64_t prevGridSum = 0,
+                                  uint64_t allGridSum = 0, uint32_t firstDevice = 0) {
+  amd::activity_prof::LaunchStamp(amd::activity_prof::LAUNCH_STAGE_API_ENTRY);
+  amd::Command* command = nullptr;
+  hipError_t status = ihipModuleLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY,
+      globalWorkSizeZ, blockDimX, blockDimY, blockDimZ, sharedMemBytes, hStream, kernelParams,
+      extra, startEvent, stopEvent, flags, params, gridId, numGrids, prevGridSum, allGridSum,
+      firstDevice);
   if (status != hipSuccess) {
     return status;
   }
+  amd::activity_prof::LaunchStamp(amd::activity_prof::LAUNCH_STAGE_COMMAND);
+  hip::Stream* hip_stream = hip::getStream(hStream);
+  if (HIP_HMM_AUTO_POLICY) {
+    // May enqueue a migration of the managed arguments ahead of the kernel
+    hip::ManagedPolicy::RecordLaunch(*static_cast<amd::NDRangeKernelCommand*>(command),
+                                     hip_stream);
+  }
 
   if (startEvent != nullptr) {
     hip::Event* eStart = reinterpret_cast<hip::Event*>(startEvent);
@@ -485,7 +510,12 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
     command->release();
     return hipErrorIllegalState;
   }
+  amd::StartupProfile::mark(amd::StartupProfile::FirstLaunch);
 
+  if (hip_stream->GetLaunchStats() != nullptr) {
+    hip_stream->GetLaunchStats()->Record(amd::activity_prof::launch_trace,
+                                         amd::activity_prof::correlation_id);
+  }
   command->release();
 
   return hipSuccess;
@@ -634,15 +664,23 @@ hipError_t ihipModuleLaunchCooperativeKernelMultiDevice(hipFunctionLaunchParams*
   uint64_t prevGridSize = 0;
   uint32_t firstDevice = 0;
 
-  // Sync the execution streams on all devices
-  if ((flags & hipCooperativeLaunchMultiDeviceNoPreSync) == 0) {
+  // Sync the execution streams on all devices with one host wait
+  auto syncStreams = [&]() {
+    std::vector<hip::Stream*> streams(numDevices);
     for (int i = 0; i < numDevices; ++i) {
-      hip::Stream* hip_stream =
-          reinterpret_cast<hip::Stream*>(launchParamsList[i].hStream);
-      hip_stream->finish();
+      streams[i] = reinterpret_cast<hip::Stream*>(launchParamsList[i].hStream);
+      streams[i]->retain();
     }
+    hip::Device::FinishStreams(streams, false);
+  };
+  if ((flags & hipCooperativeLaunchMultiDeviceNoPreSync) == 0) {
+    syncStreams();
   }
 
+  // Prepare the commands for all devices first, so only the submissions remain between
+  // the launches on different devices
+  std::vector<amd::Command*> commands;
+  commands.reserve(numDevices);
   for (int i = 0; i < numDevices; ++i) {
     const hipFunctionLaunchParams& launch = launchParamsList[i];
     hip::Stream* hip_stream = reinterpret_cast<hip::Stream*>(launch.hStream);
@@ -667,8 +705,9 @@ hipError_t ihipModuleLaunchCooperativeKernelMultiDevice(hipFunctionLaunchParams*
         globalWorkSizeZ > std::numeric_limits<uint32_t>::max()) {
       return hipErrorInvalidConfiguration;
     }
-    result = ihipModuleLaunchKernel(
-        launch.function, static_cast<uint32_t>(globalWorkSizeX),
+    amd::Command* command = nullptr;
+    result = ihipModuleLaunchKernelCommand(
+        command, launch.function, static_cast<uint32_t>(globalWorkSizeX),
         static_cast<uint32_t>(globalWorkSizeY),
         static_cast<uint32_t>(globalWorkSizeZ), launch.blockDimX, launch.blockDimY,
         launch.blockDimZ, launch.sharedMemBytes, launch.hStream, launch.kernelParams,
@@ -677,16 +716,53 @@ hipError_t ihipModuleLaunchCooperativeKernelMultiDevice(hipFunctionLaunchParams*
     if (result != hipSuccess) {
       break;
     }
+    commands.push_back(command);
     prevGridSize += globalWorkSizeX * globalWorkSizeY * globalWorkSizeZ;
   }
 
+  // Don't launch a partial grid, since the launched devices would wait for the missing ones
+  if (result != hipSuccess) {
+    for (auto command : commands) {
+      command->release();
+    }
+    return result;
+  }
+
+  if (HIP_COOP_PARALLEL_SUBMIT && (commands.size() > 1)) {
+    // Each device gets a submission thread. The threads spin on the start flag, so all
+    // submissions are released at the same time
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    threads.reserve(commands.size() - 1);
+    for (size_t i = 1; i < commands.size(); ++i) {
+      threads.emplace_back([&start, command = commands[i]]() {
+        while (!start.load(std::memory_order_acquire)) {
+          amd::Os::spinPause();
+        }
+        command->enqueue();
+      });
+    }
+    start.store(true, std::memory_order_release);
+    commands[0]->enqueue();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  } else {
+    for (auto command : commands) {
+      command->enqueue();
+    }
+  }
+
+  for (auto command : commands) {
+    if (command->status() == CL_INVALID_OPERATION) {
+      result = hipErrorIllegalState;
+    }
+    command->release();
+  }
+
   // Sync the execution streams on all devices
   if ((flags & hipCooperativeLaunchMultiDeviceNoPostSync) == 0) {
-    for (int i = 0; i < numDevices; ++i) {
-      hip::Stream* hip_stream =
-          reinterpret_cast<hip::Stream*>(launchParamsList[i].hStream);
-      hip_stream->finish();
-    }
+    syncStreams();
   }
 
   return result;
@@ -21,6 +21,9 @@
 #include <hip/hip_runtime.h>
 
 #include "hip_internal.hpp"
+#include "hip_graph_helper.hpp"
+
+#include <limits>
 
 namespace hip {
 
@@ -219,6 +222,150 @@ hipError_t hipMemcpyPeerAsync(void* dst, int dstDevice, const void* src, int src
   HIP_RETURN(ihipMemcpy(dst, src, sizeBytes, hipMemcpyDeviceToDevice, *hip_stream, true, true));
 }
 
+// ================================================================================================
+hipError_t hipExtMemcpyPeerBroadcastAsync(void* const* dsts, const int* dstDevices,
+                                          unsigned int numDsts, const void* src, int srcDevice,
+                                          size_t sizeBytes, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemcpyPeerBroadcastAsync, dsts, dstDevices, numDsts, src, srcDevice,
+               sizeBytes, stream);
+
+  const int numDevices = static_cast<int>(g_devices.size());
+  if ((dsts == nullptr) || (dstDevices == nullptr) || (src == nullptr)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if ((srcDevice < 0) || (srcDevice >= numDevices)) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  for (unsigned int i = 0; i < numDsts; ++i) {
+    if ((dstDevices[i] < 0) || (dstDevices[i] >= numDevices)) {
+      HIP_RETURN(hipErrorInvalidDevice);
+    }
+    if (dsts[i] == nullptr) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+  }
+  if (!hip::isValid(stream)) {
+    HIP_RETURN(hipErrorContextIsDestroyed);
+  }
+  hip::Stream* hip_stream = hip::getStream(stream);
+  if ((numDsts == 0) || (sizeBytes == 0)) {
+    HIP_RETURN(hipSuccess);
+  }
+
+  // Every device, which already holds the data, is a source for the remaining destinations
+  struct Holder {
+    int device_;             //!< Device ID of the holder
+    const void* ptr_;        //!< Data location on the device
+    amd::Command* fill_;     //!< Copy, which fills the holder, nullptr for the original source
+    uint32_t children_;      //!< The number of the destinations, served by the holder
+  };
+  std::vector<Holder> holders;
+  holders.reserve(numDsts + 1);
+  holders.push_back({srcDevice, src, nullptr, 0});
+  std::vector<bool> done(numDsts, false);
+
+  // Returns the hop count of the direct link between the devices, -1 if there is no peer access
+  auto directHops = [](int device1, int device2) {
+    int canAccess12 = 0;
+    int canAccess21 = 0;
+    canAccessPeer(&canAccess12, device1, device2);
+    canAccessPeer(&canAccess21, device2, device1);
+    if ((canAccess12 == 0) && (canAccess21 == 0)) {
+      return -1;
+    }
+    std::vector<amd::Device::LinkAttrType> link_attrs = {
+        {amd::Device::LinkAttribute::kLinkHopCount, 0}};
+    return (findLinkInfo(device1, device2, &link_attrs) == hipSuccess) ? link_attrs[0].second : 1;
+  };
+
+  amd::Command* lastCommand = hip_stream->getLastQueuedCommand(true);
+  amd::Command::EventWaitList leafs;
+  hipError_t status = hipSuccess;
+  for (unsigned int n = 0; (n < numDsts) && (status == hipSuccess); ++n) {
+    // Pick the next transfer over a direct link, with the least loaded holder and shortest link,
+    // so every link carries the data once and the copies spread over the tree
+    int best_dst = -1;
+    int best_holder = -1;
+    int best_hops = std::numeric_limits<int>::max();
+    uint32_t best_children = std::numeric_limits<uint32_t>::max();
+    for (unsigned int d = 0; d < numDsts; ++d) {
+      if (done[d]) {
+        continue;
+      }
+      for (size_t h = 0; h < holders.size(); ++h) {
+        int hops = (holders[h].device_ == dstDevices[d]) ? 0 :
+                   directHops(holders[h].device_, dstDevices[d]);
+        if (hops < 0) {
+          continue;
+        }
+        if ((holders[h].children_ < best_children) ||
+            ((holders[h].children_ == best_children) && (hops < best_hops))) {
+          best_dst = d;
+          best_holder = static_cast<int>(h);
+          best_hops = hops;
+          best_children = holders[h].children_;
+        }
+      }
+    }
+    if (best_dst < 0) {
+      // The remaining destinations have no direct link to any holder, copy from the source
+      for (unsigned int d = 0; d < numDsts; ++d) {
+        if (!done[d]) {
+          best_dst = d;
+          break;
+        }
+      }
+      best_holder = 0;
+    }
+    Holder& holder = holders[best_holder];
+    const int dstDevice = dstDevices[best_dst];
+
+    // Pull on the destination device, if it can access the holder, otherwise push from the holder
+    int canAccess = 0;
+    canAccessPeer(&canAccess, dstDevice, holder.device_);
+    const int queueDevice = ((canAccess != 0) || (dstDevice == holder.device_)) ?
+        dstDevice : holder.device_;
+    hip::Stream* queue = (queueDevice == hip_stream->DeviceId()) ? hip_stream :
+        hip::getNullStream(*g_devices[queueDevice]->asContext());
+
+    amd::Command* command = nullptr;
+    status = ihipMemcpyCommand(command, dsts[best_dst], holder.ptr_, sizeBytes,
+                               hipMemcpyDeviceToDevice, *queue, true);
+    if (status != hipSuccess) {
+      break;
+    }
+    amd::Command::EventWaitList waitList;
+    if (holder.fill_ != nullptr) {
+      waitList.push_back(holder.fill_);
+    } else if ((lastCommand != nullptr) && (command->queue() != hip_stream)) {
+      waitList.push_back(lastCommand);
+    }
+    command->updateEventWaitList(waitList);
+    command->enqueue();
+
+    holder.children_++;
+    done[best_dst] = true;
+    holders.push_back({dstDevice, dsts[best_dst], command, 0});
+    if (command->queue() != hip_stream) {
+      leafs.push_back(command);
+    }
+  }
+
+  // The launch stream waits for the copies on the other devices
+  if (!leafs.empty()) {
+    amd::Command* marker = new amd::Marker(*hip_stream, kMarkerDisableFlush, leafs);
+    marker->enqueue();
+    marker->release();
+  }
+  for (size_t h = 1; h < holders.size(); ++h) {
+    holders[h].fill_->release();
+  }
+  if (lastCommand != nullptr) {
+    lastCommand->release();
+  }
+  HIP_RETURN(status);
+}
+
 hipError_t hipCtxEnablePeerAccess(hipCtx_t peerCtx, unsigned int flags) {
   HIP_INIT_API(hipCtxEnablePeerAccess, peerCtx, flags);
 
@@ -25,6 +25,7 @@
 #include "platform/program.hpp"
 #include "platform/runtime.hpp"
 
+#include <limits>
 #include <unordered_map>
 #include <mutex>
 
@@ -346,7 +347,8 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
   const amd::Kernel& kernel = *function->kernel();
 
-  const device::Kernel::WorkGroupInfo* wrkGrpInfo = kernel.getDeviceKernel(device)->workGroupInfo();
+  const device::Kernel* devKernel = kernel.getDeviceKernel(device);
+  const device::Kernel::WorkGroupInfo* wrkGrpInfo = devKernel->workGroupInfo();
   if (bCalcPotentialBlkSz == false) {
     if (inputBlockSize <= 0) {
       return hipErrorInvalidValue;
@@ -367,50 +369,15 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
       inputBlockSize = device.info().maxWorkGroupSize_;
     }
   }
-  // Find wave occupancy per CU => simd_per_cu * GPR usage
-  size_t MaxWavesPerSimd;
-
-  if (device.isa().versionMajor() <= 9) {
-    MaxWavesPerSimd = 8;  // Limited by SPI 32 per CU, hence 8 per SIMD
-  } else {
-    MaxWavesPerSimd = 16;
-  }
-  size_t VgprWaves = MaxWavesPerSimd;
-  uint32_t VgprGranularity = device.info().vgprAllocGranularity_;
-  size_t maxVGPRs = device.info().vgprsPerSimd_;
-  size_t wavefrontSize = wrkGrpInfo->wavefrontSize_;
-  if (device.isa().versionMajor() >= 10) {
-    if (wavefrontSize == 64) {
-      maxVGPRs = maxVGPRs >> 1;
-      VgprGranularity = VgprGranularity >> 1;
-    }
-  }
-  if (wrkGrpInfo->usedVGPRs_ > 0) {
-    VgprWaves = maxVGPRs / amd::alignUp(wrkGrpInfo->usedVGPRs_, VgprGranularity);
-  }
-
-  if (VgprWaves == 0) {
+  device::Kernel::Occupancy occupancy;
+  if (!devKernel->GetOccupancy(dynamicSMemSize, &occupancy)) {
     // This should not happen ideally, but in case the usedVGPRs_/availableVGPRs_ values are
     // incorrect, it can lead to a crash. By returning error, API can exit gracefully.
     return hipErrorUnknown;
   }
-
-  size_t GprWaves = VgprWaves;
-  if (wrkGrpInfo->usedSGPRs_ > 0) {
-    size_t maxSGPRs = device.info().sgprsPerSimd_;
-    const size_t SgprWaves = maxSGPRs / amd::alignUp(wrkGrpInfo->usedSGPRs_, 16);
-    GprWaves = std::min(VgprWaves, SgprWaves);
-  }
-  uint32_t simdPerCU = (device.isa().versionMajor() <= 9) ? device.info().simdPerCU_
-                                                          : (wrkGrpInfo->isWGPMode_ ? 4 : 2);
-  const size_t alu_occupancy = simdPerCU * std::min(MaxWavesPerSimd, GprWaves);
-  const int alu_limited_threads = alu_occupancy * wrkGrpInfo->wavefrontSize_;
-
-  int lds_occupancy_wgs = INT_MAX;
-  const size_t total_used_lds = wrkGrpInfo->usedLDSSize_ + dynamicSMemSize;
-  if (total_used_lds != 0) {
-    lds_occupancy_wgs = static_cast<int>(device.info().localMemSize_ / total_used_lds);
-  }
+  const int alu_limited_threads = occupancy.aluWaves_ * wrkGrpInfo->wavefrontSize_;
+  const int lds_occupancy_wgs = static_cast<int>(
+      std::min<uint32_t>(occupancy.ldsGroups_, std::numeric_limits<int>::max()));
   // Calculate how many blocks of inputBlockSize we can fit per CU
   // Need to align with hardware wavefront size. If they want 65 threads, but
   // waves are 64, then we need 128 threads per block.
@@ -428,6 +395,11 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
   // calculate that 128 threads can fit in each CU, we have to give up and return 64.
   *bestBlockSize =
       std::min(alu_limited_threads, amd::alignUp(inputBlockSize, wrkGrpInfo->wavefrontSize_));
+  if (bCalcPotentialBlkSz) {
+    // A smaller block may fit more waves, if the wave limit isn't a multiple of the block
+    *bestBlockSize = static_cast<int>(
+        devKernel->FindOccupancyWorkGroupSize(*bestBlockSize, dynamicSMemSize));
+  }
   // If the best block size is smaller than the block size used to fit the maximum,
   // then we need to make the grid bigger for full occupancy.
   const int bestBlocksPerCU = alu_limited_threads / (*bestBlockSize);
@@ -725,11 +697,14 @@ extern "C"
 }
 
 void PlatformState::init() {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
   if (initialized_ || g_devices.empty()) {
     return;
   }
   initialized_ = true;
+  if (HIP_PARALLEL_FATBIN_INIT > 0) {
+    statCO_.digestFatBinaries(HIP_PARALLEL_FATBIN_INIT);
+  }
   for (auto& it : statCO_.modules_) {
     hipError_t err = digestFatBinary(it.first, it.second);
     if (err != hipSuccess) {
@@ -759,7 +734,7 @@ hipError_t PlatformState::loadModule(hipModule_t* module, const char* fname, con
   *module = dynCo->module();
   assert(*module != nullptr);
 
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
   if (dynCO_map_.find(*module) != dynCO_map_.end()) {
     delete dynCo;
     return hipErrorAlreadyMapped;
@@ -770,7 +745,7 @@ hipError_t PlatformState::loadModule(hipModule_t* module, const char* fname, con
 }
 
 hipError_t PlatformState::unloadModule(hipModule_t hmod) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
 
   auto it = dynCO_map_.find(hmod);
   if (it == dynCO_map_.end()) {
@@ -794,7 +769,7 @@ hipError_t PlatformState::unloadModule(hipModule_t hmod) {
 
 hipError_t PlatformState::getDynFunc(hipFunction_t* hfunc, hipModule_t hmod,
                                      const char* func_name) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedSharedLock lock(lock_);
 
   auto it = dynCO_map_.find(hmod);
   if (it == dynCO_map_.end()) {
@@ -809,14 +784,14 @@ hipError_t PlatformState::getDynFunc(hipFunction_t* hfunc, hipModule_t hmod,
 }
 
 bool PlatformState::isValidDynFunc(const void* hfunc) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedSharedLock lock(lock_);
   return std::any_of(dynCO_map_.begin(), dynCO_map_.end(),
                      [&](auto& it) { return it.second->isValidDynFunc(hfunc); });
 }
 
 hipError_t PlatformState::getDynGlobalVar(const char* hostVar, hipModule_t hmod,
                                           hipDeviceptr_t* dev_ptr, size_t* size_ptr) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedSharedLock lock(lock_);
 
   if (hostVar == nullptr) {
     return hipErrorInvalidValue;
@@ -847,14 +822,14 @@ hipError_t PlatformState::getDynGlobalVar(const char* hostVar, hipModule_t hmod,
 
 hipError_t PlatformState::registerTexRef(textureReference* texRef, hipModule_t hmod,
                                          std::string name) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
   texRef_map_.insert(std::make_pair(texRef, std::make_pair(hmod, name)));
   return hipSuccess;
 }
 
 hipError_t PlatformState::getDynTexGlobalVar(textureReference* texRef, hipDeviceptr_t* dev_ptr,
                                              size_t* size_ptr) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedSharedLock lock(lock_);
 
   auto tex_it = texRef_map_.find(texRef);
   if (tex_it == texRef_map_.end()) {
@@ -878,7 +853,7 @@ hipError_t PlatformState::getDynTexGlobalVar(textureReference* texRef, hipDevice
 
 hipError_t PlatformState::getDynTexRef(const char* hostVar, hipModule_t hmod,
                                        textureReference** texRef) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
 
   auto it = dynCO_map_.find(hmod);
   if (it == dynCO_map_.end()) {
@@ -1002,7 +977,7 @@ bool PlatformState::CloseUniqueFileHandle(const std::shared_ptr<UniqueFD>& ufd)
 }
 
 void* PlatformState::getDynamicLibraryHandle() {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
 
   if (dynamicLibraryHandle_ != nullptr) {
     return dynamicLibraryHandle_;
@@ -1019,7 +994,7 @@ void* PlatformState::getDynamicLibraryHandle() {
 }
 
 void PlatformState::setDynamicLibraryHandle(void* handle){
-  amd::ScopedLock lock(lock_);
+  amd::ScopedExclusiveLock lock(lock_);
   dynamicLibraryHandle_ = handle;
 }
 
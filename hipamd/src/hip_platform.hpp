@@ -23,6 +23,7 @@
 #include "hip_fatbin.hpp"
 #include "device/device.hpp"
 #include "hip_code_object.hpp"
+#include "thread/rwmonitor.hpp"
 
 namespace hip_impl {
 
@@ -43,8 +44,9 @@ struct UniqueFD {
 
 namespace hip {
 class PlatformState {
-  // Guards PlatformState globals
-  amd::Monitor lock_{true};
+  // Guards PlatformState globals. The module lookups take the shared side, the module loads and
+  // the registrations take the exclusive side
+  amd::RwMonitor lock_;
 
   // global level lock for unique file descritor map: ufd_map_
   // Unique FD Store Lock
@@ -29,6 +29,7 @@
 
 #include "hip/amd_detail/hip_prof_str.h"
 #include "platform/prof_protocol.h"
+#include "hip_api_sampler.hpp"
 
 struct hip_api_trace_data_t {
   hip_api_data_t api_data;
@@ -61,9 +62,15 @@ template <hip_api_id_t operation_id> class api_callbacks_spawner_t {
         trace_data_.phase_enter(operation_id, &trace_data_);
       }
     }
+    if (hip::ApiSampler::IsEnabled()) {
+      sample_start_ = hip::ApiSampler::Begin(&sampled_);
+    }
   }
 
   ~api_callbacks_spawner_t() {
+    if (sample_start_ != 0) {
+      hip::ApiSampler::End(operation_id, sample_start_, sampled_);
+    }
     if (enabled_) {
       if (trace_data_.phase_exit != nullptr) trace_data_.phase_exit(operation_id, &trace_data_);
       amd::activity_prof::correlation_id = 0;
@@ -72,6 +79,8 @@ template <hip_api_id_t operation_id> class api_callbacks_spawner_t {
 
  private:
   bool enabled_{false};
+  bool sampled_{false};        //!< The call was sampled by the API sampler
+  uint64_t sample_start_{0};   //!< Start timestamp of the timed call
   union {
     hip_api_trace_data_t trace_data_;
   };
@@ -32,7 +32,7 @@ Stream::Stream(hip::Device* dev, Priority p, unsigned int f, bool null_stream,
                const std::vector<uint32_t>& cuMask, hipStreamCaptureStatus captureStatus)
     : amd::HostQueue(*dev->asContext(), *dev->devices()[0], 0, amd::CommandQueue::RealTimeDisabled,
                      convertToQueuePriority(p), cuMask),
-      lock_("Stream Callback lock"),
+      lock_("Stream Callback lock", true),
       device_(dev),
       priority_(p),
       flags_(f),
@@ -68,9 +68,44 @@ hipError_t Stream::EndCapture() {
 
 // ================================================================================================
 bool Stream::Create() {
+  if (HIP_LAUNCH_LATENCY) {
+    launchStats_.reset(new LaunchStats());
+    // Calibrate the launch timestamps at the stream creation rather than on the first launch
+    LaunchStats::TicksPerNs();
+  }
+  if (!null_ && ((flags_ & hipStreamNonBlocking) == 0)) {
+    // The null stream waits for the blocking streams and skips them, while the epoch is the same
+    setSharedEpoch(device_->BlockingEpoch());
+  }
   return create();
 }
 
+// ================================================================================================
+hipError_t Stream::SetCUMask(const std::vector<uint32_t>& cuMask) {
+  // The old work completes on the old CU set, before any new work reaches the new queue
+  finish();
+  amd::ScopedLock lock(lock_);
+  if (!vdev()->setCuMask(cuMask)) {
+    return hipErrorNotSupported;
+  }
+  cuMask_ = cuMask;
+  return hipSuccess;
+}
+
+// ================================================================================================
+void Stream::ResetForReuse() {
+  captureStatus_ = hipStreamCaptureStatusNone;
+  captureMode_ = hipStreamCaptureModeGlobal;
+  pCaptureGraph_ = nullptr;
+  originStream_ = false;
+  parentStream_ = nullptr;
+  lastCapturedNodes_.clear();
+  removedDependencies_.clear();
+  parallelCaptureStreams_.clear();
+  captureEvents_.clear();
+  captureID_ = 0;
+}
+
 // ================================================================================================
 void Stream::Destroy(hip::Stream* stream) {
   stream->device_->RemoveStream(stream);
@@ -80,6 +115,9 @@ void Stream::Destroy(hip::Stream* stream) {
 
 // ================================================================================================
 bool Stream::terminate() {
+  if ((launchStats_ != nullptr) && (HIP_LAUNCH_LATENCY & 0x2)) {
+    launchStats_->Print(this);
+  }
   HostQueue::terminate();
   return true;
 }
@@ -94,13 +132,116 @@ bool isValid(hipStream_t& stream) {
     getStreamPerThread(stream);
   }
 
-  hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  for (auto& device : g_devices) {
-    if (device->StreamExists(s)) {
+  // The lookup doesn't take any lock, hence the per-thread streams don't contend on validation
+  return StreamRegistry::Get().Exists(reinterpret_cast<hip::Stream*>(stream));
+}
+
+// ================================================================================================
+StreamRegistry& StreamRegistry::Get() {
+  // The registry outlives all streams, including the ones destroyed at the exit
+  static StreamRegistry* registry = new StreamRegistry();
+  return *registry;
+}
+
+// ================================================================================================
+StreamRegistry::StreamRegistry() {
+  tables_.emplace_back(new Table(kMinSlots));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+// ================================================================================================
+void StreamRegistry::Rehash(size_t size) {
+  Table* old_table = table_.load(std::memory_order_relaxed);
+  std::unique_ptr<Table> table(new Table(size));
+  for (size_t i = 0; i <= old_table->mask_; ++i) {
+    uintptr_t key = old_table->slots_[i].load(std::memory_order_relaxed);
+    if (key > kTombstone) {
+      size_t idx = Hash(key) & table->mask_;
+      while (table->slots_[idx].load(std::memory_order_relaxed) != kEmpty) {
+        idx = (idx + 1) & table->mask_;
+      }
+      table->slots_[idx].store(key, std::memory_order_relaxed);
+    }
+  }
+  used_ = live_;
+  table_.store(table.get(), std::memory_order_release);
+  tables_.push_back(std::move(table));
+}
+
+// ================================================================================================
+void StreamRegistry::Add(const Stream* stream) {
+  amd::ScopedLock lock(lock_);
+  Table* table = table_.load(std::memory_order_relaxed);
+  // Keep the load below a half, so the probes stay short. The tombstones count, since
+  // the readers have to skip them
+  if ((used_ + 1) * 2 > (table->mask_ + 1)) {
+    size_t size = kMinSlots;
+    while (size < (live_ + 1) * 4) {
+      size *= 2;
+    }
+    Rehash(size);
+    table = table_.load(std::memory_order_relaxed);
+  }
+  uintptr_t key = reinterpret_cast<uintptr_t>(stream);
+  size_t tombstone = kInvalidSlot;
+  size_t idx = Hash(key) & table->mask_;
+  for (;;) {
+    uintptr_t slot = table->slots_[idx].load(std::memory_order_relaxed);
+    if (slot == key) {
+      return;
+    }
+    if ((slot == kTombstone) && (tombstone == kInvalidSlot)) {
+      tombstone = idx;
+    }
+    if (slot == kEmpty) {
+      break;
+    }
+    idx = (idx + 1) & table->mask_;
+  }
+  // Reuse a removed slot in the probe chain, so the churn of the streams doesn't fill the table
+  if (tombstone != kInvalidSlot) {
+    idx = tombstone;
+  } else {
+    ++used_;
+  }
+  table->slots_[idx].store(key, std::memory_order_release);
+  ++live_;
+}
+
+// ================================================================================================
+void StreamRegistry::Remove(const Stream* stream) {
+  amd::ScopedLock lock(lock_);
+  Table* table = table_.load(std::memory_order_relaxed);
+  uintptr_t key = reinterpret_cast<uintptr_t>(stream);
+  for (size_t idx = Hash(key) & table->mask_;; idx = (idx + 1) & table->mask_) {
+    uintptr_t slot = table->slots_[idx].load(std::memory_order_relaxed);
+    if (slot == kEmpty) {
+      return;
+    }
+    if (slot == key) {
+      table->slots_[idx].store(kTombstone, std::memory_order_release);
+      --live_;
+      return;
+    }
+  }
+}
+
+// ================================================================================================
+bool StreamRegistry::Exists(const Stream* stream) const {
+  uintptr_t key = reinterpret_cast<uintptr_t>(stream);
+  if (key <= kTombstone) {
+    return false;
+  }
+  const Table* table = table_.load(std::memory_order_acquire);
+  for (size_t idx = Hash(key) & table->mask_;; idx = (idx + 1) & table->mask_) {
+    uintptr_t slot = table->slots_[idx].load(std::memory_order_acquire);
+    if (slot == key) {
       return true;
     }
+    if (slot == kEmpty) {
+      return false;
+    }
   }
-  return false;
 }
 
 // ================================================================================================
@@ -135,6 +276,16 @@ bool Stream::StreamCaptureBlocking() {
   return false;
 }
 
+bool Stream::GlobalCaptureOngoing() {
+  // The generation changes under the list lock, hence a stale cache is refreshed on the next call
+  if (hip::tls.capture_generation_ != g_captureStreamsGeneration.load(std::memory_order_acquire)) {
+    amd::ScopedLock lock(g_captureStreamsLock);
+    hip::tls.capture_generation_ = g_captureStreamsGeneration.load(std::memory_order_relaxed);
+    hip::tls.global_capture_ = !g_captureStreams.empty();
+  }
+  return hip::tls.global_capture_;
+}
+
 bool Stream::StreamCaptureOngoing(hipStream_t hStream) {
   if (hStream == nullptr || hStream == hipStreamLegacy) {
     return false;
@@ -147,8 +298,8 @@ bool Stream::StreamCaptureOngoing(hipStream_t hStream) {
       return false;
     }
     // If any stream in current/concurrent thread is capturing in global mode
-    amd::ScopedLock lock(g_captureStreamsLock);
-    if (!g_captureStreams.empty()) {
+    if (GlobalCaptureOngoing()) {
+      amd::ScopedLock lock(g_captureStreamsLock);
       for (auto stream : hip::g_captureStreams) {
         stream->SetCaptureStatus(hipStreamCaptureStatusInvalidated);
       }
@@ -185,6 +336,14 @@ static hipError_t ihipStreamCreate(hipStream_t* stream,
   if (flags != hipStreamDefault && flags != hipStreamNonBlocking) {
     return hipErrorInvalidValue;
   }
+  if (cuMask.empty()) {
+    // Reuse the worker thread and the HW queue of a destroyed stream
+    hip::Stream* hStream = hip::getCurrentDevice()->TakeIdleStream(priority, flags);
+    if (hStream != nullptr) {
+      *stream = reinterpret_cast<hipStream_t>(hStream);
+      return hipSuccess;
+    }
+  }
   hip::Stream* hStream = new hip::Stream(hip::getCurrentDevice(), priority, flags, false, cuMask);
 
   if (hStream == nullptr) {
@@ -416,6 +575,7 @@ hipError_t hipStreamDestroy(hipStream_t stream) {
     const auto& g_it = std::find(g_captureStreams.begin(), g_captureStreams.end(), s);
     if (g_it != g_captureStreams.end()) {
       g_captureStreams.erase(g_it);
+      g_captureStreamsGeneration++;
     }
   }
   {
@@ -430,7 +590,9 @@ hipError_t hipStreamDestroy(hipStream_t stream) {
   if (l_it != hip::tls.capture_streams_.end()) {
     hip::tls.capture_streams_.erase(l_it);
   }
-  hip::Stream::Destroy(s);
+  if (!s->GetDevice()->RecycleStream(s)) {
+    hip::Stream::Destroy(s);
+  }
 
   HIP_RETURN(hipSuccess);
 }
@@ -569,8 +731,11 @@ hipError_t streamCallback_common(hipStream_t stream, StreamCallback* cbo, void*
   if (!hip::isValid(stream)) {
     return hipErrorContextIsDestroyed;
   }
+  return ihipEnqueueStreamCallback(hip::getStream(stream), cbo);
+}
 
-  hip::Stream* hip_stream = hip::getStream(stream);
+// ================================================================================================
+hipError_t ihipEnqueueStreamCallback(hip::Stream* hip_stream, StreamCallback* cbo) {
   amd::Command* last_command = hip_stream->getLastQueuedCommand(true);
   amd::Command::EventWaitList eventWaitList;
   if (last_command != nullptr) {
@@ -796,6 +961,122 @@ hipError_t hipExtStreamGetCUMask(hipStream_t stream, uint32_t cuMaskSize, uint32
   HIP_RETURN(hipSuccess);
 }
 
+// ================================================================================================
+hipError_t hipExtStreamSetCUMask(hipStream_t stream, uint32_t cuMaskSize, const uint32_t* cuMask) {
+  HIP_INIT_API(hipExtStreamSetCUMask, stream, cuMaskSize, cuMask);
+  CHECK_STREAM_CAPTURE_SUPPORTED();
+
+  // The null stream is shared by all blocking streams and keeps the default CU set
+  if (stream == nullptr || stream == hipStreamLegacy || stream == hipStreamPerThread) {
+    HIP_RETURN(hipErrorInvalidHandle);
+  }
+  if (!hip::isValid(stream)) {
+    HIP_RETURN(hipErrorContextIsDestroyed);
+  }
+  if ((cuMaskSize != 0) && (cuMask == nullptr)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  // An empty mask restores the default CU set
+  const std::vector<uint32_t> cuMaskv(cuMask, cuMask + cuMaskSize);
+  HIP_RETURN(reinterpret_cast<hip::Stream*>(stream)->SetCUMask(cuMaskv));
+}
+
+// ================================================================================================
+hipError_t hipExtStreamsPartitionCUs(const hipStream_t* streams, const float* weights,
+                                     uint32_t numStreams) {
+  HIP_INIT_API(hipExtStreamsPartitionCUs, streams, weights, numStreams);
+  CHECK_STREAM_CAPTURE_SUPPORTED();
+
+  if ((streams == nullptr) || (numStreams == 0)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  hip::Device* device = nullptr;
+  for (uint32_t i = 0; i < numStreams; ++i) {
+    hipStream_t stream = streams[i];
+    if (stream == nullptr || stream == hipStreamLegacy || stream == hipStreamPerThread) {
+      HIP_RETURN(hipErrorInvalidHandle);
+    }
+    if (!hip::isValid(stream)) {
+      HIP_RETURN(hipErrorContextIsDestroyed);
+    }
+    // All streams split the CUs of the same device
+    hip::Device* stream_device = reinterpret_cast<hip::Stream*>(stream)->GetDevice();
+    if ((device != nullptr) && (device != stream_device)) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    device = stream_device;
+    if ((weights != nullptr) && !(weights[i] > 0.0f)) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+  }
+
+  // Collect the CUs, allowed by the global mask
+  const auto& info = device->devices()[0]->info();
+  std::vector<uint32_t> cus;
+  for (uint32_t cu = 0; cu < info.maxComputeUnits_; ++cu) {
+    if (info.globalCUMask_.empty() || (((cu / 32) < info.globalCUMask_.size()) &&
+        ((info.globalCUMask_[cu / 32] >> (cu % 32)) & 0x1))) {
+      cus.push_back(cu);
+    }
+  }
+  if (cus.size() < numStreams) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  // Split the CUs by the weights with the largest remainders, each stream gets at least one CU
+  double total_weight = 0.0;
+  for (uint32_t i = 0; i < numStreams; ++i) {
+    total_weight += (weights != nullptr) ? weights[i] : 1.0;
+  }
+  std::vector<double> quotas(numStreams);
+  std::vector<uint32_t> counts(numStreams);
+  uint32_t assigned = 0;
+  for (uint32_t i = 0; i < numStreams; ++i) {
+    quotas[i] = ((weights != nullptr) ? weights[i] : 1.0) / total_weight * cus.size();
+    counts[i] = std::max<uint32_t>(1, static_cast<uint32_t>(quotas[i]));
+    assigned += counts[i];
+  }
+  while (assigned > cus.size()) {
+    // The minimum of one CU can oversubscribe, take a CU from the most overserved stream
+    uint32_t idx = numStreams;
+    for (uint32_t i = 0; i < numStreams; ++i) {
+      if ((counts[i] > 1) && ((idx == numStreams) ||
+          ((counts[i] - quotas[i]) > (counts[idx] - quotas[idx])))) {
+        idx = i;
+      }
+    }
+    --counts[idx];
+    --assigned;
+  }
+  while (assigned < cus.size()) {
+    uint32_t idx = 0;
+    for (uint32_t i = 1; i < numStreams; ++i) {
+      if ((quotas[i] - counts[i]) > (quotas[idx] - counts[idx])) {
+        idx = i;
+      }
+    }
+    ++counts[idx];
+    ++assigned;
+  }
+
+  // ROCr spreads the consecutive mask bits across the shader engines, hence the contiguous
+  // ranges of the CUs stay balanced across the engines
+  const size_t mask_size = (info.maxComputeUnits_ + 31) / 32;
+  size_t first = 0;
+  for (uint32_t i = 0; i < numStreams; ++i) {
+    std::vector<uint32_t> mask(mask_size, 0);
+    for (size_t cu = first; cu < first + counts[i]; ++cu) {
+      mask[cus[cu] / 32] |= 1u << (cus[cu] % 32);
+    }
+    first += counts[i];
+    hipError_t status = reinterpret_cast<hip::Stream*>(streams[i])->SetCUMask(mask);
+    if (status != hipSuccess) {
+      HIP_RETURN(status);
+    }
+  }
+  HIP_RETURN(hipSuccess);
+}
+
 // ================================================================================================
 hipError_t hipStreamGetDevice(hipStream_t stream, hipDevice_t* device) {
   HIP_INIT_API(hipStreamGetDevice, stream, device);
@@ -819,4 +1100,27 @@ hipError_t hipStreamGetDevice(hipStream_t stream, hipDevice_t* device) {
 
   HIP_RETURN(hipSuccess);
 }
+
+// ================================================================================================
+hipError_t hipExtStreamGetLaunchLatency(hipStream_t stream, unsigned int interval,
+                                        uint64_t* bins, unsigned int numBins) {
+  HIP_INIT_API(hipExtStreamGetLaunchLatency, stream, interval, bins, numBins);
+
+  if ((bins == nullptr) || (numBins == 0) || (interval >= LaunchStats::kNumIntervals)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  if (!hip::isValid(stream)) {
+    HIP_RETURN(hipErrorContextIsDestroyed);
+  }
+
+  const LaunchStats* stats = hip::getStream(stream)->GetLaunchStats();
+  if (stats == nullptr) {
+    // The collection is disabled with HIP_LAUNCH_LATENCY
+    HIP_RETURN(hipErrorNotSupported);
+  }
+  stats->Histogram(interval, bins, numBins);
+
+  HIP_RETURN(hipSuccess);
+}
 } // hip namespace
@@ -1819,3 +1819,80 @@ hipError_t hipGraphNodeSetParams(hipGraphNode_t node, hipGraphNodeParams *nodePa
 hipError_t hipExtHostAlloc(void** ptr, size_t size, unsigned int flags) {
   return hip::GetHipDispatchTable()->hipExtHostAlloc_fn(ptr, size, flags);
 }
+extern "C" hipError_t hipExtStreamGetLaunchLatency(hipStream_t stream, unsigned int interval,
+                                                   uint64_t* bins, unsigned int numBins) {
+  return hip::GetHipDispatchTable()->hipExtStreamGetLaunchLatency_fn(stream, interval, bins,
+                                                                     numBins);
+}
+extern "C" hipError_t hipExtMemcpyPeerBroadcastAsync(void* const* dsts, const int* dstDevices,
+                                                     unsigned int numDsts, const void* src,
+                                                     int srcDevice, size_t sizeBytes,
+                                                     hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemcpyPeerBroadcastAsync_fn(dsts, dstDevices, numDsts,
+                                                                       src, srcDevice, sizeBytes,
+                                                                       stream);
+}
+extern "C" hipError_t hipExtMemMapBatch(void* ptr, const hipMemGenericAllocationHandle_t* handles,
+                                        const size_t* sizes, unsigned int count,
+                                        const hipMemAccessDesc* desc, size_t descCount) {
+  return hip::GetHipDispatchTable()->hipExtMemMapBatch_fn(ptr, handles, sizes, count, desc,
+                                                          descCount);
+}
+extern "C" hipError_t hipExtMemMapAsync(void* ptr, size_t size, size_t offset,
+                                        hipMemGenericAllocationHandle_t handle,
+                                        unsigned long long flags, hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemMapAsync_fn(ptr, size, offset, handle, flags,
+                                                          stream);
+}
+extern "C" hipError_t hipExtMemUnmapAsync(void* ptr, size_t size, hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemUnmapAsync_fn(ptr, size, stream);
+}
+extern "C" hipError_t hipExtDevicesSynchronize(const int* devices, unsigned int numDevices) {
+  return hip::GetHipDispatchTable()->hipExtDevicesSynchronize_fn(devices, numDevices);
+}
+extern "C" hipError_t hipExtMemPrefetchBatchAsync(const void* const* dev_ptrs,
+                                                  const size_t* counts, size_t numRanges,
+                                                  int device, hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemPrefetchBatchAsync_fn(dev_ptrs, counts, numRanges,
+                                                                    device, stream);
+}
+extern "C" hipError_t hipExtMemPrintAllocReport(hipMemPool_t mem_pool) {
+  return hip::GetHipDispatchTable()->hipExtMemPrintAllocReport_fn(mem_pool);
+}
+extern "C" hipError_t hipExtStreamSetCUMask(hipStream_t stream, uint32_t cuMaskSize,
+                                            const uint32_t* cuMask) {
+  return hip::GetHipDispatchTable()->hipExtStreamSetCUMask_fn(stream, cuMaskSize, cuMask);
+}
+extern "C" hipError_t hipExtStreamsPartitionCUs(const hipStream_t* streams, const float* weights,
+                                                uint32_t numStreams) {
+  return hip::GetHipDispatchTable()->hipExtStreamsPartitionCUs_fn(streams, weights, numStreams);
+}
+extern "C" hipError_t hipExtCreateTextureObjects(hipTextureObject_t* pTexObjects,
+                                                 const hipResourceDesc* pResDescs,
+                                                 const hipTextureDesc* pTexDescs,
+                                                 const hipResourceViewDesc* pResViewDescs,
+                                                 unsigned int numObjects) {
+  return hip::GetHipDispatchTable()->hipExtCreateTextureObjects_fn(pTexObjects, pResDescs,
+                                                                   pTexDescs, pResViewDescs,
+                                                                   numObjects);
+}
+extern "C" hipError_t hipExtMemcpyBatchAsync(void* const* dsts, const void* const* srcs,
+                                             const size_t* sizes, size_t count,
+                                             hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemcpyBatchAsync_fn(dsts, srcs, sizes, count, stream);
+}
+extern "C" hipError_t hipExtMemsetPatternAsync(void* dst, const void* pattern, size_t patternSize,
+                                               size_t count, hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemsetPatternAsync_fn(dst, pattern, patternSize, count,
+                                                                 stream);
+}
+extern "C" hipError_t hipExtHostRegisterAsync(void* hostPtr, size_t sizeBytes, unsigned int flags,
+                                              hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtHostRegisterAsync_fn(hostPtr, sizeBytes, flags, stream);
+}
+extern "C" hipError_t hipExtExternalMemoryPin(hipExternalMemory_t extMem) {
+  return hip::GetHipDispatchTable()->hipExtExternalMemoryPin_fn(extMem);
+}
+extern "C" hipError_t hipExtExternalMemoryUnpin(hipExternalMemory_t extMem) {
+  return hip::GetHipDispatchTable()->hipExtExternalMemoryUnpin_fn(extMem);
+}
@@ -20,6 +20,7 @@
 
 #include <hip/hip_runtime.h>
 #include <hip/texture_types.h>
+#include <unordered_map>
 #include "hip_internal.hpp"
 #include "hip_platform.hpp"
 #include "hip_conversions.hpp"
@@ -58,6 +59,7 @@ struct __hip_texture {
 namespace hip {
 
 hipError_t ihipFree(void* ptr);
+hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject);
 amd::Image* ihipImageCreate(const cl_channel_order channelOrder,
                             const cl_channel_type channelType,
                             const cl_mem_object_type imageType,
@@ -72,6 +74,80 @@ amd::Image* ihipImageCreate(const cl_channel_order channelOrder,
                             amd::Memory* buffer,
                             hipError_t& status);
 
+// Cache of the live texture objects. Repeated creations with the same resource, view and
+// sampler state on the same device return the existing object, and only the last destroy
+// releases the image and the sampler
+struct TextureCacheEntry {
+  hipTextureObject_t tex_object_;  //!< The shared texture object
+  uint32_t create_count_;          //!< Number of the creations, which weren't destroyed yet
+};
+static amd::Monitor textureCacheLock{};
+static std::unordered_map<std::string, TextureCacheEntry> textureCache;
+static std::unordered_map<hipTextureObject_t, std::string> textureCacheKeys;
+
+// Appends the field bytes to the cache key
+template <typename T>
+static void AppendTextureKey(std::string* key, const T& value) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Builds the cache key from the fields used by the creation, so the padding and the unused
+// union members of the descriptors don't affect the match
+static std::string GetTextureKey(const hipResourceDesc* pResDesc, const hipTextureDesc* pTexDesc,
+                                  const hipResourceViewDesc* pResViewDesc) {
+  std::string key;
+  AppendTextureKey(&key, ihipGetDevice());
+  AppendTextureKey(&key, pResDesc->resType);
+  switch (pResDesc->resType) {
+  case hipResourceTypeArray:
+  case hipResourceTypeMipmappedArray:
+    // The texture object retains the memory of the array, hence the handles stay unique
+    AppendTextureKey(&key, pResDesc->res.array.array);
+    AppendTextureKey(&key, pResDesc->res.array.array->data);
+    break;
+  case hipResourceTypeLinear: {
+    size_t offset = 0;
+    AppendTextureKey(&key, getMemoryObject(pResDesc->res.linear.devPtr, offset));
+    AppendTextureKey(&key, pResDesc->res.linear.devPtr);
+    AppendTextureKey(&key, pResDesc->res.linear.desc);
+    AppendTextureKey(&key, pResDesc->res.linear.sizeInBytes);
+    break;
+  }
+  case hipResourceTypePitch2D: {
+    size_t offset = 0;
+    AppendTextureKey(&key, getMemoryObject(pResDesc->res.pitch2D.devPtr, offset));
+    AppendTextureKey(&key, pResDesc->res.pitch2D.devPtr);
+    AppendTextureKey(&key, pResDesc->res.pitch2D.desc);
+    AppendTextureKey(&key, pResDesc->res.pitch2D.width);
+    AppendTextureKey(&key, pResDesc->res.pitch2D.height);
+    AppendTextureKey(&key, pResDesc->res.pitch2D.pitchInBytes);
+    break;
+  }
+  }
+  AppendTextureKey(&key, pTexDesc->addressMode);
+  AppendTextureKey(&key, pTexDesc->filterMode);
+  AppendTextureKey(&key, pTexDesc->readMode);
+  AppendTextureKey(&key, pTexDesc->sRGB);
+  AppendTextureKey(&key, pTexDesc->borderColor);
+  AppendTextureKey(&key, pTexDesc->normalizedCoords);
+  AppendTextureKey(&key, pTexDesc->maxAnisotropy);
+  AppendTextureKey(&key, pTexDesc->mipmapFilterMode);
+  AppendTextureKey(&key, pTexDesc->mipmapLevelBias);
+  AppendTextureKey(&key, pTexDesc->minMipmapLevelClamp);
+  AppendTextureKey(&key, pTexDesc->maxMipmapLevelClamp);
+  if (pResViewDesc != nullptr) {
+    AppendTextureKey(&key, pResViewDesc->format);
+    AppendTextureKey(&key, pResViewDesc->width);
+    AppendTextureKey(&key, pResViewDesc->height);
+    AppendTextureKey(&key, pResViewDesc->depth);
+    AppendTextureKey(&key, pResViewDesc->firstMipmapLevel);
+    AppendTextureKey(&key, pResViewDesc->lastMipmapLevel);
+    AppendTextureKey(&key, pResViewDesc->firstLayer);
+    AppendTextureKey(&key, pResViewDesc->lastLayer);
+  }
+  return key;
+}
+
 hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
                                    const hipResourceDesc* pResDesc,
                                    const hipTextureDesc* pTexDesc,
@@ -201,6 +277,18 @@ hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
     mipFilterMode = hip::getCLFilterMode(pTexDesc->mipmapFilterMode);
   }
 
+  std::string key;
+  if (HIP_TEXTURE_OBJECT_CACHE) {
+    key = GetTextureKey(pResDesc, pTexDesc, pResViewDesc);
+    amd::ScopedLock lock(textureCacheLock);
+    auto it = textureCache.find(key);
+    if (it != textureCache.end()) {
+      it->second.create_count_++;
+      *pTexObject = it->second.tex_object_;
+      return hipSuccess;
+    }
+  }
+
   amd::Sampler* sampler = new amd::Sampler(*hip::getCurrentDevice()->asContext(),
                                            pTexDesc->normalizedCoords,
                                            addressMode,
@@ -369,6 +457,14 @@ hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
   }
   *pTexObject = new (texObjectBuffer) __hip_texture{image, sampler, *pResDesc, *pTexDesc, (pResViewDesc != nullptr) ? *pResViewDesc : hipResourceViewDesc{}};
 
+  if (HIP_TEXTURE_OBJECT_CACHE) {
+    // A concurrent creation could cache the same state first, then this object stays uncached
+    amd::ScopedLock lock(textureCacheLock);
+    if (textureCache.emplace(key, TextureCacheEntry{*pTexObject, 1}).second) {
+      textureCacheKeys[*pTexObject] = key;
+    }
+  }
+
   return hipSuccess;
 }
 
@@ -381,6 +477,35 @@ hipError_t hipCreateTextureObject(hipTextureObject_t* pTexObject,
   HIP_RETURN(ihipCreateTextureObject(pTexObject, pResDesc, pTexDesc, pResViewDesc));
 }
 
+hipError_t hipExtCreateTextureObjects(hipTextureObject_t* pTexObjects,
+                                      const hipResourceDesc* pResDescs,
+                                      const hipTextureDesc* pTexDescs,
+                                      const hipResourceViewDesc* pResViewDescs,
+                                      unsigned int numObjects) {
+  HIP_INIT_API(hipExtCreateTextureObjects, pTexObjects, pResDescs, pTexDescs, pResViewDescs,
+               numObjects);
+
+  if (numObjects == 0) {
+    HIP_RETURN(hipSuccess);
+  }
+  if (pTexObjects == nullptr || pResDescs == nullptr || pTexDescs == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  for (unsigned int i = 0; i < numObjects; ++i) {
+    hipError_t status = ihipCreateTextureObject(&pTexObjects[i], &pResDescs[i], &pTexDescs[i],
+        (pResViewDescs != nullptr) ? &pResViewDescs[i] : nullptr);
+    if (status != hipSuccess) {
+      // The batch either creates all objects or none
+      for (unsigned int j = 0; j < i; ++j) {
+        ihipDestroyTextureObject(pTexObjects[j]);
+        pTexObjects[j] = nullptr;
+      }
+      HIP_RETURN(status);
+    }
+  }
+  HIP_RETURN(hipSuccess);
+}
+
 hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject) {
   if (texObject == nullptr) {
     return hipSuccess;
@@ -392,6 +517,20 @@ hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject) {
     return hipErrorNotSupported;
   }
 
+  // The cached objects are released with the last destroy
+  {
+    amd::ScopedLock lock(textureCacheLock);
+    auto key = textureCacheKeys.find(texObject);
+    if (key != textureCacheKeys.end()) {
+      auto it = textureCache.find(key->second);
+      if (--it->second.create_count_ > 0) {
+        return hipSuccess;
+      }
+      textureCache.erase(it);
+      textureCacheKeys.erase(key);
+    }
+  }
+
   if (texObject != nullptr && texObject->image) {
     texObject->image->release();
   }
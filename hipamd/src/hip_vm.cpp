@@ -33,6 +33,55 @@ static_assert(static_cast<uint32_t>(hipMemAccessFlagsProtReadWrite)
               == static_cast<uint32_t>(amd::Device::VmmAccess::kReadWrite),
               "Mem Access Flag Read Write mismatch with ROCclr!");
 
+// ================================================================================================
+PhysMemPool& PhysMemPool::Instance() {
+  // The pool is never destroyed, since the pooled memory can't be released after the devices
+  static PhysMemPool* pool = new PhysMemPool();
+  return *pool;
+}
+
+// ================================================================================================
+amd::Memory* PhysMemPool::Take(int device_id, size_t size) {
+  amd::ScopedLock lock(lock_);
+  auto it = entries_.find({device_id, size});
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  amd::Memory* phys_mem_obj = it->second;
+  entries_.erase(it);
+  pool_size_ -= size;
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Reuse physical memory %p of size %zu on device %d",
+          phys_mem_obj->getSvmPtr(), size, device_id);
+  return phys_mem_obj;
+}
+
+// ================================================================================================
+bool PhysMemPool::Put(int device_id, size_t size, amd::Memory* phys_mem_obj) {
+  amd::ScopedLock lock(lock_);
+  if ((pool_size_ + size) > (static_cast<size_t>(HIP_VMM_HANDLE_POOL_SIZE) * Mi)) {
+    return false;
+  }
+  phys_mem_obj->getUserData().data = nullptr;
+  entries_.emplace(std::make_pair(device_id, size), phys_mem_obj);
+  pool_size_ += size;
+  return true;
+}
+
+// ================================================================================================
+void PhysMemPool::Trim(int device_id) {
+  amd::ScopedLock lock(lock_);
+  amd::Context* amdContext = g_devices[device_id]->asContext();
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->first.first == device_id) {
+      pool_size_ -= it->first.second;
+      amd::SvmBuffer::free(*amdContext, it->second->getSvmPtr());
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 hipError_t hipMemAddressFree(void* devPtr, size_t size) {
   HIP_INIT_API(hipMemAddressFree, devPtr, size);
   hipError_t status = hipSuccess;
@@ -106,12 +155,30 @@ hipError_t hipMemCreate(hipMemGenericAllocationHandle_t* handle, size_t size,
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  // The shareable allocations need a new physical memory, since the handle is exported
+  if (prop->requestedHandleType == hipMemHandleTypeNone) {
+    amd::Memory* phys_mem_obj = PhysMemPool::Instance().Take(prop->location.id, size);
+    if (phys_mem_obj != nullptr) {
+      phys_mem_obj->getUserData().data = new hip::GenericAllocation(*phys_mem_obj, size, *prop);
+      *handle = reinterpret_cast<hipMemGenericAllocationHandle_t>(
+                  phys_mem_obj->getUserData().data);
+      HIP_RETURN(hipSuccess);
+    }
+  }
+
   amd::Context* amdContext = g_devices[prop->location.id]->asContext();
 
   // When ROCCLR_MEM_PHYMEM is set, ROCr impl gets and stores unique hsa handle. Flag no-op on PAL.
   void* ptr = amd::SvmBuffer::malloc(*amdContext, ROCCLR_MEM_PHYMEM, size,
                                      dev_info.memBaseAddrAlign_, nullptr);
 
+  // Release the pooled physical memory of other sizes and retry
+  if (ptr == nullptr) {
+    PhysMemPool::Instance().Trim(prop->location.id);
+    ptr = amd::SvmBuffer::malloc(*amdContext, ROCCLR_MEM_PHYMEM, size,
+                                 dev_info.memBaseAddrAlign_, nullptr);
+  }
+
   // Handle out of memory cases,
   if (ptr == nullptr) {
     size_t free = 0, total =0;
@@ -272,6 +339,131 @@ hipError_t hipMemMap(void* ptr, size_t size, size_t offset, hipMemGenericAllocat
   HIP_RETURN(hipSuccess);
 }
 
+hipError_t hipExtMemMapAsync(void* ptr, size_t size, size_t offset,
+                             hipMemGenericAllocationHandle_t handle, unsigned long long flags,
+                             hipStream_t stream) {
+  HIP_INIT_API(hipExtMemMapAsync, ptr, size, offset, handle, flags, stream);
+
+  if (ptr == nullptr || handle == nullptr || size == 0 || offset != 0 || flags != 0 ||
+      !hip::isValid(stream)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if (hip::Stream::StreamCaptureOngoing(stream)) {
+    HIP_RETURN(hipErrorStreamCaptureUnsupported);
+  }
+
+  hip::GenericAllocation* ga = reinterpret_cast<hip::GenericAllocation*>(handle);
+  ga->retain();
+
+  // The virtual range isn't accessible before the mapping, hence the earlier work in the stream
+  // doesn't have to finish and the mapping doesn't wait for it
+  hip::Stream* hip_stream = hip::getStream(stream);
+  amd::Command* cmd = new amd::VirtualMapCommand(*hip_stream, amd::Command::EventWaitList{}, ptr,
+                                                 size, &ga->asAmdMemory());
+  cmd->enqueue();
+  cmd->release();
+
+  HIP_RETURN(hipSuccess);
+}
+
+//! The objects, which an asynchronous unmap releases after the execution
+struct UnmapRelease {
+  amd::Memory* vaddr_sub_obj_;
+  hip::GenericAllocation* ga_;
+};
+
+static void UnmapReleaseCallback(cl_event event, cl_int command_exec_status, void* user_data) {
+  UnmapRelease* unmap = reinterpret_cast<UnmapRelease*>(user_data);
+  unmap->vaddr_sub_obj_->release();
+  unmap->ga_->release();
+  delete unmap;
+}
+
+hipError_t hipExtMemUnmapAsync(void* ptr, size_t size, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemUnmapAsync, ptr, size, stream);
+
+  if (ptr == nullptr || size == 0 || !hip::isValid(stream)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if (hip::Stream::StreamCaptureOngoing(stream)) {
+    HIP_RETURN(hipErrorStreamCaptureUnsupported);
+  }
+
+  amd::Memory* vaddr_sub_obj = amd::MemObjMap::FindMemObj(ptr);
+  if (vaddr_sub_obj == nullptr || vaddr_sub_obj->getSize() != size) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  amd::Memory* phys_mem_obj = vaddr_sub_obj->getUserData().phys_mem_obj;
+  if (phys_mem_obj == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  // The unmap waits for the earlier work of this stream only, with a barrier in the stream
+  hip::Stream* hip_stream = hip::getStream(stream);
+  amd::Command* cmd = new amd::VirtualMapCommand(*hip_stream, amd::Command::EventWaitList{}, ptr,
+                                                 size, nullptr);
+  UnmapRelease* unmap = new UnmapRelease{vaddr_sub_obj,
+      reinterpret_cast<hip::GenericAllocation*>(phys_mem_obj->getUserData().data)};
+  cmd->enqueue();
+
+  // The callback runs immediately, if the unmap is already done
+  if (!cmd->setCallback(CL_COMPLETE, UnmapReleaseCallback, unmap)) {
+    cmd->awaitCompletion();
+    UnmapReleaseCallback(as_cl(&cmd->event()), CL_COMPLETE, unmap);
+  }
+  cmd->release();
+
+  HIP_RETURN(hipSuccess);
+}
+
+hipError_t hipExtMemMapBatch(void* ptr, const hipMemGenericAllocationHandle_t* handles,
+                             const size_t* sizes, unsigned int count,
+                             const hipMemAccessDesc* desc, size_t descCount) {
+  HIP_INIT_API(hipExtMemMapBatch, ptr, handles, sizes, count, desc, descCount);
+
+  if (ptr == nullptr || handles == nullptr || sizes == nullptr || count == 0 ||
+      (desc == nullptr && descCount != 0)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  size_t total_size = 0;
+  for (unsigned int i = 0; i < count; ++i) {
+    if (handles[i] == nullptr || sizes[i] == 0) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    total_size += sizes[i];
+  }
+
+  // Enqueue all mappings back to back and wait only for the last command on each queue,
+  // since the null stream executes the mappings in order
+  std::map<hip::Stream*, amd::Command*> last_cmds;
+  address chunk_ptr = reinterpret_cast<address>(ptr);
+  for (unsigned int i = 0; i < count; ++i) {
+    hip::GenericAllocation* ga = reinterpret_cast<hip::GenericAllocation*>(handles[i]);
+    ga->retain();
+
+    hip::Stream* queue = g_devices[ga->GetProperties().location.id]->NullStream();
+    amd::Command* cmd = new amd::VirtualMapCommand(*queue, amd::Command::EventWaitList{},
+                                                   chunk_ptr, sizes[i], &ga->asAmdMemory());
+    cmd->enqueue();
+    auto it = last_cmds.find(queue);
+    if (it != last_cmds.end()) {
+      it->second->release();
+      it->second = cmd;
+    } else {
+      last_cmds[queue] = cmd;
+    }
+    chunk_ptr += sizes[i];
+  }
+  for (auto& it : last_cmds) {
+    it.second->awaitCompletion();
+    it.second->release();
+  }
+
+  // A single access update covers the whole mapped range
+  HIP_RETURN(ihipMemSetAccess(ptr, total_size, desc, descCount));
+}
+
 hipError_t hipMemMapArrayAsync(hipArrayMapInfo* mapInfoList, unsigned int  count, hipStream_t stream) {
   HIP_INIT_API(hipMemMapArrayAsync, mapInfoList, count, stream);
 
@@ -319,27 +511,31 @@ hipError_t hipMemRetainAllocationHandle(hipMemGenericAllocationHandle_t* handle,
   HIP_RETURN(hipSuccess);
 }
 
-hipError_t hipMemSetAccess(void* ptr, size_t size, const hipMemAccessDesc* desc, size_t count) {
-  HIP_INIT_API(hipMemSetAccess, ptr, size, desc, count);
-
-  if (ptr == nullptr || size == 0 || desc == nullptr || count == 0) {
-    HIP_RETURN(hipErrorInvalidValue);
-  }
-
+hipError_t ihipMemSetAccess(void* ptr, size_t size, const hipMemAccessDesc* desc, size_t count) {
   for (size_t desc_idx = 0; desc_idx < count; ++desc_idx) {
     if (desc[desc_idx].location.id >= g_devices.size()) {
-      HIP_RETURN(hipErrorInvalidValue)
+      return hipErrorInvalidValue;
     }
 
     auto& dev = g_devices[desc[desc_idx].location.id];
     amd::Device::VmmAccess access_flags = static_cast<amd::Device::VmmAccess>(desc[desc_idx].flags);
 
     if (!dev->devices()[0]->SetMemAccess(ptr, size, access_flags)) {
-      HIP_RETURN(hipErrorInvalidValue);
+      return hipErrorInvalidValue;
     }
   }
 
-  HIP_RETURN(hipSuccess);
+  return hipSuccess;
+}
+
+hipError_t hipMemSetAccess(void* ptr, size_t size, const hipMemAccessDesc* desc, size_t count) {
+  HIP_INIT_API(hipMemSetAccess, ptr, size, desc, count);
+
+  if (ptr == nullptr || size == 0 || desc == nullptr || count == 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  HIP_RETURN(ihipMemSetAccess(ptr, size, desc, count));
 }
 
 hipError_t hipMemUnmap(void* ptr, size_t size) {
@@ -26,9 +26,34 @@
 
 #include "platform/object.hpp"
 
+#include <map>
+
 namespace hip {
 
 hipError_t ihipFree(void* ptr);
+hipError_t ihipMemSetAccess(void* ptr, size_t size, const hipMemAccessDesc* desc, size_t count);
+
+//! Pool of the released physical allocations, reused by hipMemCreate of the same size and
+//! location. It saves the physical memory creation in the applications, which grow and shrink
+//! the virtual ranges in the chunks of a fixed size.
+class PhysMemPool {
+public:
+  static PhysMemPool& Instance();
+
+  //! Returns a pooled physical memory object of the size on the device, nullptr on a miss
+  amd::Memory* Take(int device_id, size_t size);
+  //! Keeps the physical memory object for a reuse, returns false if the pool is full
+  bool Put(int device_id, size_t size, amd::Memory* phys_mem_obj);
+  //! Frees all pooled physical memory objects of the device
+  void Trim(int device_id);
+
+private:
+  PhysMemPool() : lock_("Physical memory pool lock", true), pool_size_(0) {}
+
+  amd::Monitor lock_;                                             //!< Pool lock
+  std::multimap<std::pair<int, size_t>, amd::Memory*> entries_;   //!< Pooled memory objects
+  size_t pool_size_;                                              //!< Total pooled size
+};
 
 class GenericAllocation : public amd::RuntimeObject {
   amd::Memory& phys_mem_ref_;        //<! Physical memory object
@@ -39,6 +64,12 @@ public:
   GenericAllocation(amd::Memory& phys_mem_ref, size_t size, const hipMemAllocationProp& prop)
                     : phys_mem_ref_(phys_mem_ref), size_(size), properties_(prop) {}
   ~GenericAllocation() {
+    // Only the allocations, which can't be shared with the other processes, are reused.
+    // The imported allocations have zero size
+    if ((size_ != 0) && (properties_.requestedHandleType == hipMemHandleTypeNone) &&
+        PhysMemPool::Instance().Put(properties_.location.id, size_, &phys_mem_ref_)) {
+      return;
+    }
     amd::Context* amdContext = g_devices[properties_.location.id]->asContext();
     amd::SvmBuffer::free(*amdContext, phys_mem_ref_.getSvmPtr());
   }
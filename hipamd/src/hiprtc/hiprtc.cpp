@@ -23,6 +23,8 @@ THE SOFTWARE.
 #include <hip/hiprtc.h>
 #include "hiprtcInternal.hpp"
 
+#include <cctype>
+
 namespace hiprtc {
 thread_local TlsAggregator tls;
 }
@@ -380,6 +382,48 @@ hiprtcResult hiprtcLinkAddData(hiprtcLinkState hip_link_state, hiprtcJITInputTyp
   HIPRTC_RETURN(HIPRTC_SUCCESS);
 }
 
+// The names must be the C identifiers, the kernel bitcode declares the constants with the same
+// names. The prototype is declared extern "C" in hiprtc.h.
+extern "C" hiprtcResult hiprtcLinkAddSpecializationConstants(hiprtcLinkState hip_link_state,
+                                                             unsigned int num_constants,
+                                                             const char** names,
+                                                             const void** values,
+                                                             const size_t* sizes) {
+  HIPRTC_INIT_API(hip_link_state, num_constants, names, values, sizes);
+
+  if (num_constants == 0 || names == nullptr || values == nullptr || sizes == nullptr) {
+    HIPRTC_RETURN(HIPRTC_ERROR_INVALID_INPUT);
+  }
+
+  for (unsigned int i = 0; i < num_constants; ++i) {
+    if (names[i] == nullptr || values[i] == nullptr || sizes[i] == 0) {
+      HIPRTC_RETURN(HIPRTC_ERROR_INVALID_INPUT);
+    }
+    const char* c = names[i];
+    if (!std::isalpha(static_cast<unsigned char>(*c)) && *c != '_') {
+      HIPRTC_RETURN(HIPRTC_ERROR_INVALID_INPUT);
+    }
+    for (++c; *c != '\0'; ++c) {
+      if (!std::isalnum(static_cast<unsigned char>(*c)) && *c != '_') {
+        HIPRTC_RETURN(HIPRTC_ERROR_INVALID_INPUT);
+      }
+    }
+  }
+
+  hiprtc::RTCLinkProgram* rtc_link_prog_ptr =
+      reinterpret_cast<hiprtc::RTCLinkProgram*>(hip_link_state);
+
+  if (!hiprtc::RTCLinkProgram::isLinkerValid(rtc_link_prog_ptr)) {
+    HIPRTC_RETURN(HIPRTC_ERROR_INVALID_INPUT);
+  }
+
+  if (!rtc_link_prog_ptr->AddSpecializationConstants(num_constants, names, values, sizes)) {
+    HIPRTC_RETURN(HIPRTC_ERROR_PROGRAM_CREATION_FAILURE);
+  }
+
+  HIPRTC_RETURN(HIPRTC_SUCCESS);
+}
+
 hiprtcResult hiprtcLinkComplete(hiprtcLinkState hip_link_state, void** bin_out, size_t* size_out) {
   HIPRTC_INIT_API(hip_link_state, bin_out, size_out);
 
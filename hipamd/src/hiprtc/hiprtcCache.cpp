@@ -0,0 +1,212 @@
+/*
+Copyright (c) 2026 - Present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "hiprtcCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <tuple>
+
+#include "top.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+namespace hiprtc {
+namespace fs = std::filesystem;
+
+namespace {
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+// Offset basis of the second hash, to make it differ from the first one
+constexpr uint64_t kFnvOffsetBasisHi = 0x84222325cbf29ce4ULL;
+
+// Cache entry header
+struct EntryHeader {
+  uint32_t magic_;    // kEntryMagic
+  uint32_t version_;  // kEntryVersion
+  uint64_t size_;     // Size of the code object after the header
+};
+constexpr uint32_t kEntryMagic = 0x43545248;  // "HRTC"
+constexpr uint32_t kEntryVersion = 1;
+constexpr const char* kEntryExtension = ".hiprtc";
+}  // namespace
+
+CacheKey::CacheKey() : lo_(kFnvOffsetBasis), hi_(kFnvOffsetBasisHi), size_(0) {}
+
+void CacheKey::add(const void* data, size_t size) {
+  // Hash the block size first, so the boundaries between the blocks are a part of the key
+  uint64_t block_size = size;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&block_size);
+  for (size_t i = 0; i < sizeof(block_size); ++i) {
+    lo_ = (lo_ ^ bytes[i]) * kFnvPrime;
+    hi_ = (hi_ ^ bytes[i] ^ (size_ + i)) * kFnvPrime;
+  }
+  size_ += sizeof(block_size);
+
+  bytes = reinterpret_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    lo_ = (lo_ ^ bytes[i]) * kFnvPrime;
+    hi_ = (hi_ ^ bytes[i] ^ (size_ + i)) * kFnvPrime;
+  }
+  size_ += size;
+}
+
+void CacheKey::add(const std::vector<std::string>& strs) {
+  add(static_cast<uint64_t>(strs.size()));
+  for (const auto& str : strs) {
+    add(str);
+  }
+}
+
+std::string CacheKey::str() const {
+  char buffer[3 * 16 + 1];
+  snprintf(buffer, sizeof(buffer), "%016llx%016llx%016llx", static_cast<unsigned long long>(lo_),
+           static_cast<unsigned long long>(hi_), static_cast<unsigned long long>(size_));
+  return buffer;
+}
+
+CodeCache* CodeCache::get() {
+  static CodeCache* cache = nullptr;
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    std::string path = HIPRTC_CACHE_PATH;
+    if (path.empty()) {
+      return;
+    }
+    std::error_code ec;
+    fs::create_directories(path, ec);
+    if (!fs::is_directory(path, ec)) {
+      LogPrintfError("hiprtc cache: unable to use the cache directory %s", path.c_str());
+      return;
+    }
+    cache = new CodeCache(path, static_cast<uint64_t>(HIPRTC_CACHE_SIZE) * Mi);
+  });
+  return cache;
+}
+
+std::string CodeCache::fileName(const CacheKey& key) const {
+  return (fs::path(path_) / (key.str() + kEntryExtension)).string();
+}
+
+bool CodeCache::load(const CacheKey& key, std::vector<char>& code) {
+  std::string file_name = fileName(key);
+  std::ifstream file(file_name, std::ios_base::in | std::ios_base::binary);
+  if (!file.good()) {
+    LogPrintfInfo("hiprtc cache miss: %s", key.str().c_str());
+    return false;
+  }
+
+  EntryHeader header = {};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file.good() || (header.magic_ != kEntryMagic) || (header.version_ != kEntryVersion)) {
+    LogPrintfInfo("hiprtc cache miss: %s has an invalid header", file_name.c_str());
+    return false;
+  }
+  code.resize(header.size_);
+  file.read(code.data(), header.size_);
+  if (static_cast<uint64_t>(file.gcount()) != header.size_) {
+    LogPrintfInfo("hiprtc cache miss: %s is truncated", file_name.c_str());
+    code.clear();
+    return false;
+  }
+  file.close();
+
+  // Refresh the entry time for the LRU eviction
+  std::error_code ec;
+  fs::last_write_time(file_name, fs::file_time_type::clock::now(), ec);
+  LogPrintfInfo("hiprtc cache hit: %s, %zu bytes", key.str().c_str(), code.size());
+  return true;
+}
+
+void CodeCache::store(const CacheKey& key, const std::vector<char>& code) {
+  static std::atomic<uint32_t> counter{0};
+  std::string file_name = fileName(key);
+  // The temporary name is unique across the threads and the processes
+  std::string tmp_name = file_name + "." + std::to_string(amd::Os::getProcessId()) + "." +
+                         std::to_string(counter++) + ".tmp";
+  {
+    std::ofstream file(tmp_name, std::ios_base::out | std::ios_base::binary |
+                       std::ios_base::trunc);
+    EntryHeader header = {kEntryMagic, kEntryVersion, code.size()};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(code.data(), code.size());
+    file.close();
+    if (!file.good()) {
+      LogPrintfInfo("hiprtc cache: unable to write %s", tmp_name.c_str());
+      std::error_code ec;
+      fs::remove(tmp_name, ec);
+      return;
+    }
+  }
+
+  // Rename replaces the entry atomically, if another process stored the same key meanwhile
+  std::error_code ec;
+  fs::rename(tmp_name, file_name, ec);
+  if (ec) {
+    LogPrintfInfo("hiprtc cache: unable to store %s", file_name.c_str());
+    fs::remove(tmp_name, ec);
+    return;
+  }
+  LogPrintfInfo("hiprtc cache store: %s, %zu bytes", key.str().c_str(), code.size());
+  evict();
+}
+
+void CodeCache::evict() {
+  std::vector<std::tuple<fs::file_time_type, uint64_t, fs::path>> entries;
+  uint64_t total_size = 0;
+  std::error_code ec;
+  for (fs::directory_iterator it(path_, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() != kEntryExtension) {
+      continue;
+    }
+    std::error_code entry_ec;
+    uint64_t size = it->file_size(entry_ec);
+    fs::file_time_type time = it->last_write_time(entry_ec);
+    if (!entry_ec) {
+      entries.emplace_back(time, size, it->path());
+      total_size += size;
+    }
+  }
+  if (total_size <= max_size_) {
+    return;
+  }
+
+  // Remove the oldest entries first. Another process may remove the same entries concurrently,
+  // hence the failures are ignored
+  std::sort(entries.begin(), entries.end());
+  for (const auto& entry : entries) {
+    if (total_size <= max_size_) {
+      break;
+    }
+    std::error_code entry_ec;
+    fs::remove(std::get<2>(entry), entry_ec);
+    total_size -= std::get<1>(entry);
+    LogPrintfInfo("hiprtc cache evict: %s", std::get<2>(entry).string().c_str());
+  }
+}
+
+}  // namespace hiprtc
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2026 - Present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hiprtc {
+
+// Key of the compiled code in the disk cache. It accumulates everything the compilation output
+// depends on: the sources, the headers, the options, the target ISA and the compiler version.
+class CacheKey {
+ public:
+  CacheKey();
+
+  // Adds a block of data into the key
+  void add(const void* data, size_t size);
+  void add(const std::string& str) { add(str.data(), str.size()); }
+  void add(const std::vector<char>& data) { add(data.data(), data.size()); }
+  void add(const std::vector<std::string>& strs);
+  void add(uint64_t value) { add(&value, sizeof(value)); }
+
+  // Returns the key as a file name
+  std::string str() const;
+
+ private:
+  uint64_t lo_;  // FNV-1a hash of the data
+  uint64_t hi_;  // FNV-1a hash of the data with the mixed in positions
+  uint64_t size_;  // Total size of the data
+};
+
+// Disk cache of the compiled code objects, shared between the processes. The entries are
+// written into temporary files and renamed, so the readers never observe a partial entry.
+// The least recently used entries are evicted, when the cache grows above the size limit.
+class CodeCache {
+ public:
+  // Returns the cache, nullptr if the cache is disabled
+  static CodeCache* get();
+
+  // Loads the cached code object, returns true on a hit
+  bool load(const CacheKey& key, std::vector<char>& code);
+
+  // Stores the code object into the cache
+  void store(const CacheKey& key, const std::vector<char>& code);
+
+ private:
+  CodeCache(const std::string& path, uint64_t max_size) : path_(path), max_size_(max_size) {}
+
+  // Removes the least recently used entries above the size limit
+  void evict();
+
+  // Returns the full file name for the key
+  std::string fileName(const CacheKey& key) const;
+
+  std::string path_;   // Cache directory
+  uint64_t max_size_;  // Size limit in bytes
+};
+
+}  // namespace hiprtc
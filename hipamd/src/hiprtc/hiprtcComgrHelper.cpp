@@ -814,6 +814,44 @@ bool compileToBitCode(const amd_comgr_data_set_t compileInputs, const std::strin
   return true;
 }
 
+// Compiles the sources without the device libraries, the precompiled headers and the small
+// helper modules don't need them
+bool compileToPlainBitCode(const amd_comgr_data_set_t compileInputs, const std::string& isa,
+                           std::vector<std::string>& compileOptions, std::string& buildLog,
+                           std::vector<char>& bitcode) {
+  amd_comgr_action_info_t action;
+  amd_comgr_data_set_t output;
+
+  if (auto res = createAction(action, compileOptions, isa, AMD_COMGR_LANGUAGE_HIP);
+      res != AMD_COMGR_STATUS_SUCCESS) {
+    return false;
+  }
+
+  if (auto res = amd::Comgr::create_data_set(&output); res != AMD_COMGR_STATUS_SUCCESS) {
+    amd::Comgr::destroy_action_info(action);
+    return false;
+  }
+
+  if (auto res = amd::Comgr::do_action(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, action,
+                                       compileInputs, output);
+      res != AMD_COMGR_STATUS_SUCCESS) {
+    extractBuildLog(output, buildLog);
+    amd::Comgr::destroy_action_info(action);
+    amd::Comgr::destroy_data_set(output);
+    return false;
+  }
+
+  if (!extractByteCodeBinary(output, AMD_COMGR_DATA_KIND_BC, bitcode)) {
+    amd::Comgr::destroy_action_info(action);
+    amd::Comgr::destroy_data_set(output);
+    return false;
+  }
+
+  amd::Comgr::destroy_action_info(action);
+  amd::Comgr::destroy_data_set(output);
+  return true;
+}
+
 bool linkLLVMBitcode(const amd_comgr_data_set_t linkInputs, const std::string& isa,
                      std::vector<std::string>& linkOptions, std::string& buildLog,
                      std::vector<char>& LinkedLLVMBitcode) {
@@ -48,6 +48,9 @@ bool compileToExecutable(const amd_comgr_data_set_t compileInputs, const std::st
 bool compileToBitCode(const amd_comgr_data_set_t compileInputs, const std::string& isa,
                       std::vector<std::string>& compileOptions, std::string& buildLog,
                       std::vector<char>& LLVMBitcode);
+bool compileToPlainBitCode(const amd_comgr_data_set_t compileInputs, const std::string& isa,
+                           std::vector<std::string>& compileOptions, std::string& buildLog,
+                           std::vector<char>& output);
 bool linkLLVMBitcode(const amd_comgr_data_set_t linkInputs, const std::string& isa,
                      std::vector<std::string>& linkOptions, std::string& buildLog,
                      std::vector<char>& LinkedLLVMBitcode);
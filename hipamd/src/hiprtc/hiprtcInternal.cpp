@@ -22,8 +22,12 @@ THE SOFTWARE.
 
 #include "hiprtcInternal.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <memory>
 #include <streambuf>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <sys/stat.h>
@@ -64,6 +68,15 @@ RTCProgram::RTCProgram(std::string name) : name_(name) {
   }
 }
 
+void RTCProgram::AddTargetToKey(CacheKey& key) const {
+  size_t major = 0, minor = 0;
+  amd::Comgr::get_version(&major, &minor);
+  key.add(static_cast<uint64_t>(major));
+  key.add(static_cast<uint64_t>(minor));
+  key.add(static_cast<uint64_t>(HIP_VERSION));
+  key.add(isa_);
+}
+
 bool RTCProgram::findIsa() {
 
 #ifdef BUILD_SHARED_LIBS
@@ -225,6 +238,9 @@ bool RTCCompileProgram::addHeader(const std::string& source, const std::string&
   if (!addCodeObjData(compile_input_, vsource, name, AMD_COMGR_DATA_KIND_INCLUDE)) {
     return false;
   }
+  headers_key_.add(name);
+  headers_key_.add(vsource);
+  header_names_.push_back(name);
   return true;
 }
 
@@ -234,6 +250,8 @@ bool RTCCompileProgram::addBuiltinHeader() {
   if (!addCodeObjData(compile_input_, source, name, AMD_COMGR_DATA_KIND_INCLUDE)) {
     return false;
   }
+  headers_key_.add(name);
+  headers_key_.add(source);
   return true;
 }
 
@@ -305,6 +323,34 @@ bool RTCCompileProgram::transformOptions(std::vector<std::string>& compile_optio
 // HIPRTC Program lock
 amd::Monitor RTCProgram::lock_(true);
 
+CompileBudget::CompileBudget() : lock_(true), active_(0) {
+  budget_ = (HIPRTC_MAX_PARALLEL_COMPILES != 0) ? HIPRTC_MAX_PARALLEL_COMPILES
+                                                 : std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void CompileBudget::acquire() {
+  amd::ScopedLock lock(lock_);
+  while (active_ >= budget_) {
+    lock_.wait();
+  }
+  ++active_;
+}
+
+void CompileBudget::release() {
+  amd::ScopedLock lock(lock_);
+  --active_;
+  lock_.notify();
+}
+
+static CompileBudget& compileBudget() {
+  static CompileBudget budget;
+  return budget;
+}
+
+CompileBudget::Scoped::Scoped() { compileBudget().acquire(); }
+
+CompileBudget::Scoped::~Scoped() { compileBudget().release(); }
+
 bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fgpu_rdc) {
   if (!addSource_impl()) {
     LogError("Error in hiprtc: unable to add source code");
@@ -323,31 +369,165 @@ bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fg
     return false;
   }
 
+  // Check the disk cache before the compilation
+  CodeCache* cache = CodeCache::get();
+  CacheKey key = headers_key_;
+  auto& compile_output = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+  bool cached = false;
+  if (cache != nullptr) {
+    AddTargetToKey(key);
+    key.add(static_cast<uint64_t>(fgpu_rdc_));
+    key.add(compileOpts);
+    key.add(link_options_);
+    key.add(source_name_);
+    key.add(source_code_);
+    cached = cache->load(key, compile_output);
+  }
+
+  CompileBudget::Scoped budget;
+  if (cached) {
+    build_log_.clear();
+  } else {
+    std::vector<std::string> pchOpts(compileOpts);
+    bool compiled = false;
+    if (HIPRTC_USE_PCH && addPrecompiledHeader(pchOpts)) {
+      compiled = compileSource(pchOpts);
+      if (!compiled) {
+        // The source may rely on the headers not being included up front
+        LogInfo("hiprtc: compilation with the precompiled header failed, retrying without it");
+        amd::Comgr::data_set_remove(compile_input_, AMD_COMGR_DATA_KIND_PRECOMPILED_HEADER);
+        build_log_.clear();
+      }
+    }
+    if (!compiled && !compileSource(compileOpts)) {
+      return false;
+    }
+  }
+  if ((cache != nullptr) && !cached) {
+    cache->store(key, compile_output);
+  }
+
+  if (!mangled_names_.empty()) {
+    auto& compile_step_output = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+    if (!fillMangledNames(compile_step_output, mangled_names_, fgpu_rdc_)) {
+      LogError("Error in hiprtc: unable to fill mangled names");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+bool RTCCompileProgram::compileSource(std::vector<std::string>& compile_options) {
   if (fgpu_rdc_) {
-    if (!compileToBitCode(compile_input_, isa_, compileOpts, build_log_, LLVMBitcode_)) {
+    if (!compileToBitCode(compile_input_, isa_, compile_options, build_log_, LLVMBitcode_)) {
       LogError("Error in hiprtc: unable to compile source to bitcode");
       return false;
     }
   } else {
     LogInfo("Using the new path of comgr");
-    if (!compileToExecutable(compile_input_, isa_, compileOpts, link_options_, build_log_,
+    if (!compileToExecutable(compile_input_, isa_, compile_options, link_options_, build_log_,
                              executable_)) {
       LogError("Failing to compile to realloc");
       return false;
     }
   }
+  return true;
+}
 
-  if (!mangled_names_.empty()) {
-    auto& compile_step_output = fgpu_rdc_ ? LLVMBitcode_ : executable_;
-    if (!fillMangledNames(compile_step_output, mangled_names_, fgpu_rdc_)) {
-      LogError("Error in hiprtc: unable to fill mangled names");
-      return false;
+bool RTCCompileProgram::addPrecompiledHeader(std::vector<std::string>& compile_options) {
+  // The programs with the same headers, options and target share the precompiled header
+  CacheKey key = headers_key_;
+  AddTargetToKey(key);
+  key.add(compile_options);
+  key.add(std::string("pch"));
+  const std::string name = key.str();
+
+  // An empty entry marks a header set, which can't be precompiled
+  static std::mutex pch_lock;
+  static std::unordered_map<std::string, std::shared_ptr<const std::vector<char>>> pchs;
+  std::shared_ptr<const std::vector<char>> pch;
+  {
+    std::lock_guard<std::mutex> lock(pch_lock);
+    auto it = pchs.find(name);
+    if (it != pchs.end()) {
+      pch = it->second;
     }
   }
+  if (pch == nullptr) {
+    auto built = std::make_shared<std::vector<char>>();
+    CodeCache* cache = CodeCache::get();
+    if ((cache == nullptr) || !cache->load(key, *built)) {
+      if (buildPrecompiledHeader(compile_options, *built) && (cache != nullptr)) {
+        cache->store(key, *built);
+      }
+    }
+    pch = built;
+    std::lock_guard<std::mutex> lock(pch_lock);
+    pchs.emplace(name, pch);
+  }
+  if (pch->empty() ||
+      !addCodeObjData(compile_input_, *pch, "hiprtc.pch", AMD_COMGR_DATA_KIND_PRECOMPILED_HEADER)) {
+    return false;
+  }
 
+  // The precompiled header already contains the builtin header
+  for (size_t i = 0; i + 1 < compile_options.size(); ++i) {
+    if ((compile_options[i] == "-include") && (compile_options[i + 1] == "hiprtc_runtime.h")) {
+      compile_options.erase(compile_options.begin() + i, compile_options.begin() + i + 2);
+      break;
+    }
+  }
+  LogPrintfInfo("hiprtc: using the precompiled header %s, %zu bytes", name.c_str(),
+                pch->size());
   return true;
 }
 
+bool RTCCompileProgram::buildPrecompiledHeader(const std::vector<std::string>& compile_options,
+                                               std::vector<char>& pch) {
+  amd_comgr_data_set_t pch_input;
+  if (amd::Comgr::create_data_set(&pch_input) != AMD_COMGR_STATUS_SUCCESS) {
+    return false;
+  }
+  // The header data is shared with the compile inputs
+  size_t count = 0;
+  bool result = (amd::Comgr::action_data_count(compile_input_, AMD_COMGR_DATA_KIND_INCLUDE,
+                                               &count) == AMD_COMGR_STATUS_SUCCESS);
+  for (size_t i = 0; result && (i < count); ++i) {
+    amd_comgr_data_t data;
+    result = (amd::Comgr::action_data_get_data(compile_input_, AMD_COMGR_DATA_KIND_INCLUDE, i,
+                                               &data) == AMD_COMGR_STATUS_SUCCESS);
+    if (result) {
+      result = (amd::Comgr::data_set_add(pch_input, data) == AMD_COMGR_STATUS_SUCCESS);
+      amd::Comgr::release_data(data);
+    }
+  }
+  std::string source;
+  for (const auto& name : header_names_) {
+    source += "#include \"" + name + "\"\n";
+  }
+  // The builtin header comes from the -include option, the source may be empty
+  source += "\n";
+  std::vector<char> vsource(source.begin(), source.end());
+  result = result &&
+           addCodeObjData(pch_input, vsource, "hiprtc_pch.hip", AMD_COMGR_DATA_KIND_SOURCE);
+
+  std::vector<std::string> pch_options(compile_options);
+  pch_options.push_back("-Xclang");
+  pch_options.push_back("-emit-pch");
+  std::string log;
+  // The frontend writes the PCH instead of the bitcode, the action returns it as the bitcode
+  if (result && !compileToPlainBitCode(pch_input, isa_, pch_options, log, pch)) {
+    LogPrintfInfo("hiprtc: unable to build the precompiled header: %s", log.c_str());
+    result = false;
+  }
+  amd::Comgr::destroy_data_set(pch_input);
+  if (!result) {
+    pch.clear();
+  }
+  return result;
+}
 
 void RTCCompileProgram::stripNamedExpression(std::string& strippedName) {
   if (strippedName.back() == ')') {
@@ -606,6 +786,9 @@ bool RTCLinkProgram::AddLinkerDataImpl(std::vector<char>& link_data, hiprtcJITIn
     LogError("Error in hiprtc: unable to add linked code object");
     return false;
   }
+  inputs_key_.add(static_cast<uint64_t>(data_kind));
+  inputs_key_.add(link_file_name);
+  inputs_key_.add(llvm_bitcode);
 
   return true;
 }
@@ -639,6 +822,62 @@ bool RTCLinkProgram::AddLinkerData(void* image_ptr, size_t image_size, std::stri
   return AddLinkerDataImpl(bundled_llvm_bitcode, input_type, link_file_name);
 }
 
+bool RTCLinkProgram::AddSpecializationConstants(unsigned int num_constants, const char** names,
+                                                const void** values, const size_t* sizes) {
+  if (!findIsa()) {
+    return false;
+  }
+
+  // The constants are defined as the byte arrays with the C names. The kernels declare them as
+  // extern "C" __constant__ const T name; and the IR link resolves the declarations, so the
+  // optimizations in the codegen of LinkComplete fold the loads of the values.
+  std::string source;
+  char byte[8];
+  for (unsigned int i = 0; i < num_constants; ++i) {
+    source += "extern \"C\" __attribute__((used, device, constant)) const unsigned char ";
+    source += names[i];
+    source += "[" + std::to_string(sizes[i]) + "] = {";
+    const unsigned char* value = reinterpret_cast<const unsigned char*>(values[i]);
+    for (size_t j = 0; j < sizes[i]; ++j) {
+      snprintf(byte, sizeof(byte), "%s0x%02x", (j == 0) ? "" : ", ", value[j]);
+      source += byte;
+    }
+    source += "};\n";
+  }
+
+  amd_comgr_data_set_t constants_input;
+  if (amd::Comgr::create_data_set(&constants_input) != AMD_COMGR_STATUS_SUCCESS) {
+    return false;
+  }
+  std::vector<char> vsource(source.begin(), source.end());
+  // The module has no includes, skip the runtime headers and the device libraries
+  std::vector<std::string> options = {"-O3", "-fgpu-rdc", "-nogpuinc", "-nogpulib"};
+  std::vector<char> bitcode;
+  std::string log;
+  bool result =
+      addCodeObjData(constants_input, vsource, "hiprtc_constants.hip", AMD_COMGR_DATA_KIND_SOURCE);
+  if (result && !compileToPlainBitCode(constants_input, isa_, options, log, bitcode)) {
+    LogPrintfError("Error in hiprtc: unable to compile the specialization constants: %s",
+                   log.c_str());
+    result = false;
+  }
+  amd::Comgr::destroy_data_set(constants_input);
+  if (!result) {
+    return false;
+  }
+
+  std::string constants_name = "hiprtc_constants_" + std::to_string(constants_count_++) + ".bc";
+  if (!addCodeObjData(link_input_, bitcode, constants_name, AMD_COMGR_DATA_KIND_BC)) {
+    LogError("Error in hiprtc: unable to add the specialization constants");
+    return false;
+  }
+  inputs_key_.add(static_cast<uint64_t>(AMD_COMGR_DATA_KIND_BC));
+  inputs_key_.add(constants_name);
+  inputs_key_.add(source);
+
+  return true;
+}
+
 bool RTCLinkProgram::LinkComplete(void** bin_out, size_t* size_out) {
   if (!findIsa()) {
     return false;
@@ -646,6 +885,22 @@ bool RTCLinkProgram::LinkComplete(void** bin_out, size_t* size_out) {
 
   AppendLinkerOptions();
 
+  // Check the disk cache before the link
+  std::vector<std::string> exe_options = getLinkOptions(link_args_);
+  CodeCache* cache = CodeCache::get();
+  CacheKey key = inputs_key_;
+  if (cache != nullptr) {
+    AddTargetToKey(key);
+    key.add(link_options_);
+    key.add(exe_options);
+    if (cache->load(key, executable_)) {
+      *size_out = executable_.size();
+      *bin_out = executable_.data();
+      return true;
+    }
+  }
+
+  CompileBudget::Scoped budget;
   std::vector<char> linked_llvm_bitcode;
   if (!linkLLVMBitcode(link_input_, isa_, link_options_, build_log_, linked_llvm_bitcode)) {
     LogError("Error in hiprtc: unable to add device libs to linked bitcode");
@@ -658,7 +913,6 @@ bool RTCLinkProgram::LinkComplete(void** bin_out, size_t* size_out) {
     return false;
   }
 
-  std::vector<std::string> exe_options = getLinkOptions(link_args_);
   LogPrintfInfo("Exe options forwarded to compiler: %s",
                 [&]() {
                   std::string ret;
@@ -673,6 +927,9 @@ bool RTCLinkProgram::LinkComplete(void** bin_out, size_t* size_out) {
     LogPrintfInfo("Error in hiprtc: unable to create exectuable: %s", build_log_.c_str());
     return false;
   }
+  if (cache != nullptr) {
+    cache->store(key, executable_);
+  }
 
   *size_out = executable_.size();
   *bin_out = executable_.data();
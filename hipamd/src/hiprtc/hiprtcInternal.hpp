@@ -45,6 +45,7 @@ extern unsigned __hipRTC_header_size;
 #endif
 
 #include "hiprtcComgrHelper.hpp"
+#include "hiprtcCache.hpp"
 
 namespace hiprtc {
 namespace internal {
@@ -82,9 +83,11 @@ static amd::Monitor g_hiprtcInitlock{};
             " This may be due to insufficient memory.");                                           \
     HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                    \
   }                                                                                                \
-  amd::ScopedLock lock(g_hiprtcInitlock);                                                          \
-  if (!amd::Flag::init()) {                                                                        \
-    HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                    \
+  {                                                                                                \
+    amd::ScopedLock lock(g_hiprtcInitlock);                                                        \
+    if (!amd::Flag::init()) {                                                                      \
+      HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                  \
+    }                                                                                              \
   }
 
 #define HIPRTC_INIT_API(...)                                                                       \
@@ -112,6 +115,30 @@ struct Settings {
   bool offloadArchProvided{false};
 };
 
+// Limits the number of comgr compilations and links, which run in parallel in the process.
+// The programs compile concurrently from the application threads, up to the thread budget.
+class CompileBudget {
+ public:
+  CompileBudget();
+
+  // Waits for a free slot in the budget
+  void acquire();
+  // Returns the slot into the budget
+  void release();
+
+  // Holds a slot of the global budget in the current scope
+  class Scoped {
+   public:
+    Scoped();
+    ~Scoped();
+  };
+
+ private:
+  amd::Monitor lock_;  // Budget access lock
+  uint32_t budget_;    // The maximum number of parallel compilations
+  uint32_t active_;    // The number of running compilations
+};
+
 class RTCProgram {
  protected:
   // Lock and control variables
@@ -124,6 +151,8 @@ class RTCProgram {
   // Member Functions
   bool findIsa();
   static void AppendOptions(std::string app_env_var, std::vector<std::string>* options);
+  // Adds the compiler version and the target ISA into the cache key
+  void AddTargetToKey(CacheKey& key) const;
 
   // Data Members
   std::string name_;
@@ -151,9 +180,19 @@ class RTCCompileProgram : public RTCProgram {
   bool fgpu_rdc_;
   std::vector<char> LLVMBitcode_;
 
+  // Cache key of the headers
+  CacheKey headers_key_;
+
+  // Names of the headers added by the app, the precompiled header includes them in this order
+  std::vector<std::string> header_names_;
+
   // Private Member functions
   bool addSource_impl();
   bool addBuiltinHeader();
+  bool compileSource(std::vector<std::string>& compile_options);
+  bool addPrecompiledHeader(std::vector<std::string>& compile_options);
+  bool buildPrecompiledHeader(const std::vector<std::string>& compile_options,
+                              std::vector<char>& pch);
   bool transformOptions(std::vector<std::string>& compile_options);
   bool findExeOptions(const std::vector<std::string>& options,
                       std::vector<std::string>& exe_options);
@@ -271,6 +310,12 @@ class RTCLinkProgram : public RTCProgram {
   std::vector<std::string> link_options_;
   static std::unordered_set<RTCLinkProgram*> linker_set_;
 
+  // Cache key of the linker inputs
+  CacheKey inputs_key_;
+
+  // Number of the added specialization constant modules
+  uint32_t constants_count_ = 0;
+
   bool AddLinkerDataImpl(std::vector<char>& link_data, hiprtcJITInputType input_type,
                          std::string& link_file_name);
 
@@ -287,6 +332,9 @@ class RTCLinkProgram : public RTCProgram {
   bool AddLinkerFile(std::string file_path, hiprtcJITInputType input_type);
   bool AddLinkerData(void* image_ptr, size_t image_size, std::string link_file_name,
                      hiprtcJITInputType input_type);
+  // Links the definitions of the constants, declared extern in the bitcode of the program
+  bool AddSpecializationConstants(unsigned int num_constants, const char** names,
+                                  const void** values, const size_t* sizes);
   bool LinkComplete(void** bin_out, size_t* size_out);
   void AppendLinkerOptions() { AppendOptions(HIPRTC_LINK_OPTIONS_APPEND, &link_options_); }
   static bool isLinkerValid(RTCLinkProgram* link_program);
@@ -107,6 +107,11 @@ clSetEventWaitList(
     return CL_SUCCESS;
 }
 
+//! Validates the kernel launch on the queue, \a local_work_size may be NULL
+cl_int clValidateNDRangeKernel(const amd::HostQueue& hostQueue, const amd::Kernel& kernel,
+    cl_uint work_dim, const size_t* global_work_offset, const size_t* global_work_size,
+    const size_t* local_work_size);
+
 //! Common function declarations for CL-external graphics API interop
 cl_int clEnqueueAcquireExtObjectsAMD(cl_command_queue command_queue,
     cl_uint num_objects, const cl_mem* mem_objects,
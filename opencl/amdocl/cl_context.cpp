@@ -21,6 +21,7 @@
 #include "cl_common.hpp"
 #include "vdi_common.hpp"
 #include "platform/context.hpp"
+#include "platform/memory.hpp"
 #include "device/device.hpp"
 #include "platform/runtime.hpp"
 #include "platform/agent.hpp"
@@ -35,6 +36,7 @@
 #include "cl_sdi_amd.h"
 #include "cl_thread_trace_amd.h"
 #include "cl_p2p_amd.h"
+#include "cl_kernel_batch_amd.h"
 
 #include <GL/gl.h>
 #include <GL/glext.h>
@@ -249,6 +251,8 @@ RUNTIME_ENTRY(cl_int, clReleaseContext, (cl_context context)) {
   if (!is_valid(context)) {
     return CL_INVALID_CONTEXT;
   }
+  // The cached empty SVM slabs hold the context references
+  amd::SvmPool::releaseIdle(*as_amd(context));
   as_amd(context)->release();
   return CL_SUCCESS;
 }
@@ -511,6 +515,7 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
 #if cl_amd_copy_buffer_p2p
       CL_EXTENSION_ENTRYPOINT_CHECK(clEnqueueCopyBufferP2PAMD);
 #endif  // cl_amd_copy_buffer_p2p
+      CL_EXTENSION_ENTRYPOINT_CHECK(clEnqueueNDRangeKernelsAMD);
       break;
     case 'G':
       CL_EXTENSION_ENTRYPOINT_CHECK(clGetKernelInfoAMD);
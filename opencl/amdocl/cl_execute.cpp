@@ -35,6 +35,75 @@
  *  @{
  */
 
+// ================================================================================================
+cl_int amd::clValidateNDRangeKernel(const amd::HostQueue& hostQueue, const amd::Kernel& kernel,
+                                    cl_uint work_dim, const size_t* global_work_offset,
+                                    const size_t* global_work_size,
+                                    const size_t* local_work_size) {
+  if (&hostQueue.context() != &kernel.program().context()) {
+    return CL_INVALID_CONTEXT;
+  }
+
+  const amd::Device& device = hostQueue.device();
+  const device::Kernel* devKernel = kernel.getDeviceKernel(device);
+  if (devKernel == NULL) {
+    return CL_INVALID_PROGRAM_EXECUTABLE;
+  }
+
+  if (kernel.parameters().getSvmSystemPointersSupport() == FGS_YES &&
+      !(device.info().svmCapabilities_ & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM)) {
+    // The user indicated that this kernel will access SVM system pointers,
+    // but the device does not support them.
+    return CL_INVALID_OPERATION;
+  }
+
+  if (work_dim < 1 || work_dim > 3) {
+    return CL_INVALID_WORK_DIMENSION;
+  }
+#if !defined(CL_VERSION_1_1)
+  if (global_work_offset != NULL) {
+    return CL_INVALID_GLOBAL_OFFSET;
+  }
+#endif  // CL_VERSION
+  if (global_work_size == NULL) {
+    return CL_INVALID_VALUE;
+  }
+
+  if (local_work_size != NULL) {
+    size_t numWorkItems = 1;
+    for (cl_uint dim = 0; dim < work_dim; ++dim) {
+      if ((devKernel->workGroupInfo()->compileSize_[0] != 0) &&
+          (local_work_size[dim] != devKernel->workGroupInfo()->compileSize_[dim])) {
+        return CL_INVALID_WORK_GROUP_SIZE;
+      }
+      // >32bits global work size is not supported.
+      if ((global_work_size[dim] == 0) || (global_work_size[dim] > static_cast<size_t>(0xffffffff))) {
+        return CL_INVALID_GLOBAL_WORK_SIZE;
+      }
+      numWorkItems *= local_work_size[dim];
+    }
+    // Make sure local work size is valid
+    if ((numWorkItems == 0) || (numWorkItems > devKernel->workGroupInfo()->size_)) {
+      return CL_INVALID_WORK_GROUP_SIZE;
+    }
+    // Check if uniform was requested and validate dimensions
+    if (devKernel->workGroupInfo()->uniformWorkGroupSize_) {
+      for (cl_uint dim = 0; dim < work_dim; ++dim) {
+        if ((global_work_size[dim] % local_work_size[dim]) != 0) {
+          return CL_INVALID_WORK_GROUP_SIZE;
+        }
+      }
+    }
+  }
+
+  // Check that all parameters have been defined.
+  if (!kernel.parameters().check()) {
+    return CL_INVALID_KERNEL_ARGS;
+  }
+
+  return CL_SUCCESS;
+}
+
 /*! \brief Enqueue a command to execute a kernel on a device.
  *
  *  \param command_queue is a valid command-queue. The kernel  will  be  queued
@@ -187,73 +256,19 @@ RUNTIME_ENTRY(cl_int, clEnqueueNDRangeKernel,
   amd::HostQueue& hostQueue = *queue;
 
   const amd::Kernel* amdKernel = as_amd(kernel);
-  if (&hostQueue.context() != &amdKernel->program().context()) {
-    return CL_INVALID_CONTEXT;
-  }
-
-  const amd::Device& device = hostQueue.device();
-  const device::Kernel* devKernel = amdKernel->getDeviceKernel(device);
-  if (devKernel == NULL) {
-    return CL_INVALID_PROGRAM_EXECUTABLE;
-  }
-
-  if (amdKernel->parameters().getSvmSystemPointersSupport() == FGS_YES &&
-      !(device.info().svmCapabilities_ & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM)) {
-    // The user indicated that this kernel will access SVM system pointers,
-    // but the device does not support them.
-    return CL_INVALID_OPERATION;
-  }
-
-  if (work_dim < 1 || work_dim > 3) {
-    return CL_INVALID_WORK_DIMENSION;
-  }
-#if !defined(CL_VERSION_1_1)
-  if (global_work_offset != NULL) {
-    return CL_INVALID_GLOBAL_OFFSET;
-  }
-#endif  // CL_VERSION
-  if (global_work_size == NULL) {
-    return CL_INVALID_VALUE;
+  cl_int err = amd::clValidateNDRangeKernel(hostQueue, *amdKernel, work_dim, global_work_offset,
+                                            global_work_size, local_work_size);
+  if (err != CL_SUCCESS) {
+    return err;
   }
-
   if (local_work_size == NULL) {
     static size_t zeroes[3] = {0, 0, 0};
     local_work_size = zeroes;
-  } else {
-    size_t numWorkItems = 1;
-    for (cl_uint dim = 0; dim < work_dim; ++dim) {
-      if ((devKernel->workGroupInfo()->compileSize_[0] != 0) &&
-          (local_work_size[dim] != devKernel->workGroupInfo()->compileSize_[dim])) {
-        return CL_INVALID_WORK_GROUP_SIZE;
-      }
-      // >32bits global work size is not supported.
-      if ((global_work_size[dim] == 0) || (global_work_size[dim] > static_cast<size_t>(0xffffffff))) {
-        return CL_INVALID_GLOBAL_WORK_SIZE;
-      }
-      numWorkItems *= local_work_size[dim];
-    }
-    // Make sure local work size is valid
-    if ((numWorkItems == 0) || (numWorkItems > devKernel->workGroupInfo()->size_)) {
-      return CL_INVALID_WORK_GROUP_SIZE;
-    }
-    // Check if uniform was requested and validate dimensions
-    if (devKernel->workGroupInfo()->uniformWorkGroupSize_) {
-      for (cl_uint dim = 0; dim < work_dim; ++dim) {
-        if ((global_work_size[dim] % local_work_size[dim]) != 0) {
-          return CL_INVALID_WORK_GROUP_SIZE;
-        }
-      }
-    }
-  }
-
-  // Check that all parameters have been defined.
-  if (!amdKernel->parameters().check()) {
-    return CL_INVALID_KERNEL_ARGS;
   }
 
   amd::Command::EventWaitList eventWaitList;
-  cl_int err = amd::clSetEventWaitList(eventWaitList, hostQueue, num_events_in_wait_list,
-                                       event_wait_list);
+  err = amd::clSetEventWaitList(eventWaitList, hostQueue, num_events_in_wait_list,
+                                event_wait_list);
   if (err != CL_SUCCESS) {
     return err;
   }
@@ -267,13 +282,17 @@ RUNTIME_ENTRY(cl_int, clEnqueueNDRangeKernel,
   }
   // ndrange is now owned by command. Do not delete it!
 
-  // Make sure we have memory for the command execution
-  cl_int result = command->captureAndValidate();
+  // Make sure we have memory for the command execution. The arguments usually don't change
+  // between the enqueues, hence they are copied from the kernel parameters snapshot
+  cl_int result = command->captureAndValidate(true, true);
   if (result != CL_SUCCESS) {
     delete command;
     return result;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -480,6 +499,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueNativeKernel,
     return CL_OUT_OF_HOST_MEMORY;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
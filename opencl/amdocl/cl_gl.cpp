@@ -1627,13 +1627,6 @@ cl_int clEnqueueAcquireExtObjectsAMD(cl_command_queue command_queue, cl_uint num
       LogWarning("\"amdContext\" is not created from GL context or share list");
       return CL_INVALID_CONTEXT;
     }
-    // If the cl_khr_gl_event extension is supported, then the OpenCL implementation will ensure
-    // that any such pending OpenGL operations are complete for an OpenGL context bound
-    // to the same thread as the OpenCL context.
-    if (hostQueue.device().settings().checkExtension(ClKhrGlEvent)) {
-      GLFunctions::Lock lock(gl_functions);
-      gl_functions->WaitCurrentGlContext(hostQueue.context().info());
-    }
   }
 
   std::vector<amd::Memory*> memObjects;
@@ -1682,6 +1675,39 @@ cl_int clEnqueueAcquireExtObjectsAMD(cl_command_queue command_queue, cl_uint num
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  // If the cl_khr_gl_event extension is supported, then the OpenCL implementation will ensure
+  // that any such pending OpenGL operations are complete for an OpenGL context bound
+  // to the same thread as the OpenCL context.
+  if ((cmd_type == CL_COMMAND_ACQUIRE_GL_OBJECTS) &&
+      hostQueue.device().settings().checkExtension(ClKhrGlEvent)) {
+    GLFunctions* gl_functions = hostQueue.context().glenv();
+    GLFunctions::Lock lock(gl_functions);
+    if (gl_functions->IsCurrentGlContext(hostQueue.context().info())) {
+      GLsync sync = nullptr;
+      // The queue thread waits for a fence after the pending GL work, so neither the application
+      // thread nor the GL pipeline stalls in glFinish. Direct dispatch has no queue thread and
+      // the device queue can't wait for a GL fence, hence it keeps glFinish
+      if (AMD_OCL_GL_FENCE_SYNC && !AMD_DIRECT_DISPATCH) {
+        sync = gl_functions->glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      }
+      amd::ClGlEvent* fence = nullptr;
+      if (sync != nullptr) {
+        fence = new amd::ClGlEvent(hostQueue.context(), true);
+        if (fence == nullptr) {
+          gl_functions->glDeleteSync_(sync);
+        }
+      }
+      if (fence != nullptr) {
+        gl_functions->glFlush_();
+        fence->data().emplace_back(sync);
+        command->updateEventWaitList({fence});
+        fence->release();
+      } else {
+        gl_functions->WaitCurrentGlContext(hostQueue.context().info());
+      }
+    }
+  }
+
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
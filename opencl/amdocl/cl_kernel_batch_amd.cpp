@@ -0,0 +1,184 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "cl_common.hpp"
+#include "cl_kernel_batch_amd.h"
+#include "platform/kernel.hpp"
+#include "platform/ndrange.hpp"
+#include "platform/command.hpp"
+
+#include <vector>
+
+/*! \addtogroup API
+ *  @{
+ *
+ *  \addtogroup AMD_Extensions
+ *  @{
+ *
+ */
+
+/*! \brief Enqueues a batch of kernel launches with a single call.
+ *
+ *  Every launch is validated and its arguments are captured before any launch is
+ *  enqueued, so a failed validation doesn't enqueue any launch. The arguments of
+ *  a launch with \a num_args != 0 are set as clSetKernelArg() does, hence they stay
+ *  set on the kernel after the call. The launches execute in the array order, on
+ *  an out-of-order queue each launch waits for the previous one. In the direct
+ *  dispatch mode the AQL packets of the batch are submitted with one doorbell update.
+ *
+ *  \param command_queue is a valid command-queue.
+ *
+ *  \param num_launches is the number of the entries in \a launches.
+ *
+ *  \param launches describes the kernel launches, see clEnqueueNDRangeKernel()
+ *  for the meaning of the work sizes.
+ *
+ *  \param num_events_in_wait_list and \a event_wait_list specify the events,
+ *  which need to complete before the first launch executes.
+ *
+ *  \param event returns an event object of the last launch. Its completion
+ *  indicates the completion of the whole batch.
+ *
+ *  \return One of the following values:
+ *  - CL_SUCCESS if the launches were successfully queued
+ *  - CL_INVALID_VALUE if \a num_launches is 0 or \a launches is NULL
+ *  - CL_INVALID_KERNEL if a launch has an invalid kernel
+ *  - any error of clEnqueueNDRangeKernel() or clSetKernelArg() for a launch
+ */
+RUNTIME_ENTRY(cl_int, clEnqueueNDRangeKernelsAMD,
+              (cl_command_queue command_queue, cl_uint num_launches,
+               const cl_ndrange_launch_amd* launches, cl_uint num_events_in_wait_list,
+               const cl_event* event_wait_list, cl_event* event)) {
+  if (!is_valid(command_queue)) {
+    return CL_INVALID_COMMAND_QUEUE;
+  }
+
+  amd::HostQueue* queue = as_amd(command_queue)->asHostQueue();
+  if (NULL == queue) {
+    return CL_INVALID_COMMAND_QUEUE;
+  }
+  amd::HostQueue& hostQueue = *queue;
+
+  if (num_launches == 0 || launches == NULL) {
+    return CL_INVALID_VALUE;
+  }
+
+  amd::Command::EventWaitList eventWaitList;
+  cl_int err = amd::clSetEventWaitList(eventWaitList, hostQueue, num_events_in_wait_list,
+                                       event_wait_list);
+  if (err != CL_SUCCESS) {
+    return err;
+  }
+
+  const bool inOrder = !hostQueue.properties().test(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+  std::vector<amd::NDRangeKernelCommand*> commands;
+  commands.reserve(num_launches);
+  for (cl_uint i = 0; i < num_launches; ++i) {
+    const cl_ndrange_launch_amd& launch = launches[i];
+    if (!is_valid(launch.kernel)) {
+      err = CL_INVALID_KERNEL;
+      break;
+    }
+    if (launch.num_args != 0 && launch.args == NULL) {
+      err = CL_INVALID_VALUE;
+      break;
+    }
+    for (cl_uint arg = 0; (arg < launch.num_args) && (err == CL_SUCCESS); ++arg) {
+      err = clSetKernelArg(launch.kernel, arg, launch.args[arg].size, launch.args[arg].value);
+    }
+    if (err != CL_SUCCESS) {
+      break;
+    }
+
+    amd::Kernel& kernel = *as_amd(launch.kernel);
+    const size_t zeroes[3] = {0, 0, 0};
+    const bool defaultLocal = (launch.work_dim <= 3) &&
+        (memcmp(launch.local_work_size, zeroes, launch.work_dim * sizeof(size_t)) == 0);
+    err = amd::clValidateNDRangeKernel(hostQueue, kernel, launch.work_dim,
+                                       launch.global_work_offset, launch.global_work_size,
+                                       defaultLocal ? NULL : launch.local_work_size);
+    if (err != CL_SUCCESS) {
+      break;
+    }
+
+    // The first launch waits for the app events, the next ones follow the previous launch
+    amd::Command::EventWaitList waitList;
+    if (i == 0) {
+      waitList = eventWaitList;
+    } else if (!inOrder) {
+      waitList.push_back(commands.back());
+    }
+    amd::NDRangeContainer ndrange(static_cast<size_t>(launch.work_dim),
+                                  launch.global_work_offset, launch.global_work_size,
+                                  launch.local_work_size);
+    amd::NDRangeKernelCommand* command =
+        new amd::NDRangeKernelCommand(hostQueue, waitList, kernel, ndrange);
+    if (command == NULL) {
+      err = CL_OUT_OF_HOST_MEMORY;
+      break;
+    }
+    // The arguments are captured now, so the next launches may change them
+    err = command->captureAndValidate(true, true);
+    if (err != CL_SUCCESS) {
+      delete command;
+      break;
+    }
+    commands.push_back(command);
+  }
+
+  if (err != CL_SUCCESS) {
+    // Destroy in the reverse order, since a command holds the previous one in the wait list
+    for (auto it = commands.rbegin(); it != commands.rend(); ++it) {
+      delete *it;
+    }
+    return err;
+  }
+
+  {
+    // Hold the doorbell updates until the last launch in the direct dispatch, since the
+    // app thread submits the packets. The worker thread submits the commands one by one
+    amd::ScopedLock lock(AMD_DIRECT_DISPATCH ? &hostQueue.vdev()->execution() : nullptr);
+    if (AMD_DIRECT_DISPATCH) {
+      hostQueue.vdev()->BeginPacketBatch();
+    }
+    for (auto command : commands) {
+      command->enqueue();
+    }
+    if (AMD_DIRECT_DISPATCH) {
+      hostQueue.vdev()->EndPacketBatch();
+    }
+  }
+
+  amd::NDRangeKernelCommand* last = commands.back();
+  commands.pop_back();
+  for (auto command : commands) {
+    command->release();
+  }
+  *not_null(event) = as_cl(&last->event());
+  if (event == NULL) {
+    last->release();
+  }
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
+/*! @}
+ *  @}
+ */
@@ -0,0 +1,61 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef __CL_KERNEL_BATCH_AMD_H
+#define __CL_KERNEL_BATCH_AMD_H
+
+#include "CL/cl_ext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+/* The argument value of a batched launch, the same as clSetKernelArg() takes */
+typedef struct _cl_kernel_arg_amd {
+  size_t size;
+  const void* value;
+} cl_kernel_arg_amd;
+
+/* A kernel launch of clEnqueueNDRangeKernelsAMD() */
+typedef struct _cl_ndrange_launch_amd {
+  cl_kernel kernel;
+  cl_uint work_dim;
+  size_t global_work_offset[3];
+  size_t global_work_size[3];
+  size_t local_work_size[3];  /* All zeros let the runtime pick the work-group size */
+  cl_uint num_args;           /* 0 launches with the current kernel arguments */
+  const cl_kernel_arg_amd* args;
+} cl_ndrange_launch_amd;
+
+extern CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernelsAMD(
+    cl_command_queue command_queue, cl_uint num_launches, const cl_ndrange_launch_amd* launches,
+    cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+    cl_event* event) CL_EXT_SUFFIX__VERSION_1_2;
+
+typedef CL_API_ENTRY cl_int(CL_API_CALL* clEnqueueNDRangeKernelsAMD_fn)(
+    cl_command_queue command_queue, cl_uint num_launches, const cl_ndrange_launch_amd* launches,
+    cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+    cl_event* event) CL_EXT_SUFFIX__VERSION_1_2;
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif /*__cplusplus*/
+
+#endif
@@ -651,6 +651,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueReadBuffer,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_read) {
     command->awaitCompletion();
@@ -793,6 +796,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueWriteBuffer,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_write) {
     command->awaitCompletion();
@@ -923,6 +929,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueCopyBuffer,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -1107,6 +1116,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueReadBufferRect,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_read) {
     command->awaitCompletion();
@@ -1292,6 +1304,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueWriteBufferRect,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_write) {
     command->awaitCompletion();
@@ -1474,6 +1489,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueCopyBufferRect,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -2244,6 +2262,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueReadImage,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_read) {
     command->awaitCompletion();
@@ -2432,6 +2453,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueWriteImage,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
   if (blocking_write) {
     command->awaitCompletion();
@@ -2626,6 +2650,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueCopyImage,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -2785,6 +2812,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueCopyImageToBuffer,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -2939,6 +2969,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueCopyBufferToImage,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -3140,6 +3173,9 @@ RUNTIME_ENTRY_RET(void*, clEnqueueMapBuffer,
   }
 
   // Send the map command for processing
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   // A blocking map has to wait for completion
@@ -3413,6 +3449,9 @@ RUNTIME_ENTRY_RET(void*, clEnqueueMapImage,
   }
 
   // Send the map command for processing
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   // A blocking map has to wait for completion
@@ -3539,6 +3578,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueUnmapMemObject,
   }
 
   amdMemory->decMapCount();
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   if (blocking) {
@@ -4293,6 +4335,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueFillBuffer,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -4471,6 +4516,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueFillImage,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -4620,6 +4668,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueMigrateMemObjects,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -505,19 +505,27 @@ RUNTIME_ENTRY(cl_int, clBuildProgram,
   }
 
   amd::Program* amdProgram = as_amd(program);
+  if (amdProgram->buildPending()) {
+    return CL_INVALID_OPERATION;
+  }
 
+  std::vector<amd::Device*> devices;
   if (device_list == NULL) {
     // build for all devices in the context.
-    return amdProgram->build(amdProgram->context().devices(), options, pfn_notify, user_data);
-  }
-
-  std::vector<amd::Device*> devices(num_devices);
-  for (cl_uint i = 0; i < num_devices; ++i) {
-    amd::Device* device = as_amd(device_list[i]);
-    if (!amdProgram->context().containsDevice(device)) {
-      return CL_INVALID_DEVICE;
+    devices = amdProgram->context().devices();
+  } else {
+    devices.resize(num_devices);
+    for (cl_uint i = 0; i < num_devices; ++i) {
+      amd::Device* device = as_amd(device_list[i]);
+      if (!amdProgram->context().containsDevice(device)) {
+        return CL_INVALID_DEVICE;
+      }
+      devices[i] = device;
     }
-    devices[i] = device;
+  }
+  // The build with a callback returns immediately and runs on a build worker
+  if ((pfn_notify != nullptr) && (AMD_OCL_BUILD_THREADS > 0)) {
+    return amdProgram->buildAsync(devices, options, pfn_notify, user_data);
   }
   return amdProgram->build(devices, options, pfn_notify, user_data);
 }
@@ -954,6 +962,8 @@ RUNTIME_ENTRY(cl_int, clGetProgramInfo,
   if (!is_valid(program)) {
     return CL_INVALID_PROGRAM;
   }
+  // The device programs change during an asynchronous build
+  as_amd(program)->waitForBuild();
 
   switch (param_name) {
     case CL_PROGRAM_REFERENCE_COUNT: {
@@ -1101,6 +1111,15 @@ RUNTIME_ENTRY(cl_int, clGetProgramBuildInfo,
     return CL_INVALID_DEVICE;
   }
 
+  // The device programs change during an asynchronous build, only the status doesn't wait
+  if (as_amd(program)->buildPending()) {
+    if (param_name == CL_PROGRAM_BUILD_STATUS) {
+      cl_build_status status = CL_BUILD_IN_PROGRESS;
+      return amd::clGetInfo(status, param_value_size, param_value, param_value_size_ret);
+    }
+    as_amd(program)->waitForBuild();
+  }
+
   const device::Program* devProgram = as_amd(program)->getDeviceProgram(*as_amd(device));
   if (devProgram == NULL) {
     return CL_INVALID_DEVICE;
@@ -190,6 +190,11 @@ RUNTIME_ENTRY_RET_NOERRCODE(void*, clSVMAlloc, (cl_context context, cl_svm_mem_f
   }
 
   amd::Context& amdContext = *as_amd(context);
+  // Small allocations are carved from the pooled slabs
+  void* ptr = amd::SvmPool::malloc(amdContext, flags, size, alignment);
+  if (ptr != nullptr) {
+    return ptr;
+  }
   return amd::SvmBuffer::malloc(amdContext, flags, size, alignment);
 }
 RUNTIME_EXIT
@@ -335,6 +340,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMFree,
     return CL_OUT_OF_HOST_MEMORY;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -461,6 +469,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMMemcpy,
     return CL_OUT_OF_HOST_MEMORY;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   if (blocking_copy) {
@@ -598,6 +609,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMMemFill,
     return CL_OUT_OF_HOST_MEMORY;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -759,6 +773,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMMap,
   if (command == NULL) {
     return CL_OUT_OF_HOST_MEMORY;
   }
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   if (blocking_map) {
@@ -866,6 +883,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMUnmap,
   if (command == NULL) {
     return CL_OUT_OF_HOST_MEMORY;
   }
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
@@ -1202,6 +1222,9 @@ RUNTIME_ENTRY(cl_int, clEnqueueSVMMigrateMem,
     return CL_MEM_OBJECT_ALLOCATION_FAILURE;
   }
 
+  if (event == NULL) {
+    command->SkipQueueProfiling();
+  }
   command->enqueue();
 
   *not_null(event) = as_cl(&command->event());
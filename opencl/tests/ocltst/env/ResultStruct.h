@@ -33,6 +33,7 @@ class TestResult {
  public:
   float value;
   std::string resultString;
+  std::string descString;  // Test description, which ends with the units
   bool passed;
 
   TestResult(float val) : resultString("\n"), passed(true) { value = val; }
@@ -41,6 +42,7 @@ class TestResult {
     value = val;
     passed = true;
     resultString.assign("\n");
+    descString.clear();
   }
 };
 
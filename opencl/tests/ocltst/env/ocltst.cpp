@@ -62,6 +62,8 @@ static OCLutil::Lock moduleLock;
 #include <stdio.h>
 
 #include <algorithm>
+#include <cmath>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -103,6 +105,8 @@ class App {
         m_rndOrder(false),
         m_spawned(0),
         m_threads(1),
+        m_perfRepeat(1),
+        m_perfThreshold(5.0),
         m_runthread(0),
         m_width(512),
         m_height(512),
@@ -290,6 +294,10 @@ class App {
   //! Function to get the number of iterations.
   int GetNumItr(void) { return m_numItr; }
 
+  //! Writes the perf statistics and compares them against the baseline.
+  //! Returns false if any test regressed
+  bool ReportPerf(void);
+
  private:
   typedef std::vector<unsigned int> TestIndexList;
   typedef std::vector<std::string> StringList;
@@ -345,6 +353,27 @@ class App {
   int* mp_testOrder;
   bool m_rndOrder;
 
+  //! Perf samples of a subtest over the repeats and the iterations
+  struct PerfSamples {
+    std::vector<float> values;
+    std::string desc;
+  };
+
+  //! Returns true if the perf statistics are collected
+  bool PerfStatsEnabled(void) const {
+    return (m_perfRepeat > 1) || !m_perfJson.empty() || !m_perfBaseline.empty();
+  }
+
+  //! Number of the runs of each subtest for the perf statistics
+  int m_perfRepeat;
+  //! Allowed slowdown of the median against the baseline in percent
+  double m_perfThreshold;
+  std::string m_perfJson;
+  std::string m_perfBaseline;
+  //! Perf samples in the run order, the map indexes them by the subtest name
+  std::vector<std::pair<std::string, PerfSamples> > m_perfSamples;
+  std::map<std::string, size_t> m_perfIndex;
+
   //! m_pool = Various threads created to execute tests on multiple devices
   OCLutil::Thread m_pool[256];
 
@@ -555,8 +584,10 @@ void report(Worker* w, const char* testname, int testnum, unsigned int crc,
   unsigned int deviceId = w->getDeviceId();
 
   char tmpUnits[256];
+  tr->descString.assign(testDesc);
   if (perflab) {
     oclTestLog(OCLTEST_LOG_ALWAYS, "%10.3f\n", timer);
+    tr->value = timer;
   } else {
     const char* passedOrFailed[] = {"FAILED", "PASSED"};
 
@@ -832,13 +863,33 @@ void App::RunAllTests() {
         for (unsigned int j = 0; j < testIndices.size(); j++) {
           unsigned int test = testIndices[j];
 
-          WaitAllThreads();
-          AddWorkerThread(i, subtest, test, pt->getThreadUsage(), runSubtest);
+          for (int repeat = 0; repeat < m_perfRepeat; repeat++) {
+            WaitAllThreads();
+            AddWorkerThread(i, subtest, test, pt->getThreadUsage(), runSubtest);
+
+            for (unsigned int thread = 1;
+                 (thread < m_threads) && (thread < m_modules.size()); thread++) {
+              AddWorkerThread(thread, subtest, test, pt->getThreadUsage(),
+                              dummyThread);
+            }
 
-          for (unsigned int thread = 1;
-               (thread < m_threads) && (thread < m_modules.size()); thread++) {
-            AddWorkerThread(thread, subtest, test, pt->getThreadUsage(),
-                            dummyThread);
+            if (PerfStatsEnabled()) {
+              WaitAllThreads();
+              TestResult* result = m_workers[0]->getResult();
+              if (result->passed) {
+                char testName[256];
+                sprintf(testName, "%s[%d]", name, test);
+                auto it = m_perfIndex.find(testName);
+                if (it == m_perfIndex.end()) {
+                  it = m_perfIndex.insert(std::make_pair(testName,
+                                                         m_perfSamples.size())).first;
+                  m_perfSamples.push_back(std::make_pair(testName, PerfSamples()));
+                }
+                PerfSamples& samples = m_perfSamples[it->second].second;
+                samples.values.push_back(result->value);
+                samples.desc = result->descString;
+              }
+            }
           }
 
           numTestsRun++;
@@ -920,6 +971,191 @@ void App::RunAllTests() {
 
 /////////////////////////////////////////////////////////////////////////////
 
+//! Perf statistics of a subtest
+struct PerfStats {
+  double median;
+  double low;   // Lower bound of the 95% confidence interval of the median
+  double high;  // Upper bound of the 95% confidence interval of the median
+  unsigned int samples;
+  bool higherIsBetter;
+};
+
+//! The units end the test description in brackets, i.e. (GB/s) or (us/disp).
+//! Rates are better higher, times are better lower
+static bool PerfHigherIsBetter(const std::string& desc) {
+  size_t open = desc.rfind('(');
+  if (open == std::string::npos) {
+    return false;
+  }
+  std::string units = desc.substr(open);
+  return units.find("/s") != std::string::npos;
+}
+
+static PerfStats ComputePerfStats(std::vector<float> values,
+                                  const std::string& desc) {
+  PerfStats stats;
+  std::sort(values.begin(), values.end());
+  const size_t n = values.size();
+  stats.samples = static_cast<unsigned int>(n);
+  stats.median = (n % 2) ? values[n / 2]
+                         : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+  // Distribution-free interval from the order statistics, the normal
+  // approximation of the binomial ranks
+  const double z = 1.96 * sqrt(static_cast<double>(n));
+  long lowRank = static_cast<long>(floor((n - z) / 2.0));
+  long highRank = static_cast<long>(ceil(1.0 + (n + z) / 2.0));
+  lowRank = std::max(lowRank, 1L);
+  highRank = std::min(highRank, static_cast<long>(n));
+  stats.low = values[lowRank - 1];
+  stats.high = values[highRank - 1];
+  stats.higherIsBetter = PerfHigherIsBetter(desc);
+  return stats;
+}
+
+//! Finds "key": <number> in a line of the perf JSON
+static bool PerfJsonNumber(const std::string& line, const char* key,
+                           double* value) {
+  std::string pattern = std::string("\"") + key + "\": ";
+  size_t pos = line.find(pattern);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  const char* start = line.c_str() + pos + pattern.size();
+  char* end = NULL;
+  *value = strtod(start, &end);
+  return end != start;
+}
+
+//! Loads the baseline, which is a perf JSON written by the -j option with
+//! one test per line
+static bool LoadPerfBaseline(const char* filename,
+                             std::map<std::string, PerfStats>* baseline) {
+  FILE* fp = fopen(filename, "r");
+  if (fp == NULL) {
+    return false;
+  }
+  char buffer[1024];
+  while (fgets(buffer, sizeof(buffer), fp) != NULL) {
+    std::string line(buffer);
+    const std::string key = "\"name\": \"";
+    size_t pos = line.find(key);
+    if (pos == std::string::npos) {
+      continue;
+    }
+    pos += key.size();
+    size_t end = line.find('"', pos);
+    if (end == std::string::npos) {
+      continue;
+    }
+    PerfStats stats;
+    double samples = 0;
+    if (!PerfJsonNumber(line, "median", &stats.median) ||
+        !PerfJsonNumber(line, "low", &stats.low) ||
+        !PerfJsonNumber(line, "high", &stats.high) ||
+        !PerfJsonNumber(line, "samples", &samples)) {
+      continue;
+    }
+    stats.samples = static_cast<unsigned int>(samples);
+    stats.higherIsBetter =
+        line.find("\"higher_is_better\": true") != std::string::npos;
+    (*baseline)[line.substr(pos, end - pos)] = stats;
+  }
+  fclose(fp);
+  return true;
+}
+
+bool App::ReportPerf(void) {
+  if (!PerfStatsEnabled() || m_perfSamples.empty()) {
+    return true;
+  }
+
+  std::vector<PerfStats> stats;
+  for (unsigned int i = 0; i < m_perfSamples.size(); i++) {
+    stats.push_back(ComputePerfStats(m_perfSamples[i].second.values,
+                                     m_perfSamples[i].second.desc));
+  }
+
+  oclTestLog(OCLTEST_LOG_ALWAYS, "\n%-32s %8s %12s %12s %12s\n", "Perf test",
+             "samples", "median", "low", "high");
+  for (unsigned int i = 0; i < m_perfSamples.size(); i++) {
+    oclTestLog(OCLTEST_LOG_ALWAYS, "%-32s %8u %12.3f %12.3f %12.3f\n",
+               m_perfSamples[i].first.c_str(), stats[i].samples,
+               stats[i].median, stats[i].low, stats[i].high);
+  }
+
+  if (!m_perfJson.empty()) {
+    FILE* fp = fopen(m_perfJson.c_str(), "w");
+    if (fp == NULL) {
+      oclTestLog(OCLTEST_LOG_ALWAYS, "Unable to write the perf results to %s\n",
+                 m_perfJson.c_str());
+    } else {
+      fprintf(fp, "{\n  \"tests\": [\n");
+      for (unsigned int i = 0; i < m_perfSamples.size(); i++) {
+        fprintf(fp,
+                "    {\"name\": \"%s\", \"median\": %.6g, \"low\": %.6g, "
+                "\"high\": %.6g, \"samples\": %u, \"higher_is_better\": %s}%s\n",
+                m_perfSamples[i].first.c_str(), stats[i].median, stats[i].low,
+                stats[i].high, stats[i].samples,
+                stats[i].higherIsBetter ? "true" : "false",
+                (i + 1 < m_perfSamples.size()) ? "," : "");
+      }
+      fprintf(fp, "  ]\n}\n");
+      fclose(fp);
+    }
+  }
+
+  if (m_perfBaseline.empty()) {
+    return true;
+  }
+  std::map<std::string, PerfStats> baseline;
+  if (!LoadPerfBaseline(m_perfBaseline.c_str(), &baseline)) {
+    oclTestLog(OCLTEST_LOG_ALWAYS, "Unable to read the perf baseline %s\n",
+               m_perfBaseline.c_str());
+    return false;
+  }
+
+  unsigned int regressions = 0;
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "\nPerf comparison against %s (threshold %.1f%%)\n",
+             m_perfBaseline.c_str(), m_perfThreshold);
+  oclTestLog(OCLTEST_LOG_ALWAYS, "%-32s %12s %12s %9s  %s\n", "Perf test",
+             "baseline", "current", "change", "status");
+  for (unsigned int i = 0; i < m_perfSamples.size(); i++) {
+    const char* name = m_perfSamples[i].first.c_str();
+    auto it = baseline.find(m_perfSamples[i].first);
+    if (it == baseline.end()) {
+      oclTestLog(OCLTEST_LOG_ALWAYS, "%-32s %12s %12.3f %9s  new\n", name, "-",
+                 stats[i].median, "-");
+      continue;
+    }
+    const PerfStats& base = it->second;
+    const PerfStats& cur = stats[i];
+    double change =
+        (base.median != 0) ? 100.0 * (cur.median - base.median) / base.median : 0;
+    // Positive is a slowdown in both directions of the units
+    double slowdown = base.higherIsBetter ? -change : change;
+    // The change must exceed the threshold and the confidence intervals must
+    // be apart, so the noise of a few samples doesn't fail the run
+    bool apart = base.higherIsBetter ? (cur.high < base.low)
+                                     : (cur.low > base.high);
+    bool ahead = base.higherIsBetter ? (cur.low > base.high)
+                                     : (cur.high < base.low);
+    const char* status = "ok";
+    if ((slowdown > m_perfThreshold) && apart) {
+      status = "REGRESSION";
+      regressions++;
+    } else if ((-slowdown > m_perfThreshold) && ahead) {
+      status = "improved";
+    }
+    oclTestLog(OCLTEST_LOG_ALWAYS, "%-32s %12.3f %12.3f %8.2f%%  %s\n", name,
+               base.median, cur.median, change, status);
+  }
+  oclTestLog(OCLTEST_LOG_ALWAYS, "Perf regressions: %u\n", regressions);
+  return regressions == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 void App::AddToList(StringList& strlist, const char* str) {
   std::string s(str);
 
@@ -950,7 +1186,7 @@ void App::LoadList(StringList& strlist, const char* filename) {
 static void Help(const char* name) {
   oclTestLog(OCLTEST_LOG_ALWAYS,
              "%s (-w | -V | -m | -M | -l | -t | -T | -p | -d | -x | -y | -g| "
-             "-o | -n )\n",
+             "-o | -n | -k | -j | -b | -e )\n",
              name);
   oclTestLog(OCLTEST_LOG_ALWAYS, "   -w            : enable window mode\n");
   oclTestLog(OCLTEST_LOG_ALWAYS, "   -V            : enable TeamCity service messages\n");
@@ -1005,6 +1241,17 @@ static void Help(const char* name) {
              "   -o <filename> : dump the output to a specified file\n");
   oclTestLog(OCLTEST_LOG_ALWAYS,
              "   -c            : Run the test on the CPU device.\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -k <count>    : run each subtest count times and report the "
+             "median perf\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -j <filename> : write the perf statistics to a JSON file\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -b <filename> : compare the perf against a JSON baseline "
+             "written by -j\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -e <percent>  : perf regression threshold against the "
+             "baseline, 5 by default\n");
   oclTestLog(OCLTEST_LOG_ALWAYS, "                 : \n");
   oclTestLog(OCLTEST_LOG_ALWAYS,
              "                 : To run only one subtest of a test, append the "
@@ -1067,7 +1314,8 @@ unsigned int getPlatformID(const char* str) {
   return platform;
 }
 
-static const char* supported_options = "dg:lm:M:o:Ps:t:T:a:A:p:v:wxy:in:rcRVJ";
+static const char* supported_options =
+    "dg:lm:M:o:Ps:t:T:a:A:p:v:wxy:in:rcRVJk:j:b:e:";
 
 unsigned int parseCommandLineForPlatform(unsigned int argc, char** argv) {
   int c;
@@ -1228,6 +1476,18 @@ void App::CommandLine(unsigned int argc, char** argv) {
       case 'i':
         m_noSysInfoPrint = true;
         break;
+      case 'k':
+        m_perfRepeat = std::max(atoi(optarg), 1);
+        break;
+      case 'j':
+        m_perfJson = optarg;
+        break;
+      case 'b':
+        m_perfBaseline = optarg;
+        break;
+      case 'e':
+        m_perfThreshold = atof(optarg);
+        break;
       default:
         Help(argv[0]);
         break;
@@ -1492,7 +1752,11 @@ int main(int argc, char** argv) {
     for (int i = 0; i < app.GetNumItr(); i++) {
       app.RunAllTests();
     }
+    bool perfPassed = app.ReportPerf();
     app.CleanUp();
+    if (!perfPassed) {
+      return 1;
+    }
 #ifdef AUTO_REGRESS
   } catch (...) {
     oclTestLog(OCLTEST_LOG_ALWAYS, "Exiting due to unhandled exception!\n");
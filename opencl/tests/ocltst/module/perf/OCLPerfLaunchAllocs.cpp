@@ -0,0 +1,191 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "OCLPerfLaunchAllocs.h"
+
+#include <Timer.h>
+#include <assert.h>
+#include <stdio.h>
+
+#include <sstream>
+#include <string>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <malloc.h>
+#define HEAP_STATS 1
+#endif
+
+#include "CL/cl.h"
+
+static const size_t Iterations = 0x8000;
+static const size_t Warmup = 0x400;
+static const size_t TotalArgs = 3;
+static const cl_uint NumArgs[TotalArgs] = {1, 8, 32};
+
+#ifdef WIN_OS
+#define SNPRINTF sprintf_s
+#else
+#define SNPRINTF snprintf
+#endif
+
+static const char* strKernel =
+    "__kernel void launch(__global uint* out%s)  \n"
+    "{                                          \n"
+    "   uint id = get_global_id(0);             \n"
+    "   out[id] = id;                           \n"
+    "}                                          \n";
+
+//! Returns the number of bytes in use by the process heap
+static size_t heapInUse() {
+#ifdef HEAP_STATS
+  struct mallinfo info = mallinfo();
+  return static_cast<size_t>(static_cast<unsigned int>(info.uordblks)) +
+         static_cast<size_t>(static_cast<unsigned int>(info.hblkhd));
+#else
+  return 0;
+#endif
+}
+
+OCLPerfLaunchAllocs::OCLPerfLaunchAllocs() {
+  _numSubTests = TotalArgs * 2;
+  failed_ = false;
+  queue_ = 0;
+}
+
+OCLPerfLaunchAllocs::~OCLPerfLaunchAllocs() {}
+
+void OCLPerfLaunchAllocs::open(unsigned int test, char* units,
+                               double& conversion, unsigned int deviceId) {
+  _deviceId = deviceId;
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+  test_ = test;
+  failed_ = false;
+  cl_device_type deviceType;
+  error_ = _wrapper->clGetDeviceInfo(devices_[deviceId], CL_DEVICE_TYPE,
+                                     sizeof(deviceType), &deviceType, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "CL_DEVICE_TYPE failed");
+
+  if (!(deviceType & CL_DEVICE_TYPE_GPU)) {
+    printf("GPU device is required for this test!\n");
+    failed_ = true;
+    return;
+  }
+
+  // Build the argument list, all arguments past the first one are scalars
+  std::string args;
+  for (cl_uint a = 1; a < NumArgs[test_ % TotalArgs]; ++a) {
+    args += ", uint a" + std::to_string(a);
+  }
+  char* program = new char[4096];
+  SNPRINTF(program, sizeof(char) * 4096, strKernel, args.c_str());
+  program_ = _wrapper->clCreateProgramWithSource(
+      context_, 1, (const char**)&program, NULL, &error_);
+  delete[] program;
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource()  failed");
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  if (error_ != CL_SUCCESS) {
+    char programLog[1024];
+    _wrapper->clGetProgramBuildInfo(program_, devices_[deviceId],
+                                    CL_PROGRAM_BUILD_LOG, 1024, programLog, 0);
+    printf("\n%s\n", programLog);
+    fflush(stdout);
+  }
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+  kernel_ = _wrapper->clCreateKernel(program_, "launch", &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+
+  cl_mem buffer = _wrapper->clCreateBuffer(
+      context_, CL_MEM_READ_WRITE, 256 * sizeof(cl_uint), NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+  buffers_.push_back(buffer);
+
+  queue_ = _wrapper->clCreateCommandQueue(context_, devices_[deviceId], 0,
+                                          &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateCommandQueue() failed");
+
+  error_ = _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &buffer);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  for (cl_uint a = 1; a < NumArgs[test_ % TotalArgs]; ++a) {
+    error_ = _wrapper->clSetKernelArg(kernel_, a, sizeof(cl_uint), &a);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  }
+}
+
+void OCLPerfLaunchAllocs::run(void) {
+  if (failed_) {
+    return;
+  }
+  // The second half of the subtests waits for every launch, so the runtime
+  // can recycle the launch resources in the steady state
+  bool sync = test_ >= TotalArgs;
+  size_t gws[1] = {256};
+  size_t lws[1] = {256};
+
+  // Warm-up, which populates the runtime caches
+  for (size_t i = 0; i < Warmup; ++i) {
+    error_ = _wrapper->clEnqueueNDRangeKernel(queue_, kernel_, 1, NULL, gws,
+                                              lws, 0, NULL, NULL);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+  }
+  _wrapper->clFinish(queue_);
+
+  size_t heapStart = heapInUse();
+  size_t heapPeak = heapStart;
+  CPerfCounter timer;
+  timer.Reset();
+  timer.Start();
+  for (size_t i = 0; i < Iterations; ++i) {
+    error_ = _wrapper->clEnqueueNDRangeKernel(queue_, kernel_, 1, NULL, gws,
+                                              lws, 0, NULL, NULL);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+    if (sync) {
+      _wrapper->clFinish(queue_);
+    }
+    if ((i % 0x100) == 0) {
+      size_t heap = heapInUse();
+      heapPeak = (heap > heapPeak) ? heap : heapPeak;
+    }
+  }
+  _wrapper->clFinish(queue_);
+  timer.Stop();
+
+  std::stringstream stream;
+  stream << "Time per launch (us), ";
+  stream.width(2);
+  stream << NumArgs[test_ % TotalArgs] << " args, "
+         << (sync ? "sync " : "async");
+#ifdef HEAP_STATS
+  stream << ", heap growth per launch (bytes): "
+         << (heapPeak - heapStart) / Iterations;
+#endif
+  testDescString = stream.str();
+  _perfInfo =
+      static_cast<float>(timer.GetElapsedTime() * 1000000 / Iterations);
+}
+
+unsigned int OCLPerfLaunchAllocs::close(void) {
+  if (queue_ != 0) {
+    _wrapper->clReleaseCommandQueue(queue_);
+    queue_ = 0;
+  }
+  return OCLTestImp::close();
+}
@@ -0,0 +1,43 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef _OCL_PERF_LAUNCH_ALLOCS_H_
+#define _OCL_PERF_LAUNCH_ALLOCS_H_
+
+#include "OCLTestImp.h"
+
+class OCLPerfLaunchAllocs : public OCLTestImp {
+ public:
+  OCLPerfLaunchAllocs();
+  virtual ~OCLPerfLaunchAllocs();
+
+ public:
+  virtual void open(unsigned int test, char* units, double& conversion,
+                    unsigned int deviceID);
+  virtual void run(void);
+  virtual unsigned int close(void);
+
+ private:
+  bool failed_;
+  unsigned int test_;
+  cl_command_queue queue_;
+};
+
+#endif  // _OCL_PERF_LAUNCH_ALLOCS_H_
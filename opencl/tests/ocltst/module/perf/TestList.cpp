@@ -51,6 +51,7 @@
 #include "OCLPerfImageSampleRate.h"
 #include "OCLPerfImageWriteSpeed.h"
 #include "OCLPerfKernelArguments.h"
+#include "OCLPerfLaunchAllocs.h"
 #include "OCLPerfLDSLatency.h"
 #include "OCLPerfLDSReadSpeed.h"
 #include "OCLPerfMandelbrot.h"
@@ -182,6 +183,7 @@ TestEntry TestList[] = {
     TEST(OCLPerfDevMemReadSpeed),
     TEST(OCLPerfDevMemWriteSpeed),
     TEST(OCLPerfVerticalFetch),
+    TEST(OCLPerfLaunchAllocs),
 };
 
 unsigned int TestListCount = sizeof(TestList) / sizeof(TestList[0]);
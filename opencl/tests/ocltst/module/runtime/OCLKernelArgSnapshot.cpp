@@ -0,0 +1,142 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "OCLKernelArgSnapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "CL/cl.h"
+
+// The number of elements, written by one launch
+const static size_t ChunkSize = 4096;
+// The number of the chunks in the output buffer
+const static cl_uint NumChunks = 4;
+
+const static char* strKernel =
+    "__kernel void write_value(global uint* out, uint offset, uint value) \n"
+    "{                                                                    \n"
+    "   out[offset + get_global_id(0)] = value;                           \n"
+    "}                                                                    \n";
+
+OCLKernelArgSnapshot::OCLKernelArgSnapshot() { _numSubTests = 1; }
+
+OCLKernelArgSnapshot::~OCLKernelArgSnapshot() {}
+
+void OCLKernelArgSnapshot::open(unsigned int test, char* units,
+                                double& conversion, unsigned int deviceId) {
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+
+  program_ = _wrapper->clCreateProgramWithSource(context_, 1, &strKernel, NULL,
+                                                 &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource()  failed");
+
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  if (error_ != CL_SUCCESS) {
+    char programLog[1024];
+    _wrapper->clGetProgramBuildInfo(program_, devices_[deviceId],
+                                    CL_PROGRAM_BUILD_LOG, 1024, programLog, 0);
+    printf("\n%s\n", programLog);
+    fflush(stdout);
+  }
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+
+  kernel_ = _wrapper->clCreateKernel(program_, "write_value", &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+
+  cl_mem buffer = _wrapper->clCreateBuffer(
+      context_, CL_MEM_READ_WRITE, NumChunks * ChunkSize * sizeof(cl_uint),
+      NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+  buffers_.push_back(buffer);
+}
+
+void OCLKernelArgSnapshot::run(void) {
+  cl_command_queue queue = cmdQueues_[_deviceId];
+  cl_mem buffer = buffers()[0];
+  std::vector<cl_uint> values(NumChunks * ChunkSize, 0);
+  error_ = _wrapper->clEnqueueWriteBuffer(queue, buffer, true, 0,
+                                          values.size() * sizeof(cl_uint),
+                                          values.data(), 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueWriteBuffer() failed");
+
+  // A temporary buffer, which is released while the launch is in flight
+  cl_mem temp = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE,
+                                         ChunkSize * sizeof(cl_uint), NULL,
+                                         &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+
+  size_t gws[1] = {ChunkSize};
+  cl_uint offset = 0;
+  cl_uint value = 1;
+  error_ = _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &buffer);
+  error_ |= _wrapper->clSetKernelArg(kernel_, 1, sizeof(cl_uint), &offset);
+  error_ |= _wrapper->clSetKernelArg(kernel_, 2, sizeof(cl_uint), &value);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+
+  // The repeated launches with unchanged arguments reuse the captured
+  // arguments, the changes after a launch must not affect it
+  for (cl_uint i = 0; i < NumChunks; ++i) {
+    if (i == 2) {
+      // The third chunk stays 0, the launch writes the temporary buffer
+      error_ = _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &temp);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+      offset = 0;
+      error_ = _wrapper->clSetKernelArg(kernel_, 1, sizeof(cl_uint), &offset);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+    } else {
+      offset = i * ChunkSize;
+      error_ = _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &buffer);
+      error_ |= _wrapper->clSetKernelArg(kernel_, 1, sizeof(cl_uint), &offset);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+    }
+    for (cl_uint j = 0; j < 2; ++j) {
+      error_ = _wrapper->clEnqueueNDRangeKernel(queue, kernel_, 1, NULL, gws,
+                                                NULL, 0, NULL, NULL);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+    }
+    if (i == 2) {
+      error_ = _wrapper->clReleaseMemObject(temp);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clReleaseMemObject() failed");
+    }
+    value = i + 2;
+    error_ = _wrapper->clSetKernelArg(kernel_, 2, sizeof(cl_uint), &value);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  }
+
+  error_ = _wrapper->clEnqueueReadBuffer(queue, buffer, true, 0,
+                                         values.size() * sizeof(cl_uint),
+                                         values.data(), 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueReadBuffer() failed");
+  for (size_t i = 0; i < values.size(); ++i) {
+    cl_uint chunk = static_cast<cl_uint>(i / ChunkSize);
+    cl_uint expected = (chunk == 2) ? 0 : chunk + 1;
+    if (values[i] != expected) {
+      printf("Element %zu: %u != %u", i, values[i], expected);
+      CHECK_RESULT(true, " - Incorrect result after the argument update!\n");
+    }
+  }
+}
+
+unsigned int OCLKernelArgSnapshot::close(void) { return OCLTestImp::close(); }
@@ -0,0 +1,150 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "OCLKernelBatch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "CL/cl.h"
+#include "cl_kernel_batch_amd.h"
+
+// The number of elements, written by one launch
+const static size_t ChunkSize = 4096;
+// The number of the launches in the batch
+const static cl_uint NumLaunches = 8;
+
+const static char* strKernel =
+    "__kernel void write_value(global uint* out, uint offset, uint value) \n"
+    "{                                                                    \n"
+    "   out[offset + get_global_id(0)] = value;                           \n"
+    "}                                                                    \n";
+
+OCLKernelBatch::OCLKernelBatch() : batch_(NULL) { _numSubTests = 1; }
+
+OCLKernelBatch::~OCLKernelBatch() {}
+
+void OCLKernelBatch::open(unsigned int test, char* units, double& conversion,
+                          unsigned int deviceId) {
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+
+  batch_ = clGetExtensionFunctionAddressForPlatform(
+      platform_, "clEnqueueNDRangeKernelsAMD");
+  CHECK_RESULT((batch_ == NULL), "clEnqueueNDRangeKernelsAMD is missing");
+
+  program_ = _wrapper->clCreateProgramWithSource(context_, 1, &strKernel, NULL,
+                                                 &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource()  failed");
+
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  if (error_ != CL_SUCCESS) {
+    char programLog[1024];
+    _wrapper->clGetProgramBuildInfo(program_, devices_[deviceId],
+                                    CL_PROGRAM_BUILD_LOG, 1024, programLog, 0);
+    printf("\n%s\n", programLog);
+    fflush(stdout);
+  }
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+
+  kernel_ = _wrapper->clCreateKernel(program_, "write_value", &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+
+  cl_mem buffer = _wrapper->clCreateBuffer(
+      context_, CL_MEM_READ_WRITE, NumLaunches * ChunkSize * sizeof(cl_uint),
+      NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+  buffers_.push_back(buffer);
+}
+
+void OCLKernelBatch::run(void) {
+  clEnqueueNDRangeKernelsAMD_fn enqueueKernels =
+      reinterpret_cast<clEnqueueNDRangeKernelsAMD_fn>(batch_);
+  cl_command_queue queue = cmdQueues_[_deviceId];
+  cl_mem buffer = buffers()[0];
+  std::vector<cl_uint> values(NumLaunches * ChunkSize, 0);
+  error_ = _wrapper->clEnqueueWriteBuffer(queue, buffer, true, 0,
+                                          values.size() * sizeof(cl_uint),
+                                          values.data(), 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueWriteBuffer() failed");
+
+  // The last launch uses the current arguments of another kernel object
+  cl_kernel lastKernel =
+      _wrapper->clCreateKernel(program_, "write_value", &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+  cl_uint lastOffset = (NumLaunches - 1) * ChunkSize;
+  cl_uint lastValue = NumLaunches;
+  error_ = _wrapper->clSetKernelArg(lastKernel, 0, sizeof(cl_mem), &buffer);
+  error_ |=
+      _wrapper->clSetKernelArg(lastKernel, 1, sizeof(cl_uint), &lastOffset);
+  error_ |=
+      _wrapper->clSetKernelArg(lastKernel, 2, sizeof(cl_uint), &lastValue);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+
+  std::vector<cl_uint> offsets(NumLaunches);
+  std::vector<cl_uint> launchValues(NumLaunches);
+  std::vector<cl_kernel_arg_amd> args(NumLaunches * 3);
+  std::vector<cl_ndrange_launch_amd> launches(NumLaunches);
+  for (cl_uint i = 0; i < NumLaunches; ++i) {
+    offsets[i] = i * ChunkSize;
+    launchValues[i] = i + 1;
+    args[i * 3] = {sizeof(cl_mem), &buffer};
+    args[i * 3 + 1] = {sizeof(cl_uint), &offsets[i]};
+    args[i * 3 + 2] = {sizeof(cl_uint), &launchValues[i]};
+    memset(&launches[i], 0, sizeof(cl_ndrange_launch_amd));
+    launches[i].kernel = (i == NumLaunches - 1) ? lastKernel : kernel_;
+    launches[i].work_dim = 1;
+    launches[i].global_work_size[0] = ChunkSize;
+    launches[i].num_args = (i == NumLaunches - 1) ? 0 : 3;
+    launches[i].args = &args[i * 3];
+  }
+
+  // A bad launch at the end fails the whole batch
+  launches[NumLaunches - 1].work_dim = 4;
+  error_ = enqueueKernels(queue, NumLaunches, launches.data(), 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_INVALID_WORK_DIMENSION),
+               "clEnqueueNDRangeKernelsAMD() didn't fail the batch");
+  launches[NumLaunches - 1].work_dim = 1;
+
+  cl_event event = NULL;
+  error_ = enqueueKernels(queue, NumLaunches, launches.data(), 0, NULL, &event);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernelsAMD() failed");
+  error_ = _wrapper->clWaitForEvents(1, &event);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clWaitForEvents() failed");
+  _wrapper->clReleaseEvent(event);
+  _wrapper->clReleaseKernel(lastKernel);
+
+  error_ = _wrapper->clEnqueueReadBuffer(queue, buffer, true, 0,
+                                         values.size() * sizeof(cl_uint),
+                                         values.data(), 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueReadBuffer() failed");
+  for (size_t i = 0; i < values.size(); ++i) {
+    cl_uint expected = static_cast<cl_uint>(i / ChunkSize) + 1;
+    if (values[i] != expected) {
+      printf("Element %zu: %u != %u", i, values[i], expected);
+      CHECK_RESULT(true, " - Incorrect result of the batched launches!\n");
+    }
+  }
+}
+
+unsigned int OCLKernelBatch::close(void) { return OCLTestImp::close(); }
@@ -32,9 +32,12 @@ const static char* strKernel =
     "    int  tidY = get_global_id(1);\n"
     "    write_imagei( source, (int2)( tidX, tidY ),(int4)( tidX, tidY,0,0 ) "
     ");\n"
+    "}\n"
+    "__kernel void persistentBuffer(__global uint* buffer, uint base){\n"
+    "    buffer[get_global_id(0)] += base + get_global_id(0);\n"
     "}\n";
 
-OCLPersistent::OCLPersistent() : clImage_(0) { _numSubTests = 1; }
+OCLPersistent::OCLPersistent() : clImage_(0), clBuffer_(0) { _numSubTests = 2; }
 
 OCLPersistent::~OCLPersistent() {}
 
@@ -59,6 +62,17 @@ void OCLPersistent::open(unsigned int test, char* units, double& conversion,
   }
   CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed!");
 
+  _openTest = test;
+  if (_openTest == 1) {
+    kernel_ = _wrapper->clCreateKernel(program_, "persistentBuffer", &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed!");
+    clBuffer_ = _wrapper->clCreateBuffer(
+        context_, CL_MEM_USE_PERSISTENT_MEM_AMD | CL_MEM_READ_WRITE,
+        c_bufferSize * sizeof(cl_uint), NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+    return;
+  }
+
   kernel_ = _wrapper->clCreateKernel(program_, "persistentImage", &error_);
   CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed!");
   cl_image_format format;
@@ -78,6 +92,10 @@ void OCLPersistent::open(unsigned int test, char* units, double& conversion,
 }
 
 void OCLPersistent::run(void) {
+  if (_openTest == 1) {
+    runBuffer();
+    return;
+  }
   _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &clImage_);
 
   size_t dimSizes[] = {c_dimSize, c_dimSize};
@@ -113,8 +131,69 @@ void OCLPersistent::run(void) {
                                     NULL, NULL);
 }
 
+void OCLPersistent::runBuffer() {
+  const size_t size = c_bufferSize * sizeof(cl_uint);
+  cl_uint* ptr = (cl_uint*)_wrapper->clEnqueueMapBuffer(
+      cmdQueues_[_deviceId], clBuffer_, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION,
+      0, size, 0, NULL, NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueMapBuffer() failed");
+  memset(ptr, 0, size);
+  error_ = _wrapper->clEnqueueUnmapMemObject(cmdQueues_[_deviceId], clBuffer_,
+                                             ptr, 0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueUnmapMemObject() failed");
+
+  // Every map has to observe the kernel writes, since the last one, and the
+  // host writes of the previous unmap
+  for (cl_uint pass = 1; pass <= 3; pass++) {
+    cl_uint base = pass * c_bufferSize;
+    _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &clBuffer_);
+    _wrapper->clSetKernelArg(kernel_, 1, sizeof(cl_uint), &base);
+    size_t gws[] = {c_bufferSize};
+    error_ = _wrapper->clEnqueueNDRangeKernel(cmdQueues_[_deviceId], kernel_,
+                                              1, NULL, gws, NULL, 0, NULL,
+                                              NULL);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+
+    // Map the second half first, so the full map extends the valid range
+    const size_t half = size / 2;
+    ptr = (cl_uint*)_wrapper->clEnqueueMapBuffer(
+        cmdQueues_[_deviceId], clBuffer_, CL_TRUE, CL_MAP_READ, half, half, 0,
+        NULL, NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueMapBuffer() failed");
+    _wrapper->clEnqueueUnmapMemObject(cmdQueues_[_deviceId], clBuffer_, ptr,
+                                      0, NULL, NULL);
+
+    ptr = (cl_uint*)_wrapper->clEnqueueMapBuffer(
+        cmdQueues_[_deviceId], clBuffer_, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+        size, 0, NULL, NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueMapBuffer() failed");
+    for (cl_uint i = 0; i < c_bufferSize; i++) {
+      // The host adds 1 after every pass
+      cl_uint expected = 0;
+      for (cl_uint p = 1; p <= pass; p++) {
+        expected += p * c_bufferSize + i + ((p < pass) ? 1 : 0);
+      }
+      if (ptr[i] != expected) {
+        printf("Failed at %u in pass %u: %u, expected %u\n", i, pass, ptr[i],
+               expected);
+        CHECK_RESULT(true, "Validation failed!");
+      }
+      ptr[i]++;
+    }
+    error_ = _wrapper->clEnqueueUnmapMemObject(cmdQueues_[_deviceId],
+                                               clBuffer_, ptr, 0, NULL, NULL);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueUnmapMemObject() failed");
+  }
+  _wrapper->clFinish(cmdQueues_[_deviceId]);
+}
+
 unsigned int OCLPersistent::close(void) {
-  _wrapper->clReleaseMemObject(clImage_);
+  if (clBuffer_ != 0) {
+    _wrapper->clReleaseMemObject(clBuffer_);
+  }
+  if (clImage_ != 0) {
+    _wrapper->clReleaseMemObject(clImage_);
+  }
 
   return OCLTestImp::close();
 }
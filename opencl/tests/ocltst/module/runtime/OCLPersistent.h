@@ -28,6 +28,7 @@ class OCLPersistent : public OCLTestImp {
   OCLPersistent();
   virtual ~OCLPersistent();
   static const unsigned int c_dimSize = 510;
+  static const unsigned int c_bufferSize = 64 * 1024;
   virtual void open(unsigned int test, char* units, double& conversion,
                     unsigned int deviceId);
   virtual void run(void);
@@ -39,12 +40,14 @@ class OCLPersistent : public OCLTestImp {
   ////////////////////
 
   bool validateImage(unsigned int* image, size_t pitch, unsigned int dimSize);
+  void runBuffer();
   /////////////////////
   // private members //
   /////////////////////
 
   // CL identifiers
   cl_mem clImage_;
+  cl_mem clBuffer_;
 };
 
 #endif  // _OCL_GL_BUFFER_H_
@@ -24,6 +24,8 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <new>
+#include <vector>
 #ifdef _WIN32
 #include <intrin.h>
 #include <windows.h>
@@ -102,6 +104,12 @@ const static char* sources[] = {
     }),
     STR(__kernel void test(){
         // dummy
+    }),
+    STR(__kernel void test(__global ulong* ptr) {
+      while (ptr) {
+        *ptr = 0xDEADBEEF;
+        ptr = *((__global ulong* __global*)(ptr + 1));
+      }
     })};
 
 OCLSVM::OCLSVM() { _numSubTests = countOf(sources); }
@@ -142,6 +150,7 @@ void OCLSVM::runEnqueueOperations() {}
 void OCLSVM::runSvmArgumentsAreRecognized() {}
 void OCLSVM::runSvmCommandsExecutedInOrder() {}
 void OCLSVM::runIdentifySvmBuffers() {}
+void OCLSVM::runSmallAllocations() {}
 #else
 
 void OCLSVM::runFineGrainedBuffer() {
@@ -569,6 +578,61 @@ void OCLSVM::runIdentifySvmBuffers() {
   clReleaseMemObject(buf1);
   clSVMFree(context_, ptr);
 }
+
+void OCLSVM::runSmallAllocations() {
+  if (!(svmCaps_ & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)) {
+    printf(
+        "Device does not support fined-grained buffer sharing, skipping "
+        "test...\n");
+    return;
+  }
+  // The small nodes share the slabs, hence the list checks that the blocks don't overlap
+  const size_t numNodes = 256;
+  std::vector<Node*> nodes(numNodes);
+  for (size_t i = 0; i < numNodes; i++) {
+    nodes[i] = (Node*)clSVMAlloc(context_,
+                                 CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER,
+                                 sizeof(Node), 0);
+    CHECK_RESULT(!nodes[i], "clSVMAlloc() failed");
+  }
+  // Churn the odd nodes, so the list reuses the freed blocks
+  for (size_t i = 1; i < numNodes; i += 2) {
+    clSVMFree(context_, nodes[i]);
+  }
+  for (size_t i = 1; i < numNodes; i += 2) {
+    nodes[i] = (Node*)clSVMAlloc(context_,
+                                 CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER,
+                                 sizeof(Node), 0);
+    CHECK_RESULT(!nodes[i], "clSVMAlloc() failed");
+  }
+  for (size_t i = 0; i < numNodes; i++) {
+    new (nodes[i]) Node(0, (i + 1 < numNodes) ? nodes[i + 1] : NULL);
+  }
+
+  error_ = clSetKernelArgSVMPointer(kernel_, 0, nodes[0]);
+  CHECK_ERROR(error_, "clSetKernelArgSVMPointer() failed");
+  error_ = clSetKernelExecInfo(kernel_, CL_KERNEL_EXEC_INFO_SVM_PTRS,
+                               numNodes * sizeof(Node*), nodes.data());
+  CHECK_ERROR(error_, "clSetKernelExecInfo() failed");
+
+  size_t gws[1] = {1};
+  error_ = _wrapper->clEnqueueNDRangeKernel(cmdQueues_[_deviceId], kernel_, 1,
+                                            NULL, gws, NULL, 0, NULL, NULL);
+  CHECK_ERROR(error_, "clEnqueueNDRangeKernel() failed");
+
+  error_ = _wrapper->clFinish(cmdQueues_[_deviceId]);
+  CHECK_ERROR(error_, "Queue::finish() failed");
+
+  size_t matchingNodes = 0;
+  for (size_t i = 0; i < numNodes; i++) {
+    if (nodes[i]->value_ == 0xDEADBEEF) {
+      matchingNodes++;
+    }
+    clSVMFree(context_, nodes[i]);
+  }
+  CHECK_RESULT(matchingNodes != numNodes, "Expected: %zd, found:%zd", numNodes,
+               matchingNodes);
+}
 #endif
 
 cl_bool OCLSVM::isOpenClSvmAvailable(cl_device_id device_id) {
@@ -611,6 +675,8 @@ void OCLSVM::run() {
     runSvmCommandsExecutedInOrder();
   } else if (_openTest == 8) {
     runIdentifySvmBuffers();
+  } else if (_openTest == 9) {
+    runSmallAllocations();
   }
 }
 
@@ -49,6 +49,7 @@ class OCLSVM : public OCLTestImp {
   void runSvmArgumentsAreRecognized();
   void runSvmCommandsExecutedInOrder();
   void runIdentifySvmBuffers();
+  void runSmallAllocations();
   cl_bool isOpenClSvmAvailable(cl_device_id device_id);
 
   uint64_t svmCaps_;
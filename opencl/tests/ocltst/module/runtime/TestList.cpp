@@ -41,6 +41,8 @@
 #include "OCLGlobalOffset.h"
 #include "OCLImage2DFromBuffer.h"
 #include "OCLImageCopyPartial.h"
+#include "OCLKernelArgSnapshot.h"
+#include "OCLKernelBatch.h"
 #include "OCLKernelBinary.h"
 #include "OCLLDS32K.h"
 #include "OCLLinearFilter.h"
@@ -118,6 +120,8 @@ TestEntry TestList[] = {
     TEST(OCLReadWriteImage),
     TEST(OCLStablePState),
     TEST(OCLP2PBuffer),
+    TEST(OCLKernelArgSnapshot),
+    TEST(OCLKernelBatch),
     // Failures in Linux. IOL doesn't support tiling aperture and Cypress linear
     // image writes TEST(OCLPersistent),
 };
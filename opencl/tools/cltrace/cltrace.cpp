@@ -18,6 +18,13 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -4358,6 +4365,367 @@ modified_dispatch = {
     NULL, /* clSetProgramSpecializationConstant */
 };
 
+// Binary trace mode. Every call appends a raw record into a per-thread buffer and a background
+// thread writes the buffers into the file, so the traced calls don't format any text. The file
+// starts with a header and the API name table, cltrace2json.py converts it to Chrome trace JSON.
+//
+//   header:  "CLTRACE1", uint32_t name count, {uint32_t slot, uint32_t length, name} per API
+//   records: BinaryRecord followed by argc_ uint64_t raw arguments
+
+#define CL_TRACE_APIS(X) \
+    X(GetPlatformIDs) \
+    X(GetPlatformInfo) \
+    X(GetDeviceIDs) \
+    X(GetDeviceInfo) \
+    X(CreateContext) \
+    X(CreateContextFromType) \
+    X(RetainContext) \
+    X(ReleaseContext) \
+    X(GetContextInfo) \
+    X(CreateCommandQueue) \
+    X(RetainCommandQueue) \
+    X(ReleaseCommandQueue) \
+    X(GetCommandQueueInfo) \
+    X(SetCommandQueueProperty) \
+    X(CreateBuffer) \
+    X(CreateImage2D) \
+    X(CreateImage3D) \
+    X(RetainMemObject) \
+    X(ReleaseMemObject) \
+    X(GetSupportedImageFormats) \
+    X(GetMemObjectInfo) \
+    X(GetImageInfo) \
+    X(CreateSampler) \
+    X(RetainSampler) \
+    X(ReleaseSampler) \
+    X(GetSamplerInfo) \
+    X(CreateProgramWithSource) \
+    X(CreateProgramWithBinary) \
+    X(RetainProgram) \
+    X(ReleaseProgram) \
+    X(BuildProgram) \
+    X(UnloadCompiler) \
+    X(GetProgramInfo) \
+    X(GetProgramBuildInfo) \
+    X(CreateKernel) \
+    X(CreateKernelsInProgram) \
+    X(RetainKernel) \
+    X(ReleaseKernel) \
+    X(SetKernelArg) \
+    X(GetKernelInfo) \
+    X(GetKernelWorkGroupInfo) \
+    X(WaitForEvents) \
+    X(GetEventInfo) \
+    X(RetainEvent) \
+    X(ReleaseEvent) \
+    X(GetEventProfilingInfo) \
+    X(Flush) \
+    X(Finish) \
+    X(EnqueueReadBuffer) \
+    X(EnqueueWriteBuffer) \
+    X(EnqueueCopyBuffer) \
+    X(EnqueueReadImage) \
+    X(EnqueueWriteImage) \
+    X(EnqueueCopyImage) \
+    X(EnqueueCopyImageToBuffer) \
+    X(EnqueueCopyBufferToImage) \
+    X(EnqueueMapBuffer) \
+    X(EnqueueMapImage) \
+    X(EnqueueUnmapMemObject) \
+    X(EnqueueNDRangeKernel) \
+    X(EnqueueTask) \
+    X(EnqueueNativeKernel) \
+    X(EnqueueMarker) \
+    X(EnqueueWaitForEvents) \
+    X(EnqueueBarrier) \
+    X(GetExtensionFunctionAddress) \
+    X(CreateFromGLBuffer) \
+    X(CreateFromGLTexture2D) \
+    X(CreateFromGLTexture3D) \
+    X(CreateFromGLRenderbuffer) \
+    X(GetGLObjectInfo) \
+    X(GetGLTextureInfo) \
+    X(EnqueueAcquireGLObjects) \
+    X(EnqueueReleaseGLObjects) \
+    X(GetGLContextInfoKHR) \
+    X(SetEventCallback) \
+    X(CreateSubBuffer) \
+    X(SetMemObjectDestructorCallback) \
+    X(CreateUserEvent) \
+    X(SetUserEventStatus) \
+    X(EnqueueReadBufferRect) \
+    X(EnqueueWriteBufferRect) \
+    X(EnqueueCopyBufferRect) \
+    X(CreateEventFromGLsyncKHR) \
+    X(CreateSubDevices) \
+    X(RetainDevice) \
+    X(ReleaseDevice) \
+    X(CreateImage) \
+    X(CreateProgramWithBuiltInKernels) \
+    X(CompileProgram) \
+    X(LinkProgram) \
+    X(UnloadPlatformCompiler) \
+    X(GetKernelArgInfo) \
+    X(EnqueueFillBuffer) \
+    X(EnqueueFillImage) \
+    X(EnqueueMigrateMemObjects) \
+    X(EnqueueMarkerWithWaitList) \
+    X(EnqueueBarrierWithWaitList) \
+    X(GetExtensionFunctionAddressForPlatform) \
+    X(CreateFromGLTexture) \
+    X(CreateCommandQueueWithProperties) \
+    X(CreatePipe) \
+    X(GetPipeInfo) \
+    X(SVMAlloc) \
+    X(SVMFree) \
+    X(EnqueueSVMFree) \
+    X(EnqueueSVMMemcpy) \
+    X(EnqueueSVMMemFill) \
+    X(EnqueueSVMMap) \
+    X(EnqueueSVMUnmap) \
+    X(CreateSamplerWithProperties) \
+    X(SetKernelArgSVMPointer) \
+    X(SetKernelExecInfo) \
+    X(GetKernelSubGroupInfoKHR) \
+    X(CloneKernel) \
+    X(CreateProgramWithILKHR) \
+    X(EnqueueSVMMigrateMem) \
+    X(GetDeviceAndHostTimer) \
+    X(GetHostTimer) \
+    X(GetKernelSubGroupInfo) \
+    X(SetDefaultDeviceCommandQueue) \
+    X(SetProgramReleaseCallback) \
+    X(SetProgramSpecializationConstant)
+
+struct BinaryRecord {
+    uint32_t slot_;     // Dispatch table slot of the API
+    uint32_t thread_;   // Sequential thread id
+    uint64_t begin_;    // Enter time in ns
+    uint64_t end_;      // Exit time in ns
+    uint64_t ret_;      // Raw return value
+    uint32_t argc_;     // Number of the raw arguments after the record
+    uint32_t reserved_;
+};
+
+// Per-thread record buffer, the owner appends and the writer takes the records
+struct ThreadBuffer {
+    std::mutex lock_;
+    std::vector<char> data_;
+    uint32_t thread_;
+    bool retired_;      // The thread exited, the writer frees the buffer
+
+    ThreadBuffer(uint32_t thread) : thread_(thread), retired_(false) {
+        data_.reserve(64 * 1024);
+    }
+};
+
+// How often the background thread writes the buffers
+static const int binary_flushes_per_second = 100;
+
+static FILE* binaryTraceFile = NULL;
+static std::mutex binaryBuffersLock;
+static std::vector<ThreadBuffer*> binaryBuffers;
+static std::atomic<uint32_t> binaryThreads(0);
+static std::atomic<bool> binaryStop(false);
+static std::thread* binaryWriter = NULL;
+
+// Marks the buffer of an exiting thread retired
+struct ThreadBufferHolder {
+    ThreadBuffer* buffer_;
+
+    ThreadBufferHolder() : buffer_(NULL) { }
+    ~ThreadBufferHolder() {
+        if (buffer_ != NULL) {
+            std::lock_guard<std::mutex> l(buffer_->lock_);
+            buffer_->retired_ = true;
+        }
+    }
+};
+
+static inline uint64_t
+binaryTime(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ThreadBuffer*
+getThreadBuffer(void)
+{
+    static thread_local ThreadBufferHolder holder;
+    if (holder.buffer_ == NULL) {
+        holder.buffer_ = new ThreadBuffer(binaryThreads++);
+        std::lock_guard<std::mutex> l(binaryBuffersLock);
+        binaryBuffers.push_back(holder.buffer_);
+    }
+    return holder.buffer_;
+}
+
+// Writes the collected records of all threads
+static void
+flushBinaryBuffers(void)
+{
+    std::vector<char> data;
+    std::lock_guard<std::mutex> l(binaryBuffersLock);
+    for (auto it = binaryBuffers.begin(); it != binaryBuffers.end(); ) {
+        ThreadBuffer* buffer = *it;
+        bool retired;
+        {
+            std::lock_guard<std::mutex> bl(buffer->lock_);
+            data.swap(buffer->data_);
+            retired = buffer->retired_;
+        }
+        if (!data.empty()) {
+            fwrite(data.data(), 1, data.size(), binaryTraceFile);
+            data.clear();
+        }
+        if (retired) {
+            delete buffer;
+            it = binaryBuffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    fflush(binaryTraceFile);
+}
+
+static void
+binaryWriterLoop(void)
+{
+    while (!binaryStop) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(1000 / binary_flushes_per_second));
+        flushBinaryBuffers();
+    }
+}
+
+template <typename T>
+static inline uint64_t
+getRawValue(T value)
+{
+    uint64_t raw = 0;
+    memcpy(&raw, &value, sizeof(value) < sizeof(raw) ? sizeof(value) : sizeof(raw));
+    return raw;
+}
+
+static inline void
+addBinaryRecord(uint32_t slot, uint64_t begin, uint64_t end, uint64_t ret,
+                const uint64_t* args, uint32_t argc)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    BinaryRecord rec = { slot, buffer->thread_, begin, end, ret, argc, 0 };
+
+    std::lock_guard<std::mutex> l(buffer->lock_);
+    const char* bytes = reinterpret_cast<const char*>(&rec);
+    buffer->data_.insert(buffer->data_.end(), bytes, bytes + sizeof(rec));
+    bytes = reinterpret_cast<const char*>(args);
+    buffer->data_.insert(buffer->data_.end(), bytes, bytes + argc * sizeof(uint64_t));
+}
+
+// The binary wrapper of a dispatch table slot, instantiated from the slot function type
+template <size_t Offset, typename F>
+struct BinaryTracer;
+
+template <size_t Offset, typename R, typename... Args>
+struct BinaryTracer<Offset, R (CL_API_CALL *)(Args...)> {
+    static R CL_API_CALL call(Args... args) {
+        typedef R (CL_API_CALL *F)(Args...);
+        F f = *reinterpret_cast<F*>(reinterpret_cast<char*>(&original_dispatch) + Offset);
+        uint64_t raw[sizeof...(Args) + 1] = { getRawValue(args)... };
+        uint64_t begin = binaryTime();
+        R ret = f(args...);
+        uint64_t end = binaryTime();
+        addBinaryRecord(Offset / sizeof(void*), begin, end, getRawValue(ret), raw,
+                        sizeof...(Args));
+        return ret;
+    }
+};
+
+template <size_t Offset, typename... Args>
+struct BinaryTracer<Offset, void (CL_API_CALL *)(Args...)> {
+    static void CL_API_CALL call(Args... args) {
+        typedef void (CL_API_CALL *F)(Args...);
+        F f = *reinterpret_cast<F*>(reinterpret_cast<char*>(&original_dispatch) + Offset);
+        uint64_t raw[sizeof...(Args) + 1] = { getRawValue(args)... };
+        uint64_t begin = binaryTime();
+        f(args...);
+        uint64_t end = binaryTime();
+        addBinaryRecord(Offset / sizeof(void*), begin, end, 0, raw, sizeof...(Args));
+    }
+};
+
+static cl_icd_dispatch_table binary_dispatch;
+
+#define SET_BINARY(DISPATCH) \
+    if (original_dispatch.DISPATCH != NULL) { \
+        binary_dispatch.DISPATCH = &BinaryTracer< \
+            offsetof(cl_icd_dispatch_table, DISPATCH), \
+            decltype(binary_dispatch.DISPATCH)>::call; \
+    }
+
+#define WRITE_BINARY_NAME(DISPATCH) \
+    { \
+        static const char name[] = "cl" #DISPATCH; \
+        uint32_t entry[2] = { \
+            static_cast<uint32_t>(offsetof(cl_icd_dispatch_table, DISPATCH) / sizeof(void*)), \
+            static_cast<uint32_t>(sizeof(name) - 1) }; \
+        fwrite(entry, sizeof(entry), 1, binaryTraceFile); \
+        fwrite(name, 1, sizeof(name) - 1, binaryTraceFile); \
+    }
+
+#define COUNT_BINARY_NAME(DISPATCH) + 1
+
+static void
+stopBinaryTrace(void)
+{
+    if (binaryWriter == NULL) {
+        return;
+    }
+    binaryStop = true;
+    binaryWriter->join();
+    delete binaryWriter;
+    binaryWriter = NULL;
+    flushBinaryBuffers();
+    fclose(binaryTraceFile);
+}
+
+static bool
+startBinaryTrace(const std::string& fileName)
+{
+    binaryTraceFile = fopen(fileName.c_str(), "wb");
+    if (binaryTraceFile == NULL) {
+        return false;
+    }
+    const uint32_t count = 0 CL_TRACE_APIS(COUNT_BINARY_NAME);
+    fwrite("CLTRACE1", 1, 8, binaryTraceFile);
+    fwrite(&count, sizeof(count), 1, binaryTraceFile);
+    CL_TRACE_APIS(WRITE_BINARY_NAME)
+
+    binary_dispatch = original_dispatch;
+    CL_TRACE_APIS(SET_BINARY)
+
+    binaryWriter = new std::thread(binaryWriterLoop);
+    std::atexit(stopBinaryTrace);
+    return true;
+}
+
+// Returns the trace file name with %pid% replaced by the process id
+static std::string
+getTraceFileName(const char* env)
+{
+    std::string name = env;
+    const std::size_t pidPos = name.find("%pid%");
+    if (pidPos != std::string::npos) {
+#if defined(_WIN32)
+        const std::int32_t pid = _getpid();
+#else
+        const std::int32_t pid = getpid();
+#endif
+        name.replace(pidPos, 5, std::to_string(pid));
+    }
+    return name;
+}
+
 static void
 cleanup(void)
 {
@@ -4376,6 +4744,7 @@ int32_t CL_CALLBACK
 vdiAgent_OnLoad(vdi_agent * agent)
 {
     char *clTraceLogEnv;
+    char *clTraceBinaryEnv;
 
     int32_t err = agent->GetICDDispatchTable(
             agent, &original_dispatch, sizeof(original_dispatch));
@@ -4383,19 +4752,20 @@ vdiAgent_OnLoad(vdi_agent * agent)
         return err;
     }
 
+    clTraceBinaryEnv = getenv("CL_TRACE_BINARY");
+    if (clTraceBinaryEnv != NULL) {
+        std::string clTraceBinaryStr = getTraceFileName(clTraceBinaryEnv);
+        if (startBinaryTrace(clTraceBinaryStr)) {
+            return agent->SetICDDispatchTable(
+                agent, &binary_dispatch, sizeof(binary_dispatch));
+        }
+        std::cerr << "!!! Cannot open the binary trace " << clTraceBinaryStr
+            << ", using the text trace" << std::endl;
+    }
+
     clTraceLogEnv = getenv("CL_TRACE_OUTPUT");
     if(clTraceLogEnv!=NULL) {
-        std::string clTraceLogStr = clTraceLogEnv;
-        const std::size_t pidPos = clTraceLogStr.find("%pid%");
-        if (pidPos != std::string::npos) {
-#if defined(_WIN32)
-            const std::int32_t pid = _getpid();
-#else
-            const std::int32_t pid = getpid();
-#endif
-            clTraceLogStr.replace(pidPos, 5, std::to_string(pid));
-        }
-        clTraceLog.open(clTraceLogStr);
+        clTraceLog.open(getTraceFileName(clTraceLogEnv));
         cerrStreamBufSave = std::cerr.rdbuf(clTraceLog.rdbuf());
         std::atexit(cleanup);
     }
@@ -4447,5 +4817,6 @@ vdiAgent_OnLoad(vdi_agent * agent)
 void CL_CALLBACK
 vdiAgent_OnUnload(vdi_agent * agent)
 {
+    stopBinaryTrace();
     clTraceLog.close();
 }
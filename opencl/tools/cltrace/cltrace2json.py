@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 - Present Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Converts a cltrace binary trace (CL_TRACE_BINARY) to Chrome trace JSON, which
+# chrome://tracing and Perfetto open. Every call becomes a complete event on the
+# timeline of its thread, with the raw arguments and the return value attached.
+#
+# usage: cltrace2json.py trace.bin [trace.json]
+
+import json
+import struct
+import sys
+
+MAGIC = b"CLTRACE1"
+RECORD = struct.Struct("<IIQQQII")
+
+
+def read_trace(data):
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a cltrace binary trace")
+    pos = len(MAGIC)
+    (count,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    names = {}
+    for _ in range(count):
+        slot, length = struct.unpack_from("<II", data, pos)
+        pos += 8
+        names[slot] = data[pos:pos + length].decode("ascii")
+        pos += length
+
+    records = []
+    while pos + RECORD.size <= len(data):
+        slot, thread, begin, end, ret, argc, _ = RECORD.unpack_from(data, pos)
+        pos += RECORD.size
+        if pos + 8 * argc > len(data):
+            break  # The trace was cut in the middle of a record
+        args = struct.unpack_from("<%dQ" % argc, data, pos)
+        pos += 8 * argc
+        records.append((slot, thread, begin, end, ret, args))
+    return names, records
+
+
+def to_chrome(names, records):
+    base = min((r[2] for r in records), default=0)
+    events = []
+    for slot, thread, begin, end, ret, args in records:
+        events.append({
+            "name": names.get(slot, "slot%d" % slot),
+            "ph": "X",
+            "pid": 0,
+            "tid": thread,
+            "ts": (begin - base) / 1000.0,
+            "dur": (end - begin) / 1000.0,
+            "args": {
+                "ret": "0x%x" % ret,
+                "args": ["0x%x" % a for a in args],
+            },
+        })
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: %s trace.bin [trace.json]\n" % argv[0])
+        return 1
+    with open(argv[1], "rb") as f:
+        names, records = read_trace(f.read())
+    trace = to_chrome(names, records)
+    if len(argv) == 3:
+        with open(argv[2], "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
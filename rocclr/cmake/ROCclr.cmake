@@ -90,10 +90,13 @@ target_sources(rocclr PRIVATE
   ${ROCCLR_SRC_DIR}/platform/ndrange.cpp
   ${ROCCLR_SRC_DIR}/platform/program.cpp
   ${ROCCLR_SRC_DIR}/platform/runtime.cpp
+  ${ROCCLR_SRC_DIR}/platform/trace_events.cpp
   ${ROCCLR_SRC_DIR}/platform/interop_gl.cpp
   ${ROCCLR_SRC_DIR}/thread/monitor.cpp
+  ${ROCCLR_SRC_DIR}/thread/rwmonitor.cpp
   ${ROCCLR_SRC_DIR}/thread/semaphore.cpp
   ${ROCCLR_SRC_DIR}/thread/thread.cpp
+  ${ROCCLR_SRC_DIR}/thread/threadpool.cpp
   ${ROCCLR_SRC_DIR}/utils/debug.cpp
   ${ROCCLR_SRC_DIR}/utils/flags.cpp)
 
@@ -27,6 +27,8 @@
 #include <iterator>
 #include <cassert>
 #include <regex>
+#include <mutex>
+#include <unordered_map>
 #include "options.hpp"
 
 namespace {
@@ -1038,8 +1040,9 @@ namespace amd {
 
 namespace option {
 
-bool
-parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
+// Parses the option string into Opts
+static bool
+parseOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
 {
     Opts.origOptionStr = options;
     OptionVariables*  ovars = Opts.oVariables;
@@ -1210,52 +1213,7 @@ parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isL
         ShowOptionsHelp(arg, Opts);
     }
 
-    // Set up llvmargv if llvmOptions is not empty
-    if (!Opts.llvmOptions.empty()) {
-        std::string*  ostr = &Opts.llvmOptions;
-        int n;
-        size_t pos1, pos2;
-        pos1 = ostr->find_first_not_of(' ');
-        for (n=0; pos1 != std::string::npos; ++n) {
-            pos2 = ostr->find_first_of(' ', pos1);
-            if (pos2 != std::string::npos) {
-                pos2 = ostr->find_first_not_of(' ', pos2);
-            }
-            pos1 = pos2;
-        }
-        if (n > 0) {
-            char* data = new char [sizeof(char*) * (n+1) +   // for argv[0:n]
-                                   ostr->size() + 1];    // for all option chars
-            char** t_argv  = (char**)data;
-            static char pseudoCmdName[] = "llvmOptCodegen";
-
-            t_argv[0] = &pseudoCmdName[0];   // pseudo command name
-            Opts.setLLVMArgs(n+1, t_argv);
-            Opts.recordMemoryHandle(data);
-
-            // Initialize all arguments
-            t_argv++;
-            data = (char*) (t_argv + n);
-            int i = 0;
-            pos1 = ostr->find_first_not_of(' ');
-            while (pos1 != std::string::npos) {
-                pos2 = ostr->find_first_of(' ', pos1);
-                size_t len;
-                if (pos2 == std::string::npos) {
-                    len = ostr->size() - pos1;
-                }
-                else {
-                    len = pos2 - pos1;
-                    pos2 = ostr->find_first_not_of(' ', pos2);
-                }
-                ostr->copy(data, len, pos1);
-                data[len] = 0;
-                t_argv[i++] = data;
-                data += (len+1);
-                pos1 = pos2;
-            }
-        }
-    }
+    Opts.setupLLVMArgs();
 
     // if the set of options is OA_LINK_LIB options, the "-create-library"
     // option should be included
@@ -1276,6 +1234,44 @@ parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isL
     return true;
 }
 
+// The JIT builds many programs with the same option string, hence the result of every parse
+// is kept and applied to the next parse of the same string. The entries are never freed, since
+// the static programs may still parse during the process exit.
+static const size_t ParsedOptionsMax = 256;
+static std::mutex* ParsedOptionsLock = new std::mutex();
+static std::unordered_map<std::string, const Options*>* ParsedOptions
+    = new std::unordered_map<std::string, const Options*>();
+
+bool
+parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
+{
+    std::string key(1, static_cast<char>((linkOptsOnly ? 1 : 0) | (isLC ? 2 : 0)));
+    key += options;
+    {
+        std::lock_guard<std::mutex> lock(*ParsedOptionsLock);
+        auto it = ParsedOptions->find(key);
+        if (it != ParsedOptions->end()) {
+            Opts.setParsedOptionsAs(*it->second);
+            return true;
+        }
+    }
+
+    Options* parsed = new Options();
+    if (!parseOptions(options, *parsed, linkOptsOnly, isLC)) {
+        // Parse again into Opts for the same error state and log
+        delete parsed;
+        return parseOptions(options, Opts, linkOptsOnly, isLC);
+    }
+    Opts.setParsedOptionsAs(*parsed);
+
+    std::lock_guard<std::mutex> lock(*ParsedOptionsLock);
+    if ((ParsedOptions->size() >= ParsedOptionsMax) ||
+        !ParsedOptions->emplace(key, parsed).second) {
+        delete parsed;
+    }
+    return true;
+}
+
 bool
 init()
 {
@@ -1717,6 +1713,100 @@ bool Options::setOptionVariablesAs(const Options& other)
     return true;
 }
 
+void Options::setParsedOptionsAs(const Options& parsed)
+{
+    origOptionStr = parsed.origOptionStr;
+
+    OptionDescriptor* od = OptDescTable;
+    for (int i=0; i < OID_LAST; ++i, ++od) {
+        if (!OPTIONHasOVariable(od)) {
+            continue;
+        }
+        (void)setOptionVariable (od, parsed.oVariables, oVariables);
+        // NOPTION entries have no variable and offset zero
+        if ((OPTION_type(od) == OT_CSTRING) && (OPTION_offset(od) != 0)) {
+            // The values may be owned by "parsed", hence keep a copy
+            OT_CSTRING_t* o = reinterpret_cast<OT_CSTRING_t*>(OPTION_var(i, oVariables));
+            if (*o != NULL) {
+                size_t len = ::strlen(*o);
+                char* cs = new char[len + 1];
+                ::memcpy(cs, *o, len + 1);
+                recordMemoryHandle(cs);
+                *o = cs;
+            }
+        }
+    }
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        flags[i] |= parsed.flags[i];
+    }
+
+    clcOptions += parsed.clcOptions;
+    clangOptions.insert(clangOptions.end(), parsed.clangOptions.begin(),
+                        parsed.clangOptions.end());
+    llvmOptions += parsed.llvmOptions;
+    finalizerOptions.insert(finalizerOptions.end(), parsed.finalizerOptions.begin(),
+                            parsed.finalizerOptions.end());
+    if (!parsed.useDefaultWGS()) {
+        for (int i = 0; i < 3; ++i) {
+            WorkGroupSize[i] = parsed.WorkGroupSize[i];
+        }
+        setDefaultWGS(false);
+    }
+    OptionsLog += parsed.OptionsLog;
+    setupLLVMArgs();
+}
+
+void
+Options::setupLLVMArgs()
+{
+    // Set up llvmargv if llvmOptions is not empty
+    if (!llvmOptions.empty()) {
+        std::string*  ostr = &llvmOptions;
+        int n;
+        size_t pos1, pos2;
+        pos1 = ostr->find_first_not_of(' ');
+        for (n=0; pos1 != std::string::npos; ++n) {
+            pos2 = ostr->find_first_of(' ', pos1);
+            if (pos2 != std::string::npos) {
+                pos2 = ostr->find_first_not_of(' ', pos2);
+            }
+            pos1 = pos2;
+        }
+        if (n > 0) {
+            char* data = new char [sizeof(char*) * (n+1) +   // for argv[0:n]
+                                   ostr->size() + 1];    // for all option chars
+            char** t_argv  = (char**)data;
+            static char pseudoCmdName[] = "llvmOptCodegen";
+
+            t_argv[0] = &pseudoCmdName[0];   // pseudo command name
+            setLLVMArgs(n+1, t_argv);
+            recordMemoryHandle(data);
+
+            // Initialize all arguments
+            t_argv++;
+            data = (char*) (t_argv + n);
+            int i = 0;
+            pos1 = ostr->find_first_not_of(' ');
+            while (pos1 != std::string::npos) {
+                pos2 = ostr->find_first_of(' ', pos1);
+                size_t len;
+                if (pos2 == std::string::npos) {
+                    len = ostr->size() - pos1;
+                }
+                else {
+                    len = pos2 - pos1;
+                    pos2 = ostr->find_first_not_of(' ', pos2);
+                }
+                ostr->copy(data, len, pos1);
+                data[len] = 0;
+                t_argv[i++] = data;
+                data += (len+1);
+                pos1 = pos2;
+            }
+        }
+    }
+}
+
 std::string Options::getStringFromStringVec(std::vector<std::string>& stringVec)
 {
     const char* const delim = " ";
@@ -303,6 +303,13 @@ public:
     // Set the option variables same as defined in "other"
     bool setOptionVariablesAs(const Options& other);
 
+    // Apply the result of parseAllOptions() in "parsed" as if its option string was parsed
+    // into this set of options
+    void setParsedOptionsAs(const Options& parsed);
+
+    // Set up llvmargv from llvmOptions
+    void setupLLVMArgs();
+
     std::string getFinalizerOptions() { return getStringFromStringVec(finalizerOptions); }
 
 private:
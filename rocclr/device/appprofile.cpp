@@ -21,9 +21,14 @@
 #include "top.hpp"
 #include "os/os.hpp"
 #include "utils/flags.hpp"
+#include "utils/debug.hpp"
 #include "appprofile.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
 
 
 #define GETPROCADDRESS(_adltype_, _adlfunc_) (_adltype_) amd::Os::getSymbol(adlHandle_, #_adlfunc_);
@@ -66,6 +71,7 @@ bool AppProfile::init() {
 
   delete[] appName;
 
+  ApplyPresets();
   ParseApplicationProfile();
 
   return true;
@@ -74,4 +80,123 @@ bool AppProfile::init() {
 bool AppProfile::ParseApplicationProfile() {
   return true;
 }
+
+namespace {
+
+constexpr int kPresetVersion = 1;
+
+std::string Trim(const std::string& str) {
+  const size_t begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  return str.substr(begin, str.find_last_not_of(" \t\r") - begin + 1);
+}
+
+std::string ToLower(std::string str) {
+  std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+  return str;
+}
+
+//! Returns the lower case file names of the loaded libraries
+std::vector<std::string> LoadedLibraries() {
+  std::vector<std::string> libs;
+#if !defined(_WIN32)
+  std::ifstream maps("/proc/self/maps");
+  std::string line;
+  while (std::getline(maps, line)) {
+    const size_t slash = line.rfind('/');
+    if (slash != std::string::npos) {
+      std::string name = ToLower(line.substr(slash + 1));
+      if (std::find(libs.begin(), libs.end(), name) == libs.end()) {
+        libs.push_back(name);
+      }
+    }
+  }
+#endif
+  return libs;
+}
+
+}  // namespace
+
+bool AppProfile::ApplyPresets() {
+  if (ROC_APP_PROFILE_FILE[0] == '\0') {
+    return true;
+  }
+  std::ifstream file(ROC_APP_PROFILE_FILE);
+  if (!file.is_open()) {
+    ClPrint(LOG_WARNING, LOG_INIT, "Unable to open the app profile %s", ROC_APP_PROFILE_FILE);
+    return false;
+  }
+
+  const std::string app = ToLower(appFileName_);
+  std::vector<std::string> libs;
+  bool libs_loaded = false;
+  bool version_found = false;
+  bool active = false;
+  std::map<std::string, std::string> presets;
+  std::string line;
+  for (uint line_num = 1; std::getline(file, line); ++line_num) {
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    if (!version_found) {
+      // The version is the first entry, the file of another version isn't applied
+      int version = 0;
+      if ((sscanf(line.c_str(), "version %d", &version) != 1) || (version != kPresetVersion)) {
+        ClPrint(LOG_WARNING, LOG_INIT, "App profile %s has no version %d header",
+                ROC_APP_PROFILE_FILE, kPresetVersion);
+        return false;
+      }
+      version_found = true;
+      continue;
+    }
+    if (line.front() == '[') {
+      const size_t end = line.find(']');
+      const std::string section = Trim(line.substr(1, end - 1));
+      const size_t space = section.find_first_of(" \t");
+      const std::string kind = section.substr(0, space);
+      const std::string name = (space == std::string::npos) ? "" :
+                               ToLower(Trim(section.substr(space)));
+      if ((end == std::string::npos) || name.empty() || ((kind != "app") && (kind != "lib"))) {
+        ClPrint(LOG_WARNING, LOG_INIT, "App profile line %u: invalid section", line_num);
+        active = false;
+      } else if (kind == "app") {
+        active = (app == name);
+      } else {
+        if (!libs_loaded) {
+          libs = LoadedLibraries();
+          libs_loaded = true;
+        }
+        // The library names match without the version suffix, e.g. librocblas matches
+        // librocblas.so.4
+        active = std::any_of(libs.begin(), libs.end(), [&name](const std::string& lib) {
+          return (lib.compare(0, name.size(), name) == 0) &&
+                 ((lib.size() == name.size()) || (lib[name.size()] == '.'));
+        });
+      }
+      continue;
+    }
+    const size_t equal = line.find('=');
+    if (equal == std::string::npos) {
+      ClPrint(LOG_WARNING, LOG_INIT, "App profile line %u: expected FLAG = value", line_num);
+      continue;
+    }
+    if (active) {
+      presets[Trim(line.substr(0, equal))] = Trim(line.substr(equal + 1));
+    }
+  }
+
+  for (const auto& it : presets) {
+    // The string flags keep the pointer, hence the values live until the process exits
+    const char* value = strdup(it.second.c_str());
+    if (!Flag::setIfDefault(it.first.c_str(), value)) {
+      ClPrint(LOG_INFO, LOG_INIT, "App profile skips %s, the flag is unknown or set already",
+              it.first.c_str());
+      free(const_cast<char*>(value));
+    }
+  }
+  return true;
+}
 }
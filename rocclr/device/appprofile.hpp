@@ -61,6 +61,11 @@ class AppProfile {
 
   virtual bool ParseApplicationProfile();
 
+  //! Applies the flag presets of ROC_APP_PROFILE_FILE, which match the application or a loaded
+  //! library. The file starts with "version 1" and lists the flags in the sections
+  //! "[app name]" and "[lib name]" as "FLAG = value". The later sections take precedence.
+  bool ApplyPresets();
+
   bool gpuvmHighAddr_;                // Currently not used.
   bool profileOverridesAllSettings_;  // Overrides hint flags and env.var.
   std::string buildOptsAppend_;
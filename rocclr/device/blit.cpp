@@ -21,6 +21,7 @@
 #include "platform/commandqueue.hpp"
 #include "device/device.hpp"
 #include "device/blit.hpp"
+#include "thread/threadpool.hpp"
 #include "utils/debug.hpp"
 
 #include <cmath>
@@ -576,11 +577,34 @@ bool HostBlitManager::fillBuffer(device::Memory& memory, const void* pattern, si
     LogError("Misaligned buffer size and pattern size!");
   }
 
-  // Fill the buffer memory with a pattern
-  for (size_t i = 0; i < (fillSize / patternSize); i++) {
-    memcpy((reinterpret_cast<address>(fillMem) + offset),
-           (reinterpret_cast<const_address>(pattern)), patternSize);
-    offset += patternSize;
+  // Fill the first chunk by doubling the pattern, then copy the chunk over the rest. The chunk
+  // is a multiple of the pattern, hence all copies keep the pattern phase
+  constexpr size_t kChunkSize = 4 * Mi;
+  constexpr size_t kParallelFillSize = 16 * Mi;
+  constexpr uint32_t kFillThreads = 8;
+  address dst = reinterpret_cast<address>(fillMem) + offset;
+  const size_t total = (fillSize / patternSize) * patternSize;
+  const size_t chunk = std::min(total, std::max(kChunkSize / patternSize, size_t(1)) * patternSize);
+  if (chunk != 0) {
+    memcpy(dst, pattern, patternSize);
+    for (size_t filled = patternSize; filled < chunk;) {
+      const size_t copy = std::min(filled, chunk - filled);
+      memcpy(dst + filled, dst, copy);
+      filled += copy;
+    }
+    const size_t chunks = amd::alignUp(total, chunk) / chunk;
+    auto copyChunk = [=](size_t i) {
+      const size_t chunkOffset = (i + 1) * chunk;
+      memcpy(dst + chunkOffset, dst, std::min(chunk, total - chunkOffset));
+    };
+    if (total >= kParallelFillSize) {
+      // Large pinned fills are bound by the CPU memory bandwidth, hence split them
+      amd::ThreadPool::shared().parallelFor(chunks - 1, copyChunk, kFillThreads);
+    } else {
+      for (size_t i = 0; i < (chunks - 1); ++i) {
+        copyChunk(i);
+      }
+    }
   }
 
   // Unmap source and destination memory
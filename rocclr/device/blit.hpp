@@ -233,6 +233,29 @@ class BlitManager : public amd::HeapObject {
                              uint64_t mask
   ) const = 0;
 
+  //! The region of a batched buffer copy in the device virtual addresses
+  struct CopyRegion {
+    uint64_t src_;   //!< Source address
+    uint64_t dst_;   //!< Destination address
+    uint64_t size_;  //!< Size of the copy region
+  };
+
+  //! Copies many small regions with a single launch. Returns false if the regions need
+  //! the per region copies
+  virtual bool copyBufferBatch(const std::vector<CopyRegion>& regions  //!< Copy regions
+                               ) const {
+    return false;
+  }
+
+  //! Writes the payload into the regions with a single launch, the source of every region is
+  //! the offset of its data in the payload. Returns false if the writes need the blit writes
+  virtual bool writeBufferInline(const std::vector<CopyRegion>& regions,  //!< Write regions
+                                 const void* payload,                     //!< Data of the writes
+                                 size_t payloadSize                       //!< Payload size
+                                 ) const {
+    return false;
+  }
+
   //! Enables synchronization on blit operations
   void enableSynchronization() { syncOperation_ = true; }
 
@@ -52,15 +52,27 @@ const char* BlitLinearSourceCode = BLIT_KERNELS(
     uint pattern_size, uint alignment, ulong end_ptr, uint next_chunk) {
     int id = get_global_id(0);
     long cur_id = id * pattern_size;
+    // Bit 8 of the alignment requests non-temporal stores
+    uint non_temporal = alignment & 0x100;
+    alignment &= 0xff;
     if (alignment == sizeof(ulong2)) {
       __global ulong2* bufULong2 = (__global ulong2*)buf;
       __global ulong2* element = &bufULong2[cur_id];
       __constant ulong2* pt = (__constant ulong2*)pattern;
-      while ((ulong)element < end_ptr) {
-        for (uint i = 0; i < pattern_size; ++i) {
-          element[i] = pt[i];
+      if (non_temporal) {
+        while ((ulong)element < end_ptr) {
+          for (uint i = 0; i < pattern_size; ++i) {
+            __builtin_nontemporal_store(pt[i], &element[i]);
+          }
+          element += next_chunk;
+        }
+      } else {
+        while ((ulong)element < end_ptr) {
+          for (uint i = 0; i < pattern_size; ++i) {
+            element[i] = pt[i];
+          }
+          element += next_chunk;
         }
-        element += next_chunk;
       }
     } else if (alignment == sizeof(ulong)) {
       __global ulong* bufULong = (__global ulong*)buf;
@@ -124,13 +136,23 @@ const char* BlitLinearSourceCode = BLIT_KERNELS(
                                           uint aligned_size, ulong end_ptr, uint next_chunk) {
     ulong id = get_global_id(0);
     ulong id_remainder = id;
+    // Bit 8 of the aligned size requests non-temporal loads and stores
+    uint non_temporal = aligned_size & 0x100;
+    aligned_size &= 0xff;
 
     if (aligned_size == sizeof(ulong2)) {
       __global ulong2* srcD = (__global ulong2*)(src);
       __global ulong2* dstD = (__global ulong2*)(dst);
-      while ((ulong)(&dstD[id]) < end_ptr) {
-        dstD[id] = srcD[id];
-        id += next_chunk;
+      if (non_temporal) {
+        while ((ulong)(&dstD[id]) < end_ptr) {
+          __builtin_nontemporal_store(__builtin_nontemporal_load(&srcD[id]), &dstD[id]);
+          id += next_chunk;
+        }
+      } else {
+        while ((ulong)(&dstD[id]) < end_ptr) {
+          dstD[id] = srcD[id];
+          id += next_chunk;
+        }
       }
     } else {
       __global uint* srcD = (__global uint*)(src);
@@ -162,6 +184,28 @@ const char* BlitLinearSourceCode = BLIT_KERNELS(
                                                    ulong4 srcRect, ulong4 dstRect, ulong4 size) {
     __amd_copyBufferRectAligned(src, dst, srcRect, dstRect, size);
   }
+
+  __kernel void __amd_rocclr_copyBufferBatch(__global ulong* regions, uint count) {
+    // Every region is {src, dst, size}, a workgroup copies one region at a time
+    for (uint i = get_group_id(0); i < count; i += get_num_groups(0)) {
+      __global uchar* src = (__global uchar*)regions[3 * i];
+      __global uchar* dst = (__global uchar*)regions[3 * i + 1];
+      ulong size = regions[3 * i + 2];
+      ulong head = 0;
+      if ((((ulong)src | (ulong)dst) & (sizeof(ulong2) - 1)) == 0) {
+        __global ulong2* srcD = (__global ulong2*)(src);
+        __global ulong2* dstD = (__global ulong2*)(dst);
+        ulong vectors = size / sizeof(ulong2);
+        for (ulong id = get_local_id(0); id < vectors; id += get_local_size(0)) {
+          dstD[id] = srcD[id];
+        }
+        head = vectors * sizeof(ulong2);
+      }
+      for (ulong id = head + get_local_id(0); id < size; id += get_local_size(0)) {
+        dst[id] = src[id];
+      }
+    }
+  }
 );
 
 const char* HipExtraSourceCode = BLIT_KERNELS(
@@ -202,6 +246,26 @@ const char* HipExtraSourceCodeNoGWS = BLIT_KERNELS(
   }
 );
 
+// The timestamp kernel writes the GPU realtime counter into the start and end times of its own
+// completion signal, hence the timed markers don't need the profiling on the queue. The kernel
+// is optional, since the counter builtin isn't available in the older compilers
+const char* TimestampSourceCode = R"(
+#if __has_builtin(__builtin_readsteadycounter)
+  __kernel void __amd_rocclr_timestamp() {
+    __constant ulong* packet = (__constant ulong*)__builtin_amdgcn_dispatch_ptr();
+    // completion_signal of hsa_kernel_dispatch_packet_t
+    ulong signal = packet[7];
+    if (signal != 0) {
+      ulong now = __builtin_readsteadycounter();
+      // start_ts and end_ts of amd_signal_t
+      __global ulong* ts = (__global ulong*)(signal + 32);
+      ts[0] = now;
+      ts[1] = now;
+    }
+  }
+#endif
+)";
+
 const char* BlitImageSourceCode = BLIT_KERNELS(
   // Extern
   extern void __amd_fillImage(__write_only image2d_array_t, float4, int4, uint4, int4, int4,
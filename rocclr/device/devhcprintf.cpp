@@ -245,7 +245,16 @@ void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len) {
     stream = stderr;
   }
 
+  // The listeners of different devices print concurrently, keep every message in one piece
+#if defined(_WIN32)
+  _lock_file(stream);
   *output = format(stream, input, end);
+  _unlock_file(stream);
+#else
+  flockfile(stream);
+  *output = format(stream, input, end);
+  funlockfile(stream);
+#endif
 }
 
 // Extract the format string hash and the format string.
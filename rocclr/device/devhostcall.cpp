@@ -34,6 +34,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <map>
 #include <set>
 
 #if defined(__clang__)
@@ -95,6 +96,7 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
         amd::Memory* mem = amd::MemObjMap::FindMemObj(reinterpret_cast<void*>(payload[0]));
         if (mem) {
           amd::MemObjMap::RemoveMemObj(reinterpret_cast<void*>(payload[0]));
+          const_cast<amd::Device&>(dev).RecordHeapGrowth(-static_cast<int64_t>(mem->getSize()));
           mem->release();
         } else {
           ClPrint(amd::LOG_ERROR, amd::LOG_ALWAYS, "Hostcall: Unknown pointer %p in devmem service",
@@ -109,6 +111,7 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
             device::Memory* dm = buf->getDeviceMemory(dev);
             va = dm->virtualAddress();
             amd::MemObjMap::AddMemObj(reinterpret_cast<void*>(va), buf);
+            const_cast<amd::Device&>(dev).RecordHeapGrowth(static_cast<int64_t>(payload[1]));
           } else {
             buf->release();
           }
@@ -123,16 +126,17 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
   }
 }
 
-void HostcallBuffer::processPackets(MessageHandler& messages) {
+uint32_t HostcallBuffer::processPackets(MessageHandler& messages) {
   // Grab the entire ready stack and set the top to 0. New requests from the
   // device will continue pushing on the stack while we process the packets that
   // we have grabbed.
 
   uint64_t ready_stack = std::atomic_exchange_explicit(&ready_stack_, static_cast<uint64_t>(0), std::memory_order_acquire);
   if (!ready_stack) {
-    return;
+    return 0;
   }
 
+  uint32_t processed = 0;
   // Each wave can submit at most one packet at a time. The ready stack cannot
   // contain multiple packets from the same wave, so consuming ready packets in
   // a latest-first order does not affect ordering of hostcall within a wave.
@@ -163,7 +167,9 @@ void HostcallBuffer::processPackets(MessageHandler& messages) {
     }
 
     header->control_.store(resetReadyFlag(header->control_), std::memory_order_release);
+    ++processed;
   }
+  return processed;
 }
 
 static uintptr_t getHeaderStart() {
@@ -217,12 +223,19 @@ void HostcallBuffer::initialize(uint32_t num_packets) {
   ready_stack_ = 0;
 }
 
-/** \brief Manage a unique listener thread and its associated buffers.
+/** \brief Manage a listener thread and its associated buffers.
+ *
+ *  Every device gets its own listener with GPU_HOSTCALL_LISTENER_PER_DEVICE,
+ *  so the hostcalls of different devices don't queue behind one host core.
  */
 class HostcallListener {
   std::set<HostcallBuffer*> buffers_;
   device::Signal* doorbell_;
   MessageHandler messages_;
+  //! The device for the NUMA placement of the thread, nullptr if shared by all devices
+  const amd::Device* numa_device_ = nullptr;
+  //! Protects the buffers, so the listeners of different devices don't serialize
+  amd::Monitor lock_;
   // Keep track of devices for which signal creation have already been done
   std::set<const amd::Device*> devices_;
 #if defined(__clang__)
@@ -268,40 +281,38 @@ class HostcallListener {
   }
 
   void terminate();
-  bool initSignal(const amd::Device &dev);
+  bool initSignal(const amd::Device &dev, bool numa_local);
   bool initDevice(const amd::Device &dev);
 };
 
-HostcallListener* hostcallListener = nullptr;
+//! The listeners by device. A single listener under nullptr serves all devices
+//! if GPU_HOSTCALL_LISTENER_PER_DEVICE is off
+static std::map<const amd::Device*, HostcallListener*> hostcallListeners;
 extern amd::Monitor listenerLock;
 constexpr static uint64_t kTimeoutFloor = K * K * 4;
 constexpr static uint64_t kTimeoutCeil = K * K * 16;
 static struct Init {
-  enum class State {
-    kDefault = 0,
-    kInit,
-    kDestroy,
-    kExit
-  };
-  volatile State state = State::kDefault;
+  std::atomic<bool> destroy_{false};  //!< The process exits, the listener threads must leave
+  std::atomic<uint32_t> active_{0};   //!< The number of running listener threads
   ~Init() {
-    if (state == State::kInit) {
-      state = State::kDestroy;
-      // @note: Under Linux thread destruction can be delayed and
-      // ROCR may crash in a wait for event occasionally. Hence, runtime needs
-      // an early exit. The logic isn't required for Windows.
-      while (IS_LINUX && (state == State::kDestroy)) {}
-    }
+    destroy_ = true;
+    // @note: Under Linux thread destruction can be delayed and
+    // ROCR may crash in a wait for event occasionally. Hence, runtime needs
+    // an early exit. The logic isn't required for Windows.
+    while (IS_LINUX && (active_ != 0)) {}
   }
 } kHostThreadActive;
 void HostcallListener::consumePackets() {
   uint64_t timeout = kTimeoutFloor;
   uint64_t signal_value = SIGNAL_INIT;
-  kHostThreadActive.state = Init::State::kInit;
+  kHostThreadActive.active_++;
+  if (numa_device_ != nullptr) {
+    numa_device_->setThreadNumaAffinity();
+  }
   while (true) {
     while (true) {
-      if (kHostThreadActive.state == Init::State::kDestroy) {
-        kHostThreadActive.state = Init::State::kExit;
+      if (kHostThreadActive.destroy_) {
+        kHostThreadActive.active_--;
         return;
       }
       uint64_t new_value = doorbell_->Wait(signal_value, device::Signal::Condition::Ne, timeout);
@@ -318,16 +329,20 @@ void HostcallListener::consumePackets() {
     }
 
     if (signal_value == SIGNAL_DONE) {
+      kHostThreadActive.active_--;
       return;
     }
 
-    if (!idle()) {
-      amd::ScopedLock lock{listenerLock};
-
+    // The waves keep pushing packets while the listener handles a batch, hence drain the
+    // buffers until a pass finds nothing instead of a doorbell wait per batch
+    uint32_t processed = 0;
+    do {
+      amd::ScopedLock lock{lock_};
+      processed = 0;
       for (auto ii : buffers_) {
-        ii->processPackets(messages_);
+        processed += ii->processPackets(messages_);
       }
-    }
+    } while (processed != 0);
   }
 
   return;
@@ -335,7 +350,6 @@ void HostcallListener::consumePackets() {
 
 void HostcallListener::terminate() {
   if (thread_.state() >= Thread::FINISHED || amd::Os::isThreadAlive(thread_)) {
-    kHostThreadActive.state = Init::State::kExit;
     doorbell_->Reset(SIGNAL_DONE);
 
     // FIXME_lmoriche: fix termination handshake
@@ -354,6 +368,7 @@ void HostcallListener::terminate() {
 }
 
 void HostcallListener::addBuffer(HostcallBuffer* buffer) {
+  amd::ScopedLock lock(lock_);
   assert(buffers_.count(buffer) == 0 && "buffer already present");
   buffer->setDoorbell(doorbell_->getHandle());
 #if defined(__clang__)
@@ -365,11 +380,15 @@ void HostcallListener::addBuffer(HostcallBuffer* buffer) {
 }
 
 void HostcallListener::removeBuffer(HostcallBuffer* buffer) {
+  amd::ScopedLock lock(lock_);
   assert(buffers_.count(buffer) != 0 && "unknown buffer");
   buffers_.erase(buffer);
 }
 
-bool HostcallListener::initSignal(const amd::Device &dev) {
+bool HostcallListener::initSignal(const amd::Device &dev, bool numa_local) {
+  if (numa_local) {
+    numa_device_ = &dev;
+  }
   doorbell_ = dev.createSignal();
   initDevice(dev);
 #if defined(__clang__)
@@ -416,20 +435,22 @@ bool enableHostcalls(const amd::Device &dev, void* bfr, uint32_t numPackets) {
   buffer->setDevice(&dev);
 
   amd::ScopedLock lock(listenerLock);
+  const amd::Device* key = GPU_HOSTCALL_LISTENER_PER_DEVICE ? &dev : nullptr;
+  HostcallListener*& hostcallListener = hostcallListeners[key];
   if (!hostcallListener) {
     hostcallListener = new HostcallListener();
-    if (!hostcallListener->initSignal(dev)) {
+    if (!hostcallListener->initSignal(dev, key != nullptr)) {
       ClPrint(amd::LOG_ERROR, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
               "Failed to launch hostcall listener");
       delete hostcallListener;
-      hostcallListener = nullptr;
+      hostcallListeners.erase(key);
       return false;
     }
     ClPrint(amd::LOG_INFO, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
-            "Launched hostcall listener at %p", hostcallListener);
+            "Launched hostcall listener at %p for device %p", hostcallListener, key);
   }
 // For PAL, create one signal per device (inside hostcallListener->initDevice(dev)) whose pointer is stored in this hostcall buffer
-// For ROCr, create only one signal across all devices (inside hostcallListener->initSignal(dev)) whose pointer is stored in every hostcall buffer
+// For ROCr, create one signal per listener (inside hostcallListener->initSignal(dev)) whose pointer is stored in its hostcall buffers
 #if defined(WITH_PAL_DEVICE)
   else if (!hostcallListener->initDevice(dev)) {
     ClPrint(amd::LOG_ERROR, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
@@ -444,20 +465,24 @@ bool enableHostcalls(const amd::Device &dev, void* bfr, uint32_t numPackets) {
 }
 
 void disableHostcalls(void* bfr) {
+  HostcallListener* hostcallListener = nullptr;
   {
     amd::ScopedLock lock(listenerLock);
-    if (!hostcallListener) {
-      return;
-    }
     assert(bfr && "expected a hostcall buffer");
     auto buffer = reinterpret_cast<HostcallBuffer*>(bfr);
-    hostcallListener->removeBuffer(buffer);
-  }
-  if (hostcallListener->idle()) {
-    hostcallListener->terminate();
-    delete hostcallListener;
-    hostcallListener = nullptr;
-    ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Terminated hostcall listener");
+    auto it = hostcallListeners.find(GPU_HOSTCALL_LISTENER_PER_DEVICE ? buffer->device() : nullptr);
+    if (it == hostcallListeners.end()) {
+      return;
+    }
+    it->second->removeBuffer(buffer);
+    if (!it->second->idle()) {
+      return;
+    }
+    hostcallListener = it->second;
+    hostcallListeners.erase(it);
   }
+  hostcallListener->terminate();
+  delete hostcallListener;
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Terminated hostcall listener");
 }
 }// namespace amd
@@ -161,10 +161,12 @@ class HostcallBuffer {
   Payload* getPayload(uint64_t ptr) const;
 
  public:
-  void processPackets(MessageHandler& messages);
+  //! Handles the packets ready at the call, returns the number of the handled packets
+  uint32_t processPackets(MessageHandler& messages);
   void initialize(uint32_t num_packets);
   void setDoorbell(void* doorbell) { doorbell_ = doorbell; };
   void setDevice(const amd::Device* dptr) { device_ = dptr; };
+  const amd::Device* device() const { return device_; }
 
  #if defined(__clang__)
  #if __has_feature(address_sanitizer)
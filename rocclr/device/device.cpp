@@ -71,6 +71,64 @@ namespace {
 
 constexpr char hsaIsaNamePrefix[] = "amdgcn-amd-amdhsa--";
 
+// Returns the blit cache file for the kernels compiled with the options, empty if disabled.
+// The name depends on everything the compiled code depends on: the ISA, the runtime build,
+// the compiler version, the options and the source code.
+std::string BlitCacheFileName(const amd::Device& device, const std::string& kernels,
+                              const std::string& options) {
+  std::string path = GPU_BLIT_CACHE_PATH;
+  size_t major = 0, minor = 0;
+#if defined(USE_COMGR_LIBRARY)
+  if (path.empty() || !amd::Comgr::IsReady()) {
+    return std::string();
+  }
+  amd::Comgr::get_version(&major, &minor);
+#else
+  return std::string();
+#endif
+  std::string key = std::string(device.isa().isaName()) + AMD_PLATFORM_INFO +
+                    std::to_string(major) + "." + std::to_string(minor) + options + kernels;
+  // FNV-1a hash of the key
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "blit_%016llx_%zx.co", static_cast<unsigned long long>(hash),
+           key.size());
+  return path + amd::Os::fileSeparator() + name;
+}
+
+// Reads the cached blit code object
+bool LoadBlitCache(const std::string& file_name, std::vector<char>& binary) {
+  std::ifstream file(file_name, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+  if (!file.good()) {
+    return false;
+  }
+  binary.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(binary.data(), binary.size());
+  return file.good() && !binary.empty();
+}
+
+// Writes the blit code object into the cache. The temporary file is renamed, so a concurrent
+// process never reads a partial file
+void StoreBlitCache(const std::string& file_name, const void* binary, size_t size) {
+  if (!amd::Os::createPath(GPU_BLIT_CACHE_PATH)) {
+    return;
+  }
+  std::string tmp_name = file_name + "." + std::to_string(amd::Os::getProcessId()) + ".tmp";
+  std::ofstream file(tmp_name, std::ios_base::out | std::ios_base::binary |
+                     std::ios_base::trunc);
+  file.write(reinterpret_cast<const char*>(binary), size);
+  file.close();
+  if (!file.good() || (std::rename(tmp_name.c_str(), file_name.c_str()) != 0)) {
+    std::remove(tmp_name.c_str());
+    return;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Stored the blit kernels into %s", file_name.c_str());
+}
+
 } // namespace
 
 namespace amd::device {
@@ -95,7 +153,7 @@ static_assert(static_cast<uint32_t>(device::Memory::MemAccess::kMemAccessReadWri
 
 namespace amd {
 
-amd::Monitor Device::lockP2P_("Lock P2P ON/OFF");
+amd::Monitor Device::lockP2P_("Lock P2P ON/OFF", true);
 std::pair<const Isa*, const Isa*> Isa::supportedIsas() {
   constexpr amd::Isa::Feature NONE = amd::Isa::Feature::Unsupported;
   constexpr amd::Isa::Feature ANY  = amd::Isa::Feature::Any;
@@ -324,16 +382,22 @@ AppProfile Device::appProfile_;
 
 Context* Device::glb_ctx_ = nullptr;
 // P2P Staging Lock
-Monitor Device::p2p_stage_ops_(true);
+Monitor Device::p2p_stage_ops_("P2P staging lock", true);
 Memory* Device::p2p_stage_ = nullptr;
+std::map<std::pair<const Device*, const Device*>, Device::P2PStageSlot*> Device::p2p_stages_;
+Device::P2PStageSlot Device::p2p_shared_stage_;
 
 std::shared_mutex MemObjMap::AllocatedLock_ ROCCLR_INIT_PRIORITY(101);
 std::map<uintptr_t, amd::Memory*> MemObjMap::MemObjMap_ ROCCLR_INIT_PRIORITY(101);
 std::map<uintptr_t, amd::Memory*> MemObjMap::VirtualMemObjMap_ ROCCLR_INIT_PRIORITY(101);
+std::atomic<uint64_t> MemObjMap::Generation_ = 0;
+thread_local MemObjMap::LookupCache MemObjMap::MemObjCache_;
+thread_local MemObjMap::LookupCache MemObjMap::VirtualMemObjCache_;
 
 void MemObjMap::AddMemObj(const void* k, amd::Memory* v) {
   std::unique_lock lock(AllocatedLock_);
   auto rval = MemObjMap_.insert({ reinterpret_cast<uintptr_t>(k), v });
+  Generation_.fetch_add(1, std::memory_order_release);
   if (!rval.second) {
     DevLogPrintfError("Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
@@ -343,15 +407,16 @@ void MemObjMap::AddMemObj(const void* k, amd::Memory* v) {
 void MemObjMap::RemoveMemObj(const void* k) {
   std::unique_lock lock(AllocatedLock_);
   auto rval = MemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
+  Generation_.fetch_add(1, std::memory_order_release);
   guarantee(rval == 1, "Memobj map does not have ptr: 0x%x",
                         reinterpret_cast<uintptr_t>(k));
 }
 
-amd::Memory* MemObjMap::FindMemObj(const void* k, size_t* offset) {
+amd::Memory* MemObjMap::FindInMap(const std::map<uintptr_t, amd::Memory*>& map,
+                                  LookupCache& cache, uintptr_t key, size_t* offset) {
   std::shared_lock lock(AllocatedLock_);
-  uintptr_t key = reinterpret_cast<uintptr_t>(k);
-  auto it = MemObjMap_.upper_bound(key);
-  if (it == MemObjMap_.begin()) {
+  auto it = map.upper_bound(key);
+  if (it == map.begin()) {
     return nullptr;
   }
 
@@ -361,6 +426,11 @@ amd::Memory* MemObjMap::FindMemObj(const void* k, size_t* offset) {
     if (offset != nullptr) {
       *offset = key - it->first;
     }
+    // The generation can't change while the shared lock is held
+    cache.base_ = it->first;
+    cache.end_ = it->first + mem->getSize();
+    cache.mem_ = mem;
+    cache.generation_ = Generation_.load(std::memory_order_relaxed);
     // the k is in the range
     return mem;
   } else {
@@ -368,6 +438,16 @@ amd::Memory* MemObjMap::FindMemObj(const void* k, size_t* offset) {
   }
 }
 
+amd::Memory* MemObjMap::FindMemObj(const void* k, size_t* offset) {
+  uintptr_t key = reinterpret_cast<uintptr_t>(k);
+  // Repeated lookups of the same allocation don't need the lock
+  amd::Memory* mem = FindCached(MemObjCache_, key, offset);
+  if (mem != nullptr) {
+    return mem;
+  }
+  return FindInMap(MemObjMap_, MemObjCache_, key, offset);
+}
+
 void MemObjMap::UpdateAccess(amd::Device *peerDev) {
   if (peerDev == nullptr) {
     return;
@@ -376,11 +456,18 @@ void MemObjMap::UpdateAccess(amd::Device *peerDev) {
   // hsa_amd_agents_allow_access was not called because there was no peer
   std::shared_lock lock(AllocatedLock_);
   for (auto it : MemObjMap_) {
-    const std::vector<Device*>& devices = it.second->getContext().devices();
+    amd::Memory* memory = it.second;
+    void* ptr = reinterpret_cast<void*>(it.first);
+    if ((memory->parent() != nullptr) && (memory->parent()->getSvmPtr() != nullptr)) {
+      // The views share the mapping of the parent, hence the parent is updated once for all views
+      memory = memory->parent();
+      ptr = memory->getSvmPtr();
+    }
+    const std::vector<Device*>& devices = memory->getContext().devices();
     if (devices.size() == 1 && devices[0] == peerDev) {
-      device::Memory* devMem = it.second->getDeviceMemory(*devices[0]);
+      device::Memory* devMem = memory->getDeviceMemory(*devices[0]);
       if (!devMem->getAllowedPeerAccess()) {
-        peerDev->deviceAllowAccess(reinterpret_cast<void*>(it.first));
+        peerDev->deviceAllowAccess(ptr);
         devMem->setAllowedPeerAccess(true);
       }
     }
@@ -397,6 +484,7 @@ void MemObjMap::Purge(amd::Device* dev) {
     if (devices.size() == 1 && devices[0] == dev && !(flags & ROCCLR_MEM_INTERNAL_MEMORY)) {
       memObj->release();
       it = MemObjMap_.erase(it);
+      Generation_.fetch_add(1, std::memory_order_release);
     } else {
       ++it;
     }
@@ -406,6 +494,7 @@ void MemObjMap::Purge(amd::Device* dev) {
 void MemObjMap::AddVirtualMemObj(const void* k, amd::Memory* v) {
   std::unique_lock lock(AllocatedLock_);
   auto rval = VirtualMemObjMap_.insert({ reinterpret_cast<uintptr_t>(k), v });
+  Generation_.fetch_add(1, std::memory_order_release);
   if (!rval.second) {
     DevLogPrintfError("Virtual Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
@@ -415,26 +504,18 @@ void MemObjMap::AddVirtualMemObj(const void* k, amd::Memory* v) {
 void MemObjMap::RemoveVirtualMemObj(const void* k) {
   std::unique_lock lock(AllocatedLock_);
   auto rval = VirtualMemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
+  Generation_.fetch_add(1, std::memory_order_release);
   guarantee(rval == 1, "Virtual Memobj map does not have ptr: 0x%x",
                        reinterpret_cast<uintptr_t>(k));
 }
 
 amd::Memory* MemObjMap::FindVirtualMemObj(const void* k) {
-  std::shared_lock lock(AllocatedLock_);
   uintptr_t key = reinterpret_cast<uintptr_t>(k);
-  auto it = VirtualMemObjMap_.upper_bound(key);
-  if (it == VirtualMemObjMap_.begin()) {
-    return nullptr;
-  }
-
-  --it;
-  amd::Memory* mem = it->second;
-  if (key >= it->first && key < (it->first + mem->getSize())) {
-    // the k is in the range
+  amd::Memory* mem = FindCached(VirtualMemObjCache_, key, nullptr);
+  if (mem != nullptr) {
     return mem;
-  } else {
-    return nullptr;
   }
+  return FindInMap(VirtualMemObjMap_, VirtualMemObjCache_, key, nullptr);
 }
 
 //==================================================================================================
@@ -553,6 +634,7 @@ Device::BlitProgram::~BlitProgram() {
 
 bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKernels,
                                  const std::string& extraOptions) {
+  StartupProfile::Scope scope(StartupProfile::BlitBuild);
   std::vector<amd::Device*> devices;
   devices.push_back(device);
   int32_t retval = CL_SUCCESS;
@@ -567,14 +649,6 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
     kernels += extraKernels;
   }
 
-  // Create a program with all blit kernels
-  program_ = new Program(*context_, kernels.c_str(), Program::OpenCL_C);
-  if (program_ == nullptr) {
-    DevLogPrintfError("Program creation for Kernel: %s failed\n",
-                      kernels.c_str());
-    return false;
-  }
-
   // Build all kernels
   std::string opt = "-cl-internal-kernel ";
   if (!device->settings().useLightning_) {
@@ -595,6 +669,35 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
   opt += " -fsanitize=address ";
 #endif
 #endif
+
+  // Load the kernels, compiled by a previous process, and compile only on a cache miss
+  std::string cache_file;
+  if (device->settings().useLightning_) {
+    cache_file = BlitCacheFileName(*device, kernels, opt);
+  }
+  std::vector<char> binary;
+  if (!cache_file.empty() && LoadBlitCache(cache_file, binary)) {
+    program_ = new Program(*context_);
+    if ((program_->addDeviceProgram(*device, binary.data(), binary.size()) == CL_SUCCESS) &&
+        (program_->build(devices, opt.c_str(), nullptr, nullptr, GPU_DUMP_BLIT_KERNELS) ==
+         CL_SUCCESS) && program_->load()) {
+      ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Loaded the blit kernels from %s",
+              cache_file.c_str());
+      return true;
+    }
+    // The cached binary is unusable, fall back to the compilation
+    program_->release();
+    program_ = nullptr;
+  }
+
+  // Create a program with all blit kernels
+  program_ = new Program(*context_, kernels.c_str(), Program::OpenCL_C);
+  if (program_ == nullptr) {
+    DevLogPrintfError("Program creation for Kernel: %s failed\n",
+                      kernels.c_str());
+    return false;
+  }
+
   if ((retval = program_->build(devices, opt.c_str(), nullptr, nullptr, GPU_DUMP_BLIT_KERNELS))
       != CL_SUCCESS) {
     DevLogPrintfError("Build failed for Kernel: %s with error code %d\n",
@@ -606,6 +709,14 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
     return false;
   }
 
+  if (!cache_file.empty()) {
+    const device::Program* dev_program = program_->getDeviceProgram(*device);
+    if (dev_program != nullptr) {
+      device::Program::binary_t executable = dev_program->binary();
+      StoreBlitCache(cache_file, executable.first, executable.second);
+    }
+  }
+
   return true;
 }
 
@@ -680,6 +791,12 @@ Device::Device()
 }
 
 Device::~Device() {
+  if (heap_grow_count_ != 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Device heap grew %llu times, peak %llu KiB over the "
+            "initial %llu KiB", static_cast<unsigned long long>(heap_grow_count_),
+            static_cast<unsigned long long>(heap_growth_peak_ / Ki),
+            static_cast<unsigned long long>(initial_heap_size_ / Ki));
+  }
   if (heap_buffer_ != nullptr) {
     delete heap_buffer_;
     heap_buffer_ = nullptr;
@@ -920,6 +1037,42 @@ bool Device::disableP2P(amd::Device* ptrDev) {
   return true;
 }
 
+Device::P2PStageSlot* Device::P2PStage(Device* src, Device* dst) const {
+  amd::ScopedLock lock(p2p_stage_ops_);
+  auto& slot = p2p_stages_[{src, dst}];
+  if (slot != nullptr) {
+    return slot;
+  }
+  // A dedicated buffer per pair lets the transfers between different pairs run concurrently
+  amd::Buffer* buf = new (GlbCtx()) amd::Buffer(GlbCtx(), CL_MEM_ALLOC_HOST_PTR, kP2PStagingSize);
+  if ((buf != nullptr) && buf->create()) {
+    if ((buf->getDeviceMemory(*src) != nullptr) && (buf->getDeviceMemory(*dst) != nullptr)) {
+      slot = new P2PStageSlot();
+      slot->buffer_ = buf;
+      return slot;
+    }
+    buf->release();
+  } else {
+    delete buf;
+  }
+  LogWarning("P2P staging falls back to the global buffer");
+  p2p_shared_stage_.buffer_ = p2p_stage_;
+  slot = &p2p_shared_stage_;
+  return slot;
+}
+
+void Device::ReleaseP2PStages() {
+  amd::ScopedLock lock(p2p_stage_ops_);
+  for (auto& it : p2p_stages_) {
+    if (it.second != &p2p_shared_stage_) {
+      it.second->buffer_->release();
+      delete it.second;
+    }
+  }
+  p2p_stages_.clear();
+  p2p_shared_stage_.buffer_ = nullptr;
+}
+
 bool Device::UpdateStackSize(uint64_t stackSize) {
   // Amount of space used by each wave is in units of 256 dwords.
   // As per COMPUTE_TMPRING_SIZE.WAVE_SIZE 24:12
@@ -941,6 +1094,19 @@ bool Device::UpdateInitialHeapSize(uint64_t initialHeapSize) {
   return true;
 }
 
+void Device::RecordHeapGrowth(int64_t size) {
+  uint64_t growth = heap_growth_.fetch_add(static_cast<uint64_t>(size)) + size;
+  if (size > 0) {
+    ++heap_grow_count_;
+    uint64_t peak = heap_growth_peak_;
+    while ((growth > peak) && !heap_growth_peak_.compare_exchange_weak(peak, growth)) {
+    }
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Device heap grew by %llu KiB to %llu KiB over the "
+            "initial heap", static_cast<unsigned long long>(size / Ki),
+            static_cast<unsigned long long>(growth / Ki));
+  }
+}
+
 char* Device::getExtensionString() {
   std::stringstream extStream;
   size_t size;
@@ -1089,6 +1255,83 @@ Settings::Settings() : value_(0) {
   gwsInitSupported_ = true;
 }
 
+namespace {
+
+// Parses a single "processor:key=value,..." entry of the transfer tuning table
+bool ParseXferTuning(const std::string& entry, XferTuning* tuning) {
+  const size_t colon = entry.find(':');
+  if ((colon == 0) || (colon == std::string::npos)) {
+    return false;
+  }
+  tuning->processor_ = entry.substr(0, colon);
+  std::stringstream values(entry.substr(colon + 1));
+  std::string item;
+  while (std::getline(values, item, ',')) {
+    const size_t equal = item.find('=');
+    if (equal == std::string::npos) {
+      return false;
+    }
+    const std::string key = item.substr(0, equal);
+    char* end = nullptr;
+    const size_t value = strtoull(item.c_str() + equal + 1, &end, 0) * Ki;
+    if ((end == item.c_str() + equal + 1) || (*end != '\0')) {
+      return false;
+    }
+    if (key == "pinned") {
+      tuning->pinnedXferSize_ = value;
+    } else if (key == "pinned_min") {
+      tuning->pinnedMinXferSize_ = value;
+    } else if (key == "staged") {
+      tuning->stagedXferSize_ = value;
+    } else if (key == "blit") {
+      tuning->blitCopySize_ = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const XferTuning* XferTuning::Find(const std::string& processor) {
+  static const std::vector<XferTuning> table = [] {
+    std::vector<XferTuning> entries;
+    std::string data = GPU_XFER_TUNING;
+    // The flag may name a file with the table
+    std::ifstream file(data);
+    if (!data.empty() && file.good()) {
+      std::stringstream content;
+      content << file.rdbuf();
+      data = content.str();
+    }
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t end = std::min(data.find_first_of(";\n", pos), data.size());
+      std::string entry = data.substr(pos, end - pos);
+      pos = end + 1;
+      entry.erase(std::remove_if(entry.begin(), entry.end(), ::isspace), entry.end());
+      if (entry.empty() || (entry[0] == '#')) {
+        continue;
+      }
+      XferTuning tuning = {};
+      if (ParseXferTuning(entry, &tuning)) {
+        entries.push_back(tuning);
+      } else {
+        LogPrintfWarning("Ignored the transfer tuning entry \"%s\"", entry.c_str());
+      }
+    }
+    return entries;
+  }();
+
+  for (const auto& it : table) {
+    if (it.processor_ == processor) {
+      return &it;
+    }
+  }
+  return nullptr;
+}
+
 void Memory::saveMapInfo(const void* mapAddress, const amd::Coord3D origin,
                          const amd::Coord3D region, uint mapFlags, bool entire,
                          amd::Image* baseMip) {
@@ -67,6 +67,8 @@ class WriteMemoryCommand;
 class FillMemoryCommand;
 class CopyMemoryCommand;
 class CopyMemoryP2PCommand;
+class CopyMemoryBatchCommand;
+class WriteMemoryInlineCommand;
 class MapMemoryCommand;
 class UnmapMemoryCommand;
 class MigrateMemObjectsCommand;
@@ -718,6 +720,22 @@ class Settings : public amd::HeapObject {
   Settings& operator=(const Settings&);
 };
 
+//! Transfer tuning of an ASIC. The entries come from GPU_XFER_TUNING, which holds the table
+//! or names a file with it, e.g. a calibration result. Every entry is a processor name followed
+//! by the sizes in KiB: "gfx942:pinned=32768,pinned_min=1024,staged=4096,blit=16". The entries
+//! are separated by ';' or new lines. Both backends take the transfer defaults from the entry of
+//! the device, the explicit environment flags still have the priority.
+struct XferTuning {
+  std::string processor_;     //!< Processor name, e.g. gfx90a
+  size_t pinnedXferSize_;     //!< Largest transfer with a single pin, 0 if not tuned
+  size_t pinnedMinXferSize_;  //!< Smallest pinned transfer, 0 if not tuned
+  size_t stagedXferSize_;     //!< Staging chunk size, 0 if not tuned
+  size_t blitCopySize_;       //!< Copies up to this size use the blit kernels, 0 if not tuned
+
+  //! Returns the tuning of the processor, or nullptr if the table has no entry
+  static const XferTuning* Find(const std::string& processor);
+};
+
 //! Device-independent cache memory, base class for the device-specific
 //! memories. One Memory instance refers to one or more of these.
 class Memory : public amd::HeapObject {
@@ -1238,6 +1256,20 @@ class PerfCounter : public amd::HeapObject {
   //! Disable default operator=
   PerfCounter& operator=(const PerfCounter&);
 };
+
+//! One interval of the continuous device-wide performance counter sampling
+struct PerfCounterSample {
+  uint64_t timestamp_;   //!< CPU time in ns at the end of the interval
+  uint64_t duration_;    //!< Length of the interval in ns
+  uint64_t gpuCycles_;   //!< GPU clock cycles in the interval
+  uint64_t busyCycles_;  //!< Cycles with the GPU busy
+  uint64_t waves_;       //!< Launched wavefronts
+  uint64_t l2Hits_;      //!< L2 cache hits
+  uint64_t l2Misses_;    //!< L2 cache misses
+  uint64_t memReads_;    //!< Read requests from L2 to the memory
+  uint64_t memWrites_;   //!< Write requests from L2 to the memory
+};
+
 /*! \class ThreadTrace
  *
  *  \brief The device interface class for the performance counters
@@ -1268,7 +1300,7 @@ class VirtualDevice : public amd::HeapObject {
   VirtualDevice(amd::Device& device)
     : device_(device)
     , blitMgr_(NULL)
-    , execution_(true) /* Virtual device execution lock */
+    , execution_("Virtual device execution lock", true)
     , index_(0) {}
 
   //! Destroy this virtual device.
@@ -1281,6 +1313,8 @@ class VirtualDevice : public amd::HeapObject {
   virtual void submitWriteMemory(amd::WriteMemoryCommand& cmd) = 0;
   virtual void submitCopyMemory(amd::CopyMemoryCommand& cmd) = 0;
   virtual void submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) = 0;
+  virtual void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd) = 0;
+  virtual void submitWriteMemoryInline(amd::WriteMemoryInlineCommand& cmd) = 0;
   virtual void submitMapMemory(amd::MapMemoryCommand& cmd) = 0;
   virtual void submitUnmapMemory(amd::UnmapMemoryCommand& cmd) = 0;
   virtual void submitKernel(amd::NDRangeKernelCommand& command) = 0;
@@ -1312,6 +1346,12 @@ class VirtualDevice : public amd::HeapObject {
 
   virtual address allocKernelArguments(size_t size, size_t alignment) { return nullptr; }
 
+  //! Starts a batch of submissions, the device may defer the queue doorbell until the end
+  virtual void BeginPacketBatch() {}
+
+  //! Ends the batch of submissions and submits the deferred packets
+  virtual void EndPacketBatch() {}
+
   //! Get the blit manager object
   device::BlitManager& blitMgr() const { return *blitMgr_; }
 
@@ -1326,12 +1366,28 @@ class VirtualDevice : public amd::HeapObject {
 
   //! Returns fence state of the VirtualGPU
   virtual bool isFenceDirty() const = 0;
+  //! Returns the number of the packets in the HW queue, which the device didn't process yet
+  virtual uint64_t hwQueueLoad() const { return 0; }
+  //! Moves the virtual device to a HW queue with the new CU mask. The caller must drain the
+  //! virtual device first. An empty mask restores the default CU set
+  virtual bool setCuMask(const std::vector<uint32_t>& cuMask) { return false; }
   //! Init hidden heap for device memory allocations
   virtual void HiddenHeapInit() = 0;
   //! Dispatch captured AQL packet
   virtual bool dispatchAqlPacket(uint8_t* aqlpacket,
                                  const std::string& kernelName,
                                  amd::AccumulateCommand* vcmd = nullptr) = 0;
+  //! Dispatch a batch of captured AQL packets, kernelNames holds the name of every packet
+  virtual bool dispatchAqlPackets(const std::vector<uint8_t*>& aqlpackets,
+                                  const std::vector<const std::string*>& kernelNames,
+                                  amd::AccumulateCommand* vcmd = nullptr) {
+    for (size_t i = 0; i < aqlpackets.size(); ++i) {
+      if (!dispatchAqlPacket(aqlpackets[i], *kernelNames[i], vcmd)) {
+        return false;
+      }
+    }
+    return true;
+  }
 
   //! Returns the number of outstanding HSA async handlers
   std::atomic<uint64_t>& QueuedAsyncHandlers() const { return queued_async_handlers_; }
@@ -1387,6 +1443,34 @@ class MemObjMap : public AllStatic {
   static std::map<uintptr_t, amd::Memory*> VirtualMemObjMap_;
   //!< Shared read/write lock
   static std::shared_mutex AllocatedLock_;
+  //!< Generation of the containers, bumped on every update to invalidate the lookup caches
+  static std::atomic<uint64_t> Generation_;
+
+  //!< Per-thread cache of the last successful lookup
+  struct LookupCache {
+    uintptr_t base_ = 0;            //!< Start address of the cached range
+    uintptr_t end_ = 0;             //!< End address of the cached range
+    amd::Memory* mem_ = nullptr;    //!< Cached memory object
+    uint64_t generation_ = 0;       //!< Generation of the map, when the cache was filled
+  };
+  static thread_local LookupCache MemObjCache_;
+  static thread_local LookupCache VirtualMemObjCache_;
+
+  //!< Lookup in the cache, returns nullptr on a miss
+  static inline amd::Memory* FindCached(const LookupCache& cache, uintptr_t key,
+                                        size_t* offset) {
+    if ((key >= cache.base_) && (key < cache.end_) &&
+        (cache.generation_ == Generation_.load(std::memory_order_acquire))) {
+      if (offset != nullptr) {
+        *offset = key - cache.base_;
+      }
+      return cache.mem_;
+    }
+    return nullptr;
+  }
+  //!< Search in the container under the shared lock and update the cache on a hit
+  static amd::Memory* FindInMap(const std::map<uintptr_t, amd::Memory*>& map,
+                                LookupCache& cache, uintptr_t key, size_t* offset);
 };
 
 /// @brief Instruction Set Architecture properties.
@@ -1612,6 +1696,7 @@ class Device : public RuntimeObject {
     uint64_t all_sum;
     struct MGSyncData sgs;
     uint num_wg;
+    uint32_t* grid_sync;  //!< Workspace of the hierarchical grid barrier, see grid::sync()
   };
 
   //Attributes that could be retrived from hsa_amd_memory_pool_link_info_t.
@@ -1647,7 +1732,9 @@ class Device : public RuntimeObject {
   static constexpr size_t kP2PStagingSize = 4 * Mi;
   static constexpr size_t kMGSyncDataSize = sizeof(MGSyncData);
   static constexpr size_t kMGInfoSizePerDevice = kMGSyncDataSize + sizeof(MGSyncInfo);
-  static constexpr size_t kSGInfoSize = kMGSyncDataSize;
+  static constexpr size_t kSGInfoSize = sizeof(MGSyncInfo);
+  //! The counters of the hierarchical grid barrier, each on its own 128 byte cache line
+  static constexpr size_t kGridSyncWorkspaceSize = 2 * Ki;
 
   typedef std::list<CommandQueue*> CommandQueues;
 
@@ -1819,6 +1906,15 @@ class Device : public RuntimeObject {
     return true;
   }
 
+  //! Allows the access to the memory of this device from all peers with a single update
+  virtual bool allowPeersAccess(device::Memory* memory, const std::vector<Device*>& peers) const {
+    bool result = true;
+    for (auto peer : peers) {
+      result &= peer->allowPeerAccess(memory);
+    }
+    return result;
+  }
+
   bool enableP2P(amd::Device* ptrDev);
 
   bool disableP2P(amd::Device* ptrDev);
@@ -1971,6 +2067,10 @@ class Device : public RuntimeObject {
     return false;
   };
 
+  // Waits for the HW events of all amd::Events with one multi-wait. The HW events can belong to
+  // different devices. Returns false if the wait failed, the events without HW events are skipped
+  virtual bool WaitHwEvents(const std::vector<amd::Event*>& events) const { return false; }
+
   // Returns the status of HW event, associated with amd::Event
   virtual bool IsHwEventReadyForcedWait(
       const amd::Event& event) const {  //!< AMD event for HW status validation
@@ -1979,7 +2079,15 @@ class Device : public RuntimeObject {
 
   virtual void getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t* end) const {};
 
+  //! Returns the recent samples of the continuous performance counter sampling, oldest first.
+  //! Returns false if the sampling is disabled or unsupported on the device
+  virtual bool GetPerfCounterSamples(std::vector<device::PerfCounterSample>* samples) const {
+    return false;
+  }
+
   virtual const uint32_t getPreferredNumaNode() const { return 0; }
+  //! Binds the calling worker thread to the CPUs of the NUMA node closest to the device
+  virtual void setThreadNumaAffinity() const {}
   virtual void ReleaseGlobalSignal(void* signal) const {}
   virtual const bool isFineGrainSupported() const {
     return (info().svmCapabilities_ & CL_DEVICE_SVM_ATOMICS) != 0 ? true : false;
@@ -2043,6 +2151,10 @@ class Device : public RuntimeObject {
   // current device
   std::vector<Device*> p2p_access_devices_;
 
+  // Relay devices for the P2P transfers between the devices without a direct link, indexed by
+  // the destination device. A relay device has access to the memory of both devices
+  std::map<const Device*, Device*> p2p_relay_devices_;
+
   //! Checks if OCL runtime can use code object manager for compilation
   bool ValidateComgr();
 
@@ -2068,6 +2180,20 @@ class Device : public RuntimeObject {
   //! Staging buffer for P2P transfer
   Memory* P2PStage() const { return p2p_stage_; }
 
+  //! Staging resources of the P2P transfers between one pair of devices
+  struct P2PStageSlot {
+    P2PStageSlot() : lock_(true), buffer_(nullptr) {}
+    Monitor lock_;    //!< Lock to serialise the transfers, which use the buffer
+    Memory* buffer_;  //!< Staging buffer, accessible by both devices of the pair
+  };
+
+  //! Returns the staging resources for the P2P transfers from src to dst device. The pairs
+  //! share the global staging buffer, if a dedicated buffer can't be allocated
+  P2PStageSlot* P2PStage(Device* src, Device* dst) const;
+
+  //! Releases the staging resources of all device pairs
+  static void ReleaseP2PStages();
+
   //! Returns heap buffer object for device allocator
   device::Memory* HeapBuffer() const { return heap_buffer_; }
 
@@ -2083,12 +2209,28 @@ class Device : public RuntimeObject {
   //! Sets the heap size of the device
   bool UpdateInitialHeapSize(uint64_t initialHeapSize);
 
+  //! Records the device heap growth by the device allocator through hostcall,
+  //! a negative size records a release of the grown memory
+  void RecordHeapGrowth(int64_t size);
+
+  //! Returns the memory the device allocator currently holds over the initial heap
+  uint64_t HeapGrowth() const { return heap_growth_; }
+
+  //! Returns the peak of the memory the device allocator held over the initial heap
+  uint64_t HeapGrowthPeak() const { return heap_growth_peak_; }
+
   //! Does this device allow P2P access?
   bool P2PAccessAllowed() const { return (p2p_access_devices_.size() > 0) ? true : false; }
 
   //! Returns the list of devices that can have access to the current
   const std::vector<Device*>& P2PAccessDevices() const { return p2p_access_devices_; }
 
+  //! Returns the relay device for the P2P transfers into dst device, nullptr if there is none
+  Device* P2PRelayDevice(const Device* dst) const {
+    auto it = p2p_relay_devices_.find(dst);
+    return (it != p2p_relay_devices_.end()) ? it->second : nullptr;
+  }
+
   //! Returns index of current device
   uint32_t index() const { return index_; }
 
@@ -2154,6 +2296,9 @@ class Device : public RuntimeObject {
   static amd::Context* glb_ctx_;      //!< Global context with all devices
   static amd::Monitor p2p_stage_ops_; //!< Lock to serialise cache for the P2P resources
   static Memory* p2p_stage_;          //!< Staging resources
+  //! Staging resources of every (src, dst) device pair, protected by p2p_stage_ops_
+  static std::map<std::pair<const Device*, const Device*>, P2PStageSlot*> p2p_stages_;
+  static P2PStageSlot p2p_shared_stage_;  //!< The pair slot over the global staging buffer
   std::vector<Device*> enabled_p2p_devices_;  //!< List of user enabled P2P devices for this device
 
   std::once_flag heap_initialized_;  //!< Heap buffer initialization flag
@@ -2165,6 +2310,9 @@ class Device : public RuntimeObject {
   uint64_t stack_size_{1024};       //!< Device stack size
   device::Memory* initial_heap_buffer_;   //!< Initial heap buffer
   uint64_t initial_heap_size_{HIP_INITIAL_DM_SIZE};  //!< Initial device heap size
+  std::atomic<uint64_t> heap_growth_{0};       //!< Device heap memory grown through hostcall
+  std::atomic<uint64_t> heap_growth_peak_{0};  //!< Peak of the grown device heap memory
+  std::atomic<uint64_t> heap_grow_count_{0};   //!< Number of the device heap growths
   amd::Monitor activeQueuesLock_ {}; //!< Guards access to the activeQueues set
   std::unordered_set<amd::CommandQueue*> activeQueues; //!< The set of active queues
  private:
@@ -25,12 +25,18 @@
 #include "devkernel.hpp"
 #include "utils/macros.hpp"
 #include "utils/options.hpp"
+#include "utils/versions.hpp"  // AMD_PLATFORM_INFO
 #if defined(WITH_COMPILER_LIB)
 #include "utils/bif_section_labels.hpp"
 #include "utils/libUtils.h"
 #endif
 #include "comgrctx.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <map>
 #include <string>
 #include <sstream>
@@ -599,6 +605,7 @@ static amd_comgr_status_t populateKernelMetaV3(const amd_comgr_metadata_node_t k
 Kernel::Kernel(const amd::Device& dev, const std::string& name, const Program& prog)
   : dev_(dev)
   , name_(name)
+  , name_hash_(std::hash<std::string>{}(name))
   , prog_(prog)
   , signature_(nullptr) {
   // Instead of memset(&workGroupInfo_, '\0', sizeof(workGroupInfo_));
@@ -696,82 +703,30 @@ void Kernel::FindLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
   if (workGroupInfo()->compileSize_[0] == 0) {
     // Find the default local workgroup size, if it wasn't specified
     if (lclWorkSize[0] == 0) {
-      // Find threads per group
-      size_t thrPerGrp = workGroupInfo()->size_;
-
-      // Check if kernel uses images
-      if (flags_.imageEna_ &&
-        // and thread group is a multiple value of wavefronts
-        ((thrPerGrp % workGroupInfo()->wavefrontSize_) == 0) &&
-        // and it's 2 or 3-dimensional workload
-        (workDim > 1) && (((gblWorkSize[0] % 16) == 0) && ((gblWorkSize[1] % 16) == 0))) {
-        // Use 8x8 workgroup size if kernel has image writes
-        if (flags_.imageWriteEna_ || (thrPerGrp != device().info().preferredWorkGroupSize_)) {
-          lclWorkSize[0] = 8;
-          lclWorkSize[1] = 8;
-        }
-        else {
-          lclWorkSize[0] = 16;
-          lclWorkSize[1] = 16;
-        }
-        if (workDim == 3) {
-          lclWorkSize[2] = 1;
-        }
-      }
-      else {
-        size_t tmp = thrPerGrp;
-        // Split the local workgroup into the most efficient way
-        for (uint d = 0; d < workDim; ++d) {
-          size_t div = tmp;
-          for (; (gblWorkSize[d] % div) != 0; div--)
+      const size_t dims = std::min<size_t>(workDim, 3);
+      {
+        amd::ScopedLock lock(localSizeCacheLock_);
+        for (const auto& it : localSizeCache_) {
+          uint d = 0;
+          for (; (it.dims_ == dims) && (d < dims) && (it.global_[d] == gblWorkSize[d]); ++d)
             ;
-          lclWorkSize[d] = div;
-          tmp /= div;
-        }
-
-        if (!workGroupInfo()->uniformWorkGroupSize_) {
-          // Assuming DWORD access
-          const uint cacheLineMatch = device().info().globalMemCacheLineSize_ >> 2;
-
-          // Check if we couldn't find optimal workload
-          if (((lclWorkSize.product() % workGroupInfo()->wavefrontSize_) != 0) ||
-              // or size is too small for the cache line
-            (lclWorkSize[0] < cacheLineMatch)) {
-            size_t maxSize = 0;
-            size_t maxDim = 0;
-            for (uint d = 0; d < workDim; ++d) {
-              if (maxSize < gblWorkSize[d]) {
-                maxSize = gblWorkSize[d];
-                maxDim = d;
-              }
-            }
-            // Use X dimension as high priority. Runtime will assume that
-            // X dimension is more important for the address calculation
-            if ((maxDim != 0) && (gblWorkSize[0] >= (cacheLineMatch / 2))) {
-              lclWorkSize[0] = cacheLineMatch;
-              thrPerGrp /= cacheLineMatch;
-              lclWorkSize[maxDim] = thrPerGrp;
-              for (uint d = 1; d < workDim; ++d) {
-                if (d != maxDim) {
-                  lclWorkSize[d] = 1;
-                }
-              }
-            }
-            else {
-              // Check if a local workgroup has the most optimal size
-              if (thrPerGrp > maxSize) {
-                thrPerGrp = maxSize;
-              }
-              lclWorkSize[maxDim] = thrPerGrp;
-              for (uint d = 0; d < workDim; ++d) {
-                if (d != maxDim) {
-                  lclWorkSize[d] = 1;
-                }
-              }
+          if ((it.dims_ == dims) && (d == dims)) {
+            for (d = 0; d < dims; ++d) {
+              lclWorkSize[d] = it.local_[d];
             }
+            return;
           }
         }
       }
+      FindDefaultLocalWorkSize(workDim, gblWorkSize, lclWorkSize);
+
+      amd::ScopedLock lock(localSizeCacheLock_);
+      LocalSizeEntry& entry = localSizeCache_[localSizeCacheNext_++ % LocalSizeCacheSize];
+      entry.dims_ = dims;
+      for (uint d = 0; d < dims; ++d) {
+        entry.global_[d] = gblWorkSize[d];
+        entry.local_[d] = lclWorkSize[d];
+      }
     }
   }
   else {
@@ -781,6 +736,162 @@ void Kernel::FindLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
   }
 }
 
+// ================================================================================================
+bool Kernel::GetOccupancy(size_t dynamicLds, Occupancy* occupancy) const {
+  // Find wave occupancy per CU => simd_per_cu * GPR usage
+  const size_t maxWavesPerSimd = (device().isa().versionMajor() <= 9) ?
+      8 :  // Limited by SPI 32 per CU, hence 8 per SIMD
+      16;
+  size_t vgprWaves = maxWavesPerSimd;
+  uint32_t vgprGranularity = device().info().vgprAllocGranularity_;
+  size_t maxVGPRs = device().info().vgprsPerSimd_;
+  const size_t wavefrontSize = workGroupInfo()->wavefrontSize_;
+  if ((device().isa().versionMajor() >= 10) && (wavefrontSize == 64)) {
+    maxVGPRs = maxVGPRs >> 1;
+    vgprGranularity = vgprGranularity >> 1;
+  }
+  if (workGroupInfo()->usedVGPRs_ > 0) {
+    vgprWaves = maxVGPRs / amd::alignUp(workGroupInfo()->usedVGPRs_, vgprGranularity);
+  }
+  if (vgprWaves == 0) {
+    // The usedVGPRs_/availableVGPRs_ values are incorrect
+    return false;
+  }
+
+  size_t gprWaves = vgprWaves;
+  if (workGroupInfo()->usedSGPRs_ > 0) {
+    const size_t sgprWaves =
+        device().info().sgprsPerSimd_ / amd::alignUp(workGroupInfo()->usedSGPRs_, 16);
+    gprWaves = std::min(vgprWaves, sgprWaves);
+  }
+  const uint32_t simdPerCU = (device().isa().versionMajor() <= 9) ?
+      device().info().simdPerCU_ : (workGroupInfo()->isWGPMode_ ? 4 : 2);
+  occupancy->aluWaves_ = static_cast<uint32_t>(simdPerCU * std::min(maxWavesPerSimd, gprWaves));
+
+  occupancy->ldsGroups_ = std::numeric_limits<uint32_t>::max();
+  const size_t totalLds = workGroupInfo()->usedLDSSize_ + dynamicLds;
+  if (totalLds != 0) {
+    occupancy->ldsGroups_ = static_cast<uint32_t>(device().info().localMemSize_ / totalLds);
+  }
+  return true;
+}
+
+// ================================================================================================
+size_t Kernel::FindOccupancyWorkGroupSize(size_t maxSize, size_t dynamicLds) const {
+  const size_t wave = workGroupInfo()->wavefrontSize_;
+  Occupancy occupancy;
+  if ((wave == 0) || (maxSize < wave) || !GetOccupancy(dynamicLds, &occupancy)) {
+    return maxSize;
+  }
+  // A workgroup runs entirely on one CU, hence a size which doesn't divide the wave limit
+  // leaves SIMD slots idle
+  size_t bestSize = maxSize;
+  uint32_t bestWaves = 0;
+  for (size_t size = amd::alignDown(maxSize, wave); size >= wave; size -= wave) {
+    const uint32_t groupWaves = static_cast<uint32_t>(size / wave);
+    const uint32_t groups = std::min(occupancy.aluWaves_ / groupWaves, occupancy.ldsGroups_);
+    if ((groups * groupWaves) > bestWaves) {
+      bestWaves = groups * groupWaves;
+      bestSize = size;
+    }
+  }
+  return bestSize;
+}
+
+// ================================================================================================
+void Kernel::FindDefaultLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
+                                      amd::NDRange& lclWorkSize) const {
+  // Find threads per group
+  size_t thrPerGrp = workGroupInfo()->size_;
+
+  // Check if kernel uses images
+  if (flags_.imageEna_ &&
+    // and thread group is a multiple value of wavefronts
+    ((thrPerGrp % workGroupInfo()->wavefrontSize_) == 0) &&
+    // and it's 2 or 3-dimensional workload
+    (workDim > 1) && (((gblWorkSize[0] % 16) == 0) && ((gblWorkSize[1] % 16) == 0))) {
+    // Use 8x8 workgroup size if kernel has image writes
+    if (flags_.imageWriteEna_ || (thrPerGrp != device().info().preferredWorkGroupSize_)) {
+      lclWorkSize[0] = 8;
+      lclWorkSize[1] = 8;
+    }
+    else {
+      lclWorkSize[0] = 16;
+      lclWorkSize[1] = 16;
+    }
+    if (workDim == 3) {
+      lclWorkSize[2] = 1;
+    }
+  }
+  else {
+    if (GPU_OCCUPANCY_WORKGROUP_SIZE) {
+      thrPerGrp = FindOccupancyWorkGroupSize(thrPerGrp, 0);
+      // Smaller groups spread a small launch over more CUs
+      const size_t wave = workGroupInfo()->wavefrontSize_;
+      size_t threads = 1;
+      for (uint d = 0; d < workDim; ++d) {
+        threads *= gblWorkSize[d];
+      }
+      const size_t cus = device().info().maxComputeUnits_;
+      if ((wave != 0) && (cus != 0) && ((threads / thrPerGrp) < cus)) {
+        thrPerGrp = std::min(thrPerGrp, std::max(wave, amd::alignUp(threads / cus, wave)));
+      }
+    }
+    size_t tmp = thrPerGrp;
+    // Split the local workgroup into the most efficient way
+    for (uint d = 0; d < workDim; ++d) {
+      size_t div = tmp;
+      for (; (gblWorkSize[d] % div) != 0; div--)
+        ;
+      lclWorkSize[d] = div;
+      tmp /= div;
+    }
+
+    if (!workGroupInfo()->uniformWorkGroupSize_) {
+      // Assuming DWORD access
+      const uint cacheLineMatch = device().info().globalMemCacheLineSize_ >> 2;
+
+      // Check if we couldn't find optimal workload
+      if (((lclWorkSize.product() % workGroupInfo()->wavefrontSize_) != 0) ||
+          // or size is too small for the cache line
+        (lclWorkSize[0] < cacheLineMatch)) {
+        size_t maxSize = 0;
+        size_t maxDim = 0;
+        for (uint d = 0; d < workDim; ++d) {
+          if (maxSize < gblWorkSize[d]) {
+            maxSize = gblWorkSize[d];
+            maxDim = d;
+          }
+        }
+        // Use X dimension as high priority. Runtime will assume that
+        // X dimension is more important for the address calculation
+        if ((maxDim != 0) && (gblWorkSize[0] >= (cacheLineMatch / 2))) {
+          lclWorkSize[0] = cacheLineMatch;
+          thrPerGrp /= cacheLineMatch;
+          lclWorkSize[maxDim] = thrPerGrp;
+          for (uint d = 1; d < workDim; ++d) {
+            if (d != maxDim) {
+              lclWorkSize[d] = 1;
+            }
+          }
+        }
+        else {
+          // Check if a local workgroup has the most optimal size
+          if (thrPerGrp > maxSize) {
+            thrPerGrp = maxSize;
+          }
+          lclWorkSize[maxDim] = thrPerGrp;
+          for (uint d = 0; d < workDim; ++d) {
+            if (d != maxDim) {
+              lclWorkSize[d] = 1;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 // ================================================================================================
 #if defined(WITH_COMPILER_LIB)
 static inline uint32_t GetOclArgumentTypeOCL(const aclArgData* argInfo, bool* isHidden) {
@@ -1101,6 +1212,16 @@ bool Kernel::GetAttrCodePropMetadata() {
   workGroupInfo_.availableSGPRs_ = 104;
   workGroupInfo_.availableVGPRs_ = 256;
 
+  // The cached kernels skip the metadata walk
+  KernelMetadataCache* cache = prog().kernelMetadataCache();
+  if (cache != nullptr) {
+    size_t size = 0;
+    const char* record = cache->Find(name(), &size);
+    if ((record != nullptr) && LoadMetadataRecord(record, size)) {
+      return true;
+    }
+  }
+
   // extract the attribute metadata if there is any
   amd_comgr_status_t status = AMD_COMGR_STATUS_SUCCESS;
 
@@ -1150,9 +1271,329 @@ bool Kernel::GetAttrCodePropMetadata() {
 
   InitParameters(kernelMetaNode);
 
+  if ((cache != nullptr) && (signature_ != nullptr)) {
+    std::vector<char> record;
+    SaveMetadataRecord(&record);
+    cache->Add(std::move(record));
+  }
   return true;
 }
 
+namespace {
+//! The version of the kernel metadata cache layout, bump on any change of the records
+constexpr uint32_t kMetadataCacheVersion = 1;
+constexpr char kMetadataCacheMagic[8] = {'R', 'O', 'C', 'K', 'M', 'D', '0', '1'};
+
+struct MetadataCacheHeader {
+  char magic_[8];      //!< kMetadataCacheMagic
+  uint64_t key_;       //!< Hash of the code object metadata and the runtime build
+  uint32_t count_;     //!< The number of the kernel records after the header
+  uint32_t reserved_;
+};
+
+//! The kernel record, followed by the parameters and the strings. The string fields are the
+//! offsets from the record start
+struct MetadataRecord {
+  uint32_t size_;            //!< Size of the record, aligned to 8 bytes
+  uint32_t numParams_;       //!< The number of the OCL arguments
+  uint32_t numParamsAll_;    //!< The number of the arguments with the hidden ones
+  uint32_t name_;
+  uint32_t symbolName_;
+  uint32_t vecTypeHint_;
+  uint32_t runtimeHandle_;
+  uint32_t kind_;
+  uint32_t flags_;           //!< Kernel::Flags, which the arguments set
+  uint32_t wgpMode_;
+  uint32_t uniformWorkGroupSize_;
+  uint32_t kernargSegmentByteSize_;
+  uint32_t kernargSegmentAlignment_;
+  uint32_t workgroupGroupSegmentByteSize_;
+  uint32_t workitemPrivateSegmentByteSize_;
+  uint32_t wavefrontSize_;
+  uint32_t usedSGPRs_;
+  uint32_t usedVGPRs_;
+  uint32_t maxWorkGroupSize_;
+  uint32_t compileSize_[3];
+  uint32_t compileSizeHint_[3];
+};
+
+struct MetadataParam {
+  uint32_t type_;
+  uint32_t offset_;
+  uint32_t size_;
+  uint32_t info_;
+  uint32_t addressQualifier_;
+  uint32_t accessQualifier_;
+  uint32_t typeQualifier_;
+  uint32_t alignment_;
+  uint32_t name_;
+  uint32_t typeName_;
+};
+
+uint32_t AddRecordString(std::vector<char>* record, const std::string& str) {
+  uint32_t offset = static_cast<uint32_t>(record->size());
+  record->insert(record->end(), str.c_str(), str.c_str() + str.size() + 1);
+  return offset;
+}
+
+//! Returns the string at the offset, nullptr if it isn't terminated inside the record
+const char* GetRecordString(const char* record, size_t size, uint32_t offset) {
+  if ((offset >= size) || (memchr(record + offset, 0, size - offset) == nullptr)) {
+    return nullptr;
+  }
+  return record + offset;
+}
+
+uint64_t HashBytes(uint64_t hash, const char* data, size_t size) {
+  // FNV-1a
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+}  // namespace
+
+// ================================================================================================
+void Kernel::SaveMetadataRecord(std::vector<char>* record) const {
+  const amd::KernelSignature& sig = signature();
+  MetadataRecord rec = {};
+  rec.numParams_ = sig.numParameters();
+  rec.numParamsAll_ = sig.numParametersAll();
+  rec.kind_ = kind_;
+  Flags flags;
+  flags.imageEna_ = flags_.imageEna_;
+  flags.imageWriteEna_ = flags_.imageWriteEna_;
+  flags.dynamicParallelism_ = flags_.dynamicParallelism_;
+  rec.flags_ = flags.value_;
+  rec.wgpMode_ = workGroupInfo_.isWGPMode_;
+  rec.uniformWorkGroupSize_ = workGroupInfo_.uniformWorkGroupSize_;
+  rec.kernargSegmentByteSize_ = kernargSegmentByteSize_;
+  rec.kernargSegmentAlignment_ = kernargSegmentAlignment_;
+  rec.workgroupGroupSegmentByteSize_ = workgroupGroupSegmentByteSize_;
+  rec.workitemPrivateSegmentByteSize_ = workitemPrivateSegmentByteSize_;
+  rec.wavefrontSize_ = workGroupInfo_.wavefrontSize_;
+  rec.usedSGPRs_ = workGroupInfo_.usedSGPRs_;
+  rec.usedVGPRs_ = workGroupInfo_.usedVGPRs_;
+  rec.maxWorkGroupSize_ = workGroupInfo_.size_;
+  for (uint32_t i = 0; i < 3; ++i) {
+    rec.compileSize_[i] = workGroupInfo_.compileSize_[i];
+    rec.compileSizeHint_[i] = workGroupInfo_.compileSizeHint_[i];
+  }
+
+  record->assign(sizeof(rec) + rec.numParamsAll_ * sizeof(MetadataParam), 0);
+  rec.name_ = AddRecordString(record, name());
+  rec.symbolName_ = AddRecordString(record, symbolName_);
+  rec.vecTypeHint_ = AddRecordString(record, workGroupInfo_.compileVecTypeHint_);
+  rec.runtimeHandle_ = AddRecordString(record, runtimeHandle_);
+  for (uint32_t i = 0; i < rec.numParamsAll_; ++i) {
+    const amd::KernelParameterDescriptor& desc = sig.at(i);
+    MetadataParam param;
+    param.type_ = desc.type_;
+    param.offset_ = desc.offset_;
+    param.size_ = desc.size_;
+    param.info_ = desc.info_.allValues_;
+    param.addressQualifier_ = desc.addressQualifier_;
+    param.accessQualifier_ = desc.accessQualifier_;
+    param.typeQualifier_ = desc.typeQualifier_;
+    param.alignment_ = desc.alignment_;
+    param.name_ = AddRecordString(record, desc.name_);
+    param.typeName_ = AddRecordString(record, desc.typeName_);
+    memcpy(record->data() + sizeof(rec) + i * sizeof(param), &param, sizeof(param));
+  }
+  record->resize(amd::alignUp(record->size(), sizeof(uint64_t)), 0);
+  rec.size_ = record->size();
+  memcpy(record->data(), &rec, sizeof(rec));
+}
+
+// ================================================================================================
+bool Kernel::LoadMetadataRecord(const char* record, size_t size) {
+  MetadataRecord rec;
+  if (size < sizeof(rec)) {
+    return false;
+  }
+  memcpy(&rec, record, sizeof(rec));
+  if ((rec.size_ != size) || (rec.numParams_ > rec.numParamsAll_) || (rec.kind_ > Fini) ||
+      ((size - sizeof(rec)) / sizeof(MetadataParam) < rec.numParamsAll_)) {
+    return false;
+  }
+  const char* symbolName = GetRecordString(record, size, rec.symbolName_);
+  const char* vecTypeHint = GetRecordString(record, size, rec.vecTypeHint_);
+  const char* runtimeHandle = GetRecordString(record, size, rec.runtimeHandle_);
+  if ((symbolName == nullptr) || (vecTypeHint == nullptr) || (runtimeHandle == nullptr)) {
+    return false;
+  }
+
+  parameters_t params(rec.numParamsAll_);
+  for (uint32_t i = 0; i < rec.numParamsAll_; ++i) {
+    MetadataParam param;
+    memcpy(&param, record + sizeof(rec) + i * sizeof(param), sizeof(param));
+    const char* paramName = GetRecordString(record, size, param.name_);
+    const char* typeName = GetRecordString(record, size, param.typeName_);
+    if ((paramName == nullptr) || (typeName == nullptr)) {
+      return false;
+    }
+    amd::KernelParameterDescriptor& desc = params[i];
+    desc.type_ = static_cast<clk_value_type_t>(param.type_);
+    desc.offset_ = param.offset_;
+    desc.size_ = param.size_;
+    desc.info_.allValues_ = param.info_;
+    desc.addressQualifier_ = param.addressQualifier_;
+    desc.accessQualifier_ = param.accessQualifier_;
+    desc.typeQualifier_ = param.typeQualifier_;
+    desc.alignment_ = param.alignment_;
+    desc.name_ = paramName;
+    desc.typeName_ = typeName;
+  }
+
+  Flags flags;
+  flags.value_ = rec.flags_;
+  flags_.imageEna_ |= flags.imageEna_;
+  flags_.imageWriteEna_ |= flags.imageWriteEna_;
+  flags_.dynamicParallelism_ |= flags.dynamicParallelism_;
+  kind_ = static_cast<KernelKind>(rec.kind_);
+  SetSymbolName(symbolName);
+  setVecTypeHint(vecTypeHint);
+  setRuntimeHandle(runtimeHandle);
+  SetWGPMode(rec.wgpMode_ != 0);
+  setUniformWorkGroupSize(rec.uniformWorkGroupSize_ != 0);
+  SetKernargSegmentByteSize(rec.kernargSegmentByteSize_);
+  SetKernargSegmentAlignment(rec.kernargSegmentAlignment_);
+  SetWorkgroupGroupSegmentByteSize(rec.workgroupGroupSegmentByteSize_);
+  SetWorkitemPrivateSegmentByteSize(rec.workitemPrivateSegmentByteSize_);
+  workGroupInfo_.wavefrontSize_ = rec.wavefrontSize_;
+  workGroupInfo_.usedSGPRs_ = rec.usedSGPRs_;
+  workGroupInfo_.usedVGPRs_ = rec.usedVGPRs_;
+  workGroupInfo_.size_ = rec.maxWorkGroupSize_;
+  setReqdWorkGroupSize(rec.compileSize_[0], rec.compileSize_[1], rec.compileSize_[2]);
+  setWorkGroupSizeHint(rec.compileSizeHint_[0], rec.compileSizeHint_[1],
+                       rec.compileSizeHint_[2]);
+  return createSignature(params, rec.numParams_, amd::KernelSignature::ABIVersion_2);
+}
+
+// ================================================================================================
+KernelMetadataCache::KernelMetadataCache(const Program& program, const void* binary,
+                                         size_t size) {
+  amd::Elf elf(ELFCLASSNONE, static_cast<const char*>(binary), size, nullptr,
+               amd::Elf::ELF_C_READ_MMAP);
+  if (!elf.isSuccessful()) {
+    return;
+  }
+  // The records depend only on the metadata notes, the language and the runtime build
+  std::string build = std::string(AMD_PLATFORM_INFO) + (amd::IS_HIP ? "hip" : "ocl") +
+                      std::to_string(program.codeObjectVer()) + "." +
+                      std::to_string(kMetadataCacheVersion);
+  uint64_t hash = HashBytes(0xcbf29ce484222325ULL, build.data(), build.size());
+  size_t notesSize = 0;
+  for (unsigned int i = 0; i < elf.getSegmentNum(); ++i) {
+    amd::ELFIO::segment* seg = nullptr;
+    if (elf.getSegment(i, seg) && (seg->get_type() == PT_NOTE) &&
+        (seg->get_data() != nullptr)) {
+      hash = HashBytes(hash, seg->get_data(), seg->get_file_size());
+      notesSize += seg->get_file_size();
+    }
+  }
+  if (notesSize == 0) {
+    return;
+  }
+  key_ = hash;
+  char name[64];
+  snprintf(name, sizeof(name), "kmd_%016llx_%zx.bin", static_cast<unsigned long long>(hash),
+           notesSize);
+  fileName_ = std::string(GPU_KERNEL_METADATA_CACHE_PATH) + amd::Os::fileSeparator() + name;
+
+  if (!amd::Os::MemoryMapFile(fileName_.c_str(), &image_, &imageSize_)) {
+    image_ = nullptr;
+    imageSize_ = 0;
+    return;
+  }
+  MetadataCacheHeader header;
+  const char* image = static_cast<const char*>(image_);
+  bool valid = (imageSize_ >= sizeof(header));
+  if (valid) {
+    memcpy(&header, image, sizeof(header));
+    valid = (memcmp(header.magic_, kMetadataCacheMagic, sizeof(kMetadataCacheMagic)) == 0) &&
+            (header.key_ == key_);
+  }
+  size_t offset = sizeof(header);
+  for (uint32_t i = 0; valid && (i < header.count_); ++i) {
+    uint32_t recordSize = 0;
+    MetadataRecord rec;
+    if (imageSize_ - offset < sizeof(rec)) {
+      valid = false;
+      break;
+    }
+    memcpy(&rec, image + offset, sizeof(rec));
+    recordSize = rec.size_;
+    const char* kernelName = nullptr;
+    if ((recordSize < sizeof(rec)) || (recordSize > imageSize_ - offset) ||
+        ((kernelName = GetRecordString(image + offset, recordSize, rec.name_)) == nullptr)) {
+      valid = false;
+      break;
+    }
+    records_[kernelName] = std::make_pair(image + offset, static_cast<size_t>(recordSize));
+    offset += recordSize;
+  }
+  if (!valid) {
+    LogPrintfWarning("Ignoring the invalid kernel metadata cache %s", fileName_.c_str());
+    records_.clear();
+  } else {
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Loaded %zu kernels from the metadata cache %s",
+            records_.size(), fileName_.c_str());
+  }
+}
+
+// ================================================================================================
+KernelMetadataCache::~KernelMetadataCache() {
+  if (image_ != nullptr) {
+    amd::Os::MemoryUnmapFile(image_, imageSize_);
+  }
+}
+
+// ================================================================================================
+const char* KernelMetadataCache::Find(const std::string& name, size_t* size) const {
+  auto it = records_.find(name);
+  if (it == records_.end()) {
+    return nullptr;
+  }
+  *size = it->second.second;
+  return it->second.first;
+}
+
+// ================================================================================================
+void KernelMetadataCache::Add(std::vector<char>&& record) {
+  added_.push_back(std::move(record));
+}
+
+// ================================================================================================
+void KernelMetadataCache::Store() {
+  if (added_.empty() || !amd::Os::createPath(GPU_KERNEL_METADATA_CACHE_PATH)) {
+    return;
+  }
+  MetadataCacheHeader header = {};
+  memcpy(header.magic_, kMetadataCacheMagic, sizeof(kMetadataCacheMagic));
+  header.key_ = key_;
+  header.count_ = static_cast<uint32_t>(records_.size() + added_.size());
+
+  // The temporary file is renamed, so a concurrent process never maps a partial file
+  std::string tmpName = fileName_ + "." + std::to_string(amd::Os::getProcessId()) + ".tmp";
+  std::ofstream file(tmpName, std::ios_base::out | std::ios_base::binary |
+                     std::ios_base::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& it : records_) {
+    file.write(it.second.first, it.second.second);
+  }
+  for (const auto& it : added_) {
+    file.write(it.data(), it.size());
+  }
+  file.close();
+  if (!file.good() || (std::rename(tmpName.c_str(), fileName_.c_str()) != 0)) {
+    std::remove(tmpName.c_str());
+    return;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Stored %u kernels into the metadata cache %s",
+          header.count_, fileName_.c_str());
+}
+
 bool Kernel::SetAvailableSgprVgpr() {
   std::string buf;
 
@@ -1655,4 +2096,89 @@ void Kernel::InitPrintf(const aclPrintfFmt* aclPrintf) {
   }
 }
 #endif // defined(WITH_COMPILER_LIB)
+
+namespace {
+//! Kernel statistics by the kernel name. The table is never destroyed, since the exiting
+//! threads may still dispatch kernels
+std::map<std::string, KernelStats*>& KernelStatsTable() {
+  static auto table = new std::map<std::string, KernelStats*>();
+  return *table;
+}
+
+amd::Monitor& KernelStatsLock() {
+  static amd::Monitor* lock = new amd::Monitor(true);
+  return *lock;
+}
+}  // namespace
+
+// ================================================================================================
+KernelStats* KernelStats::Get(const std::string& name) {
+  amd::ScopedLock sl(KernelStatsLock());
+  auto& table = KernelStatsTable();
+  auto it = table.find(name);
+  if (it != table.end()) {
+    return it->second;
+  }
+  KernelStats* stats = new KernelStats(name);
+  table[name] = stats;
+  return stats;
+}
+
+// ================================================================================================
+void KernelStats::Add(uint64_t ns) {
+  uint32_t bin = 0;
+  while ((bin < kNumBins - 1) && ((ns >> (bin + 1)) != 0)) {
+    ++bin;
+  }
+  bins_[bin].fetch_add(1, std::memory_order_relaxed);
+  samples_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t value = min_.load(std::memory_order_relaxed);
+  while ((ns < value) && !min_.compare_exchange_weak(value, ns, std::memory_order_relaxed)) {
+  }
+  value = max_.load(std::memory_order_relaxed);
+  while ((ns > value) && !max_.compare_exchange_weak(value, ns, std::memory_order_relaxed)) {
+  }
+}
+
+// ================================================================================================
+void KernelStats::Dump() {
+  if (ROC_KERNEL_STATS == 0) {
+    return;
+  }
+  // Sort by the snapshot of the total time, since the dispatches may still update the stats
+  std::vector<std::pair<uint64_t, KernelStats*>> kernels;
+  {
+    amd::ScopedLock sl(KernelStatsLock());
+    for (const auto& it : KernelStatsTable()) {
+      kernels.emplace_back(it.second->sum_.load(std::memory_order_relaxed), it.second);
+    }
+  }
+  std::sort(kernels.begin(), kernels.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+  // The sampled time, scaled by the sampling rate, estimates the total GPU time of the kernel
+  const uint64_t rate = ROC_KERNEL_STATS;
+  for (const auto& it : kernels) {
+    const KernelStats* stats = it.second;
+    uint64_t sum = it.first;
+    uint64_t samples = stats->samples_.load(std::memory_order_relaxed);
+    if (samples == 0) {
+      continue;
+    }
+    uint64_t dispatches = stats->dispatches_.load(std::memory_order_relaxed);
+    std::string bins;
+    for (uint32_t i = 0; i < kNumBins; ++i) {
+      uint64_t count = stats->bins_[i].load(std::memory_order_relaxed);
+      if (count != 0) {
+        bins += " " + std::to_string(1ull << i) + "ns:" + std::to_string(count);
+      }
+    }
+    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "Kernel stats %s: dispatches %lu, est. total %lu us, "
+            "sampled packets %lu, avg %lu ns, min %lu ns, max %lu ns,%s", stats->name_.c_str(),
+            dispatches, (sum * rate) / 1000, samples, sum / samples,
+            stats->min_.load(std::memory_order_relaxed),
+            stats->max_.load(std::memory_order_relaxed), bins.c_str());
+  }
+}
+
 } // namespace amd::device
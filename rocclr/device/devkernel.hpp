@@ -200,6 +200,70 @@ struct PrintfInfo {
 };
 
 //! \class DeviceKernel, which will contain the common fields for any device
+//! Runtime statistics of the kernel dispatches, collected with ROC_KERNEL_STATS. The dispatches
+//! are counted exactly and the GPU time is measured on the sampled dispatches only
+class KernelStats : public amd::HeapObject {
+ public:
+  static constexpr uint32_t kNumBins = 32;
+
+  //! Returns the statistics of the kernel name. The entries live until the process exit
+  static KernelStats* Get(const std::string& name);
+
+  //! Prints all kernels, sorted by the estimated total GPU time
+  static void Dump();
+
+  //! Counts a dispatch, returns true if the dispatch must be timed
+  bool Sample(uint32_t rate) {
+    return (dispatches_.fetch_add(1, std::memory_order_relaxed) % rate) == 0;
+  }
+
+  //! Adds the GPU time of a timed dispatch packet
+  void Add(uint64_t ns);
+
+ private:
+  explicit KernelStats(const std::string& name) : name_(name) {}
+
+  std::string name_;                          //!< Kernel name
+  std::atomic<uint64_t> dispatches_{0};       //!< The number of the dispatches
+  std::atomic<uint64_t> samples_{0};          //!< The number of the timed packets
+  std::atomic<uint64_t> sum_{0};              //!< Total time of the timed packets in ns
+  std::atomic<uint64_t> min_{UINT64_MAX};     //!< The fastest timed packet in ns
+  std::atomic<uint64_t> max_{0};              //!< The slowest timed packet in ns
+  std::atomic<uint64_t> bins_[kNumBins] = {}; //!< Bin N counts the packets in [2^N, 2^(N+1)) ns
+};
+
+#if defined(USE_COMGR_LIBRARY)
+//! Disk cache of the parsed kernel metadata of a code object, enabled with
+//! GPU_KERNEL_METADATA_CACHE_PATH. Every kernel is a compact POD record, the file is mapped on
+//! the next load of the same code object and the cached kernels skip the comgr metadata walk
+class KernelMetadataCache : public amd::HeapObject {
+ public:
+  //! Opens the cache of the code object, the disabled cache finds no kernels
+  KernelMetadataCache(const Program& program, const void* binary, size_t size);
+  ~KernelMetadataCache();
+
+  //! Returns the record of the kernel and its size, nullptr if the kernel isn't cached
+  const char* Find(const std::string& name, size_t* size) const;
+
+  //! Adds the record of a kernel, which missed the cache
+  void Add(std::vector<char>&& record);
+
+  //! Writes the cache file if any kernel missed the cache
+  void Store();
+
+  //! Returns true if the cache has a file name
+  bool enabled() const { return !fileName_.empty(); }
+
+ private:
+  std::string fileName_;       //!< The cache file of the code object, empty if disabled
+  uint64_t key_ = 0;           //!< The hash of the metadata and the runtime build
+  const void* image_ = nullptr;  //!< The mapped cache file
+  size_t imageSize_ = 0;       //!< The size of the mapped cache file
+  std::unordered_map<std::string, std::pair<const char*, size_t>> records_;  //!< Found records
+  std::vector<std::vector<char>> added_;  //!< The records of the missed kernels
+};
+#endif  // defined(USE_COMGR_LIBRARY)
+
 class Kernel : public amd::HeapObject {
  public:
   typedef std::vector<amd::KernelParameterDescriptor> parameters_t;
@@ -252,6 +316,19 @@ class Kernel : public amd::HeapObject {
   //! Returns the kernel name
   const std::string& name() const { return name_; }
 
+  //! Returns the hash of the kernel name
+  size_t nameHash() const { return name_hash_; }
+
+  //! Returns the dispatch statistics of the kernel
+  KernelStats* stats() {
+    KernelStats* stats = stats_.load(std::memory_order_acquire);
+    if (stats == nullptr) {
+      stats = KernelStats::Get(name_);
+      stats_.store(stats, std::memory_order_release);
+    }
+    return stats;
+  }
+
   //! Initializes the kernel parameters for the abstraction layer
   bool createSignature(
     const parameters_t& params, uint32_t numParameters,
@@ -329,6 +406,20 @@ class Kernel : public amd::HeapObject {
     amd::NDRange& lclWorkSize         //!< Calculated local work size
   ) const;
 
+  //! Occupancy limits of the kernel on one CU
+  struct Occupancy {
+    uint32_t aluWaves_;   //!< Waves limited by the SIMDs and the register usage
+    uint32_t ldsGroups_;  //!< Workgroups limited by the LDS usage, UINT32_MAX without LDS
+  };
+
+  //! Finds the occupancy limits with the dynamic LDS size. Returns false if the register usage
+  //! doesn't fit a SIMD
+  bool GetOccupancy(size_t dynamicLds, Occupancy* occupancy) const;
+
+  //! Returns the workgroup size up to the limit, which keeps the most waves active on a CU.
+  //! The larger size wins the ties
+  size_t FindOccupancyWorkGroupSize(size_t maxSize, size_t dynamicLds) const;
+
   const uint64_t KernelCodeHandle() const { return kernelCodeHandle_; }
 
   const uint32_t WorkgroupGroupSegmentByteSize() const { return workgroupGroupSegmentByteSize_; }
@@ -366,6 +457,12 @@ class Kernel : public amd::HeapObject {
   //! Retrieve kernel attribute and code properties metadata
   bool GetAttrCodePropMetadata();
 
+  //! Serializes the state, which the metadata walk sets, into a kernel metadata cache record
+  void SaveMetadataRecord(std::vector<char>* record) const;
+
+  //! Restores the state of the metadata walk from a kernel metadata cache record
+  bool LoadMetadataRecord(const char* record, size_t size);
+
   //! Retrieve the available SGPRs and VGPRs
   bool SetAvailableSgprVgpr();
 
@@ -393,6 +490,8 @@ class Kernel : public amd::HeapObject {
 
   const amd::Device& dev_;          //!< GPU device object
   std::string name_;                //!< kernel name
+  size_t name_hash_;                //!< Hash of the kernel name
+  std::atomic<KernelStats*> stats_{nullptr};  //!< Dispatch statistics with ROC_KERNEL_STATS
   const Program& prog_;             //!< Reference to the parent program
   std::string symbolName_;          //!< kernel symbol name
   WorkGroupInfo workGroupInfo_;     //!< device kernel info structure
@@ -437,6 +536,21 @@ class Kernel : public amd::HeapObject {
   };
 
   KernelKind kind_{Normal};  //!< Kernel kind, is normal unless specified otherwise
+
+  //! The default local sizes of the recent global sizes, the launches repeat a few shapes
+  struct LocalSizeEntry {
+    size_t dims_;       //!< Work dimension, 0 for an empty entry
+    size_t global_[3];  //!< Global work size
+    size_t local_[3];   //!< Found local work size
+  };
+  static constexpr uint32_t LocalSizeCacheSize = 4;
+  mutable LocalSizeEntry localSizeCache_[LocalSizeCacheSize] = {};
+  mutable uint32_t localSizeCacheNext_ = 0;  //!< The entry for the next insertion
+  mutable amd::Monitor localSizeCacheLock_;  //!< Guards the cached local sizes
+
+  //! Finds the default local size without the compiled size
+  void FindDefaultLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
+                                amd::NDRange& lclWorkSize) const;
 };
 
 #if defined(USE_COMGR_LIBRARY)
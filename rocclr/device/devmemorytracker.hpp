@@ -0,0 +1,120 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace amd::device {
+
+//! Tracks the address ranges, accessed by the kernels in the queue since the last cache flush.
+//! The ranges of the previous kernels are merged into two sets of disjoint intervals, all
+//! accessed and the written ones, so a dependency lookup is O(log n). The ranges of the current
+//! kernel are kept aside, since they don't depend on each other, and join the sets on the next
+//! kernel.
+class MemoryRangeTracker : public amd::EmbeddedObject {
+ public:
+  MemoryRangeTracker() : maxRanges_(0) {}
+
+  //! Sets the limit of the tracked ranges, 0 disables the tracking
+  void create(size_t maxRanges) { maxRanges_ = maxRanges; }
+
+  //! Returns the limit of the tracked ranges
+  size_t maxRanges() const { return maxRanges_; }
+
+  //! Returns true if the range depends on the accesses of the previous kernels
+  bool depends(uint64_t start, uint64_t end, bool readOnly) const {
+    return overlaps(written_, start, end) || (!readOnly && overlaps(accessed_, start, end));
+  }
+
+  //! Returns true if the tracker reached the limit and must be cleared
+  bool full() const { return (accessed_.size() + current_.size()) >= maxRanges_; }
+
+  //! Adds the range of the current kernel
+  void add(uint64_t start, uint64_t end, bool readOnly) {
+    current_.push_back({start, end, readOnly});
+  }
+
+  //! Moves the ranges of the current kernel to the previous kernels
+  void newKernel() {
+    for (const auto& it : current_) {
+      insert(accessed_, it.start_, it.end_);
+      if (!it.readOnly_) {
+        insert(written_, it.start_, it.end_);
+      }
+    }
+    current_.clear();
+  }
+
+  //! Clears the ranges of the previous kernels and the current one if all is true
+  void clear(bool all) {
+    accessed_.clear();
+    written_.clear();
+    if (all) {
+      current_.clear();
+    } else if (current_.size() >= maxRanges_) {
+      // A single kernel can go over the limit with the SVM pointers, grow the limit then
+      maxRanges_ <<= 1;
+    }
+  }
+
+ private:
+  struct Range {
+    uint64_t start_;  //!< Start address
+    uint64_t end_;    //!< End address
+    bool readOnly_;   //!< The kernel only reads the range
+  };
+
+  //! The disjoint intervals, the start address is the key of the end address
+  typedef std::map<uint64_t, uint64_t> IntervalSet;
+
+  static bool overlaps(const IntervalSet& set, uint64_t start, uint64_t end) {
+    auto it = set.upper_bound(start);
+    if ((it != set.end()) && (it->first < end)) {
+      return true;
+    }
+    return (it != set.begin()) && (std::prev(it)->second > start);
+  }
+
+  static void insert(IntervalSet& set, uint64_t start, uint64_t end) {
+    // Merge with the touching or overlapping intervals
+    auto it = set.upper_bound(start);
+    if ((it != set.begin()) && (std::prev(it)->second >= start)) {
+      --it;
+      start = it->first;
+    }
+    while ((it != set.end()) && (it->first <= end)) {
+      end = std::max(end, it->second);
+      it = set.erase(it);
+    }
+    set.emplace_hint(it, start, end);
+  }
+
+  IntervalSet accessed_;          //!< The ranges, accessed by the previous kernels
+  IntervalSet written_;           //!< The ranges, written by the previous kernels
+  std::vector<Range> current_;    //!< The ranges of the current kernel
+  size_t maxRanges_;              //!< The limit of the tracked ranges
+};
+
+}  // namespace amd::device
@@ -113,6 +113,8 @@ Program::~Program() {
       amd::Comgr::destroy_metadata(kernelMeta.second);
     }
     amd::Comgr::destroy_metadata(metadata_);
+    // A failed kernel creation doesn't store the cache
+    delete kernelMetadataCache_;
 #endif
   }
 }
@@ -178,6 +180,14 @@ amd_comgr_status_t Program::extractByteCodeBinary(const amd_comgr_data_set_t inD
     status = amd::Comgr::get_data(binaryData, &binarySize, NULL);
   }
 
+  // The data stays in the data set for the next stage, if neither the dump nor the caller need it
+  if (outFileName.empty() && outBinary == nullptr) {
+    if (status == AMD_COMGR_STATUS_SUCCESS) {
+      amd::Comgr::release_data(binaryData);
+    }
+    return status;
+  }
+
   size_t bufSize = (dataKind == AMD_COMGR_DATA_KIND_LOG) ? binarySize + 1 : binarySize;
 
   char* binary = new char[bufSize];
@@ -223,6 +233,42 @@ amd_comgr_status_t Program::extractByteCodeBinary(const amd_comgr_data_set_t inD
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+amd_comgr_status_t Program::extractByteCodeBinary(const amd_comgr_data_set_t inDataSet,
+                                                  const amd_comgr_data_kind_t dataKind,
+                                                  const std::string& outFileName,
+                                                  std::string* outBinary) {
+  amd_comgr_data_t binaryData;
+
+  amd_comgr_status_t status = amd::Comgr::action_data_get_data(inDataSet, dataKind, 0, &binaryData);
+  if (status != AMD_COMGR_STATUS_SUCCESS) {
+    return status;
+  }
+
+  size_t binarySize = 0;
+  status = amd::Comgr::get_data(binaryData, &binarySize, NULL);
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    outBinary->resize(binarySize);
+    status = amd::Comgr::get_data(binaryData, &binarySize, &(*outBinary)[0]);
+  }
+  amd::Comgr::release_data(binaryData);
+
+  if (status != AMD_COMGR_STATUS_SUCCESS) {
+    outBinary->clear();
+    return status;
+  }
+
+  if (!outFileName.empty()) {
+    std::ofstream f(outFileName.c_str(), std::ios::trunc | std::ios::binary);
+    if (f.is_open()) {
+      f.write(outBinary->data(), outBinary->size());
+      f.close();
+    } else {
+      buildLog_ += "Warning: opening the file to dump the code failed.\n";
+    }
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t Program::addPreCompiledHeader(
     amd_comgr_data_set_t* dataSet, const std::vector<std::string>& preCompiledHeaders) {
   amd_comgr_status_t status = AMD_COMGR_STATUS_SUCCESS;
@@ -343,7 +389,7 @@ amd_comgr_status_t Program::createAction(const amd_comgr_language_t oclver,
 bool Program::linkLLVMBitcode(const amd_comgr_data_set_t inputs,
                               const std::vector<std::string>& options,
                               amd::option::Options* amdOptions, amd_comgr_data_set_t* output,
-                              char* binaryData[], size_t* binarySize) {
+                              std::string* bitcode) {
 
   amd_comgr_language_t langver = getCOMGRLanguage(isHIP(), *amdOptions);
   if (langver == AMD_COMGR_LANGUAGE_NONE) {
@@ -367,8 +413,12 @@ bool Program::linkLLVMBitcode(const amd_comgr_data_set_t inputs,
     if (amdOptions->isDumpFlagSet(amd::option::DUMP_BC_LINKED)) {
       dumpFileName = amdOptions->getDumpFileName("_linked.bc");
     }
-    status = extractByteCodeBinary(*output, AMD_COMGR_DATA_KIND_BC, dumpFileName, binaryData,
-                                   binarySize);
+    // The linked bitcode stays in the output data set for the codegen, unless it's requested
+    if (bitcode != nullptr) {
+      status = extractByteCodeBinary(*output, AMD_COMGR_DATA_KIND_BC, dumpFileName, bitcode);
+    } else if (!dumpFileName.empty()) {
+      status = extractByteCodeBinary(*output, AMD_COMGR_DATA_KIND_BC, dumpFileName);
+    }
   }
 
   if (hasAction) {
@@ -381,8 +431,7 @@ bool Program::linkLLVMBitcode(const amd_comgr_data_set_t inputs,
 bool Program::compileToLLVMBitcode(const amd_comgr_data_set_t compileInputs,
                                    const std::vector<std::string>& options,
                                    amd::option::Options* amdOptions,
-                                   char* binaryData[], size_t* binarySize,
-                                   const bool link_dev_libs) {
+                                   std::string* bitcode, const bool link_dev_libs) {
 
   amd_comgr_language_t langver = getCOMGRLanguage(isHIP(), *amdOptions);
   if (langver == AMD_COMGR_LANGUAGE_NONE) {
@@ -467,23 +516,23 @@ bool Program::compileToLLVMBitcode(const amd_comgr_data_set_t compileInputs,
     extractBuildLog(output);
   }
 
+  // The sources with the headers are consumed, release them before the bitcode is extracted
+  if (hasDataSetPCH) {
+    amd::Comgr::destroy_data_set(dataSetPCH);
+  }
+
   if (status == AMD_COMGR_STATUS_SUCCESS) {
     std::string outFileName;
     if (amdOptions->isDumpFlagSet(amd::option::DUMP_BC_OPTIMIZED)) {
        outFileName = amdOptions->getDumpFileName("_optimized.bc");
     }
-    status = extractByteCodeBinary(output, AMD_COMGR_DATA_KIND_BC, outFileName, binaryData,
-                                   binarySize);
+    status = extractByteCodeBinary(output, AMD_COMGR_DATA_KIND_BC, outFileName, bitcode);
   }
 
   if (hasAction) {
     amd::Comgr::destroy_action_info(action);
   }
 
-  if (hasDataSetPCH) {
-    amd::Comgr::destroy_data_set(dataSetPCH);
-  }
-
   if (hasOutput) {
     amd::Comgr::destroy_data_set(output);
   }
@@ -565,6 +614,12 @@ bool Program::compileAndLinkExecutable(const amd_comgr_data_set_t inputs,
     extractBuildLog(output);
   }
 
+  // The relocatable is consumed by the link
+  if (hasRelocatableData) {
+    amd::Comgr::destroy_data_set(relocatableData);
+    hasRelocatableData = false;
+  }
+
   if (status == AMD_COMGR_STATUS_SUCCESS) {
     // Extract the executable binary
     std::string outFileName;
@@ -725,15 +780,10 @@ bool Program::compileImplLC(const std::string& sourceCode,
     }
   }
 
-  // Compile source to IR
-  char* binaryData = nullptr;
-  size_t binarySize = 0;
-  bool ret = compileToLLVMBitcode(inputs, driverOptions, options, &binaryData, &binarySize);
+  // Compile source to IR, the bitcode is extracted directly into llvmBinary_
+  bool ret = compileToLLVMBitcode(inputs, driverOptions, options, &llvmBinary_);
+  amd::Comgr::destroy_data_set(inputs);
   if (ret) {
-    llvmBinary_.assign(binaryData, binarySize);
-    // Destroy the original LLVM binary, received after compilation
-    delete[] binaryData;
-
     elfSectionType_ = amd::Elf::LLVMIR;
 
     if (clBinary()->saveSOURCE()) {
@@ -749,7 +799,6 @@ bool Program::compileImplLC(const std::string& sourceCode,
     buildLog_ += "Error: Failed to compile source (from CL or HIP source to LLVM IR).\n";
   }
 
-  amd::Comgr::destroy_data_set(inputs);
   return ret;
 #else   // defined(USE_COMGR_LIBRARY)
   return false;
@@ -946,11 +995,8 @@ bool Program::linkImplLC(const std::vector<Program*>& inputPrograms,
 
   // NOTE: The options parameter is also used to identy cached code object.
   //       This parameter should not contain any dyanamically generated filename.
-  char* binaryData = nullptr;
-  size_t binarySize = 0;
   std::vector<std::string> linkOptions;
-  bool ret = linkLLVMBitcode(inputs, linkOptions, options, &output, &binaryData,
-                             &binarySize);
+  bool ret = linkLLVMBitcode(inputs, linkOptions, options, &output, &llvmBinary_);
 
   amd::Comgr::destroy_data_set(output);
   amd::Comgr::destroy_data_set(inputs);
@@ -960,11 +1006,6 @@ bool Program::linkImplLC(const std::vector<Program*>& inputPrograms,
     return false;
   }
 
-  llvmBinary_.assign(binaryData, binarySize);
-
-  // Destroy llvm binary, received after compilation
-  delete[] binaryData;
-
   elfSectionType_ = amd::Elf::LLVMIR;
 
   if (clBinary()->saveLLVMIR()) {
@@ -2670,6 +2711,7 @@ bool Program::createKernelMetadataMap(void* binary, size_t binSize) {
     // Assume an empty binary. HIP may have binaries with just global variables
     return true;
   }
+  kernelMetadataMap_.reserve(size);
 
   for (size_t i = 0; i < size && status == AMD_COMGR_STATUS_SUCCESS; i++) {
     amd_comgr_metadata_node_t nameMeta;
@@ -2694,7 +2736,7 @@ bool Program::createKernelMetadataMap(void* binary, size_t binSize) {
     }
 
     if (status == AMD_COMGR_STATUS_SUCCESS) {
-      kernelMetadataMap_[kernelName] = kernelNode;
+      kernelMetadataMap_[std::move(kernelName)] = kernelNode;
     }
     else {
       if (hasKernelNode) {
@@ -2719,6 +2761,35 @@ bool Program::createKernelMetadataMap(void* binary, size_t binSize) {
 }
 #endif
 
+// ================================================================================================
+void Program::OpenKernelMetadataCache(const void* binary, size_t binSize) {
+#if defined(USE_COMGR_LIBRARY)
+  delete kernelMetadataCache_;
+  kernelMetadataCache_ = nullptr;
+  // Code object v2 has the legacy metadata layout, which the cache doesn't keep
+  if ((GPU_KERNEL_METADATA_CACHE_PATH[0] == '\0') || (codeObjectVer() < 3)) {
+    return;
+  }
+  kernelMetadataCache_ = new KernelMetadataCache(*this, binary, binSize);
+  if (!kernelMetadataCache_->enabled()) {
+    delete kernelMetadataCache_;
+    kernelMetadataCache_ = nullptr;
+  }
+#endif
+}
+
+// ================================================================================================
+void Program::CloseKernelMetadataCache() {
+#if defined(USE_COMGR_LIBRARY)
+  if (kernelMetadataCache_ != nullptr) {
+    kernelMetadataCache_->Store();
+    delete kernelMetadataCache_;
+    kernelMetadataCache_ = nullptr;
+  }
+#endif
+}
+
+// ================================================================================================
 bool Program::FindGlobalVarSize(void* binary, size_t binSize) {
 #if defined(USE_COMGR_LIBRARY)
   // HIP doesn't need information about global variable size.
@@ -2728,8 +2799,9 @@ bool Program::FindGlobalVarSize(void* binary, size_t binSize) {
     size_t dynamicSize = 0;
     size_t progvarsWriteSize = 0;
 
+    // The binary outlives elfIn, hence parse it in place
     amd::Elf elfIn(ELFCLASSNONE, reinterpret_cast<const char *>(binary), binSize,
-                      nullptr, amd::Elf::ELF_C_READ);
+                      nullptr, amd::Elf::ELF_C_READ_MMAP);
 
     if (!elfIn.isSuccessful()) {
       buildLog_ += "Creating input amd::Elf object failed\n";
@@ -57,6 +57,7 @@ namespace option {
 namespace amd::device {
 class ClBinary;
 class Kernel;
+class KernelMetadataCache;
 
 struct SymbolInfo {
   int sym_type;
@@ -163,7 +164,10 @@ class Program : public amd::HeapObject {
 #if defined(USE_COMGR_LIBRARY)
   amd_comgr_metadata_node_t metadata_ = {}; //!< COMgr metadata
   uint32_t codeObjectVer_;                  //!< version of code object
-  std::map<std::string, amd_comgr_metadata_node_t> kernelMetadataMap_; //!< Map of kernel metadata
+  //! Map of kernel metadata, hashed since the mangled kernel names are long
+  std::unordered_map<std::string, amd_comgr_metadata_node_t> kernelMetadataMap_;
+  //! The kernel metadata cache of the kernel creation in progress
+  KernelMetadataCache* kernelMetadataCache_ = nullptr;
 #endif
   //! Sanitizer lock - lock when launching init/fini kernels
   static amd::Monitor initFiniLock_;
@@ -271,7 +275,7 @@ class Program : public amd::HeapObject {
   amd_comgr_metadata_node_t metadata() const { return metadata_; }
 
   //! Get the kernel metadata
-  const bool getKernelMetadata(const std::string name, amd_comgr_metadata_node_t* meta) const {
+  const bool getKernelMetadata(const std::string& name, amd_comgr_metadata_node_t* meta) const {
     auto it = kernelMetadataMap_.find(name);
     if (it != kernelMetadataMap_.end()) {
       *meta = it->second;
@@ -281,6 +285,9 @@ class Program : public amd::HeapObject {
   }
 
   const uint32_t codeObjectVer() const { return codeObjectVer_; }
+
+  //! Returns the kernel metadata cache of the kernel creation in progress, nullptr if none
+  KernelMetadataCache* kernelMetadataCache() const { return kernelMetadataCache_; }
 #endif
 
   //! Check if program is HIP based
@@ -389,6 +396,12 @@ class Program : public amd::HeapObject {
   //! Finds the total size of all global variables in the program
   bool FindGlobalVarSize(void* binary, size_t binSize);
 
+  //! Opens the kernel metadata cache of the code object for the kernel creation
+  void OpenKernelMetadataCache(const void* binary, size_t binSize);
+
+  //! Stores the kernels, which missed the metadata cache, and closes the cache
+  void CloseKernelMetadataCache();
+
   bool isElf(const char* bin) const { return amd::Elf::isElfMagic(bin); }
 
   virtual bool defineGlobalVar(const char* name, void* dptr) {
@@ -441,6 +454,10 @@ class Program : public amd::HeapObject {
   amd_comgr_status_t extractByteCodeBinary(const amd_comgr_data_set_t inDataSet,
     const amd_comgr_data_kind_t dataKind, const std::string& outFileName,
     char* outBinary[] = nullptr, size_t* outSize = nullptr);
+  //! Extract the code object data directly into the string, without the temporary buffer
+  amd_comgr_status_t extractByteCodeBinary(const amd_comgr_data_set_t inDataSet,
+    const amd_comgr_data_kind_t dataKind, const std::string& outFileName,
+    std::string* outBinary);
 
   //! Create code object and add it into the data set
   amd_comgr_status_t addCodeObjData(const char *source,
@@ -460,13 +477,12 @@ class Program : public amd::HeapObject {
   bool linkLLVMBitcode(const amd_comgr_data_set_t inputs,
     const std::vector<std::string>& options,
     amd::option::Options* amdOptions, amd_comgr_data_set_t* output,
-    char* binaryData[] = nullptr, size_t* binarySize = nullptr);
+    std::string* bitcode = nullptr);
 
   //! Create the bitcode of the compiled input dataset
   bool compileToLLVMBitcode(const amd_comgr_data_set_t compileInputs,
     const std::vector<std::string>& options, amd::option::Options* amdOptions,
-    char* binaryData[], size_t* binarySize,
-    const bool link_dev_libs = true);
+    std::string* bitcode, const bool link_dev_libs = true);
 
   //! Compile and create the excutable of the input dataset
   bool compileAndLinkExecutable(const amd_comgr_data_set_t inputs,
@@ -75,8 +75,17 @@ class ManagedBuffer : public amd::EmbeddedObject {
     GpuEvent events[AllEngines];
   };
 
-  //! The maximum number of the managed buffers
-  static constexpr uint32_t MaxNumberOfBuffers = 3;
+  //! The initial number of the managed buffers
+  static constexpr uint32_t InitialNumberOfBuffers = 3;
+
+  //! The maximum number of the managed buffers, the ring grows when the GPU falls behind
+  static constexpr uint32_t MaxNumberOfBuffers = 8;
+
+  //! Allocates a managed buffer
+  bool createBuffer(TimeStampedBuffer* buffer);
+
+  //! Returns true if the GPU doesn't use the buffer anymore
+  bool isIdle(TimeStampedBuffer* buffer);
 
   //! Disable copy constructor
   ManagedBuffer(const ManagedBuffer&) = delete;
@@ -90,6 +99,7 @@ class ManagedBuffer : public amd::EmbeddedObject {
   uint32_t size_;                        //!< Constant buffer size
   uint32_t wrtOffset_;                   //!< Current write offset
   address wrtAddress_;                   //!< Write address in CB
+  Resource::MemoryType type_;            //!< Memory type of the buffers
 };
 
 //! Constant buffer
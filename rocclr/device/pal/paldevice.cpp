@@ -698,6 +698,12 @@ void NullDevice::fillDeviceInfo(const Pal::DeviceProperties& palProp,
 }
 
 Device::XferBuffers::~XferBuffers() {
+  if ((hits_ + misses_) != 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_RESOURCE,
+            "Staging buffers %zu KiB: %zu pooled, %llu acquires, hit rate %.1f%%", bufSize_ / Ki,
+            freeBuffers_.size(), static_cast<unsigned long long>(hits_ + misses_),
+            100.0 * hits_ / (hits_ + misses_));
+  }
   // Destroy temporary buffer for reads
   for (const auto& buf : freeBuffers_) {
     // CPU optimization: unmap staging buffer just once
@@ -750,6 +756,7 @@ Memory& Device::XferBuffers::acquire() {
       xferBuf = nullptr;
       LogError("Couldn't allocate a transfer buffer!");
     } else {
+      ++misses_;
       ++acquiredCnt_;
       // CPU optimization: map staging buffer just once
       if (!xferBuf->desc().cardMemory_) {
@@ -761,9 +768,18 @@ Memory& Device::XferBuffers::acquire() {
   if (xferBuf == nullptr) {
     xferBuf = *(freeBuffers_.begin());
     freeBuffers_.erase(freeBuffers_.begin());
+    ++hits_;
     ++acquiredCnt_;
   }
 
+  // Track the working set, the peak of the concurrently acquired buffers. The pool grows on
+  // demand up to the working set and the window lets it shrink after a burst of transfers
+  windowPeak_ = std::max<uint>(windowPeak_, acquiredCnt_);
+  if (((hits_ + misses_) % WorkingSetWindow) == 0) {
+    peakAcquired_ = windowPeak_;
+    windowPeak_ = acquiredCnt_;
+  }
+
   return *xferBuf;
 }
 
@@ -773,8 +789,20 @@ void Device::XferBuffers::release(VirtualGPU& gpu, Memory& buffer) {
   buffer.wait(gpu);
   // Lock the operations with the staged buffer list
   amd::ScopedLock l(lock_);
-  freeBuffers_.push_back(&buffer);
   --acquiredCnt_;
+  // Keep the pinned buffers of the working set, but free the buffers over the peak of the
+  // previous and the current windows, since the staging memory is pinned in the system memory
+  const uint workingSet = std::max(std::max(peakAcquired_, windowPeak_), 1u);
+  if ((freeBuffers_.size() + acquiredCnt_) >= workingSet) {
+    if (!buffer.desc().cardMemory_) {
+      buffer.unmap(nullptr);
+    }
+    delete &buffer;
+    ClPrint(amd::LOG_INFO, amd::LOG_RESOURCE, "Staging buffers trimmed to the working set of %u",
+            workingSet);
+    return;
+  }
+  freeBuffers_.push_back(&buffer);
 }
 
 
@@ -822,6 +850,7 @@ Device::Device()
       captureMgr_(nullptr) {}
 
 Device::~Device() {
+  ReleaseP2PStages();
   if (p2p_stage_ != nullptr) {
     p2p_stage_->release();
     p2p_stage_ = nullptr;
@@ -1009,6 +1038,7 @@ bool Device::create(Pal::IDevice* device) {
                            appProfile_.reportAsOCL12Device())) {
     return false;
   }
+  gpuSettings->setXferTuning(isa->processorName());
 
   // Fill the device info structure
   fillDeviceInfo(properties(), heaps_, 16 * Ki, numComputeEngines(), numExclusiveComputeEngines(), iDev());
@@ -284,10 +284,19 @@ class Device : public NullDevice {
   class XferBuffers : public amd::HeapObject {
    public:
     static constexpr size_t MaxXferBufListSize = 8;
+    //! The number of the acquires in the working set window
+    static constexpr uint64_t WorkingSetWindow = 1024;
 
     //! Default constructor
     XferBuffers(const Device& device, Resource::MemoryType type, size_t bufSize)
-        : type_(type), bufSize_(bufSize), acquiredCnt_(0), gpuDevice_(device) {}
+        : type_(type),
+          bufSize_(bufSize),
+          acquiredCnt_(0),
+          hits_(0),
+          misses_(0),
+          peakAcquired_(0),
+          windowPeak_(0),
+          gpuDevice_(device) {}
 
     //! Default destructor
     ~XferBuffers();
@@ -320,6 +329,10 @@ class Device : public NullDevice {
     size_t bufSize_;                  //!< Staged buffer size
     std::list<Memory*> freeBuffers_;  //!< The list of free buffers
     std::atomic<uint> acquiredCnt_;   //!< The total number of acquired buffers
+    uint64_t hits_;                   //!< Acquires served from the free list
+    uint64_t misses_;                 //!< Acquires with a new allocation
+    uint peakAcquired_;               //!< Peak acquired buffers in the previous window
+    uint windowPeak_;                 //!< Peak acquired buffers in the current window
     amd::Monitor lock_;               //!< Stgaed buffer acquire/release lock
     const Device& gpuDevice_;         //!< GPU device object
   };
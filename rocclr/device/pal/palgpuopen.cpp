@@ -272,7 +272,10 @@ void RgpCaptureMgr::PostDispatch(VirtualGPU* gpu) {
     if (trace_.status_ == TraceStatus::Running) {
       amd::ScopedLock traceLock(&trace_mutex_);
       trace_.sqtt_disp_count_++;
-      if (trace_.sqtt_disp_count_ >= max_sqtt_disp_) {
+      // The time window captures end at the earlier of the window and the dispatch limit
+      const uint64_t window = device_.settings().rgpSqttTimeWindow_ * 1000000ull;
+      if ((trace_.sqtt_disp_count_ >= max_sqtt_disp_) ||
+          ((window != 0) && ((amd::Os::timeNanos() - trace_.sqtt_begin_time_) >= window))) {
         Pal::Result res = EndRGPHardwareTrace(gpu);
         if (Pal::Result::ErrorIncompatibleQueue == res) {
           // continue until we find the right queue...
@@ -427,7 +430,12 @@ void RgpCaptureMgr::PreDispatch(VirtualGPU* gpu, const HSAILKernel& kernel, size
       }
     }
 
-    if (trace_.status_ == TraceStatus::Running) {
+    if ((trace_.status_ == TraceStatus::Running) && device_.settings().rgpSqttLightMarkers_) {
+      // Keep the host work per dispatch to a single marker
+      WriteEventWithDimsMarker(gpu, RgpSqttMarkerEventType::CmdNDRangeKernel,
+                               static_cast<uint32_t>(x), static_cast<uint32_t>(y),
+                               static_cast<uint32_t>(z));
+    } else if (trace_.status_ == TraceStatus::Running) {
       RgpSqttMarkerEventType apiEvent = RgpSqttMarkerEventType::CmdNDRangeKernel;
       if (kernel.prog().isInternal()) {
         constexpr RgpSqttMarkerEventType ApiEvents[KernelBlitManager::BlitTotal] = {
@@ -636,6 +644,7 @@ Pal::Result RgpCaptureMgr::BeginRGPTrace(VirtualGPU* gpu) {
   if (result == Pal::Result::Success) {
     trace_.status_ = TraceStatus::Running;
     trace_.begin_queue_ = gpu;
+    trace_.sqtt_begin_time_ = amd::Os::timeNanos();
   }
 
   return result;
@@ -371,6 +371,7 @@ class RgpCaptureMgr final : public ICaptureMgr {
 
     uint32_t prepared_disp_count_;  // Number of dispatches counted while preparing for a trace
     uint32_t sqtt_disp_count_;      // Number of dispatches counted while SQTT tracing is active
+    uint64_t sqtt_begin_time_;      // Host time of the SQTT start in ns
     mutable uint32_t current_event_id_;  // Current event ID
   };
 
@@ -2266,7 +2266,11 @@ bool ResourceCache::addGpuMemory(Resource::Descriptor* desc, GpuMemoryReference*
 
       amd::ScopedLock l(&lockCacheOps_);
       // Add the current resource to the cache
-      resCache_.push_front({descCached, ref});
+      const uint64_t key = CacheKey(*desc, amd::log2(size));
+      resCache_.push_front({descCached, ref, size, key});
+      CacheBucket& bucket = resIndex_[key];
+      bucket.push_front(resCache_.begin());
+      resCache_.front().bucket_ = bucket.begin();
       ref->gpu_ = nullptr;
       cacheSize_ += size;
       if (desc->type_ == Resource::Local) {
@@ -2315,41 +2319,59 @@ GpuMemoryReference* ResourceCache::findGpuMemory(Resource::Descriptor* desc, Pal
     return ref;
   }
 
-  // Serach the right resource through the cache list
-  for (const auto& it : resCache_) {
-    Resource::Descriptor* entry = it.first;
-    size_t sizeRes = it.second->iMem()->Desc().size;
-    // Find if we can reuse this entry
-    if ((entry->type_ == desc->type_) && (entry->flags_ == desc->flags_) && (size <= sizeRes) &&
-        (size > (sizeRes >> 1)) && ((it.second->iMem()->Desc().gpuVirtAddr % alignment) == 0) &&
-        (entry->isAllocExecute_ == desc->isAllocExecute_) &&
-        (entry->SVMRes_ == desc->SVMRes_) &&
-        (entry->gl2CacheDisabled_ == desc->gl2CacheDisabled_) &&
-        (entry->interprocess_ == desc->interprocess_)) {
-      ref = it.second;
-      cacheSize_ -= sizeRes;
-      if (entry->type_ == Resource::Local) {
-        lclCacheSize_ -= sizeRes;
-      } else if (entry->type_ == Resource::Persistent) {
-        persistentCacheSize_ -= sizeRes;
+  // A reusable entry is at least the requested size and less than twice the size,
+  // hence it's in the size class of the request or in the next one
+  const uint sizeClass = amd::log2(size);
+  for (uint sc = sizeClass; sc <= sizeClass + 1; ++sc) {
+    auto bucket = resIndex_.find(CacheKey(*desc, sc));
+    if (bucket == resIndex_.end()) {
+      continue;
+    }
+    for (auto it : bucket->second) {
+      if ((size <= it->size_) && (size > (it->size_ >> 1)) &&
+          ((it->ref_->iMem()->Desc().gpuVirtAddr % alignment) == 0)) {
+        return removeEntry(it);
       }
-      delete it.first;
-      // Remove the found etry from the cache
-      resCache_.remove(it);
-      break;
     }
   }
 
   return ref;
 }
 
+// ================================================================================================
+uint64_t ResourceCache::CacheKey(const Resource::Descriptor& desc, uint sizeClass) {
+  // The attributes must match for the reuse
+  return (static_cast<uint64_t>(desc.type_) << 48) | (static_cast<uint64_t>(desc.flags_) << 16) |
+      (desc.isAllocExecute_ << 11) | (desc.SVMRes_ << 10) | (desc.gl2CacheDisabled_ << 9) |
+      (desc.interprocess_ << 8) | sizeClass;
+}
+
+// ================================================================================================
+GpuMemoryReference* ResourceCache::removeEntry(CacheLru::iterator entry) {
+  GpuMemoryReference* ref = entry->ref_;
+  cacheSize_ -= entry->size_;
+  if (entry->desc_->type_ == Resource::Local) {
+    lclCacheSize_ -= entry->size_;
+  } else if (entry->desc_->type_ == Resource::Persistent) {
+    persistentCacheSize_ -= entry->size_;
+  }
+  auto bucket = resIndex_.find(entry->key_);
+  bucket->second.erase(entry->bucket_);
+  if (bucket->second.empty()) {
+    resIndex_.erase(bucket);
+  }
+  delete entry->desc_;
+  resCache_.erase(entry);
+  return ref;
+}
+
 // ================================================================================================
 bool ResourceCache::free(size_t minCacheEntries) {
   bool result = false;
   if (minCacheEntries < resCache_.size()) {
     result = true;
     // Clear the cache
-    while (static_cast<int64_t>(cacheSize_) > 0) {
+    while (!resCache_.empty()) {
       removeLast();
     }
     CondLog((cacheSize_ != 0), "Incorrect size for cache release!");
@@ -2359,27 +2381,19 @@ bool ResourceCache::free(size_t minCacheEntries) {
 
 // ================================================================================================
 void ResourceCache::removeLast() {
-  std::pair<Resource::Descriptor*, GpuMemoryReference*> entry;
+  GpuMemoryReference* ref = nullptr;
   {
     // Protect access to the global data
     amd::ScopedLock l(&lockCacheOps_);
     if (resCache_.size() > 0) {
-      entry = resCache_.back();
-      resCache_.pop_back();
-      auto mem_size = entry.second->iMem()->Desc().size;
-      cacheSize_ -= mem_size;
-      if (entry.first->type_ == Resource::Local) {
-        lclCacheSize_ -= mem_size;
-      } else if (entry.first->type_ == Resource::Persistent) {
-        persistentCacheSize_ -= mem_size;
-      }
-      // Delete Descriptor
-      delete entry.first;
+      ref = removeEntry(std::prev(resCache_.end()));
     }
   }
 
   // Destroy PAL resource
-  entry.second->release();
+  if (ref != nullptr) {
+    ref->release();
+  }
 }
 
 }  // namespace amd::pal
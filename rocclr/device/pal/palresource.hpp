@@ -625,6 +625,25 @@ class ResourceCache : public amd::HeapObject {
   //! Disable operator=
   ResourceCache& operator=(const ResourceCache&);
 
+  struct CacheEntry;
+  typedef std::list<CacheEntry> CacheLru;
+  //! Entries of the same memory attributes and size class in the LRU order
+  typedef std::list<CacheLru::iterator> CacheBucket;
+
+  struct CacheEntry {
+    Resource::Descriptor* desc_;     //!< Resource descriptor
+    GpuMemoryReference* ref_;        //!< Cached PAL resource
+    size_t size_;                    //!< Size of PAL resource
+    uint64_t key_;                   //!< Index key of the bucket
+    CacheBucket::iterator bucket_;   //!< Position in the bucket
+  };
+
+  //! Returns the index key for the memory attributes and the size class
+  static uint64_t CacheKey(const Resource::Descriptor& desc, uint sizeClass);
+
+  //! Removes an entry from the cache and returns the PAL resource
+  GpuMemoryReference* removeEntry(CacheLru::iterator entry);
+
   //! Removes one last entry from the cache
   void removeLast();
 
@@ -635,8 +654,10 @@ class ResourceCache : public amd::HeapObject {
   size_t persistentCacheSize_;  //!< Persistent memory stored in the cache
   const size_t cacheSizeLimit_; //!< Cache size limit in bytes
 
-  //! PAL resource cache
-  std::list<std::pair<Resource::Descriptor*, GpuMemoryReference*> > resCache_;
+  //! PAL resource cache, the most recently added entries first
+  CacheLru resCache_;
+  //! Index of the cache by the memory attributes and the size class
+  std::unordered_map<uint64_t, CacheBucket> resIndex_;
 
   MemorySubAllocator mem_sub_alloc_local_;                     //!< Allocator for suballocations in Local
   CoarseMemorySubAllocator mem_sub_alloc_coarse_;              //!< Allocator for suballocations in Coarse SVM
@@ -121,6 +121,9 @@ Settings::Settings() {
 
   // SQTT buffer size in bytes
   rgpSqttDispCount_ = PAL_RGP_DISP_COUNT;
+  rgpSqttTimeWindow_ = PAL_RGP_TIME_WINDOW;
+  // The time window captures are meant for the production runs, hence skip the name markers
+  rgpSqttLightMarkers_ = (rgpSqttTimeWindow_ != 0);
   rgpSqttWaitIdle_ = true;
   rgpSqttForceDisable_ = false;
 
@@ -445,6 +448,22 @@ bool Settings::create(const Pal::DeviceProperties& palProp,
   return true;
 }
 
+void Settings::setXferTuning(const std::string& processor) {
+  const device::XferTuning* tuning = device::XferTuning::Find(processor);
+  if (tuning == nullptr) {
+    return;
+  }
+  if ((tuning->pinnedXferSize_ != 0) && flagIsDefault(GPU_PINNED_XFER_SIZE)) {
+    pinnedXferSize_ = tuning->pinnedXferSize_;
+  }
+  if ((tuning->pinnedMinXferSize_ != 0) && flagIsDefault(GPU_PINNED_MIN_XFER_SIZE)) {
+    pinnedMinXferSize_ = tuning->pinnedMinXferSize_;
+  }
+  if ((tuning->stagedXferSize_ != 0) && flagIsDefault(GPU_STAGING_BUFFER_SIZE)) {
+    stagedXferSize_ = tuning->stagedXferSize_;
+  }
+}
+
 void Settings::override() {
   // Limit reported workgroup size
   if (GPU_MAX_WORKGROUP_SIZE != 0) {
@@ -79,7 +79,8 @@ class Settings : public device::Settings {
       uint imageBufferWar_ : 1;         //!< Image buffer workaround for Gfx10
       uint disableSdma_ : 1;            //!< Disable SDMA support
       uint alwaysResident_ : 1;         //!< Make resources resident at allocation time
-      uint reserved_ : 10;
+      uint rgpSqttLightMarkers_ : 1;    //!< Only the dispatch markers in SQTT
+      uint reserved_ : 9;
     };
     uint value_;
   };
@@ -105,6 +106,7 @@ class Settings : public device::Settings {
   size_t numMemDependencies_;    //!< The array size for memory dependencies tracking
   uint64_t maxAllocSize_;        //!< Maximum single allocation size
   uint rgpSqttDispCount_;        //!< The number of dispatches captured in SQTT
+  uint rgpSqttTimeWindow_;       //!< SQTT capture time in ms, 0 - capture by dispatch count
   uint maxCmdBuffers_;           //!< Maximum number of command buffers allocated per queue
   uint mallPolicy_;              //!< 0 - default, 1 - always bypass, 2 - always put
 
@@ -128,6 +130,9 @@ class Settings : public device::Settings {
               bool reportAsOCL12Device = false            //!< Report As OpenCL1.2 Device
   );
 
+  //! Takes the transfer defaults from the tuning table entry of the processor
+  void setXferTuning(const std::string& processor);
+
  private:
   //! Disable copy constructor
   Settings(const Settings&);
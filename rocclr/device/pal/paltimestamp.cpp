@@ -27,9 +27,9 @@
 
 namespace amd::pal {
 
-TimeStamp::TimeStamp(const VirtualGPU& gpu, Pal::IGpuMemory* iMem, uint memOffset, address cpuAddr)
-    : gpu_(gpu), iMem_(iMem), memOffset_(memOffset) {
-  values_ = reinterpret_cast<volatile uint64_t*>(cpuAddr + memOffset);
+TimeStamp::TimeStamp(const VirtualGPU& gpu, TimeStampPool& pool, uint memOffset)
+    : gpu_(gpu), pool_(pool), iMem_(pool.mem_->iMem()), memOffset_(memOffset) {
+  values_ = reinterpret_cast<volatile uint64_t*>(pool.cpuAddr_ + memOffset);
 }
 
 TimeStamp::~TimeStamp() {}
@@ -55,11 +55,10 @@ inline void SetValue(uint64_t* time, uint64_t val, double nanos) {
 
 void TimeStamp::value(uint64_t* startTime, uint64_t* endTime) {
   CondLog(!flags_.endIssued_, "We didn't send the counter end operation!");
-  //! @todo optimize!
-  const double NanoSecondsPerTick = 1000000000.0 / (gpu_.dev().properties().timestampFrequency);
+  const uint64_t* copy = &pool_.values_[memOffset_ / sizeof(uint64_t)];
 
-  SetValue(startTime, values_[CommandStartTime], NanoSecondsPerTick);
-  SetValue(endTime, values_[CommandEndTime], NanoSecondsPerTick);
+  SetValue(startTime, copy[CommandStartTime], pool_.nanosPerTick_);
+  SetValue(endTime, copy[CommandEndTime], pool_.nanosPerTick_);
 }
 
 TimeStampCache::~TimeStampCache() {
@@ -71,16 +70,30 @@ TimeStampCache::~TimeStampCache() {
 
   // Release all memory objects
   for (uint i = 0; i < tsBuf_.size(); ++i) {
-    tsBuf_[i]->unmap(&gpu_);
-    gpu_.queue(MainEngine).removeMemRef(tsBuf_[i]->iMem());
+    Memory* mem = tsBuf_[i]->mem_;
+    mem->unmap(&gpu_);
+    gpu_.queue(MainEngine).removeMemRef(mem->iMem());
     if (!gpu_.dev().settings().disableSdma_) {
-      gpu_.queue(SdmaEngine).removeMemRef(tsBuf_[i]->iMem());
+      gpu_.queue(SdmaEngine).removeMemRef(mem->iMem());
     }
+    delete mem;
     delete tsBuf_[i];
   }
   tsBuf_.clear();
 }
 
+void TimeStampCache::readback() {
+  for (auto pool : tsBuf_) {
+    if (pool->readEnd_ > pool->readBegin_) {
+      // A single sequential read of the uncached memory for all staged time stamps
+      memcpy(&pool->values_[pool->readBegin_ / sizeof(uint64_t)],
+             pool->cpuAddr_ + pool->readBegin_, pool->readEnd_ - pool->readBegin_);
+      pool->readBegin_ = TimerBufSize;
+      pool->readEnd_ = 0;
+    }
+  }
+}
+
 TimeStamp* TimeStampCache::allocTimeStamp() {
   TimeStamp* ts = nullptr;
   if (0 != freedTS_.size()) {
@@ -89,22 +102,29 @@ TimeStamp* TimeStampCache::allocTimeStamp() {
   }
 
   if (nullptr == ts) {
-    if ((tsBufCpu_ == nullptr) || ((tsOffset_ + TimerSlotSize) > TimerBufSize)) {
+    if (tsBuf_.empty() || ((tsOffset_ + TimerSlotSize) > TimerBufSize)) {
       Memory* buf = new Memory(gpu_.dev(), TimerBufSize);
       if (buf == nullptr || !buf->create(Resource::Remote)) {
+        delete buf;
         return nullptr;
       }
       gpu_.queue(MainEngine).addMemRef(buf->iMem());
       if (!gpu_.dev().settings().disableSdma_) {
         gpu_.queue(SdmaEngine).addMemRef(buf->iMem());
       }
-      tsBufCpu_ = reinterpret_cast<address>(buf->map(&gpu_));
-      memset(tsBufCpu_, 0, TimerBufSize);
+      TimeStampPool* pool = new TimeStampPool();
+      pool->mem_ = buf;
+      pool->cpuAddr_ = reinterpret_cast<address>(buf->map(&gpu_));
+      memset(pool->cpuAddr_, 0, TimerBufSize);
+      pool->values_.resize(TimerBufSize / sizeof(uint64_t), 0);
+      pool->readBegin_ = TimerBufSize;
+      pool->readEnd_ = 0;
+      pool->nanosPerTick_ = 1000000000.0 / gpu_.dev().properties().timestampFrequency;
       tsOffset_ = 0;
-      tsBuf_.push_back(buf);
+      tsBuf_.push_back(pool);
     }
     // Allocate a TimeStamp object
-    ts = new TimeStamp(gpu_, tsBuf_[(tsBuf_.size() - 1)]->iMem(), tsOffset_, tsBufCpu_);
+    ts = new TimeStamp(gpu_, *tsBuf_.back(), tsOffset_);
     // Create a timestamp
     if (ts == nullptr) {
       return nullptr;
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include "device/pal/paldefs.hpp"
 #include "device/pal/palresource.hpp"
 
@@ -34,6 +35,17 @@ class Device;
 class VirtualGPU;
 class Memory;
 
+//! Buffer with the timer values and the host copy of them. The GPU writes the timer values into
+//! the uncached memory, hence the profiling reads the values of the entire batch in one copy.
+struct TimeStampPool : public amd::HeapObject {
+  Memory* mem_;                   //!< Memory object with the timer values
+  address cpuAddr_;               //!< CPU pointer for the values in memory
+  std::vector<uint64_t> values_;  //!< Host copy of the timer values
+  uint readBegin_;                //!< Start offset of the range for the next readback
+  uint readEnd_;                  //!< End offset of the range for the next readback
+  double nanosPerTick_;           //!< GPU timer period in nano seconds
+};
+
 class TimeStamp : public amd::HeapObject {
  public:
   //! Enums for the timestamp information
@@ -53,9 +65,8 @@ class TimeStamp : public amd::HeapObject {
 
   //! Default constructor
   TimeStamp(const VirtualGPU& gpu,  //!< Virtual GPU
-            Pal::IGpuMemory* iMem,  //!< Buffer with the timer values
-            uint memOffset,         //!< Offset in the buffer for the current TS
-            address cpuAddr         //!< CPU pointer for the values in memory
+            TimeStampPool& pool,    //!< Buffer with the timer values
+            uint memOffset          //!< Offset in the buffer for the current TS
   );
 
   //! Default destructor
@@ -67,7 +78,13 @@ class TimeStamp : public amd::HeapObject {
   //! Ends the timestamp
   void end();
 
-  //! Returns the timestamp result in nano seconds
+  //! Adds the timer values into the range of the next pool readback
+  void stage() {
+    pool_.readBegin_ = std::min(pool_.readBegin_, memOffset_);
+    pool_.readEnd_ = std::max(pool_.readEnd_, memOffset_ + CommandTotal * uint(sizeof(uint64_t)));
+  }
+
+  //! Returns the timestamp result in nano seconds from the host copy of the last readback
   void value(uint64_t* startTime, uint64_t* endTime);
 
   //! Clear all TimeStamp states
@@ -75,6 +92,9 @@ class TimeStamp : public amd::HeapObject {
     flags_.value_ = 0;
     values_[CommandStartTime] = 0;
     values_[CommandEndTime] = 0;
+    uint64_t* copy = &pool_.values_[memOffset_ / sizeof(uint64_t)];
+    copy[CommandStartTime] = 0;
+    copy[CommandEndTime] = 0;
   }
 
   //! Timer commands were submitted to HW
@@ -92,7 +112,8 @@ class TimeStamp : public amd::HeapObject {
 
   const VirtualGPU& gpu_;      //!< Virtual GPU
   Flags flags_;                //!< The time stamp state
-  Pal::IGpuMemory* iMem_;      //!< Buffer with the timer values
+  TimeStampPool& pool_;        //!< Buffer with the timer values
+  Pal::IGpuMemory* iMem_;      //!< GPU memory of the timer values
   uint memOffset_;             //!< Offset in the buffer for the current timer
   volatile uint64_t* values_;  //!< CPU pointer to the timer values
 };
@@ -102,7 +123,7 @@ class TimeStampCache : public amd::HeapObject {
   //! Default constructor
   TimeStampCache(VirtualGPU& gpu  //!< Virtual GPU object
                  )
-      : gpu_(gpu), tsBufCpu_(NULL), tsOffset_(0) {}
+      : gpu_(gpu), tsOffset_(0) {}
 
   //! Default destructor
   ~TimeStampCache();
@@ -113,6 +134,10 @@ class TimeStampCache : public amd::HeapObject {
   //! Frees a time stamp object
   void freeTimeStamp(TimeStamp* ts) { freedTS_.push_back(ts); }
 
+  //! Copies the staged timer values of all pools into the host copies. The GPU must be done
+  //! with the staged time stamps.
+  void readback();
+
  private:
   static constexpr uint TimerSlotSize = TimeStamp::CommandTotal * sizeof(uint64_t);
   static constexpr uint TimerBufSize = TimerSlotSize * 4096;
@@ -123,11 +148,10 @@ class TimeStampCache : public amd::HeapObject {
   //! Disable operator=
   TimeStampCache& operator=(const TimeStampCache&);
 
-  std::vector<TimeStamp*> freedTS_;  //!< Array of freed time stamp objects
-  VirtualGPU& gpu_;                  //!< Virtual GPU
-  std::vector<Memory*> tsBuf_;       //!< Array of memory objects with the timer value
-  address tsBufCpu_;                 //!< CPU pointer for current TS memory
-  uint tsOffset_;                    //!< Active offset in the current mem object
+  std::vector<TimeStamp*> freedTS_;    //!< Array of freed time stamp objects
+  VirtualGPU& gpu_;                    //!< Virtual GPU
+  std::vector<TimeStampPool*> tsBuf_;  //!< Array of pools with the timer values
+  uint tsOffset_;                      //!< Active offset in the current pool
 };
 
 /*@}*/  // namespace amd::pal
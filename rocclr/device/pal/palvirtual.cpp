@@ -139,7 +139,8 @@ VirtualGPU::Queue* VirtualGPU::Queue::Create(VirtualGPU& gpu, Pal::QueueType que
     return nullptr;
   }
 
-  size_t allocSize = qSize + max_command_buffers * (cmdSize + fSize);
+  const uint capacity = Queue::CmdBufferCapacity(max_command_buffers);
+  size_t allocSize = qSize + capacity * (cmdSize + fSize);
   VirtualGPU::Queue* queue =
       new (allocSize) VirtualGPU::Queue(gpu, palDev, residency_limit, max_command_buffers);
   if (queue != nullptr) {
@@ -210,10 +211,10 @@ VirtualGPU::Queue* VirtualGPU::Queue::Create(VirtualGPU& gpu, Pal::QueueType que
     }
     queue->UpdateAppPowerProfile();
     address addrCmd = addrQ + qSize;
-    address addrF = addrCmd + max_command_buffers * cmdSize;
+    address addrF = addrCmd + capacity * cmdSize;
     Pal::CmdBufferBuildInfo cmdBuildInfo = {};
 
-    for (uint i = 0; i < max_command_buffers; ++i) {
+    for (uint i = 0; i < capacity; ++i) {
       result = palDev->CreateCmdBuffer(cmdCreateInfo, &addrCmd[i * cmdSize], &queue->iCmdBuffs_[i]);
       if (result != Pal::Result::Success) {
         delete queue;
@@ -330,8 +331,15 @@ void VirtualGPU::Queue::addCmdMemRef(GpuMemoryReference* mem) {
 void VirtualGPU::Queue::removeCmdMemRef(GpuMemoryReference* mem) {
   Pal::IGpuMemory* iMem = mem->iMem();
   if (0 != memReferences_.erase(mem)) {
-    iDev_->RemoveGpuMemoryReferences(1, &iMem, iQueue_);
     residency_size_ -= iMem->Desc().size;
+    // A reference, which wasn't flushed yet, is only in the pending list
+    auto pending = std::find_if(palMemRefs_.begin(), palMemRefs_.end(),
+        [iMem](const Pal::GpuMemoryRef& ref) { return ref.pGpuMemory == iMem; });
+    if (pending != palMemRefs_.end()) {
+      palMemRefs_.erase(pending);
+    } else {
+      iDev_->RemoveGpuMemoryReferences(1, &iMem, iQueue_);
+    }
   }
 }
 
@@ -438,6 +446,7 @@ bool VirtualGPU::Queue::flush() {
 
   // Reset the counter of commands
   cmdCnt_ = 0;
+  cmdBufIds_[cmdBufIdSlot_] = cmdBufIdCurrent_;
 
   // Find the next command buffer
   cmdBufIdCurrent_++;
@@ -447,18 +456,28 @@ bool VirtualGPU::Queue::flush() {
     waifForFence<!IbReuse>(cmdBufIdSlot_);
     cmdBufIdCurrent_ = 1;
     cmbBufIdRetired_ = 0;
+    std::fill(cmdBufIds_.begin(), cmdBufIds_.end(), 0);
   }
 
-  // Wrap current slot
-  cmdBufIdSlot_ = cmdBufIdCurrent_ % max_command_buffers_;
+  // Move to the next slot of the ring
+  uint nextSlot = (cmdBufIdSlot_ + 1) % active_command_buffers_;
+  // The ring grows at the wrap point only, so the slots stay in the submission order. If the
+  // oldest submission is still busy, then the GPU falls behind and the recording would stall
+  if ((nextSlot == 0) && (active_command_buffers_ < max_command_buffers_) &&
+      (iCmdFences_[nextSlot]->GetStatus() == Pal::Result::NotReady)) {
+    nextSlot = active_command_buffers_++;
+    ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "PAL queue grows to %d command buffers",
+            active_command_buffers_);
+  }
+  cmdBufIdSlot_ = nextSlot;
 
   waifForFence<IbReuse>(cmdBufIdSlot_);
 
-  // Progress retired TS
-  if ((cmdBufIdCurrent_ > max_command_buffers_) &&
-      (cmbBufIdRetired_ < (cmdBufIdCurrent_ - max_command_buffers_))) {
-    cmbBufIdRetired_ = cmdBufIdCurrent_ - max_command_buffers_;
+  // Progress retired TS, the submissions complete in order
+  if (cmbBufIdRetired_ < cmdBufIds_[cmdBufIdSlot_]) {
+    cmbBufIdRetired_ = cmdBufIds_[cmdBufIdSlot_];
   }
+  cmdBufIds_[cmdBufIdSlot_] = 0;
 
   // Reset command buffer, so CB chunks could be reused
   if (Pal::Result::Success != iCmdBuffs_[cmdBufIdSlot_]->Reset(nullptr, false)) {
@@ -477,8 +496,9 @@ bool VirtualGPU::Queue::flush() {
   palDoppRefs_.clear();
   palSdiRefs_.clear();
 
-  // Remove old memory references
-  if ((memReferences_.size() > 2048) || (residency_size_ > residency_limit_)) {
+  // Remove the memory references, which the retired command buffer used last. The other
+  // references stay resident, so the next submissions send only the new ones
+  if ((memReferences_.size() > PAL_MAX_RESIDENT_REFS) || (residency_size_ > residency_limit_)) {
     for (auto it = memReferences_.begin(); it != memReferences_.end();) {
       if (it->second == cmdBufIdSlot_) {
         palMems_.push_back(it->first->iMem());
@@ -509,7 +529,12 @@ bool VirtualGPU::Queue::waitForEvent(uint id) {
     return false;
   }
 
-  uint slotId = id % max_command_buffers_;
+  uint slotId = findSlot(id);
+  if (slotId == max_command_buffers_) {
+    // The slot was reused, hence the submission is done
+    cmbBufIdRetired_ = id;
+    return true;
+  }
   constexpr bool IbReuse = true;
   bool result = waifForFence<!IbReuse>(slotId);
   cmbBufIdRetired_ = id;
@@ -531,7 +556,9 @@ bool VirtualGPU::Queue::isDone(uint id) {
     }
   }
 
-  if (Pal::Result::Success != iCmdFences_[id % max_command_buffers_]->GetStatus()) {
+  uint slotId = findSlot(id);
+  if ((slotId != max_command_buffers_) &&
+      (Pal::Result::Success != iCmdFences_[slotId]->GetStatus())) {
     return false;
   }
   cmbBufIdRetired_ = id;
@@ -590,23 +617,14 @@ void VirtualGPU::Queue::DumpMemoryReferences() const {
 }
 
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
-  if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
-    maxMemObjectsInQueue_ = numMemObj;
-  }
-
+  ranges_.create(numMemObj);
   return true;
 }
 
 void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
   bool flushL1Cache = false;
 
-  if (maxMemObjectsInQueue_ == 0) {
+  if (ranges_.maxRanges() == 0) {
     // Return earlier if tracking is disabled
     return;
   }
@@ -618,30 +636,14 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
     // Mark resource as modified
     memory->setModified(gpu, !readOnly);
 
-    // Loop through all memory objects in the queue and find dependency
+    // Find the dependency on the memory of the previous kernels, if the busy region was
+    // written or the current one is for write
     // @note don't include objects from the current kernel
-    for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-      // Check if the queue already contains this mem object and
-      // GPU operations aren't readonly
-      uint64_t busyStart = memObjectsInQueue_[j].start_;
-      uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-      // Check if the start inside the busy region
-      if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-           // Check if the end inside the busy region
-           ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-           // Check if the start/end cover the busy region
-           ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-          // If the buys region was written or the current one is for write
-          (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-        flushL1Cache = true;
-        break;
-      }
-    }
+    flushL1Cache = ranges_.depends(curStart, curEnd, readOnly);
   }
 
   // Did we reach the limit?
-  if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
+  if (ranges_.full()) {
     flushL1Cache = true;
   }
 
@@ -657,46 +659,11 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   // Insert current memory object into the queue always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
-  numMemObjectsInQueue_++;
+  ranges_.add(curStart, curEnd, readOnly);
 }
 
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      size_t i, j;
-      // Preserve all objects from the current kernel
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_ = ptr;
-    }
-
-    // Adjust the number of active objects
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
-  }
+  ranges_.clear(all);
 }
 
 void VirtualGPU::addPinnedMem(amd::Memory* mem) {
@@ -1534,6 +1501,55 @@ void VirtualGPU::submitCopyMemory(amd::CopyMemoryCommand& vcmd) {
   profilingEnd(vcmd);
 }
 
+void VirtualGPU::submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& vcmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(vcmd);
+
+  amd::BufferRect rect;
+  for (const auto& it : vcmd.copies()) {
+    amd::Coord3D srcOrigin(it.srcOffset_);
+    amd::Coord3D dstOrigin(it.dstOffset_);
+    amd::Coord3D size(it.size_);
+    bool entire = it.src_->isEntirelyCovered(srcOrigin, size) &&
+                  it.dst_->isEntirelyCovered(dstOrigin, size);
+    if (!copyMemory(vcmd.type(), *it.src_, *it.dst_, entire, srcOrigin, dstOrigin, size, rect,
+                    rect, vcmd.copyMetadata())) {
+      vcmd.setStatus(CL_INVALID_OPERATION);
+      break;
+    }
+  }
+
+  profilingEnd(vcmd);
+}
+
+void VirtualGPU::submitWriteMemoryInline(amd::WriteMemoryInlineCommand& vcmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(vcmd);
+
+  for (const auto& it : vcmd.writes()) {
+    pal::Memory* memory = dev().getGpuMemory(it.dst_);
+    amd::Coord3D origin(it.offset_);
+    amd::Coord3D size(it.size_);
+    bool entire = it.dst_->isEntirelyCovered(origin, size);
+    device::Memory::SyncFlags syncFlags;
+    syncFlags.skipEntire_ = entire;
+    memory->syncCacheFromHost(*this, syncFlags);
+    if (!blitMgr().writeBuffer(vcmd.payload().data() + it.data_, *memory, origin, size,
+                               entire)) {
+      LogError("submitWriteMemoryInline failed!");
+      vcmd.setStatus(CL_OUT_OF_RESOURCES);
+      break;
+    }
+    it.dst_->signalWrite(&gpuDevice_);
+  }
+
+  profilingEnd(vcmd);
+}
+
 void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& vcmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
@@ -2864,22 +2880,26 @@ void VirtualGPU::submitAccumulate(amd::AccumulateCommand& vcmd) {
 
 // ================================================================================================
 void VirtualGPU::submitExternalSemaphoreCmd(amd::ExternalSemaphoreCmd& cmd) {
-
-  const Pal::IQueueSemaphore* sem = reinterpret_cast<const Pal::IQueueSemaphore*>(cmd.sem_ptr());
-
   if (cmd.semaphoreCmd() ==
       amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE) {
+    // A single flush covers all semaphores of the command
     flushDMA(MainEngine);
-    if (Pal::Result::Success !=
-        queues_[MainEngine]->iQueue_->SignalQueueSemaphore(const_cast<Pal::IQueueSemaphore*>(sem),
-                                                           cmd.fence())) {
-      LogError("Failed to signal external semaphore");
+    for (const auto& it : cmd.semaphores()) {
+      const Pal::IQueueSemaphore* sem = reinterpret_cast<const Pal::IQueueSemaphore*>(it.sem_ptr_);
+      if (Pal::Result::Success !=
+          queues_[MainEngine]->iQueue_->SignalQueueSemaphore(
+              const_cast<Pal::IQueueSemaphore*>(sem), it.fence_)) {
+        LogError("Failed to signal external semaphore");
+      }
     }
   } else {
-    if (Pal::Result::Success !=
-        queues_[MainEngine]->iQueue_->WaitQueueSemaphore(const_cast<Pal::IQueueSemaphore*>(sem),
-                                                         cmd.fence())) {
-      LogError("Failed to wait on external semaphore");
+    for (const auto& it : cmd.semaphores()) {
+      const Pal::IQueueSemaphore* sem = reinterpret_cast<const Pal::IQueueSemaphore*>(it.sem_ptr_);
+      if (Pal::Result::Success !=
+          queues_[MainEngine]->iQueue_->WaitQueueSemaphore(
+              const_cast<Pal::IQueueSemaphore*>(sem), it.fence_)) {
+        LogError("Failed to wait on external semaphore");
+      }
     }
   }
 }
@@ -3360,6 +3380,17 @@ void VirtualGPU::waitEventLock(CommandBatch* cb) {
     // Make sure VirtualGPU has an exclusive access to the resources
     amd::ScopedLock lock(execution());
     earlyDone = waitAllEngines(cb);
+
+    if (cb->lastTS_ != nullptr) {
+      // The batch is done, hence read the timer values of all profiled commands at once
+      for (amd::Command* cmd = cb->head_; cmd != nullptr; cmd = cmd->getNext()) {
+        if (!cmd->data().empty()) {
+          reinterpret_cast<TimeStamp*>(cmd->data().back())->stage();
+        }
+      }
+      cb->lastTS_->stage();
+      tsCache_->readback();
+    }
   }
 
   // Free resource cache if we have too many entries
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <queue>
 #include "device/pal/paldefs.hpp"
 #include "device/pal/palconstbuf.hpp"
@@ -29,6 +30,7 @@
 #include "device/pal/palgpuopen.hpp"
 #include "platform/commandqueue.hpp"
 #include "device/blit.hpp"
+#include "device/devmemorytracker.hpp"
 #include "palUtil.h"
 #include "palCmdBuffer.h"
 #include "palCmdAllocator.h"
@@ -98,11 +100,16 @@ class VirtualGPU : public device::VirtualDevice {
                          uint max_command_buffers  //!< Number of allocated command buffers
     );
 
+    //! Returns the number of command buffers a queue can grow to
+    static uint CmdBufferCapacity(uint max_command_buffers) {
+      return std::max(max_command_buffers, PAL_MAX_COMMAND_BUFFERS_GROWTH);
+    }
+
     Queue(VirtualGPU& gpu, Pal::IDevice* iDev, uint64_t residency_limit, uint max_command_buffers)
         : lock_(nullptr),
           iQueue_(nullptr),
-          iCmdBuffs_(max_command_buffers, nullptr),
-          iCmdFences_(max_command_buffers, nullptr),
+          iCmdBuffs_(CmdBufferCapacity(max_command_buffers), nullptr),
+          iCmdFences_(CmdBufferCapacity(max_command_buffers), nullptr),
           last_kernel_(nullptr),
           gpu_(gpu),
           iDev_(iDev),
@@ -113,7 +120,9 @@ class VirtualGPU : public device::VirtualDevice {
           vlAlloc_(64 * Ki),
           residency_size_(0),
           residency_limit_(residency_limit),
-          max_command_buffers_(max_command_buffers) {
+          cmdBufIds_(CmdBufferCapacity(max_command_buffers), 0),
+          active_command_buffers_(max_command_buffers),
+          max_command_buffers_(CmdBufferCapacity(max_command_buffers)) {
       vlAlloc_.Init();
     }
 
@@ -214,7 +223,19 @@ class VirtualGPU : public device::VirtualDevice {
     std::vector<const Pal::IGpuMemory*> palSdiRefs_;
     uint64_t residency_size_;   //!< Resource residency size
     uint64_t residency_limit_;  //!< Enables residency limit
-    uint max_command_buffers_;
+    std::vector<uint> cmdBufIds_;  //!< Submission IDs in the command buffer slots
+    uint active_command_buffers_;  //!< Command buffers in the ring
+    uint max_command_buffers_;     //!< Allocated command buffers, the ring can grow to
+
+    //! Returns the slot of a submission or max_command_buffers_ if the slot was reused
+    uint findSlot(uint id) const {
+      for (uint i = 0; i < active_command_buffers_; ++i) {
+        if (cmdBufIds_[i] == id) {
+          return i;
+        }
+      }
+      return max_command_buffers_;
+    }
   };
 
   struct CommandBatch : public amd::HeapObject {
@@ -260,23 +281,20 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel() { ranges_.newKernel(); }
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
 
     //! Invalidates GPU caches if memory dependency tracking is disabled
     void sync(VirtualGPU& gpu) const {
-      if (maxMemObjectsInQueue_ == 0) {
+      if (ranges_.maxRanges() == 0) {
         // Ignore the barrier in any order mode. The app is responsible for synchronization.
         // HW will execute the kernels asynchronously
         if (!gpu.anyOrder()) {
@@ -290,16 +308,7 @@ class VirtualGPU : public device::VirtualDevice {
     void clear(bool all = true);
 
    private:
-    struct MemoryState {
-      uint64_t start_;  //! Busy memory start address
-      uint64_t end_;    //! Busy memory end address
-      bool readOnly_;   //! Current GPU state in the queue
-    };
-
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    amd::device::MemoryRangeTracker ranges_;  //!< The memory ranges of the kernels in the queue
   };
 
  public:
@@ -316,6 +325,8 @@ class VirtualGPU : public device::VirtualDevice {
   void submitWriteMemory(amd::WriteMemoryCommand& vcmd);
   void submitCopyMemory(amd::CopyMemoryCommand& vcmd);
   void submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& vcmd);
+  void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& vcmd);
+  void submitWriteMemoryInline(amd::WriteMemoryInlineCommand& vcmd);
   void submitMapMemory(amd::MapMemoryCommand& vcmd);
   void submitUnmapMemory(amd::UnmapMemoryCommand& vcmd);
   void submitKernel(amd::NDRangeKernelCommand& vcmd);
@@ -24,6 +24,7 @@
 #include "device/rocm/rocmemory.hpp"
 #include "device/rocm/rockernel.hpp"
 #include "device/rocm/rocsched.hpp"
+#include "platform/trace_events.hpp"
 #include "utils/debug.hpp"
 #include <algorithm>
 
@@ -33,7 +34,8 @@ DmaBlitManager::DmaBlitManager(VirtualGPU& gpu, Setup setup)
       MinSizeForPinnedTransfer(dev().settings().pinnedMinXferSize_),
       completeOperation_(false),
       context_(nullptr),
-      sdmaEngineRetainCount_(0) {
+      sdmaEngineRetainCount_(0),
+      lastCopy_() {
         dev().getSdmaRWMasks(&sdmaEngineReadMask_, &sdmaEngineWriteMask_);
       }
 
@@ -94,6 +96,11 @@ bool DmaBlitManager::readBufferRect(device::Memory& srcMemory, void* dstHost,
     return HostBlitManager::readBufferRect(srcMemory, dstHost, bufRect, hostRect, size, entire, copyMetadata);
   } else {
     const_address src = gpuMem(srcMemory).getDeviceMemory();
+    constexpr bool kHostToDev = false;
+    if (hsaCopyStagedRect(src, reinterpret_cast<address>(dstHost), bufRect, hostRect, size,
+                          kHostToDev)) {
+      return true;
+    }
 
     size_t srcOffset;
     size_t dstOffset;
@@ -181,6 +188,11 @@ bool DmaBlitManager::writeBufferRect(const void* srcHost, device::Memory& dstMem
                                             copyMetadata);
   } else {
     address dst = static_cast<roc::Memory&>(dstMemory).getDeviceMemory();
+    constexpr bool kHostToDev = true;
+    if (hsaCopyStagedRect(reinterpret_cast<const_address>(srcHost), dst, hostRect, bufRect, size,
+                          kHostToDev)) {
+      return true;
+    }
 
     size_t srcOffset;
     size_t dstOffset;
@@ -192,7 +204,6 @@ bool DmaBlitManager::writeBufferRect(const void* srcHost, device::Memory& dstMem
 
         // Copy data from host to device - line by line
         const_address src = reinterpret_cast<const_address>(srcHost) + srcOffset;
-        constexpr bool kHostToDev = true;
         bool retval = hsaCopyStaged(src, dst + dstOffset, size[0], kHostToDev, copyMetadata);
         if (!retval) {
           return retval;
@@ -270,7 +281,6 @@ bool DmaBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory& d
     bool isSubwindowRectCopy = true;
     hsa_amd_copy_direction_t direction = hsaHostToHost;
 
-    hsa_agent_t agent = dev().getBackendDevice();
     //Determine copy direction
     if (srcMemory.isHostMemDirectAccess() && !dstMemory.isHostMemDirectAccess()) {
       direction = hsaHostToDevice;
@@ -291,8 +301,6 @@ bool DmaBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory& d
     hsa_dim3_t dim = { static_cast<uint32_t>(size[0]),
                       static_cast<uint32_t>(size[1]),
                       static_cast<uint32_t>(size[2]) };
-    hsa_dim3_t offset = { 0, 0 ,0 };
-
 
     if ((srcRect.rowPitch_ % 4 != 0)    ||
         (srcRect.slicePitch_ % 4 != 0)  ||
@@ -301,35 +309,22 @@ bool DmaBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory& d
       isSubwindowRectCopy = false;
     }
 
-    HwQueueEngine engine = HwQueueEngine::Unknown;
-    if ((srcAgent.handle == dev().getCpuAgent().handle) &&
-        (dstAgent.handle != dev().getCpuAgent().handle)) {
-      engine = HwQueueEngine::SdmaWrite;
-    } else if ((srcAgent.handle != dev().getCpuAgent().handle) &&
-              (dstAgent.handle == dev().getCpuAgent().handle)) {
-      engine = HwQueueEngine::SdmaRead;
-    }
-
-    auto wait_events = gpu().Barriers().WaitingSignal(engine);
-
-    if (isSubwindowRectCopy ) {
-      hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
-
-      // Copy memory line by line
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
-              "HSA Async Copy Rect dst=0x%zx, src=0x%zx, wait_event=0x%zx "
-              "completion_signal=0x%zx", dstMem.base, srcMem.base,
-              (wait_events.size() != 0) ? wait_events[0].handle : 0, active.handle);
-
-      hsa_status_t status = hsa_amd_memory_async_copy_rect(&dstMem, &offset,
-          &srcMem, &offset, &dim, agent, direction, wait_events.size(), wait_events.data(),
-          active);
-      if (status != HSA_STATUS_SUCCESS) {
-        gpu().Barriers().ResetCurrentSignal();
-        LogPrintfError("DMA buffer failed with code %d", status);
+    if (isSubwindowRectCopy) {
+      if (!rocrCopyRect(dstMem, srcMem, dim, direction)) {
         return false;
       }
     } else {
+      HwQueueEngine engine = HwQueueEngine::Unknown;
+      if ((srcAgent.handle == dev().getCpuAgent().handle) &&
+          (dstAgent.handle != dev().getCpuAgent().handle)) {
+        engine = HwQueueEngine::SdmaWrite;
+      } else if ((srcAgent.handle != dev().getCpuAgent().handle) &&
+                (dstAgent.handle == dev().getCpuAgent().handle)) {
+        engine = HwQueueEngine::SdmaRead;
+      }
+
+      auto wait_events = gpu().Barriers().WaitingSignal(engine);
+
       // Fall to line by line copies
       const hsa_signal_value_t kInitVal = size[2] * size[1];
       hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitVal, gpu().timestamp());
@@ -439,8 +434,8 @@ bool DmaBlitManager::copyBufferToImage(device::Memory& srcMemory, device::Memory
                                                dstImage.getHsaImageObject(), &image_region);
     result = (status == HSA_STATUS_SUCCESS) ? true : false;
 
-    // hsa_ext_image_import need a system scope fence
-    gpu().addSystemScope();
+    // hsa_ext_image_import writes the image around L2, the next packet needs the invalidation
+    gpu().addSystemScope(VirtualGPU::kSystemAcquire);
 
     // Check if a HostBlit tran sfer is required
     if (completeOperation_ && !result) {
@@ -516,6 +511,11 @@ inline bool DmaBlitManager::rocrCopyBuffer(address dst, hsa_agent_t& dstAgent,
     copyMask = kUseRegularCopyApi ? 0 : dev().fetchSDMAMask(this, true);
   }
 
+  if (coalesceCopy(dst, dstAgent, src, srcAgent, size, engine)) {
+    return true;
+  }
+  lastCopy_.signal_.handle = 0;
+
   // Check if host wait has to be forced
   bool forceHostWait = forceHostWaitFunc(size);
 
@@ -559,6 +559,9 @@ inline bool DmaBlitManager::rocrCopyBuffer(address dst, hsa_agent_t& dstAgent,
                                                   size, wait_events.size(),
                                                   wait_events.data(), active, copyEngine,
                                                   forceSDMA);
+      if (status == HSA_STATUS_SUCCESS) {
+        lastCopy_ = {active, dstAgent.handle, srcAgent.handle, copyMask, 1, engine};
+      }
     } else {
       kUseRegularCopyApi = true;
     }
@@ -576,7 +579,8 @@ inline bool DmaBlitManager::rocrCopyBuffer(address dst, hsa_agent_t& dstAgent,
   }
 
   if (status == HSA_STATUS_SUCCESS) {
-    gpu().addSystemScope();
+    // SDMA writes the memory around L2, hence the next packet needs only the invalidation
+    gpu().addSystemScope(VirtualGPU::kSystemAcquire);
   } else {
     gpu().Barriers().ResetCurrentSignal();
     LogPrintfError("HSA copy failed with code %d, falling to Blit copy", status);
@@ -586,6 +590,46 @@ inline bool DmaBlitManager::rocrCopyBuffer(address dst, hsa_agent_t& dstAgent,
 }
 
 
+// ================================================================================================
+bool DmaBlitManager::coalesceCopy(address dst, hsa_agent_t& dstAgent, const_address src,
+                                  hsa_agent_t& srcAgent, size_t size,
+                                  HwQueueEngine engine) const {
+  // Limits the copies on a signal, so the host waits for the older copies don't get too late
+  constexpr uint32_t kMaxCoalescedCopies = 64;
+  if ((ROC_SDMA_COALESCE_SIZE == 0) || (size > ROC_SDMA_COALESCE_SIZE * Ki) ||
+      (lastCopy_.signal_.handle == 0) || (lastCopy_.count_ >= kMaxCoalescedCopies) ||
+      (lastCopy_.engine_ != engine) || (lastCopy_.dstAgent_ != dstAgent.handle) ||
+      (lastCopy_.srcAgent_ != srcAgent.handle) || (gpu().timestamp() != nullptr)) {
+    return false;
+  }
+  // Any other operation, a dependency on another queue or a marker on the signal since the
+  // previous copy needs the regular path
+  const ProfilingSignal* last = gpu().Barriers().GetLastSignal();
+  if ((last->signal_.handle != lastCopy_.signal_.handle) || (last->referenceCount() > 1) ||
+      !gpu().Barriers().IsExternalSignalListEmpty() ||
+      (hsa_signal_load_relaxed(lastCopy_.signal_) <= 0)) {
+    return false;
+  }
+
+  hsa_signal_add_relaxed(lastCopy_.signal_, 1);
+  hsa_amd_sdma_engine_id_t copyEngine = static_cast<hsa_amd_sdma_engine_id_t>(lastCopy_.copyMask_);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy coalesced on copy_engine=0x%x, "
+          "dst=0x%zx, src=0x%zx, size=%ld, completion_signal=0x%zx", copyEngine, dst, src, size,
+          lastCopy_.signal_.handle);
+  constexpr bool kForceSDMA = true;
+  hsa_status_t status = hsa_amd_memory_async_copy_on_engine(dst, dstAgent, src, srcAgent, size,
+                                                            0, nullptr, lastCopy_.signal_,
+                                                            copyEngine, kForceSDMA);
+  if (status != HSA_STATUS_SUCCESS) {
+    hsa_signal_subtract_relaxed(lastCopy_.signal_, 1);
+    lastCopy_.signal_.handle = 0;
+    return false;
+  }
+  ++lastCopy_.count_;
+  gpu().addSystemScope(VirtualGPU::kSystemAcquire);
+  return true;
+}
+
 // ================================================================================================
 bool DmaBlitManager::hsaCopy(const Memory& srcMemory, const Memory& dstMemory,
                              const amd::Coord3D& srcOrigin, const amd::Coord3D& dstOrigin,
@@ -613,79 +657,306 @@ bool DmaBlitManager::hsaCopy(const Memory& srcMemory, const Memory& dstMemory,
     dstAgent = dstMemory.dev().getBackendDevice();
   }
 
+  if ((ROC_SDMA_STRIPE_SIZE != 0) && (size[0] >= (ROC_SDMA_STRIPE_SIZE * Mi)) &&
+      (copyMetadata.copyEnginePreference_ != amd::CopyMetadata::CopyEnginePreference::BLIT)) {
+    uint32_t maxEngines = ROC_SDMA_STRIPE_ENGINES;
+    if (&srcMemory.dev() != &dstMemory.dev()) {
+      std::vector<amd::Device::LinkAttrType> link_attrs;
+      link_attrs.push_back(std::make_pair(amd::Device::LinkAttribute::kLinkLinkType, 0));
+      auto& other = (&srcMemory.dev() == &dev()) ? dstMemory.dev() : srcMemory.dev();
+      if (const_cast<Device&>(dev()).findLinkInfo(other, &link_attrs) &&
+          (link_attrs[0].second == HSA_AMD_LINK_INFO_TYPE_XGMI)) {
+        maxEngines = ROC_SDMA_STRIPE_ENGINES_XGMI;
+      }
+    }
+    uint32_t engineMask = stripeEngineMask(dstAgent, srcAgent, maxEngines);
+    if (amd::countBitsSet(engineMask) > 1) {
+      return rocrCopyBufferStriped(dst, dstAgent, src, srcAgent, size[0], engineMask);
+    }
+  }
+
   return rocrCopyBuffer(dst, dstAgent, src, srcAgent, size[0], copyMetadata);
 }
 
+// ================================================================================================
+uint32_t DmaBlitManager::stripeEngineMask(hsa_agent_t& dstAgent, hsa_agent_t& srcAgent,
+                                          uint32_t maxEngines) const {
+  uint32_t freeEngineMask = 0;
+  if (HSA_STATUS_SUCCESS !=
+      hsa_amd_memory_copy_engine_status(dstAgent, srcAgent, &freeEngineMask)) {
+    return 0;
+  }
+  // Respect the read/write engine split for the host copies
+  if ((srcAgent.handle == dev().getCpuAgent().handle) && (sdmaEngineWriteMask_ != 0)) {
+    freeEngineMask &= sdmaEngineWriteMask_;
+  } else if ((dstAgent.handle == dev().getCpuAgent().handle) && (sdmaEngineReadMask_ != 0)) {
+    freeEngineMask &= sdmaEngineReadMask_;
+  }
+  // Keep the lowest engines up to the limit
+  uint32_t engineMask = 0;
+  for (uint32_t i = 0; (i < maxEngines) && (freeEngineMask != 0); ++i) {
+    uint32_t engine = freeEngineMask & (~freeEngineMask + 1);
+    engineMask |= engine;
+    freeEngineMask &= ~engine;
+  }
+  return engineMask;
+}
+
+// ================================================================================================
+bool DmaBlitManager::rocrCopyBufferStriped(address dst, hsa_agent_t& dstAgent,
+                                           const_address src, hsa_agent_t& srcAgent, size_t size,
+                                           uint32_t engineMask) const {
+  HwQueueEngine engine = HwQueueEngine::SdmaRead;
+  if ((srcAgent.handle == dev().getCpuAgent().handle) &&
+      (dstAgent.handle != dev().getCpuAgent().handle)) {
+    engine = HwQueueEngine::SdmaWrite;
+  }
+  const uint32_t numStripes = amd::countBitsSet(engineMask);
+  // Keep the stripes page aligned, the last one takes the remainder
+  const size_t stripeSize = amd::alignUp(size / numStripes, 4 * Ki);
+
+  constexpr bool kIgnoreHostWait = false;
+  auto wait_events = gpu().Barriers().WaitingSignal(engine, kIgnoreHostWait);
+  // Every stripe decrements the same completion signal
+  const hsa_signal_value_t kInitVal = numStripes;
+  hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitVal, gpu().timestamp());
+
+  size_t offset = 0;
+  uint32_t issued = 0;
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  for (; (issued < numStripes) && (offset < size); ++issued) {
+    uint32_t copyMask = engineMask & (~engineMask + 1);
+    engineMask &= ~copyMask;
+    size_t copySize = (issued == (numStripes - 1)) ? (size - offset)
+                                                   : std::min(stripeSize, size - offset);
+    hsa_amd_sdma_engine_id_t copyEngine = static_cast<hsa_amd_sdma_engine_id_t>(copyMask);
+    ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
+            "HSA Async Copy stripe on copy_engine=0x%x, dst=0x%zx, src=0x%zx, size=%ld, "
+            "completion_signal=0x%zx", copyEngine, dst + offset, src + offset, copySize,
+            active.handle);
+    constexpr bool kForceSDMA = true;
+    status = hsa_amd_memory_async_copy_on_engine(dst + offset, dstAgent, src + offset, srcAgent,
+                                                copySize, wait_events.size(),
+                                                wait_events.data(), active, copyEngine,
+                                                kForceSDMA);
+    if (status != HSA_STATUS_SUCCESS) {
+      break;
+    }
+    offset += copySize;
+  }
+
+  if (issued < numStripes) {
+    // Make sure the signal retires with the stripes, which were actually submitted
+    hsa_signal_subtract_relaxed(active, numStripes - issued);
+  }
+  if (status != HSA_STATUS_SUCCESS) {
+    LogPrintfError("HSA striped copy failed with code %d, falling to Blit copy", status);
+    if (issued == 0) {
+      gpu().Barriers().ResetCurrentSignal();
+    }
+    return false;
+  }
+  gpu().addSystemScope(VirtualGPU::kSystemAcquire);
+  return true;
+}
+
+// ================================================================================================
+bool DmaBlitManager::rocrCopyRect(const hsa_pitched_ptr_t& dst, const hsa_pitched_ptr_t& src,
+                                  const hsa_dim3_t& size,
+                                  hsa_amd_copy_direction_t direction) const {
+  HwQueueEngine engine = HwQueueEngine::Unknown;
+  if (direction == hsaHostToDevice) {
+    engine = HwQueueEngine::SdmaWrite;
+  } else if (direction == hsaDeviceToHost) {
+    engine = HwQueueEngine::SdmaRead;
+  }
+
+  auto wait_events = gpu().Barriers().WaitingSignal(engine);
+  hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
+
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
+          "HSA Async Copy Rect dst=0x%zx, src=0x%zx, wait_event=0x%zx "
+          "completion_signal=0x%zx", dst.base, src.base,
+          (wait_events.size() != 0) ? wait_events[0].handle : 0, active.handle);
+
+  const hsa_dim3_t offset = { 0, 0, 0 };
+  hsa_status_t status = hsa_amd_memory_async_copy_rect(&dst, &offset, &src, &offset, &size,
+      dev().getBackendDevice(), direction, wait_events.size(), wait_events.data(), active);
+  if (status != HSA_STATUS_SUCCESS) {
+    gpu().Barriers().ResetCurrentSignal();
+    LogPrintfError("DMA buffer failed with code %d", status);
+    return false;
+  }
+  return true;
+}
+
 // ================================================================================================
 bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_t size,
                                    bool hostToDev, amd::CopyMetadata& copyMetadata)  const {
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Copy, "hsaCopyStaged");
   // Stall GPU, sicne CPU copy is possible
   gpu().releaseGpuMemoryFence(hostToDev);
 
+  if (!hostToDev) {
+    return hsaCopyStagedRead(hostSrc, hostDst, size, copyMetadata);
+  }
+
   size_t totalSize = size;
   size_t stagedCopyOffset = 0;
   bool status = true;
-  Memory* xferBuf = nullptr;
-  address stagingBuffer = 0;
   size_t maxStagedXferSize = dev().settings().stagedXferSize_;
+  hsa_agent_t srcAgent = dev().getCpuAgent();
+  hsa_agent_t dstAgent = dev().getBackendDevice();
 
-  if (!hostToDev) {
-    // Get static staging buffer as we need to wait until copy on GPU completes to copy
-    // it back to the unpinned buffer
-    xferBuf = &dev().xferRead().acquire();
-    stagingBuffer = xferBuf->getDeviceMemory();
-  }
-
-  // Allocate requested size of memory
+  // @note H2D chunks are already pipelined, since the managed staging buffer is a ring of
+  // chunks and Acquire() waits only for the chunk, which is about to be recycled
   while (totalSize > 0) {
     size = std::min(totalSize, maxStagedXferSize);
 
-    hsa_agent_t srcAgent;
-    hsa_agent_t dstAgent;
-
-    // Copy data from Host to Device
-    if (hostToDev) {
-      hsa_agent_t srcAgent = dev().getCpuAgent();
-      hsa_agent_t dstAgent = dev().getBackendDevice();
+    // Get an address from managed staging buffer
+    address stagingBuffer = gpu().Staging().Acquire(size);
 
-      // Get an address from managed staging buffer
-      stagingBuffer = gpu().Staging().Acquire(std::min(size, maxStagedXferSize));
-
-      address dst = hostDst + stagedCopyOffset;
-      memcpy(stagingBuffer, hostSrc + stagedCopyOffset, size);
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged H2D");
-      status = rocrCopyBuffer(dst, dstAgent, stagingBuffer, srcAgent, size, copyMetadata);
-      if (!status) {
-        break;
-      }
-    } else {
-      dstAgent = dev().getCpuAgent();
-      srcAgent = dev().getBackendDevice();
-
-      const_address src = static_cast<const_address>(hostSrc) + stagedCopyOffset;
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged D2H");
-      status = rocrCopyBuffer(stagingBuffer, dstAgent, src, srcAgent, size, copyMetadata);
-      if (status) {
-        gpu().Barriers().WaitCurrent();
-        memcpy(hostDst + stagedCopyOffset, stagingBuffer, size);
-      } else {
-        break;
-      }
+    address dst = hostDst + stagedCopyOffset;
+    memcpy(stagingBuffer, hostSrc + stagedCopyOffset, size);
+    ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged H2D");
+    status = rocrCopyBuffer(dst, dstAgent, stagingBuffer, srcAgent, size, copyMetadata);
+    if (!status) {
+      break;
     }
 
     totalSize -= size;
     stagedCopyOffset += size;
   }
 
-  if (!hostToDev) {
+  if (!status) {
+    return false;
+  }
+
+  gpu().addSystemScope(VirtualGPU::kSystemAcquire);
+
+  return true;
+}
+
+// ================================================================================================
+bool DmaBlitManager::hsaCopyStagedRead(const_address devSrc, address hostDst, size_t size,
+                                       amd::CopyMetadata& copyMetadata) const {
+  constexpr uint32_t kNumSlots = 2;
+  size_t maxStagedXferSize = dev().settings().stagedXferSize_;
+  hsa_agent_t dstAgent = dev().getCpuAgent();
+  hsa_agent_t srcAgent = dev().getBackendDevice();
+
+  // Get static staging buffers as runtime has to wait until copy on GPU completes to copy
+  // it back to the unpinned buffer. A second slot lets SDMA fill the next chunk,
+  // while CPU copies the current one
+  uint32_t numSlots = (size > maxStagedXferSize) ? kNumSlots : 1;
+  Memory* xferBuf[kNumSlots] = {};
+  ProfilingSignal* signal[kNumSlots] = {};
+  for (uint32_t i = 0; i < numSlots; ++i) {
+    xferBuf[i] = &dev().xferRead().acquire();
+  }
+
+  size_t numChunks = amd::alignUp(size, maxStagedXferSize) / maxStagedXferSize;
+  auto chunkSize = [&](size_t chunk) {
+    return std::min(size - chunk * maxStagedXferSize, maxStagedXferSize);
+  };
+  // Submits a DMA copy of the chunk into its staging slot
+  auto submit = [&](size_t chunk) {
+    uint32_t slot = chunk % numSlots;
+    const_address src = devSrc + chunk * maxStagedXferSize;
+    ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged D2H");
+    bool result = rocrCopyBuffer(xferBuf[slot]->getDeviceMemory(), dstAgent, src, srcAgent,
+                                 chunkSize(chunk), copyMetadata);
+    signal[slot] = gpu().Barriers().GetLastSignal();
+    return result;
+  };
+
+  bool status = submit(0);
+  for (size_t chunk = 0; status && (chunk < numChunks); ++chunk) {
+    uint32_t slot = chunk % numSlots;
+    if ((numSlots > 1) && ((chunk + 1) < numChunks)) {
+      // The other slot was drained by CPU on the previous iteration
+      status = submit(chunk + 1);
+    }
+    gpu().Barriers().WaitSignal(signal[slot]);
+    memcpy(hostDst + chunk * maxStagedXferSize, xferBuf[slot]->getDeviceMemory(),
+           chunkSize(chunk));
+    if (status && (numSlots == 1) && ((chunk + 1) < numChunks)) {
+      status = submit(chunk + 1);
+    }
+  }
+
+  for (uint32_t i = 0; i < numSlots; ++i) {
+    dev().xferRead().release(gpu(), *xferBuf[i]);
+  }
+
+  if (!status) {
+    return false;
+  }
+
+  gpu().addSystemScope(VirtualGPU::kSystemAcquire);
+
+  return true;
+}
+
+// ================================================================================================
+bool DmaBlitManager::hsaCopyStagedRect(const_address src, address dst,
+                                       const amd::BufferRect& srcRect,
+                                       const amd::BufferRect& dstRect, const amd::Coord3D& size,
+                                       bool hostToDev) const {
+  const amd::BufferRect& devRect = hostToDev ? dstRect : srcRect;
+  const size_t maxStagedXferSize = dev().settings().stagedXferSize_;
+  // The staging rows keep the dword pitch alignment of the SDMA rect copies
+  const size_t stagedPitch = amd::alignUp(size[0], sizeof(uint32_t));
+  if (((size[1] * size[2]) == 1) || (stagedPitch > maxStagedXferSize) ||
+      ((devRect.rowPitch_ % sizeof(uint32_t)) != 0) ||
+      ((devRect.slicePitch_ % sizeof(uint32_t)) != 0)) {
+    return false;
+  }
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Copy, "hsaCopyStagedRect");
+  const size_t rowsPerChunk = maxStagedXferSize / stagedPitch;
+
+  Memory* xferBuf = hostToDev ? nullptr : &dev().xferRead().acquire();
+  bool status = true;
+  for (size_t z = 0; status && (z < size[2]); ++z) {
+    for (size_t y = 0; status && (y < size[1]); y += rowsPerChunk) {
+      const size_t rows = std::min(rowsPerChunk, size[1] - y);
+      const hsa_dim3_t dim = { static_cast<uint32_t>(size[0]), static_cast<uint32_t>(rows), 1 };
+      if (hostToDev) {
+        // Get an address from managed staging buffer
+        address staging = gpu().Staging().Acquire(rows * stagedPitch);
+        for (size_t row = 0; row < rows; ++row) {
+          memcpy(staging + row * stagedPitch, src + srcRect.offset(0, y + row, z), size[0]);
+        }
+        const hsa_pitched_ptr_t srcMem = { staging, stagedPitch, rows * stagedPitch };
+        const hsa_pitched_ptr_t dstMem = { dst + dstRect.offset(0, y, z), dstRect.rowPitch_,
+                                           dstRect.slicePitch_ };
+        status = rocrCopyRect(dstMem, srcMem, dim, hsaHostToDevice);
+      } else {
+        address staging = xferBuf->getDeviceMemory();
+        const hsa_pitched_ptr_t srcMem = { const_cast<address>(src) + srcRect.offset(0, y, z),
+                                           srcRect.rowPitch_, srcRect.slicePitch_ };
+        const hsa_pitched_ptr_t dstMem = { staging, stagedPitch, rows * stagedPitch };
+        status = rocrCopyRect(dstMem, srcMem, dim, hsaDeviceToHost);
+        if (status) {
+          // CPU copies the rows out, hence wait for the chunk
+          gpu().Barriers().WaitSignal(gpu().Barriers().GetLastSignal());
+          for (size_t row = 0; row < rows; ++row) {
+            memcpy(dst + dstRect.offset(0, y + row, z), staging + row * stagedPitch, size[0]);
+          }
+        }
+      }
+    }
+  }
+  if (xferBuf != nullptr) {
     dev().xferRead().release(gpu(), *xferBuf);
   }
 
   if (!status) {
+    // The row copies redo the whole rectangle, which is safe, since the source doesn't change
     return false;
   }
 
-  gpu().addSystemScope();
+  gpu().addSystemScope(VirtualGPU::kSystemAcquire);
 
   return true;
 }
@@ -1213,6 +1484,58 @@ bool KernelBlitManager::copyImageToBufferKernel(device::Memory& srcMemory,
   return result;
 }
 
+// ================================================================================================
+//! Returns true if the image region is in a linear layout, which the buffer kernels can access
+static bool IsLinearImage(const Image& image, const amd::Coord3D& size) {
+  // The pitch workaround keeps the data in a separate image
+  return (image.LinearRowPitch() != 0) && (image.CopyImageBuffer() == nullptr) && (size[2] == 1);
+}
+
+// ================================================================================================
+bool KernelBlitManager::copyImageRaw(device::Memory& srcMemory, device::Memory& dstMemory,
+                                     const amd::Coord3D& srcOrigin, const amd::Coord3D& dstOrigin,
+                                     const amd::Coord3D& size, bool entire,
+                                     amd::CopyMetadata copyMetadata) const {
+  if (!ROC_BLIT_IMAGE_RAW || (&gpuMem(srcMemory).dev() != &gpuMem(dstMemory).dev())) {
+    return false;
+  }
+  const Image& srcImage = static_cast<const Image&>(gpuMem(srcMemory));
+  const Image& dstImage = static_cast<const Image&>(gpuMem(dstMemory));
+  const amd::Image& srcOwner = *srcMemory.owner()->asImage();
+  const amd::Image& dstOwner = *dstMemory.owner()->asImage();
+  const size_t elementSize = srcOwner.getImageFormat().getElementSize();
+
+  size_t srcOffset = 0;
+  size_t dstOffset = 0;
+  size_t copySize = 0;
+  if (entire && srcImage.IsSameLayout(dstImage)) {
+    // The whole image keeps the tiled layout, hence the bytes move as they are
+    copySize = srcImage.DeviceImageSize();
+  } else if ((elementSize == dstOwner.getImageFormat().getElementSize()) &&
+             IsLinearImage(srcImage, size) && IsLinearImage(dstImage, size)) {
+    // The rows must be contiguous in both images, the pitch padding belongs to the buffer
+    auto contiguous = [&](const Image& image, const amd::Image& owner) {
+      return (size[1] == 1) || ((size[0] == owner.getWidth()) &&
+                                (image.LinearRowPitch() == owner.getWidth() * elementSize));
+    };
+    if (!contiguous(srcImage, srcOwner) || !contiguous(dstImage, dstOwner)) {
+      return false;
+    }
+    srcOffset = srcOrigin[1] * srcImage.LinearRowPitch() + srcOrigin[0] * elementSize;
+    dstOffset = dstOrigin[1] * dstImage.LinearRowPitch() + dstOrigin[0] * elementSize;
+    copySize = size[0] * size[1] * elementSize;
+  } else {
+    return false;
+  }
+
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Raw image copy of %zu bytes", copySize);
+  return shaderCopyBuffer(reinterpret_cast<address>(dstImage.virtualAddress()),
+                          reinterpret_cast<address>(srcImage.virtualAddress()),
+                          amd::Coord3D(dstOffset), amd::Coord3D(srcOffset),
+                          amd::Coord3D(copySize), entire, dev().settings().limit_blit_wg_,
+                          copyMetadata);
+}
+
 // ================================================================================================
 bool KernelBlitManager::copyImage(device::Memory& srcMemory, device::Memory& dstMemory,
                                   const amd::Coord3D& srcOrigin, const amd::Coord3D& dstOrigin,
@@ -1222,6 +1545,12 @@ bool KernelBlitManager::copyImage(device::Memory& srcMemory, device::Memory& dst
   guarantee((dev().info().imageSupport_ != false), "Image not supported on this device");
 
   amd::ScopedLock k(lockXferOps_);
+  // Skip the texel path if the raw data can move with the buffer copy
+  if (copyImageRaw(srcMemory, dstMemory, srcOrigin, dstOrigin, size, entire, copyMetadata)) {
+    synchronize();
+    return true;
+  }
+
   bool result = false;
   Memory* srcView = &gpuMem(srcMemory);
   Memory* dstView = &gpuMem(dstMemory);
@@ -1636,6 +1965,38 @@ bool KernelBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory
   return result;
 }
 
+// ================================================================================================
+bool KernelBlitManager::XferTuner::useBlit(size_t size, bool blit) const {
+  if (size == 0) {
+    return blit;
+  }
+  const SizeClass& sizeClass = classes_[amd::log2(size)];
+  if ((sizeClass.samples_[0] < kSamples) || (sizeClass.samples_[1] < kSamples)) {
+    // Measure the path with less samples, start with the static choice
+    return (sizeClass.samples_[0] == sizeClass.samples_[1])
+        ? blit : (sizeClass.samples_[1] < sizeClass.samples_[0]);
+  }
+  return sizeClass.bandwidth_[1] > sizeClass.bandwidth_[0];
+}
+
+// ================================================================================================
+void KernelBlitManager::XferTuner::record(size_t size, bool blit, uint64_t nanos) {
+  if (size == 0) {
+    return;
+  }
+  const uint32_t idx = amd::log2(size);
+  SizeClass& sizeClass = classes_[idx];
+  // The best result filters out the transfers delayed by the other work
+  const double bandwidth = static_cast<double>(size) / std::max<uint64_t>(nanos, 1);
+  sizeClass.bandwidth_[blit] = std::max(sizeClass.bandwidth_[blit], bandwidth);
+  if ((++sizeClass.samples_[blit] == kSamples) && (sizeClass.samples_[!blit] >= kSamples)) {
+    ClPrint(amd::LOG_INFO, amd::LOG_COPY, "Staged reads of %zu to %zu bytes use %s, "
+            "SDMA %.2f GB/s, blit %.2f GB/s", size_t(1) << idx, (size_t(2) << idx) - 1,
+            (sizeClass.bandwidth_[1] > sizeClass.bandwidth_[0]) ? "blit" : "SDMA",
+            sizeClass.bandwidth_[0], sizeClass.bandwidth_[1]);
+  }
+}
+
 // ================================================================================================
 bool KernelBlitManager::readBuffer(device::Memory& srcMemory, void* dstHost,
                                    const amd::Coord3D& origin, const amd::Coord3D& size,
@@ -1685,11 +2046,21 @@ bool KernelBlitManager::readBuffer(device::Memory& srcMemory, void* dstHost,
                                (totalSize <= dev().settings().sdmaCopyThreshold_)   ||
                                (copyMetadata.copyEnginePreference_ ==
                                 amd::CopyMetadata::CopyEnginePreference::BLIT);
+      // Only the runtime choices are tuned, not the disabled engine or the requested one
+      const bool tune = ROC_XFER_AUTOTUNE && !setup_.disableHwlCopyBuffer_ &&
+          (copyMetadata.copyEnginePreference_ == amd::CopyMetadata::CopyEnginePreference::NONE);
+      if (tune) {
+        useShaderCopyPath = readTuner_.useBlit(totalSize, useShaderCopyPath);
+      }
+      const uint64_t start = tune ? amd::Os::timeNanos() : 0;
 
       if (!useShaderCopyPath) {
         // HSA copy using a staging resource
         result = DmaBlitManager::readBuffer(srcMemory, dstHost, origin, size,
                                             entire, copyMetadata);
+        if (result && tune) {
+          readTuner_.record(size[0], false, amd::Os::timeNanos() - start);
+        }
       }
       if (!result) {
         // Blit copy using a staging resource
@@ -1728,6 +2099,10 @@ bool KernelBlitManager::readBuffer(device::Memory& srcMemory, void* dstHost,
         }
 
         dev().xferRead().release(gpu(), xferBuf);
+        // The fallback after a failed SDMA copy doesn't measure the blit path
+        if (result && tune && useShaderCopyPath) {
+          readTuner_.record(size[0], true, amd::Os::timeNanos() - start);
+        }
       }
     }
   }
@@ -2022,7 +2397,13 @@ bool KernelBlitManager::fillBuffer1D(device::Memory& memory, const void* pattern
       // Adjust the pattern size in the copy type size
       kpattern_size /= alignment;
       setArgument(kernels_[kFillType], 2, sizeof(uint32_t), &kpattern_size);
-      setArgument(kernels_[kFillType], 3, sizeof(alignment), &alignment);
+      // Stream large fills past the caches
+      uint32_t kalignment = alignment;
+      if ((alignment == 2 * sizeof(uint64_t)) &&
+          (packed_obj.fill_size_ >= dev().settings().blit_nt_threshold_)) {
+        kalignment |= kBlitNonTemporal;
+      }
+      setArgument(kernels_[kFillType], 3, sizeof(kalignment), &kalignment);
 
       // Calculate max id
       kfill_size = memory.virtualAddress() + koffset + kfill_size * kpattern_size * alignment;
@@ -2161,6 +2542,8 @@ bool KernelBlitManager::shaderCopyBuffer(address dst, address src,
   // Check alignments for source and destination
   bool aligned = ((srcOrigin[0] % kMaxAlignment) == 0) && ((dstOrigin[0] % kMaxAlignment) == 0);
   uint32_t aligned_size = (aligned) ? kMaxAlignment : sizeof(uint32_t);
+  // Stream large transfers past the caches
+  const bool non_temporal = aligned && (sizeIn[0] >= dev().settings().blit_nt_threshold_);
 
   // Setup copy size accordingly to the alignment
   uint32_t remainder = size[0] % aligned_size;
@@ -2185,7 +2568,8 @@ bool KernelBlitManager::shaderCopyBuffer(address dst, address src,
   setArgument(kernels_[kBlitType], 2, sizeof(copySize), &copySize);
 
   setArgument(kernels_[kBlitType], 3, sizeof(remainder), &remainder);
-  setArgument(kernels_[kBlitType], 4, sizeof(aligned_size), &aligned_size);
+  uint32_t kaligned_size = aligned_size | (non_temporal ? kBlitNonTemporal : 0);
+  setArgument(kernels_[kBlitType], 4, sizeof(kaligned_size), &kaligned_size);
 
   // End pointer is the aligned copy size and destination offset
   uint64_t end_ptr = reinterpret_cast<uint64_t>(dst) + dstOrigin[0] + sizeIn[0] - remainder;
@@ -2264,6 +2648,132 @@ bool KernelBlitManager::copyBuffer(device::Memory& srcMemory, device::Memory& ds
   return result;
 }
 
+// ================================================================================================
+bool KernelBlitManager::copyBufferBatch(const std::vector<CopyRegion>& regions) const {
+  const uint64_t maxSize = static_cast<uint64_t>(ROC_BLIT_BATCH_MAX_SIZE) * Ki;
+  for (const auto& it : regions) {
+    if (it.size_ > maxSize) {
+      return false;
+    }
+  }
+  return submitCopyBatch(regions, nullptr, 0);
+}
+
+// ================================================================================================
+bool KernelBlitManager::writeBufferInline(const std::vector<CopyRegion>& regions,
+                                          const void* payload, size_t payloadSize) const {
+  if (payload == nullptr) {
+    return false;
+  }
+  return submitCopyBatch(regions, payload, payloadSize);
+}
+
+// ================================================================================================
+bool KernelBlitManager::submitCopyBatch(const std::vector<CopyRegion>& regions,
+                                        const void* payload, size_t payloadSize) const {
+  constexpr uint32_t kBlitType = BlitCopyBufferBatch;
+  // The regions are small, hence a workgroup per region up to the limit and reuse after it
+  constexpr size_t kMaxGroups = 256;
+  if ((kernels_[kBlitType] == nullptr) || regions.empty()) {
+    return false;
+  }
+
+  amd::ScopedLock k(lockXferOps_);
+  const size_t localWorkSize = 256;
+  size_t globalWorkSize = std::min(regions.size(), kMaxGroups) * localWorkSize;
+
+  // The payload and the region list go with the kernel arguments, so the launch doesn't need
+  // a staging copy. The payload keeps the 16 bytes alignment of the writes
+  const size_t payloadSpace = amd::alignUp(payloadSize, sizeof(CopyRegion));
+  const size_t listSize = regions.size() * sizeof(CopyRegion);
+  address args = reinterpret_cast<address>(gpu().allocKernArg(payloadSpace + listSize, 16));
+  CopyRegion* list = reinterpret_cast<CopyRegion*>(args + payloadSpace);
+  memcpy(list, regions.data(), listSize);
+  if (payload != nullptr) {
+    memcpy(args, payload, payloadSize);
+    for (size_t i = 0; i < regions.size(); ++i) {
+      list[i].src_ += reinterpret_cast<uint64_t>(args);
+    }
+  }
+  constexpr bool kDirectVa = true;
+  setArgument(kernels_[kBlitType], 0, sizeof(cl_mem), list, 0, nullptr, kDirectVa);
+  uint32_t count = static_cast<uint32_t>(regions.size());
+  setArgument(kernels_[kBlitType], 1, sizeof(count), &count);
+
+  // Create ND range object for the kernel's execution
+  amd::NDRangeContainer ndrange(1, nullptr, &globalWorkSize, &localWorkSize);
+
+  // Execute the blit
+  address parameters = captureArguments(kernels_[kBlitType]);
+  bool result = gpu().submitKernelInternal(ndrange, *kernels_[kBlitType], parameters, nullptr);
+  releaseArguments(parameters);
+
+  synchronize();
+
+  return result;
+}
+
+// ================================================================================================
+bool KernelBlitManager::fillImageLinear(device::Memory& memory, const void* pattern,
+                                        const amd::Coord3D& origin,
+                                        const amd::Coord3D& size) const {
+  const Image& image = static_cast<const Image&>(gpuMem(memory));
+  const amd::Image::Format& format = memory.owner()->asImage()->getImageFormat();
+  // sRGB needs the color conversion of the image writes
+  if (!ROC_BLIT_IMAGE_RAW || !IsLinearImage(image, size) ||
+      (format.image_channel_order == CL_sRGB) || (format.image_channel_order == CL_sRGBx) ||
+      (format.image_channel_order == CL_sRGBA) || (format.image_channel_order == CL_sBGRA)) {
+    return false;
+  }
+
+  // The linear image is a view of a buffer, hence fill the buffer region of the image
+  amd::Memory* ancestor = memory.owner()->parent();
+  while (ancestor->asBuffer() == nullptr) {
+    ancestor = ancestor->parent();
+  }
+  device::Memory* bufferMemory = ancestor->getDeviceMemory(dev());
+  const size_t elementSize = format.getElementSize();
+  if ((bufferMemory == nullptr) ||
+      !amd::isMultipleOf(image.virtualAddress() - bufferMemory->virtualAddress(), elementSize)) {
+    return false;
+  }
+
+  // Clamp the normalized colors as the image writes do, the packing doesn't saturate
+  float color[4];
+  memcpy(color, pattern, sizeof(color));
+  switch (format.image_channel_data_type) {
+    case CL_UNORM_INT8:
+    case CL_UNORM_INT16:
+    case CL_UNORM_SHORT_565:
+    case CL_UNORM_SHORT_555:
+    case CL_UNORM_INT_101010:
+      for (auto& it : color) {
+        it = std::min(std::max(it, 0.0f), 1.0f);
+      }
+      break;
+    case CL_SNORM_INT8:
+    case CL_SNORM_INT16:
+      for (auto& it : color) {
+        it = std::min(std::max(it, -1.0f), 1.0f);
+      }
+      break;
+    default:
+      break;
+  }
+  uint8_t packed[16] = {};
+  format.formatColor(color, packed);
+
+  const size_t rowPitch = image.LinearRowPitch();
+  const amd::Coord3D fillOrigin(image.virtualAddress() - bufferMemory->virtualAddress() +
+                                origin[1] * rowPitch + origin[0] * elementSize);
+  const amd::Coord3D fillSize(size[0] * elementSize, size[1], 1);
+  const amd::Coord3D surface(rowPitch, size[1], 1);
+  // The host fill of the buffer doesn't take the row pitch, hence force the kernels
+  constexpr bool kForceBlit = true;
+  return fillBuffer(*bufferMemory, packed, elementSize, surface, fillOrigin, fillSize, false,
+                    kForceBlit);
+}
+
 // ================================================================================================
 bool KernelBlitManager::fillImage(device::Memory& memory, const void* pattern,
                                   const amd::Coord3D& origin, const amd::Coord3D& size,
@@ -2286,6 +2796,12 @@ bool KernelBlitManager::fillImage(device::Memory& memory, const void* pattern,
     return result;
   }
 
+  // Fill the linear images with the packed color through the buffer kernels
+  if (fillImageLinear(memory, pattern, origin, size)) {
+    synchronize();
+    return true;
+  }
+
   uint fillType;
   size_t dim = 0;
   size_t globalWorkOffset[3] = {0, 0, 0};
@@ -2563,6 +3079,20 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
     return amdMemory;
   }
 
+  if (dev().pinCache() != nullptr) {
+    amdMemory = dev().pinCache()->find(tmpHost, pinAllocSize);
+    if (amdMemory != nullptr) {
+      // The cached range can start below the aligned address, hence adjust the offset
+      partial = reinterpret_cast<const char*>(hostMem) -
+          reinterpret_cast<const char*>(amdMemory->getHostMem());
+      if (gpu().findPinnedMem(amdMemory->getHostMem(), amdMemory->getSize()) != nullptr) {
+        // The queue holds a reference already and addPinnedMem() won't take a new one
+        amdMemory->release();
+      }
+      return amdMemory;
+    }
+  }
+
   amdMemory = new (*context_) amd::Buffer(*context_, CL_MEM_USE_HOST_PTR, pinAllocSize);
   amdMemory->setVirtualDevice(&gpu());
   if ((amdMemory != nullptr) && !amdMemory->create(tmpHost, SysMem)) {
@@ -2578,6 +3108,9 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
   if (srcMemory == nullptr) {
     // Release all pinned memory and attempt pinning again
     gpu().releasePinnedMem();
+    if (dev().pinCache() != nullptr) {
+      dev().pinCache()->flush();
+    }
     srcMemory = dev().getRocMemory(amdMemory);
     if (srcMemory == nullptr) {
       // Release memory
@@ -2586,6 +3119,10 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
     }
   }
 
+  if ((amdMemory != nullptr) && (dev().pinCache() != nullptr)) {
+    dev().pinCache()->add(amdMemory);
+  }
+
   return amdMemory;
 }
 
@@ -2683,15 +3220,11 @@ bool KernelBlitManager::runScheduler(uint64_t vqVM, amd::Memory* schedulerParam,
 
   if (!gpu().submitKernelInternal(ndrange, *kernels_[Scheduler],
                                   parameters, nullptr, 0, nullptr, &sp->scheduler_aql)) {
+    hsa_signal_store_relaxed(schedulerSignal, 0);
     return false;
   }
   releaseArguments(parameters);
 
-  if (!WaitForSignal(schedulerSignal)) {
-    LogWarning("Failed schedulerSignal wait");
-    return false;
-  }
-
   return true;
 }
 
@@ -2725,4 +3258,24 @@ bool KernelBlitManager::RunGwsInit(
   return result;
 }
 
+// ================================================================================================
+bool KernelBlitManager::RunTimestamp() const {
+  amd::ScopedLock k(lockXferOps_);
+
+  size_t globalWorkOffset[1] = { 0 };
+  size_t globalWorkSize[1] = { 1 };
+  size_t localWorkSize[1] = { 1 };
+
+  // Create ND range object for the kernel's execution
+  amd::NDRangeContainer ndrange(1, globalWorkOffset, globalWorkSize, localWorkSize);
+
+  // Execute the blit. The completion signal must be attached, since the kernel writes into it
+  address parameters = captureArguments(kernels_[TimestampWrite]);
+  bool result = gpu().submitKernelInternal(ndrange, *kernels_[TimestampWrite], parameters,
+                                           nullptr, 0, nullptr, nullptr, true);
+  releaseArguments(parameters);
+
+  return result;
+}
+
 }  // namespace amd::roc
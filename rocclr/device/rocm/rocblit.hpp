@@ -237,6 +237,35 @@ class DmaBlitManager : public device::HostBlitManager {
                              const_address src, hsa_agent_t& srcAgent, size_t size,
                              amd::CopyMetadata& copyMetadata) const;
 
+  //! Returns the mask of free SDMA engines for a striped copy, 0 if striping isn't possible
+  uint32_t stripeEngineMask(hsa_agent_t& dstAgent, hsa_agent_t& srcAgent,
+                            uint32_t maxEngines) const;
+
+  //! Splits the copy across the SDMA engines in the mask with a single completion signal
+  bool rocrCopyBufferStriped(address dst, hsa_agent_t& dstAgent,
+                             const_address src, hsa_agent_t& srcAgent, size_t size,
+                             uint32_t engineMask) const;
+
+  //! Copies a pitched region with one SDMA sub-window copy. The pitches must be dword aligned
+  bool rocrCopyRect(const hsa_pitched_ptr_t& dst, const hsa_pitched_ptr_t& src,
+                    const hsa_dim3_t& size, hsa_amd_copy_direction_t direction) const;
+
+  //! Issues a small copy on the SDMA engine of the previous copy and adds it to the completion
+  //! signal of that copy. The engine runs the copies in order, hence the copy doesn't wait for
+  //! the previous one. Returns false if the copy can't be coalesced
+  bool coalesceCopy(address dst, hsa_agent_t& dstAgent, const_address src,
+                    hsa_agent_t& srcAgent, size_t size, HwQueueEngine engine) const;
+
+  //! The last SDMA copy, which the following small copies may join
+  struct CoalescedCopy {
+    hsa_signal_t signal_;   //!< Completion signal of the copies
+    uint64_t dstAgent_;     //!< Destination agent handle
+    uint64_t srcAgent_;     //!< Source agent handle
+    uint32_t copyMask_;     //!< SDMA engine of the copies
+    uint32_t count_;        //!< Number of the copies on the signal
+    HwQueueEngine engine_;  //!< Direction of the copies
+  };
+
   const size_t MinSizeForPinnedTransfer;
   bool completeOperation_;                    //!< DMA blit manager must complete operation
   amd::Context* context_;                     //!< A dummy context
@@ -244,6 +273,7 @@ class DmaBlitManager : public device::HostBlitManager {
                                               //!< used SDMA engine or fetch the new mask
   uint32_t sdmaEngineReadMask_;               //!< SDMA Engine Read Mask
   uint32_t sdmaEngineWriteMask_;              //!< SDMA Engine Write Mask
+  mutable CoalescedCopy lastCopy_;            //!< The last SDMA copy for coalescing
 
  private:
   //! Disable copy constructor
@@ -261,6 +291,24 @@ class DmaBlitManager : public device::HostBlitManager {
                      amd::CopyMetadata& copyMetadata  //!< Memory copy MetaData
                      ) const;
 
+  //! Transfers data from Local to Host, overlapping SDMA and CPU copies of the chunks
+  bool hsaCopyStagedRead(const_address devSrc,              //!< Source device memory
+                         address hostDst,                   //!< Destination host memory
+                         size_t size,                       //!< Size of data to copy in bytes
+                         amd::CopyMetadata& copyMetadata    //!< Memory copy MetaData
+                         ) const;
+
+  //! Moves an unpinned host rectangle through the staging buffers. The rows of a chunk are
+  //! packed in the staging buffer, so every chunk takes one SDMA rect copy instead of a copy
+  //! per row. Returns false if the rectangle needs the row copies
+  bool hsaCopyStagedRect(const_address src,              //!< Source memory
+                         address dst,                    //!< Destination memory
+                         const amd::BufferRect& srcRect, //!< Source rectangle
+                         const amd::BufferRect& dstRect, //!< Destination rectangle
+                         const amd::Coord3D& size,       //!< Size of the copy region
+                         bool hostToDev                  //!< True if data is copied from H2D
+                         ) const;
+
   bool forceHostWaitFunc(size_t copy_size) const;
 };
 
@@ -274,11 +322,13 @@ class KernelBlitManager : public DmaBlitManager {
     BlitCopyBufferAligned,
     BlitCopyBufferRect,
     BlitCopyBufferRectAligned,
+    BlitCopyBufferBatch,
     StreamOpsWrite,
     StreamOpsWait,
     Scheduler,
     GwsInit,
     InitHeap,
+    TimestampWrite,
     BlitLinearTotal,
     FillImage = BlitLinearTotal,
     BlitCopyImage,
@@ -363,6 +413,17 @@ class KernelBlitManager : public DmaBlitManager {
                                     amd::CopyMetadata()   //!< Memory copy MetaData
                           ) const;
 
+  //! Copies many small regions with the gather kernel
+  virtual bool copyBufferBatch(const std::vector<CopyRegion>& regions  //!< Copy regions
+                               ) const;
+
+  //! Writes the payload into the regions with the gather kernel, the data goes with the kernel
+  //! arguments
+  virtual bool writeBufferInline(const std::vector<CopyRegion>& regions,  //!< Write regions
+                                 const void* payload,                     //!< Data of the writes
+                                 size_t payloadSize                       //!< Payload size
+                                 ) const;
+
   //! Copies a buffer object to an image object
   virtual bool copyBufferToImage(device::Memory& srcMemory,      //!< Source memory object
                                  device::Memory& dstMemory,      //!< Destination memory object
@@ -487,6 +548,12 @@ class KernelBlitManager : public DmaBlitManager {
   bool RunGwsInit(uint32_t value             //!< Initial value for GWS resource
                   ) const;
 
+  //! Returns true if the timestamp kernel is available
+  bool HasTimestampKernel() const { return kernels_[TimestampWrite] != nullptr; }
+
+  //! Runs the kernel, which writes the GPU time into its completion signal
+  bool RunTimestamp() const;
+
   //! Stream memory write operation - Write a 'value' at 'memory'.
   virtual bool streamOpsWrite(device::Memory& memory, //!< Memory to write the 'value'
                              uint64_t value,
@@ -542,6 +609,13 @@ class KernelBlitManager : public DmaBlitManager {
                                     amd::CopyMetadata()   //!< Memory copy MetaData
                                ) const;
 
+  //! Launches the gather kernel. The payload goes into the kernel arguments before the region
+  //! list and the region sources are the offsets in it, if the payload isn't null
+  bool submitCopyBatch(const std::vector<CopyRegion>& regions,  //!< Copy regions
+                       const void* payload,                     //!< Data of the inline writes
+                       size_t payloadSize                       //!< Payload size
+                       ) const;
+
   //! Creates a program for all blit operations
   bool createProgram(Device& device  //!< Device object
                      );
@@ -562,6 +636,8 @@ class KernelBlitManager : public DmaBlitManager {
 
   static constexpr uint32_t kCBSize = 0x100;
   static constexpr size_t   kCBAlignment = 0x100;
+  //! Alignment argument bit that selects non-temporal accesses in the dwordx4 blit paths
+  static constexpr uint32_t kBlitNonTemporal = 0x100;
 
   inline uint32_t NumBlitKernels() {
     return (dev().info().imageSupport_) ? BlitTotal : BlitLinearTotal;
@@ -573,6 +649,44 @@ class KernelBlitManager : public DmaBlitManager {
                         const amd::Coord3D& size, bool entire, const uint32_t blitWg,
                         amd::CopyMetadata copyMetadata, bool attachSignal = false) const;
 
+  //! Copies the image data as raw bytes if both images have the same or a linear layout.
+  //! Returns false if the images need the image path
+  bool copyImageRaw(device::Memory& srcMemory, device::Memory& dstMemory,
+                    const amd::Coord3D& srcOrigin, const amd::Coord3D& dstOrigin,
+                    const amd::Coord3D& size, bool entire,
+                    amd::CopyMetadata copyMetadata) const;
+
+  //! Fills a linear image with the packed color through the buffer fill kernels.
+  //! Returns false if the image needs the image path
+  bool fillImageLinear(device::Memory& memory, const void* pattern, const amd::Coord3D& origin,
+                       const amd::Coord3D& size) const;
+
+  //! Online selection between the SDMA and the blit kernel paths of the staged transfers.
+  //! The staged reads block, hence the duration of the call measures the path. Every size class
+  //! tries both paths a few times and keeps the faster one afterwards.
+  class XferTuner {
+   public:
+    XferTuner() : classes_() {}
+
+    //! Returns true if the staged transfer should use the blit kernels
+    bool useBlit(size_t size,  //!< Transfer size
+                 bool blit     //!< Static choice of the thresholds
+    ) const;
+
+    //! Records the duration of a finished staged transfer
+    void record(size_t size, bool blit, uint64_t nanos);
+
+   private:
+    static constexpr uint32_t kSamples = 4;   //!< Measurements of a path before the choice
+    static constexpr uint32_t kClasses = 64;  //!< Power of two size classes
+
+    struct SizeClass {
+      uint32_t samples_[2];   //!< Number of measurements of SDMA and blit
+      double bandwidth_[2];   //!< Best bandwidth of SDMA and blit in bytes per ns
+    };
+    SizeClass classes_[kClasses];
+  };
+
   //! Disable copy constructor
   KernelBlitManager(const KernelBlitManager&);
 
@@ -583,13 +697,16 @@ class KernelBlitManager : public DmaBlitManager {
   amd::Kernel* kernels_[BlitTotal];   //!< GPU kernels for blit
   size_t xferBufferSize_;             //!< Transfer buffer size
   mutable amd::Monitor  lockXferOps_; //!< Lock transfer operation
+  mutable XferTuner readTuner_;       //!< Path selection of the staged reads
 };
 
 static const char* BlitName[KernelBlitManager::BlitTotal] = {
   "__amd_rocclr_fillBufferAligned", "__amd_rocclr_fillBufferAligned2D", "__amd_rocclr_copyBuffer",
   "__amd_rocclr_copyBufferAligned", "__amd_rocclr_copyBufferRect",
-  "__amd_rocclr_copyBufferRectAligned", "__amd_rocclr_streamOpsWrite", "__amd_rocclr_streamOpsWait",
+  "__amd_rocclr_copyBufferRectAligned", "__amd_rocclr_copyBufferBatch",
+  "__amd_rocclr_streamOpsWrite", "__amd_rocclr_streamOpsWait",
   "__amd_rocclr_scheduler", "__amd_rocclr_gwsInit", "__amd_rocclr_initHeap",
+  "__amd_rocclr_timestamp",
   "__amd_rocclr_fillImage", "__amd_rocclr_copyImage", "__amd_rocclr_copyImage1DA",
   "__amd_rocclr_copyImageToBuffer", "__amd_rocclr_copyBufferToImage"
 };
@@ -20,6 +20,7 @@
 
 #include "device/rocm/roccounters.hpp"
 #include "device/rocm/rocvirtual.hpp"
+#include <algorithm>
 #include <array>
 
 namespace amd::roc {
@@ -629,5 +630,183 @@ PerfCounterProfile::~PerfCounterProfile() {
   }
 }
 
-}  // namespace amd::roc
+// ================================================================================================
+PerfCounterSampler::PerfCounterSampler(Device& device, uint32_t interval, uint32_t count)
+    : roc_device_(device),
+      interval_(interval),
+      stop_(false),
+      worker_(nullptr),
+      gpu_(nullptr),
+      profile_(nullptr),
+      ring_(std::max(count, 1u)),
+      samples_(0),
+      lock_(true) {}
+
+// ================================================================================================
+PerfCounterSampler::~PerfCounterSampler() {
+  stop_ = true;
+  if (worker_ != nullptr) {
+    while (worker_->state() < amd::Thread::FINISHED && amd::Os::isThreadAlive(*worker_)) {
+      amd::Os::yield();
+    }
+    delete worker_;
+  }
+  if (profile_ != nullptr) {
+    profile_->release();
+  }
+  delete gpu_;
+}
 
+// ================================================================================================
+bool PerfCounterSampler::Create() {
+  // The event selections below follow the gfx9 counter definitions
+  if (roc_device_.isa().versionMajor() != 9) {
+    LogWarning("Performance counter sampling is supported on gfx9 devices only");
+    return false;
+  }
+  worker_ = new Worker();
+  if ((worker_ == nullptr) || (worker_->state() < amd::Thread::INITIALIZED)) {
+    LogError("Couldn't create the performance counter sampling thread");
+    return false;
+  }
+  worker_->start(this);
+  return true;
+}
+
+// ================================================================================================
+bool PerfCounterSampler::setup(bool l2_counters) {
+  struct SampledEvent {
+    hsa_ven_amd_aqlprofile_block_name_t block_;
+    uint32_t event_;  //!< Counter selection on gfx9
+    Counter counter_;
+  };
+  static constexpr SampledEvent kEvents[] = {
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_GRBM, 0, kGpuCycles},   // GRBM_COUNT
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_GRBM, 2, kBusyCycles},  // GRBM_GUI_ACTIVE
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_SQ, 4, kWaves},         // SQ_WAVES
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_TCC, 17, kL2Hits},      // TCC_HIT
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_TCC, 19, kL2Misses},    // TCC_MISS
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_TCC, 38, kMemReads},    // TCC_EA_RDREQ
+      {HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_TCC, 26, kMemWrites},   // TCC_EA_WRREQ
+  };
+  // TCC counters are per channel, the sample sums all channels
+  constexpr uint32_t kTccInstances = 16;
+
+  if (gpu_ == nullptr) {
+    gpu_ = reinterpret_cast<VirtualGPU*>(roc_device_.createVirtualDevice());
+    if (gpu_ == nullptr) {
+      return false;
+    }
+  }
+  if (profile_ != nullptr) {
+    profile_->release();
+  }
+  counters_.clear();
+  profile_ = new PerfCounterProfile(roc_device_);
+  if (profile_ == nullptr || !profile_->Create()) {
+    return false;
+  }
+  for (const auto& it : kEvents) {
+    bool tcc = (it.block_ == HSA_VEN_AMD_AQLPROFILE_BLOCK_NAME_TCC);
+    if (tcc && !l2_counters) {
+      continue;
+    }
+    for (uint32_t i = 0; i < (tcc ? kTccInstances : 1); ++i) {
+      hsa_ven_amd_aqlprofile_event_t event = {it.block_, i, it.event_};
+      profile_->addEvent(event);
+      counters_.push_back(it.counter_);
+    }
+  }
+  return profile_->initialize();
+}
+
+// ================================================================================================
+bool PerfCounterSampler::sample() {
+  uint64_t start = amd::Os::timeNanos();
+  {
+    amd::ScopedLock lock(gpu_->execution());
+    if ((profile_->createStartPacket() == nullptr) ||
+        !gpu_->dispatchCounterAqlPacket(profile_->prePacket(), PerfCounter::ROC_GFX9, false,
+                                        profile_->api())) {
+      return false;
+    }
+  }
+
+  // Sleep in short slices, so the teardown doesn't wait for a long interval
+  constexpr uint32_t kSliceMs = 10;
+  for (uint32_t slept = 0; slept < interval_ && !stop_; slept += kSliceMs) {
+    amd::Os::sleep(std::min(kSliceMs, interval_ - slept));
+  }
+
+  {
+    amd::ScopedLock lock(gpu_->execution());
+    if ((profile_->createStopPacket() == nullptr) ||
+        !gpu_->dispatchCounterAqlPacket(profile_->postPacket(), PerfCounter::ROC_GFX9, true,
+                                        profile_->api())) {
+      return false;
+    }
+  }
+  uint64_t end = amd::Os::timeNanos();
+
+  std::vector<hsa_ven_amd_aqlprofile_info_data_t> data;
+  profile_->api()->hsa_ven_amd_aqlprofile_iterate_data(profile_->profile(), PerfCounterCallback,
+                                                       &data);
+  uint64_t values[kCounterCount] = {};
+  const hsa_ven_amd_aqlprofile_event_t* events = profile_->profile()->events;
+  for (const auto& it : data) {
+    for (size_t i = 0; i < counters_.size(); ++i) {
+      if (it.pmc_data.event.block_name == events[i].block_name &&
+          it.pmc_data.event.block_index == events[i].block_index &&
+          it.pmc_data.event.counter_id == events[i].counter_id) {
+        values[counters_[i]] += it.pmc_data.result;
+        break;
+      }
+    }
+  }
+
+  amd::ScopedLock lock(lock_);
+  device::PerfCounterSample& sample = ring_[samples_ % ring_.size()];
+  sample.timestamp_ = end;
+  sample.duration_ = end - start;
+  sample.gpuCycles_ = values[kGpuCycles];
+  sample.busyCycles_ = values[kBusyCycles];
+  sample.waves_ = values[kWaves];
+  sample.l2Hits_ = values[kL2Hits];
+  sample.l2Misses_ = values[kL2Misses];
+  sample.memReads_ = values[kMemReads];
+  sample.memWrites_ = values[kMemWrites];
+  ++samples_;
+  return true;
+}
+
+// ================================================================================================
+void PerfCounterSampler::loop() {
+  roc_device_.setThreadNumaAffinity();
+  if (!setup(true)) {
+    // The channel count differs between the ASICs, hence keep sampling without the L2 counters
+    LogWarning("Couldn't sample the L2 counters, the samples report only busy and waves");
+    if (!setup(false)) {
+      LogError("Couldn't set up the performance counter sampling");
+      return;
+    }
+  }
+  while (!stop_) {
+    if (!sample()) {
+      LogError("Performance counter sampling failed, the sampling stops");
+      return;
+    }
+  }
+}
+
+// ================================================================================================
+void PerfCounterSampler::GetSamples(std::vector<device::PerfCounterSample>* samples) const {
+  amd::ScopedLock lock(lock_);
+  uint64_t count = std::min<uint64_t>(samples_, ring_.size());
+  samples->clear();
+  samples->reserve(count);
+  for (uint64_t i = samples_ - count; i < samples_; ++i) {
+    samples->push_back(ring_[i % ring_.size()]);
+  }
+}
+
+}  // namespace amd::roc
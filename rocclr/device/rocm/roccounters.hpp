@@ -187,6 +187,73 @@ class PerfCounterProfile : public amd::ReferenceCountedObject {
 
 };
 
+//! Continuous sampling of a small fixed set of device-wide counters. A worker thread brackets
+//! every interval with the start and stop packets of one profile on an internal queue and keeps
+//! the recent results in a ring. The counters cover all queues of the device, hence the sampling
+//! doesn't touch the dispatches of the application
+class PerfCounterSampler : public amd::HeapObject {
+ public:
+  PerfCounterSampler(Device& device,     //!< A ROC device object
+                     uint32_t interval,  //!< Sampling interval in ms
+                     uint32_t count);    //!< Number of the samples in the ring
+
+  //! Stops the worker thread and releases the profile and the queue
+  ~PerfCounterSampler();
+
+  //! Starts the worker thread
+  bool Create();
+
+  //! Returns the samples in the ring, oldest first
+  void GetSamples(std::vector<device::PerfCounterSample>* samples) const;
+
+ private:
+  //! Disable copy constructor
+  PerfCounterSampler(const PerfCounterSampler&);
+
+  //! Disable operator=
+  PerfCounterSampler& operator=(const PerfCounterSampler&);
+
+  //! The sampled counters
+  enum Counter {
+    kGpuCycles = 0,
+    kBusyCycles,
+    kWaves,
+    kL2Hits,
+    kL2Misses,
+    kMemReads,
+    kMemWrites,
+    kCounterCount
+  };
+
+  class Worker : public amd::Thread {
+   public:
+    Worker() : amd::Thread("Perf Counter Sampler") {}
+
+    //! The worker thread entry point
+    void run(void* data) { static_cast<PerfCounterSampler*>(data)->loop(); }
+  };
+
+  //! Creates the queue and the profile, called on the worker thread
+  bool setup(bool l2_counters);
+
+  //! Collects one interval into the ring
+  bool sample();
+
+  //! Samples until the sampler stops
+  void loop();
+
+  Device& roc_device_;               //!< The backend device
+  uint32_t interval_;                //!< Sampling interval in ms
+  std::atomic<bool> stop_;           //!< The worker exits before the next interval
+  Worker* worker_;                   //!< Sampling thread
+  VirtualGPU* gpu_;                  //!< Internal queue for the profile packets
+  PerfCounterProfile* profile_;      //!< Profile with the sampled events
+  std::vector<Counter> counters_;    //!< The counter of each profile event
+  std::vector<device::PerfCounterSample> ring_;  //!< Recent samples
+  uint64_t samples_;                 //!< Total number of the collected samples
+  mutable amd::Monitor lock_;        //!< Ring access lock
+};
+
 }  // namespace amd::roc
 
 #endif  // ROCCOUNTERS_HPP_
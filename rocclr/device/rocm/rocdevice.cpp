@@ -22,6 +22,7 @@
 
 #include "platform/program.hpp"
 #include "platform/kernel.hpp"
+#include "platform/runtime.hpp"
 #include "os/os.hpp"
 #include "utils/debug.hpp"
 #include "utils/flags.hpp"
@@ -35,6 +36,7 @@
 #include "device/devhostcall.hpp"
 #include "device/rocm/rocdevice.hpp"
 #include "device/rocm/rocblit.hpp"
+#include "device/rocm/roccounters.hpp"
 #include "device/rocm/rocvirtual.hpp"
 #include "device/rocm/rocprogram.hpp"
 #include "device/rocm/rocmemory.hpp"
@@ -58,7 +60,13 @@
 #include <numaif.h>
 #endif // ROCCLR_SUPPORT_NUMA_POLICY
 #include <sstream>
+#include <thread>
 #include <vector>
+#if defined(__linux__)
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#endif  // __linux__
 #endif // WITHOUT_HSA_BaCKEND
 
 #define OPENCL_VERSION_STR XSTR(OPENCL_MAJOR) "." XSTR(OPENCL_MINOR)
@@ -115,6 +123,7 @@ bool getValueFromIsaMeta(amd_comgr_metadata_node_t& isaMeta, const char* key,
 namespace amd::device {
 extern const char* HipExtraSourceCode;
 extern const char* HipExtraSourceCodeNoGWS;
+extern const char* TimestampSourceCode;
 } // namespace amd::device
 
 namespace amd::roc {
@@ -179,8 +188,14 @@ Device::Device(hsa_agent_t bkendDevice)
     , alloc_granularity_(0)
     , xferQueue_(nullptr)
     , xferRead_(nullptr)
-    , freeMem_(0)
-    , vgpusAccess_(true) /* Virtual GPU List Ops Lock */
+    , pinCache_(nullptr)
+    , subAllocator_(nullptr)
+    , callbackExecutor_(nullptr)
+    , perfCounterSampler_(nullptr)
+    , usedMem_{}
+    , otherMem_(0)
+    , reconcileTime_(0)
+    , vgpusAccess_("Virtual GPU list lock", true)
     , hsa_exclusive_gpu_access_(false)
     , queuePool_(QueuePriority::Total)
     , coopHostcallBuffer_(nullptr)
@@ -231,6 +246,12 @@ void Device::setupCpuAgent() {
           system_segment_.handle, system_coarse_segment_.handle, bkendDevice_.handle, isXgmi_);
 }
 
+void Device::setThreadNumaAffinity() const {
+  if (ROC_NUMA_THREAD_AFFINITY) {
+    amd::Os::setCurrentThreadNumaNode(preferred_numa_node_);
+  }
+}
+
 void Device::checkAtomicSupport() {
   std::vector<amd::Device::LinkAttrType> link_attrs;
   link_attrs.push_back(std::make_pair(LinkAttribute::kLinkAtomicSupport, 0));
@@ -242,6 +263,12 @@ void Device::checkAtomicSupport() {
 }
 
 Device::~Device() {
+  // Finish the pending API callbacks first, since they update the queues state
+  delete callbackExecutor_;
+
+  // Stop the sampling before the queues go away
+  delete perfCounterSampler_;
+
   if (coopHostcallBuffer_) {
     amd::disableHostcalls(coopHostcallBuffer_);
     context().svmFree(coopHostcallBuffer_);
@@ -256,6 +283,7 @@ Device::~Device() {
   delete mapCache_;
   delete mapCacheOps_;
 
+  ReleaseP2PStages();
   if (nullptr != p2p_stage_) {
     p2p_stage_->release();
     p2p_stage_ = nullptr;
@@ -287,6 +315,12 @@ Device::~Device() {
   }
   queuePool_.clear();
 
+  // Release the cached pinned host ranges
+  delete pinCache_;
+
+  // Release the slabs of the sub-allocator
+  delete subAllocator_;
+
   // Destroy temporary buffers for read/write
   delete xferRead_;
 
@@ -441,6 +475,7 @@ Memory& Device::XferBuffers::acquire() {
   }
 
   if (xferBuf == nullptr) {
+    guarantee(!freeBuffers_.empty(), "No transfer buffers available!");
     xferBuf = *(freeBuffers_.begin());
     freeBuffers_.erase(freeBuffers_.begin());
     ++acquiredCnt_;
@@ -459,6 +494,335 @@ void Device::XferBuffers::release(VirtualGPU& gpu, Memory& buffer) {
   --acquiredCnt_;
 }
 
+// ================================================================================================
+amd::Memory* Device::PinCache::find(const void* hostMem, size_t size) {
+  amd::ScopedLock l(lock_);
+  uintptr_t start = reinterpret_cast<uintptr_t>(hostMem);
+  auto it = ranges_.upper_bound(start);
+  if (it == ranges_.begin()) {
+    return nullptr;
+  }
+  --it;
+  amd::Memory* memory = *it->second;
+  if ((start + size) > (it->first + memory->getSize())) {
+    return nullptr;
+  }
+  // Move the range to the front of the LRU list
+  lru_.splice(lru_.begin(), lru_, it->second);
+  memory->retain();
+  return memory;
+}
+
+// ================================================================================================
+void Device::PinCache::add(amd::Memory* memory) {
+  if (memory->getSize() > budget_) {
+    return;
+  }
+  amd::ScopedLock l(lock_);
+  uintptr_t start = reinterpret_cast<uintptr_t>(memory->getHostMem());
+  if (ranges_.find(start) != ranges_.end()) {
+    // Another queue pinned the same range already
+    return;
+  }
+  while ((size_ + memory->getSize()) > budget_) {
+    amd::Memory* lru = lru_.back();
+    ranges_.erase(reinterpret_cast<uintptr_t>(lru->getHostMem()));
+    lru_.pop_back();
+    size_ -= lru->getSize();
+    // The active transfers hold own references, hence it's safe to release the cache one
+    lru->release();
+  }
+  memory->retain();
+  lru_.push_front(memory);
+  ranges_[start] = lru_.begin();
+  size_ += memory->getSize();
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Pin cache add: %p, %zu bytes, total %zu bytes",
+          memory->getHostMem(), memory->getSize(), size_);
+}
+
+// ================================================================================================
+void Device::PinCache::flush() {
+  amd::ScopedLock l(lock_);
+  for (auto memory : lru_) {
+    memory->release();
+  }
+  lru_.clear();
+  ranges_.clear();
+  size_ = 0;
+}
+
+// ================================================================================================
+Device::SubAllocator::~SubAllocator() {
+  amd::ScopedLock l(lock_);
+  for (auto& it : slabs_) {
+    if (it.second->free_.size() != (kSlabSize / it.second->bin_.second)) {
+      ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Sub-allocator slab %p has live chunks on exit",
+              it.second->base_);
+    }
+    freeSlab(it.second);
+  }
+  slabs_.clear();
+  partial_.clear();
+}
+
+// ================================================================================================
+Device::SubAllocator::Slab* Device::SubAllocator::allocSlab(const hsa_amd_memory_pool_t& pool,
+                                                              const BinKey& bin, bool host) {
+  void* ptr = nullptr;
+  hsa_status_t stat = hsa_amd_memory_pool_allocate(pool, kSlabSize, 0, &ptr);
+  if (stat != HSA_STATUS_SUCCESS) {
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Sub-allocator slab allocation failed with err %d",
+            stat);
+    return nullptr;
+  }
+  if (host) {
+    stat = hsa_amd_agents_allow_access(gpu_agents_.size(), &gpu_agents_[0], nullptr, ptr);
+  } else if (device_.isP2pEnabled() && !device_.deviceAllowAccess(ptr)) {
+    stat = HSA_STATUS_ERROR;
+  }
+  if (stat != HSA_STATUS_SUCCESS) {
+    LogPrintfError("Fail to allow access to the sub-allocator slab with err %d", stat);
+    hsa_amd_memory_pool_free(ptr);
+    return nullptr;
+  }
+
+  Slab* slab = new Slab();
+  slab->base_ = reinterpret_cast<address>(ptr);
+  slab->bin_ = bin;
+  // Keep the chunks in the reverse order, so the allocations go from the slab start
+  uint32_t num_chunks = static_cast<uint32_t>(kSlabSize / bin.second);
+  slab->free_.reserve(num_chunks);
+  for (uint32_t i = num_chunks; i > 0; --i) {
+    slab->free_.push_back(i - 1);
+  }
+  auto& partial = partial_[bin];
+  slab->partial_ = partial.insert(partial.begin(), slab);
+  slabs_[reinterpret_cast<uintptr_t>(ptr)] = slab;
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Sub-allocator slab %p, chunk size 0x%zx",
+          ptr, bin.second);
+  return slab;
+}
+
+// ================================================================================================
+void Device::SubAllocator::freeSlab(Slab* slab) {
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Sub-allocator free slab %p", slab->base_);
+  if (hsa_amd_memory_pool_free(slab->base_) != HSA_STATUS_SUCCESS) {
+    LogError("Fail freeing the sub-allocator slab");
+  }
+  delete slab;
+}
+
+// ================================================================================================
+void* Device::SubAllocator::alloc(const hsa_amd_memory_pool_t& pool, size_t size, bool host) {
+  if ((size == 0) || (size > max_size_)) {
+    return nullptr;
+  }
+  size_t chunk_size = amd::nextPowerOfTwo(size);
+  BinKey bin(pool.handle, (chunk_size < kMinChunkSize) ? size_t{kMinChunkSize} : chunk_size);
+
+  amd::ScopedLock l(lock_);
+  auto& partial = partial_[bin];
+  Slab* slab = partial.empty() ? allocSlab(pool, bin, host) : partial.front();
+  if (slab == nullptr) {
+    return nullptr;
+  }
+  uint32_t chunk = slab->free_.back();
+  slab->free_.pop_back();
+  if (slab->free_.empty()) {
+    partial.erase(slab->partial_);
+  }
+  void* ptr = slab->base_ + chunk * bin.second;
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Sub-allocate %p, size 0x%zx, slab %p", ptr, size,
+          slab->base_);
+  return ptr;
+}
+
+// ================================================================================================
+bool Device::SubAllocator::free(void* ptr) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  amd::ScopedLock l(lock_);
+  auto it = slabs_.upper_bound(addr);
+  if (it == slabs_.begin()) {
+    return false;
+  }
+  --it;
+  if (addr >= (it->first + kSlabSize)) {
+    return false;
+  }
+  Slab* slab = it->second;
+  auto& partial = partial_[slab->bin_];
+  if (slab->free_.empty()) {
+    slab->partial_ = partial.insert(partial.end(), slab);
+  }
+  slab->free_.push_back(static_cast<uint32_t>((addr - it->first) / slab->bin_.second));
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Sub-free %p, slab %p", ptr, slab->base_);
+
+  // Keep a single empty slab per bin, so the alloc/free loops don't hit the pool
+  if ((slab->free_.size() == (kSlabSize / slab->bin_.second)) && (partial.size() > 1)) {
+    partial.erase(slab->partial_);
+    slabs_.erase(it);
+    freeSlab(slab);
+  }
+  return true;
+}
+
+// ================================================================================================
+void* Device::SubAllocator::base(void* ptr) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  amd::ScopedLock l(lock_);
+  auto it = slabs_.upper_bound(addr);
+  if ((it != slabs_.begin()) && (addr < ((--it)->first + kSlabSize))) {
+    return it->second->base_;
+  }
+  return ptr;
+}
+
+// ================================================================================================
+Device::CallbackExecutor::CallbackExecutor(const Device& device, uint32_t num_threads)
+    : device_(device), num_threads_(num_threads), stop_(false), lock_(true) {}
+
+// ================================================================================================
+Device::CallbackExecutor::~CallbackExecutor() {
+  {
+    amd::ScopedLock l(lock_);
+    stop_ = true;
+    lock_.notifyAll();
+  }
+  for (auto worker : workers_) {
+    while (worker->state() < amd::Thread::FINISHED && amd::Os::isThreadAlive(*worker)) {
+      amd::Os::yield();
+    }
+    delete worker;
+  }
+}
+
+// ================================================================================================
+bool Device::CallbackExecutor::startWorkers() {
+  for (uint32_t i = 0; i < num_threads_; ++i) {
+    Worker* worker = new Worker();
+    if ((worker == nullptr) || (worker->state() < amd::Thread::INITIALIZED)) {
+      delete worker;
+      return false;
+    }
+    workers_.push_back(worker);
+    worker->start(this);
+  }
+  return true;
+}
+
+// ================================================================================================
+void Device::CallbackExecutor::enqueue(const void* token, Task&& task) {
+  amd::ScopedLock l(lock_);
+  // The workers start with the first task, so the devices without callbacks have no threads
+  if (workers_.empty() && !startWorkers()) {
+    LogError("Couldn't start the callback threads, running the callback in place");
+    lock_.unlock();
+    task();
+    lock_.lock();
+    return;
+  }
+  auto& tasks = tasks_[token];
+  tasks.push_back(std::move(task));
+  // The token becomes ready only if nothing runs or waits for it already
+  if (tasks.size() == 1) {
+    ready_.push_back(token);
+    lock_.notify();
+  }
+}
+
+// ================================================================================================
+void Device::CallbackExecutor::loop() {
+  device_.setThreadNumaAffinity();
+  amd::ScopedLock l(lock_);
+  while (true) {
+    if (ready_.empty()) {
+      if (stop_) {
+        break;
+      }
+      lock_.wait();
+      continue;
+    }
+    const void* token = ready_.front();
+    ready_.pop_front();
+    // Keep the task in the queue while it runs, so the new tasks with the same token wait
+    Task task = std::move(tasks_[token].front());
+
+    lock_.unlock();
+    task();
+    lock_.lock();
+
+    auto it = tasks_.find(token);
+    it->second.pop_front();
+    if (it->second.empty()) {
+      tasks_.erase(it);
+    } else {
+      ready_.push_back(token);
+    }
+  }
+}
+
+// ================================================================================================
+void DumpFlightRecorders() {
+  static amd::Monitor dumpLock(true);
+  amd::ScopedLock lock(dumpLock);
+  constexpr bool kNoOfflineDevices = false;
+  std::vector<amd::Device*> devices = amd::Device::getDevices(CL_DEVICE_TYPE_GPU,
+                                                              kNoOfflineDevices);
+  for (auto device : devices) {
+    Device* gpu = static_cast<Device*>(device);
+    // The caller may hold the execution lock of a queue, while the exclusive GPU access holds
+    // the queue list and waits for the execution locks. Hence skip the dump if the list is busy
+    if (!gpu->vgpusAccess().tryLock()) {
+      fprintf(amd::outFile, "Flight recorder: %s queues are busy, skipped\n",
+              gpu->info().name_);
+      continue;
+    }
+    fprintf(amd::outFile, "Flight recorder: %s, %zu queues\n", gpu->info().name_,
+            gpu->vgpus().size());
+    for (auto vgpu : gpu->vgpus()) {
+      if (vgpu != nullptr) {
+        vgpu->DumpFlightRecorder(amd::outFile);
+      }
+    }
+    gpu->vgpusAccess().unlock();
+  }
+  fflush(amd::outFile);
+}
+
+#if defined(__linux__)
+namespace {
+sem_t flightRecorderRequest;
+
+void flightRecorderSignalHandler(int) {
+  // The dump isn't async signal safe, hence it runs on a separate thread
+  sem_post(&flightRecorderRequest);
+}
+
+void installFlightRecorderDump() {
+  if (sem_init(&flightRecorderRequest, 0, 0) != 0) {
+    LogError("Couldn't create the flight recorder semaphore");
+    return;
+  }
+  std::thread dumper([]() {
+    while (true) {
+      if (sem_wait(&flightRecorderRequest) == 0) {
+        DumpFlightRecorders();
+      }
+    }
+  });
+  dumper.detach();
+
+  struct sigaction action = {};
+  action.sa_handler = flightRecorderSignalHandler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGUSR1, &action, nullptr) != 0) {
+    LogError("Couldn't install SIGUSR1 handler for the flight recorder");
+  }
+}
+}  // namespace
+#endif  // __linux__
+
 // ================================================================================================
 bool Device::init() {
   ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Initializing HSA stack.");
@@ -469,7 +833,11 @@ bool Device::init() {
     return false;
   }
 
-  status = hsa_init();
+  {
+    amd::StartupProfile::Scope scope(amd::StartupProfile::HsaInit);
+    status = hsa_init();
+  }
+  amd::StartupProfile::Scope enumeration(amd::StartupProfile::DeviceEnumeration);
 
   // If there are no GPUs available, hsa_init will fail with HSA_STATUS_ERROR_OUT_OF_RESOURCES
   // but for NoGpu tests to pass, true needs to be returned
@@ -487,6 +855,13 @@ bool Device::init() {
   hsa_system_get_major_extension_table(HSA_EXTENSION_AMD_LOADER, 1, sizeof(amd_loader_ext_table),
                                        &amd_loader_ext_table);
 
+#if defined(__linux__)
+  // Dump the flight recorders of all queues on SIGUSR1 for the hang analysis
+  if (GPU_ANALYZE_HANG && (ROC_FLIGHT_RECORDER_SIZE > 0)) {
+    installFlightRecorderDump();
+  }
+#endif  // __linux__
+
   status = hsa_iterate_agents(iterateAgentCallback, nullptr);
   if (status != HSA_STATUS_SUCCESS) {
     LogPrintfError("hsa_iterate_agents failed with %x", status);
@@ -600,6 +975,45 @@ bool Device::init() {
       }
     }
 
+    // Build the relay routes for the pairs without a direct link. The relay device accesses
+    // the memory of both devices, so its transfer queue copies the data over its own links
+    for (auto src: devices) {
+      for (auto dst: devices) {
+        if (!ROC_P2P_RELAY || (src == dst) ||
+            (std::find(src->p2p_access_devices_.begin(), src->p2p_access_devices_.end(), dst) !=
+             src->p2p_access_devices_.end()) ||
+            (std::find(dst->p2p_access_devices_.begin(), dst->p2p_access_devices_.end(), src) !=
+             dst->p2p_access_devices_.end())) {
+          continue;
+        }
+        amd::Device* relay = nullptr;
+        int32_t relay_hops = std::numeric_limits<int32_t>::max();
+        for (auto device: src->p2p_access_devices_) {
+          if ((device == dst) ||
+              (std::find(dst->p2p_access_devices_.begin(), dst->p2p_access_devices_.end(),
+                         device) == dst->p2p_access_devices_.end())) {
+            continue;
+          }
+          std::vector<LinkAttrType> src_attrs = {{kLinkHopCount, 0}};
+          std::vector<LinkAttrType> dst_attrs = {{kLinkHopCount, 0}};
+          if (!device->findLinkInfo(*src, &src_attrs) || !device->findLinkInfo(*dst, &dst_attrs)) {
+            continue;
+          }
+          // Prefer the relay with the shortest total route
+          int32_t hops = src_attrs[0].second + dst_attrs[0].second;
+          if (hops < relay_hops) {
+            relay = device;
+            relay_hops = hops;
+          }
+        }
+        if (relay != nullptr) {
+          src->p2p_relay_devices_[dst] = relay;
+          ClPrint(amd::LOG_INFO, amd::LOG_INIT, "P2P route %u -> %u relays through %u, %d hops",
+                  src->index(), dst->index(), relay->index(), relay_hops);
+        }
+      }
+    }
+
     // Create a dummy context for internal memory allocations on all reported devices
     glb_ctx_ = new amd::Context(devices, amd::Context::Info());
     if (glb_ctx_ == nullptr) {
@@ -788,7 +1202,7 @@ bool Device::create() {
                    pciDeviceId_);
     return false;
   }
-  hsaSettings->limit_blit_wg_ = info().maxComputeUnits_;
+  hsaSettings->limit_blit_wg_ = info().maxComputeUnits_ * hsaSettings->blit_wg_per_cu_;
   if (!flagIsDefault(DEBUG_CLR_LIMIT_BLIT_WG)) {
     hsaSettings->limit_blit_wg_ = std::max(DEBUG_CLR_LIMIT_BLIT_WG, 0x1U);
   }
@@ -803,7 +1217,7 @@ bool Device::create() {
   }
 
   // Map Cache Lock
-  mapCacheOps_ = new amd::Monitor(true);
+  mapCacheOps_ = new amd::Monitor("Map cache lock", true);
   if (nullptr == mapCacheOps_) {
     return false;
   }
@@ -818,19 +1232,57 @@ bool Device::create() {
   if (settings().stagedXferSize_ != 0) {
     // Initialize staged read buffers
     if (settings().stagedXferRead_) {
+      // The staging buffers are allocated by the first staged read, so the devices, which a
+      // process never uses, don't hold device memory
       xferRead_ = new XferBuffers(*this, amd::alignUp(settings().stagedXferSize_, 4 * Ki));
-      if ((xferRead_ == nullptr) || !xferRead_->create()) {
+      if (xferRead_ == nullptr) {
         LogError("Couldn't allocate transfer buffer objects for write");
         return false;
       }
     }
   }
 
+  if (ROC_PIN_CACHE_SIZE != 0) {
+    pinCache_ = new PinCache(static_cast<size_t>(ROC_PIN_CACHE_SIZE) * Mi);
+  }
+
+  if (ROC_MAX_SUBALLOC_SIZE != 0) {
+    // Limit the chunks to a half of the slab, otherwise the slabs don't save any memory
+    size_t max_size = static_cast<size_t>(ROC_MAX_SUBALLOC_SIZE) * Ki;
+    size_t max_chunk = SubAllocator::kSlabSize / 2;
+    subAllocator_ = new SubAllocator(*this, std::min(max_size, max_chunk));
+  }
+
+  uint32_t callback_threads = ROC_CALLBACK_THREADS;
+  if (flagIsDefault(ROC_CALLBACK_THREADS) && AMD_DIRECT_DISPATCH) {
+    // Direct dispatch has no queue threads and the deferred work of all queues lands on ROCr
+    // async handler thread, hence a blocking callback stalls every stream. Scale the pool with
+    // the cores instead of the queues. The workers start on the first callback only
+    callback_threads = std::min(std::max(amd::Os::processorCount() / 8, 1), 4);
+  }
+  if (callback_threads != 0) {
+    callbackExecutor_ = new CallbackExecutor(*this, callback_threads);
+    if (callbackExecutor_ == nullptr) {
+      LogError("Couldn't create the worker pool for API callbacks");
+      return false;
+    }
+  }
+
   // Create signal for HMM prefetch operation on device
   if (HSA_STATUS_SUCCESS != hsa_signal_create(kInitSignalValueOne, 0, nullptr, &prefetch_signal_)) {
     return false;
   }
 
+  if (ROC_PERF_SAMPLE_INTERVAL != 0) {
+    // The sampling is an optional monitor, hence its failure doesn't fail the device
+    perfCounterSampler_ = new PerfCounterSampler(*this, ROC_PERF_SAMPLE_INTERVAL,
+                                                 ROC_PERF_SAMPLE_COUNT);
+    if ((perfCounterSampler_ != nullptr) && !perfCounterSampler_->Create()) {
+      delete perfCounterSampler_;
+      perfCounterSampler_ = nullptr;
+    }
+  }
+
   if (AMD_LOG_LEVEL >= LOG_EXTRA_DEBUG) {
     uint8_t logMask[8] = { 0 };
     hsa_flag_set64(logMask, HSA_AMD_LOG_FLAG_BLIT_KERNEL_PKTS);
@@ -900,6 +1352,9 @@ bool Device::createBlitProgram() {
       } else {
         extraKernel = device::HipExtraSourceCodeNoGWS;
       }
+      if (ROC_TIMESTAMP_KERNEL) {
+        extraKernel += device::TimestampSourceCode;
+      }
     } else {
       extraKernel = SchedulerSourceCode;
     }
@@ -1410,7 +1865,9 @@ bool Device::populateOCLDeviceConstants() {
     }
   }
 
-  freeMem_ = info_.globalMemSize_;
+  for (auto& it : usedMem_) {
+    it = 0;
+  }
 
   // Make sure the max allocation size is not larger than the available memory size.
   info_.maxMemAllocSize_ = std::min(info_.maxMemAllocSize_, info_.globalMemSize_);
@@ -1927,17 +2384,8 @@ device::VirtualDevice* Device::createVirtualDevice(amd::CommandQueue* queue) {
 bool Device::globalFreeMemory(size_t* freeMemory) const {
   const uint TotalFreeMemory = 0;
   const uint LargestFreeBlock = 1;
-  uint64_t globalAvailMemory;
-  // Queries memory available in bytes across all global pools owned by the agent
-  if (HSA_STATUS_SUCCESS !=
-      hsa_agent_get_info(bkendDevice_,
-                         static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_MEMORY_AVAIL),
-                         &globalAvailMemory)) {
-    LogError("HSA_AMD_AGENT_INFO_MEMORY_AVAIL query failed.");
-    return false;
-  }
-
-  globalAvailMemory = globalAvailMemory / Ki;
+  // The accounting tracks the runtime allocations immediately and reconciles the rest with KFD
+  uint64_t globalAvailMemory = freeMemory() / Ki;
   if (globalAvailMemory > HIP_HIDDEN_FREE_MEM * Ki) {
     globalAvailMemory -= HIP_HIDDEN_FREE_MEM * Ki;
   } else {
@@ -2184,6 +2632,12 @@ device::Memory* Device::createMemory(size_t size) const {
 // ================================================================================================
 void* Device::hostAlloc(size_t size, size_t alignment, MemorySegment mem_seg) const {
   void* ptr = nullptr;
+  if (mem_seg != kKernArg) {
+    ptr = hostHugeAlloc(size, mem_seg == kAtomics);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
 
   hsa_amd_memory_pool_t segment{0};
   switch (mem_seg) {
@@ -2254,6 +2708,126 @@ void* Device::hostAgentAlloc(size_t size, const AgentInfo& agentInfo, bool atomi
   return ptr;
 }
 
+// ================================================================================================
+void* Device::hostHugeAlloc(size_t size, bool atomics, bool force) const {
+#if defined(__linux__)
+  constexpr size_t kHugePage = 2 * Mi;
+  constexpr size_t kGiantPage = 1 * Gi;
+  // Small allocations waste the most of a huge page, unless the application asked for it
+  uint32_t mode = std::max(ROC_HOST_HUGE_PAGES, force ? 1u : 0u);
+  if ((mode == 0) || (!force && (size < kHugePage))) {
+    return nullptr;
+  }
+
+  void* ptr = MAP_FAILED;
+  size_t alloc_size = 0;
+  if (mode > 1) {
+    // Explicit pages from hugetlbfs: 1GB pages for the large sizes, then the default 2MB pages
+#if defined(MAP_HUGE_SHIFT)
+    if (size >= kGiantPage) {
+      alloc_size = amd::alignUp(size, kGiantPage);
+      ptr = mmap(nullptr, alloc_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT), -1, 0);
+    }
+#endif  // MAP_HUGE_SHIFT
+    if (ptr == MAP_FAILED) {
+      alloc_size = amd::alignUp(size, kHugePage);
+      ptr = mmap(nullptr, alloc_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+  }
+  if (ptr == MAP_FAILED) {
+    // Transparent huge pages need a 2MB aligned range, hence reserve extra and trim it
+    alloc_size = amd::alignUp(size, kHugePage);
+    void* reserved = mmap(nullptr, alloc_size + kHugePage, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+      return nullptr;
+    }
+    address base = reinterpret_cast<address>(reserved);
+    address aligned = amd::alignUp(base, kHugePage);
+    if (aligned != base) {
+      munmap(base, aligned - base);
+    }
+    munmap(aligned + alloc_size, base + kHugePage - aligned);
+    if (madvise(aligned, alloc_size, MADV_HUGEPAGE) != 0) {
+      ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Transparent huge pages are unavailable");
+      munmap(aligned, alloc_size);
+      return nullptr;
+    }
+    ptr = aligned;
+  }
+
+  touchHostPages(ptr, alloc_size);
+
+  // Pin the range and map it for all GPUs
+  const hsa_amd_memory_pool_t& segment =
+      (!atomics && (system_coarse_segment_.handle != 0)) ? system_coarse_segment_
+                                                          : system_segment_;
+  void* agent_ptr = nullptr;
+  hsa_status_t stat = hsa_amd_memory_lock_to_pool(ptr, alloc_size, &gpu_agents_[0],
+                                                  gpu_agents_.size(), segment, 0, &agent_ptr);
+  if (stat != HSA_STATUS_SUCCESS || (agent_ptr != ptr)) {
+    // The runtime requires the same address on the host and the device for the host memory
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Huge page pinning isn't available, err %d", stat);
+    if (stat == HSA_STATUS_SUCCESS) {
+      hsa_amd_memory_unlock(ptr);
+    }
+    munmap(ptr, alloc_size);
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(lock_huge_pages_);
+    hugeAllocs_[ptr] = alloc_size;
+  }
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Allocate huge page host memory %p, size 0x%zx",
+          ptr, alloc_size);
+  return ptr;
+#else
+  return nullptr;
+#endif  // __linux__
+}
+
+// ================================================================================================
+void Device::touchHostPages(void* ptr, size_t size) const {
+  // Smaller ranges don't pay off the thread startup
+  constexpr size_t kMinChunk = 64 * Mi;
+  const size_t page = amd::Os::pageSize();
+  auto touch = [page](address start, address end) {
+    for (volatile char* p = reinterpret_cast<volatile char*>(start); p < end; p += page) {
+      *p = 0;
+    }
+  };
+
+  address base = reinterpret_cast<address>(ptr);
+  size_t num_threads = std::min(static_cast<size_t>(ROC_HOST_TOUCH_THREADS), size / kMinChunk);
+  if (num_threads <= 1) {
+    touch(base, base + size);
+    return;
+  }
+
+  // The workers inherit the memory policy of the thread. Under the default policy the first
+  // touch places the pages on the NUMA node of the workers, hence bind them to the device node
+  size_t chunk = amd::alignUp((size + num_threads - 1) / num_threads, page);
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    address start = base + std::min(i * chunk, size);
+    address end = base + std::min((i + 1) * chunk, size);
+    workers.emplace_back([this, touch, start, end]() {
+      amd::Os::setCurrentThreadNumaNode(preferred_numa_node_);
+      touch(start, end);
+    });
+  }
+  touch(base, base + std::min(chunk, size));
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Touched host memory %p, size 0x%zx with %zu threads",
+          ptr, size, num_threads);
+}
+
 // ================================================================================================
 void* Device::hostNumaAlloc(size_t size, size_t alignment, bool atomics) const {
   void* ptr = nullptr;
@@ -2279,6 +2853,11 @@ void* Device::hostNumaAlloc(size_t size, size_t alignment, bool atomics) const {
     // For details, see "man get_mempolicy".
     case MPOL_BIND:
     case MPOL_PREFERRED:
+      // The huge pages follow the memory policy of the thread on the first touch
+      ptr = hostHugeAlloc(size, atomics);
+      if (ptr != nullptr) {
+        break;
+      }
       // We only care about the first CPU node
       for (unsigned int i = 0; i < cpuCount; i++) {
         if ((1u << i) & *nodeMask->maskp) {
@@ -2318,6 +2897,10 @@ bool Device::allowPeerAccess(device::Memory* memory) const {
   }
   if (!p2pAgents().empty()) {
     void* ptr = reinterpret_cast<void*>(memory->virtualAddress());
+    if (subAllocator_ != nullptr) {
+      // ROCr tracks the access of the whole slab
+      ptr = subAllocator_->base(ptr);
+    }
     hsa_agent_t agent = getBackendDevice();
     hsa_status_t stat = hsa_amd_agents_allow_access(1, &agent, nullptr, ptr);
     if (stat != HSA_STATUS_SUCCESS) {
@@ -2328,6 +2911,30 @@ bool Device::allowPeerAccess(device::Memory* memory) const {
   return true;
 }
 
+bool Device::allowPeersAccess(device::Memory* memory,
+                              const std::vector<amd::Device*>& peers) const {
+  if ((memory == nullptr) || peers.empty()) {
+    return false;
+  }
+  void* ptr = reinterpret_cast<void*>(memory->virtualAddress());
+  if (subAllocator_ != nullptr) {
+    // ROCr tracks the access of the whole slab
+    ptr = subAllocator_->base(ptr);
+  }
+  std::vector<hsa_agent_t> agents;
+  agents.reserve(peers.size());
+  for (auto peer : peers) {
+    agents.push_back(static_cast<const Device*>(peer)->getBackendDevice());
+  }
+  // A single update maps the memory to all peers, instead of a page table update per peer
+  hsa_status_t stat = hsa_amd_agents_allow_access(agents.size(), agents.data(), nullptr, ptr);
+  if (stat != HSA_STATUS_SUCCESS) {
+    LogPrintfError("Allow p2p access failed - hsa_amd_agents_allow_access with err: %d", stat);
+    return false;
+  }
+  return true;
+}
+
 uint64_t Device::deviceVmemAlloc(size_t size, uint64_t flags) const {
   hsa_amd_vmem_alloc_handle_t hsa_vmem_handle {};
 
@@ -2387,6 +2994,26 @@ void* Device::deviceLocalAlloc(size_t size, bool atomics, bool pseudo_fine_grain
 }
 
 void Device::memFree(void* ptr, size_t size) const {
+  if ((subAllocator_ != nullptr) && subAllocator_->free(ptr)) {
+    return;
+  }
+#if defined(__linux__)
+  {
+    std::unique_lock<std::mutex> lock(lock_huge_pages_);
+    auto it = hugeAllocs_.find(ptr);
+    if (it != hugeAllocs_.end()) {
+      size_t alloc_size = it->second;
+      hugeAllocs_.erase(it);
+      lock.unlock();
+      if (hsa_amd_memory_unlock(ptr) != HSA_STATUS_SUCCESS) {
+        LogError("Fail unlocking huge page memory");
+      }
+      munmap(ptr, alloc_size);
+      ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Free huge page host memory %p", ptr);
+      return;
+    }
+  }
+#endif  // __linux__
   hsa_status_t stat = hsa_amd_memory_pool_free(ptr);
   ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Free hsa memory %p", ptr);
   if (stat != HSA_STATUS_SUCCESS) {
@@ -2394,24 +3021,67 @@ void Device::memFree(void* ptr, size_t size) const {
   }
 }
 
-void Device::updateFreeMemory(size_t size, bool free) {
-  if (free) {
-    freeMem_ += size;
+void* Device::deviceSubAlloc(size_t size) const {
+  if (subAllocator_ != nullptr && gpuvm_segment_.handle != 0) {
+    void* ptr = subAllocator_->alloc(gpuvm_segment_, size, false);
+    if (ptr != nullptr) {
+      return ptr;
+    }
   }
-  else {
-    if (size > freeMem_) {
-      // To avoid underflow of the freeMem_
-      // This can happen if the free mem tracked is inaccurate, as some allocations can happen
-      // directly via ROCr
-      ClPrint(amd::LOG_ERROR, amd::LOG_ALWAYS,
-             "Free memory set to zero on device 0x%lx, requested size = 0x%zx, freeMem_ = 0x%zx",
-             this, size, freeMem_.load());
-      freeMem_ = 0;
-      return;
+  return deviceLocalAlloc(size);
+}
+
+void* Device::hostSubAlloc(size_t size, MemorySegment mem_seg) const {
+  if (subAllocator_ != nullptr) {
+    const hsa_amd_memory_pool_t& segment =
+        ((mem_seg == MemorySegment::kNoAtomics) && (system_coarse_segment_.handle != 0))
+        ? system_coarse_segment_ : system_segment_;
+    void* ptr = subAllocator_->alloc(segment, size, true);
+    if (ptr != nullptr) {
+      return ptr;
     }
-    freeMem_ -= size;
   }
-  ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Device=0x%lx, freeMem_ = 0x%zx", this, freeMem_.load());
+  return hostAlloc(size, 1, mem_seg);
+}
+
+void Device::updateFreeMemory(size_t size, bool free, MemoryCategory category) {
+  int64_t delta = free ? -static_cast<int64_t>(size) : static_cast<int64_t>(size);
+  int64_t used = usedMem_[category].fetch_add(delta, std::memory_order_relaxed) + delta;
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Device=0x%lx, category %u used = 0x%llx", this,
+          category, static_cast<long long>(used));
+}
+
+// ================================================================================================
+size_t Device::freeMemory() const {
+  uint64_t now = amd::Os::timeNanos();
+  uint64_t last = reconcileTime_.load(std::memory_order_relaxed);
+  const uint64_t period = static_cast<uint64_t>(ROC_MEM_RECONCILE_PERIOD) * 1000000;
+  // A single thread reconciles with KFD, the others use the previous value
+  if (((now - last) >= period) && reconcileTime_.compare_exchange_strong(last, now)) {
+    uint64_t avail = 0;
+    if (HSA_STATUS_SUCCESS == hsa_agent_get_info(bkendDevice_,
+        static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_MEMORY_AVAIL), &avail)) {
+      int64_t accounted = 0;
+      for (const auto& it : usedMem_) {
+        accounted += it.load(std::memory_order_relaxed);
+      }
+      int64_t other = static_cast<int64_t>(info_.globalMemSize_) -
+                      static_cast<int64_t>(avail) - accounted;
+      otherMem_.store(other, std::memory_order_relaxed);
+      ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Device=0x%lx, reconciled free memory 0x%llx, "
+              "other used 0x%llx", this, static_cast<unsigned long long>(avail),
+              static_cast<long long>(other));
+    } else {
+      LogError("HSA_AMD_AGENT_INFO_MEMORY_AVAIL query failed.");
+    }
+  }
+
+  int64_t free = static_cast<int64_t>(info_.globalMemSize_) -
+                 otherMem_.load(std::memory_order_relaxed);
+  for (const auto& it : usedMem_) {
+    free -= it.load(std::memory_order_relaxed);
+  }
+  return static_cast<size_t>(std::max<int64_t>(free, 0));
 }
 
 // ================================================================================================
@@ -2943,6 +3613,15 @@ bool Device::SetClockMode(const cl_set_device_clock_mode_input_amd setClockModeI
   return result;
 }
 
+// ================================================================================================
+bool Device::GetPerfCounterSamples(std::vector<device::PerfCounterSample>* samples) const {
+  if (perfCounterSampler_ == nullptr) {
+    return false;
+  }
+  perfCounterSampler_->GetSamples(samples);
+  return true;
+}
+
 // ================================================================================================
 bool Device::IsHwEventReadyForcedWait(const amd::Event& event) const {
   void* hw_event =
@@ -2973,6 +3652,53 @@ bool Device::IsHwEventReady(const amd::Event& event, bool wait, uint32_t hip_eve
   return (hsa_signal_load_relaxed(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_) == 0);
 }
 
+// ================================================================================================
+bool Device::WaitHwEvents(const std::vector<amd::Event*>& events) const {
+  std::vector<hsa_signal_t> signals;
+  signals.reserve(events.size());
+  for (auto event : events) {
+    void* hw_event =
+        (event->NotifyEvent() != nullptr) ? event->NotifyEvent()->HwEvent() : event->HwEvent();
+    if (hw_event != nullptr) {
+      hsa_signal_t signal = reinterpret_cast<ProfilingSignal*>(hw_event)->signal_;
+      if (hsa_signal_load_relaxed(signal) > 0) {
+        signals.push_back(signal);
+      }
+    }
+  }
+
+  std::vector<hsa_signal_condition_t> conditions(signals.size(), HSA_SIGNAL_CONDITION_LT);
+  std::vector<hsa_signal_value_t> values(signals.size(), kInitSignalValueOne);
+  // Wait actively in the same window as a single signal wait, then with CPU suspend
+  uint64_t timeout = ActiveWait() ? kUnlimitedWait : kTimeout100us;
+  hsa_wait_state_t wait_state = HSA_WAIT_STATE_ACTIVE;
+  while (!signals.empty()) {
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host %s wait for %zu signals",
+            (wait_state == HSA_WAIT_STATE_ACTIVE) ? "active" : "blocked", signals.size());
+    hsa_signal_value_t value = 0;
+    uint32_t index = hsa_amd_signal_wait_any(signals.size(), signals.data(), conditions.data(),
+                                             values.data(), timeout, wait_state, &value);
+    if (index >= signals.size()) {
+      if (wait_state == HSA_WAIT_STATE_BLOCKED) {
+        return false;
+      }
+      wait_state = HSA_WAIT_STATE_BLOCKED;
+      timeout = kUnlimitedWait;
+      continue;
+    }
+    // Drop the satisfied signal and all signals, which completed meanwhile
+    signals.erase(signals.begin() + index);
+    signals.erase(std::remove_if(signals.begin(), signals.end(), [](hsa_signal_t signal) {
+                    return hsa_signal_load_relaxed(signal) < kInitSignalValueOne;
+                  }), signals.end());
+    conditions.resize(signals.size());
+    values.resize(signals.size());
+  }
+  // The multi-wait doesn't have the acquire semantics of hsa_signal_wait_scacquire
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
 // ================================================================================================
 void Device::getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t* end) const {
   void* hw_event = (event.NotifyEvent() != nullptr) ?
@@ -3027,12 +3753,27 @@ hsa_queue_t* Device::getQueueFromPool(const uint qIndex) {
   } else {
     if (qIndex < QueuePriority::Total && queuePool_[qIndex].size() > 0) {
       typedef decltype(queuePool_)::value_type::const_reference PoolRef;
-      auto lowest = std::min_element(
-          queuePool_[qIndex].begin(), queuePool_[qIndex].end(),
-          [](PoolRef A, PoolRef B) { return A.second.refCount < B.second.refCount; });
+      auto lowest = queuePool_[qIndex].begin();
+      if (GPU_HW_QUEUE_LOAD_BALANCE) {
+        // Sample the outstanding packets. The history halves on every selection, so a queue
+        // with the heavy streams stays loaded between the samples
+        for (auto& it : queuePool_[qIndex]) {
+          it.second.load_ = (it.second.load_ >> 1) + queueLoad(it.first);
+        }
+        lowest = std::min_element(
+            queuePool_[qIndex].begin(), queuePool_[qIndex].end(), [](PoolRef A, PoolRef B) {
+              return (A.second.load_ < B.second.load_) ||
+                  ((A.second.load_ == B.second.load_) && (A.second.refCount < B.second.refCount));
+            });
+      } else {
+        lowest = std::min_element(
+            queuePool_[qIndex].begin(), queuePool_[qIndex].end(),
+            [](PoolRef A, PoolRef B) { return A.second.refCount < B.second.refCount; });
+      }
       lowest->second.refCount++;
-      ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Selected queue refCount: %p (%d)",
-              lowest->first->base_address, lowest->second.refCount);
+      ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Selected queue refCount: %p (%d), load %llu",
+              lowest->first->base_address, lowest->second.refCount,
+              static_cast<unsigned long long>(lowest->second.load_));
       return lowest->first;
     }
   }
@@ -3128,7 +3869,10 @@ hsa_queue_t* Device::acquireQueue(uint32_t queue_size_hint, bool coop_queue,
           "size %d with priority %d, cooperative: %i",
           queue, queue->base_address, queue_size, queue_priority, coop_queue);
 
-  hsa_amd_profiling_set_profiler_enabled(queue, 1);
+  // With the timestamp kernel the profiling is enabled on demand, see VirtualGPU::profilingBegin()
+  if (!ROC_TIMESTAMP_KERNEL) {
+    hsa_amd_profiling_set_profiler_enabled(queue, 1);
+  }
   if (cuMask.size() != 0 || info_.globalCUMask_.size() != 0) {
     std::stringstream ss;
     ss << std::hex;
@@ -46,7 +46,10 @@
 #include "hsa/hsa_ven_amd_loader.h"
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -75,6 +78,7 @@ class Memory;
 class Resource;
 class VirtualDevice;
 class PrintfDbg;
+class PerfCounterSampler;
 
 class ProfilingSignal : public amd::ReferenceCountedObject {
 public:
@@ -83,6 +87,7 @@ public:
   HwQueueEngine engine_;  //!< Engine used with this signal
   amd::Monitor  lock_;    //!< Signal lock for update
   bool isPacketDispatch_; //!< True if the packet associated with the signal is dispatch
+  device::KernelStats* kernel_stats_;  //!< Kernel statistics of the sampled dispatch
 
   typedef union {
     struct {
@@ -100,6 +105,7 @@ public:
     , engine_(HwQueueEngine::Compute)
     , lock_(true) /* Signal Ops Lock */
     , isPacketDispatch_(false)
+    , kernel_stats_(nullptr)
     {
       signal_.handle = 0;
       flags_.done_ = true;
@@ -374,6 +380,135 @@ class Device : public NullDevice {
     const Device& gpuDevice_;         //!< GPU device object
   };
 
+  //! Device-wide LRU cache of pinned host ranges for unpinned transfers.
+  //! @note Locked host memory is a userptr allocation in KFD, which follows CPU page table
+  //! changes with MMU notifiers, hence a cached range stays valid after munmap/mmap of the pages
+  class PinCache : public amd::HeapObject {
+   public:
+    PinCache(size_t budget) : budget_(budget), size_(0), lock_(true) {}
+
+    ~PinCache() { flush(); }
+
+    //! Finds a cached range, which covers the host range. The returned object is retained
+    amd::Memory* find(const void* hostMem, size_t size);
+
+    //! Adds a pinned range into the cache, evicting the least recently used ranges
+    void add(amd::Memory* memory);
+
+    //! Releases all cached ranges
+    void flush();
+
+   private:
+    //! Disable copy constructor
+    PinCache(const PinCache&);
+
+    //! Disable assignment operator
+    PinCache& operator=(const PinCache&);
+
+    typedef std::list<amd::Memory*> LruList;
+
+    size_t budget_;   //!< The maximum size of all cached ranges
+    size_t size_;     //!< The current size of all cached ranges
+    LruList lru_;     //!< Cached ranges, the most recently used first
+    std::map<uintptr_t, LruList::iterator> ranges_;  //!< Cached ranges, sorted by host address
+    amd::Monitor lock_; //!< Cache access lock
+  };
+
+  //! Sub-allocator of the small buffers from the slabs of the memory pools. A slab serves a
+  //! single power of two chunk size, hence the chunks are naturally aligned within the slab.
+  //! @note The slabs are 2MB, so ROCr can export a chunk over IPC as a fragment of the slab
+  class SubAllocator : public amd::HeapObject {
+   public:
+    SubAllocator(const Device& device, size_t max_size)
+        : device_(device), max_size_(max_size), lock_(true) {}
+
+    ~SubAllocator();
+
+    //! Allocates a chunk from the slabs of the pool, nullptr if the size isn't sub-allocated
+    void* alloc(const hsa_amd_memory_pool_t& pool, size_t size, bool host);
+
+    //! Frees a chunk, returns false if the pointer doesn't belong to a slab
+    bool free(void* ptr);
+
+    //! Returns the base address of the slab with the chunk, the pointer itself otherwise
+    void* base(void* ptr);
+
+    static constexpr size_t kSlabSize = 2 * Mi;  //!< The slab size
+    static constexpr size_t kMinChunkSize = 256; //!< The minimum chunk size
+
+   private:
+    //! Disable copy constructor
+    SubAllocator(const SubAllocator&);
+
+    //! Disable assignment operator
+    SubAllocator& operator=(const SubAllocator&);
+
+    typedef std::pair<uint64_t, size_t> BinKey;  //!< Pool handle and chunk size
+
+    struct Slab {
+      address base_;                        //!< Base address of the slab
+      BinKey bin_;                          //!< The bin of the slab
+      std::vector<uint32_t> free_;          //!< Indices of the free chunks
+      std::list<Slab*>::iterator partial_;  //!< Position in the list of the partial slabs
+    };
+
+    //! Allocates a new slab from the pool and adds it into the bin
+    Slab* allocSlab(const hsa_amd_memory_pool_t& pool, const BinKey& bin, bool host);
+
+    //! Returns the slab memory into the pool
+    void freeSlab(Slab* slab);
+
+    const Device& device_;  //!< ROC device object
+    size_t max_size_;       //!< The maximum sub-allocated size
+    std::map<uintptr_t, Slab*> slabs_;  //!< All slabs, sorted by base address
+    std::map<BinKey, std::list<Slab*>> partial_;  //!< Slabs with free chunks, per bin
+    amd::Monitor lock_;     //!< Sub-allocator access lock
+  };
+
+  //! Worker pool for the API callbacks, which runs them off the ROCr async handler thread
+  class CallbackExecutor : public amd::HeapObject {
+   public:
+    typedef std::function<void()> Task;
+
+    CallbackExecutor(const Device& device, uint32_t num_threads);
+
+    //! Finishes all queued tasks and stops the worker threads
+    ~CallbackExecutor();
+
+    //! Queues a task. Tasks with the same ordering token run in the submission order,
+    //! tasks with different tokens can run in parallel
+    void enqueue(const void* token, Task&& task);
+
+   private:
+    //! Disable copy constructor
+    CallbackExecutor(const CallbackExecutor&);
+
+    //! Disable assignment operator
+    CallbackExecutor& operator=(const CallbackExecutor&);
+
+    class Worker : public amd::Thread {
+     public:
+      Worker() : amd::Thread("Callback Thread") {}
+
+      //! The worker thread entry point
+      void run(void* data) { static_cast<CallbackExecutor*>(data)->loop(); }
+    };
+
+    //! Starts the worker threads, called with the lock held
+    bool startWorkers();
+
+    //! Processes the tasks until the executor stops
+    void loop();
+
+    const Device& device_;          //!< The device of the callbacks
+    uint32_t num_threads_;          //!< The number of worker threads
+    bool stop_;                     //!< The workers exit once the queues are empty
+    std::vector<Worker*> workers_;  //!< Worker threads
+    std::deque<const void*> ready_; //!< Tokens with pending tasks and without a running task
+    std::unordered_map<const void*, std::deque<Task>> tasks_; //!< Pending tasks per token
+    amd::Monitor lock_;             //!< Queue access lock
+  };
+
   //! Initialise the whole HSA device subsystem (CAL init, device enumeration, etc).
   static bool init();
   static void tearDown();
@@ -384,6 +519,11 @@ class Device : public NullDevice {
   static hsa_status_t iterateCpuMemoryPoolCallback(hsa_amd_memory_pool_t region, void* data);
   static hsa_status_t loaderQueryHostAddress(const void* device, const void** host);
 
+  //! Returns the number of the packets in the HSA queue, which CP didn't read yet
+  static uint64_t queueLoad(hsa_queue_t* queue) {
+    return hsa_queue_load_write_index_relaxed(queue) - hsa_queue_load_read_index_relaxed(queue);
+  }
+
   static bool loadHsaModules();
 
   hsa_agent_t getBackendDevice() const { return bkendDevice_; }
@@ -462,6 +602,7 @@ class Device : public NullDevice {
   bool deviceAllowAccess(void* dst) const;
 
   bool allowPeerAccess(device::Memory* memory) const;
+  bool allowPeersAccess(device::Memory* memory, const std::vector<amd::Device*>& peers) const;
   void deviceVmemRelease(uint64_t mem_handle) const;
   uint64_t deviceVmemAlloc(size_t size, uint64_t flags) const;
   void* deviceLocalAlloc(size_t size, bool atomics = false, bool pseudo_fine_grain=false,
@@ -469,6 +610,11 @@ class Device : public NullDevice {
 
   void memFree(void* ptr, size_t size) const;
 
+  //! Allocates a small coarse grain device buffer or host buffer from the slabs of the
+  //! sub-allocator, falls back to the pool allocation for the sizes above the limit
+  void* deviceSubAlloc(size_t size) const;
+  void* hostSubAlloc(size_t size, MemorySegment mem_seg) const;
+
   virtual void* svmAlloc(amd::Context& context, size_t size, size_t alignment,
                          cl_svm_mem_flags flags = CL_MEM_READ_WRITE, void* svmPtr = nullptr) const;
 
@@ -497,8 +643,10 @@ class Device : public NullDevice {
 
   virtual bool IsHwEventReady(const amd::Event& event, bool wait = false,
                               uint32_t hip_event_flags = 0) const;
+  virtual bool WaitHwEvents(const std::vector<amd::Event*>& events) const;
   virtual bool IsHwEventReadyForcedWait(const amd::Event& event) const;
   virtual void getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t* end) const;
+  virtual bool GetPerfCounterSamples(std::vector<device::PerfCounterSample>* samples) const;
   virtual void ReleaseGlobalSignal(void* signal) const;
 
   //! Allocate host memory in terms of numa policy set by user
@@ -507,6 +655,14 @@ class Device : public NullDevice {
   //! Allocate host memory from agent info
   void* hostAgentAlloc(size_t size, const AgentInfo& agentInfo, bool atomics = false) const;
 
+  //! Allocates pinned host memory, backed with huge pages. Returns nullptr if ROC_HOST_HUGE_PAGES
+  //! is off and the allocation isn't forced, or if the huge pages are unavailable
+  void* hostHugeAlloc(size_t size, bool atomics, bool force = false) const;
+
+  //! First touches the pages of a fresh host range from parallel workers, bound to the NUMA
+  //! node of the device, so the pinning doesn't fault the pages in on the calling thread
+  void touchHostPages(void* ptr, size_t size) const;
+
   //! Returns transfer engine object
   const device::BlitManager& xferMgr() const { return xferQueue()->blitMgr(); }
 
@@ -523,6 +679,12 @@ class Device : public NullDevice {
   //! Returns transfer buffer object
   XferBuffers& xferRead() const { return *xferRead_; }
 
+  //! Returns the cache of pinned host ranges, nullptr if the cache is disabled
+  PinCache* pinCache() const { return pinCache_; }
+
+  //! Returns the worker pool for the API callbacks, nullptr if callbacks run on ROCr thread
+  CallbackExecutor* callbackExecutor() const { return callbackExecutor_; }
+
   //! Returns a ROC memory object from AMD memory object
   roc::Memory* getRocMemory(amd::Memory* mem  //!< Pointer to AMD memory object
                             ) const;
@@ -539,8 +701,27 @@ class Device : public NullDevice {
   // User enabled peer devices
   const bool isP2pEnabled() const { return (enabled_p2p_devices_.size() > 0) ? true : false; }
 
-  // Update the global free memory size
-  void updateFreeMemory(size_t size, bool free);
+  //! Categories of the device memory accounting
+  enum MemoryCategory : uint32_t {
+    kMemUser = 0,       //!< App buffers and images
+    kMemPool,           //!< Buffers of HIP memory pools
+    kMemInternal,       //!< Runtime staging, kernel argument and internal buffers
+    kMemCode,           //!< Loaded code objects
+    kMemCategoryCount
+  };
+
+  //! Updates the used memory of the category on an allocation or a free
+  void updateFreeMemory(size_t size, bool free, MemoryCategory category = kMemUser);
+
+  //! Returns the free memory in bytes from the accounting, without a lock or a kernel query.
+  //! The memory outside of the categories is reconciled with KFD every ROC_MEM_RECONCILE_PERIOD
+  size_t freeMemory() const;
+
+  //! Returns the used memory of the category in bytes
+  size_t usedMemory(MemoryCategory category) const {
+    return static_cast<size_t>(std::max<int64_t>(usedMem_[category].load(
+        std::memory_order_relaxed), 0));
+  }
 
   bool AcquireExclusiveGpuAccess();
   void ReleaseExclusiveGpuAccess(VirtualGPU& vgpu) const;
@@ -592,6 +773,7 @@ class Device : public NullDevice {
   virtual amd::Memory* GetArenaMemObj(const void* ptr, size_t& offset, size_t size = 0);
 
   const uint32_t getPreferredNumaNode() const { return preferred_numa_node_; }
+  virtual void setThreadNumaAffinity() const;
   const bool isFineGrainSupported() const;
 
   //! Returns True if memory pointer is known to ROCr (excludes HMM allocations)
@@ -630,6 +812,8 @@ class Device : public NullDevice {
   uint32_t preferred_numa_node_;
   std::vector<hsa_agent_t> p2p_agents_;  //!< List of P2P agents available for this device
   mutable std::mutex lock_allow_access_; //!< To serialize allow_access calls
+  mutable std::mutex lock_huge_pages_;   //!< Protects the huge page allocations
+  mutable std::unordered_map<void*, size_t> hugeAllocs_;  //!< Huge page allocations and sizes
   hsa_agent_t bkendDevice_;
   uint32_t pciDeviceId_;
   hsa_agent_t* p2p_agents_list_ = nullptr;
@@ -650,7 +834,15 @@ class Device : public NullDevice {
   VirtualGPU* xferQueue_;  //!< Transfer queue, created on demand
 
   XferBuffers* xferRead_;   //!< Transfer buffers read
-  std::atomic<size_t> freeMem_;   //!< Total of free memory available
+  PinCache* pinCache_;      //!< Device-wide cache of pinned host ranges
+  SubAllocator* subAllocator_;  //!< Sub-allocator of the small buffers
+  CallbackExecutor* callbackExecutor_;  //!< Worker pool for the API callbacks
+  PerfCounterSampler* perfCounterSampler_;  //!< Continuous perf counter sampling
+  std::atomic<int64_t> usedMem_[kMemCategoryCount];  //!< Used memory per category
+  //! Memory used outside of the categories: ROCr direct allocations, scratch, other processes.
+  //! It's the difference between KFD and the categories at the last reconcile
+  mutable std::atomic<int64_t> otherMem_;
+  mutable std::atomic<uint64_t> reconcileTime_;  //!< Time of the last reconcile in ns
   mutable amd::Monitor vgpusAccess_;     //!< Lock to serialise virtual gpu list access
   bool hsa_exclusive_gpu_access_;  //!< TRUE if current device was moved into exclusive GPU access mode
   static address mg_sync_;  //!< MGPU grid launch sync memory (SVM location)
@@ -658,12 +850,13 @@ class Device : public NullDevice {
   struct QueueInfo {
     int refCount;
     void* hostcallBuffer_;
+    uint64_t load_ = 0;  //!< Outstanding packets, sampled on the queue selections with a decay
   };
 
   //! a vector for keeping Pool of HSA queues with low, normal and high priorities for recycling
   std::vector<std::map<hsa_queue_t*, QueueInfo>> queuePool_;
 
-  //! returns a hsa queue from queuePool with least refCount and updates the refCount as well
+  //! returns a hsa queue from queuePool with least load or refCount and updates the refCount
   hsa_queue_t* getQueueFromPool(const uint qIndex);
 
   void* coopHostcallBuffer_;
@@ -48,6 +48,10 @@ Memory::Memory(const roc::Device& dev, amd::Memory& owner)
       kind_(MEMORY_KIND_NORMAL),
       amdImageDesc_(nullptr),
       persistent_host_ptr_(nullptr),
+      persistent_mirror_(false),
+      mirror_version_(0),
+      mirror_begin_(0),
+      mirror_end_(0),
       pinnedMemory_(nullptr) {}
 
 Memory::Memory(const roc::Device& dev, size_t size)
@@ -57,6 +61,10 @@ Memory::Memory(const roc::Device& dev, size_t size)
       kind_(MEMORY_KIND_NORMAL),
       amdImageDesc_(nullptr),
       persistent_host_ptr_(nullptr),
+      persistent_mirror_(false),
+      mirror_version_(0),
+      mirror_begin_(0),
+      mirror_end_(0),
       pinnedMemory_(nullptr) {}
 
 Memory::~Memory() {
@@ -120,9 +128,9 @@ void* Memory::allocMapTarget(const amd::Coord3D& origin, const amd::Coord3D& reg
     return (static_cast<char*>(persistent_host_ptr_) + origin[0]);
   }
 
-  // Allocate one if needed.
+  // Allocate one if needed. The persistent mirror keeps the map target between the maps
   if (indirectMapCount_ == 1) {
-    if (!allocateMapMemory(owner()->getSize())) {
+    if ((mapMemory_ == nullptr) && !allocateMapMemory(owner()->getSize())) {
       decIndMapCount();
       DevLogPrintfError("Cannot allocate Map memory for size: %u \n",
                         owner()->getSize());
@@ -161,7 +169,7 @@ void Memory::decIndMapCount() {
   }
 
   // Decrement the counter and release indirect map if it's the last op
-  if (--indirectMapCount_ == 0 && mapMemory_ != nullptr) {
+  if (--indirectMapCount_ == 0 && mapMemory_ != nullptr && !persistent_mirror_) {
     if (!dev().addMapTarget(mapMemory_)) {
       // Release the buffer object containing the map data.
       mapMemory_->release();
@@ -180,12 +188,13 @@ void* Memory::cpuMap(device::VirtualDevice& vDev, uint flags, uint startLayer, u
   // CPU access requires a stall of the current queue
   static_cast<roc::VirtualGPU&>(vDev).releaseGpuMemoryFence();
 
-  if (!isHostMemDirectAccess() && !IsPersistentDirectMap()) {
+  if (!isHostMemDirectAccess() && !IsPersistentDirectMap() && !IsMirrorValid(0, size())) {
     if (!vDev.blitMgr().readBuffer(*this, mapTarget, amd::Coord3D(0), amd::Coord3D(size()), true)) {
       decIndMapCount();
       DevLogError("Cannot read buffer \n");
       return nullptr;
     }
+    ValidateMirror(0, size(), owner()->getVersion());
   }
 
   return mapTarget;
@@ -199,10 +208,34 @@ void Memory::cpuUnmap(device::VirtualDevice& vDev) {
     }
     // Wait on CPU for the transfer
     static_cast<roc::VirtualGPU&>(vDev).releaseGpuMemoryFence();
+    ValidateMirror(0, size(), owner()->getVersion());
   }
   decIndMapCount();
 }
 
+// ================================================================================================
+bool Memory::IsMirrorValid(size_t offset, size_t size) const {
+  return persistent_mirror_ && (mirror_version_ == owner()->getVersion()) &&
+         (offset >= mirror_begin_) && ((offset + size) <= mirror_end_);
+}
+
+// ================================================================================================
+void Memory::ValidateMirror(size_t offset, size_t size, size_t version) {
+  if (!persistent_mirror_) {
+    return;
+  }
+  // A single range is tracked, the ranges are merged if they touch, otherwise the new one wins
+  if ((mirror_version_ == version) && (offset <= mirror_end_) &&
+      (mirror_begin_ <= (offset + size))) {
+    mirror_begin_ = std::min(mirror_begin_, offset);
+    mirror_end_ = std::max(mirror_end_, offset + size);
+  } else {
+    mirror_begin_ = offset;
+    mirror_end_ = offset + size;
+  }
+  mirror_version_ = owner()->getVersion();
+}
+
 // ================================================================================================
 hsa_status_t Memory::interopMapBuffer(int fd) {
   hsa_agent_t agent = dev().getBackendDevice();
@@ -609,13 +642,28 @@ void Memory::mgpuCacheWriteBack(VirtualGPU& gpu) {
 }
 
 // ==================================== roc::Buffer ===============================================
+// Returns the category of the device memory accounting for the buffer
+static Device::MemoryCategory bufferCategory(const amd::Memory* owner) {
+  if ((owner == nullptr) || (owner->getMemFlags() & ROCCLR_MEM_INTERNAL_MEMORY)) {
+    return Device::kMemInternal;
+  }
+  return (owner->getMemFlags() & ROCCLR_MEM_POOL_MEMORY) ? Device::kMemPool : Device::kMemUser;
+}
+
 Buffer::Buffer(const roc::Device& dev, amd::Memory& owner) : roc::Memory(dev, owner) {}
 
 Buffer::Buffer(const roc::Device& dev, size_t size) : roc::Memory(dev, size) {}
 
 Buffer::~Buffer() {
   if (owner() == nullptr) {
+    if ((deviceMemory_ != nullptr) && amd::AllocTrace::Enabled()) {
+      amd::AllocTrace::Record(amd::AllocTrace::kFree, amd::AllocTrace::kInternal, deviceMemory_,
+                              size());
+    }
     dev().memFree(deviceMemory_, size());
+    if ((deviceMemory_ != nullptr) && (kind_ != MEMORY_KIND_HOST)) {
+      const_cast<Device&>(dev()).updateFreeMemory(size(), true, Device::kMemInternal);
+    }
   } else {
     destroy();
 
@@ -681,7 +729,7 @@ void Buffer::destroy() {
 
     if ((deviceMemory_ != nullptr) &&
         (dev().settings().apuSystem_ || !isFineGrain)) {
-      const_cast<Device&>(dev()).updateFreeMemory(size(), true);
+      const_cast<Device&>(dev()).updateFreeMemory(size(), true, bufferCategory(owner()));
     }
 
     return;
@@ -696,14 +744,14 @@ void Buffer::destroy() {
         needUnlockHostMem = true;
       } else {
         dev().memFree(deviceMemory_, size());
-        const_cast<Device&>(dev()).updateFreeMemory(size(), true);
+        const_cast<Device&>(dev()).updateFreeMemory(size(), true, bufferCategory(owner()));
       }
     }
     else {
       if (!(memFlags & (CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR))) {
         dev().memFree(deviceMemory_, size());
         if (dev().settings().apuSystem_) {
-          const_cast<Device&>(dev()).updateFreeMemory(size(), true);
+          const_cast<Device&>(dev()).updateFreeMemory(size(), true, bufferCategory(owner()));
         }
       } else if ((memFlags & CL_MEM_ALLOC_HOST_PTR) &&
                  (owner()->getContext().devices().size() == 1)) {
@@ -735,16 +783,20 @@ bool Buffer::create(bool alloc_local) {
       deviceMemory_ = dev().deviceLocalAlloc(size());
       if (deviceMemory_ != nullptr) {
         flags_ |= HostMemoryDirectAccess;
-        return true;
+        const_cast<Device&>(dev()).updateFreeMemory(size(), false, Device::kMemInternal);
       }
     } else {
       deviceMemory_ = dev().hostAlloc(size(), 1, Device::MemorySegment::kNoAtomics);
       if (deviceMemory_ != nullptr) {
         flags_ |= HostMemoryDirectAccess;
-        return true;
+        kind_ = MEMORY_KIND_HOST;
       }
     }
-    return false;
+    if ((deviceMemory_ != nullptr) && amd::AllocTrace::Enabled()) {
+      amd::AllocTrace::Record(amd::AllocTrace::kAlloc, amd::AllocTrace::kInternal, deviceMemory_,
+                              size());
+    }
+    return (deviceMemory_ != nullptr);
   }
 
   if (owner()->ipcShared()) {
@@ -849,15 +901,28 @@ bool Buffer::create(bool alloc_local) {
           // Disable host access to force blit path for memeory writes.
           flags_ &= ~HostMemoryDirectAccess;
         } else {
-          deviceMemory_ = dev().hostAlloc(size(), 1, ((memFlags & CL_MEM_SVM_ATOMICS) != 0)
-                                                       ? Device::MemorySegment::kAtomics
-                                                       : Device::MemorySegment::kNoAtomics);
+          if (memFlags & ROCCLR_MEM_HUGE_PAGES) {
+            // Falls back to the regular pages, if the huge pages are unavailable
+            deviceMemory_ = dev().hostHugeAlloc(size(), (memFlags & CL_MEM_SVM_ATOMICS) != 0,
+                                                true);
+          }
+          if (deviceMemory_ == nullptr) {
+            deviceMemory_ = dev().hostSubAlloc(size(), ((memFlags & CL_MEM_SVM_ATOMICS) != 0)
+                                                         ? Device::MemorySegment::kAtomics
+                                                         : Device::MemorySegment::kNoAtomics);
+          }
         }
       } else {
         assert(!isHostMemDirectAccess() && "Runtime doesn't support direct access to GPU memory!");
-        deviceMemory_ = dev().deviceLocalAlloc(size(), (memFlags & CL_MEM_SVM_ATOMICS) != 0,
-                                               (memFlags & ROCCLR_MEM_HSA_UNCACHED) != 0,
-                                               (memFlags & ROCCLR_MEM_HSA_CONTIGUOUS) != 0);
+        if ((memFlags & (CL_MEM_SVM_ATOMICS | CL_MEM_VA_RANGE_AMD | ROCCLR_MEM_HSA_UNCACHED |
+                         ROCCLR_MEM_HSA_CONTIGUOUS)) == 0) {
+          // Small coarse grain buffers share the slabs of the sub-allocator
+          deviceMemory_ = dev().deviceSubAlloc(size());
+        } else {
+          deviceMemory_ = dev().deviceLocalAlloc(size(), (memFlags & CL_MEM_SVM_ATOMICS) != 0,
+                                                 (memFlags & ROCCLR_MEM_HSA_UNCACHED) != 0,
+                                                 (memFlags & ROCCLR_MEM_HSA_CONTIGUOUS) != 0);
+        }
       }
       owner()->setSvmPtr(deviceMemory_);
     } else {
@@ -873,7 +938,7 @@ bool Buffer::create(bool alloc_local) {
 
     if ((deviceMemory_ != nullptr) && (dev().settings().apuSystem_ || !isFineGrain)
                                    && (kind_ != MEMORY_KIND_ARENA)) {
-      const_cast<Device&>(dev()).updateFreeMemory(size(), false);
+      const_cast<Device&>(dev()).updateFreeMemory(size(), false, bufferCategory(owner()));
     }
 
     return deviceMemory_ != nullptr;
@@ -949,11 +1014,20 @@ bool Buffer::create(bool alloc_local) {
       owner()->setHostMem(deviceMemory_);
 
       if ((deviceMemory_ != nullptr) && dev().settings().apuSystem_) {
-        const_cast<Device&>(dev()).updateFreeMemory(size(), false);
+        const_cast<Device&>(dev()).updateFreeMemory(size(), false, bufferCategory(owner()));
       }
     }
     else {
-      const_cast<Device&>(dev()).updateFreeMemory(size(), false);
+      const_cast<Device&>(dev()).updateFreeMemory(size(), false, bufferCategory(owner()));
+      if (memFlags & CL_MEM_USE_PERSISTENT_MEM_AMD) {
+        if (dev().info().largeBar_) {
+          // The large BAR exposes the device memory to the CPU, hence map returns the pointer
+          persistent_host_ptr_ = deviceMemory_;
+        } else {
+          // The map target stays with the buffer and the maps copy only the stale ranges
+          persistent_mirror_ = true;
+        }
+      }
     }
 
     assert(amd::isMultipleOf(deviceMemory_, static_cast<size_t>(dev().info().memBaseAddrAlign_)));
@@ -1346,6 +1420,7 @@ bool Image::createView(const Memory& parent) {
     status = hsa_ext_image_create_with_layout(
              dev().getBackendDevice(), &imageDescriptor_, deviceMemory_, permission_,
              HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR, rowPitch, 0, &hsaImageObject_);
+    linearRowPitch_ = rowPitch;
 
     if (!amd::IS_HIP && dev().settings().imageBufferWar_ &&
         ((ownerImage.getWidth() * ownerImage.getImageFormat().getElementSize()) <
@@ -1414,6 +1489,30 @@ bool Image::createView(const Memory& parent) {
   return true;
 }
 
+size_t Image::DeviceImageSize() const {
+  // The allocation size includes the alignment if the allocator couldn't align the memory
+  return (deviceImageInfo_.alignment <= dev().alloc_granularity())
+      ? deviceImageInfo_.size
+      : deviceImageInfo_.size - deviceImageInfo_.alignment;
+}
+
+bool Image::IsSameLayout(const Image& image) const {
+  // Views and interop images may not own the whole layout of the allocation
+  if ((owner()->parent() != nullptr) || (image.owner()->parent() != nullptr) ||
+      owner()->isInterop() || image.owner()->isInterop() ||
+      (owner()->asImage()->getMipLevels() > 1) || (image.owner()->asImage()->getMipLevels() > 1)) {
+    return false;
+  }
+  const hsa_ext_image_descriptor_t& desc = image.imageDescriptor_;
+  return (imageDescriptor_.geometry == desc.geometry) && (imageDescriptor_.width == desc.width) &&
+      (imageDescriptor_.height == desc.height) && (imageDescriptor_.depth == desc.depth) &&
+      (imageDescriptor_.array_size == desc.array_size) &&
+      (imageDescriptor_.format.channel_type == desc.format.channel_type) &&
+      (imageDescriptor_.format.channel_order == desc.format.channel_order) &&
+      (permission_ == image.permission_) && (deviceImageInfo_.size == image.deviceImageInfo_.size) &&
+      (deviceImageInfo_.alignment == image.deviceImageInfo_.alignment);
+}
+
 void* Image::allocMapTarget(const amd::Coord3D& origin, const amd::Coord3D& region, uint mapFlags,
                             size_t* rowPitch, size_t* slicePitch) {
   amd::ScopedLock lock(owner()->lockMemoryOps());
@@ -117,6 +117,16 @@ class Memory : public device::Memory {
 
   void* PersistentHostPtr() const { return persistent_host_ptr_; }
 
+  //! Returns true if the map target is kept between the maps as a mirror of the device memory
+  bool IsPersistentMirror() const { return persistent_mirror_; }
+
+  //! Returns true if the persistent mirror holds the current data of the range
+  bool IsMirrorValid(size_t offset, size_t size) const;
+
+  //! Marks the range of the mirror current. The previous valid range is kept, if the owner
+  //! version was \a version, when the mirror was updated
+  void ValidateMirror(size_t offset, size_t size, size_t version);
+
   //! Validates allocated memory for possible workarounds
   virtual bool ValidateMemory() { return true; }
 
@@ -151,6 +161,11 @@ class Memory : public device::Memory {
 
   void* persistent_host_ptr_;  //!< Host accessible pointer for persistent memory
 
+  bool persistent_mirror_;   //!< The map target is a persistent mirror
+  size_t mirror_version_;    //!< The owner version, the mirror range is current for
+  size_t mirror_begin_;      //!< The start of the mirror range with the current data
+  size_t mirror_end_;        //!< The end of the mirror range with the current data
+
  private:
   // Disable copy constructor
   Memory(const Memory&);
@@ -223,6 +238,16 @@ class Image : public roc::Memory {
 
   amd::Image* CopyImageBuffer() const { return copyImageBuffer_; }
 
+  //! Returns the row pitch of an image view of a buffer, 0 if the image has a tiled layout
+  size_t LinearRowPitch() const { return linearRowPitch_; }
+
+  //! Returns the size of the image data from the aligned device address
+  size_t DeviceImageSize() const;
+
+  //! Returns true if the raw data of both images has the same layout, hence a copy of the whole
+  //! image can move the bytes without the image instructions
+  bool IsSameLayout(const Image& image) const;
+
   virtual uint64_t originalDeviceAddress() const { return reinterpret_cast<uint64_t>(originalDeviceMemory_); }
 
   //! Adds an image view to the view cache for the fast blit manager operations
@@ -253,6 +278,7 @@ class Image : public roc::Memory {
 
   void* originalDeviceMemory_;
   amd::Image* copyImageBuffer_ = nullptr;
+  size_t linearRowPitch_ = 0;             //!< Row pitch of the linear layout in bytes
   std::vector<amd::Image*>  view_cache_;  //!< Cache of views for fast access
 };
 }
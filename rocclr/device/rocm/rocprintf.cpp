@@ -27,9 +27,11 @@
 #include "device/rocm/rocprogram.hpp"
 #include "device/rocm/rocdevice.hpp"
 #include "device/rocm/rocprintf.hpp"
+#include "device/rocm/rocvirtual.hpp"
 #include <cstdio>
 #include <algorithm>
 #include <cmath>
+#include <deque>
 
 // Functions defined in devhcprintf.cpp
 namespace amd {
@@ -41,12 +43,152 @@ bool populateFormatStringHashMap(
 
 namespace amd::roc {
 
+//! Formats the buffers of the printf rings on a host thread once their dispatches complete.
+//! One drainer serves all queues, the buffers of a queue drain in the submission order
+class PrintfDrainer : public amd::HeapObject {
+ public:
+  //! Queues the current buffer of the printf object
+  static void Enqueue(PrintfDbg* owner, uint slot, ProfilingSignal* signal,
+                      const std::vector<device::PrintfInfo>& printfInfo) {
+    PrintfDrainer& drainer = get();
+    // Keep the signal alive, so the queue replaces it instead of resetting it for a reuse
+    signal->retain();
+    amd::ScopedLock lock(drainer.lock_);
+    drainer.jobs_.push_back({owner, slot, signal, printfInfo});
+    if ((drainer.worker_ == nullptr) && !drainer.start()) {
+      // Drain in place if the thread can't start
+      drainer.lock_.unlock();
+      drainer.drain();
+      drainer.lock_.lock();
+      return;
+    }
+    drainer.lock_.notify();
+  }
+
+ private:
+  struct Job {
+    PrintfDbg* owner_;                               //!< The printf object of the buffer
+    uint slot_;                                      //!< The buffer in the ring
+    ProfilingSignal* signal_;                        //!< Completion signal of the dispatch
+    std::vector<device::PrintfInfo> printfInfo_;     //!< Format strings of the kernel
+  };
+
+  class Worker : public amd::Thread {
+   public:
+    Worker() : amd::Thread("Printf Drainer Thread") {}
+
+    //! The drainer thread entry point
+    void run(void* data) { static_cast<PrintfDrainer*>(data)->loop(); }
+  };
+
+  PrintfDrainer() : worker_(nullptr), lock_(true) {}
+
+  //! The drainer lives until the process exits, since the queues can drain at any time
+  static PrintfDrainer& get() {
+    static PrintfDrainer* drainer = new PrintfDrainer();
+    return *drainer;
+  }
+
+  //! Starts the worker thread, called with the lock held
+  bool start() {
+    Worker* worker = new Worker();
+    if ((worker == nullptr) || (worker->state() < amd::Thread::INITIALIZED)) {
+      delete worker;
+      return false;
+    }
+    worker_ = worker;
+    worker_->start(this);
+    return true;
+  }
+
+  //! Formats the queued buffers
+  void drain() {
+    while (true) {
+      Job job;
+      {
+        amd::ScopedLock lock(lock_);
+        if (jobs_.empty()) {
+          return;
+        }
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      BlockedWaitForSignal(job.signal_->signal_);
+      job.signal_->release();
+      job.owner_->parse(job.owner_->ring_ + job.slot_ * job.owner_->dbgBuffer_size_,
+                        job.printfInfo_);
+      job.owner_->releaseSlot(job.slot_);
+    }
+  }
+
+  void loop() {
+    amd::ScopedLock lock(lock_);
+    while (true) {
+      if (jobs_.empty()) {
+        lock_.wait();
+        continue;
+      }
+      lock_.unlock();
+      drain();
+      lock_.lock();
+    }
+  }
+
+  Worker* worker_;          //!< Drainer thread, started with the first buffer
+  std::deque<Job> jobs_;    //!< Buffers in the submission order
+  amd::Monitor lock_;       //!< Jobs access lock
+};
+
 PrintfDbg::PrintfDbg(Device& device, FILE* file)
-    : dbgBuffer_(nullptr), dbgBuffer_size_(0), dbgFile_(file), gpuDevice_(device) {}
+    : dbgBuffer_(nullptr), dbgBuffer_size_(0), dbgFile_(file), gpuDevice_(device),
+      ring_(nullptr), current_(0), busy_{} {}
+
+PrintfDbg::~PrintfDbg() {
+  if (ring()) {
+    waitDrained();
+    dev().hostFree(ring_, dbgBuffer_size_ * kRingSlots);
+  } else {
+    dev().hostFree(dbgBuffer_, dbgBuffer_size_);
+  }
+}
 
-PrintfDbg::~PrintfDbg() { dev().hostFree(dbgBuffer_, dbgBuffer_size_); }
+void PrintfDbg::releaseSlot(uint slot) {
+  amd::ScopedLock lock(slotsLock_);
+  busy_[slot] = false;
+  slotsLock_.notifyAll();
+}
+
+void PrintfDbg::waitDrained() {
+  if (!ring()) {
+    return;
+  }
+  amd::ScopedLock lock(slotsLock_);
+  for (uint i = 0; i < kRingSlots; ++i) {
+    while (busy_[i]) {
+      slotsLock_.wait();
+    }
+  }
+}
 
 bool PrintfDbg::allocate(bool realloc) {
+  if ((nullptr == dbgBuffer_) && (ROC_PRINTF_RING_SIZE != 0)) {
+    // Every dispatch gets a slice of the ring, at least the size of the synchronous buffer
+    dbgBuffer_size_ = std::max(dev().info().printfBufferSize_,
+                               amd::alignUp(static_cast<size_t>(ROC_PRINTF_RING_SIZE) * Mi /
+                                            kRingSlots, sizeof(void*)));
+    ring_ = reinterpret_cast<address>(dev().hostAlloc(dbgBuffer_size_ * kRingSlots,
+                                                      sizeof(void*)));
+    if (ring_ == nullptr) {
+      LogWarning("Couldn't allocate the printf ring, the printf output is synchronous");
+      dbgBuffer_size_ = 0;
+    } else {
+      dbgBuffer_ = ring_;
+      return true;
+    }
+  }
+  if (ring()) {
+    return true;
+  }
   if (nullptr == dbgBuffer_) {
     dbgBuffer_size_ = dev().info().printfBufferSize_;
     dbgBuffer_ = reinterpret_cast<address>(dev().hostAlloc(dbgBuffer_size_, sizeof(void*)));
@@ -396,6 +538,15 @@ bool PrintfDbg::init(bool printfEnabled) {
     if (!allocate()) {
       return false;
     }
+    if (ring()) {
+      // Take the next buffer of the ring, the wait applies only if the host falls behind
+      amd::ScopedLock lock(slotsLock_);
+      current_ = (current_ + 1) % kRingSlots;
+      while (busy_[current_]) {
+        slotsLock_.wait();
+      }
+      dbgBuffer_ = ring_ + current_ * dbgBuffer_size_;
+    }
 
     // The first two DWORDs in the printf buffer are as follows:
     // First DWORD = Offset to where next information is to
@@ -421,115 +572,132 @@ bool PrintfDbg::init(bool printfEnabled) {
 }
 
 bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
-                       const std::vector<device::PrintfInfo>& printfInfo) {
+                       const std::vector<device::PrintfInfo>& printfInfo, bool async) {
   if (printfEnabled) {
-    uint32_t offsetSize = 0;
+    if (async) {
+      // The drainer formats the buffer once the completion signal of the dispatch goes down
+      ProfilingSignal* signal = gpu.Barriers().GetLastSignal();
+      gpu.FlushDoorbell();
+      {
+        amd::ScopedLock lock(slotsLock_);
+        busy_[current_] = true;
+      }
+      PrintfDrainer::Enqueue(this, current_, signal, printfInfo);
+      return true;
+    }
 
     // Wait until outstanding kernels finish
     gpu.releaseGpuMemoryFence();
+    return parse(dbgBuffer_, printfInfo);
+  }
 
-    // Get memory pointer to the staged buffer
-    uint32_t* dbgBufferPtr = reinterpret_cast<uint32_t*>(dbgBuffer_);
-    if (nullptr == dbgBufferPtr) {
-      return false;
-    }
-
-    offsetSize = *dbgBufferPtr;
+  return true;
+}
 
-    if (offsetSize == 0) {
-      return true;
-    }
+bool PrintfDbg::parse(address buffer, const std::vector<device::PrintfInfo>& printfInfo) {
+  uint32_t offsetSize = 0;
 
-    // Get a pointer to the buffer data
-    dbgBufferPtr = reinterpret_cast<uint32_t*>(dbgBuffer_ + 2 * sizeof(uint32_t));
-    if (nullptr == dbgBufferPtr) {
-      return false;
-    }
+  // Get memory pointer to the staged buffer
+  uint32_t* dbgBufferPtr = reinterpret_cast<uint32_t*>(buffer);
+  if (nullptr == dbgBufferPtr) {
+    return false;
+  }
 
-    uint sb = 0;
-    uint sbt = 0;
+  offsetSize = *dbgBufferPtr;
 
-    // Handle HIP nonhostcall printf here, However longterm goal
-    // should be to have common implementation for both HIP and OpenCL
-    if (amd::IS_HIP) {
-      // Map between 64 bit MD5 format string hash and
-      // actual format string
-      std::map<uint64_t, std::string> StrMap;
+  if (offsetSize == 0) {
+    return true;
+  }
 
-      auto BufferForHIP = reinterpret_cast<uint32_t*>(dbgBufferPtr);
+  // Get a pointer to the buffer data
+  dbgBufferPtr = reinterpret_cast<uint32_t*>(buffer + 2 * sizeof(uint32_t));
+  if (nullptr == dbgBufferPtr) {
+    return false;
+  }
 
-      // Populate string map with hashes and actual
-      // format strings.
-      if(!amd::populateFormatStringHashMap(printfInfo, StrMap))
-        return false;
+  uint sb = 0;
+  uint sbt = 0;
 
-      while (sbt < offsetSize)
-      {
-        auto controlDword = *BufferForHIP++;
-        auto PB = (uint64_t*)BufferForHIP;
-
-        uint64_t nextOffset  = controlDword >> 2;
-
-        std::vector<uint8_t> PBuffer;
-        uint64_t BufferLen = 0;
-        if (controlDword & 2U) {
-          // Process the contsant format string case.
-          // The first value is the 64 bit format string hash
-          // and remaining values are printf arguments.
-          // Construct a temporary buffer with actual format
-          // string followed by arguments. The format string is
-          // obtained by querying StrMap populated before.
-          auto ArgsLen = nextOffset - 12;
-          auto Str = StrMap[*PB++];
-          auto StrLenWithNull = Str.size() + 1;
-          BufferLen = ArgsLen + amd::alignUp(StrLenWithNull, sizeof(uint64_t));
-          PBuffer.resize(BufferLen);
-          memcpy(PBuffer.data(), Str.c_str(), StrLenWithNull);
-          memset(PBuffer.data() + Str.size(), 0, 8 - (StrLenWithNull % 8 ));
-          memcpy(PBuffer.data() + amd::alignUp(StrLenWithNull, sizeof(uint64_t)),
-          PB, ArgsLen);
-        }
-        else {
-            // Process Non constant format string case.
-            // Here, The buffer itself contains the actual
-            // format string and hence just copy the contents
-            // of format string and arguments into a temporary
-            // buffer
-            BufferLen = nextOffset - /*ControlDWord*/4;
-            PBuffer.resize(BufferLen);
-            memcpy(PBuffer.data(), BufferForHIP, nextOffset);
-        }
+  // Handle HIP nonhostcall printf here, However longterm goal
+  // should be to have common implementation for both HIP and OpenCL
+  if (amd::IS_HIP) {
+    // Map between 64 bit MD5 format string hash and
+    // actual format string
+    std::map<uint64_t, std::string> StrMap;
 
-        // Handle printing
-        amd::handlePrintfDelayed((uint64_t*)PBuffer.data(), BufferLen / 8,
-                            controlDword);
-        BufferForHIP += (nextOffset / 4) - /*ControlDWord*/1;
-        sbt += nextOffset;
-      }
+    auto BufferForHIP = reinterpret_cast<uint32_t*>(dbgBufferPtr);
 
-      return true;
-    }
+    // Populate string map with hashes and actual
+    // format strings.
+    if(!amd::populateFormatStringHashMap(printfInfo, StrMap))
+      return false;
 
-    // parse the debug buffer
-    while (sbt < offsetSize) {
-      if (*dbgBufferPtr >= printfInfo.size()) {
-        LogError("Couldn't find the reported PrintfID!");
-        return false;
+    while (sbt < offsetSize)
+    {
+      auto controlDword = *BufferForHIP++;
+      auto PB = (uint64_t*)BufferForHIP;
+
+      uint64_t nextOffset  = controlDword >> 2;
+
+      std::vector<uint8_t> PBuffer;
+      uint64_t BufferLen = 0;
+      if (controlDword & 2U) {
+        // Process the contsant format string case.
+        // The first value is the 64 bit format string hash
+        // and remaining values are printf arguments.
+        // Construct a temporary buffer with actual format
+        // string followed by arguments. The format string is
+        // obtained by querying StrMap populated before.
+        auto ArgsLen = nextOffset - 12;
+        auto Str = StrMap[*PB++];
+        auto StrLenWithNull = Str.size() + 1;
+        BufferLen = ArgsLen + amd::alignUp(StrLenWithNull, sizeof(uint64_t));
+        PBuffer.resize(BufferLen);
+        memcpy(PBuffer.data(), Str.c_str(), StrLenWithNull);
+        memset(PBuffer.data() + Str.size(), 0, 8 - (StrLenWithNull % 8 ));
+        memcpy(PBuffer.data() + amd::alignUp(StrLenWithNull, sizeof(uint64_t)),
+        PB, ArgsLen);
       }
-      const device::PrintfInfo& info = printfInfo[(*dbgBufferPtr)];
-      sb += sizeof(uint32_t);
-      for (const auto& ita : info.arguments_) {
-        sb += ita;
+      else {
+          // Process Non constant format string case.
+          // Here, The buffer itself contains the actual
+          // format string and hence just copy the contents
+          // of format string and arguments into a temporary
+          // buffer
+          BufferLen = nextOffset - /*ControlDWord*/4;
+          PBuffer.resize(BufferLen);
+          memcpy(PBuffer.data(), BufferForHIP, nextOffset);
       }
 
-      size_t idx = 1;
-      // There's something in the debug buffer
-      outputDbgBuffer(info, dbgBufferPtr, idx);
+      // Handle printing
+      amd::handlePrintfDelayed((uint64_t*)PBuffer.data(), BufferLen / 8,
+                          controlDword);
+      BufferForHIP += (nextOffset / 4) - /*ControlDWord*/1;
+      sbt += nextOffset;
+    }
+
+    return true;
+  }
 
-      sbt += sb;
-      dbgBufferPtr += sb / sizeof(uint32_t);
-      sb = 0;
+  // parse the debug buffer
+  while (sbt < offsetSize) {
+    if (*dbgBufferPtr >= printfInfo.size()) {
+      LogError("Couldn't find the reported PrintfID!");
+      return false;
+    }
+    const device::PrintfInfo& info = printfInfo[(*dbgBufferPtr)];
+    sb += sizeof(uint32_t);
+    for (const auto& ita : info.arguments_) {
+      sb += ita;
     }
+
+    size_t idx = 1;
+    // There's something in the debug buffer
+    outputDbgBuffer(info, dbgBufferPtr, idx);
+
+    sbt += sb;
+    dbgBufferPtr += sb / sizeof(uint32_t);
+    sb = 0;
   }
 
   return true;
@@ -47,12 +47,16 @@ namespace amd::roc {
 class Kernel;
 class VirtualGPU;
 class Device;
+class PrintfDrainer;
 
 class PrintfDbg : public amd::HeapObject {
  public:
   //! Debug buffer size per workitem
   static constexpr uint WorkitemDebugSize = 4096;
 
+  //! Number of the buffers in the printf ring
+  static constexpr uint kRingSlots = 8;
+
   //! constructor
   PrintfDbg(Device& device, FILE* file = nullptr);
 
@@ -66,21 +70,41 @@ class PrintfDbg : public amd::HeapObject {
   //! Prints the kernel's debug informaiton from the buffer
   bool output(VirtualGPU& gpu,
               bool printfEnabled,                        //!< checks for printf
-              const std::vector<device::PrintfInfo>& printfInfo  //!< printf info
+              const std::vector<device::PrintfInfo>& printfInfo,  //!< printf info
+              bool async = false  //!< Drain on the host thread after the dispatch completion
               );
 
   //! Returns debug buffer object
   address dbgBuffer() const { return dbgBuffer_; }
 
+  //! Returns TRUE if the dispatches take the buffers from the printf ring
+  bool ring() const { return ring_ != nullptr; }
+
+  //! Waits until the host drained all buffers of the ring
+  void waitDrained();
+
  protected:
   address dbgBuffer_;      //!< Buffer to hold debug output
   size_t dbgBuffer_size_;  //!< Size of the debugger buffer
   FILE* dbgFile_;          //!< Debug file
   Device& gpuDevice_;      //!< GPU device object
 
+  address ring_;                 //!< Printf ring with kRingSlots buffers, nullptr if disabled
+  uint current_;                 //!< The ring buffer of the current dispatch
+  bool busy_[kRingSlots];        //!< The ring buffers, waiting for the drain
+  amd::Monitor slotsLock_;       //!< Ring state lock
+
   //! Gets GPU device object
   Device& dev() const { return gpuDevice_; }
 
+  //! Prints the records in the debug buffer
+  bool parse(address buffer,                                   //!< Debug buffer
+             const std::vector<device::PrintfInfo>& printfInfo  //!< printf info
+             );
+
+  //! Returns a drained buffer into the ring
+  void releaseSlot(uint slot);
+
   //! Allocates the debug buffer
   bool allocate(bool realloc = false  //!< If TRUE then reallocate the debug memory
                 );
@@ -113,6 +137,8 @@ class PrintfDbg : public amd::HeapObject {
                        ) const;
 
  private:
+  friend class PrintfDrainer;
+
   //! Disable copy constructor
   PrintfDbg(const PrintfDbg&);
 
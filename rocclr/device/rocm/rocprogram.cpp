@@ -24,6 +24,7 @@
 
 #include "utils/options.hpp"
 #include "rockernel.hpp"
+#include "platform/trace_events.hpp"
 
 #include "hsa/amd_hsa_kernel_code.h"
 
@@ -50,13 +51,17 @@ Program::~Program() {
   if (hsaExecutable_.handle != 0) {
     hsa_executable_destroy(hsaExecutable_);
   }
+  if (codeSize_ != 0) {
+    const_cast<Device&>(rocDevice()).updateFreeMemory(codeSize_, true, Device::kMemCode);
+  }
   if (hsaCodeObjectReader_.handle != 0) {
     hsa_code_object_reader_destroy(hsaCodeObjectReader_);
   }
   releaseClBinary();
 }
 
-Program::Program(roc::NullDevice& device, amd::Program& owner) : device::Program(device, owner) {
+Program::Program(roc::NullDevice& device, amd::Program& owner)
+    : device::Program(device, owner), codeSize_(0) {
   hsaExecutable_.handle = 0;
   hsaCodeObjectReader_.handle = 0;
 }
@@ -268,8 +273,10 @@ bool LightningProgram::createKernels(void* binary, size_t binSize, bool useUnifo
     return false;
   }
 
+  OpenKernelMetadataCache(binary, binSize);
+  kernels().reserve(kernelMetadataMap_.size());
   for (const auto &kernelMeta : kernelMetadataMap_) {
-    const std::string kernelName = kernelMeta.first;
+    const std::string& kernelName = kernelMeta.first;
     Kernel* aKernel = new roc::LightningKernel(kernelName, this);
     if (!aKernel->init()) {
       return false;
@@ -280,6 +287,7 @@ bool LightningProgram::createKernels(void* binary, size_t binSize, bool useUnifo
     aKernel->setInternalKernelFlag(internalKernel);
     kernels()[kernelName] = aKernel;
   }
+  CloseKernelMetadataCache();
   return true;
 }
 
@@ -291,6 +299,7 @@ bool LightningProgram::setKernels(void* binary, size_t binSize,
   if (!device().isOnline()) {
     return true;
   }
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Load, "LoadCodeObject");
 
   hsa_agent_t agent = rocDevice().getBackendDevice();
   hsa_status_t status;
@@ -323,6 +332,9 @@ bool LightningProgram::setKernels(void* binary, size_t binSize,
     buildLog_ += "\n";
     return false;
   }
+  // The loaded segments are close to the code object size, KFD reconcile covers the difference
+  codeSize_ = binSize;
+  const_cast<Device&>(rocDevice()).updateFreeMemory(codeSize_, false, Device::kMemCode);
 
   // Freeze the executable.
   status = hsa_executable_freeze(hsaExecutable_, nullptr);
@@ -84,6 +84,7 @@ protected:
   /* HSA executable */
   hsa_executable_t hsaExecutable_;               //!< Handle to HSA executable
   hsa_code_object_reader_t hsaCodeObjectReader_; //!< Handle to HSA code reader
+  size_t codeSize_;                              //!< Accounted size of the loaded code
 };
 
 class HSAILProgram : public roc::Program {
@@ -21,6 +21,7 @@
 #ifndef WITHOUT_HSA_BACKEND
 
 #include "top.hpp"
+#include <limits>
 #include "os/os.hpp"
 #include "device/device.hpp"
 #include "rocsettings.hpp"
@@ -97,6 +98,8 @@ Settings::Settings() {
   kernel_arg_impl_ = KernelArgImpl::HostKernelArgs;
   gwsInitSupported_ = true;
   limit_blit_wg_ = 16;
+  blit_wg_per_cu_ = 1;
+  blit_nt_threshold_ = std::numeric_limits<size_t>::max();
 }
 
 // ================================================================================================
@@ -110,6 +113,8 @@ bool Settings::create(bool fullProfile, const amd::Isa& isa,
 
   customHostAllocator_ = false;
 
+  setXferTuning(isa.processorName());
+
   if (fullProfile) {
     pinnedXferSize_ = 0;
     stagedXferSize_ = 0;
@@ -192,6 +197,8 @@ bool Settings::create(bool fullProfile, const amd::Isa& isa,
     gwsInitSupported_ = false;
   }
 
+  setBlitTuning(isa);
+
   // Override current device settings
   override();
 
@@ -239,6 +246,59 @@ void Settings::override() {
   }
 }
 
+// ================================================================================================
+void Settings::setBlitTuning(const amd::Isa& isa) {
+  // Blit launch parameters for the ASICs with the large memory bandwidth. More than one
+  // workgroup per CU hides the memory latency of the dwordx4 grid-stride loops, and
+  // transfers much larger than the last level cache bypass it with non-temporal accesses.
+  struct BlitTuning {
+    uint32_t major_;          //!< GFX IP major version
+    uint32_t minor_;          //!< GFX IP minor version
+    uint32_t stepping_;       //!< GFX IP stepping
+    uint32_t wg_per_cu_;      //!< Blit workgroups per compute unit
+    size_t nt_threshold_mb_;  //!< Non-temporal access threshold in MB
+  };
+  static constexpr BlitTuning kBlitTuning[] = {
+    {9, 0, 10, 2,  32},   // gfx90a
+    {9, 4,  0, 2, 256},   // gfx940
+    {9, 4,  1, 2, 256},   // gfx941
+    {9, 4,  2, 2, 256},   // gfx942
+  };
+
+  for (const auto& tuning : kBlitTuning) {
+    if (isa.versionMajor() == tuning.major_ && isa.versionMinor() == tuning.minor_ &&
+        isa.versionStepping() == tuning.stepping_) {
+      blit_wg_per_cu_ = tuning.wg_per_cu_;
+      blit_nt_threshold_ = tuning.nt_threshold_mb_ * Mi;
+      break;
+    }
+  }
+
+  if (ROC_BLIT_NT_SIZE != 0) {
+    blit_nt_threshold_ = static_cast<size_t>(ROC_BLIT_NT_SIZE) * Mi;
+  }
+}
+
+// ================================================================================================
+void Settings::setXferTuning(const std::string& processor) {
+  const device::XferTuning* tuning = device::XferTuning::Find(processor);
+  if (tuning == nullptr) {
+    return;
+  }
+  if ((tuning->pinnedXferSize_ != 0) && flagIsDefault(GPU_PINNED_XFER_SIZE)) {
+    pinnedXferSize_ = tuning->pinnedXferSize_;
+  }
+  if ((tuning->pinnedMinXferSize_ != 0) && flagIsDefault(GPU_PINNED_MIN_XFER_SIZE)) {
+    pinnedMinXferSize_ = tuning->pinnedMinXferSize_;
+  }
+  if ((tuning->stagedXferSize_ != 0) && flagIsDefault(GPU_STAGING_BUFFER_SIZE)) {
+    stagedXferSize_ = tuning->stagedXferSize_;
+  }
+  if ((tuning->blitCopySize_ != 0) && flagIsDefault(GPU_FORCE_BLIT_COPY_SIZE)) {
+    sdmaCopyThreshold_ = tuning->blitCopySize_;
+  }
+}
+
 // ================================================================================================
 void Settings::setKernelArgImpl(const amd::Isa& isa, bool isXgmi, bool hasValidHDPFlush) {
 
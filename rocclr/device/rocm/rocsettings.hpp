@@ -76,6 +76,8 @@ class Settings : public device::Settings {
 
   uint32_t  hmmFlags_;        //!< HMM functionality control flags
   uint32_t  limit_blit_wg_;   //!< The number of workgroups for blit execution
+  uint32_t  blit_wg_per_cu_;  //!< The number of blit workgroups per compute unit
+  size_t    blit_nt_threshold_; //!< Use non-temporal blit accesses above this size
 
   //! Default constructor
   Settings();
@@ -95,6 +97,12 @@ class Settings : public device::Settings {
   //! Overrides current settings based on registry/environment
   void override();
 
+  //! Selects the blit kernel launch tuning for the ASIC
+  void setBlitTuning(const amd::Isa& isa);
+
+  //! Takes the transfer defaults from the tuning table entry of the processor
+  void setXferTuning(const std::string& processor);
+
   //! Determine how kernel arguments should be implemented given ASIC (host
   //! memory, device memory, device memory with memory ordering workaround)
   void setKernelArgImpl(const amd::Isa& isa, bool isXgmi, bool hasValidHDPFlush);
@@ -158,6 +158,13 @@ void Timestamp::checkGpuTime() {
         start = std::min(time.start, start);
         end = std::max(time.end, end);
 
+        if (amd::TraceEvents::enabled()) {
+          amd::TraceEvents::recordGpu(
+              amd::activity_prof::getOclCommandKindString(command().type()),
+              time.start * ticksToTime_, time.end * ticksToTime_, gpu()->dev().index(),
+              gpu()->index(), it->engine_ != HwQueueEngine::Compute);
+        }
+
         if ((command().type() == CL_COMMAND_TASK) && (it->isPacketDispatch_ == true)) {
           static_cast<amd::AccumulateCommand&>(command()).addTimestamps(time.start, time.end);
         }
@@ -232,6 +239,19 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
   auto gpu = ts->gpu();
   gpu->QueuedAsyncHandlers()--;
 
+  // Run API callbacks on the worker pool, so the callbacks on the different queues don't wait
+  // for each other on ROCr thread. The queue remains blocked by the callback signal until the
+  // callback is done and the callbacks on the same queue run in order
+  auto executor = gpu->dev().callbackExecutor();
+  if ((callback_signal.handle != 0) && (executor != nullptr)) {
+    executor->enqueue(gpu, [gpu, ts, callback_signal]() {
+      gpu->setLastUsedSdmaEngine(0);
+      gpu->updateCommandsState(ts->command().GetBatchHead());
+      hsa_signal_subtract_relaxed(callback_signal, 1);
+    });
+    return false;
+  }
+
   // Reset last used SDMA engine mask
   gpu->setLastUsedSdmaEngine(0);
 
@@ -249,24 +269,13 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
 
 // ================================================================================================
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
-  if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
-    maxMemObjectsInQueue_ = numMemObj;
-  }
-
+  ranges_.create(numMemObj);
   return true;
 }
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
-  bool flushL1Cache = false;
-
-  if (maxMemObjectsInQueue_ == 0) {
+  if (ranges_.maxRanges() == 0) {
     // Sync AQL packets
     gpu.setAqlHeader(gpu.dispatchPacketHeader_);
     return;
@@ -275,29 +284,13 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   uint64_t curStart = reinterpret_cast<uint64_t>(memory->getDeviceMemory());
   uint64_t curEnd = curStart + memory->size();
 
-  // Loop through all memory objects in the queue and find dependency
+  // Find the dependency on the memory of the previous kernels, if the busy region was written
+  // or the current one is for write
   // @note don't include objects from the current kernel
-  for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-    // Check if the queue already contains this mem object and
-    // GPU operations aren't readonly
-    uint64_t busyStart = memObjectsInQueue_[j].start_;
-    uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-    // Check if the start inside the busy region
-    if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-         // Check if the end inside the busy region
-         ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-         // Check if the start/end cover the busy region
-         ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-        // If the buys region was written or the current one is for write
-        (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-      flushL1Cache = true;
-      break;
-    }
-  }
+  bool flushL1Cache = ranges_.depends(curStart, curEnd, readOnly);
 
   // Did we reach the limit?
-  if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
+  if (ranges_.full()) {
     flushL1Cache = true;
   }
 
@@ -313,101 +306,143 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   // Insert current memory object into the queue always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
-  numMemObjectsInQueue_++;
+  ranges_.add(curStart, curEnd, readOnly);
 }
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      // Preserve all objects from the current kernel
-      size_t i, j;
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr  = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_= ptr;
-    }
-
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
-  }
+  ranges_.clear(all);
 }
 
 // ================================================================================================
 VirtualGPU::HwQueueTracker::~HwQueueTracker() {
   for (auto& signal: signal_list_) {
     CpuWaitForSignal(signal);
+    HarvestKernelStats(signal);
     signal->release();
   }
+  if (grows_ > 0 || forced_waits_ > 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Signal pool: peak size %zu, grows %lu, "
+            "cap hits %lu, trims %lu, forced waits %lu", peak_size_, grows_, cap_hits_,
+            trims_, forced_waits_);
+  }
 }
 
 // ================================================================================================
-bool VirtualGPU::HwQueueTracker::Create() {
-  uint kSignalListSize = ROC_SIGNAL_POOL_SIZE;
-
-  signal_list_.resize(kSignalListSize);
+void VirtualGPU::HwQueueTracker::HarvestKernelStats(ProfilingSignal* signal) const {
+  if (signal->kernel_stats_ == nullptr) {
+    return;
+  }
+  if (hsa_signal_load_relaxed(signal->signal_) <= 0) {
+    hsa_amd_profiling_dispatch_time_t time = {};
+    if ((hsa_amd_profiling_get_dispatch_time(gpu_.gpu_device(), signal->signal_, &time) ==
+         HSA_STATUS_SUCCESS) && (time.end > time.start)) {
+      signal->kernel_stats_->Add(static_cast<uint64_t>(
+          (time.end - time.start) * Timestamp::getGpuTicksToTime()));
+    }
+  }
+  signal->kernel_stats_ = nullptr;
+}
 
+// ================================================================================================
+ProfilingSignal* VirtualGPU::HwQueueTracker::CreateSignal() const {
+  std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+  if (signal == nullptr) {
+    return nullptr;
+  }
   hsa_agent_t agent = gpu_.gpu_device();
   const Settings& settings = gpu_.dev().settings();
   hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
   uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
 
+  if (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
+    return nullptr;
+  }
+  return signal.release();
+}
+
+// ================================================================================================
+bool VirtualGPU::HwQueueTracker::Create() {
+  uint kSignalListSize = ROC_SIGNAL_POOL_SIZE;
+
+  signal_list_.resize(kSignalListSize);
+
   for (uint i = 0; i < kSignalListSize; ++i) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
-    if ((signal == nullptr) ||
-        (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &signal->signal_))) {
+    ProfilingSignal* signal = CreateSignal();
+    if (signal == nullptr) {
       return false;
     }
-    signal_list_[i] = signal.release();
+    signal_list_[i] = signal;
   }
+  peak_size_ = signal_list_.size();
   return true;
 }
 
+// ================================================================================================
+void VirtualGPU::HwQueueTracker::TrimIdle() {
+  const size_t keep = std::max(ROC_SIGNAL_POOL_SIZE, 2u);
+  if (signal_list_.size() <= keep) {
+    return;
+  }
+  // Make sure all signals are idle and don't have any pending profiling or marker references
+  for (auto signal : signal_list_) {
+    if ((hsa_signal_load_relaxed(signal->signal_) > 0) || (signal->ts_ != nullptr) ||
+        (signal->referenceCount() > 1)) {
+      return;
+    }
+  }
+  // Keep the most recent signals in the submission order, so the last submitted signal
+  // stays current and the wait for the next signal still targets the oldest one
+  std::vector<ProfilingSignal*> signals(keep);
+  const size_t size = signal_list_.size();
+  for (size_t i = 0; i < size; ++i) {
+    size_t idx = (current_id_ + size - i) % size;
+    if (i < keep) {
+      signals[keep - 1 - i] = signal_list_[idx];
+    } else {
+      HarvestKernelStats(signal_list_[idx]);
+      signal_list_[idx]->release();
+    }
+  }
+  ClPrint(amd::LOG_DEBUG, amd::LOG_SIG, "Signal pool trimmed from %zu to %zu signals",
+          size, keep);
+  signal_list_.swap(signals);
+  current_id_ = keep - 1;
+  ++trims_;
+}
+
 // ================================================================================================
 hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
     hsa_signal_value_t init_val, Timestamp* ts, bool forceHostWait) {
   bool new_signal = false;
 
+  // Shrink the pool back if it grew on a burst and the queue has been idle for a while
+  if (signal_list_.size() > ROC_SIGNAL_POOL_SIZE) {
+    if (hsa_signal_load_relaxed(signal_list_[current_id_]->signal_) > 0) {
+      idle_count_ = 0;
+    } else if (++idle_count_ >= kSignalTrimIdleCount) {
+      idle_count_ = 0;
+      TrimIdle();
+    }
+  }
+
   // Peep signal +2 ahead to see if its done
   auto temp_id = (current_id_ + 2) % signal_list_.size();
   // If GPU is still busy with processing, then add more signals to avoid more frequent stalls
   if (hsa_signal_load_relaxed(signal_list_[temp_id]->signal_) > 0) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
-    if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
+    if (signal_list_.size() < ROC_SIGNAL_POOL_MAX_SIZE) {
+      ProfilingSignal* signal = CreateSignal();
+      if (signal != nullptr) {
         // Find valid new index
         ++current_id_ %= signal_list_.size();
         // Insert the new signal into the current slot and ignore any wait
-        signal_list_.insert(signal_list_.begin() + current_id_, signal.release());
+        signal_list_.insert(signal_list_.begin() + current_id_, signal);
         new_signal = true;
+        ++grows_;
+        peak_size_ = std::max(peak_size_, signal_list_.size());
       }
+    } else {
+      ++cap_hits_;
     }
   }
 
@@ -417,6 +452,11 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
     // Find valid index
     ++current_id_ %= signal_list_.size();
 
+    if (hsa_signal_load_relaxed(signal_list_[current_id_]->signal_) > 0) {
+      // The pool is exhausted and the host has to wait for the signal reuse
+      ++forced_waits_;
+    }
+
     // Make sure the previous operation on the current signal is done
     WaitCurrent();
 
@@ -428,24 +468,18 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
   if (signal_list_[current_id_]->referenceCount() > 1) {
     // The signal was assigned to the global marker's event, hence runtime can't reuse it
     // and needs a new signal
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+    ProfilingSignal* signal = CreateSignal();
     if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
-        signal_list_[current_id_]->release();
-        signal_list_[current_id_] = signal.release();
-      } else {
-        assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
-      }
+      HarvestKernelStats(signal_list_[current_id_]);
+      signal_list_[current_id_]->release();
+      signal_list_[current_id_] = signal;
     } else {
       assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
     }
   }
   ProfilingSignal* prof_signal = signal_list_[current_id_];
+  // Collect the time of the previous dispatch before the signal reuse
+  HarvestKernelStats(prof_signal);
   // Reset the signal and return
   hsa_signal_silent_store_relaxed(prof_signal->signal_, init_val);
   prof_signal->flags_.done_ = false;
@@ -577,7 +611,9 @@ bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
     amd::ScopedLock lock(signal->LockSignalOps());
     ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Host wait on completion_signal=0x%zx",
             signal->signal_.handle);
-    if (!WaitForSignal(signal->signal_, gpu_.ActiveWait())) {
+    bool result = (ROC_ADAPTIVE_WAIT && !gpu_.ActiveWait()) ?
+        adaptive_wait_.Wait(signal->signal_) : WaitForSignal(signal->signal_, gpu_.ActiveWait());
+    if (!result) {
       LogPrintfError("Failed signal [0x%lx] wait", signal->signal_);
       return false;
     }
@@ -586,6 +622,82 @@ bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
   return true;
 }
 
+// ================================================================================================
+bool FlightRecorder::Create(uint32_t size) {
+  if (size == 0) {
+    return true;
+  }
+  size = amd::nextPowerOfTwo(size);
+  entries_ = new (std::nothrow) Entry[size]();
+  if (entries_ == nullptr) {
+    return false;
+  }
+  mask_ = size - 1;
+  return true;
+}
+
+// ================================================================================================
+void FlightRecorder::Dump(FILE* file, uint64_t queue_id, uint64_t read_index) const {
+  if (entries_ == nullptr) {
+    return;
+  }
+  uint64_t count = count_.load(std::memory_order_acquire);
+  uint64_t first = (count > mask_) ? (count - mask_ - 1) : 0;
+  uint64_t now = amd::Os::timeNanos();
+  fprintf(file, "Flight recorder: queue id=%lu, read index=%lu, %lu packets recorded\n",
+          queue_id, read_index, count);
+  for (uint64_t i = first; i < count; ++i) {
+    const Entry& entry = entries_[i & mask_];
+    fprintf(file, "  wptr=%lu %s: %lu us ago, type=%d, barrier=%d, command=0x%x, "
+            "kernel=0x%lx, completion_signal=0x%lx\n", entry.index_,
+            (entry.index_ < read_index) ? "consumed" : "pending",
+            (now - std::min(now, entry.time_)) / 1000,
+            extractAqlBits(entry.header_, HSA_PACKET_HEADER_TYPE, HSA_PACKET_HEADER_WIDTH_TYPE),
+            extractAqlBits(entry.header_, HSA_PACKET_HEADER_BARRIER,
+                           HSA_PACKET_HEADER_WIDTH_BARRIER),
+            entry.command_, entry.kernel_, entry.signal_);
+  }
+}
+
+// ================================================================================================
+AdaptiveWait::~AdaptiveWait() {
+  if ((spin_hits_ + spin_misses_) > 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Adaptive wait: spin hits %lu, spin misses %lu "
+            "(hit rate %lu%%), average wait %lu ns", spin_hits_, spin_misses_,
+            (spin_hits_ * 100) / (spin_hits_ + spin_misses_), avg_wait_);
+  }
+}
+
+// ================================================================================================
+bool AdaptiveWait::Wait(hsa_signal_t signal) {
+  if (hsa_signal_load_relaxed(signal) <= 0) {
+    return true;
+  }
+  uint64_t start = amd::Os::timeNanos();
+  // Expect the completion within two average wait times in the queue.
+  // Long operations will quickly push the window to the limit and switch to the interrupt wait
+  uint64_t window = std::min(std::max(avg_wait_ * 2, kAdaptiveMinSpin), kAdaptiveMaxSpin);
+  bool spin = (avg_wait_ < kAdaptiveMaxSpin);
+  bool hit = false;
+  if (spin) {
+    hit = (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                     window, HSA_WAIT_STATE_ACTIVE) == 0);
+  }
+  if (!hit) {
+    if (!BlockedWaitForSignal(signal)) {
+      return false;
+    }
+  }
+  uint64_t elapsed = amd::Os::timeNanos() - start;
+  // Exponential moving average with 1/8 weight for the last wait
+  avg_wait_ = (avg_wait_ == 0) ? elapsed : (avg_wait_ * 7 + elapsed) / 8;
+  hit ? ++spin_hits_ : ++spin_misses_;
+  ClPrint(amd::LOG_DEBUG, amd::LOG_SIG, "Adaptive wait for Signal = (0x%lx): %s, window %lu ns, "
+          "wait %lu ns", signal.handle, hit ? "spin" : (spin ? "spin+block" : "block"),
+          window, elapsed);
+  return true;
+}
+
 // ================================================================================================
 void VirtualGPU::HwQueueTracker::ResetCurrentSignal() {
   // Reset the signal and return
@@ -852,13 +964,15 @@ bool VirtualGPU::dispatchGenericAqlPacket(
   uint64_t index = hsa_queue_add_write_index_screlease(gpu_queue_, 1);
   uint64_t read = hsa_queue_load_read_index_relaxed(gpu_queue_);
 
-  if (addSystemScope_) {
-    header &= ~(HSA_FENCE_SCOPE_AGENT << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE |
-                HSA_FENCE_SCOPE_AGENT << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
-    header |= (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE |
-               HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
-    addSystemScope_ = false;
+  if (addSystemScope_ & kSystemAcquire) {
+    header &= ~(HSA_FENCE_SCOPE_AGENT << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE);
+    header |= (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE);
+  }
+  if (addSystemScope_ & kSystemRelease) {
+    header &= ~(HSA_FENCE_SCOPE_AGENT << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+    header |= (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
   }
+  addSystemScope_ = 0;
 
   auto expected_fence_state = extractAqlBits(header, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
                          HSA_PACKET_HEADER_WIDTH_SCRELEASE_FENCE_SCOPE);
@@ -891,6 +1005,8 @@ bool VirtualGPU::dispatchGenericAqlPacket(
 
   // Make sure the slot is free for usage
   while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= sw_queue_size) {
+    // Batched packets must be visible to CP, otherwise the queue can't make progress
+    FlushDoorbell();
     amd::Os::yield();
   }
 
@@ -909,6 +1025,11 @@ bool VirtualGPU::dispatchGenericAqlPacket(
   if (header != 0) {
     packet_store_release(reinterpret_cast<uint32_t*>(aql_loc), header, rest);
   }
+  uint16_t recorded_header = (header != 0) ? header : *reinterpret_cast<uint16_t*>(packet);
+  bool dispatch = (extractAqlBits(recorded_header, HSA_PACKET_HEADER_TYPE,
+                   HSA_PACKET_HEADER_WIDTH_TYPE) == HSA_PACKET_TYPE_KERNEL_DISPATCH);
+  flight_recorder_.Record(index, recorded_header, packet->completion_signal.handle,
+                          dispatch ? recorder_kernel_ : 0, recorder_command_);
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, Dispatch Header = "
           "0x%x (type=%d, barrier=%d, acquire=%d, release=%d), "
@@ -936,7 +1057,15 @@ bool VirtualGPU::dispatchGenericAqlPacket(
           reinterpret_cast<hsa_kernel_dispatch_packet_t*>(packet)->reserved2, read,
           index);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  // Packets without a completion signal can't be waited on directly, hence the doorbell update
+  // can be delayed until the batch is full or the next packet with a signal. Any packet with
+  // a signal or a barrier rings the doorbell and submits all previous packets in the queue.
+  if ((aql_batch_size_ > 0) && !blocking && (packet->completion_signal.handle == 0) &&
+      (++pending_doorbell_packets_ < aql_batch_size_)) {
+    pending_doorbell_index_ = index;
+  } else {
+    RingDoorbell(index);
+  }
 
   // Mark the flag indicating if a dispatch is outstanding.
   // We are not waiting after every dispatch.
@@ -1022,6 +1151,46 @@ inline bool VirtualGPU::dispatchAqlPacket(
   return true;
 }
 
+// ================================================================================================
+bool VirtualGPU::dispatchAqlPackets(const std::vector<uint8_t*>& aqlpackets,
+                                    const std::vector<const std::string*>& kernelNames,
+                                    amd::AccumulateCommand* vcmd) {
+  if (vcmd == nullptr) {
+    return false;
+  }
+  // Profiling tracks the timestamps of every packet separately
+  if (vcmd->profilingInfo().enabled_) {
+    for (size_t i = 0; i < aqlpackets.size(); ++i) {
+      dispatchAqlPacket(aqlpackets[i], *kernelNames[i], vcmd);
+    }
+    return true;
+  }
+
+  amd::ScopedLock lock(execution());
+  profilingBegin(*vcmd);
+  dispatchBlockingWait();
+
+  // Defer the doorbell update until the last packet, so CP receives the whole batch at once.
+  // The queue full wait still rings the doorbell for the batched packets to make progress
+  const uint32_t aql_batch_size = aql_batch_size_;
+  aql_batch_size_ = std::numeric_limits<uint32_t>::max();
+  for (size_t i = 0; i < aqlpackets.size(); ++i) {
+    vcmd->addKernelName(*kernelNames[i]);
+    auto packet = reinterpret_cast<hsa_kernel_dispatch_packet_t*>(aqlpackets[i]);
+    // Don't expose a valid header in the captured packet before the body is copied
+    uint16_t packetHeader = packet->header;
+    packet->header = (HSA_PACKET_TYPE_INVALID << HSA_PACKET_HEADER_TYPE);
+    dispatchGenericAqlPacket(packet, packetHeader, packet->setup, false);
+    packet->header = packetHeader;
+  }
+  aql_batch_size_ = aql_batch_size;
+  FlushDoorbell();
+  ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Graph batch dispatch : %zu packets", aqlpackets.size());
+
+  profilingEnd(*vcmd);
+  return true;
+}
+
 // ================================================================================================
 bool VirtualGPU::dispatchCounterAqlPacket(hsa_ext_amd_aql_pm4_packet_t* packet,
                                           const uint32_t gfxVersion, bool blocking,
@@ -1047,6 +1216,7 @@ bool VirtualGPU::dispatchCounterAqlPacket(hsa_ext_amd_aql_pm4_packet_t* packet,
 // ================================================================================================
 void VirtualGPU::dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal,
                                        hsa_signal_t signal) {
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Barrier, "BarrierPacket");
   const uint32_t queueSize = gpu_queue_->size;
   const uint32_t queueMask = queueSize - 1;
 
@@ -1090,7 +1260,7 @@ void VirtualGPU::dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal,
   *aql_loc = barrier_packet_;
   __atomic_store_n(reinterpret_cast<uint32_t*>(aql_loc), packetHeader, __ATOMIC_RELEASE);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  RingDoorbell(index);
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, BarrierAND Header = 0x%x (type=%d, barrier=%d, acquire=%d,"
           " release=%d), "
@@ -1121,6 +1291,7 @@ void VirtualGPU::dispatchBarrierValuePacket(uint16_t packetHeader, bool resolveD
                                             hsa_signal_t signal, hsa_signal_value_t value,
                                             hsa_signal_value_t mask, hsa_signal_condition32_t cond,
                                             bool skipTs, hsa_signal_t completionSignal) {
+  amd::TraceEvents::Scope trace(amd::TraceEvents::Barrier, "BarrierValuePacket");
   uint16_t rest = HSA_AMD_PACKET_TYPE_BARRIER_VALUE;
   const uint32_t queueSize = gpu_queue_->size;
   const uint32_t queueMask = queueSize - 1;
@@ -1168,7 +1339,7 @@ void VirtualGPU::dispatchBarrierValuePacket(uint16_t packetHeader, bool resolveD
   *aql_loc = barrier_value_packet_;
   packet_store_release(reinterpret_cast<uint32_t*>(aql_loc), packetHeader, rest);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  RingDoorbell(index);
 
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, BarrierValue Header = 0x%x AmdFormat = 0x%x "
@@ -1198,6 +1369,8 @@ void VirtualGPU::ResetQueueStates() {
   // Release the pool, since runtime just completed a barrier
   // @note: Runtime can reset kernel arg pool only if the barrier with L2 invalidation was issued
   resetKernArgPool();
+  // The queue is idle, hence the pools retired after growth can be released
+  releaseRetiredPools();
 }
 
 // ================================================================================================
@@ -1208,12 +1381,18 @@ bool VirtualGPU::releaseGpuMemoryFence(bool skip_cpu_wait) {
     hasPendingDispatch_ = false;
     retainExternalSignals_ = false;
   }
+  // Make sure all batched packets are submitted
+  FlushDoorbell();
 
   // Check if runtime could skip CPU wait
   if (!skip_cpu_wait) {
     Barriers().WaitCurrent();
 
     ResetQueueStates();
+    // Make the printf output of the finished kernels visible to the waiting thread
+    if (printfdbg_ != nullptr) {
+      printfdbg_->waitDrained();
+    }
   }
   return true;
 }
@@ -1232,6 +1411,7 @@ VirtualGPU::VirtualGPU(Device& device, bool profiling, bool cooperative,
       schedulerThreads_(0),
       schedulerParam_(nullptr),
       schedulerQueue_(nullptr),
+      gridSyncWorkspace_(nullptr),
       schedulerSignal_({0}),
       barriers_(*this),
       kernarg_pool_signal_(KernelArgPoolNumSignal),
@@ -1324,6 +1504,10 @@ VirtualGPU::~VirtualGPU() {
     virtualQueue_->release();
   }
 
+  if (nullptr != gridSyncWorkspace_) {
+    roc_device_.memFree(gridSyncWorkspace_, Device::kGridSyncWorkspaceSize);
+  }
+
   // Lock the device to make the following thread safe
   amd::ScopedLock lock(roc_device_.vgpusAccess());
 
@@ -1338,6 +1522,34 @@ VirtualGPU::~VirtualGPU() {
   }
 }
 
+// ================================================================================================
+bool VirtualGPU::setCuMask(const std::vector<uint32_t>& cuMask) {
+  // The cooperative queue is single per device and can't be replaced
+  if (cooperative_) {
+    return false;
+  }
+  amd::ScopedLock lock(execution());
+  hsa_queue_t* queue = roc_device_.acquireQueue(ROC_AQL_QUEUE_SIZE, false, cuMask, priority_);
+  if (queue == nullptr) {
+    return false;
+  }
+  // Submit the batched packets to the old queue. The caller waited for the old work, hence the
+  // new queue doesn't need a dependency on the old one
+  FlushDoorbell();
+  ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Moved virtual GPU %p from HW queue %p to %p", this,
+          gpu_queue_->base_address, queue->base_address);
+  // The old queue with a custom mask is destroyed on release
+  roc_device_.releaseQueue(gpu_queue_, cuMask_, cooperative_);
+  gpu_queue_ = queue;
+  cuMask_ = cuMask;
+  queueProfiling_ = false;
+  if (aql_batch_size_ > 0) {
+    aql_batch_size_ = std::min(DEBUG_CLR_AQL_BATCH_SIZE, DEBUG_CLR_MAX_BATCH_SIZE);
+    aql_batch_size_ = std::min(aql_batch_size_, gpu_queue_->size / 2);
+  }
+  return true;
+}
+
 // ================================================================================================
 bool VirtualGPU::create() {
   // Pick a reasonable queue size
@@ -1345,11 +1557,23 @@ bool VirtualGPU::create() {
   gpu_queue_ = roc_device_.acquireQueue(queue_size, cooperative_, cuMask_, priority_);
   if (!gpu_queue_) return false;
 
+  // Doorbell batching is safe only in direct dispatch, since the app thread controls
+  // all submissions and sync points
+  if (AMD_DIRECT_DISPATCH && (DEBUG_CLR_AQL_BATCH_SIZE > 1)) {
+    aql_batch_size_ = std::min(DEBUG_CLR_AQL_BATCH_SIZE, DEBUG_CLR_MAX_BATCH_SIZE);
+    aql_batch_size_ = std::min(aql_batch_size_, gpu_queue_->size / 2);
+  }
+
   if (!initPool(dev().settings().kernargPoolSize_)) {
     LogError("Couldn't allocate arguments/signals for the queue");
     return false;
   }
 
+  if (!flight_recorder_.Create(ROC_FLIGHT_RECORDER_SIZE)) {
+    LogError("Couldn't allocate the flight recorder for the queue");
+    return false;
+  }
+
   device::BlitManager::Setup blitSetup;
   blitMgr_ = new KernelBlitManager(*this, blitSetup);
   if ((nullptr == blitMgr_) || !blitMgr_->create(roc_device_)) {
@@ -1375,6 +1599,15 @@ bool VirtualGPU::create() {
     hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &frequency);
     Timestamp::setGpuTicksToTime(1e9 / double(frequency));
   }
+  if (amd::TraceEvents::enabled() && !amd::TraceEvents::hasGpuClockOffset()) {
+    // Sample both clocks back to back, so the GPU times of the trace move to the host clock
+    uint64_t ticks = 0;
+    uint64_t host = amd::Os::timeNanos();
+    hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP, &ticks);
+    host = (host + amd::Os::timeNanos()) / 2;
+    amd::TraceEvents::setGpuClockOffset(static_cast<int64_t>(host) -
+        static_cast<int64_t>(ticks * Timestamp::getGpuTicksToTime()));
+  }
 
   if (!memoryDependency().create(GPU_NUM_MEM_DEPENDENCY)) {
     LogError("Could not create the array of memory objects!");
@@ -1403,6 +1636,10 @@ VirtualGPU::ManagedBuffer::~ManagedBuffer() {
     }
   }
   if (pool_base_ != nullptr) {
+    if (amd::AllocTrace::Enabled()) {
+      amd::AllocTrace::Record(amd::AllocTrace::kFree, amd::AllocTrace::kInternal, pool_base_,
+                              pool_size_);
+    }
     gpu_.dev().hostFree(pool_base_, pool_size_);
   }
 }
@@ -1417,6 +1654,10 @@ bool VirtualGPU::ManagedBuffer::Create() {
   if (pool_base_ == nullptr) {
     return false;
   }
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kAlloc, amd::AllocTrace::kInternal, pool_base_,
+                            pool_size_);
+  }
   hsa_agent_t agent = gpu_.dev().getBackendDevice();
   for (auto& it : pool_signal_) {
     if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 1, &agent, &it)) {
@@ -1459,28 +1700,30 @@ address VirtualGPU::ManagedBuffer::Acquire(uint32_t size) {
 }
 
 // ================================================================================================
-bool VirtualGPU::initPool(size_t kernarg_pool_size) {
-  kernarg_pool_size_ = kernarg_pool_size;
-  kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
-  active_chunk_ = 0;
+bool VirtualGPU::allocPool(uint32_t pool_size, address* pool_base,
+                           std::vector<hsa_signal_t>* signals) {
   if ((dev().settings().kernel_arg_impl_ != KernelArgImpl::HostKernelArgs) &&
       roc_device_.info().largeBar_) {
-    kernarg_pool_base_ =
-      reinterpret_cast<address>(roc_device_.deviceLocalAlloc(kernarg_pool_size_));
-    if (kernarg_pool_base_ != nullptr) {
+    *pool_base = reinterpret_cast<address>(roc_device_.deviceLocalAlloc(pool_size));
+    if (*pool_base != nullptr) {
+      roc_device_.updateFreeMemory(pool_size, false, Device::kMemInternal);
       // @note Workaround first access penalty.
       // KFD may update CPU page tables on the first CPU access
-      *kernarg_pool_base_ = 0;
+      **pool_base = 0;
     }
   } else {
-    kernarg_pool_base_ = reinterpret_cast<address>(roc_device_.hostAlloc(kernarg_pool_size_, 0,
-                                                   Device::MemorySegment::kKernArg));
+    *pool_base = reinterpret_cast<address>(roc_device_.hostAlloc(pool_size, 0,
+                                           Device::MemorySegment::kKernArg));
   }
-  if (kernarg_pool_base_ == nullptr) {
+  if (*pool_base == nullptr) {
     return false;
   }
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kAlloc, amd::AllocTrace::kInternal, *pool_base,
+                            pool_size);
+  }
   hsa_agent_t agent = gpu_device();
-  for (auto& it : kernarg_pool_signal_) {
+  for (auto& it : *signals) {
     if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 1, &agent, &it)) {
       return false;
     }
@@ -1488,15 +1731,91 @@ bool VirtualGPU::initPool(size_t kernarg_pool_size) {
   return true;
 }
 
+// ================================================================================================
+void VirtualGPU::freePool(address pool_base, uint32_t pool_size) {
+  if ((dev().settings().kernel_arg_impl_ != KernelArgImpl::HostKernelArgs) &&
+      roc_device_.info().largeBar_) {
+    roc_device_.updateFreeMemory(pool_size, true, Device::kMemInternal);
+  }
+  if (amd::AllocTrace::Enabled()) {
+    amd::AllocTrace::Record(amd::AllocTrace::kFree, amd::AllocTrace::kInternal, pool_base,
+                            pool_size);
+  }
+  roc_device_.hostFree(pool_base, pool_size);
+}
+
+// ================================================================================================
+bool VirtualGPU::initPool(size_t kernarg_pool_size) {
+  kernarg_pool_size_ = kernarg_pool_size;
+  kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
+  active_chunk_ = 0;
+  return allocPool(kernarg_pool_size_, &kernarg_pool_base_, &kernarg_pool_signal_);
+}
+
+// ================================================================================================
+bool VirtualGPU::growPool(size_t min_size) {
+  uint32_t new_size = kernarg_pool_size_ * 2;
+  // The new chunk must fit the requested allocation
+  while ((new_size / KernelArgPoolNumSignal) < min_size) {
+    new_size *= 2;
+  }
+  if (new_size > HSA_KERNARG_POOL_MAX_SIZE) {
+    return false;
+  }
+
+  address new_base = nullptr;
+  std::vector<hsa_signal_t> new_signals(KernelArgPoolNumSignal);
+  if (!allocPool(new_size, &new_base, &new_signals)) {
+    for (auto& it : new_signals) {
+      if (it.handle != 0) {
+        hsa_signal_destroy(it);
+      }
+    }
+    if (new_base != nullptr) {
+      freePool(new_base, new_size);
+    }
+    return false;
+  }
+
+  // The old pool is still in use by GPU, hence keep it until the queue is idle.
+  // Note: all chunks of the old pool are protected with the barriers and the signals
+  kernarg_retired_pools_.push_back({kernarg_pool_base_, kernarg_pool_size_,
+                                    std::move(kernarg_pool_signal_)});
+  kernarg_pool_base_ = new_base;
+  kernarg_pool_size_ = new_size;
+  kernarg_pool_signal_ = std::move(new_signals);
+  resetKernArgPool();
+  ++kernarg_pool_grows_;
+  ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Kernel arg pool grows to %u bytes", new_size);
+  return true;
+}
+
+// ================================================================================================
+void VirtualGPU::releaseRetiredPools() {
+  for (auto& pool : kernarg_retired_pools_) {
+    for (auto& it : pool.signals_) {
+      if (it.handle != 0) {
+        hsa_signal_destroy(it);
+      }
+    }
+    freePool(pool.base_, pool.size_);
+  }
+  kernarg_retired_pools_.clear();
+}
+
 // ================================================================================================
 void VirtualGPU::destroyPool() {
+  ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Kernel arg pool: size %u, high-water %u, grows %u, "
+          "chunk waits %u", kernarg_pool_size_, kernarg_pool_high_water_, kernarg_pool_grows_,
+          kernarg_pool_waits_);
+  releaseRetiredPools();
   for (auto& it : kernarg_pool_signal_) {
     if (it.handle != 0) {
       hsa_signal_destroy(it);
     }
   }
   if (kernarg_pool_base_ != nullptr) {
-    roc_device_.hostFree(kernarg_pool_base_, kernarg_pool_size_);
+    freePool(kernarg_pool_base_, kernarg_pool_size_);
   }
 }
 
@@ -1508,6 +1827,7 @@ void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
   const size_t pool_new_usage = (result + size) - kernarg_pool_base_;
   if (pool_new_usage <= kernarg_pool_chunk_end_) {
     kernarg_pool_cur_offset_ = pool_new_usage;
+    kernarg_pool_high_water_ = std::max(kernarg_pool_high_water_, kernarg_pool_cur_offset_);
     return result;
   } else {
     //! That means the app didn't call clFlush/clFinish for very long time.
@@ -1519,6 +1839,18 @@ void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
     dispatchBarrierPacket(kBarrierPacketHeader, true, kernarg_pool_signal_[active_chunk_]);
     // Get the next chunk
     active_chunk_ = ++active_chunk_ % KernelArgPoolNumSignal;
+    // If the next chunk is still busy or too small, then try a bigger pool instead of a stall
+    const bool chunk_busy = hsa_signal_load_relaxed(kernarg_pool_signal_[active_chunk_]) > 0;
+    const bool chunk_small = (size + alignment) > (kernarg_pool_size_ / KernelArgPoolNumSignal);
+    if ((chunk_busy || chunk_small) && growPool(size + alignment)) {
+      result = amd::alignUp(kernarg_pool_base_, alignment);
+      kernarg_pool_cur_offset_ = (result + size) - kernarg_pool_base_;
+      kernarg_pool_high_water_ = std::max(kernarg_pool_high_water_, kernarg_pool_cur_offset_);
+      return result;
+    }
+    if (chunk_busy) {
+      ++kernarg_pool_waits_;
+    }
     // Make sure the new active chunk is free
     bool test = WaitForSignal(kernarg_pool_signal_[active_chunk_], ActiveWait());
     assert(test && "Runtime can't fail a wait for chunk!");
@@ -1529,6 +1861,7 @@ void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
                               kernarg_pool_size_ / KernelArgPoolNumSignal;
     result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
     kernarg_pool_cur_offset_ = (result + size) - kernarg_pool_base_;
+    kernarg_pool_high_water_ = std::max(kernarg_pool_high_water_, kernarg_pool_cur_offset_);
   }
 
   return result;
@@ -1536,7 +1869,11 @@ void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
 
 // ================================================================================================
 address VirtualGPU::allocKernelArguments(size_t size, size_t alignment) {
-  if (ROC_SKIP_KERNEL_ARG_COPY) {
+  // The worker thread can recycle the pool before a deferred command is submitted, and
+  // the host reads of the captured arguments from device memory are slow.
+  // Hence the direct capture is limited to direct dispatch with the host kernel arguments
+  if (ROC_SKIP_KERNEL_ARG_COPY && AMD_DIRECT_DISPATCH &&
+      (dev().settings().kernel_arg_impl_ == KernelArgImpl::HostKernelArgs)) {
     // Make sure VirtualGPU has an exclusive access to the resources
     amd::ScopedLock lock(execution());
     return reinterpret_cast<address>(allocKernArg(size, alignment));
@@ -1551,6 +1888,7 @@ address VirtualGPU::allocKernelArguments(size_t size, size_t alignment) {
 * and then calls start() to get the current host timestamp.
 */
 void VirtualGPU::profilingBegin(amd::Command& command, bool sdmaProfiling) {
+  recorder_command_ = command.type();
   // Disable profiling when command is being captured to prevent memory leak from created timestamp_
   // which won't get freed, since the command is not being executed until graph launch
   if (!command.getPktCapturingState() && command.profilingInfo().enabled_) {
@@ -1565,6 +1903,13 @@ void VirtualGPU::profilingBegin(amd::Command& command, bool sdmaProfiling) {
     command.data().emplace_back(timestamp_);
     timestamp_->start();
 
+    // The markers get the time from the timestamp kernel, but all other commands need
+    // the timestamps from the queue profiling
+    bool marker = (command.type() == 0) || (command.type() == CL_COMMAND_MARKER);
+    if (!marker) {
+      enableQueueProfiling();
+    }
+
     // Enable SDMA profiling on the first access if profiling is set
     // Its not per command basis
     if (sdmaProfiling && !Barriers().GetSDMAProfiling()) {
@@ -1594,6 +1939,16 @@ void VirtualGPU::profilingBegin(amd::Command& command, bool sdmaProfiling) {
   }
 }
 
+// ================================================================================================
+void VirtualGPU::enableQueueProfiling() {
+  if (ROC_TIMESTAMP_KERNEL && !queueProfiling_) {
+    hsa_amd_profiling_set_profiler_enabled(gpu_queue_, 1);
+    queueProfiling_ = true;
+    ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Enabled profiling on HW queue %p",
+            gpu_queue_->base_address);
+  }
+}
+
 // ================================================================================================
 /* profilingEnd, when profiling is enabled, checks to see if a signal was
 * created for whatever command we are running and calls end() to get the
@@ -1925,25 +2280,30 @@ void VirtualGPU::submitSvmPrefetchAsync(amd::SvmPrefetchAsyncCommand& cmd) {
   profilingBegin(cmd);
 
   if (dev().info().hmmSupported_) {
-    // Initialize signal for the barrier
-    auto wait_events = Barriers().WaitingSignal(HwQueueEngine::Unknown);
-    hsa_signal_t active = Barriers().ActiveSignal(kInitSignalValueOne, timestamp_);
-
     // Find the requested agent for the transfer
     hsa_agent_t agent = (cmd.cpu_access() ||
         (dev().settings().hmmFlags_ & Settings::Hmm::EnableSystemMemory)) ?
         dev().getCpuAgent() : (static_cast<const roc::Device*>(cmd.device()))->getBackendDevice();
 
-    // Initiate a prefetch command
-    hsa_status_t status = hsa_amd_svm_prefetch_async(
-        const_cast<void*>(cmd.dev_ptr()), cmd.count(), agent,
-        wait_events.size(), wait_events.data(), active);
-
-    // Wait for the prefetch. Should skip wait, but may require extra tracking for kernel execution
-    if ((status != HSA_STATUS_SUCCESS) || !Barriers().WaitCurrent()) {
-      Barriers().ResetCurrentSignal();
-      LogError("hsa_amd_svm_prefetch_async failed");
-      cmd.setStatus(CL_INVALID_OPERATION);
+    // The command carries coalesced ranges, hence one prefetch op per contiguous range
+    for (const auto& range : cmd.ranges()) {
+      // Initialize signal for the barrier
+      auto wait_events = Barriers().WaitingSignal(HwQueueEngine::Unknown);
+      hsa_signal_t active = Barriers().ActiveSignal(kInitSignalValueOne, timestamp_);
+
+      // Initiate a prefetch command
+      hsa_status_t status = hsa_amd_svm_prefetch_async(
+          const_cast<void*>(range.first), range.second, agent,
+          wait_events.size(), wait_events.data(), active);
+
+      // Wait for the prefetch. Should skip wait, but may require extra tracking for kernel
+      // execution
+      if ((status != HSA_STATUS_SUCCESS) || !Barriers().WaitCurrent()) {
+        Barriers().ResetCurrentSignal();
+        LogError("hsa_amd_svm_prefetch_async failed");
+        cmd.setStatus(CL_INVALID_OPERATION);
+        break;
+      }
     }
 
     // Add system scope, since the prefetch scope is unclear
@@ -2068,6 +2428,102 @@ void VirtualGPU::submitCopyMemory(amd::CopyMemoryCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+void VirtualGPU::submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(cmd, true);
+
+  // Many small device copies go with one gather kernel instead of a blit per copy
+  std::vector<device::BlitManager::CopyRegion> regions;
+  if ((cmd.copies().size() > 1) && (cmd.copyMetadata().copyEnginePreference_ !=
+                                    amd::CopyMetadata::CopyEnginePreference::SDMA)) {
+    regions.reserve(cmd.copies().size());
+    for (const auto& it : cmd.copies()) {
+      Memory* srcDevMem = dev().getRocMemory(it.src_);
+      Memory* dstDevMem = dev().getRocMemory(it.dst_);
+      if ((srcDevMem == nullptr) || (dstDevMem == nullptr) ||
+          (it.src_->getType() != CL_MEM_OBJECT_BUFFER) ||
+          (it.dst_->getType() != CL_MEM_OBJECT_BUFFER) || srcDevMem->isHostMemDirectAccess() ||
+          dstDevMem->isHostMemDirectAccess()) {
+        regions.clear();
+        break;
+      }
+      srcDevMem->syncCacheFromHost(*this);
+      dstDevMem->syncCacheFromHost(*this);
+      regions.push_back({srcDevMem->virtualAddress() + it.srcOffset_,
+                         dstDevMem->virtualAddress() + it.dstOffset_, it.size_});
+    }
+  }
+  if (!regions.empty() && blitMgr().copyBufferBatch(regions)) {
+    profilingEnd(cmd);
+    return;
+  }
+
+  // The blits go back to back, only the last one carries the completion signal of the batch
+  amd::BufferRect rect;
+  for (const auto& it : cmd.copies()) {
+    amd::Coord3D srcOrigin(it.srcOffset_);
+    amd::Coord3D dstOrigin(it.dstOffset_);
+    amd::Coord3D size(it.size_);
+    bool entire = it.src_->isEntirelyCovered(srcOrigin, size) &&
+                  it.dst_->isEntirelyCovered(dstOrigin, size);
+    if (!copyMemory(cmd.type(), *it.src_, *it.dst_, entire, srcOrigin, dstOrigin, size, rect,
+                    rect, cmd.copyMetadata())) {
+      cmd.setStatus(CL_INVALID_OPERATION);
+      break;
+    }
+  }
+  copy_command_type_ = 0;
+  profilingEnd(cmd);
+}
+
+// ================================================================================================
+void VirtualGPU::submitWriteMemoryInline(amd::WriteMemoryInlineCommand& cmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(cmd, true);
+
+  // The data goes with the launch of the gather kernel, the region sources are payload offsets
+  std::vector<device::BlitManager::CopyRegion> regions;
+  regions.reserve(cmd.writes().size());
+  for (const auto& it : cmd.writes()) {
+    Memory* devMem = dev().getRocMemory(it.dst_);
+    if ((devMem == nullptr) || (it.dst_->getType() != CL_MEM_OBJECT_BUFFER) ||
+        devMem->isHostMemDirectAccess()) {
+      regions.clear();
+      break;
+    }
+    devMem->syncCacheFromHost(*this);
+    regions.push_back({it.data_, devMem->virtualAddress() + it.offset_, it.size_});
+  }
+  if (!regions.empty() &&
+      blitMgr().writeBufferInline(regions, cmd.payload().data(), cmd.payload().size())) {
+    for (const auto& it : cmd.writes()) {
+      it.dst_->signalWrite(&dev());
+    }
+    profilingEnd(cmd);
+    return;
+  }
+
+  for (const auto& it : cmd.writes()) {
+    Memory* devMem = dev().getRocMemory(it.dst_);
+    amd::Coord3D origin(it.offset_);
+    amd::Coord3D size(it.size_);
+    if ((devMem == nullptr) ||
+        !blitMgr().writeBuffer(cmd.payload().data() + it.data_, *devMem, origin, size,
+                               it.dst_->isEntirelyCovered(origin, size))) {
+      LogError("submitWriteMemoryInline failed!");
+      cmd.setStatus(CL_OUT_OF_RESOURCES);
+      break;
+    }
+    it.dst_->signalWrite(&dev());
+  }
+  profilingEnd(cmd);
+}
+
 // ================================================================================================
 void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
@@ -2150,6 +2606,14 @@ void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+// The transfer queue of a device is shared by the staged P2P copies of all device pairs
+template <typename Copy>
+static bool StagedP2PCopy(const Device& dev, Copy copy) {
+  amd::ScopedLock lock(dev.xferQueue()->execution());
+  return copy(dev.xferMgr());
+}
+
 // ================================================================================================
 void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
@@ -2179,6 +2643,24 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
     }
   }
 
+  // Without a direct link a GPU with access to both devices copies the data over its own links,
+  // so the transfer doesn't go through the host staging
+  const Device* relayDev = nullptr;
+  Memory* srcRelayMem = nullptr;
+  Memory* dstRelayMem = nullptr;
+  if (!p2pAllowed) {
+    amd::Device* relay = srcDevMem->dev().P2PRelayDevice(&dstDevMem->dev());
+    if (relay != nullptr) {
+      srcRelayMem = static_cast<Memory*>(cmd.source().getDeviceMemory(*relay));
+      dstRelayMem = static_cast<Memory*>(cmd.destination().getDeviceMemory(*relay));
+      if ((srcRelayMem != nullptr) && (dstRelayMem != nullptr)) {
+        relayDev = static_cast<const Device*>(relay);
+        // Sync the current queue, since the relay device uses its own queue for transfer
+        releaseGpuMemoryFence();
+      }
+    }
+  }
+
   // Synchronize source and destination memory
   device::Memory::SyncFlags syncFlags;
   syncFlags.skipEntire_ = cmd.isEntireMemory();
@@ -2193,16 +2675,27 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
       if (p2pAllowed) {
           result = blitMgr().copyBuffer(*srcDevMem, *dstDevMem, srcOrigin, dstOrigin,
                                         size, cmd.isEntireMemory());
+      } else if (relayDev != nullptr) {
+          result = StagedP2PCopy(*relayDev, [&](const device::BlitManager& xfer) {
+            return xfer.copyBuffer(*srcRelayMem, *dstRelayMem, srcOrigin, dstOrigin, size,
+                                   cmd.isEntireMemory());
+          });
       }
       else {
           // Sync the current queue, since P2P staging uses the device queues for transfer
           releaseGpuMemoryFence();
 
-          amd::ScopedLock lock(dev().P2PStageOps());
+          // Only the transfers between the same pair of devices share the staging buffer
+          auto stage = dev().P2PStage(cmd.source().getContext().devices()[0],
+                                      cmd.destination().getContext().devices()[0]);
+          if (stage->buffer_ == nullptr) {
+            break;
+          }
+          amd::ScopedLock lock(stage->lock_);
           Memory* dstStgMem = static_cast<Memory*>(
-              dev().P2PStage()->getDeviceMemory(*cmd.source().getContext().devices()[0]));
+              stage->buffer_->getDeviceMemory(*cmd.source().getContext().devices()[0]));
           Memory* srcStgMem = static_cast<Memory*>(
-              dev().P2PStage()->getDeviceMemory(*cmd.destination().getContext().devices()[0]));
+              stage->buffer_->getDeviceMemory(*cmd.destination().getContext().devices()[0]));
 
           size_t copy_size = Device::kP2PStagingSize;
           size_t left_size = size[0];
@@ -2216,11 +2709,13 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
             amd::Coord3D cpSize(copy_size);
 
             // Perform 2 step transfer with staging buffer
-            result &= srcDevMem->dev().xferMgr().copyBuffer(
-              *srcDevMem, *dstStgMem, srcOrigin, stageOffset, cpSize);
+            result &= StagedP2PCopy(srcDevMem->dev(), [&](const device::BlitManager& xfer) {
+              return xfer.copyBuffer(*srcDevMem, *dstStgMem, srcOrigin, stageOffset, cpSize);
+            });
             srcOrigin.c[0] += copy_size;
-            result &= dstDevMem->dev().xferMgr().copyBuffer(
-              *srcStgMem, *dstDevMem, stageOffset, dstOrigin, cpSize);
+            result &= StagedP2PCopy(dstDevMem->dev(), [&](const device::BlitManager& xfer) {
+              return xfer.copyBuffer(*srcStgMem, *dstDevMem, stageOffset, dstOrigin, cpSize);
+            });
             dstOrigin.c[0] += copy_size;
           } while (left_size > 0);
       }
@@ -2230,26 +2725,39 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
       if (p2pAllowed) {
         result = blitMgr().copyBufferRect(*srcDevMem, *dstDevMem, cmd.srcRect(), cmd.dstRect(), size,
                                           cmd.isEntireMemory(), cmd.copyMetadata());
+      } else if (relayDev != nullptr) {
+        result = StagedP2PCopy(*relayDev, [&](const device::BlitManager& xfer) {
+          return xfer.copyBufferRect(*srcRelayMem, *dstRelayMem, cmd.srcRect(), cmd.dstRect(),
+                                     size, cmd.isEntireMemory(), cmd.copyMetadata());
+        });
       } else {
         // Sync the current queue, since P2P staging uses the device queues for transfer
         releaseGpuMemoryFence();
 
-        amd::ScopedLock lock(dev().P2PStageOps());
+        // Only the transfers between the same pair of devices share the staging buffer
+        auto stage = dev().P2PStage(cmd.source().getContext().devices()[0],
+                                    cmd.destination().getContext().devices()[0]);
+        if (stage->buffer_ == nullptr) {
+          break;
+        }
+        amd::ScopedLock lock(stage->lock_);
         Memory* dstStgMem = static_cast<Memory*>(
-            dev().P2PStage()->getDeviceMemory(*cmd.source().getContext().devices()[0]));
+            stage->buffer_->getDeviceMemory(*cmd.source().getContext().devices()[0]));
         Memory* srcStgMem = static_cast<Memory*>(
-            dev().P2PStage()->getDeviceMemory(*cmd.destination().getContext().devices()[0]));
+            stage->buffer_->getDeviceMemory(*cmd.destination().getContext().devices()[0]));
 
         if ((cmd.srcRect().slicePitch_ * size[2]) <= Device::kP2PStagingSize) {
           result = true;
           // Perform 2 step transfer with staging buffer
-          result &= srcDevMem->dev().xferMgr().copyBufferRect(*srcDevMem, *dstStgMem, cmd.srcRect(),
-                                                              cmd.srcRect(), size, false,
-                                                              cmd.copyMetadata());
-
-          result &= dstDevMem->dev().xferMgr().copyBufferRect(*srcStgMem, *dstDevMem, cmd.srcRect(),
-                                                              cmd.dstRect(), size, false,
-                                                              cmd.copyMetadata());
+          result &= StagedP2PCopy(srcDevMem->dev(), [&](const device::BlitManager& xfer) {
+            return xfer.copyBufferRect(*srcDevMem, *dstStgMem, cmd.srcRect(), cmd.srcRect(), size,
+                                       false, cmd.copyMetadata());
+          });
+
+          result &= StagedP2PCopy(dstDevMem->dev(), [&](const device::BlitManager& xfer) {
+            return xfer.copyBufferRect(*srcStgMem, *dstDevMem, cmd.srcRect(), cmd.dstRect(), size,
+                                       false, cmd.copyMetadata());
+          });
         }
         else {
           size_t srcOffset;
@@ -2273,11 +2781,15 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
                 left_size -= copy_size;
 
                 // Perform 2 step transfer with staging buffer
-                result &= srcDevMem->dev().xferMgr().copyBuffer(*srcDevMem, *dstStgMem, srcOrigin,
-                                                                stageOffset, copy_size);
+                result &= StagedP2PCopy(srcDevMem->dev(), [&](const device::BlitManager& xfer) {
+                  return xfer.copyBuffer(*srcDevMem, *dstStgMem, srcOrigin, stageOffset,
+                                         copy_size);
+                });
 
-                result &= dstDevMem->dev().xferMgr().copyBuffer(*srcStgMem, *dstDevMem, stageOffset,
-                                                                dstOrigin, copy_size);
+                result &= StagedP2PCopy(dstDevMem->dev(), [&](const device::BlitManager& xfer) {
+                  return xfer.copyBuffer(*srcStgMem, *dstDevMem, stageOffset, dstOrigin,
+                                         copy_size);
+                });
 
                 srcOrigin.c[0] += copy_size;
                 dstOrigin.c[0] += copy_size;
@@ -2449,11 +2961,17 @@ void VirtualGPU::submitMapMemory(amd::MapMemoryCommand& cmd) {
         size.c[0] *= elemSize;
       }
 
-      if (mapMemory != nullptr) {
+      if (hsaMemory->IsMirrorValid(origin[0], size[0])) {
+        // The persistent mirror already holds the current data
+        result = true;
+      } else if (mapMemory != nullptr) {
         roc::Memory* hsaMapMemory =
             static_cast<roc::Memory*>(mapMemory->getDeviceMemory(dev(), false));
         result = blitMgr().copyBuffer(*hsaMemory, *hsaMapMemory, origin, dstOrigin, size,
                                       cmd.isEntireMemory());
+        if (result) {
+          hsaMemory->ValidateMirror(origin[0], size[0], hsaMemory->owner()->getVersion());
+        }
         void* svmPtr = devMemory->owner()->getSvmPtr();
         if ((svmPtr != nullptr) && (hostPtr != svmPtr)) {
           // Wait on a kernel if one is outstanding
@@ -2574,7 +3092,12 @@ void VirtualGPU::submitUnmapMemory(amd::UnmapMemoryCommand& cmd) {
       }
     }
 
+    const size_t version = cmd.memory().getVersion();
     cmd.memory().signalWrite(&dev());
+    if (cmd.status() >= CL_COMPLETE) {
+      // The persistent mirror stays current after the write of its own data
+      devMemory->ValidateMirror(mapInfo->origin_[0], mapInfo->region_[0], version);
+    }
   }
 
   devMemory->clearUnmapInfo(cmd.mapPtr());
@@ -2965,6 +3488,14 @@ bool VirtualGPU::createSchedulerParam()
   return false;
 }
 
+// ================================================================================================
+void VirtualGPU::waitScheduler() {
+  // The scheduler state and the virtual queue are reused only after the children are done
+  if ((0 != schedulerSignal_.handle) && !WaitForSignal(schedulerSignal_)) {
+    LogWarning("Failed schedulerSignal wait");
+  }
+}
+
 // ================================================================================================
 uint64_t VirtualGPU::getVQVirtualAddress()
 {
@@ -2978,7 +3509,10 @@ bool VirtualGPU::createVirtualQueue(uint deviceQueueSize)
   uint MinDeviceQueueSize = 16 * 1024;
   deviceQueueSize = std::max(deviceQueueSize, MinDeviceQueueSize);
 
-  maskGroups_ = deviceQueueSize / (512 * Ki);
+  // Give the scheduler at least one thread per CU, so the child kernels of a large queue are
+  // processed across the whole device instead of by 128 threads
+  uint targetThreads = std::max(128u, dev().info().maxComputeUnits_);
+  maskGroups_ = deviceQueueSize / (sizeof(AmdAqlWrap) * DeviceQueueMaskSize * targetThreads);
   maskGroups_ = (maskGroups_ == 0) ? 1 : maskGroups_;
 
   // Align the queue size for the multiple dispatch scheduler.
@@ -3136,6 +3670,24 @@ static inline void nontemporalMemcpy(
 #endif
 }
 
+uint32_t* VirtualGPU::gridSyncWorkspace() {
+  if (gridSyncWorkspace_ == nullptr) {
+    void* workspace = roc_device_.deviceLocalAlloc(Device::kGridSyncWorkspaceSize, true);
+    if (workspace == nullptr) {
+      LogError("Couldn't allocate the grid barrier workspace");
+      return nullptr;
+    }
+    if (hsa_amd_memory_fill(workspace, 0, Device::kGridSyncWorkspaceSize / sizeof(uint32_t)) !=
+        HSA_STATUS_SUCCESS) {
+      LogError("Couldn't clear the grid barrier workspace");
+      roc_device_.memFree(workspace, Device::kGridSyncWorkspaceSize);
+      return nullptr;
+    }
+    gridSyncWorkspace_ = reinterpret_cast<uint32_t*>(workspace);
+  }
+  return gridSyncWorkspace_;
+}
+
 void VirtualGPU::HiddenHeapInit() { const_cast<Device&>(dev()).HiddenHeapInit(*this); }
 
 // ================================================================================================
@@ -3143,9 +3695,11 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     const amd::Kernel& kernel, const_address parameters, void* event_handle,
     uint32_t sharedMemBytes, amd::NDRangeKernelCommand* vcmd,
     hsa_kernel_dispatch_packet_t* aql_packet, bool attach_signal) {
+  amd::activity_prof::LaunchStamp(amd::activity_prof::LAUNCH_STAGE_SUBMIT);
   device::Kernel* devKernel = const_cast<device::Kernel*>(kernel.getDeviceKernel(dev()));
   Kernel& gpuKernel = static_cast<Kernel&>(*devKernel);
   size_t ldsUsage = gpuKernel.WorkgroupGroupSegmentByteSize();
+  recorder_kernel_ = gpuKernel.nameHash();
   bool imageBufferWrtBack = false; // Image buffer write back is required
   std::vector<device::Memory*> wrtBackImageBuffer; // Array of images for write back
 
@@ -3188,19 +3742,51 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
         break;
       }
     }
+    // Split the long internal dispatches on low priority queues into the workgroup chunks,
+    // so the dispatches from the high priority queues don't wait behind the whole grid
+    if ((dim == -1) && (priority_ == amd::CommandQueue::Priority::Low) &&
+        (ROC_LOW_PRIORITY_CHUNK != 0)) {
+      size_t max_groups = 0;
+      for (uint i = 0; i < sizes.dimensions(); i++) {
+        size_t groups = (sizes.local()[i] != 0) ? (sizes.global()[i] / sizes.local()[i]) : 0;
+        if (groups > max_groups) {
+          max_groups = groups;
+          dim = i;
+        }
+      }
+      if (max_groups > ROC_LOW_PRIORITY_CHUNK) {
+        iteration = static_cast<int>((max_groups + ROC_LOW_PRIORITY_CHUNK - 1) /
+                                     ROC_LOW_PRIORITY_CHUNK);
+        globalStep = static_cast<size_t>(ROC_LOW_PRIORITY_CHUNK) * sizes.local()[dim];
+        ClPrint(amd::LOG_DEBUG, amd::LOG_KERN, "Low priority split of %s: %d chunks in dim %d",
+                gpuKernel.name().c_str(), iteration, dim);
+      } else {
+        dim = -1;
+      }
+    }
   }
 
   amd::Memory* const* memories =
       reinterpret_cast<amd::Memory* const*>(parameters + kernelParams.memoryObjOffset());
   bool isGraphCapture = currCmd_ != nullptr && currCmd_->getPktCapturingState();
+  // Time a sampled dispatch with a completion signal, the signal reuse collects the time
+  device::KernelStats* kernel_stats = nullptr;
+  if ((ROC_KERNEL_STATS != 0) && !isGraphCapture &&
+      gpuKernel.stats()->Sample(ROC_KERNEL_STATS)) {
+    kernel_stats = gpuKernel.stats();
+    enableQueueProfiling();
+  }
+  // The printf ring drains the buffer after the completion signal of the dispatch
+  bool printf_async = printfEnabled && printfDbg()->ring() && !isGraphCapture;
   for (int j = 0; j < iteration; j++) {
     // Reset global size for dimension dim if split is needed
     if (dim != -1) {
-      newOffset[dim] = sizes.offset()[dim] + globalStep * j;
-      if (((newOffset[dim] + globalStep) < sizes.global()[dim]) && (j != (iteration - 1))) {
+      size_t done = globalStep * j;
+      newOffset[dim] = sizes.offset()[dim] + done;
+      if (((done + globalStep) < sizes.global()[dim]) && (j != (iteration - 1))) {
         newGlobalSize[dim] = globalStep;
       } else {
-        newGlobalSize[dim] = sizes.global()[dim] - newOffset[dim];
+        newGlobalSize[dim] = sizes.global()[dim] - done;
       }
     }
 
@@ -3261,6 +3847,7 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
           uint64_t vqVA = 0;
           amd::DeviceQueue* defQueue = kernel.program().context().defDeviceQueue(dev());
           if (nullptr != defQueue && devKernel->dynamicParallelism()) {
+            waitScheduler();
             if (!createVirtualQueue(defQueue->size()) || !createSchedulerParam()) {
               return false;
             }
@@ -3272,6 +3859,7 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
         case amd::KernelParameterDescriptor::HiddenCompletionAction: {
           uint64_t spVA = 0;
           if (nullptr != schedulerParam_ && devKernel->dynamicParallelism()) {
+            waitScheduler();
             Memory* schedulerMem = dev().getRocMemory(schedulerParam_);
             AmdAqlWrap* wrap = reinterpret_cast<AmdAqlWrap*>(
                                reinterpret_cast<uint64_t>(schedulerParam_->getHostMem()) + sizeof(SchedulerParam));
@@ -3298,6 +3886,9 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
             syncInfo = reinterpret_cast<Device::MGSyncInfo*>(allocKernArg(Device::kSGInfoSize, 64));
             syncInfo->mgs = nullptr;
           }
+          if (syncInfo != nullptr) {
+            syncInfo->grid_sync = gridSyncWorkspace();
+          }
           if (multiGridSync || singleGridSync) {
             // Update sync data address.
             syncInfo->sgs = {0};
@@ -3409,7 +4000,8 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     size_t argSize = std::min(gpuKernel.KernargSegmentByteSize(), signature.paramsSize());
 
     // Find all parameters for the current kernel
-    if (!kernel.parameters().deviceKernelArgs() || gpuKernel.isInternalKernel()) {
+    bool deviceArgs = (vcmd != nullptr) && vcmd->deviceKernelArgs();
+    if (!deviceArgs || gpuKernel.isInternalKernel() || isGraphCapture) {
       // Allocate buffer to hold kernel arguments
       if (isGraphCapture) {
         argBuffer = currCmd_->getKernArgOffset(gpuKernel.KernargSegmentByteSize(),
@@ -3451,34 +4043,14 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
       return false;
     }
 
-    // Initialize the dispatch Packet
-    hsa_kernel_dispatch_packet_t dispatchPacket;
-    memset(&dispatchPacket, 0, sizeof(dispatchPacket));
+    // Initialize the dispatch Packet from the prebuilt template and patch the launch values
+    hsa_kernel_dispatch_packet_t dispatchPacket =
+        dispatchTemplate(gpuKernel, local, sizes.dimensions(), ldsUsage + sharedMemBytes);
 
-    dispatchPacket.header = kInvalidAql;
-    dispatchPacket.kernel_object = gpuKernel.KernelCodeHandle();
-
-   // dispatchPacket.header = aqlHeader_;
-    // dispatchPacket.setup |= sizes.dimensions() << HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS;
     dispatchPacket.grid_size_x = sizes.dimensions() > 0 ? newGlobalSize[0] : 1;
     dispatchPacket.grid_size_y = sizes.dimensions() > 1 ? newGlobalSize[1] : 1;
     dispatchPacket.grid_size_z = sizes.dimensions() > 2 ? newGlobalSize[2] : 1;
-
-    dispatchPacket.workgroup_size_x = sizes.dimensions() > 0 ? local[0] : 1;
-    dispatchPacket.workgroup_size_y = sizes.dimensions() > 1 ? local[1] : 1;
-    dispatchPacket.workgroup_size_z = sizes.dimensions() > 2 ? local[2] : 1;
-
     dispatchPacket.kernarg_address = argBuffer;
-    dispatchPacket.group_segment_size = ldsUsage + sharedMemBytes;
-    dispatchPacket.private_segment_size = devKernel->workGroupInfo()->privateMemSize_;
-
-    if ((devKernel->workGroupInfo()->usedStackSize_ & 0x1) == 0x1) {
-      dispatchPacket.private_segment_size =
-              std::max<uint64_t>(dev().StackSize(), dispatchPacket.private_segment_size);
-      if (dispatchPacket.private_segment_size > 16 * Ki) {
-        dispatchPacket.private_segment_size = 16 * Ki;
-      }
-    }
 
     // Pass the header accordingly
     auto aqlHeaderWithOrder = aqlHeader_;
@@ -3488,7 +4060,7 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     }
 
     if (vcmd != nullptr && vcmd->getEventScope() == amd::Device::kCacheStateSystem) {
-      addSystemScope_ = true;
+      addSystemScope_ = kSystemAcquireRelease;
     }
 
     // Copy scheduler's AQL packet for possible relaunch from the scheduler itself
@@ -3512,14 +4084,19 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     } else {
       if (!dispatchAqlPacket(&dispatchPacket, aqlHeaderWithOrder,
                              (sizes.dimensions() << HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS),
-                             GPU_FLUSH_ON_EXECUTION, false, nullptr, attach_signal)) {
+                             GPU_FLUSH_ON_EXECUTION, false, nullptr,
+                             attach_signal || (kernel_stats != nullptr) || printf_async)) {
         return false;
       }
+      if (kernel_stats != nullptr) {
+        Barriers().GetLastSignal()->kernel_stats_ = kernel_stats;
+      }
     }
   }
+  amd::activity_prof::LaunchStamp(amd::activity_prof::LAUNCH_STAGE_PUBLISHED);
 
   // Output printf buffer
-  if (!printfDbg()->output(*this, printfEnabled, gpuKernel.printfInfo())) {
+  if (!printfDbg()->output(*this, printfEnabled, gpuKernel.printfInfo(), printf_async)) {
     LogError("\nCould not print data from the printf buffer!");
     return false;
   }
@@ -3527,9 +4104,14 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
   if (gpuKernel.dynamicParallelism()) {
     dispatchBarrierPacket(kBarrierPacketHeader, true);
     if (virtualQueue_ != nullptr) {
-      static_cast<KernelBlitManager&>(blitMgr()).runScheduler(
+      if (static_cast<KernelBlitManager&>(blitMgr()).runScheduler(
           getVQVirtualAddress(), schedulerParam_, schedulerQueue_,
-          schedulerSignal_, schedulerThreads_);
+          schedulerSignal_, schedulerThreads_)) {
+        // The scheduler relaunches itself on the child queue until all children are done.
+        // Make the later work in the queue wait for it on the device, so the host isn't blocked
+        barrier_packet_.dep_signal[0] = schedulerSignal_;
+        dispatchBarrierPacket(kBarrierPacketHeader, true);
+      }
     }
   }
 
@@ -3552,6 +4134,55 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
   return true;
 }
 
+// ================================================================================================
+const hsa_kernel_dispatch_packet_t& VirtualGPU::dispatchTemplate(const Kernel& gpuKernel,
+    const amd::NDRange& local, uint32_t dims, uint32_t groupSegmentSize) {
+  const uint64_t code = gpuKernel.KernelCodeHandle();
+  const uint16_t localX = dims > 0 ? static_cast<uint16_t>(local[0]) : 1;
+  const uint16_t localY = dims > 1 ? static_cast<uint16_t>(local[1]) : 1;
+  const uint16_t localZ = dims > 2 ? static_cast<uint16_t>(local[2]) : 1;
+
+  // Kernel descriptors are 64 bytes aligned, hence skip the low bits for the index
+  DispatchTemplate& entry = dispatch_templates_[(code >> 6) % kDispatchTemplates];
+  if ((entry.kernel_object_ == code) && (entry.group_segment_size_ == groupSegmentSize) &&
+      (entry.local_[0] == localX) && (entry.local_[1] == localY) && (entry.local_[2] == localZ) &&
+      (entry.dims_ == dims) && (entry.stack_size_ == dev().StackSize()) &&
+      (entry.private_size_ == gpuKernel.workGroupInfo()->privateMemSize_)) {
+    return entry.packet_;
+  }
+
+  hsa_kernel_dispatch_packet_t& packet = entry.packet_;
+  memset(&packet, 0, sizeof(packet));
+
+  // The header and setup are filled in the dispatch, since they depend on the command
+  packet.header = kInvalidAql;
+  packet.kernel_object = code;
+  packet.workgroup_size_x = localX;
+  packet.workgroup_size_y = localY;
+  packet.workgroup_size_z = localZ;
+  packet.grid_size_x = packet.grid_size_y = packet.grid_size_z = 1;
+  packet.group_segment_size = groupSegmentSize;
+  packet.private_segment_size = gpuKernel.workGroupInfo()->privateMemSize_;
+
+  if ((gpuKernel.workGroupInfo()->usedStackSize_ & 0x1) == 0x1) {
+    packet.private_segment_size =
+            std::max<uint64_t>(dev().StackSize(), packet.private_segment_size);
+    if (packet.private_segment_size > 16 * Ki) {
+      packet.private_segment_size = 16 * Ki;
+    }
+  }
+
+  entry.kernel_object_ = code;
+  entry.stack_size_ = dev().StackSize();
+  entry.private_size_ = gpuKernel.workGroupInfo()->privateMemSize_;
+  entry.group_segment_size_ = groupSegmentSize;
+  entry.local_[0] = localX;
+  entry.local_[1] = localY;
+  entry.local_[2] = localZ;
+  entry.dims_ = dims;
+  return packet;
+}
+
 /**
  * @brief Api to dispatch a kernel for execution. The implementation
  * parses the input object, an instance of virtual command to obtain
@@ -3641,7 +4272,21 @@ void VirtualGPU::submitMarker(amd::Marker& vcmd) {
       if (timestamp_ != nullptr) {
         const Settings& settings = dev().settings();
         int32_t releaseFlags = vcmd.getEventScope();
-        if (releaseFlags == Device::CacheState::kCacheStateIgnore) {
+        auto& blit = static_cast<KernelBlitManager&>(blitMgr());
+        if (ROC_TIMESTAMP_KERNEL && vcmd.profilingInfo().marker_ts_ &&
+            blit.HasTimestampKernel()) {
+          // A single dispatch replaces the barrier and gives the time without queue profiling
+          if (releaseFlags != Device::CacheState::kCacheStateIgnore) {
+            addSystemScope();
+          }
+          if (!blit.RunTimestamp()) {
+            LogError("Timestamp kernel dispatch failed!");
+            vcmd.setStatus(CL_INVALID_OPERATION);
+          }
+          if (releaseFlags != Device::CacheState::kCacheStateIgnore) {
+            hasPendingDispatch_ = false;
+          }
+        } else if (releaseFlags == Device::CacheState::kCacheStateIgnore) {
           if (settings.barrier_value_packet_ && vcmd.profilingInfo().marker_ts_) {
             dispatchBarrierValuePacket(kBarrierVendorPacketNopScopeHeader, true);
           } else {
@@ -3685,7 +4330,8 @@ void VirtualGPU::submitAcquireExtObjects(amd::AcquireExtObjectsCommand& vcmd) {
   amd::ScopedLock lock(execution());
 
   profilingBegin(vcmd);
-  addSystemScope();
+  // The external objects were written outside of the GPU caches, only the invalidation is needed
+  addSystemScope(kSystemAcquire);
   profilingEnd(vcmd);
 }
 
@@ -31,6 +31,8 @@
 #include "hsa/hsa_ven_amd_aqlprofile.h"
 #include "rocsched.hpp"
 #include "device/device.hpp"
+#include "device/devmemorytracker.hpp"
+#include "platform/trace_events.hpp"
 
 namespace amd::roc {
 class Device;
@@ -49,9 +51,32 @@ constexpr static uint64_t kUnlimitedWait = std::numeric_limits<uint64_t>::max();
 // then just wait instead of adding dependency wait signal.
 constexpr static uint64_t kForcedTimeout10us = 10;
 
+// Blocked wait time, after which GPU_ANALYZE_HANG reports a possible hang
+constexpr static uint64_t kAnalyzeHangTimeout = 10ull * 1000 * 1000 * 1000;
+
+//! Dumps the flight recorders of all queues on all devices into the log output
+void DumpFlightRecorders();
+
+//! Waits for the signal completion with CPU suspend. With GPU_ANALYZE_HANG the flight recorders
+//! are dumped, if the wait exceeds the hang timeout
+inline bool BlockedWaitForSignal(hsa_signal_t signal) {
+  if (GPU_ANALYZE_HANG) {
+    if (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                  kAnalyzeHangTimeout, HSA_WAIT_STATE_BLOCKED) == 0) {
+      return true;
+    }
+    LogPrintfError("Wait for Signal = (0x%lx) exceeded %lu s, possible GPU hang",
+                   signal.handle, kAnalyzeHangTimeout / (1000ull * 1000 * 1000));
+    DumpFlightRecorders();
+  }
+  return hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                   kUnlimitedWait, HSA_WAIT_STATE_BLOCKED) == 0;
+}
+
 template <bool active_wait_timeout = false>
 inline bool WaitForSignal(hsa_signal_t signal, bool active_wait = false, bool forced_wait = false) {
   if (hsa_signal_load_relaxed(signal) > 0) {
+    amd::TraceEvents::Scope trace(amd::TraceEvents::Wait, "WaitForSignal");
     uint64_t timeout = kTimeout100us;
     if (active_wait) {
       timeout = kUnlimitedWait;
@@ -77,8 +102,7 @@ inline bool WaitForSignal(hsa_signal_t signal, bool active_wait = false, bool fo
               signal.handle);
 
       // Wait until the completion with CPU suspend
-      if (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
-                                    kUnlimitedWait, HSA_WAIT_STATE_BLOCKED) != 0) {
+      if (!BlockedWaitForSignal(signal)) {
         return false;
       }
     }
@@ -87,6 +111,68 @@ inline bool WaitForSignal(hsa_signal_t signal, bool active_wait = false, bool fo
   return true;
 }
 
+// Active wait window limits for the adaptive host wait
+constexpr static uint64_t kAdaptiveMinSpin = 5 * K;
+constexpr static uint64_t kAdaptiveMaxSpin = 200 * K;
+
+// Number of submissions on the idle queue before the signal pool can be trimmed
+constexpr static uint32_t kSignalTrimIdleCount = 256;
+
+//! Flight recorder of the recent AQL packets on the queue. It's cheap enough to be always on and
+//! shows what the queue was doing, when the recorders are dumped on a hang
+class FlightRecorder : public amd::EmbeddedObject {
+ public:
+  struct Entry {
+    uint64_t time_;        //!< Submission time in ns
+    uint64_t index_;       //!< AQL write index of the packet
+    uint64_t signal_;      //!< Completion signal of the packet
+    uint64_t kernel_;      //!< Hash of the kernel name for the kernel dispatches
+    uint32_t command_;     //!< Type of the submitted command, 0 if unknown
+    uint16_t header_;      //!< AQL packet header
+  };
+
+  FlightRecorder() {}
+  ~FlightRecorder() { delete[] entries_; }
+
+  //! Allocates the ring for the requested number of packets, rounded up to a power of two
+  bool Create(uint32_t size);
+
+  //! Records a submitted packet. The queue owner is the only writer
+  void Record(uint64_t index, uint16_t header, uint64_t signal, uint64_t kernel,
+              uint32_t command) {
+    if (entries_ != nullptr) {
+      uint64_t count = count_.load(std::memory_order_relaxed);
+      entries_[count & mask_] = {amd::Os::timeNanos(), index, signal, kernel, command, header};
+      count_.store(count + 1, std::memory_order_release);
+    }
+  }
+
+  //! Prints the recorded packets. The entries may be overwritten during the dump, since
+  //! the recorder doesn't block the submissions
+  void Dump(FILE* file, uint64_t queue_id, uint64_t read_index) const;
+
+ private:
+  Entry* entries_ = nullptr;           //!< Ring of the recorded packets
+  uint32_t mask_ = 0;                  //!< Ring size mask
+  std::atomic<uint64_t> count_{0};     //!< The number of the recorded packets
+};
+
+//! Adaptive host wait policy. It keeps the history of the wait times on the queue and
+//! actively waits for the expected completion window, before it falls back to the interrupt wait
+class AdaptiveWait : public amd::EmbeddedObject {
+ public:
+  AdaptiveWait() {}
+  ~AdaptiveWait();
+
+  //! Waits for the signal completion. Returns false if the wait failed
+  bool Wait(hsa_signal_t signal);
+
+ private:
+  uint64_t  avg_wait_ = 0;      //!< Moving average of the wait times in ns
+  uint64_t  spin_hits_ = 0;     //!< The number of waits, completed in the active window
+  uint64_t  spin_misses_ = 0;   //!< The number of waits, which switched to the interrupt wait
+};
+
 inline void fetchSignalTime(hsa_signal_t signal, hsa_agent_t gpu_device,
                             uint64_t* start, uint64_t* end) {
   if (start != nullptr && end != nullptr) {
@@ -214,16 +300,13 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel() { ranges_.newKernel(); }
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
@@ -232,19 +315,10 @@ class VirtualGPU : public device::VirtualDevice {
     void clear(bool all = true);
 
     //! Max number of mem objects in the queue
-    size_t maxMemObjectsInQueue() const { return maxMemObjectsInQueue_; }
+    size_t maxMemObjectsInQueue() const { return ranges_.maxRanges(); }
 
    private:
-    struct MemoryState {
-      uint64_t start_;  //! Busy memory start address
-      uint64_t end_;    //! Busy memory end address
-      bool readOnly_;   //! Current GPU state in the queue
-    };
-
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    amd::device::MemoryRangeTracker ranges_;  //!< The memory ranges of the kernels in the queue
   };
 
   class HwQueueTracker : public amd::EmbeddedObject {
@@ -279,18 +353,34 @@ class VirtualGPU : public device::VirtualDevice {
 
     //! Adds an external signal(submission in another queue) for dependency tracking
     void AddExternalSignal(ProfilingSignal* signal) {
+      // Several events of the same producer can share the signal, hence skip the duplicates
+      for (auto external : external_signals_) {
+        if (external->signal_.handle == signal->signal_.handle) {
+          return;
+        }
+      }
       external_signals_.push_back(signal);
     }
 
     //! Get the last active signal on the queue
     ProfilingSignal* GetLastSignal() const { return signal_list_[current_id_]; }
 
+    //! Adds the GPU time of the completed sampled dispatch into the kernel statistics
+    void HarvestKernelStats(ProfilingSignal* signal) const;
+
+    //! Wait for a signal, previously obtained with GetLastSignal()
+    bool WaitSignal(ProfilingSignal* signal) { return CpuWaitForSignal(signal); }
+
     //! Clear external signals
     void ClearExternalSignals() { external_signals_.clear(); }
 
     //! Empty check for external signals
     bool IsExternalSignalListEmpty() const { return external_signals_.empty(); }
 
+    //! Signal pool telemetry
+    size_t SignalPoolSize() const { return signal_list_.size(); }
+    uint64_t ForcedWaits() const { return forced_waits_; }
+
     //! Get/Set SDMA profiling
     bool GetSDMAProfiling() { return sdma_profiling_; }
     void SetSDMAProfiling(bool profile) {
@@ -308,6 +398,12 @@ class VirtualGPU : public device::VirtualDevice {
     //! Wait for the provided signal
     bool CpuWaitForSignal(ProfilingSignal* signal);
 
+    //! Allocates a new signal for the pool
+    ProfilingSignal* CreateSignal() const;
+
+    //! Releases the signals above the initial pool size if the queue is idle
+    void TrimIdle();
+
     HwQueueEngine engine_ = HwQueueEngine::Unknown; //!< Engine used in the current operations
     std::vector<ProfilingSignal*> signal_list_;     //!< The pool of all signals for processing
     size_t current_id_ = 0;       //!< Last submitted signal
@@ -315,6 +411,13 @@ class VirtualGPU : public device::VirtualDevice {
     const VirtualGPU& gpu_;       //!< VirtualGPU, associated with this tracker
     std::vector<ProfilingSignal*> external_signals_; //!< External signals for a wait in this queue
     std::vector<hsa_signal_t> waiting_signals_;   //!< Current waiting signals in this queue
+    AdaptiveWait adaptive_wait_;  //!< Adaptive host wait policy for this queue
+    uint32_t idle_count_ = 0;     //!< Number of submissions, which found the queue idle
+    size_t peak_size_ = 0;        //!< The peak size of the signal pool
+    uint64_t forced_waits_ = 0;   //!< Number of host waits, forced by the signal reuse
+    uint64_t grows_ = 0;          //!< Number of signals added to the pool
+    uint64_t cap_hits_ = 0;       //!< Number of times the pool size limit stopped the growth
+    uint64_t trims_ = 0;          //!< Number of times the pool was trimmed
   };
 
   VirtualGPU(Device& device, bool profiling = false, bool cooperative = false,
@@ -328,12 +431,17 @@ class VirtualGPU : public device::VirtualDevice {
   void profilingBegin(amd::Command& command, bool sdmaProfiling = false);
   void profilingEnd(amd::Command& command);
 
+  //! Enables the HW queue profiling, if it was deferred with the timestamp kernel
+  void enableQueueProfiling();
+
   void updateCommandsState(amd::Command* list) const;
 
   void submitReadMemory(amd::ReadMemoryCommand& cmd);
   void submitWriteMemory(amd::WriteMemoryCommand& cmd);
   void submitCopyMemory(amd::CopyMemoryCommand& cmd);
   void submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd);
+  void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd);
+  void submitWriteMemoryInline(amd::WriteMemoryInlineCommand& cmd);
   void submitMapMemory(amd::MapMemoryCommand& cmd);
   void submitUnmapMemory(amd::UnmapMemoryCommand& cmd);
   void submitKernel(amd::NDRangeKernelCommand& cmd);
@@ -422,8 +530,17 @@ class VirtualGPU : public device::VirtualDevice {
 
   void hasPendingDispatch() { hasPendingDispatch_ = true; }
   bool IsPendingDispatch() const { return (hasPendingDispatch_) ? true : false; }
-  void addSystemScope() {
-    addSystemScope_ = true;
+  //! The system scope fences of the next AQL packet
+  enum SystemScope : uint32_t {
+    kSystemAcquire = 1,  //!< Invalidates L2, the memory was written outside of the GPU caches
+    kSystemRelease = 2,  //!< Writes back L2, the host or a peer consumes the memory
+    kSystemAcquireRelease = kSystemAcquire | kSystemRelease
+  };
+  //! Requests the system scope fences for the next AQL packet. The runtime operations, which
+  //! know the memory they touch, request only the side they need, since the system release
+  //! writes back the whole L2
+  void addSystemScope(uint32_t scope = kSystemAcquireRelease) {
+    addSystemScope_ |= scope;
     fence_state_ = amd::Device::CacheState::kCacheStateInvalid;
   }
   void SetCopyCommandType(cl_command_type type) { copy_command_type_ = type; }
@@ -433,13 +550,49 @@ class VirtualGPU : public device::VirtualDevice {
   Timestamp* timestamp() const { return timestamp_; }
 
   void* allocKernArg(size_t size, size_t alignment);
+
+  //! Returns the zeroed workspace of the hierarchical grid barrier, the barrier leaves the
+  //! counters zeroed, hence the cooperative launches on the queue reuse it
+  uint32_t* gridSyncWorkspace();
   bool isFenceDirty() const { return fence_dirty_; }
+  uint64_t hwQueueLoad() const { return Device::queueLoad(gpu_queue_); }
+  bool setCuMask(const std::vector<uint32_t>& cuMask);
   void HiddenHeapInit();
 
   void setLastUsedSdmaEngine(uint32_t mask) { lastUsedSdmaEngineMask_ = mask; }
   uint32_t getLastUsedSdmaEngine() const { return lastUsedSdmaEngineMask_.load(); }
   uint64_t getQueueID() { return gpu_queue_->id; }
 
+  //! Prints the recent packets of the queue
+  void DumpFlightRecorder(FILE* file) const {
+    if (gpu_queue_ != nullptr) {
+      flight_recorder_.Dump(file, gpu_queue_->id, hsa_queue_load_read_index_relaxed(gpu_queue_));
+    }
+  }
+
+  //! Submits all AQL packets, which were batched without a doorbell update
+  void FlushDoorbell() {
+    if (pending_doorbell_packets_ > 0) {
+      RingDoorbell(pending_doorbell_index_);
+    }
+  }
+
+  //! Batches all packets without a signal until EndPacketBatch(), the caller holds execution()
+  void BeginPacketBatch() override {
+    if (batch_depth_++ == 0) {
+      saved_aql_batch_size_ = aql_batch_size_;
+      aql_batch_size_ = std::numeric_limits<uint32_t>::max();
+    }
+  }
+
+  //! Restores the doorbell batching and submits the batched packets
+  void EndPacketBatch() override {
+    if (--batch_depth_ == 0) {
+      aql_batch_size_ = saved_aql_batch_size_;
+      FlushDoorbell();
+    }
+  }
+
   // } roc OpenCL integration
  private:
   //! Dispatches a barrier with blocking HSA signals
@@ -447,6 +600,9 @@ class VirtualGPU : public device::VirtualDevice {
 
   inline bool dispatchAqlPacket(uint8_t* aqlpacket, const std::string& kernelName,
                                 amd::AccumulateCommand* vcmd = nullptr);
+  bool dispatchAqlPackets(const std::vector<uint8_t*>& aqlpackets,
+                          const std::vector<const std::string*>& kernelNames,
+                          amd::AccumulateCommand* vcmd = nullptr);
   bool dispatchAqlPacket(hsa_kernel_dispatch_packet_t* packet, uint16_t header, uint16_t rest,
                          bool blocking = true, bool capturing = false,
                          const uint8_t* aqlPacket = nullptr, bool attach_signal = false);
@@ -474,6 +630,23 @@ class VirtualGPU : public device::VirtualDevice {
   bool initPool(size_t kernarg_pool_size);
   void destroyPool();
 
+  //! Allocates memory and signals for a new kernel arguments pool
+  bool allocPool(uint32_t pool_size, address* pool_base, std::vector<hsa_signal_t>* signals);
+
+  //! Frees the memory of a kernel arguments pool
+  void freePool(address pool_base, uint32_t pool_size);
+
+  //! Replaces the current kernel arguments pool with a bigger one, if the limit allows
+  bool growPool(size_t min_size);
+
+  //! Releases kernel argument pools, retired after growth. Queue must be idle
+  void releaseRetiredPools();
+
+  //! Returns the prebuilt dispatch packet for the kernel launch shape
+  const hsa_kernel_dispatch_packet_t& dispatchTemplate(const Kernel& gpuKernel,
+                                                       const amd::NDRange& local, uint32_t dims,
+                                                       uint32_t groupSegmentSize);
+
   void resetKernArgPool() {
     kernarg_pool_cur_offset_ = 0;
     kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
@@ -481,6 +654,8 @@ class VirtualGPU : public device::VirtualDevice {
   }
 
   uint64_t getVQVirtualAddress();
+  //! Waits for the child kernels of the previous parent kernel
+  void waitScheduler();
 
   bool createSchedulerParam();
 
@@ -515,6 +690,12 @@ class VirtualGPU : public device::VirtualDevice {
   //! Updates AQL header for the upcomming dispatch
   void setAqlHeader(uint16_t header) { aqlHeader_ = header; }
 
+  //! Updates the doorbell with the provided write index. It also submits all batched packets
+  void RingDoorbell(uint64_t index) {
+    hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+    pending_doorbell_packets_ = 0;
+  }
+
   //! Resets the current queue state. Note: should be called after AQL queue becomes idle
   void ResetQueueStates();
 
@@ -526,9 +707,10 @@ class VirtualGPU : public device::VirtualDevice {
       uint32_t hasPendingDispatch_    : 1; //!< A kernel dispatch is outstanding
       uint32_t profiling_             : 1; //!< Profiling is enabled
       uint32_t cooperative_           : 1; //!< Cooperative launch is enabled
-      uint32_t addSystemScope_        : 1; //!< Insert a system scope to the next aql
+      uint32_t addSystemScope_        : 2; //!< SystemScope fences of the next aql
       uint32_t tracking_created_      : 1; //!< Enabled if tracking object was properly initialized
       uint32_t retainExternalSignals_ : 1; //!< Indicate to retain external signal array
+      uint32_t queueProfiling_        : 1; //!< The profiling was enabled on the HW queue
     };
     uint32_t  state_;
   };
@@ -553,6 +735,7 @@ class VirtualGPU : public device::VirtualDevice {
 
   amd::Memory* schedulerParam_;
   hsa_queue_t* schedulerQueue_;
+  uint32_t* gridSyncWorkspace_;   //!< Hierarchical grid barrier counters
   hsa_signal_t schedulerSignal_;
 
   HwQueueTracker  barriers_;      //!< Tracks active barriers in ROCr
@@ -566,10 +749,35 @@ class VirtualGPU : public device::VirtualDevice {
   uint32_t  kernarg_pool_cur_offset_;
   std::vector<hsa_signal_t> kernarg_pool_signal_; //!< Pool of HSA signals to manage
                                                   //!< multiple chunks
+  //! Kernel argument pool, which was replaced with a bigger one and can't be freed until idle
+  struct RetiredPool {
+    address   base_;                      //!< Base address of the retired pool
+    uint32_t  size_;                      //!< Size of the retired pool
+    std::vector<hsa_signal_t> signals_;   //!< Chunk signals of the retired pool
+  };
+  std::vector<RetiredPool> kernarg_retired_pools_;  //!< Pools, retired after growth
+  uint32_t  kernarg_pool_high_water_ = 0; //!< The max offset ever used in the pool
+  uint32_t  kernarg_pool_waits_ = 0;      //!< The number of CPU waits for a busy chunk
+  uint32_t  kernarg_pool_grows_ = 0;      //!< The number of pool growths
+
+  //! Dispatch packet, prebuilt for the repeated launches of the same kernel and shape.
+  //! Only the grid size and kernel arguments address change between launches
+  struct DispatchTemplate {
+    uint64_t  kernel_object_ = 0;       //!< Kernel code handle, 0 for the empty entry
+    uint64_t  stack_size_ = 0;          //!< Device stack size used for the private segment
+    uint64_t  private_size_ = 0;        //!< Kernel private memory size
+    uint32_t  group_segment_size_ = 0;  //!< Static and dynamic LDS size
+    uint16_t  local_[3] = {};           //!< Workgroup size
+    uint16_t  dims_ = 0;                //!< The number of dimensions
+    hsa_kernel_dispatch_packet_t packet_ = {};  //!< Prebuilt packet
+  };
+  static constexpr uint32_t kDispatchTemplates = 64;          //!< Number of cached templates
+  DispatchTemplate dispatch_templates_[kDispatchTemplates];  //!< Cached dispatch templates
 
   ManagedBuffer managed_buffer_;  //!< Memory manager for staging copies
 
   friend class Timestamp;
+  friend class PerfCounterSampler;
 
   //  PM4 packet for gfx8 performance counter
   enum {
@@ -581,7 +789,7 @@ class VirtualGPU : public device::VirtualDevice {
   uint16_t dispatchPacketHeader_;
 
   //!< bit-vector representing the CU mask. Each active bit represents using one CU
-  const std::vector<uint32_t> cuMask_;
+  std::vector<uint32_t> cuMask_;
   amd::CommandQueue::Priority priority_; //!< The priority for the hsa queue
 
   cl_command_type copy_command_type_;   //!< Type of the copy command, used for ROC profiler
@@ -593,8 +801,17 @@ class VirtualGPU : public device::VirtualDevice {
 
   std::atomic<uint> lastUsedSdmaEngineMask_;     //!< Last Used SDMA Engine mask
 
+  uint32_t  aql_batch_size_ = 0;          //!< The max number of packets per doorbell update
+  uint32_t  pending_doorbell_packets_ = 0;  //!< The number of packets without doorbell update
+  uint64_t  pending_doorbell_index_ = 0;  //!< The write index of the last batched packet
+  uint32_t  saved_aql_batch_size_ = 0;    //!< The batch size outside of BeginPacketBatch()
+  uint32_t  batch_depth_ = 0;             //!< The nesting of BeginPacketBatch() calls
+
   using KernelArgImpl = device::Settings::KernelArgImpl;
 
   amd::Command* currCmd_ = nullptr;  //!< Current command under capture
+  FlightRecorder flight_recorder_;   //!< Recent packets on the queue for the hang analysis
+  uint64_t recorder_kernel_ = 0;     //!< Kernel name hash for the next recorded dispatch
+  uint32_t recorder_command_ = 0;    //!< Command type for the recorded packets
 };
 }
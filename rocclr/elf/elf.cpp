@@ -185,6 +185,7 @@ Elf::Elf (
   _shstrtab_ndx (SHN_UNDEF),
   _strtab_ndx (SHN_UNDEF),
   _symtab_ndx (SHN_UNDEF),
+  _symbolIndexValid (false),
   _successful (false)
 {
   LogElfInfo("fname=%s, rawElfSize=%lu, elfcmd=%d, %s",
@@ -241,7 +242,9 @@ bool Elf::Init()
         return false;
       }
       {
-        std::istringstream is { std::string(_rawElfBytes, _rawElfSize) };
+        // The stream reads rawElfBytes in place, only the section data is copied
+        image_streambuf buf(_rawElfBytes, _rawElfSize);
+        std::istream is(&buf);
         if (!_elfio.load(is)) {
           LogElfError("failed in _elfio.load(%p, %lu)", _rawElfBytes, _rawElfSize);
           return false;
@@ -249,6 +252,17 @@ bool Elf::Init()
       }
       break;
 
+    case ELF_C_READ_MMAP:
+      if(_rawElfBytes == nullptr || _rawElfSize == 0) {
+        logElfError("failed: _rawElfBytes = nullptr or _rawElfSize = 0");
+        return false;
+      }
+      if (!_elfio.load(_rawElfBytes, _rawElfSize)) {
+        LogElfError("failed in _elfio.load(%p, %lu) of the view", _rawElfBytes, _rawElfSize);
+        return false;
+      }
+      break;
+
     default:
       LogElfError("failed: unexpected cmd %d", _elfCmd);
       return false; // Don't support other mode
@@ -266,7 +280,7 @@ bool Elf::Init()
 
 bool Elf::InitElf ()
 {
-  if (_elfCmd == ELF_C_READ) {
+  if (isReader()) {
     assert(_elfio.sections.size() > 0 && "elfio object should have been created already");
 
     // Set up _shstrtab_ndx
@@ -746,6 +760,13 @@ bool Elf::addSymbol(
   auto ret = symbol_writter.add_symbol(strtab_offset, sec_offset, size, 0,
                      (isFunction)? STT_FUNC : STT_OBJECT, 0, sec_ndx);
 
+  {
+    // The next query rebuilds the name index with the new symbol
+    std::lock_guard<std::mutex> lock(_symbolIndexLock);
+    _symbolIndexValid = false;
+    _symbolIndex.clear();
+  }
+
   LogElfDebug("%s: sectionName=%s symbolName=%s strtab_offset=%lu, sec_offset=%lu, "
       "size=%zu, sec_ndx=%zu, ret=%d", ret >= 1 ? "succeeded" : "failed",
           sectionName, symbolName, strtab_offset, sec_offset, size, sec_ndx, ret);
@@ -773,18 +794,22 @@ bool Elf::getSymbol(
 
   *size = 0;
   *buffer = nullptr;
-  symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
 
   Elf64_Addr value = 0;
   Elf_Xword  size0 = 0;
-  unsigned char bind = 0;
-  unsigned char type = 0;
-  unsigned char other = 0;
   Elf_Half sec_ndx = SHN_UNDEF;
 
   // Search by symbolName, sectionName
-  bool ret = symbol_reader.get_symbol(symbolName, ElfSecDesc[id].name, value, size0,
-                    bind, type, sec_ndx, other);
+  Elf_Xword index = 0;
+  bool ret = findSymbol(symbolName, ElfSecDesc[id].name, &index);
+  if (ret) {
+    symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
+    std::string name;
+    unsigned char bind = 0;
+    unsigned char type = 0;
+    unsigned char other = 0;
+    ret = symbol_reader.get_symbol(index, name, value, size0, bind, type, sec_ndx, other);
+  }
 
   if (ret) {
     *buffer = const_cast<char*>(_elfio.sections[sec_ndx]->get_data() + value);
@@ -799,6 +824,57 @@ bool Elf::getSymbol(
   return ret;
 }
 
+bool Elf::findSymbol(const char* symbolName, const char* sectionName, Elf_Xword* index) const
+{
+  std::lock_guard<std::mutex> lock(_symbolIndexLock);
+  if (!_symbolIndexValid) {
+    // One pass over .symtab, so a code object with many kernels and globals doesn't walk
+    // the whole table for every name
+    symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
+    const Elf_Xword num = symbol_reader.get_symbols_num();
+    _symbolIndex.clear();
+    _symbolIndex.reserve(num);
+
+    std::string   sym_name;
+    Elf64_Addr    value = 0;
+    Elf_Xword     size = 0;
+    unsigned char bind = 0;
+    unsigned char type = 0;
+    Elf_Half      sec_index = 0;
+    unsigned char other = 0;
+    // Skip the first dummy symbol
+    for (Elf_Xword i = 1; i < num; ++i) {
+      if (symbol_reader.get_symbol(i, sym_name, value, size, bind, type, sec_index, other)) {
+        _symbolIndex.emplace(sym_name, i);
+      }
+    }
+    _symbolIndexValid = true;
+    LogElfDebug("built the symbol index: num=%lu", num);
+  }
+
+  symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
+  auto range = _symbolIndex.equal_range(symbolName);
+  for (auto it = range.first; it != range.second; ++it) {
+    std::string   sym_name;
+    Elf64_Addr    value = 0;
+    Elf_Xword     size = 0;
+    unsigned char bind = 0;
+    unsigned char type = 0;
+    Elf_Half      sec_index = SHN_UNDEF;
+    unsigned char other = 0;
+    if (!symbol_reader.get_symbol(it->second, sym_name, value, size, bind, type, sec_index,
+                                  other)) {
+      continue;
+    }
+    const section* sec = _elfio.sections[sec_index];
+    if ((sec != nullptr) && (sec->get_name() == sectionName)) {
+      *index = it->second;
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Elf::addNote(
     const char* noteName,
     const char* noteDesc,
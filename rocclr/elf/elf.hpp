@@ -22,6 +22,9 @@
 #define ELF_HPP_
 
 #include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "top.hpp"
 #include "elfio/elfio.hpp"
@@ -142,6 +145,7 @@ public:
         ELF_C_READ,
         ELF_C_SET,
         ELF_C_WRITE,
+        ELF_C_READ_MMAP,
         ELF_C_NUM
     } ElfCmd;
 
@@ -196,6 +200,13 @@ private:
     Elf64_Word    _strtab_ndx; // Indexes of .strtab. Must be valid.
     Elf64_Word    _symtab_ndx; // Indexes of .symtab. May be SHN_UNDEF.
 
+    // Name to .symtab index of all symbols, built on the first query by name and dropped when
+    // a symbol is added. The names may repeat in different sections.
+    typedef std::unordered_multimap<std::string, Elf_Xword> SymbolIndex;
+    mutable SymbolIndex _symbolIndex;
+    mutable bool        _symbolIndexValid;
+    mutable std::mutex  _symbolIndexLock;
+
     bool _successful;
 
 public:
@@ -203,13 +214,19 @@ public:
     /*
        Elf object can be created for reading or writing (it could be created for
        both reading and writing, which is not supported yet at this time). Currently,
-       it has two forms:
+       it has three forms:
 
         1)  Elf(eclass, rawElfBytes, rawElfSize, 0, ELF_C_READ)
 
             To load ELF from raw bytes in memory and generate Elf object. And this
             object is for reading only.
 
+        1a) Elf(eclass, rawElfBytes, rawElfSize, 0, ELF_C_READ_MMAP)
+
+            Same as 1), but the sections and segments are views of rawElfBytes and no data is
+            copied, hence rawElfBytes (e.g. a file mapped by amd::Os::MemoryMapFile) must
+            outlive the Elf object. The returned data must not be modified.
+
         2)  Elf(eclass,  nullptr, 0, elfFileName|nullptr, ELF_C_WRITE)
 
             To create an ELF for writing and save it into a file 'elfFileName' (if it
@@ -231,7 +248,7 @@ public:
         const char*   rawElfBytes,  // raw ELF bytes to be loaded
         uint64_t      rawElfSize,   // size of the ELF raw bytes
         const char*   elfFileName,  // File to save this ELF.
-        ElfCmd        elfcmd        // ELF_C_READ/ELF_C_WRITE
+        ElfCmd        elfcmd        // ELF_C_READ/ELF_C_READ_MMAP/ELF_C_WRITE
         );
 
     ~Elf ();
@@ -327,6 +344,9 @@ public:
 
     bool isSuccessful() const { return _successful; }
 
+    /* Return true if the Elf object is loaded from raw bytes */
+    bool isReader() const { return (_elfCmd == ELF_C_READ) || (_elfCmd == ELF_C_READ_MMAP); }
+
     bool isHsaCo() const { return _elfio.get_machine() == EM_AMDGPU; }
 
     /* Return number of segments */
@@ -348,6 +368,12 @@ private:
     /* Initialization */
     bool Init();
 
+    /*
+     * Find the .symtab index of the symbol 'symbolName' in the section 'sectionName'.
+     * Builds the name index on the first call.
+     */
+    bool findSymbol(const char* symbolName, const char* sectionName, Elf_Xword* index) const;
+
     /*
      * Initialize ELF object by creating ELF header and key sections such as
      * .shstrtab, .strtab, and .symtab.
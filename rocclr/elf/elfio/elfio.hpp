@@ -71,6 +71,36 @@ set_##FNAME( TYPE val )                            \
 namespace amd {
 namespace ELFIO {
 
+//------------------------------------------------------------------------------
+// Read only stream over the image in memory, without a copy of the bytes
+class image_streambuf : public std::streambuf
+{
+  public:
+    image_streambuf( const char* image, size_t size )
+    {
+        char* begin = const_cast<char*>( image );
+        setg( begin, begin, begin + size );
+    }
+
+  protected:
+    pos_type seekoff( off_type off, std::ios_base::seekdir dir,
+                      std::ios_base::openmode which = std::ios_base::in )
+    {
+        char* pos = ( dir == std::ios_base::beg ) ? eback() :
+                    ( dir == std::ios_base::cur ) ? gptr() : egptr();
+        if ( off < eback() - pos || off > egptr() - pos ) {
+            return pos_type( off_type( -1 ) );
+        }
+        setg( eback(), pos + off, egptr() );
+        return pos_type( gptr() - eback() );
+    }
+
+    pos_type seekpos( pos_type pos, std::ios_base::openmode which = std::ios_base::in )
+    {
+        return seekoff( off_type( pos ), std::ios_base::beg, which );
+    }
+};
+
 //------------------------------------------------------------------------------
 class elfio
 {
@@ -80,6 +110,7 @@ class elfio
     {
         header           = 0;
         current_file_pos = 0;
+        view_image       = 0;
         create( ELFCLASS32, ELFDATA2LSB );
     }
 
@@ -110,6 +141,20 @@ class elfio
         return load(stream);
     }
 
+//------------------------------------------------------------------------------
+    // Loads the image in memory without a copy of the section and segment data, get_data()
+    // returns the pointers into the image. The image must outlive this object and can't be
+    // modified through it
+    bool load( const char* image, size_t size )
+    {
+        image_streambuf buf( image, size );
+        std::istream stream( &buf );
+        view_image = image;
+        bool ret = load( stream );
+        view_image = 0;
+        return ret;
+    }
+
 //------------------------------------------------------------------------------
     bool load( std::istream &stream )
     {
@@ -406,7 +451,7 @@ class elfio
 
         for ( Elf_Half i = 0; i < num; ++i ) {
             section* sec = create_section();
-            sec->load( stream, (std::streamoff)offset + i * entry_size );
+            sec->load( stream, (std::streamoff)offset + i * entry_size, view_image );
             sec->set_index( i );
             // To mark that the section is not permitted to reassign address
             // during layout calculation
@@ -462,7 +507,7 @@ class elfio
                 return false;
             }
 
-            seg->load( stream, (std::streamoff)offset + i * entry_size );
+            seg->load( stream, (std::streamoff)offset + i * entry_size, view_image );
             seg->set_index( i );
 
             // Add sections to the segments (similar to readelfs algorithm)
@@ -939,6 +984,7 @@ class elfio
     endianess_convertor   convertor;
 
     Elf_Xword current_file_pos;
+    const char* view_image;  // The image of the load in progress without the copy
 };
 
 } // namespace ELFIO
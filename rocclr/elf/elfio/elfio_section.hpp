@@ -62,7 +62,8 @@ protected:
     ELFIO_SET_ACCESS_DECL( Elf_Half,  index  );
 
     virtual void load( std::istream&  stream,
-                       std::streampos header_offset ) = 0;
+                       std::streampos header_offset,
+                       const char*    image = 0 ) = 0;
     virtual void save( std::ostream&  stream,
                        std::streampos header_offset,
                        std::streampos data_offset )   = 0;
@@ -81,12 +82,15 @@ class section_impl : public section
         is_address_set = false;
         data           = 0;
         data_size      = 0;
+        data_owned     = true;
     }
 
 //------------------------------------------------------------------------------
     ~section_impl()
     {
-        delete [] data;
+        if ( data_owned ) {
+            delete [] data;
+        }
     }
 
 //------------------------------------------------------------------------------
@@ -151,7 +155,10 @@ class section_impl : public section
     set_data( const char* raw_data, Elf_Word size )
     {
         if ( get_type() != SHT_NOBITS ) {
-            delete [] data;
+            if ( data_owned ) {
+                delete [] data;
+            }
+            data_owned = true;
             try {
                 data = new char[size];
             } catch (const std::bad_alloc&) {
@@ -180,7 +187,8 @@ class section_impl : public section
     append_data( const char* raw_data, Elf_Word size )
     {
         if ( get_type() != SHT_NOBITS ) {
-            if ( get_size() + size < data_size ) {
+            // A view of the loaded image is never written
+            if ( data_owned && get_size() + size < data_size ) {
                 std::copy( raw_data, raw_data + size, data + get_size() );
             }
             else {
@@ -195,8 +203,11 @@ class section_impl : public section
                 if ( 0 != new_data ) {
                     std::copy( data, data + get_size(), new_data );
                     std::copy( raw_data, raw_data + size, new_data + get_size() );
-                    delete [] data;
-                    data = new_data;
+                    if ( data_owned ) {
+                        delete [] data;
+                    }
+                    data       = new_data;
+                    data_owned = true;
                 }
             }
             set_size( get_size() + size );
@@ -225,7 +236,8 @@ class section_impl : public section
 //------------------------------------------------------------------------------
     void
     load( std::istream&  stream,
-          std::streampos header_offset )
+          std::streampos header_offset,
+          const char*    image )
     {
         std::fill_n( reinterpret_cast<char*>( &header ), sizeof( header ), '\0' );
 
@@ -237,6 +249,17 @@ class section_impl : public section
 
 
         Elf_Xword size = get_size();
+        Elf64_Off offset = (*convertor)( header.sh_offset );
+        // The view of the image skips the copy. The string tables must end with 0 in the image,
+        // since the copy is the one which adds the terminator
+        if ( 0 != image && 0 == data && SHT_NULL != get_type() && SHT_NOBITS != get_type() &&
+             0 != size && offset + size <= get_stream_size() &&
+             ( SHT_STRTAB != get_type() || image[offset + size - 1] == 0 ) ) {
+            data       = const_cast<char*>( image + offset );
+            data_size  = size;
+            data_owned = false;
+            return;
+        }
         if ( 0 == data && SHT_NULL != get_type() && SHT_NOBITS != get_type() && size < get_stream_size()) {
             try {
                 data = new char[size + 1];
@@ -314,6 +337,7 @@ class section_impl : public section
     const endianess_convertor* convertor;
     bool                       is_address_set;
     size_t                     stream_size;
+    bool                       data_owned;  // False if data is a view of the loaded image
 };
 
 } // namespace ELFIO
@@ -58,7 +58,8 @@ class segment
     ELFIO_SET_ACCESS_DECL( Elf_Half,  index  );
 
     virtual const std::vector<Elf_Half>& get_sections() const               = 0;
-    virtual void load( std::istream& stream, std::streampos header_offset ) = 0;
+    virtual void load( std::istream& stream, std::streampos header_offset,
+                       const char* image = 0 ) = 0;
     virtual void save( std::ostream& stream, std::streampos header_offset,
                                              std::streampos data_offset )   = 0;
 };
@@ -71,7 +72,7 @@ class segment_impl : public segment
   public:
 //------------------------------------------------------------------------------
     segment_impl( endianess_convertor* convertor_ ) :
-        stream_size( 0 ), index( 0 ), data( 0 ), convertor( convertor_ )
+        stream_size( 0 ), index( 0 ), data( 0 ), data_owned( true ), convertor( convertor_ )
     {
         is_offset_set = false;
         std::fill_n( reinterpret_cast<char*>( &ph ), sizeof( ph ), '\0' );
@@ -80,7 +81,9 @@ class segment_impl : public segment
 //------------------------------------------------------------------------------
     virtual ~segment_impl()
     {
-        delete [] data;
+        if ( data_owned ) {
+            delete [] data;
+        }
     }
 
 //------------------------------------------------------------------------------
@@ -190,7 +193,8 @@ class segment_impl : public segment
 //------------------------------------------------------------------------------
     void
     load( std::istream&  stream,
-          std::streampos header_offset )
+          std::streampos header_offset,
+          const char*    image )
     {
 
     stream.seekg ( 0, stream.end );
@@ -207,6 +211,11 @@ class segment_impl : public segment
             if ( size > get_stream_size() ) {
                 data = 0;
             }
+            else if ( 0 != image && (*convertor)( ph.p_offset ) + size <= get_stream_size() ) {
+                // The view of the image skips the copy
+                data       = const_cast<char*>( image + (*convertor)( ph.p_offset ) );
+                data_owned = false;
+            }
             else {
                 try {
                     data = new char[size + 1];
@@ -238,6 +247,7 @@ class segment_impl : public segment
     T                     ph;
     Elf_Half              index;
     char*                 data;
+    bool                  data_owned;  // False if data is a view of the loaded image
     std::vector<Elf_Half> sections;
     endianess_convertor*  convertor;
     bool                  is_offset_set;
@@ -234,6 +234,8 @@ class Os : AllStatic {
 
   //! NUMA related settings
   static void setPreferredNumaNode(uint32_t node);
+  //! Bind the current thread to the CPUs of the NUMA node, allowed for the process
+  static void setCurrentThreadNumaNode(uint32_t node);
 
   // File/Path helper routines:
   //
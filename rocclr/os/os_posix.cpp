@@ -338,6 +338,35 @@ void Os::setPreferredNumaNode(uint32_t node) {
 #endif //ROCCLR_SUPPORT_NUMA_POLICY
 }
 
+void Os::setCurrentThreadNumaNode(uint32_t node) {
+#ifdef ROCCLR_SUPPORT_NUMA_POLICY
+  if (numa_available() < 0) {
+    return;
+  }
+  bitmask* bm = numa_allocate_cpumask();
+  numa_node_to_cpus(node, bm);
+
+  // Stay within the affinity of the process, which may be limited with a cpuset or taskset
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (unsigned int cpu = 0; (cpu < bm->size) && (cpu < CPU_SETSIZE); ++cpu) {
+    if (numa_bitmask_isbitset(bm, cpu) && CPU_ISSET(cpu, &nativeMask_)) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  numa_free_cpumask(bm);
+
+  if (CPU_COUNT(&mask) == 0) {
+    return;
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) != 0) {
+    ClPrint(amd::LOG_WARNING, amd::LOG_INIT, "Failed to bind the thread to NUMA node %u", node);
+    return;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Bind the thread to NUMA node %u", node);
+#endif //ROCCLR_SUPPORT_NUMA_POLICY
+}
+
 void* Thread::entry(Thread* thread) {
   sigset_t set;
 
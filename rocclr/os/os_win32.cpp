@@ -252,6 +252,8 @@ void Os::setCurrentThreadName(const char* name) { SetThreadName(GetCurrentThread
 
 void Os::setPreferredNumaNode(uint32_t node) {};
 
+void Os::setCurrentThreadNumaNode(uint32_t node) {};
+
 static LONG WINAPI divExceptionFilter(struct _EXCEPTION_POINTERS* ep) {
   DWORD code = ep->ExceptionRecord->ExceptionCode;
 
@@ -35,6 +35,12 @@ __thread activity_correlation_id_t correlation_id __attribute__((tls_model("init
 __declspec(thread) activity_correlation_id_t correlation_id = 0;
 #endif  // defined(_WIN32)
 
+#if defined(__linux__)
+__thread LaunchTrace launch_trace __attribute__((tls_model("initial-exec"))) = {};
+#elif defined(_WIN32)
+__declspec(thread) LaunchTrace launch_trace = {};
+#endif  // defined(_WIN32)
+
 static inline size_t linearSize(const amd::Coord3D& size3d) {
   size_t size = size3d[0];
   if (size3d[1] != 0) size *= size3d[1];
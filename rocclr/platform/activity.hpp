@@ -21,6 +21,8 @@
 #pragma once
 
 #include "top.hpp"
+#include "os/os.hpp"
+#include "utils/flags.hpp"
 
 #include <atomic>
 #include <array>
@@ -28,6 +30,14 @@
 #include <shared_mutex>
 #include <utility>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_WIN32)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
 namespace amd {
 class Command;
 }  // namespace amd
@@ -73,6 +83,47 @@ constexpr OpId OperationId(cl_command_type commandType) {
   }
 }
 
+//! Kernel launch stages, timestamped in the launching thread for the launch latency histograms
+enum LaunchStage : uint32_t {
+  LAUNCH_STAGE_API_ENTRY = 0,     //!< The launch entered the runtime
+  LAUNCH_STAGE_VALIDATED = 1,     //!< The launch parameters were validated
+  LAUNCH_STAGE_COMMAND = 2,       //!< The command was created with the captured arguments
+  LAUNCH_STAGE_SUBMIT = 3,        //!< The device layer started the kernel submission
+  LAUNCH_STAGE_PUBLISHED = 4,     //!< The dispatch packet was published to the HW queue
+  LAUNCH_STAGE_NUMBER = 5
+};
+
+//! Launch stage timestamps of the current thread. A zero timestamp means the stage was skipped,
+//! i.e. the submission happened in the worker thread
+struct LaunchTrace {
+  uint64_t stamp_[LAUNCH_STAGE_NUMBER];
+};
+
+#if defined(__linux__)
+extern __thread LaunchTrace launch_trace __attribute__((tls_model("initial-exec")));
+#elif defined(_WIN32)
+extern __declspec(thread) LaunchTrace launch_trace;
+#endif  // defined(_WIN32)
+
+//! Returns a low overhead timestamp. It's TSC on x86 and nanoseconds on other CPUs
+inline uint64_t LaunchTimestamp() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return __rdtsc();
+#else
+  return amd::Os::timeNanos();
+#endif
+}
+
+//! Records the timestamp of the launch stage, if the launch latency collection is enabled
+inline void LaunchStamp(LaunchStage stage) {
+  if (HIP_LAUNCH_LATENCY) {
+    if (stage == LAUNCH_STAGE_API_ENTRY) {
+      launch_trace = {};
+    }
+    launch_trace.stamp_[stage] = LaunchTimestamp();
+  }
+}
+
 bool IsEnabled(OpId operation_id);
 void ReportActivity(const amd::Command& command);
 
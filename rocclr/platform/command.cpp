@@ -28,8 +28,10 @@
 #include "platform/memory.hpp"
 #include "platform/agent.hpp"
 #include "os/alloc.hpp"
+#include "platform/trace_events.hpp"
 
 #include <atomic>
+#include <mutex>
 #include <cstring>
 #include <algorithm>
 
@@ -305,7 +307,7 @@ Command::Command(HostQueue& queue, cl_command_type type, const EventWaitList& ev
     : Event(queue,
             amd::activity_prof::IsEnabled(amd::activity_prof::OperationId(type)) ||
                 queue.properties().test(CL_QUEUE_PROFILING_ENABLE) ||
-                Agent::shouldPostEventEvents()),
+                Agent::shouldPostEventEvents() || TraceEvents::enabled()),
       queue_(&queue),
       next_(nullptr),
       type_(type),
@@ -319,6 +321,88 @@ Command::Command(HostQueue& queue, cl_command_type type, const EventWaitList& ev
 }
 
 SysmemPool<ComputeCommand>* Command::command_pool_ = new SysmemPool<ComputeCommand>;
+
+namespace {
+
+//! The lock-free list of the commands waiting for the delete, linked with deferred_next_
+std::atomic<Command*> deferredCommands{nullptr};
+std::atomic<uint32_t> deferredCount{0};
+std::atomic<bool> deferredStopped{false};
+//! Serializes the batches, hence the teardown flush waits for the running one
+std::mutex deferredLock;
+
+//! Runs the command destructors in batches, off the dispatch and the completion paths
+class CommandReclaimer : public Thread {
+ public:
+  //! The partial batches are deleted after the interval
+  static constexpr int kIntervalMs = 10;
+
+  CommandReclaimer() : Thread("Command Reclaimer Thread") {}
+
+  //! The reclaimer thread entry point
+  void run(void* data) {
+    while (!deferredStopped.load(std::memory_order_relaxed)) {
+      wakeup_.timedWait(kIntervalMs);
+      Command::FlushDeferredDeletes();
+    }
+  }
+
+  Semaphore wakeup_;  //!< Posted for every full batch
+};
+
+//! Starts on the first deferred delete and lives until the process exits
+CommandReclaimer* GetCommandReclaimer() {
+  static CommandReclaimer* reclaimer = []() -> CommandReclaimer* {
+    CommandReclaimer* thread = new CommandReclaimer();
+    if ((thread == nullptr) || (thread->state() < Thread::INITIALIZED)) {
+      LogError("Couldn't create the command reclaimer thread, the commands are deleted inline");
+      delete thread;
+      return nullptr;
+    }
+    thread->start();
+    return thread;
+  }();
+  return reclaimer;
+}
+
+}  // namespace
+
+// ================================================================================================
+void Command::DeferDelete(Command* command) {
+  CommandReclaimer* reclaimer = deferredStopped.load(std::memory_order_acquire) ?
+                                nullptr : GetCommandReclaimer();
+  if (reclaimer == nullptr) {
+    delete command;
+    return;
+  }
+  Command* head = deferredCommands.load(std::memory_order_relaxed);
+  do {
+    command->deferred_next_ = head;
+  } while (!deferredCommands.compare_exchange_weak(head, command, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+  if ((deferredCount.fetch_add(1, std::memory_order_relaxed) + 1) %
+      ROC_DEFERRED_COMMAND_DELETE == 0) {
+    reclaimer->wakeup_.post();
+  }
+}
+
+// ================================================================================================
+void Command::FlushDeferredDeletes(bool final) {
+  std::lock_guard<std::mutex> guard(deferredLock);
+  if (final) {
+    deferredStopped.store(true, std::memory_order_release);
+  }
+  // The destructors may release more commands, hence repeat until the list stays empty
+  Command* command = deferredCommands.exchange(nullptr, std::memory_order_acquire);
+  while (command != nullptr) {
+    while (command != nullptr) {
+      Command* next = command->deferred_next_;
+      delete command;
+      command = next;
+    }
+    command = deferredCommands.exchange(nullptr, std::memory_order_acquire);
+  }
+}
 // ================================================================================================
 void Command::operator delete(void* ptr) {
   if (DEBUG_CLR_SYSMEM_POOL) {
@@ -350,6 +434,11 @@ void Command::releaseResources() {
 // ================================================================================================
 void Command::enqueue() {
   assert(queue_ != NULL && "Cannot be enqueued");
+  TraceEvents::Scope trace(TraceEvents::Enqueue,
+                           amd::activity_prof::getOclCommandKindString(type()));
+
+  // The deferred waits go first, so this command is ordered after them
+  queue_->flushPendingWaits();
 
   if (Agent::shouldPostEventEvents() && type_ != 0) {
     Agent::postEventCreate(as_cl(static_cast<Event*>(this)), type_);
@@ -383,12 +472,20 @@ void Command::enqueue() {
       // updated upon the marker completion
       SetBatchHead(queue_->GetSubmissionBatch());
 
-      submit(*queue_->vdev());
+      {
+        TraceEvents::Scope submit_trace(TraceEvents::Submit,
+                                        amd::activity_prof::getOclCommandKindString(type()));
+        submit(*queue_->vdev());
+      }
 
       // The batch will be tracked with the marker now
       queue_->ResetSubmissionBatch();
     } else {
-      submit(*queue_->vdev());
+      {
+        TraceEvents::Scope submit_trace(TraceEvents::Submit,
+                                        amd::activity_prof::getOclCommandKindString(type()));
+        submit(*queue_->vdev());
+      }
       queue_->FlushSubmissionBatch(this);
     }
   } else {
@@ -405,6 +502,17 @@ void Command::enqueue() {
   queue_->SetQueueStatus();
 }
 
+// ================================================================================================
+void Command::SkipQueueProfiling() {
+  // The tools and the marker timestamps still require the profiling
+  if (profilingInfo_.marker_ts_ ||
+      amd::activity_prof::IsEnabled(amd::activity_prof::OperationId(type())) ||
+      Agent::shouldPostEventEvents() || TraceEvents::enabled()) {
+    return;
+  }
+  profilingInfo_.enabled_ = false;
+}
+
 // ================================================================================================
 const Context& Command::context() const { return queue_->context(); }
 
@@ -424,7 +532,9 @@ NDRangeKernelCommand::NDRangeKernelCommand(HostQueue& queue, const EventWaitList
     numGrids_(numGrids),
     prevGridSum_(prevGridSum),
     allGridSum_(allGridSum),
-    firstDevice_(firstDevice) {
+    firstDevice_(firstDevice),
+    deviceKernelArgs_(false),
+    snapshot_(nullptr) {
   auto& device = queue.device();
   auto devKernel = const_cast<device::Kernel*>(kernel.getDeviceKernel(device));
   if (cooperativeGroups()) {
@@ -442,7 +552,7 @@ NDRangeKernelCommand::NDRangeKernelCommand(HostQueue& queue, const EventWaitList
 }
 
 void NDRangeKernelCommand::releaseResources() {
-  kernel_.parameters().release(parameters_);
+  kernel_.parameters().release(parameters_, deviceKernelArgs_, snapshot_);
   DEBUG_ONLY(parameters_ = NULL);
   kernel_.release();
   Command::releaseResources();
@@ -654,14 +764,16 @@ bool MigrateMemObjectsCommand::validateMemory() {
 }
 
 // =================================================================================================
-int32_t NDRangeKernelCommand::AllocCaptureSetValidate(void** kernelParams, address kernArgs) {
+int32_t NDRangeKernelCommand::AllocCaptureSetValidate(void** kernelParams, address kernArgs,
+                                                      bool directArgs) {
   const amd::Device& device = queue()->device();
    // Validate the kernel before submission
   if (!queue()->device().validateKernel(kernel(), queue()->vdev(), cooperativeGroups())) {
     return CL_OUT_OF_RESOURCES;
   }
 
-  parameters_ = kernel().parameters().alloc(*queue()->vdev());
+  parameters_ = kernel().parameters().alloc(*queue()->vdev(),
+                                            directArgs ? &deviceKernelArgs_ : nullptr);
   if (parameters_ == nullptr) {
     LogError("Cannot allocate memory for parameters_");
     return CL_OUT_OF_RESOURCES;
@@ -674,7 +786,7 @@ int32_t NDRangeKernelCommand::AllocCaptureSetValidate(void** kernelParams, addre
   return CL_SUCCESS;
 }
 
-int32_t NDRangeKernelCommand::captureAndValidate() {
+int32_t NDRangeKernelCommand::captureAndValidate(bool directArgs, bool useSnapshot) {
   const amd::Device& device = queue()->device();
   // Validate the kernel before submission
   if (!queue()->device().validateKernel(kernel(), queue()->vdev(), cooperativeGroups())) {
@@ -684,7 +796,9 @@ int32_t NDRangeKernelCommand::captureAndValidate() {
   int32_t error;
   uint64_t lclMemSize = kernel().getDeviceKernel(device)->workGroupInfo()->localMemSize_;
   parameters_ = kernel().parameters().capture(*queue()->vdev(),
-                                              sharedMemBytes_ + lclMemSize, &error);
+                                              sharedMemBytes_ + lclMemSize, &error,
+                                              directArgs ? &deviceKernelArgs_ : nullptr,
+                                              useSnapshot ? &snapshot_ : nullptr);
   return error;
 }
 
@@ -798,12 +912,38 @@ bool CopyMemoryP2PCommand::validateMemory() {
   return true;
 }
 
+// ================================================================================================
+SvmPrefetchAsyncCommand::SvmPrefetchAsyncCommand(HostQueue& queue,
+                                                 const EventWaitList& eventWaitList,
+                                                 const RangeList& ranges, amd::Device* dev,
+                                                 bool cpu_access)
+    : Command(queue, 1, eventWaitList), ranges_(ranges), cpu_access_(cpu_access), dev_(dev) {
+  // Coalesce the ranges, so the migration cost scales with the contiguous bytes
+  std::sort(ranges_.begin(), ranges_.end());
+  size_t last = 0;
+  for (size_t i = 1; i < ranges_.size(); ++i) {
+    auto start = reinterpret_cast<uintptr_t>(ranges_[i].first);
+    auto end = reinterpret_cast<uintptr_t>(ranges_[last].first) + ranges_[last].second;
+    if (start <= end) {
+      auto new_end = std::max(end, start + ranges_[i].second);
+      ranges_[last].second = new_end - reinterpret_cast<uintptr_t>(ranges_[last].first);
+    } else {
+      ranges_[++last] = ranges_[i];
+    }
+  }
+  ranges_.resize(ranges_.empty() ? 0 : last + 1);
+  ClPrint(LOG_DEBUG, LOG_CMD, "Prefetch batch of %zu ranges is coalesced into %zu",
+          ranges.size(), ranges_.size());
+}
+
 // ================================================================================================
 bool SvmPrefetchAsyncCommand::validateMemory() {
-  amd::Memory* svmMem = amd::MemObjMap::FindMemObj(dev_ptr());
-  if (nullptr == svmMem) {
-    LogPrintfError("SvmPrefetchAsync received unknown memory for prefetch: %p!", dev_ptr());
-    return false;
+  for (const auto& it : ranges_) {
+    amd::Memory* svmMem = amd::MemObjMap::FindMemObj(it.first);
+    if (nullptr == svmMem) {
+      LogPrintfError("SvmPrefetchAsync received unknown memory for prefetch: %p!", it.first);
+      return false;
+    }
   }
   return true;
 }
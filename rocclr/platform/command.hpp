@@ -265,6 +265,7 @@ class Command : public Event {
   HostQueue* queue_;               //!< The command queue this command is enqueue into
   Command* next_;                  //!< Next GPU command in the queue list
   Command* batch_head_ = nullptr;  //!< The head of the batch commands
+  Command* deferred_next_ = nullptr;  //!< Next command in the deferred delete list
   cl_command_type type_;           //!< This command's OpenCL type.
   std::vector<void*> data_;
   const Event* waitingEvent_;  //!< Waiting event associated with the marker
@@ -306,10 +307,25 @@ class Command : public Event {
     if (Agent::shouldPostEventEvents() && type() != 0) {
       Agent::postEventFree(as_cl(static_cast<Event*>(this)));
     }
+    if (IS_HIP && (ROC_DEFERRED_COMMAND_DELETE != 0)) {
+      DeferDelete(this);
+      return false;
+    }
     return true;
   }
 
+  //! Queues the command for the reclaimer thread, which runs the destructors in batches
+  static void DeferDelete(Command* command);
+
  public:
+  //! Deletes the commands queued for the reclaimer thread on the calling thread. The final flush
+  //! at the teardown makes the later releases delete inline.
+  static void FlushDeferredDeletes(bool final = false);
+
+  //! Drops the queue profiling of a command, which returns no event to the app. Nobody can
+  //! query its timestamps, so the command is dispatched without a timestamp and a signal.
+  void SkipQueueProfiling();
+
   //! Returns AQL buffer state
   static void ReleaseSysmemPool() {
     if (command_pool_ != nullptr) {
@@ -432,10 +448,12 @@ class UserEvent : public Command {
 class ClGlEvent : public Command {
  private:
   const Context& context_;
+  bool ownsSync_;  //!< The runtime created the GL sync and deletes it after the wait
   bool waitForFence();
 
  public:
-  ClGlEvent(Context& context) : Command(CL_COMMAND_GL_FENCE_SYNC_OBJECT_KHR), context_(context) {
+  ClGlEvent(Context& context, bool ownsSync = false)
+      : Command(CL_COMMAND_GL_FENCE_SYNC_OBJECT_KHR), context_(context), ownsSync_(ownsSync) {
     setStatus(CL_SUBMITTED);
   }
 
@@ -1131,6 +1149,8 @@ class NDRangeKernelCommand : public Command {
   uint64_t allGridSum_;     //!< A sum of all grids in multi GPU launch
   uint32_t firstDevice_;    //!< Device index of the first device in the gridc
   uint32_t numWorkgroups_;  //!< Total number of workgroups in the current launch
+  bool deviceKernelArgs_;   //!< Parameters were captured directly into device kernel arguments
+  KernelParameters::Snapshot* snapshot_;  //!< The snapshot of the copied parameters or nullptr
 
  public:
   enum {
@@ -1157,6 +1177,9 @@ class NDRangeKernelCommand : public Command {
   //! Return the parameters given to this kernel.
   const_address parameters() const { return parameters_; }
 
+  //! Returns true if the parameters were captured directly into device kernel arguments
+  bool deviceKernelArgs() const { return deviceKernelArgs_; }
+
   //! Return the kernel NDRange.
   const NDRangeContainer& sizes() const { return sizes_; }
 
@@ -1214,11 +1237,13 @@ class NDRangeKernelCommand : public Command {
     numWorkgroups_ = numWorkgroups;
   }
 
-  // Capture kernel parameters and validate
-  int32_t captureAndValidate();
+  // Capture kernel parameters and validate. If directArgs is true, then the command is submitted
+  // right after the capture, hence the parameters can go directly into device kernel arguments.
+  // If useSnapshot is true, then the parameters are copied from the kernel parameters snapshot
+  int32_t captureAndValidate(bool directArgs = false, bool useSnapshot = false);
 
   // Allocate, capture and set kernel parameters
-  int32_t AllocCaptureSetValidate(void** kernelParams, address kernArgs);
+  int32_t AllocCaptureSetValidate(void** kernelParams, address kernArgs, bool directArgs = false);
 };
 
 class NativeFnCommand : public Command {
@@ -1255,22 +1280,32 @@ class ExternalSemaphoreCmd : public Command {
  public:
   enum ExternalSemaphoreCmdType { COMMAND_WAIT_EXTSEMAPHORE, COMMAND_SIGNAL_EXTSEMAPHORE };
 
+  struct Semaphore {
+    const void* sem_ptr_;  //!< Pointer to external semaphore
+    uint64_t fence_;       //!< semaphore value to be set or waited for
+  };
+  typedef std::vector<Semaphore> SemaphoreList;
+
  private:
-  const void* sem_ptr_; //!< Pointer to external semaphore
-  uint64_t fence_;           //!< semaphore value to be set
+  SemaphoreList semaphores_;          //!< All semaphores of the API call
   ExternalSemaphoreCmdType cmd_type_; //!< Signal or Wait semaphore command
 
  public:
   ExternalSemaphoreCmd(HostQueue& queue, const void* sem_ptr, uint64_t fence,
                        ExternalSemaphoreCmdType cmd_type)
-      : Command::Command(queue, CL_COMMAND_USER), sem_ptr_(sem_ptr), fence_(fence),
+      : Command::Command(queue, CL_COMMAND_USER), semaphores_({{sem_ptr, fence}}),
+                         cmd_type_(cmd_type) {}
+
+  //! The semaphores are signaled or waited in one submission
+  ExternalSemaphoreCmd(HostQueue& queue, SemaphoreList&& semaphores,
+                       ExternalSemaphoreCmdType cmd_type)
+      : Command::Command(queue, CL_COMMAND_USER), semaphores_(std::move(semaphores)),
                          cmd_type_(cmd_type) {}
 
   virtual void submit(device::VirtualDevice& device) {
     device.submitExternalSemaphoreCmd(*this);
   }
-  const void* sem_ptr() const { return sem_ptr_; }
-  const uint64_t fence() { return fence_; }
+  const SemaphoreList& semaphores() const { return semaphores_; }
   const ExternalSemaphoreCmdType semaphoreCmd() { return cmd_type_; }
 
 };
@@ -1762,28 +1797,141 @@ class CopyMemoryP2PCommand : public CopyMemoryCommand {
   bool validateMemory();
 };
 
+/*! \brief      A batch of buffer copies
+ *
+ *  \details    The copies run under one command, so the batch takes the queue lock, the
+ *              profiling and the completion signal once. The copies have no order between them
+ */
+class CopyMemoryBatchCommand : public Command {
+ public:
+  struct Copy {
+    Memory* src_;       //!< The source buffer
+    Memory* dst_;       //!< The destination buffer
+    size_t srcOffset_;  //!< The offset in bytes in the source
+    size_t dstOffset_;  //!< The offset in bytes in the destination
+    size_t size_;       //!< The number of bytes to copy
+  };
+  typedef std::vector<Copy> CopyList;
+
+ private:
+  CopyList copies_;                 //!< The copies of the batch
+  amd::CopyMetadata copyMetadata_;  //!< The metadata of all copies
+
+ public:
+  CopyMemoryBatchCommand(HostQueue& queue, const EventWaitList& eventWaitList,
+                         const CopyList& copies,
+                         amd::CopyMetadata copyMetadata = amd::CopyMetadata())
+      : Command(queue, CL_COMMAND_COPY_BUFFER, eventWaitList, AMD_SERIALIZE_COPY),
+        copies_(copies),
+        copyMetadata_(copyMetadata) {
+    for (const auto& it : copies_) {
+      it.src_->retain();
+      it.dst_->retain();
+    }
+  }
+
+  virtual void releaseResources() {
+    for (const auto& it : copies_) {
+      it.src_->release();
+      it.dst_->release();
+    }
+    Command::releaseResources();
+  }
+
+  virtual void submit(device::VirtualDevice& device) { device.submitCopyMemoryBatch(*this); }
+
+  //! Return the copies of the batch
+  const CopyList& copies() const { return copies_; }
+  //! Return the copy MetaData
+  amd::CopyMetadata copyMetadata() const { return copyMetadata_; }
+};
+
+/*! \brief      Small writes of host data into buffers
+ *
+ *  \details    The command keeps a copy of the data, so the source can be reused right after
+ *              the enqueue. The device carries the data with the launch arguments of one copy
+ *              kernel. The writes have no order between them
+ */
+class WriteMemoryInlineCommand : public Command {
+ public:
+  //! The payload limit of one command
+  static constexpr size_t MaxPayloadSize = 4 * Ki;
+
+  struct Write {
+    Memory* dst_;     //!< The destination buffer
+    size_t offset_;   //!< The offset in bytes in the destination
+    size_t data_;     //!< The offset of the data in the payload
+    size_t size_;     //!< The number of bytes to write
+  };
+  typedef std::vector<Write> WriteList;
+
+ private:
+  WriteList writes_;              //!< The writes of the command
+  std::vector<uint8_t> payload_;  //!< The data of all writes
+
+ public:
+  WriteMemoryInlineCommand(HostQueue& queue, const EventWaitList& eventWaitList)
+      : Command(queue, CL_COMMAND_WRITE_BUFFER, eventWaitList, AMD_SERIALIZE_COPY) {}
+
+  //! Adds a write, returns false if it doesn't fit into the payload
+  bool addWrite(Memory& dst, size_t offset, const void* data, size_t size) {
+    // Every write starts 16 bytes aligned, so the kernel can use the wide accesses
+    const size_t start = amd::alignUp(payload_.size(), 16);
+    if ((start + size) > MaxPayloadSize) {
+      return false;
+    }
+    dst.retain();
+    writes_.push_back({&dst, offset, start, size});
+    payload_.resize(start + size);
+    memcpy(payload_.data() + start, data, size);
+    return true;
+  }
+
+  virtual void releaseResources() {
+    for (const auto& it : writes_) {
+      it.dst_->release();
+    }
+    Command::releaseResources();
+  }
+
+  virtual void submit(device::VirtualDevice& device) { device.submitWriteMemoryInline(*this); }
+
+  //! Return the writes of the command
+  const WriteList& writes() const { return writes_; }
+  //! Return the data of all writes
+  const std::vector<uint8_t>& payload() const { return payload_; }
+};
+
 /*! \brief      Prefetch command for SVM memory
  *
  *  \details    Prefetches SVM memory into the destination device or CPU
  */
 class SvmPrefetchAsyncCommand : public Command {
-  const void* dev_ptr_;   //!< Device pointer to memory for prefetch
-  size_t count_;          //!< the size for prefetch
+ public:
+  typedef std::vector<std::pair<const void*, size_t>> RangeList;
+
+ private:
+  RangeList ranges_;      //!< Device pointers and sizes of the ranges for prefetch
   bool cpu_access_;       //!< Prefetch data into CPU location
   amd::Device* dev_;      //!< Destination device to prefetch to
 
  public:
   SvmPrefetchAsyncCommand(HostQueue& queue, const EventWaitList& eventWaitList,
                           const void* dev_ptr, size_t count, amd::Device* dev, bool cpu_access)
-      : Command(queue, 1, eventWaitList), dev_ptr_(dev_ptr), count_(count),
+      : Command(queue, 1, eventWaitList), ranges_(1, {dev_ptr, count}),
         cpu_access_(cpu_access), dev_(dev) {}
 
+  //! Prefetches a batch of ranges, the adjacent and the overlapping ranges are merged into one
+  SvmPrefetchAsyncCommand(HostQueue& queue, const EventWaitList& eventWaitList,
+                          const RangeList& ranges, amd::Device* dev, bool cpu_access);
+
   virtual void submit(device::VirtualDevice& device) { device.submitSvmPrefetchAsync(*this); }
 
   bool validateMemory();
 
-  const void* dev_ptr() const { return dev_ptr_; }
-  size_t count() const { return count_; }
+  const void* dev_ptr() const { return ranges_[0].first; }
+  size_t count() const { return ranges_[0].second; }
+  const RangeList& ranges() const { return ranges_; }
   amd::Device* device() const { return dev_; }
   size_t cpu_access() const { return cpu_access_; }
 };
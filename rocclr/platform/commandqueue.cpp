@@ -22,6 +22,7 @@
 #include "thread/monitor.hpp"
 #include "device/device.hpp"
 #include "platform/context.hpp"
+#include "platform/trace_events.hpp"
 
 /*!
  * \file commandQueue.cpp
@@ -196,17 +197,33 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
   while (true) {
     // Get one command from the queue
     Command* command = queue_.dequeue();
+    // Spin for a short period first, since the app usually submits commands in bursts
+    for (uint i = 0; (command == NULL) && (i < kConsumerSpinIter); ++i) {
+      Os::spinPause();
+      command = queue_.dequeue();
+    }
     if (command == NULL) {
       ScopedLock sl(queueLock_);
       while ((command = queue_.dequeue()) == NULL) {
         if (!thread_.acceptingCommands_) {
           return;
         }
+        // Let the producers know a notification is required
+        consumerParked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Recheck the queue to avoid a lost wake up from a concurrent append()
+        if ((command = queue_.dequeue()) != NULL) {
+          consumerParked_.store(false, std::memory_order_relaxed);
+          break;
+        }
         queueLock_.wait();
+        consumerParked_.store(false, std::memory_order_relaxed);
       }
     }
 
     command->retain();
+    TraceEvents::Scope trace(TraceEvents::Worker,
+                             amd::activity_prof::getOclCommandKindString(command->type()));
 
     // Process the command's event wait list.
     const Command::EventWaitList& events = command->eventWaitList();
@@ -248,7 +265,11 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
     command->setStatus(CL_SUBMITTED);
 
     // Submit to the device queue.
-    command->submit(*virtualDevice);
+    {
+      TraceEvents::Scope submit_trace(TraceEvents::Submit,
+                                      amd::activity_prof::getOclCommandKindString(command->type()));
+      command->submit(*virtualDevice);
+    }
 
     // if this is a user invisible marker command, then flush
     if (0 == command->type()) {
@@ -285,6 +306,7 @@ void HostQueue::append(Command& command) {
 
     prevLastEnqueueCommand = lastEnqueueCommand_;
     lastEnqueueCommand_ = &command;
+    advanceEpoch();
   }
 
   if (prevLastEnqueueCommand != nullptr) {
@@ -295,12 +317,57 @@ void HostQueue::append(Command& command) {
   }
 }
 
+// ================================================================================================
+void HostQueue::addPendingWait(Event& event) {
+  event.retain();
+  ScopedLock l(pendingWaitsLock_);
+  for (auto pending : pendingWaits_) {
+    if (pending == &event) {
+      event.release();
+      return;
+    }
+  }
+  pendingWaits_.push_back(&event);
+  hasPendingWaits_.store(true, std::memory_order_release);
+  // The queue state changed for the waiters, which skip the queues with the same epoch
+  advanceEpoch();
+}
+
+// ================================================================================================
+void HostQueue::submitPendingWaits() {
+  Command::EventWaitList waits;
+  {
+    ScopedLock l(pendingWaitsLock_);
+    waits.swap(pendingWaits_);
+    hasPendingWaits_.store(false, std::memory_order_release);
+  }
+  if (waits.empty()) {
+    return;
+  }
+  ClPrint(LOG_DEBUG, LOG_CMD, "Coalesced %zu waits into one marker on queue %p", waits.size(),
+          this);
+  // The marker retains the events, hence the references of the pending list can go.
+  // The marker enqueue calls back into this function, but the list is empty by then
+  Command* command = new Marker(*this, true, waits);
+  if (command != nullptr) {
+    // Only the dependency is needed, hence no cache flushes
+    command->setEventScope(Device::kCacheStateIgnore);
+    command->enqueue();
+    command->release();
+  }
+  for (auto event : waits) {
+    event->release();
+  }
+}
+
 bool HostQueue::isEmpty() {
   // Get a snapshot of queue size
   return queue_.empty();
 }
 
 Command* HostQueue::getLastQueuedCommand(bool retain) {
+  // The deferred waits are a part of the queue state for the callers
+  flushPendingWaits();
   if (AMD_DIRECT_DISPATCH) {
     // The batch update must be lock protected to avoid a race condition
     // when multiple threads submit/flush/update the batch at the same time
@@ -128,8 +128,8 @@ class CommandQueue : public RuntimeObject {
       : properties_(propMask, properties),
         rtCUs_(rtCUs),
         priority_(priority),
-        queueLock_("CommandQueue::queueLock"),
-        lastCmdLock_("LastQueuedCommand"),
+        queueLock_("CommandQueue::queueLock", true),
+        lastCmdLock_("LastQueuedCommand", true),
         device_(device),
         context_(context),
         cuMask_(cuMask) {}
@@ -167,6 +167,7 @@ class HostQueue : public CommandQueue {
     //! The command queue thread entry point.
     void run(void* data) {
       HostQueue* queue = static_cast<HostQueue*>(data);
+      queue->device().setThreadNumaAffinity();
       virtualDevice_ = queue->device().createVirtualDevice(queue);
       if (virtualDevice_ != nullptr) {
         queue->loop(virtualDevice_);
@@ -197,11 +198,32 @@ class HostQueue : public CommandQueue {
  private:
   ConcurrentLinkedQueue<Command*> queue_;  //!< The queue.
 
+  //! The number of spin iterations in the worker thread before it parks on the queue lock
+  static constexpr uint kConsumerSpinIter = 1000;
+  std::atomic<bool> consumerParked_ = false;  //!< The worker thread waits for a notification
+
   Command* lastEnqueueCommand_;  //!< The last submitted command
+  std::atomic<uint64_t> enqueueEpoch_{0};  //!< The number of the last command updates
+  std::atomic<uint64_t>* sharedEpoch_ = nullptr;  //!< Epoch, shared with other queues
+
+  //! Advances the epochs after the update of the last command
+  void advanceEpoch() {
+    enqueueEpoch_.fetch_add(1, std::memory_order_release);
+    if (sharedEpoch_ != nullptr) {
+      sharedEpoch_->fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  std::vector<Event*> pendingWaits_;           //!< Deferred waits for the next command
+  std::atomic<bool> hasPendingWaits_{false};  //!< True if pendingWaits_ isn't empty
+  Monitor pendingWaitsLock_{true};            //!< Guards pendingWaits_
 
   //! Await commands and execute them as they become ready.
   void loop(device::VirtualDevice* virtualDevice);
 
+  //! Enqueues a marker for all deferred waits
+  void submitPendingWaits();
+
  protected:
   virtual bool terminate();
 
@@ -226,8 +248,14 @@ class HostQueue : public CommandQueue {
 
   //! Signal to start processing the commands in the queue.
   void flush() {
-    ScopedLock sl(queueLock_);
-    queueLock_.notify();
+    // Pairs with the fence in loop(). Either the worker sees the new command in the queue or
+    // the producer sees the parked worker
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // The worker thread is busy or spinning, hence it will find the command without a wake up
+    if (consumerParked_.load(std::memory_order_relaxed)) {
+      ScopedLock sl(queueLock_);
+      queueLock_.notify();
+    }
   }
 
   //! Finish all queued commands
@@ -245,6 +273,24 @@ class HostQueue : public CommandQueue {
   //! Get last enqueued command
   Command* getLastQueuedCommand(bool retain);
 
+  //! Defers a wait for the event until the next command. The consecutive waits are coalesced
+  //! into a single marker, which waits for all of them
+  void addPendingWait(Event& event);
+
+  //! Submits the deferred waits, if any
+  void flushPendingWaits() {
+    if (hasPendingWaits_.load(std::memory_order_acquire)) {
+      submitPendingWaits();
+    }
+  }
+
+  //! Returns the epoch of the last enqueued command. The epoch changes with the command, so the
+  //! waiters can skip the queue without the command retain while the epoch stays the same
+  uint64_t enqueueEpoch() const { return enqueueEpoch_.load(std::memory_order_acquire); }
+
+  //! Sets the epoch, advanced together with the epoch of this queue
+  void setSharedEpoch(std::atomic<uint64_t>* epoch) { sharedEpoch_ = epoch; }
+
   //! Get the submitted batch
   Command* GetSubmissionBatch() const { return head_; }
 
@@ -277,6 +323,7 @@ class HostQueue : public CommandQueue {
     command->retain();
 
     lastEnqueueCommand_ = command;
+    advanceEpoch();
   }
 
   //! Flushes submitted commands if the batch size significantly grew
@@ -28,6 +28,8 @@ GLPREFIX(GLenum, glGetError, (void))
 GLPREFIX(void, glFinish, (void))
 GLPREFIX(void, glFlush, (void))
 GLPREFIX(GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout))
+GLPREFIX(GLsync, glFenceSync, (GLenum condition, GLbitfield flags))
+GLPREFIX(void, glDeleteSync, (GLsync sync))
 GLPREFIX(void, glGetIntegerv, (GLenum pname, GLint *params))
 GLPREFIX(void, glGetRenderbufferParameterivEXT, (GLenum target, GLenum pname, GLint* params))
 GLPREFIX(void, glGetTexLevelParameteriv, (GLenum target, GLint level, GLenum pname, GLint *params))
@@ -55,6 +55,17 @@ bool amd::ClGlEvent::waitForFence() {
                                           : nullptr;
   if (!gs) return false;
 
+  // Waits in the current GL context, the sync created by the runtime is deleted after the wait
+  auto clientWait = [this, gs]() {
+    GLenum result = context().glenv()->glClientWaitSync_(gs, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                                         static_cast<GLuint64>(-1));
+    if (ownsSync_) {
+      context().glenv()->glDeleteSync_(gs);
+      data().clear();
+    }
+    return result;
+  };
+
 // Try to use DC and GLRC of current thread, if it doesn't exist
 // create a new GL context on this thread, which is shared with the original context
 
@@ -64,8 +75,7 @@ bool amd::ClGlEvent::waitForFence() {
   // Set DC and GLRC
   if (tempDC_ && tempGLRC_) {
     amd::GLFunctions::Lock lock(context().glenv());
-    ret = context().glenv()->glClientWaitSync_(gs, GL_SYNC_FLUSH_COMMANDS_BIT,
-                                               static_cast<GLuint64>(-1));
+    ret = clientWait();
     if (!(ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED)) return false;
   } else {
     tempDC_ = context().glenv()->getDC();
@@ -78,8 +88,7 @@ bool amd::ClGlEvent::waitForFence() {
     amd::GLFunctions::SetIntEnv ie(context().glenv());
 
     // If fence has not yet executed, wait till it finishes
-    ret = context().glenv()->glClientWaitSync_(gs, GL_SYNC_FLUSH_COMMANDS_BIT,
-                                               static_cast<GLuint64>(-1));
+    ret = clientWait();
     if (!(ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED)) return false;
   }
 #else  // Lnx
@@ -89,8 +98,7 @@ bool amd::ClGlEvent::waitForFence() {
   // Set internal Display and GLXContext
   if (tempDpy_ && tempCtx_) {
     amd::GLFunctions::Lock lock(context().glenv());
-    ret = context().glenv()->glClientWaitSync_(gs, GL_SYNC_FLUSH_COMMANDS_BIT,
-                                               static_cast<GLuint64>(-1));
+    ret = clientWait();
     if (!(ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED)) return false;
   } else {
     if (!context().glenv()->init(reinterpret_cast<intptr_t>(context().glenv()->getIntDpy()),
@@ -101,8 +109,7 @@ bool amd::ClGlEvent::waitForFence() {
     amd::GLFunctions::SetIntEnv ie(context().glenv());
 
     // If fence has not yet executed, wait till it finishes
-    ret = context().glenv()->glClientWaitSync_(gs, GL_SYNC_FLUSH_COMMANDS_BIT,
-                                               static_cast<GLuint64>(-1));
+    ret = clientWait();
     if (!(ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED)) return false;
   }
 #endif
@@ -27,6 +27,93 @@
 
 namespace amd {
 
+namespace {
+
+//! Per-thread cache of the host memory blocks used for the captured kernel parameters.
+//! Blocks are kept in power of two size classes, so the steady state launch path
+//! doesn't go to the heap. Each block has a header with the size class, since
+//! the capture size isn't available at release time.
+class ParamBlockCache {
+ public:
+  static constexpr size_t kMinBlockSize = 256;    //!< The smallest cached size class
+  static constexpr uint32_t kNumClasses = 6;      //!< 256 bytes - 8KB
+  static constexpr uint32_t kMaxBlocks = 32;      //!< Max cached blocks per class
+
+  ParamBlockCache() : count_{} {}
+  ~ParamBlockCache() {
+    for (uint32_t c = 0; c < kNumClasses; ++c) {
+      for (uint32_t i = 0; i < count_[c]; ++i) {
+        AlignedMemory::deallocate(blocks_[c][i]);
+      }
+    }
+  }
+
+  //! Returns the parameters memory with at least \a size bytes
+  address alloc(size_t size) {
+    const size_t header = PARAMETERS_MIN_ALIGNMENT;
+    uint32_t sizeClass = 0;
+    while ((sizeClass < kNumClasses) && ((kMinBlockSize << sizeClass) < size)) {
+      ++sizeClass;
+    }
+    address block = nullptr;
+    if (sizeClass < kNumClasses) {
+      if (count_[sizeClass] > 0) {
+        block = blocks_[sizeClass][--count_[sizeClass]];
+      } else {
+        block = reinterpret_cast<address>(AlignedMemory::allocate(
+            header + (kMinBlockSize << sizeClass), PARAMETERS_MIN_ALIGNMENT));
+      }
+    } else {
+      block = reinterpret_cast<address>(
+          AlignedMemory::allocate(header + size, PARAMETERS_MIN_ALIGNMENT));
+    }
+    if (block == nullptr) {
+      return nullptr;
+    }
+    *reinterpret_cast<uint32_t*>(block) = sizeClass;
+    return block + header;
+  }
+
+  //! Returns the parameters memory back into the cache of the current thread
+  void free(address mem) {
+    address block = mem - PARAMETERS_MIN_ALIGNMENT;
+    uint32_t sizeClass = *reinterpret_cast<uint32_t*>(block);
+    if ((sizeClass < kNumClasses) && (count_[sizeClass] < kMaxBlocks)) {
+      blocks_[sizeClass][count_[sizeClass]++] = block;
+    } else {
+      AlignedMemory::deallocate(block);
+    }
+  }
+
+ private:
+  uint32_t count_[kNumClasses];                 //!< The number of cached blocks per class
+  address blocks_[kNumClasses][kMaxBlocks];     //!< Cached blocks
+};
+
+thread_local ParamBlockCache paramBlockCache;
+
+//! Allocates host memory for the captured kernel parameters
+address allocParamBlock(size_t size) {
+  if (DEBUG_CLR_SYSMEM_POOL) {
+    return paramBlockCache.alloc(size);
+  }
+  return reinterpret_cast<address>(AlignedMemory::allocate(size, PARAMETERS_MIN_ALIGNMENT));
+}
+
+//! Releases host memory of the captured kernel parameters
+void freeParamBlock(address mem) {
+  if (mem == nullptr) {
+    return;
+  }
+  if (DEBUG_CLR_SYSMEM_POOL) {
+    paramBlockCache.free(mem);
+  } else {
+    AlignedMemory::deallocate(mem);
+  }
+}
+
+}  // namespace
+
 Kernel::Kernel(Program& program, const Symbol& symbol, const std::string& name)
     : program_(program), symbol_(symbol), name_(name) {
   parameters_ = new (signature()) KernelParameters(const_cast<KernelSignature&>(signature()));
@@ -86,18 +173,19 @@ size_t KernelParameters::localMemSize(size_t minDataTypeAlignment) const {
 }
 
 // =================================================================================================
-address KernelParameters::alloc(device::VirtualDevice& vDev) {
+address KernelParameters::alloc(device::VirtualDevice& vDev, bool* deviceArgs) {
 
   //! Information about which arguments are SVM pointers is stored after
   // the actual parameters, but only if the device has any SVM capability
   const size_t execInfoSize = getNumberOfSvmPtr() * sizeof(void*);
 
-  address mem = vDev.allocKernelArguments(totalSize_ + execInfoSize, 128);
+  address mem = (deviceArgs != nullptr) ?
+      vDev.allocKernelArguments(totalSize_ + execInfoSize, 128) : nullptr;
+  if (deviceArgs != nullptr) {
+    *deviceArgs = (mem != nullptr);
+  }
   if (mem == nullptr) {
-    mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_ + execInfoSize,
-                                                            PARAMETERS_MIN_ALIGNMENT));
-  } else {
-    deviceKernelArgs_ = true;
+    mem = allocParamBlock(totalSize_ + execInfoSize);
   }
 
   return mem;
@@ -171,6 +259,7 @@ bool KernelParameters::captureAndSet(void** kernelParams, address kernArgs, addr
 }
 
 void KernelParameters::set(size_t index, size_t size, const void* value, bool svmBound) {
+  releaseSnapshot();
   KernelParameterDescriptor& desc = signature_.params()[index];
 
   void* param = values_ + desc.offset_;
@@ -239,7 +328,8 @@ void KernelParameters::set(size_t index, size_t size, const void* value, bool sv
   desc.info_.defined_ = true;
 }
 
-address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error) {
+address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error,
+                                  bool* deviceArgs, Snapshot** snapshot) {
   const Device& device = vDev.device();
   *error = CL_SUCCESS;
 
@@ -247,12 +337,68 @@ address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSi
   // the actual parameters, but only if the device has any SVM capability
   const size_t execInfoSize = getNumberOfSvmPtr() * sizeof(void*);
 
-  address mem = vDev.allocKernelArguments(totalSize_ + execInfoSize, 128);
+  // The samplers and the queues are captured per enqueue
+  if ((snapshot != nullptr) && (signature_.numSamplers() == 0) &&
+      (signature_.numQueues() == 0)) {
+    Snapshot* current = nullptr;
+    {
+      ScopedLock lock(snapshotLock_);
+      if ((snapshot_ != nullptr) &&
+          ((&snapshot_->device_ != &device) || (snapshot_->lclMemIn_ != lclMemSize))) {
+        snapshot_->release();
+        snapshot_ = nullptr;
+      }
+      if (snapshot_ == nullptr) {
+        // Capture into a host block, which the snapshot owns with the references of the objects
+        address mem = capture(vDev, lclMemSize, error);
+        if (mem == nullptr) {
+          *snapshot = nullptr;
+          return nullptr;
+        }
+        uint64_t lclMemOut = lclMemSize;
+        for (size_t i = 0; i < signature_.numParameters(); ++i) {
+          const KernelParameterDescriptor& desc = signature_.at(i);
+          if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
+            lclMemOut = alignUp(lclMemOut, device.info().minDataTypeAlignSize_) +
+                ((desc.size_ == 8) ? *reinterpret_cast<const uint64_t*>(values_ + desc.offset_) :
+                                     *reinterpret_cast<const uint32_t*>(values_ + desc.offset_));
+          }
+        }
+        snapshot_ = new Snapshot(*this, device, mem, totalSize_ + execInfoSize, lclMemSize,
+                                 lclMemOut);
+      }
+      current = snapshot_;
+      current->retain();
+    }
+    address mem = (deviceArgs != nullptr) ?
+        vDev.allocKernelArguments(current->size_, 128) : nullptr;
+    if (deviceArgs != nullptr) {
+      *deviceArgs = (mem != nullptr);
+    }
+    if (mem == nullptr) {
+      mem = allocParamBlock(current->size_);
+    }
+    if (mem == nullptr) {
+      current->release();
+      *snapshot = nullptr;
+      *error = CL_OUT_OF_HOST_MEMORY;
+      return nullptr;
+    }
+    ::memcpy(mem, current->mem_, current->size_);
+    *snapshot = current;
+    return mem;
+  }
+  if (snapshot != nullptr) {
+    *snapshot = nullptr;
+  }
+
+  address mem = (deviceArgs != nullptr) ?
+      vDev.allocKernelArguments(totalSize_ + execInfoSize, 128) : nullptr;
+  if (deviceArgs != nullptr) {
+    *deviceArgs = (mem != nullptr);
+  }
   if (mem == nullptr) {
-    mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_ + execInfoSize,
-                                                            PARAMETERS_MIN_ALIGNMENT));
-  } else {
-    deviceKernelArgs_ = true;
+    mem = allocParamBlock(totalSize_ + execInfoSize);
   }
 
   if (mem != nullptr) {
@@ -320,7 +466,9 @@ address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSi
 
   // Check if capture was successful
   if (CL_SUCCESS != *error) {
-    AlignedMemory::deallocate(mem);
+    if ((deviceArgs == nullptr) || !*deviceArgs) {
+      freeParamBlock(mem);
+    }
     mem = nullptr;
   }
   return mem;
@@ -338,12 +486,20 @@ bool KernelParameters::boundToSvmPointer(const Device& device, const_address cap
   return svmBound[index];
 }
 
-void KernelParameters::release(address mem) const {
+void KernelParameters::release(address mem, bool deviceArgs, Snapshot* snapshot) const {
   if (mem == nullptr) {
     // nothing to do!
     return;
   }
 
+  if (snapshot != nullptr) {
+    snapshot->release();
+    if (!deviceArgs) {
+      freeParamBlock(mem);
+    }
+    return;
+  }
+
   amd::Memory* const* memories = reinterpret_cast<amd::Memory* const*>(mem + memoryObjOffset());
   for (uint32_t i = 0; i < signature_.numMemories(); ++i) {
     Memory* memArg = memories[i];
@@ -370,8 +526,8 @@ void KernelParameters::release(address mem) const {
     }
   }
 
-  if (!deviceKernelArgs()) {
-    AlignedMemory::deallocate(mem);
+  if (!deviceArgs) {
+    freeParamBlock(mem);
   }
 }
 
@@ -118,6 +118,33 @@ class KernelSignature : public HeapObject {
 // @todo: look into a copy-on-write model instead of copy-on-read.
 //
 class KernelParameters : protected HeapObject {
+ public:
+  //! Immutable captured parameters with the device addresses of the memory objects. The enqueues
+  //! of the kernel with unchanged arguments copy the snapshot instead of capturing every argument
+  //! again, the snapshot holds the references of the captured objects for all these enqueues
+  class Snapshot : public ReferenceCountedObject {
+   public:
+    Snapshot(const KernelParameters& parameters, const Device& device, address mem, size_t size,
+             uint64_t lclMemIn, uint64_t lclMemOut)
+        : parameters_(parameters),
+          device_(device),
+          mem_(mem),
+          size_(size),
+          lclMemIn_(lclMemIn),
+          lclMemOut_(lclMemOut) {}
+
+    const KernelParameters& parameters_;  //!< The parameters of the snapshot
+    const Device& device_;                //!< The device of the captured addresses
+    const address mem_;                   //!< The captured parameters
+    const size_t size_;                   //!< The size of the captured parameters
+    const uint64_t lclMemIn_;             //!< The local memory size before the arguments
+    const uint64_t lclMemOut_;            //!< The local memory size with the arguments
+
+   protected:
+    //! Releases the captured objects
+    ~Snapshot() { parameters_.release(mem_); }
+  };
+
  private:
   //! The signature describing these parameters.
   KernelSignature& signature_;
@@ -136,12 +163,14 @@ class KernelParameters : protected HeapObject {
 
   uint32_t  totalSize_;             //!< The total size of all captured parameters
 
+  Snapshot* snapshot_;              //!< The snapshot of the current parameters or nullptr
+  Monitor snapshotLock_;            //!< Serializes the snapshot update between the enqueues
+
   struct {
     uint32_t validated_ : 1;        //!< True if all parameters are defined.
     uint32_t execNewVcop_ : 1;      //!< special new VCOP for kernel execution
     uint32_t execPfpaVcop_ : 1;     //!< special PFPA VCOP for kernel execution
-    uint32_t deviceKernelArgs_:1;   //!< Kernel arguments allocated on device
-    uint32_t unused : 28;           //!< unused
+    uint32_t unused : 29;           //!< unused
   };
 
  public:
@@ -153,10 +182,11 @@ class KernelParameters : protected HeapObject {
         memoryObjects_(nullptr),
         samplerObjects_(nullptr),
         queueObjects_(nullptr),
+        snapshot_(nullptr),
+        snapshotLock_("Kernel parameters snapshot lock"),
         validated_(0),
         execNewVcop_(0),
-        execPfpaVcop_(0),
-        deviceKernelArgs_(false) {
+        execPfpaVcop_(0) {
     totalSize_ = signature.paramsSize() + (signature.numMemories() +
         signature.numSamplers() + signature.numQueues()) * sizeof(void*);
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), PARAMETERS_MIN_ALIGNMENT);
@@ -179,10 +209,11 @@ class KernelParameters : protected HeapObject {
         samplerObjects_(nullptr),
         queueObjects_(nullptr),
         totalSize_(rhs.totalSize_),
+        snapshot_(nullptr),
+        snapshotLock_("Kernel parameters snapshot lock"),
         validated_(rhs.validated_),
         execNewVcop_(rhs.execNewVcop_),
-        execPfpaVcop_(rhs.execPfpaVcop_),
-        deviceKernelArgs_(false) {
+        execPfpaVcop_(rhs.execPfpaVcop_) {
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), PARAMETERS_MIN_ALIGNMENT);
     memoryObjOffset_ = signature_.paramsSize();
     memoryObjects_ = reinterpret_cast<amd::Memory**>(values_ + memoryObjOffset_);
@@ -194,8 +225,11 @@ class KernelParameters : protected HeapObject {
     ::memcpy(values_, rhs.values_, limit - values_);
   }
 
+  ~KernelParameters() { releaseSnapshot(); }
+
   //! Reset the parameter at the given \a index (becomes undefined).
   void reset(size_t index) {
+    releaseSnapshot();
     signature_.params()[index].info_.defined_ = false;
     validated_ = 0;
   }
@@ -213,9 +247,25 @@ class KernelParameters : protected HeapObject {
   size_t localMemSize(size_t minDataTypeAlignment) const;
 
   //! Capture the state of the parameters and return the stack base pointer.
-  address capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error);
-  //! Release the captured state of the parameters.
-  void release(address parameters) const;
+  //! If \a deviceArgs is not null, then the state can be captured directly into
+  //! the device kernel arguments and \a deviceArgs reports the choice.
+  //! If \a snapshot is not null, then the state is copied from the snapshot of the current
+  //! parameters and \a snapshot returns the referenced snapshot or nullptr
+  address capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error,
+                  bool* deviceArgs = nullptr, Snapshot** snapshot = nullptr);
+  //! Release the captured state of the parameters. The objects of the parameters, copied from
+  //! a \a snapshot, are released with the snapshot
+  void release(address parameters, bool deviceArgs = false, Snapshot* snapshot = nullptr) const;
+
+  //! Drops the snapshot, the next capture takes a new one. The commands in flight keep
+  //! the references of the old snapshot
+  void releaseSnapshot() {
+    ScopedLock lock(snapshotLock_);
+    if (snapshot_ != nullptr) {
+      snapshot_->release();
+      snapshot_ = nullptr;
+    }
+  }
 
   //! Allocate memory for this instance as well as the required storage for
   //  the values_, defined_, and rawPointer_ arrays.
@@ -242,6 +292,7 @@ class KernelParameters : protected HeapObject {
   bool boundToSvmPointer(const Device& device, const_address capturedAddress, size_t index) const;
   //! add the svmPtr execInfo into container
   void addSvmPtr(void* const* execInfoArray, size_t count) {
+    releaseSnapshot();
     execSvmPtr_.clear();
     for (size_t i = 0; i < count; i++) {
       execSvmPtr_.push_back(execInfoArray[i]);
@@ -282,11 +333,9 @@ class KernelParameters : protected HeapObject {
   //! get the PFPA VCOP in the execInfo container
   bool getExecPfpaVcop() const { return (execPfpaVcop_ == 1); }
 
-  //! Returns true if arguemnts were allocated on device
-  bool deviceKernelArgs() const { return (deviceKernelArgs_ == 1); }
-
-  //! Allocate memory for kernel arguments to be set.
-  address alloc(device::VirtualDevice& vDev);
+  //! Allocate memory for kernel arguments to be set. If \a deviceArgs is not null, then
+  //! the memory can be allocated directly in the device kernel arguments
+  address alloc(device::VirtualDevice& vDev, bool* deviceArgs = nullptr);
 
   //! Capture the arguments from signature and set.
   bool captureAndSet(void** kernelParams, address kernArgs, address mem);
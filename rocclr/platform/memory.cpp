@@ -25,8 +25,19 @@
 #include "platform/object.hpp"
 #include "platform/memory.hpp"
 #include "device/device.hpp"
+#include "platform/activity.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif  // __linux__
 
 namespace amd {
 
@@ -165,6 +176,153 @@ void Memory::initDeviceMemory() {
   memset(deviceMemories_, 0, NumDevicesWithP2P() * sizeof(DeviceMemory));
 }
 
+// ================================================================================================
+AllocTrace::Stats AllocTrace::stats_[AllocTrace::kKindCount];
+std::atomic<uint64_t> AllocTrace::next_{0};
+AllocTrace::Entry* AllocTrace::ring_ = nullptr;
+
+static const char* AllocKindName[AllocTrace::kKindCount] = {
+    "device", "host", "managed", "pool", "internal"};
+
+// ================================================================================================
+const void* AllocTrace::CallSite() {
+#if defined(__linux__)
+  constexpr int kMaxFrames = 16;
+  void* frames[kMaxFrames];
+  int num_frames = backtrace(frames, kMaxFrames);
+  Dl_info runtime = {};
+  if (dladdr(reinterpret_cast<void*>(&AllocTrace::Record), &runtime) == 0) {
+    return nullptr;
+  }
+  for (int i = 1; i < num_frames; ++i) {
+    Dl_info info = {};
+    if ((dladdr(frames[i], &info) != 0) && (info.dli_fbase != runtime.dli_fbase)) {
+      return frames[i];
+    }
+  }
+#endif  // __linux__
+  return nullptr;
+}
+
+// ================================================================================================
+void AllocTrace::Record(Op op, Kind kind, const void* ptr, size_t size, const void* pool,
+                        const void* stream) {
+  static std::once_flag initialized;
+  std::call_once(initialized, []() { ring_ = new Entry[ROC_ALLOC_TRACE](); });
+
+  Stats& stats = stats_[kind];
+  if (op == kAlloc) {
+    stats.allocs_.fetch_add(1, std::memory_order_relaxed);
+    int64_t live = stats.live_.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = stats.peak_.load(std::memory_order_relaxed);
+    while ((live > peak) &&
+           !stats.peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+  } else {
+    stats.frees_.fetch_add(1, std::memory_order_relaxed);
+    stats.live_.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  if (ring_ != nullptr) {
+    uint64_t index = next_.fetch_add(1, std::memory_order_relaxed) % ROC_ALLOC_TRACE;
+    // Only the allocations are attributed, the frees are paired with them by the pointer
+    const void* site = (op == kAlloc) ? CallSite() : nullptr;
+    ring_[index] = {Os::timeNanos(), activity_prof::correlation_id, ptr, size, site, pool,
+                    stream, kind, op};
+  }
+}
+
+// ================================================================================================
+void AllocTrace::Report() {
+  if (!Enabled()) {
+    return;
+  }
+  for (uint32_t i = 0; i < kKindCount; ++i) {
+    const Stats& stats = stats_[i];
+    ClPrint(LOG_NONE, LOG_ALWAYS, "Alloc trace %-8s: allocs %lu, frees %lu, live %ld bytes, "
+            "peak %ld bytes", AllocKindName[i], stats.allocs_.load(std::memory_order_relaxed),
+            stats.frees_.load(std::memory_order_relaxed),
+            stats.live_.load(std::memory_order_relaxed),
+            stats.peak_.load(std::memory_order_relaxed));
+  }
+  if (ring_ == nullptr) {
+    return;
+  }
+
+  // Copy the ring in the order of the events. Concurrent records may tear a few entries
+  uint64_t count = next_.load(std::memory_order_relaxed);
+  uint64_t first = (count > ROC_ALLOC_TRACE) ? (count - ROC_ALLOC_TRACE) : 0;
+  std::vector<Entry> events;
+  events.reserve(count - first);
+  for (uint64_t i = first; i < count; ++i) {
+    events.push_back(ring_[i % ROC_ALLOC_TRACE]);
+  }
+
+  struct Site {
+    uint64_t allocs_ = 0;          //!< The number of the allocations from the site
+    uint64_t bytes_ = 0;           //!< Allocated bytes
+    uint64_t correlation_id_ = 0;  //!< Correlation ID of the last allocation
+  };
+  struct Lifetime {
+    uint64_t count_ = 0;  //!< The number of the allocations, freed within the ring
+    uint64_t sum_ = 0;    //!< Total lifetime in ns
+    uint64_t max_ = 0;    //!< The longest lifetime in ns
+  };
+  std::unordered_map<const void*, const Entry*> live;
+  std::unordered_map<const void*, Site> sites;
+  Lifetime lifetimes[kKindCount];
+  for (const auto& event : events) {
+    if (event.op_ == kAlloc) {
+      live[event.ptr_] = &event;
+      if (event.site_ != nullptr) {
+        Site& site = sites[event.site_];
+        ++site.allocs_;
+        site.bytes_ += event.size_;
+        site.correlation_id_ = event.correlation_id_;
+      }
+    } else if (auto it = live.find(event.ptr_); it != live.end()) {
+      Lifetime& lifetime = lifetimes[it->second->kind_];
+      uint64_t ns = event.time_ - it->second->time_;
+      ++lifetime.count_;
+      lifetime.sum_ += ns;
+      lifetime.max_ = std::max(lifetime.max_, ns);
+      live.erase(it);
+    }
+  }
+  for (uint32_t i = 0; i < kKindCount; ++i) {
+    if (lifetimes[i].count_ != 0) {
+      ClPrint(LOG_NONE, LOG_ALWAYS, "Alloc trace %-8s: lifetime avg %lu ns, max %lu ns over %lu "
+              "allocations", AllocKindName[i], lifetimes[i].sum_ / lifetimes[i].count_,
+              lifetimes[i].max_, lifetimes[i].count_);
+    }
+  }
+  uint64_t live_bytes = 0;
+  for (const auto& it : live) {
+    live_bytes += it.second->size_;
+  }
+  ClPrint(LOG_NONE, LOG_ALWAYS, "Alloc trace: %zu allocations, %lu bytes of the last %zu events "
+          "are still live", live.size(), live_bytes, events.size());
+
+  // The call sites with the most bytes go first
+  constexpr size_t kMaxSites = 8;
+  std::vector<std::pair<const void*, Site>> top(sites.begin(), sites.end());
+  size_t num_sites = std::min(kMaxSites, top.size());
+  std::partial_sort(top.begin(), top.begin() + num_sites, top.end(),
+                    [](const auto& a, const auto& b) { return a.second.bytes_ > b.second.bytes_; });
+  for (size_t i = 0; i < num_sites; ++i) {
+    const char* symbol = "";
+#if defined(__linux__)
+    Dl_info info = {};
+    if ((dladdr(top[i].first, &info) != 0) && (info.dli_sname != nullptr)) {
+      symbol = info.dli_sname;
+    }
+#endif  // __linux__
+    ClPrint(LOG_NONE, LOG_ALWAYS, "Alloc site %p %s: allocs %lu, bytes %lu, last correlation "
+            "id %lu", top[i].first, symbol, top[i].second.allocs_, top[i].second.bytes_,
+            top[i].second.correlation_id_);
+  }
+}
+
 // ================================================================================================
 void Memory::resetAllocationState() {
 
@@ -1526,21 +1684,21 @@ void Image::Format::formatColor(const void* colorRGBA, void* colorFormat) const
   }
 }
 
-Monitor SvmBuffer::AllocatedLock_ ROCCLR_INIT_PRIORITY(101) ("Guards SVM allocation list");
+std::shared_mutex SvmBuffer::AllocatedLock_ ROCCLR_INIT_PRIORITY(101);
 std::map<uintptr_t, uintptr_t> SvmBuffer::Allocated_ ROCCLR_INIT_PRIORITY(101);
 
 void SvmBuffer::Add(uintptr_t k, uintptr_t v) {
-  ScopedLock lock(AllocatedLock_);
+  std::unique_lock lock(AllocatedLock_);
   Allocated_.insert(std::pair<uintptr_t, uintptr_t>(k, v));
 }
 
 void SvmBuffer::Remove(uintptr_t k) {
-  ScopedLock lock(AllocatedLock_);
+  std::unique_lock lock(AllocatedLock_);
   Allocated_.erase(k);
 }
 
 bool SvmBuffer::Contains(uintptr_t ptr) {
-  ScopedLock lock(AllocatedLock_);
+  std::shared_lock lock(AllocatedLock_);
   auto it = Allocated_.upper_bound(ptr);
   if (it == Allocated_.begin()) {
     return false;
@@ -1563,6 +1721,9 @@ void* SvmBuffer::malloc(Context& context, cl_svm_mem_flags flags, size_t size, s
 }
 
 void SvmBuffer::free(const Context& context, void* ptr) {
+  if (SvmPool::free(context, ptr)) {
+    return;
+  }
   Remove(reinterpret_cast<uintptr_t>(ptr));
   context.svmFree(ptr);
 }
@@ -1578,6 +1739,172 @@ void SvmBuffer::memFill(void* dst, const void* src, size_t srcSize, size_t times
 // ================================================================================================
 bool SvmBuffer::malloced(const void* ptr) { return Contains(reinterpret_cast<uintptr_t>(ptr)); }
 
+namespace {
+
+//! A slab of the SVM pool
+struct SvmSlab {
+  const Context* context_;       //!< The context of the slab
+  cl_svm_mem_flags flags_;       //!< The SVM flags of the slab allocation
+  uintptr_t base_;               //!< The slab address
+  size_t block_;                 //!< The size class of the blocks
+  uint32_t capacity_;            //!< The number of the blocks in the slab
+  std::vector<uint32_t> free_;   //!< The indices of the free blocks
+};
+
+typedef std::tuple<const Context*, cl_svm_mem_flags, size_t> SvmPoolKey;
+
+struct SvmPoolState {
+  Monitor lock_{"Guards SVM pool"};
+  std::map<uintptr_t, SvmSlab*> slabs_;                      //!< The range index of all slabs
+  std::map<SvmPoolKey, std::vector<SvmSlab*>> available_;   //!< The slabs with free blocks
+};
+
+//! The pool is never destroyed, since the static objects may free SVM during the process exit
+SvmPoolState& GetSvmPool() {
+  static SvmPoolState* pool = new SvmPoolState();
+  return *pool;
+}
+
+//! The number of the slabs, the frees skip the pool lock if nothing is pooled
+std::atomic<size_t> svmPoolSlabs{0};
+
+//! The smallest size class, which holds a small list node
+constexpr size_t kSvmMinBlockSize = 64;
+
+//! Removes an empty slab from the pool. Must be called under the pool lock
+void RemoveSvmSlab(SvmPoolState& pool, SvmSlab* slab) {
+  auto it = pool.available_.find({slab->context_, slab->flags_, slab->block_});
+  it->second.erase(std::find(it->second.begin(), it->second.end(), slab));
+  if (it->second.empty()) {
+    pool.available_.erase(it);
+  }
+  pool.slabs_.erase(slab->base_);
+  --svmPoolSlabs;
+}
+
+}  // namespace
+
+// ================================================================================================
+void* SvmPool::malloc(Context& context, cl_svm_mem_flags flags, size_t size, size_t alignment) {
+  const size_t slab_size = static_cast<size_t>(AMD_OCL_SVM_POOL_SLAB_SIZE) * Ki;
+  // The blocks are aligned to the size class, since the slab is
+  size_t block = std::max({nextPowerOfTwo(size), alignment, kSvmMinBlockSize});
+  if ((slab_size == 0) || (block > (slab_size >> 3))) {
+    return nullptr;
+  }
+
+  SvmPoolState& pool = GetSvmPool();
+  const SvmPoolKey key(&context, flags, block);
+  {
+    ScopedLock lock(pool.lock_);
+    auto it = pool.available_.find(key);
+    if (it != pool.available_.end()) {
+      SvmSlab* slab = it->second.back();
+      uint32_t index = slab->free_.back();
+      slab->free_.pop_back();
+      if (slab->free_.empty()) {
+        it->second.pop_back();
+        if (it->second.empty()) {
+          pool.available_.erase(it);
+        }
+      }
+      return reinterpret_cast<void*>(slab->base_ + index * slab->block_);
+    }
+  }
+
+  // The slab allocation runs without the pool lock, since it goes to all devices of the context
+  void* base = SvmBuffer::malloc(context, flags, slab_size, block);
+  if (base == nullptr) {
+    return nullptr;
+  }
+  SvmSlab* slab = new SvmSlab{&context, flags, reinterpret_cast<uintptr_t>(base), block,
+                              static_cast<uint32_t>(slab_size / block), {}};
+  // Block 0 is returned now, the lower blocks are taken first
+  slab->free_.reserve(slab->capacity_);
+  for (uint32_t i = slab->capacity_ - 1; i > 0; --i) {
+    slab->free_.push_back(i);
+  }
+  ClPrint(LOG_INFO, LOG_MEM, "SVM pool slab %p of %u blocks of %zu bytes", base,
+          slab->capacity_, block);
+
+  ScopedLock lock(pool.lock_);
+  pool.slabs_[slab->base_] = slab;
+  pool.available_[key].push_back(slab);
+  ++svmPoolSlabs;
+  return base;
+}
+
+// ================================================================================================
+bool SvmPool::free(const Context& context, void* ptr) {
+  if (svmPoolSlabs == 0) {
+    return false;
+  }
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  SvmPoolState& pool = GetSvmPool();
+  void* release = nullptr;
+  {
+    ScopedLock lock(pool.lock_);
+    auto it = pool.slabs_.upper_bound(address);
+    if (it == pool.slabs_.begin()) {
+      return false;
+    }
+    SvmSlab* slab = (--it)->second;
+    if ((address >= (slab->base_ + slab->capacity_ * slab->block_)) ||
+        (slab->context_ != &context)) {
+      return false;
+    }
+    if (((address - slab->base_) % slab->block_) != 0) {
+      // A free of the slab would destroy the other blocks
+      LogPrintfError("SVM free of %p, which isn't a start of an allocation", ptr);
+      return true;
+    }
+    slab->free_.push_back(static_cast<uint32_t>((address - slab->base_) / slab->block_));
+
+    auto& available = pool.available_[{slab->context_, slab->flags_, slab->block_}];
+    if (slab->free_.size() == 1) {
+      available.push_back(slab);
+    }
+    if (slab->free_.size() == slab->capacity_) {
+      // Keep a single empty slab per size class, so an alloc/free loop doesn't reach the devices
+      bool idle = std::any_of(available.begin(), available.end(), [slab](const SvmSlab* other) {
+        return (other != slab) && (other->free_.size() == other->capacity_);
+      });
+      if (idle) {
+        release = reinterpret_cast<void*>(slab->base_);
+        RemoveSvmSlab(pool, slab);
+        delete slab;
+      }
+    }
+  }
+  if (release != nullptr) {
+    SvmBuffer::free(context, release);
+  }
+  return true;
+}
+
+// ================================================================================================
+void SvmPool::releaseIdle(const Context& context) {
+  if (svmPoolSlabs == 0) {
+    return;
+  }
+  SvmPoolState& pool = GetSvmPool();
+  std::vector<void*> release;
+  {
+    ScopedLock lock(pool.lock_);
+    for (auto it = pool.slabs_.begin(); it != pool.slabs_.end();) {
+      SvmSlab* slab = (it++)->second;
+      if ((slab->context_ == &context) && (slab->free_.size() == slab->capacity_)) {
+        release.push_back(reinterpret_cast<void*>(slab->base_));
+        RemoveSvmSlab(pool, slab);
+        delete slab;
+      }
+    }
+  }
+  for (auto ptr : release) {
+    SvmBuffer::free(context, ptr);
+  }
+}
+
 // ================================================================================================
 void IpcBuffer::initDeviceMemory() {
   deviceMemories_ =
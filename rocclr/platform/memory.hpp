@@ -37,6 +37,7 @@
 #include <unordered_map>
 #include <memory>
 #include <limits>
+#include <shared_mutex>
 #define CL_MEM_FOLLOW_USER_NUMA_POLICY  (1u << 31)
 #define ROCCLR_MEM_HSA_SIGNAL_MEMORY    (1u << 30)
 #define ROCCLR_MEM_INTERNAL_MEMORY      (1u << 29)
@@ -45,6 +46,8 @@
 #define ROCCLR_MEM_INTERPROCESS         (1u << 26)
 #define ROCCLR_MEM_PHYMEM               (1u << 25)
 #define ROCCLR_MEM_HSA_CONTIGUOUS       (1u << 24)
+#define ROCCLR_MEM_POOL_MEMORY          (1u << 23)
+#define ROCCLR_MEM_HUGE_PAGES           (1u << 22)
 
 namespace amd::device {
 class Memory;
@@ -684,7 +687,22 @@ class SvmBuffer : AllStatic {
   static bool Contains(uintptr_t ptr);
 
   static std::map<uintptr_t, uintptr_t> Allocated_;  // !< Allocated buffers
-  static Monitor AllocatedLock_;
+  static std::shared_mutex AllocatedLock_;            // !< Shared lock for the lookups
+};
+
+//! Sub-allocates small SVM buffers of clSVMAlloc from slabs. A slab belongs to one context and
+//! one set of the SVM flags and holds the blocks of a single power of two size class. The slabs
+//! are whole SVM buffers, hence a block is a plain interior SVM pointer for the runtime.
+class SvmPool : AllStatic {
+ public:
+  //! Returns a block for the allocation, nullptr if the size isn't pooled or the pool is empty
+  static void* malloc(Context& context, cl_svm_mem_flags flags, size_t size, size_t alignment);
+
+  //! Returns true if \a ptr is a block of the pool, which is released back into its slab
+  static bool free(const Context& context, void* ptr);
+
+  //! Frees the cached empty slabs of the context, so the slabs don't keep the context alive
+  static void releaseIdle(const Context& context);
 };
 
 class ArenaMemory: public Buffer {
@@ -711,6 +729,59 @@ class IpcBuffer : public Buffer {
   const void* handle_;  //!< Ipc handle, associated with this memory object
 };
 
+//! Low overhead trace of the allocations in a ring buffer of ROC_ALLOC_TRACE entries. The totals
+//! and peaks per kind are exact, the ring keeps the recent events for the lifetime and the call
+//! site statistics of the report
+class AllocTrace : AllStatic {
+ public:
+  enum Kind : uint32_t {
+    kDevice = 0,  //!< hipMalloc
+    kHost,        //!< hipHostMalloc
+    kManaged,     //!< hipMallocManaged
+    kPool,        //!< hipMallocAsync
+    kInternal,    //!< Runtime staging buffers and kernel argument pools
+    kKindCount
+  };
+  enum Op : uint32_t { kAlloc = 0, kFree };
+
+  struct Entry {
+    uint64_t time_;            //!< Timestamp in ns
+    uint64_t correlation_id_;  //!< API correlation ID of the call
+    const void* ptr_;          //!< Allocated or freed pointer
+    size_t size_;              //!< Allocation size
+    const void* site_;         //!< The first caller outside of the runtime
+    const void* pool_;         //!< Memory pool of the allocation
+    const void* stream_;       //!< Stream of the allocation
+    Kind kind_;                //!< Allocation kind
+    Op op_;                    //!< Allocation or free
+  };
+
+  //! Returns true if the trace is enabled
+  static bool Enabled() { return ROC_ALLOC_TRACE != 0; }
+
+  //! Adds the allocation event
+  static void Record(Op op, Kind kind, const void* ptr, size_t size, const void* pool = nullptr,
+                     const void* stream = nullptr);
+
+  //! Prints the totals and peaks per kind, the lifetimes and the top call sites in the ring
+  static void Report();
+
+ private:
+  struct Stats {
+    std::atomic<uint64_t> allocs_{0};  //!< The number of the allocations
+    std::atomic<uint64_t> frees_{0};   //!< The number of the frees
+    std::atomic<int64_t> live_{0};     //!< Live bytes
+    std::atomic<int64_t> peak_{0};     //!< Peak of the live bytes
+  };
+
+  //! Returns the first return address on the stack outside of the runtime library
+  static const void* CallSite();
+
+  static Stats stats_[kKindCount];       //!< Totals per kind
+  static std::atomic<uint64_t> next_;    //!< The number of the recorded events
+  static Entry* ring_;                   //!< Ring buffer of ROC_ALLOC_TRACE entries
+};
+
 
 }  // namespace amd
 
@@ -28,6 +28,8 @@
 #include "utils/bif_section_labels.hpp"
 #include "hsailctx.hpp"
 #endif
+#include "device/comgrctx.hpp"
+#include "utils/versions.hpp"  // AMD_PLATFORM_INFO
 
 #include <cstdlib>  // for malloc
 #include <cstring>  // for strcmp
@@ -35,6 +37,14 @@
 #include <fstream>
 #include <iostream>
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace amd {
 
@@ -72,6 +82,112 @@ static void remove_g_option(std::string &option)
   return;
 }
 
+// The workers of the asynchronous program builds. The builds of different programs run side
+// by side up to AMD_OCL_BUILD_THREADS, the workers stay for the process lifetime
+class BuildWorkers {
+ public:
+  static BuildWorkers& get() {
+    // The detached workers may still run during the process exit, hence never destroyed
+    static BuildWorkers* workers = new BuildWorkers();
+    return *workers;
+  }
+
+  void enqueue(std::function<void()> job) {
+    std::lock_guard<std::mutex> guard(lock_);
+    jobs_.push_back(std::move(job));
+    if ((idle_ == 0) && (threads_ < AMD_OCL_BUILD_THREADS)) {
+      ++threads_;
+      std::thread(&BuildWorkers::loop, this).detach();
+    } else {
+      cv_.notify_one();
+    }
+  }
+
+ private:
+  void loop() {
+    // The code object loads may need the runtime thread object
+    if (Thread::current() == NULL) {
+      new HostThread();
+    }
+    std::unique_lock<std::mutex> guard(lock_);
+    while (true) {
+      ++idle_;
+      cv_.wait(guard, [this]() { return !jobs_.empty(); });
+      --idle_;
+      std::function<void()> job = std::move(jobs_.front());
+      jobs_.pop_front();
+      guard.unlock();
+      job();
+      guard.lock();
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;  //!< The builds waiting for a worker
+  uint32_t threads_ = 0;                    //!< The started workers
+  uint32_t idle_ = 0;                       //!< The workers waiting for a build
+};
+
+// Returns the program cache file for the source built with the options, empty if disabled.
+// The name depends on everything the code object depends on: the ISA, the runtime build,
+// the compiler version, the final build options and the source code.
+static std::string ProgramCacheFileName(const Device& device, const std::string& source,
+                                        const std::string& options) {
+  std::string path = AMD_OCL_PROGRAM_CACHE_PATH;
+  size_t major = 0, minor = 0;
+#if defined(USE_COMGR_LIBRARY)
+  if (path.empty() || !device.settings().useLightning_ || !Comgr::IsReady()) {
+    return std::string();
+  }
+  Comgr::get_version(&major, &minor);
+#else
+  return std::string();
+#endif
+  std::string key = std::string(device.isa().isaName()) + AMD_PLATFORM_INFO +
+                    std::to_string(major) + "." + std::to_string(minor) + options + '\0' +
+                    source;
+  // FNV-1a hash of the key
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "program_%016llx_%zx.co", static_cast<unsigned long long>(hash),
+           key.size());
+  return path + Os::fileSeparator() + name;
+}
+
+// Reads the cached code object
+static bool LoadProgramCache(const std::string& file_name, std::vector<char>& binary) {
+  std::ifstream file(file_name, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+  if (!file.good()) {
+    return false;
+  }
+  binary.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(binary.data(), binary.size());
+  return file.good() && !binary.empty();
+}
+
+// Writes the code object into the cache. The temporary file is renamed, so a concurrent
+// process never reads a partial file
+static void StoreProgramCache(const std::string& file_name, const void* binary, size_t size) {
+  if (!Os::createPath(AMD_OCL_PROGRAM_CACHE_PATH)) {
+    return;
+  }
+  std::string tmp_name = file_name + "." + std::to_string(Os::getProcessId()) + ".tmp";
+  std::ofstream file(tmp_name, std::ios_base::out | std::ios_base::binary |
+                     std::ios_base::trunc);
+  file.write(reinterpret_cast<const char*>(binary), size);
+  file.close();
+  if (!file.good() || (std::rename(tmp_name.c_str(), file_name.c_str()) != 0)) {
+    std::remove(tmp_name.c_str());
+    return;
+  }
+  ClPrint(LOG_INFO, LOG_CODE, "Stored the program into %s", file_name.c_str());
+}
+
 Program::~Program() {
   // Destroy all device programs
   for (const auto& it : devicePrograms_) {
@@ -430,6 +546,7 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
     const device::Program& program = *(sit.second);
 
     const device::Program::kernels_t& kernels = program.kernels();
+    symbolTable_->reserve(kernels.size());
     for (const auto& it : kernels) {
       const std::string& name = it.first;
       const device::Kernel* devKernel = it.second;
@@ -485,6 +602,62 @@ void Program::StubProgramSource(const std::string& app_name) {
   program_counter++;
 }
 
+device::Program* Program::loadFromCache(Device& device, const std::string& file_name,
+                                        const char* options, option::Options& parsedOptions,
+                                        std::vector<char>& image) {
+  if (!LoadProgramCache(file_name, image)) {
+    return NULL;
+  }
+  device::Program* program = device.createProgram(*this, &parsedOptions);
+  if (program == NULL) {
+    return NULL;
+  }
+  // The program without the source loads the code object, as for clCreateProgramWithBinary()
+  if (!program->setBinary(image.data(), image.size()) ||
+      (program->build(std::string(), options, &parsedOptions, {}) != CL_SUCCESS)) {
+    LogPrintfWarning("The cached program %s is unusable, the program is compiled",
+                     file_name.c_str());
+    delete program;
+    return NULL;
+  }
+  ClPrint(LOG_INFO, LOG_CODE, "Loaded the program from %s", file_name.c_str());
+  return program;
+}
+
+int32_t Program::buildAsync(const std::vector<Device*>& devices, const char* options,
+                           void(CL_CALLBACK* notifyFptr)(cl_program, void*), void* data) {
+  {
+    ScopedLock sl(buildMonitor_);
+    if (buildPending_) {
+      return CL_INVALID_OPERATION;
+    }
+    buildPending_ = true;
+  }
+  // The program stays alive until the build is done, even if the app releases it
+  retain();
+  const bool hasOptions = (options != NULL);
+  std::string buildOptions(hasOptions ? options : "");
+  BuildWorkers::get().enqueue([this, devices, hasOptions, buildOptions, notifyFptr, data]() {
+    build(devices, hasOptions ? buildOptions.c_str() : NULL, NULL, NULL);
+    {
+      ScopedLock sl(buildMonitor_);
+      buildPending_ = false;
+      buildMonitor_.notifyAll();
+    }
+    // The callback runs after the waiters are released, since it may use the program
+    notifyFptr(as_cl(this), data);
+    release();
+  });
+  return CL_SUCCESS;
+}
+
+void Program::waitForBuild() {
+  ScopedLock sl(buildMonitor_);
+  while (buildPending_) {
+    buildMonitor_.wait();
+  }
+}
+
 int32_t Program::build(const std::vector<Device*>& devices, const char* options,
                       void(CL_CALLBACK* notifyFptr)(cl_program, void*), void* data,
                       bool optionChangable, bool newDevProg) {
@@ -513,9 +686,26 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
   std::string cppstr(options ? options : "");
   optionChangable &= adjustOptionsOnIgnoreEnv(cppstr);
 
+  // The device builds are independent, hence they are prepared in the device order and may run
+  // on the worker threads
+  struct DeviceBuild {
+    Device* device_;                            //!< The device of the build
+    device::Program* program_;                  //!< The device program to build
+    std::unique_ptr<option::Options> options_;  //!< The parsed options of the device build
+    std::string cacheFile_;                     //!< The program cache file, empty if disabled
+    device::Program* cached_ = NULL;            //!< The device program from the cache
+    std::vector<char> image_;                   //!< The code object of the cached program
+    int32_t result_ = CL_SUCCESS;               //!< The result of the device build
+  };
+  std::vector<DeviceBuild> builds;
+  builds.reserve(devices.size());
+  // HSAIL builds serialize on the global build lock anyway
+  bool parallel = true;
+
   // Build the program programs associated with the given devices.
   for (const auto& it : devices) {
-    option::Options parsedOptions;
+    std::unique_ptr<option::Options> options_ptr(new option::Options());
+    option::Options& parsedOptions = *options_ptr;
     constexpr bool LinkOptsOnly = false;
     if ((language_ != HIP) && !ParseAllOptions(cppstr, parsedOptions, optionChangable, LinkOptsOnly,
                          it->settings().useLightning_)) {
@@ -525,12 +715,18 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
     }
 
     device::Program* devProgram = getDeviceProgram(*it);
+    std::string cacheFile;
     if (devProgram == NULL) {
       const binary_t& bin = binary(*it);
       if (sourceCode_.empty() && (std::get<0>(bin) == NULL)) {
         retval = false;
         continue;
       }
+      // Only the self-contained OpenCL C source is cached, the embedded headers aren't hashed
+      if ((language_ == OpenCL_C) && !sourceCode_.empty() && headers_.empty() &&
+          precompiledHeaders_.empty()) {
+        cacheFile = ProgramCacheFileName(*it, sourceCode_, parsedOptions.origOptionStr);
+      }
       retval = addDeviceProgram(*it, std::get<0>(bin), std::get<1>(bin), false, &parsedOptions);
       if (retval != CL_SUCCESS) {
         return retval;
@@ -555,15 +751,74 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
     if (devProgram->buildStatus() != CL_BUILD_NONE) {
       continue;
     }
-    int32_t result = devProgram->build(sourceCode_, options, &parsedOptions, precompiledHeaders_);
+    parallel &= it->settings().useLightning_;
+    builds.push_back({it, devProgram, std::move(options_ptr), cacheFile});
+  }
+
+  auto buildDevice = [this, options](DeviceBuild& build) {
+    // A cache hit skips the compilation of the source
+    if (!build.cacheFile_.empty()) {
+      build.cached_ = loadFromCache(*build.device_, build.cacheFile_, options, *build.options_,
+                                    build.image_);
+      if (build.cached_ != NULL) {
+        return;
+      }
+    }
+    build.result_ = build.program_->build(sourceCode_, options, build.options_.get(),
+                                          precompiledHeaders_);
+    if ((build.result_ == CL_SUCCESS) && !build.cacheFile_.empty()) {
+      device::Program::binary_t executable = build.program_->binary();
+      StoreProgramCache(build.cacheFile_, executable.first, executable.second);
+    }
+  };
+  const size_t num_threads =
+      parallel ? std::min(static_cast<size_t>(AMD_OCL_BUILD_THREADS), builds.size()) : 1;
+  if (num_threads <= 1) {
+    for (auto& build : builds) {
+      buildDevice(build);
+    }
+  } else {
+    // Every worker takes the next device build, the calling thread is one of the workers
+    std::atomic<size_t> next(0);
+    auto worker = [&builds, &next, &buildDevice]() {
+      for (size_t i = next++; i < builds.size(); i = next++) {
+        buildDevice(builds[i]);
+      }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (size_t i = 1; i < num_threads; ++i) {
+      workers.emplace_back([&worker]() {
+        // The device code object loads may need the runtime thread object
+        if (Thread::current() == NULL) {
+          new HostThread();
+        }
+        worker();
+      });
+    }
+    worker();
+    for (auto& it : workers) {
+      it.join();
+    }
+    ClPrint(LOG_INFO, LOG_CODE, "Built the program for %zu devices with %zu threads",
+            builds.size(), num_threads);
+  }
 
+  for (auto& build : builds) {
+    if (build.cached_ != NULL) {
+      // The device program references the code object, hence it lives with the program
+      delete devicePrograms_[build.device_];
+      devicePrograms_[build.device_] = build.cached_;
+      cachedBinaries_[build.device_] = std::move(build.image_);
+      continue;
+    }
     // Check if the previous device failed a build
-    if ((result != CL_SUCCESS) && (retval != CL_SUCCESS)) {
+    if ((build.result_ != CL_SUCCESS) && (retval != CL_SUCCESS)) {
       retval = CL_INVALID_OPERATION;
     }
     // Update the returned value with a build error
-    else if (result != CL_SUCCESS) {
-      retval = result;
+    else if (build.result_ != CL_SUCCESS) {
+      retval = build.result_;
     }
   }
 
@@ -574,6 +829,7 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
       const device::Program& program = *(it.second);
 
       const device::Program::kernels_t& kernels = program.kernels();
+      symbolTable_->reserve(kernels.size());
       for (const auto& kit : kernels) {
         const std::string& name = kit.first;
         const device::Kernel* devKernel = kit.second;
@@ -594,6 +850,7 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
 }
 
 bool Program::load(const std::vector<Device*>& devices) {
+  waitForBuild();
   ScopedLock sl(&programLock_);
 
   for (const auto& it : devicePrograms_) {
@@ -645,6 +902,7 @@ void Program::clear() {
   }
 
   devicePrograms_.clear();
+  cachedBinaries_.clear();
   deviceList_.clear();
   if (symbolTable_) symbolTable_->clear();
   kernelNames_.clear();
@@ -117,9 +117,14 @@ class Program : public RuntimeObject {
   deviceprograms_t devicePrograms_;
   devicelist_t deviceList_;
 
+  //! The code objects from the program cache, referenced by the device programs
+  std::unordered_map<Device const*, std::vector<char>> cachedBinaries_;
+
   std::string programLog_;  //!< Log for parsing options, etc.
 
   Monitor programLock_; //!< Lock to protect program data structure
+  Monitor buildMonitor_; //!< Lock and wait for the asynchronous builds
+  bool buildPending_;    //!< An asynchronous build is queued or running
 
  protected:
   //! Destroy this program.
@@ -128,6 +133,11 @@ class Program : public RuntimeObject {
   //! Clears the program object if the app attempts to rebuild the program
   void clear();
 
+  //! Creates the device program from the code object in the program cache
+  device::Program* loadFromCache(Device& device, const std::string& file_name,
+                                 const char* options, option::Options& parsedOptions,
+                                 std::vector<char>& image);
+
  public:
   //! Construct a new program to be compiled from the given source code.
   Program(Context& context, const std::string& sourceCode, Language language,
@@ -137,7 +147,9 @@ class Program : public RuntimeObject {
         language_(language),
         symbolTable_(NULL),
         programLog_(),
-        programLock_(true) /* Program lock */ {
+        programLock_("Program lock", true),
+        buildMonitor_("Program build lock"),
+        buildPending_(false) {
     for (auto i = 0; i != numHeaders; ++i) {
       headers_.emplace_back(headers[i]);
       headerNames_.emplace_back(headerNames[i]);
@@ -148,7 +160,9 @@ class Program : public RuntimeObject {
   Program(Context& context, Language language = Binary)
       : context_(context), language_(language),
         symbolTable_(NULL),
-        programLock_(true) /* Program lock */ {}
+        programLock_("Program lock", true),
+        buildMonitor_("Program build lock"),
+        buildPending_(false) {}
 
   //! Returns context, associated with the current program.
   const Context& context() const { return context_(); }
@@ -222,6 +236,19 @@ class Program : public RuntimeObject {
                void(CL_CALLBACK* notifyFptr)(cl_program, void*) = NULL, void* data = NULL,
                bool optionChangable = true, bool newDevProg = true);
 
+  //! Builds the program on a build worker and calls \a notifyFptr when the build is done
+  int32_t buildAsync(const std::vector<Device*>& devices, const char* options,
+                     void(CL_CALLBACK* notifyFptr)(cl_program, void*), void* data);
+
+  //! Returns true if an asynchronous build is queued or running
+  bool buildPending() {
+    ScopedLock sl(buildMonitor_);
+    return buildPending_;
+  }
+
+  //! Waits for the asynchronous build of the program
+  void waitForBuild();
+
   //! Load the program. If devices is not specified, then load program for all devices.
   bool load(const std::vector<Device*>& devices = {});
 
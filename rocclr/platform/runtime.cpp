@@ -26,6 +26,9 @@
 #include "utils/options.hpp"
 #include "platform/context.hpp"
 #include "platform/agent.hpp"
+#include "platform/command.hpp"
+#include "platform/commandqueue.hpp"
+#include "platform/trace_events.hpp"
 
 #include "platform/interop_gl.hpp"
 
@@ -73,7 +76,7 @@ bool Runtime::init() {
     return true;
   }
 
-  if (!Flag::init() || !option::init() || !Device::init()
+  if (!Flag::init() || !TraceEvents::init() || !option::init() || !Device::init()
       // Agent initializes last
       || (!amd::IS_HIP && !Agent::init())) {
     ClPrint(LOG_ERROR, LOG_INIT, "Runtime initialization failed");
@@ -90,9 +93,16 @@ void Runtime::tearDown() {
     return;
   }
 
+  StartupProfile::dump();
+  // The deferred command destructors release the device signals
+  Command::FlushDeferredDeletes(true);
   Agent::tearDown();
   Device::tearDown();
   option::teardown();
+  device::KernelStats::Dump();
+  Monitor::DumpLockStats();
+  TraceEvents::dump();
+  log_flush();
   Flag::tearDown();
   if (outFile != stderr && outFile != nullptr) {
     fclose(outFile);
@@ -101,10 +111,121 @@ void Runtime::tearDown() {
   initialized_ = false;
 }
 
+void Runtime::fastTearDown() {
+  if (!initialized_) {
+    return;
+  }
+
+  // The pending work and the callbacks in it are visible to the app, hence they must complete.
+  // The device memory, the queues, the code objects and the other driver objects are reclaimed
+  // by the kernel driver with the process
+  for (auto device : Device::devices()) {
+    for (auto queue : device->getActiveQueues()) {
+      HostQueue* hostQueue = queue->asHostQueue();
+      if (hostQueue != nullptr) {
+        hostQueue->finish(true);
+      }
+    }
+  }
+
+  StartupProfile::dump();
+  device::KernelStats::Dump();
+  Monitor::DumpLockStats();
+  TraceEvents::dump();
+  log_flush();
+  if (outFile != stderr && outFile != nullptr) {
+    fclose(outFile);
+  }
+  initialized_ = false;
+}
+
+namespace {
+struct PhaseStats {
+  std::atomic<uint64_t> count_{0};        //!< The number of the recorded intervals
+  std::atomic<uint64_t> total_{0};        //!< Total time in nanoseconds
+  std::atomic<uint64_t> first_begin_{0};  //!< The start of the first interval
+  std::atomic<uint64_t> first_end_{0};    //!< The end of the first interval
+};
+PhaseStats startupPhases[StartupProfile::PhaseCount];
+std::atomic<uint64_t> startupOrigin{0};  //!< The start of the first recorded event
+
+const char* startupPhaseNames[StartupProfile::PhaseCount] = {
+  "hsa_init", "device_enumeration", "blit_build", "fat_binary_registration", "build_program",
+  "first_launch"
+};
+}  // namespace
+
+StartupProfile::Scope::Scope(Phase phase, bool active)
+    : phase_(phase), begin_((active && enabled()) ? Os::timeNanos() : 0) {}
+
+StartupProfile::Scope::~Scope() {
+  if (begin_ != 0) {
+    record(phase_, begin_, Os::timeNanos());
+  }
+}
+
+bool StartupProfile::enabled() {
+  static const bool enabled = []() {
+    const char* path = getenv("AMD_STARTUP_PROFILE");
+    return (path != nullptr) && (path[0] != '\0');
+  }();
+  return enabled;
+}
+
+void StartupProfile::record(Phase phase, uint64_t begin, uint64_t end) {
+  // The nested phases finish first, so keep the earliest start as the origin
+  uint64_t origin = startupOrigin;
+  while (((origin == 0) || (begin < origin)) &&
+         !startupOrigin.compare_exchange_weak(origin, begin)) {
+  }
+  PhaseStats& stats = startupPhases[phase];
+  if (stats.count_++ == 0) {
+    stats.first_begin_ = begin;
+    stats.first_end_ = end;
+  }
+  stats.total_ += end - begin;
+}
+
+void StartupProfile::mark(Phase phase) {
+  if (enabled() && (startupPhases[phase].count_ == 0)) {
+    uint64_t now = Os::timeNanos();
+    uint64_t origin = startupOrigin;
+    record(phase, (origin != 0) ? origin : now, now);
+  }
+}
+
+void StartupProfile::dump() {
+  if (!enabled()) {
+    return;
+  }
+  const char* path = getenv("AMD_STARTUP_PROFILE");
+  FILE* file = fopen(path, "w");
+  if (file == nullptr) {
+    ClPrint(LOG_ERROR, LOG_INIT, "Unable to write the startup profile into %s", path);
+    return;
+  }
+  // All times are in milliseconds, the starts are relative to the first recorded event
+  uint64_t origin = startupOrigin;
+  fprintf(file, "{\n  \"pid\": %d,\n  \"phases\": {", Os::getProcessId());
+  for (uint32_t i = 0; i < PhaseCount; ++i) {
+    const PhaseStats& stats = startupPhases[i];
+    fprintf(file, "%s\n    \"%s\": {\"count\": %llu", (i == 0) ? "" : ",",
+            startupPhaseNames[i], static_cast<unsigned long long>(stats.count_.load()));
+    if (stats.count_ != 0) {
+      fprintf(file, ", \"total_ms\": %.3f, \"first_start_ms\": %.3f, \"first_end_ms\": %.3f",
+              stats.total_ / 1e6, (stats.first_begin_ - origin) / 1e6,
+              (stats.first_end_ - origin) / 1e6);
+    }
+    fprintf(file, "}");
+  }
+  fprintf(file, "\n  }\n}\n");
+  fclose(file);
+}
+
 // ~RuntimeTearDown() will reference listenerLock.
 // listenerLock will be constructed ealier and destructed later than
 // runtime_tear_down.
-amd::Monitor listenerLock("Hostcall listener lock");
+amd::Monitor listenerLock("Hostcall listener lock", true);
 std::vector<ReferenceCountedObject*> RuntimeTearDown::external_;
 
 RuntimeTearDown::~RuntimeTearDown() {
@@ -112,6 +233,10 @@ RuntimeTearDown::~RuntimeTearDown() {
   // Only perform destruction if process matches the initialization,
   // to avoid a call with the child process after fork()
   if (amd::IS_HIP && amd::Os::getProcessId() == Runtime::pid()) {
+    if (HIP_FAST_EXIT) {
+      Runtime::fastTearDown();
+      return;
+    }
     for (auto it: external_) {
       it->release();
     }
@@ -131,7 +256,8 @@ uint ReferenceCountedObject::retain() {
 }
 
 uint ReferenceCountedObject::release() {
-  uint newCount = referenceCount_.fetch_sub(1, std::memory_order_relaxed) - 1;
+  // The release orders the prior accesses of this thread before the destruction on another one
+  uint newCount = referenceCount_.fetch_sub(1, std::memory_order_acq_rel) - 1;
   if (newCount == 0) {
     if (terminate()) {
       delete this;
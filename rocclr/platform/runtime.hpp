@@ -48,6 +48,9 @@ class Runtime : AllStatic {
   //! Tear down the runtime.
   static void tearDown();
 
+  //! Tear down the runtime at the process exit, without the release of the device resources
+  static void fastTearDown();
+
   //! Return true if the Runtime is still single-threaded.
   static bool singleThreaded() { return !initialized(); }
 
@@ -62,6 +65,45 @@ class Runtime : AllStatic {
 
 /*@}*/
 
+//! Startup phase timings. The phases are recorded, if AMD_STARTUP_PROFILE names an output file,
+//! and written into it as JSON at the runtime teardown. The variable is read from the
+//! environment directly, since the fat binaries are registered before the flags are parsed.
+class StartupProfile : AllStatic {
+ public:
+  enum Phase : uint32_t {
+    HsaInit = 0,            //!< hsa_init()
+    DeviceEnumeration,      //!< Agent enumeration and the device creation
+    BlitBuild,              //!< The blit program build per device
+    FatBinaryRegistration,  //!< __hipRegisterFatBinary()
+    BuildProgram,           //!< The first build and load of a fat binary program per device
+    FirstLaunch,            //!< From the first recorded event to the first kernel launch
+    PhaseCount
+  };
+
+  //! Records a phase for the scope lifetime
+  class Scope : public StackObject {
+   public:
+    Scope(Phase phase, bool active = true);
+    ~Scope();
+
+   private:
+    Phase phase_;     //!< The recorded phase
+    uint64_t begin_;  //!< The start time, 0 if the profile is disabled
+  };
+
+  //! Returns true if the startup profile is enabled
+  static bool enabled();
+
+  //! Records an interval of the phase
+  static void record(Phase phase, uint64_t begin, uint64_t end);
+
+  //! Records the phase from the first recorded event until now, only the first time
+  static void mark(Phase phase);
+
+  //! Writes the profile into the output file
+  static void dump();
+};
+
 class RuntimeTearDown : public HeapObject {
   static std::vector<ReferenceCountedObject*> external_;
 
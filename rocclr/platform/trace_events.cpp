@@ -0,0 +1,189 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/trace_events.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace amd {
+
+namespace {
+
+struct TraceEvent {
+  const char* name_;   //!< The event name with the static lifetime
+  uint64_t begin_;     //!< The start time in ns
+  uint64_t end_;       //!< The end time in ns
+  uint32_t category_;  //!< TraceEvents::Category
+  uint32_t track_;     //!< The host thread or the GPU engine timeline
+};
+
+//! The GPU engine timelines follow the host threads
+constexpr uint32_t kGpuTrack = 1u << 31;
+
+//! Limits the memory of a long running process, the later events of the thread are dropped
+constexpr size_t kMaxEventsPerThread = 1 << 20;
+
+//! Per-thread event buffer. The lock is uncontended, except the dump
+struct ThreadEvents {
+  std::mutex lock_;
+  std::vector<TraceEvent> events_;
+  uint32_t thread_;      //!< Sequential id of the thread
+  uint64_t dropped_ = 0; //!< Events over the limit
+
+  ThreadEvents(uint32_t thread) : thread_(thread) {}
+};
+
+//! The buffers are kept after the thread exit until the dump, the list is never freed, since
+//! the static objects may still record during the process exit
+struct TraceBuffers {
+  std::mutex lock_;
+  std::vector<ThreadEvents*> threads_;
+};
+
+TraceBuffers& GetTraceBuffers() {
+  static TraceBuffers* buffers = new TraceBuffers();
+  return *buffers;
+}
+
+const char* traceCategoryNames[TraceEvents::CategoryCount] = {
+  "enqueue", "worker", "submit", "barrier", "wait", "copy", "load", "memory", "gpu"
+};
+
+std::atomic<int64_t> gpuClockOffset{0};
+std::atomic<bool> gpuClockOffsetValid{false};
+
+ThreadEvents& GetThreadEvents() {
+  static std::atomic<uint32_t> threads{0};
+  static thread_local ThreadEvents* events = nullptr;
+  if (events == nullptr) {
+    events = new ThreadEvents(threads++);
+    TraceBuffers& buffers = GetTraceBuffers();
+    std::lock_guard<std::mutex> guard(buffers.lock_);
+    buffers.threads_.push_back(events);
+  }
+  return *events;
+}
+
+void AddEvent(const TraceEvent& event) {
+  ThreadEvents& thread = GetThreadEvents();
+  std::lock_guard<std::mutex> guard(thread.lock_);
+  if (thread.events_.size() < kMaxEventsPerThread) {
+    thread.events_.push_back(event);
+  } else {
+    ++thread.dropped_;
+  }
+}
+}  // namespace
+
+bool TraceEvents::enabled_ = false;
+
+// ================================================================================================
+void TraceEvents::record(Category category, const char* name, uint64_t begin, uint64_t end) {
+  AddEvent({name, begin, end, category, GetThreadEvents().thread_});
+}
+
+// ================================================================================================
+void TraceEvents::recordGpu(const char* name, uint64_t begin, uint64_t end, uint32_t device,
+                            uint32_t queue, bool sdma) {
+  if (!gpuClockOffsetValid.load(std::memory_order_acquire)) {
+    return;
+  }
+  // The track encodes the device, the virtual device and the engine for the timeline names
+  uint32_t track = kGpuTrack | (device << 24) | ((queue & 0x7fffff) << 1) | (sdma ? 1 : 0);
+  int64_t offset = gpuClockOffset.load(std::memory_order_relaxed);
+  AddEvent({name, begin + offset, end + offset, Gpu, track});
+}
+
+// ================================================================================================
+void TraceEvents::setGpuClockOffset(int64_t offset) {
+  gpuClockOffset.store(offset, std::memory_order_relaxed);
+  gpuClockOffsetValid.store(true, std::memory_order_release);
+}
+
+// ================================================================================================
+bool TraceEvents::hasGpuClockOffset() {
+  return gpuClockOffsetValid.load(std::memory_order_acquire);
+}
+
+// ================================================================================================
+void TraceEvents::dump() {
+  if (!enabled()) {
+    return;
+  }
+  std::string path = ROC_TRACE_EVENTS;
+  const size_t pid_pos = path.find("%pid%");
+  if (pid_pos != std::string::npos) {
+    path.replace(pid_pos, 5, std::to_string(Os::getProcessId()));
+  }
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    ClPrint(LOG_ERROR, LOG_ALWAYS, "Unable to write the trace events into %s", path.c_str());
+    return;
+  }
+
+  const int pid = Os::getProcessId();
+  std::set<uint32_t> tracks;
+  uint64_t dropped = 0;
+  bool first = true;
+  fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  TraceBuffers& buffers = GetTraceBuffers();
+  std::lock_guard<std::mutex> guard(buffers.lock_);
+  for (auto thread : buffers.threads_) {
+    std::lock_guard<std::mutex> thread_guard(thread->lock_);
+    for (const auto& it : thread->events_) {
+      // Chrome trace times are in microseconds
+      fprintf(file, "%s\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": %d, "
+              "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", first ? "" : ",", it.name_,
+              traceCategoryNames[it.category_], pid, it.track_, it.begin_ / 1e3,
+              (it.end_ - it.begin_) / 1e3);
+      tracks.insert(it.track_);
+      first = false;
+    }
+    dropped += thread->dropped_;
+  }
+  for (auto track : tracks) {
+    char name[64];
+    if ((track & kGpuTrack) != 0) {
+      snprintf(name, sizeof(name), "GPU %u queue %u %s", (track >> 24) & 0x7f,
+               (track >> 1) & 0x7fffff, (track & 1) ? "sdma" : "compute");
+    } else {
+      snprintf(name, sizeof(name), "Host thread %u", track);
+    }
+    // Sort the GPU timelines after the host threads
+    fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %u, "
+            "\"args\": {\"name\": \"%s\"}},\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", "
+            "\"pid\": %d, \"tid\": %u, \"args\": {\"sort_index\": %u}}", first ? "" : ",", pid,
+            track, name, pid, track, track);
+    first = false;
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  if (dropped != 0) {
+    ClPrint(LOG_WARNING, LOG_ALWAYS, "Trace events dropped %lu events over the limit of %zu "
+            "per thread", dropped, kMaxEventsPerThread);
+  }
+}
+
+}  // namespace amd
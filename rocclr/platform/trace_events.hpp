@@ -0,0 +1,103 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef TRACE_EVENTS_HPP_
+#define TRACE_EVENTS_HPP_
+
+#include "top.hpp"
+#include "utils/flags.hpp"
+#include "os/os.hpp"
+
+namespace amd {
+
+/*! \addtogroup Runtime
+ *  @{
+ */
+
+//! Runtime internal events. If ROC_TRACE_EVENTS names an output file, the events are collected
+//! in per-thread buffers and written at the runtime teardown as Chrome trace JSON, which
+//! chrome://tracing and Perfetto open. The GPU execution times of the profiled commands are
+//! moved to the host clock, so the host and the GPU timelines line up.
+class TraceEvents : AllStatic {
+ public:
+  enum Category : uint32_t {
+    Enqueue = 0,  //!< The command enqueue on the host queue
+    Worker,       //!< The command processing on the host queue thread
+    Submit,       //!< The command submission into the device queue
+    Barrier,      //!< Barrier packets
+    Wait,         //!< Blocking waits for HSA signals
+    Copy,         //!< Staging copies
+    Load,         //!< Code object loads
+    Memory,       //!< Memory pool trims
+    Gpu,          //!< GPU execution
+    CategoryCount
+  };
+
+  //! Records an event for the scope lifetime
+  class Scope : public StackObject {
+   public:
+    Scope(Category category, const char* name)
+        : category_(category), name_(name), begin_(enabled() ? Os::timeNanos() : 0) {}
+    ~Scope() {
+      if (begin_ != 0) {
+        record(category_, name_, begin_, Os::timeNanos());
+      }
+    }
+
+   private:
+    Category category_;  //!< The category of the event
+    const char* name_;   //!< The event name, must be a string with the static lifetime
+    uint64_t begin_;     //!< The start time, 0 if the trace is disabled
+  };
+
+  //! Resolves the trace state from the flags, the commands check it on every creation
+  static bool init() {
+    enabled_ = (ROC_TRACE_EVENTS[0] != '\0');
+    return true;
+  }
+
+  //! Returns true if the trace is enabled
+  static bool enabled() { return enabled_; }
+
+  //! Records an event on the timeline of the calling thread
+  static void record(Category category, const char* name, uint64_t begin, uint64_t end);
+
+  //! Records a GPU execution interval in the GPU clock on the timeline of the GPU engine
+  static void recordGpu(const char* name, uint64_t begin, uint64_t end, uint32_t device,
+                        uint32_t queue, bool sdma);
+
+  //! Sets the offset from the GPU clock to the host clock
+  static void setGpuClockOffset(int64_t offset);
+
+  //! Returns true if the GPU clock offset is known
+  static bool hasGpuClockOffset();
+
+  //! Writes the collected events into the output file
+  static void dump();
+
+ private:
+  static bool enabled_;  //!< ROC_TRACE_EVENTS names an output file
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*TRACE_EVENTS_HPP_*/
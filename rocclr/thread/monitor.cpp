@@ -22,11 +22,16 @@
 #include "thread/semaphore.hpp"
 #include "thread/thread.hpp"
 #include "utils/util.hpp"
+#include "utils/debug.hpp"
+#include "os/os.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <mutex>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace amd {
 MonitorBase::~MonitorBase() {}
@@ -34,16 +39,25 @@ MonitorBase::~MonitorBase() {}
 namespace legacy_monitor {
 
 Monitor::Monitor(bool recursive)
-    : contendersList_(0), onDeck_(0), waitersList_(NULL), owner_(NULL), recursive_(recursive) {}
+    : contendersList_(0),
+      onDeck_(0),
+      waitersList_(NULL),
+      owner_(NULL),
+      recursive_(recursive),
+      spinEstimate_(kMaxReadSpinIter / 2) {}
 
 bool Monitor::trySpinLock() {
   if (tryLock()) {
     return true;
   }
 
-  for (int s = kMaxSpinIter; s > 0; --s) {
+  // The estimate follows the spins of the successful acquisitions and decays on the failures.
+  // The updates race without harm, the estimate is only a hint
+  int estimate = spinEstimate_.load(std::memory_order_relaxed);
+  const int limit = std::min(kMaxSpinIter, 2 * estimate + kMinSpinIter);
+  for (int s = 0; s < limit; ++s) {
     // First, be SMT friendly
-    if (s >= (kMaxSpinIter - kMaxReadSpinIter)) {
+    if (s < kMaxReadSpinIter) {
       Os::spinPause();
     }
     // and then SMP friendly
@@ -51,11 +65,18 @@ bool Monitor::trySpinLock() {
       Thread::yield();
     }
     if (!isLocked()) {
-      return tryLock();
+      if (tryLock()) {
+        // Round the growth up, so a lock the estimate decayed on can learn the spins again
+        const int step = (s >= estimate) ? (s - estimate + 7) / 8 : (s - estimate) / 8;
+        spinEstimate_.store(estimate + step, std::memory_order_relaxed);
+        return true;
+      }
+      break;
     }
   }
 
   // We could not acquire the lock in the spin loop.
+  spinEstimate_.store(estimate - (estimate + 7) / 8, std::memory_order_relaxed);
   return false;
 }
 
@@ -395,4 +416,163 @@ void Monitor::unlock() {
   finishUnlock();
 }
 } // namespace legacy_monitor
+
+namespace {
+
+//! Lock profile counters of one monitor name
+struct LockCounters {
+  std::atomic<uint64_t> acquisitions_{0};  //!< All acquisitions
+  std::atomic<uint64_t> contended_{0};     //!< Acquisitions which had to wait
+  std::atomic<uint64_t> waitTime_{0};      //!< Total wait time in ns
+};
+
+//! The slot count is fixed, so the dump can read the counters of the running threads
+constexpr uint32_t kMaxLockStats = 256;
+
+//! Lock profile of one thread, only the owner thread updates the counters
+struct ThreadLockStats {
+  LockCounters counters_[kMaxLockStats];
+};
+
+//! The names and the per-thread profiles. The profile is never freed, since the monitors of the
+//! static objects may still lock during the process exit
+struct LockProfile {
+  std::mutex lock_;  //!< Can't be a Monitor, which reports into the profile
+  std::vector<const char*> names_{"<unnamed>"};  //!< Monitor name per slot
+  std::vector<ThreadLockStats*> threads_;        //!< Profiles of the running threads
+  ThreadLockStats retired_;                      //!< Merged profiles of the exited threads
+};
+
+LockProfile& GetLockProfile() {
+  static LockProfile* profile = new LockProfile();
+  return *profile;
+}
+
+//! Merges the profile of an exiting thread into the retired counters
+struct ThreadLockStatsHolder {
+  ThreadLockStats* stats_ = nullptr;
+
+  ~ThreadLockStatsHolder() {
+    if (stats_ == nullptr) {
+      return;
+    }
+    LockProfile& profile = GetLockProfile();
+    std::lock_guard<std::mutex> guard(profile.lock_);
+    for (uint32_t i = 0; i < kMaxLockStats; ++i) {
+      const LockCounters& src = stats_->counters_[i];
+      LockCounters& dst = profile.retired_.counters_[i];
+      dst.acquisitions_ += src.acquisitions_.load(std::memory_order_relaxed);
+      dst.contended_ += src.contended_.load(std::memory_order_relaxed);
+      dst.waitTime_ += src.waitTime_.load(std::memory_order_relaxed);
+    }
+    profile.threads_.erase(std::find(profile.threads_.begin(), profile.threads_.end(), stats_));
+    delete stats_;
+  }
+};
+
+ThreadLockStats& GetThreadLockStats() {
+  static thread_local ThreadLockStatsHolder holder;
+  if (holder.stats_ == nullptr) {
+    holder.stats_ = new ThreadLockStats();
+    LockProfile& profile = GetLockProfile();
+    std::lock_guard<std::mutex> guard(profile.lock_);
+    profile.threads_.push_back(holder.stats_);
+  }
+  return *holder.stats_;
+}
+
+//! The owner thread is the only writer, hence a plain read-modify-write without a locked add
+inline void AddCounter(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// ================================================================================================
+uint32_t Monitor::RegisterLockStats(const char* name) {
+  // The unnamed monitors share the first slot and the last slot takes the names without a slot
+  constexpr uint32_t kUnnamed = 0;
+  constexpr uint32_t kOthers = kMaxLockStats - 1;
+  if (name == nullptr) {
+    return kUnnamed;
+  }
+  LockProfile& profile = GetLockProfile();
+  std::lock_guard<std::mutex> guard(profile.lock_);
+  for (uint32_t i = 0; i < profile.names_.size(); ++i) {
+    if (strcmp(profile.names_[i], name) == 0) {
+      return i;
+    }
+  }
+  if (profile.names_.size() == kOthers) {
+    profile.names_.push_back("<others>");
+  }
+  if (profile.names_.size() > kOthers) {
+    return kOthers;
+  }
+  profile.names_.push_back(name);
+  return static_cast<uint32_t>(profile.names_.size() - 1);
+}
+
+// ================================================================================================
+void Monitor::profiledLock() {
+  uint32_t slot = stats_.load(std::memory_order_relaxed);
+  if (slot == kNoStats) {
+    // The lookup returns the same slot for the same name, so the racing threads agree
+    slot = RegisterLockStats(name_);
+    stats_.store(slot, std::memory_order_relaxed);
+  }
+  LockCounters& counters = GetThreadLockStats().counters_[slot];
+  AddCounter(counters.acquisitions_, 1);
+  if (monitor_->tryLock()) {
+    return;
+  }
+  uint64_t start = Os::timeNanos();
+  monitor_->lock();
+  AddCounter(counters.contended_, 1);
+  AddCounter(counters.waitTime_, Os::timeNanos() - start);
+}
+
+// ================================================================================================
+void Monitor::DumpLockStats() {
+  if (!DEBUG_CLR_LOCK_PROFILE) {
+    return;
+  }
+  struct Total {
+    uint32_t slot_;
+    uint64_t acquisitions_;
+    uint64_t contended_;
+    uint64_t waitTime_;
+  };
+  std::vector<Total> totals;
+  std::vector<const char*> names;
+  {
+    LockProfile& profile = GetLockProfile();
+    std::lock_guard<std::mutex> guard(profile.lock_);
+    names = profile.names_;
+    for (uint32_t i = 0; i < names.size(); ++i) {
+      Total total = {i, 0, 0, 0};
+      auto merge = [&total, i](const ThreadLockStats& stats) {
+        total.acquisitions_ += stats.counters_[i].acquisitions_.load(std::memory_order_relaxed);
+        total.contended_ += stats.counters_[i].contended_.load(std::memory_order_relaxed);
+        total.waitTime_ += stats.counters_[i].waitTime_.load(std::memory_order_relaxed);
+      };
+      merge(profile.retired_);
+      for (const auto it : profile.threads_) {
+        merge(*it);
+      }
+      if (total.acquisitions_ != 0) {
+        totals.push_back(total);
+      }
+    }
+  }
+  std::sort(totals.begin(), totals.end(),
+            [](const Total& a, const Total& b) { return a.waitTime_ > b.waitTime_; });
+  for (const auto& it : totals) {
+    ClPrint(amd::LOG_NONE, amd::LOG_ALWAYS, "Lock stats %s: acquisitions %lu, contended %lu "
+            "(%.1f%%), total wait %lu us, avg wait %lu ns", names[it.slot_], it.acquisitions_,
+            it.contended_, (100.0 * it.contended_) / it.acquisitions_, it.waitTime_ / 1000,
+            (it.contended_ != 0) ? it.waitTime_ / it.contended_ : 0);
+  }
+}
+
 }  // namespace amd
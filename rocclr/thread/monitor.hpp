@@ -91,6 +91,7 @@ class Monitor final: public HeapObject, public MonitorBase {
 
   static constexpr int kMaxSpinIter = 55;      //!< Total number of spin iterations.
   static constexpr int kMaxReadSpinIter = 50;  //!< Read iterations before yielding
+  static constexpr int kMinSpinIter = 4;       //!< Spin iterations of the long hold locks
 
   /*! Linked list of semaphores the contending threads are waiting on
    *  and main lock.
@@ -108,6 +109,11 @@ class Monitor final: public HeapObject, public MonitorBase {
   uint32_t lockCount_;
   //! True if this is a recursive mutex, false otherwise.
   const bool recursive_;
+  /*! The spin iterations, which recently acquired the contended lock. The short hold locks
+   *  keep spinning up to twice the estimate, the long hold locks decay to the minimum spin
+   *  and park almost at once
+   */
+  std::atomic_int spinEstimate_;
 
  private:
   //! Finish locking the mutex (contented case).
@@ -242,7 +248,10 @@ class Monitor final: public HeapObject, public MonitorBase {
 // Monitor API wrapper to user
 class Monitor {
 public:
-  explicit Monitor(bool recursive = false) {
+  explicit Monitor(bool recursive = false) : Monitor(nullptr, recursive) {}
+  //! The lock profiler reports the monitors by name, the monitors with the same name add up.
+  //! The name must outlive the monitor, usually it's a string literal
+  explicit Monitor(const char* name, bool recursive = false) : name_(name), stats_(kNoStats) {
     if (DEBUG_CLR_USE_STDMUTEX_IN_AMD_MONITOR) {
       monitor_ = new mutex_monitor::Monitor(recursive);
     }
@@ -252,14 +261,38 @@ public:
   }
   inline ~Monitor() { delete monitor_; };
   inline bool tryLock() { return monitor_->tryLock(); }
-  inline void lock() { monitor_->lock(); }
+  inline void lock() {
+    if (!DEBUG_CLR_LOCK_PROFILE) {
+      monitor_->lock();
+    } else {
+      profiledLock();
+    }
+  }
   inline void unlock() { monitor_->unlock(); }
   inline void wait() { monitor_->wait(); }
   inline void notify() { monitor_->notify(); }
   inline void notifyAll() { monitor_->notifyAll(); }
 
+  //! Returns the name of the monitor, nullptr for unnamed monitors
+  const char* name() const { return name_; }
+
+  //! Prints the lock profile of all monitors, sorted by the total wait time
+  static void DumpLockStats();
+
 private:
+  static constexpr uint32_t kNoStats = ~0u;
+
+  //! Returns the lock profile slot of the monitor name
+  static uint32_t RegisterLockStats(const char* name);
+
+  //! Acquires the lock and counts the acquisition in the profile of the calling thread
+  void profiledLock();
+
   MonitorBase* monitor_;
+  const char* name_;  //!< The name of the monitor
+  //! The lock profile slot, the static monitors exist before the flags are read, hence the
+  //! first profiled lock looks up the slot
+  std::atomic<uint32_t> stats_;
 };
 
 class ScopedLock : StackObject {
@@ -0,0 +1,124 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "thread/rwmonitor.hpp"
+#include "os/os.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+namespace amd {
+
+namespace {
+
+//! Identifies the calling thread, the threads outside the runtime don't have amd::Thread
+const void* ThreadTag() {
+  static thread_local char tag;
+  return &tag;
+}
+
+//! The writer spins for the short reader sections before it yields the CPU
+constexpr uint32_t kWriterSpinIter = 64;
+
+}  // namespace
+
+// ================================================================================================
+RwMonitor::RwMonitor() : writerLock_(true) {}
+
+// ================================================================================================
+uint32_t RwMonitor::readerSlot() {
+#if defined(_WIN32)
+  int cpu = static_cast<int>(GetCurrentProcessorNumber());
+#else
+  int cpu = sched_getcpu();
+#endif
+  if (cpu < 0) {
+    // Spread the threads by the tag address if the CPU can't be queried
+    cpu = static_cast<int>(reinterpret_cast<uintptr_t>(ThreadTag()) >> 6);
+  }
+  return static_cast<uint32_t>(cpu) % kReaderSlots;
+}
+
+// ================================================================================================
+uint32_t RwMonitor::lockShared() {
+  if (owner_.load(std::memory_order_relaxed) == ThreadTag()) {
+    // The writer reads under its exclusive lock
+    return kOwnerSlot;
+  }
+  // The slot may change with the thread migration, unlockShared() gets the counted one
+  const uint32_t slot = readerSlot();
+  std::atomic_int& readers = slots_[slot].readers_;
+  while (true) {
+    // The increment and the flag check pair with the flag store and the slot scan of lock(),
+    // hence either the reader sees the writer or the writer sees the reader
+    readers.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_.load(std::memory_order_seq_cst)) {
+      return slot;
+    }
+    readers.fetch_sub(1, std::memory_order_release);
+    // Park until the writer is done
+    writerLock_.lock();
+    writerLock_.unlock();
+  }
+}
+
+// ================================================================================================
+void RwMonitor::unlockShared(uint32_t slot) {
+  if (slot != kOwnerSlot) {
+    slots_[slot].readers_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+// ================================================================================================
+void RwMonitor::lock() {
+  const void* tag = ThreadTag();
+  if (owner_.load(std::memory_order_relaxed) == tag) {
+    ++depth_;
+    return;
+  }
+  writerLock_.lock();
+  owner_.store(tag, std::memory_order_relaxed);
+  depth_ = 1;
+  writer_.store(true, std::memory_order_seq_cst);
+  for (auto& it : slots_) {
+    for (uint32_t spin = 0; it.readers_.load(std::memory_order_acquire) != 0; ++spin) {
+      if (spin < kWriterSpinIter) {
+        Os::spinPause();
+      } else {
+        Os::yield();
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void RwMonitor::unlock() {
+  if (--depth_ != 0) {
+    return;
+  }
+  owner_.store(nullptr, std::memory_order_relaxed);
+  writer_.store(false, std::memory_order_release);
+  writerLock_.unlock();
+}
+
+}  // namespace amd
@@ -0,0 +1,104 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef RWMONITOR_HPP_
+#define RWMONITOR_HPP_
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+
+#include <atomic>
+
+namespace amd {
+
+/*! \addtogroup Threads
+ *  @{
+ *
+ *  \addtogroup Synchronization
+ *  @{
+ */
+
+//! Reader-writer lock for the read-mostly structures. The readers count themselves in the
+//! per-CPU slots on separate cache lines, hence the concurrent lookups don't bounce a single
+//! lock word between the cores. A writer raises the writer flag, which sends the new readers
+//! to wait on the writer lock, and waits until the reader slots drain. The writer side is
+//! recursive and the owner may take the shared side as well, the reverse order deadlocks.
+class RwMonitor : public HeapObject {
+ public:
+  static constexpr uint32_t kReaderSlots = 64;
+
+  RwMonitor();
+
+  //! Takes the shared side, returns the slot for unlockShared()
+  uint32_t lockShared();
+  //! Releases the shared side taken in the slot
+  void unlockShared(uint32_t slot);
+
+  //! Takes the exclusive side
+  void lock();
+  //! Releases the exclusive side
+  void unlock();
+
+ private:
+  //! The slot of the writer thread, which reads under its own exclusive lock
+  static constexpr uint32_t kOwnerSlot = kReaderSlots;
+
+  struct alignas(64) ReaderSlot {
+    std::atomic_int readers_{0};
+  };
+
+  ReaderSlot slots_[kReaderSlots];     //!< The reader counts
+  std::atomic_bool writer_{false};     //!< A writer holds or waits for the exclusive side
+  std::atomic<const void*> owner_{nullptr};  //!< The writer thread tag
+  uint32_t depth_ = 0;                 //!< The recursion depth of the writer
+  Monitor writerLock_;                 //!< Serializes the writers, the readers park on it
+
+  //! Returns the reader slot of the current CPU
+  static uint32_t readerSlot();
+};
+
+//! Holds the shared side of RwMonitor for the scope lifetime
+class ScopedSharedLock : StackObject {
+ public:
+  ScopedSharedLock(RwMonitor& lock) : lock_(lock), slot_(lock.lockShared()) {}
+  ~ScopedSharedLock() { lock_.unlockShared(slot_); }
+
+ private:
+  RwMonitor& lock_;
+  uint32_t slot_;
+};
+
+//! Holds the exclusive side of RwMonitor for the scope lifetime
+class ScopedExclusiveLock : StackObject {
+ public:
+  ScopedExclusiveLock(RwMonitor& lock) : lock_(lock) { lock_.lock(); }
+  ~ScopedExclusiveLock() { lock_.unlock(); }
+
+ private:
+  RwMonitor& lock_;
+};
+
+/*! @}
+ *  @}
+ */
+
+}  // namespace amd
+
+#endif /*RWMONITOR_HPP_*/
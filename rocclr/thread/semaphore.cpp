@@ -24,21 +24,54 @@
 #if defined(_WIN32) || defined(__CYGWIN__)
 #include <windows.h>
 #else  // !_WIN32
-#include <semaphore.h>
 #include <errno.h>
 #include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif  // !_WIN32
 
 namespace amd {
 
+#ifndef _WIN32
+//! Parks the thread while the futex word holds the value, the timeout is relative.
+//! Returns false on the timeout
+static bool FutexWait(std::atomic_int* word, int value, const struct timespec* timeout) {
+  if (syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAIT_PRIVATE, value, timeout,
+              nullptr, 0) != 0) {
+    if (errno == ETIMEDOUT) {
+      return false;
+    } else if (errno != EAGAIN && errno != EINTR) {
+      fatal("futex wait failed");
+    }
+  }
+  return true;
+}
+
+//! Wakes a thread parked on the futex word
+static void FutexWake(std::atomic_int* word) {
+  syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+//! Takes a pending wakeup, returns false if there is none
+static bool TakeWakeup(std::atomic_int* wakeups) {
+  int pending = wakeups->load(std::memory_order_acquire);
+  while (pending > 0) {
+    if (wakeups->compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif  // !_WIN32
+
 Semaphore::Semaphore() : state_(0) {
 #ifdef _WIN32
   handle_ = static_cast<void*>(CreateSemaphore(NULL, 0, LONG_MAX, NULL));
   assert(handle_ != NULL && "CreateSemaphore failed");
 #else   // !_WIN32
-  if (sem_init(&sem_, 0, 0) != 0) {
-    fatal("sem_init() failed");
-  }
+  wakeups_.store(0, std::memory_order_relaxed);
 #endif  // !_WIN32
 }
 
@@ -47,11 +80,7 @@ Semaphore::~Semaphore() {
   if (!CloseHandle(static_cast<HANDLE>(handle_))) {
     fatal("CloseHandle() failed");
   }
-#else   // !_WIN32
-  if (sem_destroy(&sem_) != 0) {
-    fatal("sem_destroy() failed");
-  }
-#endif  // !WIN32
+#endif  // WIN32
 }
 
 void Semaphore::post() {
@@ -76,9 +105,8 @@ void Semaphore::post() {
 #ifdef _WIN32
     ReleaseSemaphore(static_cast<HANDLE>(handle_), 1, NULL);
 #else   // !_WIN32
-    if (0 != sem_post(&sem_)) {
-      fatal("sem_post() failed");
-    }
+    wakeups_.fetch_add(1, std::memory_order_release);
+    FutexWake(&wakeups_);
 #endif  // !_WIN32
   }
 }
@@ -93,10 +121,8 @@ void Semaphore::wait() {
     fatal("WaitForSingleObject failed");
   }
 #else   // !_WIN32
-  while (0 != sem_wait(&sem_)) {
-    if (EINTR != errno) {
-      fatal("sem_wait() failed");
-    }
+  while (!TakeWakeup(&wakeups_)) {
+    FutexWait(&wakeups_, 0, nullptr);
   }
 #endif  // !_WIN32
 }
@@ -112,26 +138,14 @@ void Semaphore::timedWait(int millis) {
     fatal("WaitForSingleObject failed");
   }
 #else   // !_WIN32
+  // The futex timeout is relative and on the monotonic clock, hence the wall clock changes
+  // don't shorten or extend the wait. The interrupted waits resume with the full timeout
   struct timespec ts;
-
-  if (clock_gettime(CLOCK_REALTIME, &ts) == -1) {
-    fatal("clock_gettime() failed");
-  }
-
-  ts.tv_sec += millis / 1000;
-  ts.tv_nsec += ((long)millis % 1000) * 1000000;
-
-  if (ts.tv_nsec >= 1000000000) {
-    ts.tv_sec += 1;
-    ts.tv_nsec -= 1000000000;
-  }
-
-  int status;
-  while ((status = sem_timedwait(&sem_, &ts)) != 0) {
-    if (ETIMEDOUT == errno) {
+  ts.tv_sec = millis / 1000;
+  ts.tv_nsec = (static_cast<long>(millis) % 1000) * 1000000;
+  while (!TakeWakeup(&wakeups_)) {
+    if (!FutexWait(&wakeups_, 0, &ts)) {
       break;
-    } else if (EINTR != errno) {
-      fatal("sem_wait() failed");
     }
   }
 #endif  // !_WIN32
@@ -25,9 +25,6 @@
 #include "utils/util.hpp"
 
 #include <atomic>
-#if defined(__linux__)
-#include <semaphore.h>
-#endif /*linux*/
 
 
 namespace amd {
@@ -49,7 +46,8 @@ class alignas(64) Semaphore : public HeapObject {
 #ifdef _WIN32
   void* handle_;  //!< The semaphore object's handle.
 #else  // !_WIN32
-  sem_t sem_;  //!< The semaphore object's identifier.
+  //! The pending wakeups of the parked threads, the threads park on it as a futex word
+  std::atomic_int wakeups_;
 #endif /*!_WIN32*/
 
 public:
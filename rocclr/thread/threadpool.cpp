@@ -0,0 +1,196 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "thread/threadpool.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+#include <algorithm>
+
+namespace amd {
+
+namespace {
+
+//! The pool and the deque of the calling worker thread
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local uint32_t currentQueue = 0;
+
+//! The shared pool doesn't take all CPUs of the large systems by default
+constexpr uint32_t kMaxDefaultPoolSize = 16;
+
+}  // namespace
+
+// ================================================================================================
+ThreadPool::ThreadPool(const char* name, uint32_t num_threads, int numa_node)
+    : queues_(new WorkQueue[std::max(num_threads, 1u)]),
+      numa_node_(numa_node),
+      next_(0),
+      pending_(0),
+      sleepers_(0),
+      stop_(false),
+      sleep_lock_(true) {
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    Worker* worker = new Worker(name, this, i);
+    if ((worker == nullptr) || (worker->state() < Thread::INITIALIZED)) {
+      LogPrintfError("Couldn't create the %s, the pool runs %u workers", name, i);
+      delete worker;
+      break;
+    }
+    workers_.push_back(worker);
+  }
+  for (auto worker : workers_) {
+    worker->start();
+  }
+}
+
+// ================================================================================================
+ThreadPool::~ThreadPool() {
+  {
+    ScopedLock l(sleep_lock_);
+    stop_ = true;
+    sleep_lock_.notifyAll();
+  }
+  for (auto worker : workers_) {
+    while (worker->state() < Thread::FINISHED && Os::isThreadAlive(*worker)) {
+      Os::yield();
+    }
+    delete worker;
+  }
+}
+
+// ================================================================================================
+ThreadPool& ThreadPool::shared() {
+  static ThreadPool* pool = []() {
+    uint32_t size = ROC_THREAD_POOL_SIZE;
+    if (size == 0) {
+      size = std::min(static_cast<uint32_t>(std::max(Os::processorCount(), 1)),
+                      kMaxDefaultPoolSize);
+    }
+    return new ThreadPool("Runtime Pool Thread", size);
+  }();
+  return *pool;
+}
+
+// ================================================================================================
+void ThreadPool::enqueue(Task&& task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  // The workers keep their tasks local, the other threads spread the tasks over the deques
+  const uint32_t index = (currentPool == this) ? currentQueue : (next_++ % size());
+  // Count the task first, so a worker which takes it never sees the count below zero
+  pending_.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> guard(queues_[index].lock_);
+    queues_[index].tasks_.push_back(std::move(task));
+  }
+  if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+    ScopedLock l(sleep_lock_);
+    sleep_lock_.notify();
+  }
+}
+
+// ================================================================================================
+bool ThreadPool::runOne() {
+  if (pending_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  const uint32_t count = size();
+  const uint32_t self = (currentPool == this) ? currentQueue : (next_.load() % count);
+  Task task;
+  for (uint32_t i = 0; (i < count) && !task; ++i) {
+    const uint32_t index = (self + i) % count;
+    WorkQueue& queue = queues_[index];
+    std::lock_guard<std::mutex> guard(queue.lock_);
+    if (queue.tasks_.empty()) {
+      continue;
+    }
+    // The own deque runs the newest task, which has the hot data, the thieves take the oldest
+    if ((index == self) && (currentPool == this)) {
+      task = std::move(queue.tasks_.back());
+      queue.tasks_.pop_back();
+    } else {
+      task = std::move(queue.tasks_.front());
+      queue.tasks_.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+  task();
+  return true;
+}
+
+// ================================================================================================
+void ThreadPool::loop(uint32_t index) {
+  currentPool = this;
+  currentQueue = index;
+  if (numa_node_ >= 0) {
+    Os::setCurrentThreadNumaNode(static_cast<uint32_t>(numa_node_));
+  }
+  while (true) {
+    if (runOne()) {
+      continue;
+    }
+    ScopedLock l(sleep_lock_);
+    // The enqueue counts the task before it checks the sleepers, hence no wakeup is lost
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    while ((pending_.load(std::memory_order_seq_cst) == 0) && !stop_) {
+      sleep_lock_.wait();
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    if (stop_ && (pending_.load(std::memory_order_relaxed) == 0)) {
+      break;
+    }
+  }
+}
+
+// ================================================================================================
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func,
+                             uint32_t max_threads) {
+  if (count == 0) {
+    return;
+  }
+  uint32_t threads = (max_threads == 0) ? (size() + 1) : std::min(max_threads, size() + 1);
+  threads = static_cast<uint32_t>(std::min<size_t>(threads, count));
+
+  // The helpers and the caller take the indices from the shared counter
+  std::atomic<size_t> next{0};
+  auto body = [&next, count, &func]() {
+    for (size_t i = next++; i < count; i = next++) {
+      func(i);
+    }
+  };
+  std::vector<std::future<void>> helpers;
+  helpers.reserve(threads - 1);
+  for (uint32_t i = 1; i < threads; ++i) {
+    helpers.push_back(submit(body));
+  }
+  body();
+  // The helpers reference the counter, hence wait for all of them, including the late ones
+  for (auto& it : helpers) {
+    wait(it);
+  }
+}
+
+}  // namespace amd
@@ -0,0 +1,147 @@
+/* Copyright (c) 2026 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "thread/thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace amd {
+
+/*! \addtogroup Threads
+ *  @{
+ */
+
+//! Work-stealing pool of runtime threads. Every worker owns a task deque, it runs its own tasks
+//! in the LIFO order and steals the oldest tasks of the other workers when it runs out of work.
+//! The waits on the pool futures run the queued tasks meanwhile, hence a task can wait for the
+//! tasks it submitted without blocking a worker.
+class ThreadPool : public HeapObject {
+ public:
+  typedef std::function<void()> Task;
+
+  //! Starts the workers, a valid \a numa_node binds them to the CPUs of the node
+  ThreadPool(const char* name, uint32_t num_threads, int numa_node = -1);
+
+  //! Finishes all queued tasks and stops the workers
+  ~ThreadPool();
+
+  //! Returns the pool shared by the runtime subsystems, ROC_THREAD_POOL_SIZE sets its size.
+  //! The pool lives until the process exits.
+  static ThreadPool& shared();
+
+  //! Returns the number of the worker threads
+  uint32_t size() const { return static_cast<uint32_t>(workers_.size()); }
+
+  //! Queues a task, runs it in place if the pool has no workers
+  void enqueue(Task&& task);
+
+  //! Queues a function and returns the future of its result
+  template <typename F> auto submit(F&& func) -> std::future<decltype(func())> {
+    typedef decltype(func()) Result;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+    std::future<Result> result = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return result;
+  }
+
+  //! Queues a continuation, which runs with the ready \a prior future
+  template <typename T, typename F>
+  auto then(std::shared_future<T> prior, F&& func) -> std::future<decltype(func(prior))> {
+    return submit([this, prior, func = std::forward<F>(func)]() mutable {
+      wait(prior);
+      return func(prior);
+    });
+  }
+
+  //! Waits for the future and runs the queued tasks meanwhile
+  template <typename Future> void wait(const Future& future) {
+    constexpr auto kPoll = std::chrono::microseconds(0);
+    constexpr auto kSleep = std::chrono::microseconds(100);
+    while (future.wait_for(kPoll) != std::future_status::ready) {
+      if (!runOne()) {
+        future.wait_for(kSleep);
+      }
+    }
+  }
+
+  //! Runs func(i) for all i in [0, count) on up to \a max_threads threads, including the
+  //! calling one, and returns once all calls are done. 0 uses all workers.
+  void parallelFor(size_t count, const std::function<void(size_t)>& func,
+                   uint32_t max_threads = 0);
+
+ private:
+  //! Disable copy constructor
+  ThreadPool(const ThreadPool&);
+
+  //! Disable assignment operator
+  ThreadPool& operator=(const ThreadPool&);
+
+  class Worker : public Thread {
+   public:
+    Worker(const char* name, ThreadPool* pool, uint32_t index)
+        : Thread(name), pool_(pool), index_(index) {}
+
+    //! The worker thread entry point
+    void run(void* data) { pool_->loop(index_); }
+
+   private:
+    ThreadPool* pool_;  //!< The pool of the worker
+    uint32_t index_;    //!< The task deque of the worker
+  };
+
+  struct alignas(64) WorkQueue {
+    std::mutex lock_;          //!< Taken by the owner and the thieves, held only for the access
+    std::deque<Task> tasks_;   //!< The owner pushes and pops at the back, thieves take the front
+  };
+
+  //! Runs one queued task, own tasks first, returns false if all deques are empty
+  bool runOne();
+
+  //! Processes the tasks until the pool stops
+  void loop(uint32_t index);
+
+  std::unique_ptr<WorkQueue[]> queues_;  //!< Task deques, one per worker
+  std::vector<Worker*> workers_;         //!< Worker threads
+  int numa_node_;                        //!< The NUMA node of the workers, -1 if unbound
+  std::atomic<uint32_t> next_;           //!< Round robin deque for the external submissions
+  std::atomic<size_t> pending_;          //!< Queued tasks, which no thread took yet
+  std::atomic<uint32_t> sleepers_;       //!< Workers waiting for tasks
+  bool stop_;                            //!< The workers exit once the deques are empty
+  Monitor sleep_lock_;                   //!< The idle workers wait on it
+};
+
+/*! @}
+ */
+
+}  // namespace amd
+
+#endif /*THREADPOOL_HPP_*/
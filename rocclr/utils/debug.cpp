@@ -33,6 +33,12 @@
 #include <sstream>
 #include <iomanip>
 #include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <vector>
 #ifdef _WIN32
 #include <windows.h>
 #endif  // _WIN32
@@ -92,9 +98,227 @@ void log_timestamped(LogLevel level, const char* file, int line, const char* mes
   fflush(outFile);
 }
 
+namespace {
+//! Log record, which precedes the formatted message in the ring
+struct LogRecord {
+  uint64_t timeUs_;      //!< Time of the message in microseconds
+  uint64_t durationUs_;  //!< Duration of the timed message, kNoDuration otherwise
+  const char* file_;     //!< Source file of the message
+  int32_t line_;         //!< Source line of the message
+  int32_t level_;        //!< Log level, kPadding for the skipped space at the end of the ring
+  std::thread::id tid_;  //!< Thread which logged the message
+  uint32_t size_;        //!< Size of the record with the message, aligned to the record alignment
+};
+
+constexpr uint64_t kNoDuration = std::numeric_limits<uint64_t>::max();
+constexpr int32_t kPadding = -1;
+constexpr size_t kMaxMessage = 4096;
+
+//! Single producer/single consumer ring of the log records. The owner thread is the producer.
+//! The consumer always holds the writer lock, hence any thread can drain the ring.
+struct LogRing {
+  static constexpr size_t kSize = 64 * Ki;
+
+  std::atomic<uint64_t> head_{0};        //!< Write position, updated by the producer only
+  std::atomic<uint64_t> tail_{0};        //!< Read position, updated by the consumer only
+  std::atomic<bool> orphaned_{false};    //!< The owner thread has exited
+  alignas(LogRecord) char data_[kSize];  //!< Records storage
+
+  //! Places a record into the ring, returns false if the ring doesn't have enough space
+  bool push(const LogRecord& record, const char* message, size_t length) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t free = kSize - (head - tail_.load(std::memory_order_acquire));
+    size_t pos = head % kSize;
+    // The records are contiguous, hence the space at the end of the ring may be skipped
+    size_t skip = ((kSize - pos) < record.size_) ? (kSize - pos) : 0;
+    if (free < (skip + record.size_)) {
+      return false;
+    }
+    if (skip >= sizeof(LogRecord)) {
+      LogRecord* padding = reinterpret_cast<LogRecord*>(&data_[pos]);
+      padding->level_ = kPadding;
+      padding->size_ = static_cast<uint32_t>(skip);
+    }
+    pos = (head + skip) % kSize;
+    *reinterpret_cast<LogRecord*>(&data_[pos]) = record;
+    memcpy(&data_[pos + sizeof(LogRecord)], message, length);
+    data_[pos + sizeof(LogRecord) + length] = '\0';
+    head_.store(head + skip + record.size_, std::memory_order_release);
+    return true;
+  }
+};
+
+//! Asynchronous log writer. The callers format the messages into their own rings and
+//! the writer thread drains all rings into the log output in batches with a single flush.
+class AsyncLogger {
+ public:
+  static AsyncLogger* get() {
+    // The logger is never destroyed, since the detached writer and the exiting threads
+    // may still use it during the static destruction
+    static AsyncLogger* logger = new AsyncLogger();
+    return logger;
+  }
+
+  //! Queues a message from the current thread
+  void log(const LogRecord& record, const char* message, size_t length) {
+    LogRing* ring = threadRing();
+    if (!ring->push(record, message, length)) {
+      // The ring is full. Drain all rings on the caller thread to keep the order of the output
+      std::lock_guard<std::mutex> lock(writerLock_);
+      drainAll();
+      ring->push(record, message, length);
+    }
+  }
+
+  //! Writes all queued messages into the log output
+  void flush() {
+    std::lock_guard<std::mutex> lock(writerLock_);
+    drainAll();
+  }
+
+ private:
+  //! Releases the ring of the exited thread
+  struct RingHolder {
+    LogRing* ring_ = nullptr;
+    ~RingHolder() {
+      if (ring_ != nullptr) {
+        ring_->orphaned_.store(true, std::memory_order_release);
+      }
+    }
+  };
+
+  AsyncLogger() {
+    std::thread writer([this]() { run(); });
+    writer.detach();
+    atexit([]() { AsyncLogger::get()->flush(); });
+  }
+
+  LogRing* threadRing() {
+    static thread_local RingHolder holder;
+    if (holder.ring_ == nullptr) {
+      holder.ring_ = new LogRing();
+      std::lock_guard<std::mutex> lock(ringsLock_);
+      rings_.push_back(holder.ring_);
+    }
+    return holder.ring_;
+  }
+
+  //! Writer thread loop
+  void run() {
+    while (true) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      flush();
+    }
+  }
+
+  //! Drains all rings, the caller must hold the writer lock
+  void drainAll() {
+    std::lock_guard<std::mutex> lock(ringsLock_);
+    bool written = false;
+    for (auto it = rings_.begin(); it != rings_.end();) {
+      LogRing* ring = *it;
+      // Check the owner before the drain, so all messages of the exited thread are visible
+      bool orphaned = ring->orphaned_.load(std::memory_order_acquire);
+      written |= drain(ring, written);
+      if (orphaned) {
+        delete ring;
+        it = rings_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (written) {
+      fflush(outFile);
+    }
+  }
+
+  //! Writes the records of a single ring, returns true if any record was written
+  bool drain(LogRing* ring, bool sizeChecked) {
+    uint64_t tail = ring->tail_.load(std::memory_order_relaxed);
+    uint64_t head = ring->head_.load(std::memory_order_acquire);
+    if (tail == head) {
+      return false;
+    }
+    if (!sizeChecked) {
+      truncate_log_file();
+    }
+    while (tail != head) {
+      size_t pos = tail % LogRing::kSize;
+      if ((LogRing::kSize - pos) < sizeof(LogRecord)) {
+        tail += LogRing::kSize - pos;
+        continue;
+      }
+      const LogRecord* record = reinterpret_cast<const LogRecord*>(&ring->data_[pos]);
+      if (record->level_ != kPadding) {
+        write(*record, &ring->data_[pos + sizeof(LogRecord)]);
+      }
+      tail += record->size_;
+      ring->tail_.store(tail, std::memory_order_release);
+    }
+    return true;
+  }
+
+  void write(const LogRecord& record, const char* message) {
+    std::stringstream pidtid;
+    if (AMD_LOG_LEVEL >= 4) {
+      pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
+      pidtid << std::hex << std::setw(5) << record.tid_ << "]";
+    }
+    if (record.durationUs_ == kNoDuration) {
+      fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s\n", record.level_,
+              record.file_, record.line_, record.timeUs_, pidtid.str().c_str(), message);
+    } else {
+      fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s: duration: %" PRIu64 " us\n",
+              record.level_, record.file_, record.line_, record.timeUs_, pidtid.str().c_str(),
+              message, record.durationUs_);
+    }
+  }
+
+  std::mutex writerLock_;          //!< Serializes the consumers of the rings
+  std::mutex ringsLock_;           //!< Protects the list of the rings
+  std::vector<LogRing*> rings_;    //!< Rings of all threads, which logged a message
+};
+
+// ================================================================================================
+void log_async(LogLevel level, const char* file, int line, uint64_t timeUs, uint64_t durationUs,
+               const char* format, va_list ap) {
+  char message[kMaxMessage];
+  int length = vsnprintf(message, sizeof(message), format, ap);
+  if (length < 0) {
+    length = 0;
+  }
+  length = std::min(length, static_cast<int>(sizeof(message) - 1));
+
+  LogRecord record;
+  record.timeUs_ = timeUs;
+  record.durationUs_ = durationUs;
+  record.file_ = file;
+  record.line_ = line;
+  record.level_ = level;
+  record.tid_ = std::this_thread::get_id();
+  size_t size = sizeof(LogRecord) + length + 1;
+  record.size_ = static_cast<uint32_t>((size + alignof(LogRecord) - 1) &
+                                       ~(alignof(LogRecord) - 1));
+  AsyncLogger::get()->log(record, message, length);
+}
+}  // namespace
+
+// ================================================================================================
+void log_flush() {
+  if (AMD_LOG_ASYNC) {
+    AsyncLogger::get()->flush();
+  }
+}
+
 // ================================================================================================
 void log_printf(LogLevel level, const char* file, int line, const char* format, ...) {
   va_list ap;
+  if (AMD_LOG_ASYNC) {
+    va_start(ap, format);
+    log_async(level, file, line, Os::timeNanos() / 1000ULL, kNoDuration, format, ap);
+    va_end(ap);
+    return;
+  }
   std::stringstream pidtid;
   if (AMD_LOG_LEVEL >= 4) {
     pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
@@ -119,6 +343,17 @@ void log_printf(LogLevel level, const char* file, int line, const char* format,
 void log_printf(LogLevel level, const char* file, int line, uint64_t* start,
                 const char* format, ...) {
   va_list ap;
+  if (AMD_LOG_ASYNC) {
+    uint64_t timeUs = Os::timeNanos() / 1000ULL;
+    bool timed = (start != nullptr) && (*start != 0);
+    va_start(ap, format);
+    log_async(level, file, line, timeUs, timed ? (timeUs - *start) : kNoDuration, format, ap);
+    va_end(ap);
+    if (start != nullptr && *start == 0) {
+      *start = timeUs;
+    }
+    return;
+  }
   std::stringstream pidtid;
   if (AMD_LOG_LEVEL >= 4) {
     pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
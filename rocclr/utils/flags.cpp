@@ -21,6 +21,7 @@
 #include "top.hpp"
 #include "utils/flags.hpp"
 #include "os/os.hpp"
+#include "utils/debug.hpp"
 
 #include <unordered_map>
 #include <string>
@@ -156,9 +157,56 @@ bool Flag::init() {
     }
   }
 
+  // The flags are parsed once, print the values taken from the environment
+  for (size_t i = 0; i < numFlags_; ++i) {
+    const Flag& flag = flags_[i];
+    if (flag.value_ != NULL && !flag.isDefault_) {
+      flag.print();
+    }
+  }
+
   return true;
 }
 
+bool Flag::setIfDefault(const char* name, const char* value) {
+  for (size_t i = 0; i < numFlags_; ++i) {
+    Flag& flag = flags_[i];
+    if (strcmp(name, flag.name_) == 0) {
+      if (flag.value_ == NULL || !flag.isDefault_) {
+        return false;
+      }
+      flag.setValue(value);
+      flag.print();
+      return true;
+    }
+  }
+  return false;
+}
+
+void Flag::print() const {
+  switch (type_) {
+    case Tbool:
+      ClPrint(LOG_INFO, LOG_INIT, "Flag %s = %s", name_, *(bool*)value_ ? "true" : "false");
+      break;
+    case Tint:
+      ClPrint(LOG_INFO, LOG_INIT, "Flag %s = %d", name_, *(int*)value_);
+      break;
+    case Tuint:
+      ClPrint(LOG_INFO, LOG_INIT, "Flag %s = %u", name_, *(uint*)value_);
+      break;
+    case Tsize_t:
+      ClPrint(LOG_INFO, LOG_INIT, "Flag %s = %zu", name_, *(size_t*)value_);
+      break;
+    case Tcstring: {
+      const char* value = *(const char**)value_;
+      ClPrint(LOG_INFO, LOG_INIT, "Flag %s = \"%s\"", name_, (value != NULL) ? value : "");
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 bool Flag::setValue(const char* value) {
   if (value_ == NULL) {
     return false;  // flag is constant.
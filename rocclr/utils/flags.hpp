@@ -32,12 +32,17 @@ release(cstring, AMD_LOG_LEVEL_FILE, "",                                      \
         "Set output file for AMD_LOG_LEVEL, Default is stderr")               \
 release(size_t, AMD_LOG_LEVEL_SIZE, 2048,                                     \
         "The max size of AMD_LOG generated in MB if printed to a file")       \
+release(bool, AMD_LOG_ASYNC, false,                                           \
+        "Write the log messages from a background thread in batches")         \
 debug(uint, DEBUG_GPU_FLAGS, 0,                                               \
         "The debug options for GPU device")                                   \
 release(size_t, CQ_THREAD_STACK_SIZE, 256*Ki, /* @todo: that much! */         \
         "The default command queue thread stack size")                        \
 release(int, GPU_MAX_WORKGROUP_SIZE, 0,                                       \
         "Maximum number of workitems in a workgroup for GPU, 0 -use default") \
+release(bool, GPU_OCCUPANCY_WORKGROUP_SIZE, true,                             \
+        "Pick the default workgroup size of the kernels from the register "   \
+        "and LDS occupancy")                                                  \
 debug(bool, CPU_MEMORY_GUARD_PAGES, false,                                    \
         "Use guard pages for CPU memory")                                     \
 debug(size_t, CPU_MEMORY_GUARD_PAGE_SIZE, 64,                                 \
@@ -62,6 +67,16 @@ release(uint, GPU_STAGING_BUFFER_SIZE, 4,                                     \
         "Size of the GPU staging buffer in MiB")                              \
 release(bool, GPU_DUMP_BLIT_KERNELS, false,                                   \
         "Dump the kernels for blit manager")                                  \
+release(cstring, GPU_BLIT_CACHE_PATH, "",                                     \
+        "Directory of the disk cache for the compiled blit kernels, shared "  \
+        "between the processes. Empty disables the cache")                    \
+release(cstring, GPU_KERNEL_METADATA_CACHE_PATH, "",                          \
+        "Directory of the disk cache for the parsed kernel metadata of the "  \
+        "code objects, shared between the processes. Empty disables the "     \
+        "cache")                                                              \
+release(cstring, GPU_XFER_TUNING, "",                                         \
+        "Per-ASIC transfer tuning table or a file with it. The entries are "  \
+        "like gfx942:pinned=32768,pinned_min=1024,staged=4096,blit=16 in KiB")\
 release(uint, GPU_BLIT_ENGINE_TYPE, 0x0,                                      \
         "Blit engine type: 0 - Default, 1 - Host, 2 - CAL, 3 - Kernel")       \
 release(bool, GPU_FLUSH_ON_EXECUTION, false,                                  \
@@ -72,6 +87,16 @@ release(cstring, AMD_OCL_BUILD_OPTIONS, 0,                                    \
         "Set clBuildProgram() and clCompileProgram()'s options (override)")   \
 release(cstring, AMD_OCL_BUILD_OPTIONS_APPEND, 0,                             \
         "Append clBuildProgram() and clCompileProgram()'s options")           \
+release(cstring, AMD_OCL_PROGRAM_CACHE_PATH, "",                              \
+        "Directory of the disk cache for the code objects of the programs "   \
+        "built from OpenCL C source, shared between the processes. The "      \
+        "headers from the file system aren't a part of the cache key. "       \
+        "Empty disables the cache")                                           \
+release(uint, AMD_OCL_BUILD_THREADS, 4,                                       \
+        "Max number of threads, which build a program for the devices of a "  \
+        "context in parallel, and of the workers, which run the builds with " \
+        "a callback asynchronously. 0 builds synchronously, one device "      \
+        "after another")                                                      \
 release(cstring, AMD_OCL_LINK_OPTIONS, 0,                                     \
         "Set clLinkProgram()'s options (override)")                           \
 release(cstring, AMD_OCL_LINK_OPTIONS_APPEND, 0,                              \
@@ -86,8 +111,8 @@ release(size_t, GPU_RESOURCE_CACHE_SIZE, 64,                                  \
         "The resource cache size in MB")                                      \
 release(size_t, GPU_MAX_SUBALLOC_SIZE, 4096,                                  \
         "The maximum size accepted for suballocations in KB")                 \
-release(size_t, GPU_NUM_MEM_DEPENDENCY, 256,                                  \
-        "Number of memory objects for dependency tracking")                   \
+release(size_t, GPU_NUM_MEM_DEPENDENCY, 4096,                                 \
+        "Number of memory ranges for dependency tracking")                    \
 release(size_t, GPU_XFER_BUFFER_SIZE, 0,                                      \
         "Transfer buffer size for image copy optimization in KB")             \
 release(bool, GPU_IMAGE_DMA, true,                                            \
@@ -96,6 +121,18 @@ release(uint, GPU_SINGLE_ALLOC_PERCENT, 85,                                   \
         "Maximum size of a single allocation as percentage of total")         \
 release(uint, GPU_NUM_COMPUTE_RINGS, 2,                                       \
         "GPU number of compute rings. 0 - disabled, 1 , 2,.. - the number of compute rings") \
+release(bool, AMD_OCL_GL_FENCE_SYNC, true,                                    \
+        "Acquire of GL objects waits for a GL fence on the queue thread, "    \
+        "instead of glFinish on the application thread")                      \
+release(uint, AMD_OCL_SVM_POOL_SLAB_SIZE, 2048,                               \
+        "Slab size in KB for clSVMAlloc sub-allocations. Allocations up to "  \
+        "1/8 of the slab are carved from slabs, 0 disables sub-allocation")   \
+release(bool, ROC_XFER_AUTOTUNE, false,                                       \
+        "Measure the SDMA and the blit kernel paths of the staged reads per " \
+        "size class and use the faster one")                                  \
+release(bool, ROC_BLIT_IMAGE_RAW, true,                                       \
+        "Copy and fill the images with the linear or the same tiled layout "  \
+        "through the buffer blit kernels")                                    \
 release(bool, AMD_OCL_WAIT_COMMAND, false,                                    \
         "1 = Enable a wait for every submitted command")                      \
 release(uint, GPU_PRINT_CHILD_KERNEL, 0,                                      \
@@ -110,6 +147,8 @@ release(bool, HSA_LOCAL_MEMORY_ENABLE, true,                                  \
         "Enable HSA device local memory usage")                               \
 release(uint, HSA_KERNARG_POOL_SIZE, 1024 * 1024,                             \
         "Kernarg pool size")                                                  \
+release(uint, HSA_KERNARG_POOL_MAX_SIZE, 16 * 1024 * 1024,                    \
+        "Max kernarg pool size, the pool grows up to when chunks are busy")   \
 release(bool, GPU_MIPMAP, true,                                               \
         "Enables GPU mipmap extension")                                       \
 release(uint, GPU_ENABLE_PAL, 2,                                              \
@@ -125,7 +164,10 @@ release(uint, GPU_WAVES_PER_SIMD, 0,                                          \
 release(bool, OCL_STUB_PROGRAMS, false,                                       \
         "1 = Enables OCL programs stubing")                                   \
 release(bool, GPU_ANALYZE_HANG, false,                                        \
-        "1 = Enables GPU hang analysis")                                      \
+        "1 = Enables GPU hang analysis. The flight recorders are dumped on "  \
+        "SIGUSR1 and on the waits longer than 10 seconds")                    \
+release(uint, ROC_FLIGHT_RECORDER_SIZE, 256,                                  \
+        "The number of the recent AQL packets, recorded per queue, 0 - off")  \
 release(uint, GPU_MAX_REMOTE_MEM_SIZE, 2,                                     \
         "Maximum size (in Ki) that allows device memory substitution with system") \
 release(bool, GPU_ADD_HBCC_SIZE, false,                                        \
@@ -134,6 +176,10 @@ release(bool, PAL_DISABLE_SDMA, false,                                        \
         "1 = Disable SDMA for PAL")                                           \
 release(uint, PAL_RGP_DISP_COUNT, 10000,                                      \
         "The number of dispatches for RGP capture with SQTT")                 \
+release(uint, PAL_RGP_TIME_WINDOW, 0,                                         \
+        "The time in ms for RGP capture with SQTT, which ends at the earlier "\
+        "of the time and PAL_RGP_DISP_COUNT. Only the dispatch markers are "  \
+        "written. 0 = capture by the dispatch count")                         \
 release(uint, PAL_MALL_POLICY, 0,                                             \
         "Controls the behaviour of allocations with respect to the MALL"      \
         "0 = MALL policy is decided by KMD"                                   \
@@ -151,6 +197,9 @@ release(uint, GPU_MAX_COMMAND_BUFFERS, 8,                                     \
          "The maximum number of command buffers allocated per queue")         \
 release(uint, GPU_MAX_HW_QUEUES, 4,                                           \
          "The maximum number of HW queues allocated per device")              \
+release(bool, GPU_HW_QUEUE_LOAD_BALANCE, true,                                \
+         "Reuse the HW queue with the least outstanding packets, once the "   \
+         "device reached GPU_MAX_HW_QUEUES, instead of the least users")      \
 release(bool, GPU_IMAGE_BUFFER_WAR, true,                                     \
         "Enables image buffer workaround")                                    \
 release(cstring, HIP_VISIBLE_DEVICES, "",                                     \
@@ -173,8 +222,25 @@ release(uint, AMD_SERIALIZE_COPY, 0,                                          \
 release(uint, HIP_LAUNCH_BLOCKING, 0,                                         \
         "Serialize kernel enqueue 0x1 = Wait for completion after enqueue,"   \
         "same as AMD_SERIALIZE_KERNEL=2")                                     \
+release(uint, HIP_API_SAMPLE_RATE, 0,                                         \
+        "Records a random 1-in-N subset of the HIP API calls and prints the " \
+        "estimated per API times at exit, 0 = disabled")                      \
+release(uint, HIP_API_SAMPLE_THRESHOLD, 0,                                    \
+        "Records all HIP API calls slower than N microseconds, 0 = disabled") \
+release(cstring, HIP_API_SAMPLE_FILE, "",                                     \
+        "CSV file for the calls, recorded by the HIP API sampling")           \
+release(uint, HIP_LAUNCH_LATENCY, 0,                                          \
+        "Per stream launch and per graph exec launch time histograms, "       \
+        "0x1 = collect, 0x2 = collect and print at the stream or the graph "  \
+        "exec destruction")                                                   \
 release(bool, PAL_ALWAYS_RESIDENT, false,                                     \
         "Force memory resources to become resident at allocation time")       \
+release(uint, PAL_MAX_COMMAND_BUFFERS_GROWTH, 32,                             \
+        "The number of command buffers a queue can grow to, when the GPU "    \
+        "falls behind the recording. 0 keeps GPU_MAX_COMMAND_BUFFERS")        \
+release(uint, PAL_MAX_RESIDENT_REFS, 2048,                                    \
+        "Memory references a queue keeps resident across the submissions, "   \
+        "before the stale references are evicted")                            \
 release(uint, HIP_HOST_COHERENT, 0,                                           \
         "Coherent memory in hipExtHostAlloc, 0x1 = memory is coherent with host"\
         "0x0 = memory is not coherent between host and GPU")                  \
@@ -190,6 +256,8 @@ release(size_t, GPU_FORCE_BLIT_COPY_SIZE, 16,                                 \
         "Use Blit until this size(in KB) for copies")                         \
 release(uint, ROC_ACTIVE_WAIT_TIMEOUT, 0,                                     \
         "Forces active wait of GPU interrup for the timeout(us)")             \
+release(bool, ROC_ADAPTIVE_WAIT, false,                                       \
+        "Adapts the active wait window to the history of the queue wait times")\
 release(bool, ROC_ENABLE_LARGE_BAR, true,                                     \
         "Enable Large Bar if supported by the device")                        \
 release(bool, ROC_CPU_WAIT_FOR_SIGNAL, true,                                  \
@@ -202,6 +270,54 @@ release(bool, HIP_MEM_POOL_SUPPORT, true,                                     \
         "Enables memory pool support in HIP")                                 \
 release(bool, HIP_MEM_POOL_USE_VM, true,                                      \
         "Enables memory pool support in HIP")                                 \
+release(uint, HIP_STREAM_POOL_SIZE, 4,                                        \
+        "Max number of destroyed streams per device, kept with their worker " \
+        "threads and HW queues for the next hipStreamCreate, 0 disables")     \
+release(uint, HIP_MEM_POOL_SLAB_SIZE, 2048,                                   \
+        "Slab size in KB for mempool sub-allocations. Allocations up to "     \
+        "1/8 of the slab are carved from slabs, 0 disables sub-allocation")   \
+release(bool, HIP_ALLOC_REPORT, false,                                        \
+        "Print the allocation trace and the memory pool report at exit")      \
+release(bool, HIP_MEM_POOL_COMPACT, false,                                    \
+        "Retry a failed pool allocation after the release of the free pool "  \
+        "memory without live pointers, so ROCr can join the pieces scattered "\
+        "over the VA space into one block")                                   \
+release(uint, HIP_MEM_POOL_RECLAIM_RATE, 0,                                   \
+        "Rate limit in MB/s for a background release of the freed mempool "   \
+        "memory, 0 releases the memory synchronously at sync points")         \
+release(bool, HIP_DEFERRED_FREE, false,                                       \
+        "hipFree skips the device sync and returns the memory to ROCr in "    \
+        "batches, after the GPU passes the last commands of the streams")     \
+release(bool, HIP_FAST_EXIT, false,                                           \
+        "At the process exit finish the queues and flush the reports, but "   \
+        "leave the device memory and driver objects to the kernel driver")    \
+release(bool, HIP_HMM_AUTO_POLICY, false,                                     \
+        "Place the managed memory by the kernel accesses: preferred location "\
+        "and prefetch for one device, accessed-by mappings for the sharing "  \
+        "devices. Explicit hipMemAdvise disables the policy for the range")   \
+release(uint, HIP_HMM_POLICY_WINDOW, 8,                                       \
+        "Number of the kernel launches, accessing a managed range, between "  \
+        "the decisions of HIP_HMM_AUTO_POLICY")                               \
+release(uint, HIP_VMM_HANDLE_POOL_SIZE, 256,                                  \
+        "Size limit in MB of the released hipMemCreate allocations, kept for "\
+        "a reuse by hipMemCreate of the same size, 0 disables the reuse")     \
+release(bool, HIP_COALESCE_STREAM_WAITS, true,                                \
+        "With direct dispatch, consecutive hipStreamWaitEvent calls become "  \
+        "one marker, submitted before the next command on the stream")        \
+release(bool, HIP_EVENT_RECORD_REUSE, true,                                   \
+        "With direct dispatch, hipEventRecord reuses the last command of the "\
+        "stream, if it already has a HW signal, instead of a new marker")     \
+release(bool, HIP_COOP_PARALLEL_SUBMIT, false,                                \
+        "Submit the kernels of a multi-device cooperative launch from "       \
+        "parallel threads, released at the same time")                        \
+release(uint, HIP_ASYNC_STAGING_POOL_SIZE, 256,                               \
+        "Size limit in MB of the pinned bounce buffers, which let the async " \
+        "H2D copies from pageable memory return before the GPU copy, 0 "      \
+        "disables the bounce buffers")                                        \
+release(uint, HIP_INLINE_WRITE_SIZE, 64,                                      \
+        "Size limit in bytes of the H2D copies from pageable memory, which "  \
+        "carry the data with the launch of a copy kernel instead of the "     \
+        "staging copy, 0 disables the inline writes")                         \
 release(bool, PAL_HIP_IPC_FLAG, true,                                         \
         "Enable interprocess flag for device allocation in PAL HIP")          \
 release(uint, PAL_FORCE_ASIC_REVISION, 0,                                     \
@@ -215,20 +331,102 @@ release(size_t, PAL_PREPINNED_MEMORY_SIZE, 64,                                \
         "Size in KBytes of prepinned memory")                                 \
 release(bool, AMD_CPU_AFFINITY, false,                                        \
         "Reset CPU affinity of any runtime threads")                          \
+release(bool, ROC_NUMA_THREAD_AFFINITY, true,                                 \
+        "Bind the runtime worker threads of a device to the CPUs of the NUMA "\
+        "node closest to the device")                                         \
 release(bool, ROC_USE_FGS_KERNARG, true,                                      \
         "Use fine grain kernel args segment for supported asics")             \
+release(bool, ROC_P2P_RELAY, true,                                            \
+        "Relay P2P copies between GPUs without a direct link through a GPU "  \
+        "with access to both of them, instead of the host staging")           \
 release(uint, ROC_P2P_SDMA_SIZE, 1024,                                        \
         "The minimum size in KB for P2P transfer with SDMA")                  \
+release(uint, ROC_SDMA_STRIPE_SIZE, 0,                                        \
+        "The minimum size in MB for a copy striped across SDMA engines, "     \
+        "0 disables striping")                                                \
+release(uint, ROC_SDMA_STRIPE_ENGINES, 2,                                     \
+        "Max number of SDMA engines in a striped host or PCIe P2P copy")      \
+release(uint, ROC_SDMA_STRIPE_ENGINES_XGMI, 4,                                \
+        "Max number of SDMA engines in a striped XGMI P2P copy")              \
+release(uint, ROC_SDMA_COALESCE_SIZE, 0,                                      \
+        "The max size in KB of the consecutive SDMA copies on a queue, which "\
+        "share the engine and the completion signal, 0 disables coalescing")  \
 release(uint, ROC_AQL_QUEUE_SIZE, 16384,                                      \
         "AQL queue size in AQL packets")                                      \
 release(uint, ROC_SIGNAL_POOL_SIZE, 64,                                       \
         "Initial size of HSA signal pool")                                    \
+release(uint, ROC_SIGNAL_POOL_MAX_SIZE, 4096,                                 \
+        "Max size of HSA signal pool, the pool shrinks back when idle")       \
+release(uint, ROC_PIN_CACHE_SIZE, 0,                                          \
+        "Budget in MB of the device-wide cache of pinned host ranges for "    \
+        "unpinned transfers, 0 disables the cache")                           \
+release(uint, ROC_MAX_SUBALLOC_SIZE, 64,                                      \
+        "The max size in KB of hipMalloc and hipHostMalloc buffers, which "   \
+        "are sub-allocated from the shared 2MB slabs, 0 disables it")         \
+release(uint, ROC_HOST_HUGE_PAGES, 0,                                         \
+        "Back the pinned host allocations of 2MB and larger with huge pages: "\
+        "0 - off, 1 - transparent huge pages, 2 - hugetlbfs 1GB/2MB pages, "  \
+        "then transparent ones. Falls back to 4KB pages without huge pages")  \
+release(uint, ROC_HOST_TOUCH_THREADS, 8,                                      \
+        "Max number of threads, first touching the pages of the large pinned "\
+        "host allocations on the NUMA node of the device, 0 or 1 touches the "\
+        "pages on the calling thread")                                        \
+release(uint, ROC_ALLOC_TRACE, 0,                                             \
+        "Number of the recent allocation events in the trace ring buffer, "   \
+        "0 disables the allocation trace")                                    \
+release(uint, ROC_MEM_RECONCILE_PERIOD, 100,                                  \
+        "Period in ms of the free memory reconcile with KFD, the accounting " \
+        "of the runtime allocations serves hipMemGetInfo in between")         \
+release(uint, ROC_PRINTF_RING_SIZE, 0,                                        \
+        "Size in MB of the printf buffer ring. The buffered printf output "   \
+        "is formatted on a host thread after the kernel completes, instead "  \
+        "of a wait after every launch, 0 = synchronous printf")               \
+release(bool, GPU_HOSTCALL_LISTENER_PER_DEVICE, true,                         \
+        "Every device gets its own NUMA-local hostcall listener thread, "     \
+        "false serves the hostcalls of all devices from one thread")          \
+release(uint, ROC_PERF_SAMPLE_INTERVAL, 0,                                    \
+        "Interval in ms of the continuous sampling of the device-wide "       \
+        "performance counters, 0 = disabled")                                 \
+release(uint, ROC_PERF_SAMPLE_COUNT, 64,                                      \
+        "Number of the recent performance counter samples kept per device")   \
+release(cstring, ROC_TRACE_EVENTS, "",                                        \
+        "Writes the runtime internal events and the GPU execution of the "    \
+        "commands into the file as Chrome trace JSON at exit, %pid% is "      \
+        "replaced by the process id")                                         \
+release(uint, ROC_KERNEL_STATS, 0,                                            \
+        "Counts the dispatches per kernel, times 1-in-N of them and prints "  \
+        "the kernels sorted by GPU time at exit, 0 = disabled")               \
+release(uint, ROC_DEFERRED_COMMAND_DELETE, 256,                               \
+        "Deletes the released commands on a background thread in batches of " \
+        "N, off the dispatch and the completion paths, 0 = delete inline")    \
+release(uint, ROC_THREAD_POOL_SIZE, 0,                                        \
+        "Number of the worker threads of the runtime thread pool, which runs "\
+        "the internal parallel work, 0 = the CPU count up to 16")             \
+release(cstring, ROC_APP_PROFILE_FILE, "",                                    \
+        "Versioned file of the runtime flag presets per application or "      \
+        "loaded library, the environment variables take precedence")          \
+release(bool, ROC_TIMESTAMP_KERNEL, false,                                    \
+        "Timed HIP event markers take the GPU time from a tiny kernel. The "  \
+        "queue profiling is then enabled only for profiled commands")         \
+release(uint, ROC_LOW_PRIORITY_CHUNK, 0,                                      \
+        "Max workgroups per dispatch of the internal kernels on low priority "\
+        "queues. The chunks let high priority work in, 0 disables the split") \
+release(uint, ROC_CALLBACK_THREADS, 0,                                        \
+        "The number of worker threads for HIP stream callbacks, 0 runs the "  \
+        "callbacks on ROCr async handler thread. If not set, direct "         \
+        "dispatch sizes the pool with the CPU cores")                         \
 release(uint, DEBUG_CLR_LIMIT_BLIT_WG, 16,                                    \
         "Limit the number of workgroups in blit operations")                  \
+release(uint, ROC_BLIT_NT_SIZE, 0,                                            \
+        "Use non-temporal accesses in blit kernels for transfers of at least "\
+        "this size in MB, 0 uses the ASIC default")                           \
+release(uint, ROC_BLIT_BATCH_MAX_SIZE, 64,                                    \
+        "Copy the batched device copies of at most this size in KB with one " \
+        "gather kernel, 0 disables the kernel")                               \
 release(bool, DEBUG_CLR_BLIT_KERNARG_OPT, false,                              \
         "Enable blit kernel arguments optimization")                          \
 release(bool, ROC_SKIP_KERNEL_ARG_COPY, false,                                \
-        "If true, then runtime can skip kernel arg copy")                     \
+        "Capture kernel args into the kernarg pool with direct dispatch")     \
 release(bool, GPU_STREAMOPS_CP_WAIT, false,                                   \
         "Force the stream wait memory operation to wait on CP.")              \
 release(bool, HIP_USE_RUNTIME_UNBUNDLER, false,                               \
@@ -236,13 +434,36 @@ release(bool, HIP_USE_RUNTIME_UNBUNDLER, false,                               \
 release(bool, HIPRTC_USE_RUNTIME_UNBUNDLER, false,                            \
         "Set this to true to force runtime unbundler in hiprtc.")             \
 release(size_t, HIP_INITIAL_DM_SIZE, 8 * Mi,                                  \
-        "Set initial heap size for device malloc.")                           \
+        "Set initial heap size for device malloc, the heap grows through "    \
+        "hostcall over it")                                                   \
 release(bool, HIP_FORCE_DEV_KERNARG, true,                                    \
          "Force device mem for kernel args.")                                 \
 release(bool, DEBUG_CLR_GRAPH_PACKET_CAPTURE, true,                           \
          "Enable/Disable graph packet capturing")                             \
+release(bool, HIP_GRAPH_FUSE_MEMSET, true,                                    \
+         "Fuse adjacent graph memset nodes of a contiguous range into one "   \
+         "fill")                                                              \
+release(bool, HIP_GRAPH_MULTI_STREAM_CAPTURE, true,                           \
+         "Capture AQL packets for the graphs with parallel branches and "     \
+         "dispatch them directly on every branch stream")                     \
+release(bool, HIP_GRAPH_MEM_PLAN, true,                                       \
+         "Plan the peak memory of the graph alloc/free nodes at "             \
+         "instantiation and hold it in the graph pool across the launches")   \
 release(bool, GPU_DEBUG_ENABLE, false,                                        \
         "Enables collection of extra info for debugger at some perf cost")    \
+release(cstring, HIPRTC_CACHE_PATH, "",                                       \
+        "Directory of the hiprtc disk cache for the compiled code objects, "  \
+        "empty disables the cache. The headers from the file system aren't "  \
+        "tracked")                                                            \
+release(uint, HIPRTC_CACHE_SIZE, 1024,                                        \
+        "Size limit in MB of the hiprtc disk cache")                          \
+release(bool, HIPRTC_USE_PCH, false,                                          \
+        "Precompile the builtin and the added headers once per header set, "  \
+        "options and target, and reuse the PCH for the compilations in the "  \
+        "process and through HIPRTC_CACHE_PATH")                              \
+release(uint, HIPRTC_MAX_PARALLEL_COMPILES, 0,                                \
+        "The maximum number of hiprtc compilations running in parallel, "     \
+        "0 uses the number of CPU cores")                                     \
 release(cstring, HIPRTC_COMPILE_OPTIONS_APPEND, "",                           \
         "Set compile options needed for hiprtc compilation")                  \
 release(cstring, HIPRTC_LINK_OPTIONS_APPEND, "",                              \
@@ -255,8 +476,28 @@ release(bool, DEBUG_HIP_FORCE_ASYNC_QUEUE, false,                             \
         "Forces grpahs into async queue mode. DEBUG_HIP_FORCE_GRAPH_QUEUES must be 1") \
 release(uint, DEBUG_HIP_FORCE_GRAPH_QUEUES, 4,                                \
         "Forces the number of streams for the graph parallel execution")      \
+release(bool, DEBUG_HIP_GRAPH_LIST_SCHEDULE, true,                            \
+        "Schedules graph nodes into streams in the critical path order")      \
 release(bool, HIP_ALWAYS_USE_NEW_COMGR_UNBUNDLING_ACTION, false,              \
         "Force to always use new comgr unbundling action")                    \
+release(cstring, HIP_SHARED_CO_CACHE_PATH, "",                                \
+        "Directory of the node-local cache of the unbundled code objects, "   \
+        "shared between the processes, e.g. under /dev/shm. Empty disables "  \
+        "the cache")                                                          \
+release(bool, HIP_SPECIALIZE_GENERIC_TARGETS, false,                          \
+        "Compile the embedded bitcode of the loaded generic target code "     \
+        "objects for the exact device ISA in the background and store the "   \
+        "result into HIP_SHARED_CO_CACHE_PATH, which the later loads use")    \
+release(uint, HIP_PARALLEL_FATBIN_INIT, 0,                                    \
+        "Number of threads, which unbundle the static fat binaries and "      \
+        "build their programs for all devices at the init, 0 keeps it on "    \
+        "demand")                                                             \
+release(bool, HIP_LAZY_FATBIN_EXTRACT, true,                                  \
+        "Unbundle the static fat binaries per device on the first use of "    \
+        "the device, instead of for all devices at the registration")         \
+release(bool, HIP_TEXTURE_OBJECT_CACHE, true,                                 \
+        "Returns the live texture object for the repeated creations with the "\
+        "same resource, view and sampler state, the destroys are counted")    \
 release(uint, DEBUG_HIP_BLOCK_SYNC, 50,                                       \
         "Blocks synchronization on CPU until the callback processing is done")\
 release(uint, DEBUG_CLR_MAX_BATCH_SIZE, 1000,                                 \
@@ -267,11 +508,17 @@ release(bool, DEBUG_HIP_KERNARG_COPY_OPT, true,                               \
         "Enable/Disable multiple kern arg copies")                            \
 release(bool, DEBUG_CLR_USE_STDMUTEX_IN_AMD_MONITOR, false,                   \
         "Use std::mutex in amd::monitor")                                     \
+release(bool, DEBUG_CLR_LOCK_PROFILE, false,                                  \
+        "Count the acquisitions, contended acquisitions and wait time of "    \
+        "the named amd::Monitor locks and print them at the exit")            \
 release(bool, DEBUG_CLR_KERNARG_HDP_FLUSH_WA, false,                          \
         "Toggle kernel arg copy workaround")                                  \
 release(uint, DEBUG_HIP_7_PREVIEW, 0,                                         \
         "Enables specific backward incompatible changes support before 7.0,"  \
         "using the mask. By default the changes are disabled and is set to 0")\
+release(uint, DEBUG_CLR_AQL_BATCH_SIZE, 0,                                 \
+        "The max number of AQL packets submitted with a single doorbell in "  \
+        "direct dispatch mode. 0 = ring the doorbell for every packet")       \
 
 namespace amd {
 
@@ -328,6 +575,13 @@ struct Flag {
 
   bool setValue(const char* value);
 
+  //! Sets the flag with the name from a string, which must outlive the flag, if the flag kept
+  //! the default value. Returns false if the flag can't be set or it was set already.
+  static bool setIfDefault(const char* name, const char* value);
+
+  //! Prints the flag value into the log
+  void print() const;
+
   static bool isDefault(Name name) { return flags_[name].isDefault_; }
 };
 